@@ -19,6 +19,9 @@
 #include <linux/mm.h>
 #include <linux/export.h>
 #include <linux/bitops.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
 #include <linux/dma-map-ops.h> /* for dma_default_coherent */
 
 #include <asm/bcache.h>
@@ -856,6 +859,14 @@ static void r4k_flush_icache_user_range(unsigned long start, unsigned long end)
 
 #ifdef CONFIG_DMA_NONCOHERENT
 
+/*
+ * Sizes from which the DMA cache operations flush the whole primary data
+ * cache by index, instead of walking the range line by line with hit ops.
+ * They default to the size of the cache and are calibrated at boot.
+ */
+static unsigned long dma_wback_inv_blast_size __read_mostly;
+static unsigned long dma_inv_blast_size __read_mostly;
+
 static void r4k_dma_cache_wback_inv(unsigned long addr, unsigned long size)
 {
 	/* Catch bad driver code */
@@ -885,7 +896,7 @@ static void r4k_dma_cache_wback_inv(unsigned long addr, unsigned long size)
 	 * we have to use the HIT-type alternative as IPI cannot be used
 	 * here due to interrupts possibly being disabled.
 	 */
-	if (!r4k_op_needs_ipi(R4K_INDEX) && size >= dcache_size) {
+	if (!r4k_op_needs_ipi(R4K_INDEX) && size >= dma_wback_inv_blast_size) {
 		r4k_blast_dcache();
 	} else {
 		R4600_HIT_CACHEOP_WAR_IMPL;
@@ -955,7 +966,7 @@ static void r4k_dma_cache_inv(unsigned long addr, unsigned long size)
 		return;
 	}
 
-	if (!r4k_op_needs_ipi(R4K_INDEX) && size >= dcache_size) {
+	if (!r4k_op_needs_ipi(R4K_INDEX) && size >= dma_inv_blast_size) {
 		r4k_blast_dcache();
 	} else {
 		R4600_HIT_CACHEOP_WAR_IMPL;
@@ -966,6 +977,86 @@ static void r4k_dma_cache_inv(unsigned long addr, unsigned long size)
 	bc_inv(addr, size);
 	__sync();
 }
+
+#define DMA_CALIBRATE_LOOPS	8
+
+/* Time @range, or a blast of the whole D-cache, over a dirty buffer */
+static u64 __init r4k_dma_time_dcache_op(void *buf,
+		void (*range)(unsigned long start, unsigned long end))
+{
+	unsigned long addr = (unsigned long)buf, flags;
+	u64 start, total = 0;
+	int i;
+
+	for (i = 0; i < DMA_CALIBRATE_LOOPS; i++) {
+		memset(buf, i, dcache_size);
+
+		local_irq_save(flags);
+		start = ktime_get_ns();
+		if (range)
+			range(addr, addr + dcache_size);
+		else
+			r4k_blast_dcache();
+		total += ktime_get_ns() - start;
+		local_irq_restore(flags);
+	}
+
+	return total;
+}
+
+static unsigned long __init r4k_dma_blast_size(u64 blast, u64 range)
+{
+	u64 size;
+
+	if (!blast || !range)
+		return dcache_size;
+
+	/* The cost of walking a range is proportional to its size */
+	size = div64_u64(blast * dcache_size, range);
+
+	/*
+	 * Blasting also evicts the lines of everything else, which costs
+	 * refills later on that the measurement does not see; don't do it for
+	 * much less than the size of the cache.
+	 */
+	size = clamp_t(u64, size, dcache_size / 4, 8 * dcache_size);
+
+	return ALIGN(size, cpu_dcache_line_size());
+}
+
+/*
+ * The crossover between blasting and walking the range varies a lot between
+ * cores, depending on the cost of the index and hit cache ops; measure it on
+ * the CPU we run on.
+ */
+static int __init r4k_dma_cache_calibrate(void)
+{
+	u64 blast, wback_inv, inv;
+	void *buf;
+
+	/* Only the primary cache paths choose between both ways */
+	if (dma_default_coherent || cpu_has_inclusive_pcaches ||
+	    r4k_op_needs_ipi(R4K_INDEX) || !dcache_size)
+		return 0;
+
+	buf = kmalloc(dcache_size, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	blast = r4k_dma_time_dcache_op(buf, NULL);
+	wback_inv = r4k_dma_time_dcache_op(buf, blast_dcache_range);
+	inv = r4k_dma_time_dcache_op(buf, blast_inv_dcache_range);
+	kfree(buf);
+
+	dma_wback_inv_blast_size = r4k_dma_blast_size(blast, wback_inv);
+	dma_inv_blast_size = r4k_dma_blast_size(blast, inv);
+
+	pr_info("DMA cache ops blast the D-cache from %lukB (wback_inv), %lukB (inv)\n",
+		dma_wback_inv_blast_size >> 10, dma_inv_blast_size >> 10);
+
+	return 0;
+}
+late_initcall(r4k_dma_cache_calibrate);
 #endif /* CONFIG_DMA_NONCOHERENT */
 
 static void r4k_flush_icache_all(void)
@@ -1922,6 +2013,9 @@ void r4k_cache_init(void)
 		_dma_cache_wback_inv	= r4k_dma_cache_wback_inv;
 		_dma_cache_wback	= r4k_dma_cache_wback_inv;
 		_dma_cache_inv		= r4k_dma_cache_inv;
+
+		dma_wback_inv_blast_size = dcache_size;
+		dma_inv_blast_size = dcache_size;
 	}
 #endif /* CONFIG_DMA_NONCOHERENT */
 
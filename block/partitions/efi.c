@@ -103,6 +103,20 @@ force_gpt_fn(char *str)
 }
 __setup("gpt", force_gpt_fn);
 
+/* The 'trust_primary_gpt' option skips the read of the alternate GPT when
+ * the primary one is valid. It sits at the very end of the disk, which is
+ * slow to reach on some SD cards and USB sticks. (It can't start with 'gpt',
+ * which would match the option above.)
+ */
+static int trust_primary_gpt;
+static int __init
+trust_primary_gpt_fn(char *str)
+{
+	trust_primary_gpt = 1;
+	return 1;
+}
+__setup("trust_primary_gpt", trust_primary_gpt_fn);
+
 
 /**
  * efi_crc32() - EFI version of crc32 function
@@ -578,7 +592,8 @@ compare_gpts(gpt_header *pgpt, gpt_header *agpt, u64 lastlba)
  * valid.  If the Primary GPT header is not valid, the Alternate GPT header
  * is not checked unless the 'gpt' kernel command line option is passed.
  * This protects against devices which misreport their size, and forces
- * the user to decide to use the Alternate GPT.
+ * the user to decide to use the Alternate GPT. With the 'trust_primary_gpt'
+ * option, a valid Primary GPT is used without reading the Alternate one.
  */
 static int find_valid_gpt(struct parsed_partitions *state, gpt_header **gpt,
 			  gpt_entry **ptes)
@@ -614,6 +629,11 @@ static int find_valid_gpt(struct parsed_partitions *state, gpt_header **gpt,
 
 	good_pgpt = is_gpt_valid(state, GPT_PRIMARY_PARTITION_TABLE_LBA,
 				 &pgpt, &pptes);
+	if (good_pgpt && trust_primary_gpt) {
+		*gpt  = pgpt;
+		*ptes = pptes;
+		return 1;
+	}
         if (good_pgpt)
 		good_agpt = is_gpt_valid(state,
 					 le64_to_cpu(pgpt->alternate_lba),
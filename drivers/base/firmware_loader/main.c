@@ -494,6 +494,7 @@ fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 	char *path;
 	size_t msize = INT_MAX;
 	void *buffer = NULL;
+	bool populated;
 
 	/* Already populated data member means we're loading into a buffer */
 	if (!decompress && fw_priv->data) {
@@ -505,7 +506,8 @@ fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 	if (!path)
 		return -ENOMEM;
 
-	wait_for_initramfs();
+	populated = wait_for_initramfs_early();
+retry:
 	for (i = 0; i < ARRAY_SIZE(fw_path); i++) {
 		size_t file_size = 0;
 		size_t *file_size_ptr = NULL;
@@ -570,6 +572,13 @@ fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 		fw_state_done(fw_priv);
 		break;
 	}
+
+	/* Not in the early part of the initramfs, it might be in the rest */
+	if (rc == -ENOENT && !populated) {
+		wait_for_initramfs();
+		populated = true;
+		goto retry;
+	}
 	__putname(path);
 
 	return rc;
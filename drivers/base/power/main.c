@@ -33,7 +33,9 @@
 #include <trace/events/power.h>
 #include <linux/cpufreq.h>
 #include <linux/cpuidle.h>
+#include <linux/debugfs.h>
 #include <linux/devfreq.h>
+#include <linux/seq_file.h>
 #include <linux/timer.h>
 
 #include "../base.h"
@@ -232,6 +234,102 @@ static void initcall_debug_report(struct device *dev, ktime_t calltime,
 		 (unsigned long long)nsecs >> 10);
 }
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * History of the duration of the device callbacks, exported through the
+ * pm_device_times debugfs file, so that the devices slowing down a system
+ * transition can be found without booting with pm_print_times.
+ */
+#define DPM_TIMES_NUM	512
+
+struct dpm_time {
+	char device[32];
+	char driver[24];
+	const char *info;
+	unsigned int cycle;
+	int event;
+	int error;
+	u32 usecs;
+};
+
+static struct dpm_time dpm_times[DPM_TIMES_NUM];
+static unsigned int dpm_times_next;
+static unsigned int dpm_times_cycle;
+static DEFINE_SPINLOCK(dpm_times_lock);
+
+static ktime_t dpm_time_start(void)
+{
+	return ktime_get();
+}
+
+static void dpm_time_record(struct device *dev, ktime_t calltime,
+			    pm_message_t state, const char *info, int error)
+{
+	s64 usecs = ktime_us_delta(ktime_get(), calltime);
+	struct dpm_time *t;
+	unsigned long flags;
+
+	spin_lock_irqsave(&dpm_times_lock, flags);
+	t = &dpm_times[dpm_times_next++ % DPM_TIMES_NUM];
+	strscpy(t->device, dev_name(dev), sizeof(t->device));
+	strscpy(t->driver, dev_driver_string(dev), sizeof(t->driver));
+	t->info = info;
+	t->cycle = dpm_times_cycle;
+	t->event = state.event;
+	t->error = error;
+	t->usecs = min_t(s64, usecs, U32_MAX);
+	spin_unlock_irqrestore(&dpm_times_lock, flags);
+}
+
+static void dpm_times_new_cycle(void)
+{
+	spin_lock_irq(&dpm_times_lock);
+	dpm_times_cycle++;
+	spin_unlock_irq(&dpm_times_lock);
+}
+
+static int pm_device_times_show(struct seq_file *s, void *unused)
+{
+	unsigned int i, first, last;
+	struct dpm_time t;
+
+	seq_printf(s, "%-6s%-10s%-24s%-24s%-32s%10s%6s\n", "cycle", "event",
+		   "phase", "driver", "device", "usecs", "err");
+
+	spin_lock_irq(&dpm_times_lock);
+	last = dpm_times_next;
+	first = last > DPM_TIMES_NUM ? last - DPM_TIMES_NUM : 0;
+	spin_unlock_irq(&dpm_times_lock);
+
+	for (i = first; i != last; i++) {
+		spin_lock_irq(&dpm_times_lock);
+		t = dpm_times[i % DPM_TIMES_NUM];
+		spin_unlock_irq(&dpm_times_lock);
+
+		seq_printf(s, "%-6u%-10s%-24s%-24s%-32s%10u%6d\n", t.cycle,
+			   pm_verb(t.event), t.info ?: "", t.driver, t.device,
+			   t.usecs, t.error);
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(pm_device_times);
+
+static int __init pm_device_times_debugfs_init(void)
+{
+	debugfs_create_file("pm_device_times", 0400, NULL, NULL,
+			    &pm_device_times_fops);
+	return 0;
+}
+late_initcall(pm_device_times_debugfs_init);
+#else
+static inline ktime_t dpm_time_start(void) { return 0; }
+static inline void dpm_time_record(struct device *dev, ktime_t calltime,
+				   pm_message_t state, const char *info,
+				   int error) {}
+static inline void dpm_times_new_cycle(void) {}
+#endif /* CONFIG_DEBUG_FS */
+
 /**
  * dpm_wait - Wait for a PM operation to complete.
  * @dev: Device to wait for.
@@ -477,7 +575,7 @@ static void dpm_show_time(ktime_t starttime, pm_message_t state, int error,
 static int dpm_run_callback(pm_callback_t cb, struct device *dev,
 			    pm_message_t state, const char *info)
 {
-	ktime_t calltime;
+	ktime_t calltime, starttime;
 	int error;
 
 	if (!cb)
@@ -487,7 +585,9 @@ static int dpm_run_callback(pm_callback_t cb, struct device *dev,
 
 	pm_dev_dbg(dev, state, info);
 	trace_device_pm_callback_start(dev, info, state.event);
+	starttime = dpm_time_start();
 	error = cb(dev);
+	dpm_time_record(dev, starttime, state, info, error);
 	trace_device_pm_callback_end(dev, error);
 	suspend_report_result(cb, error);
 
@@ -1546,12 +1646,14 @@ static int legacy_suspend(struct device *dev, pm_message_t state,
 			  const char *info)
 {
 	int error;
-	ktime_t calltime;
+	ktime_t calltime, starttime;
 
 	calltime = initcall_debug_start(dev, cb);
 
 	trace_device_pm_callback_start(dev, info, state.event);
+	starttime = dpm_time_start();
 	error = cb(dev, state);
+	dpm_time_record(dev, starttime, state, info, error);
 	trace_device_pm_callback_end(dev, error);
 	suspend_report_result(cb, error);
 
@@ -1866,6 +1968,8 @@ int dpm_prepare(pm_message_t state)
 	trace_suspend_resume(TPS("dpm_prepare"), state.event, true);
 	might_sleep();
 
+	dpm_times_new_cycle();
+
 	/*
 	 * Give a chance for the known devices to complete their probes, before
 	 * disable probing of devices. This sync point is important at least
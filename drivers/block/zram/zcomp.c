@@ -11,6 +11,7 @@
 #include <linux/sched.h>
 #include <linux/cpu.h>
 #include <linux/crypto.h>
+#include <linux/mm.h>
 
 #include "zcomp.h"
 
@@ -33,28 +34,185 @@ static const char * const backends[] = {
 #endif
 };
 
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+/* Same level as the default one of the zstd crypto backend */
+#define ZCOMP_ZSTD_LEVEL	3
+
+/*
+ * A zstd dictionary, digested once per device and shared by all its
+ * streams. Pages are small and mostly look alike, so compressing them
+ * against a dictionary trained on typical pages gives a much better
+ * ratio than compressing each of them from scratch.
+ */
+struct zcomp_dict {
+	void *data;
+	ZSTD_parameters params;
+	void *cdict_wksp;
+	ZSTD_CDict *cdict;
+	void *ddict_wksp;
+	ZSTD_DDict *ddict;
+};
+
+static void zcomp_dict_free(struct zcomp_dict *dict)
+{
+	if (!dict)
+		return;
+
+	kvfree(dict->ddict_wksp);
+	kvfree(dict->cdict_wksp);
+	kvfree(dict->data);
+	kfree(dict);
+}
+
+static struct zcomp_dict *zcomp_dict_create(const char *compress,
+		const void *data, size_t len)
+{
+	struct zcomp_dict *dict;
+	size_t sz;
+
+	if (strcmp(compress, "zstd"))
+		return ERR_PTR(-EINVAL);
+
+	dict = kzalloc(sizeof(*dict), GFP_KERNEL);
+	if (!dict)
+		return ERR_PTR(-ENOMEM);
+
+	/* The digested dictionaries reference it, keep our own copy */
+	dict->data = kvmalloc(len, GFP_KERNEL);
+	if (!dict->data)
+		goto out_nomem;
+	memcpy(dict->data, data, len);
+
+	dict->params = ZSTD_getParams(ZCOMP_ZSTD_LEVEL, PAGE_SIZE, len);
+
+	sz = ZSTD_CDictWorkspaceBound(dict->params.cParams);
+	dict->cdict_wksp = kvmalloc(sz, GFP_KERNEL);
+	if (!dict->cdict_wksp)
+		goto out_nomem;
+	dict->cdict = ZSTD_initCDict(dict->data, len, dict->params,
+			dict->cdict_wksp, sz);
+
+	sz = ZSTD_DDictWorkspaceBound();
+	dict->ddict_wksp = kvmalloc(sz, GFP_KERNEL);
+	if (!dict->ddict_wksp)
+		goto out_nomem;
+	dict->ddict = ZSTD_initDDict(dict->data, len, dict->ddict_wksp, sz);
+
+	if (!dict->cdict || !dict->ddict) {
+		zcomp_dict_free(dict);
+		return ERR_PTR(-EINVAL);
+	}
+	return dict;
+
+out_nomem:
+	zcomp_dict_free(dict);
+	return ERR_PTR(-ENOMEM);
+}
+
+static void zcomp_strm_free_dict(struct zcomp_strm *zstrm)
+{
+	kvfree(zstrm->zstd_wksp);
+	zstrm->zstd_wksp = NULL;
+	zstrm->cctx = NULL;
+	zstrm->dctx = NULL;
+	zstrm->dict = NULL;
+}
+
+/* One workspace holds both the compression and decompression contexts */
+static int zcomp_strm_init_dict(struct zcomp_strm *zstrm, struct zcomp *comp)
+{
+	size_t csize, dsize;
+
+	csize = ALIGN(ZSTD_CCtxWorkspaceBound(comp->dict->params.cParams),
+			sizeof(u64));
+	dsize = ZSTD_DCtxWorkspaceBound();
+
+	zstrm->zstd_wksp = kvmalloc(csize + dsize, GFP_KERNEL);
+	if (!zstrm->zstd_wksp)
+		return -ENOMEM;
+
+	zstrm->cctx = ZSTD_initCCtx(zstrm->zstd_wksp, csize);
+	zstrm->dctx = ZSTD_initDCtx(zstrm->zstd_wksp + csize, dsize);
+	if (!zstrm->cctx || !zstrm->dctx)
+		return -ENOMEM;
+
+	zstrm->dict = comp->dict;
+	return 0;
+}
+
+static int zcomp_compress_dict(struct zcomp_strm *zstrm,
+		const void *src, unsigned int *dst_len)
+{
+	size_t ret;
+
+	ret = ZSTD_compress_usingCDict(zstrm->cctx, zstrm->buffer,
+			PAGE_SIZE * 2, src, PAGE_SIZE, zstrm->dict->cdict);
+	if (ZSTD_isError(ret))
+		return -EINVAL;
+
+	*dst_len = ret;
+	return 0;
+}
+
+static int zcomp_decompress_dict(struct zcomp_strm *zstrm,
+		const void *src, unsigned int src_len, void *dst)
+{
+	size_t ret;
+
+	ret = ZSTD_decompress_usingDDict(zstrm->dctx, dst, PAGE_SIZE,
+			src, src_len, zstrm->dict->ddict);
+	if (ZSTD_isError(ret) || ret != PAGE_SIZE)
+		return -EINVAL;
+
+	return 0;
+}
+#else
+static void zcomp_dict_free(struct zcomp_dict *dict) {}
+
+static struct zcomp_dict *zcomp_dict_create(const char *compress,
+		const void *data, size_t len)
+{
+	return ERR_PTR(-EINVAL);
+}
+
+static void zcomp_strm_free_dict(struct zcomp_strm *zstrm) {}
+
+static int zcomp_strm_init_dict(struct zcomp_strm *zstrm, struct zcomp *comp)
+{
+	return -EINVAL;
+}
+#endif
+
 static void zcomp_strm_free(struct zcomp_strm *zstrm)
 {
 	if (!IS_ERR_OR_NULL(zstrm->tfm))
 		crypto_free_comp(zstrm->tfm);
+	zcomp_strm_free_dict(zstrm);
 	free_pages((unsigned long)zstrm->buffer, 1);
 	zstrm->tfm = NULL;
 	zstrm->buffer = NULL;
 }
 
 /*
- * Initialize zcomp_strm structure with ->tfm initialized by backend, and
- * ->buffer. Return a negative value on error.
+ * Initialize zcomp_strm structure with ->tfm initialized by backend, or
+ * with the zstd contexts if the device has a dictionary, and ->buffer.
+ * Return a negative value on error.
  */
 static int zcomp_strm_init(struct zcomp_strm *zstrm, struct zcomp *comp)
 {
-	zstrm->tfm = crypto_alloc_comp(comp->name, 0, 0);
+	int ret = 0;
+
+	if (comp->dict)
+		ret = zcomp_strm_init_dict(zstrm, comp);
+	else
+		zstrm->tfm = crypto_alloc_comp(comp->name, 0, 0);
 	/*
 	 * allocate 2 pages. 1 for compressed data, plus 1 extra for the
 	 * case when compressed size is larger than the original one
 	 */
 	zstrm->buffer = (void *)__get_free_pages(GFP_KERNEL | __GFP_ZERO, 1);
-	if (IS_ERR_OR_NULL(zstrm->tfm) || !zstrm->buffer) {
+	if (ret || (!comp->dict && IS_ERR_OR_NULL(zstrm->tfm)) ||
+	    !zstrm->buffer) {
 		zcomp_strm_free(zstrm);
 		return -ENOMEM;
 	}
@@ -137,6 +295,10 @@ int zcomp_compress(struct zcomp_strm *zstrm,
 	 * the dst buffer, zram_drv will take care of the fact that
 	 * compressed buffer is too big.
 	 */
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+	if (zstrm->dict)
+		return zcomp_compress_dict(zstrm, src, dst_len);
+#endif
 	*dst_len = PAGE_SIZE * 2;
 
 	return crypto_comp_compress(zstrm->tfm,
@@ -149,6 +311,10 @@ int zcomp_decompress(struct zcomp_strm *zstrm,
 {
 	unsigned int dst_len = PAGE_SIZE;
 
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+	if (zstrm->dict)
+		return zcomp_decompress_dict(zstrm, src, src_len, dst);
+#endif
 	return crypto_comp_decompress(zstrm->tfm,
 			src, src_len,
 			dst, &dst_len);
@@ -201,6 +367,7 @@ void zcomp_destroy(struct zcomp *comp)
 {
 	cpuhp_state_remove_instance(CPUHP_ZCOMP_PREPARE, &comp->node);
 	free_percpu(comp->stream);
+	zcomp_dict_free(comp->dict);
 	kfree(comp);
 }
 
@@ -210,9 +377,11 @@ void zcomp_destroy(struct zcomp *comp)
  * backend pointer or ERR_PTR if things went bad. ERR_PTR(-EINVAL)
  * if requested algorithm is not supported, ERR_PTR(-ENOMEM) in
  * case of allocation error, or any other error potentially
- * returned by zcomp_init().
+ * returned by zcomp_init(). A non-empty dict is only supported by
+ * zstd, pages are then compressed against it.
  */
-struct zcomp *zcomp_create(const char *compress)
+struct zcomp *zcomp_create(const char *compress, const void *dict,
+		size_t dict_len)
 {
 	struct zcomp *comp;
 	int error;
@@ -225,8 +394,18 @@ struct zcomp *zcomp_create(const char *compress)
 		return ERR_PTR(-ENOMEM);
 
 	comp->name = compress;
+	if (dict_len) {
+		comp->dict = zcomp_dict_create(compress, dict, dict_len);
+		if (IS_ERR(comp->dict)) {
+			error = PTR_ERR(comp->dict);
+			kfree(comp);
+			return ERR_PTR(error);
+		}
+	}
+
 	error = zcomp_init(comp);
 	if (error) {
+		zcomp_dict_free(comp->dict);
 		kfree(comp);
 		return ERR_PTR(error);
 	}
@@ -6,6 +6,9 @@
 #ifndef _ZCOMP_H_
 #define _ZCOMP_H_
 #include <linux/local_lock.h>
+#include <linux/zstd.h>
+
+struct zcomp_dict;
 
 struct zcomp_strm {
 	/* The members ->buffer and ->tfm are protected by ->lock. */
@@ -13,12 +16,21 @@ struct zcomp_strm {
 	/* compression/decompression buffer */
 	void *buffer;
 	struct crypto_comp *tfm;
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+	/* zstd contexts, used instead of ->tfm when ->dict is set */
+	const struct zcomp_dict *dict;
+	void *zstd_wksp;
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+#endif
 };
 
 /* dynamic per-device compression frontend */
 struct zcomp {
 	struct zcomp_strm __percpu *stream;
 	const char *name;
+	/* NULL unless pages are compressed against a dictionary */
+	struct zcomp_dict *dict;
 	struct hlist_node node;
 };
 
@@ -27,7 +39,8 @@ int zcomp_cpu_dead(unsigned int cpu, struct hlist_node *node);
 ssize_t zcomp_available_show(const char *comp, char *buf);
 bool zcomp_available_algorithm(const char *comp);
 
-struct zcomp *zcomp_create(const char *comp);
+struct zcomp *zcomp_create(const char *comp, const void *dict,
+		size_t dict_len);
 void zcomp_destroy(struct zcomp *comp);
 
 struct zcomp_strm *zcomp_stream_get(struct zcomp *comp);
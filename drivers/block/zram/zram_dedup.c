@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Same-content page deduplication for zram
+ *
+ * Pages are hashed before compression. If a stored object has the same hash
+ * and the same content, the slot shares its zsmalloc handle instead of
+ * compressing the page again. Shared objects are refcounted, and indexed
+ * both by hash, for the lookup on write, and by handle, for the free.
+ */
+
+#define KMSG_COMPONENT "zram"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/highmem.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/xxhash.h>
+
+#include "zram_drv.h"
+
+void zram_dedup_init(struct zram *zram)
+{
+	spin_lock_init(&zram->dedup_lock);
+	zram->dedup_by_checksum = RB_ROOT;
+	zram->dedup_by_handle = RB_ROOT;
+}
+
+unsigned long zram_dedup_checksum(struct page *page)
+{
+	unsigned long checksum;
+	void *mem;
+
+	mem = kmap_atomic(page);
+	checksum = xxhash(mem, PAGE_SIZE, 0);
+	kunmap_atomic(mem);
+
+	return checksum;
+}
+
+/* Caller should hold dedup_lock */
+static bool zram_dedup_match(struct zram *zram, struct zram_dedup_entry *entry,
+			     struct page *page)
+{
+	struct zcomp_strm *zstrm;
+	void *src, *mem;
+	bool match;
+	int ret;
+
+	if (entry->len != PAGE_SIZE)
+		zstrm = zcomp_stream_get(zram->comp);
+
+	src = zs_map_object(zram->mem_pool, entry->handle, ZS_MM_RO);
+	mem = kmap_atomic(page);
+	if (entry->len == PAGE_SIZE) {
+		match = !memcmp(mem, src, PAGE_SIZE);
+	} else {
+		/* Decompressing is still much cheaper than compressing */
+		ret = zcomp_decompress(zstrm, src, entry->len, zstrm->buffer);
+		match = !ret && !memcmp(mem, zstrm->buffer, PAGE_SIZE);
+	}
+	kunmap_atomic(mem);
+	zs_unmap_object(zram->mem_pool, entry->handle);
+
+	if (entry->len != PAGE_SIZE)
+		zcomp_stream_put(zram->comp);
+
+	return match;
+}
+
+/*
+ * Look for a stored object with the content of @page. On success a reference
+ * is taken on it for the caller's slot, and its handle is returned.
+ */
+unsigned long zram_dedup_find(struct zram *zram, struct page *page,
+			      unsigned long checksum, unsigned int *len)
+{
+	struct rb_node *node;
+	struct zram_dedup_entry *entry, *first = NULL;
+	unsigned long handle = 0;
+
+	spin_lock(&zram->dedup_lock);
+
+	/* Find the first entry of the run with this checksum */
+	node = zram->dedup_by_checksum.rb_node;
+	while (node) {
+		entry = rb_entry(node, struct zram_dedup_entry, checksum_node);
+		if (checksum < entry->checksum) {
+			node = node->rb_left;
+		} else if (checksum > entry->checksum) {
+			node = node->rb_right;
+		} else {
+			first = entry;
+			node = node->rb_left;
+		}
+	}
+
+	for (entry = first; entry; ) {
+		if (zram_dedup_match(zram, entry, page)) {
+			entry->refcount++;
+			handle = entry->handle;
+			*len = entry->len;
+			atomic64_add(entry->len, &zram->stats.dup_data_size);
+			break;
+		}
+
+		node = rb_next(&entry->checksum_node);
+		entry = node ? rb_entry(node, struct zram_dedup_entry,
+					checksum_node) : NULL;
+		if (entry && entry->checksum != checksum)
+			break;
+	}
+
+	spin_unlock(&zram->dedup_lock);
+
+	return handle;
+}
+
+/*
+ * Make the new object @handle available to later writes. Returns false if it
+ * couldn't be registered, in which case the slot owns it as usual.
+ */
+bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		       unsigned int len, unsigned long checksum)
+{
+	struct rb_node **link, *parent = NULL;
+	struct zram_dedup_entry *entry, *tmp;
+
+	entry = kmalloc(sizeof(*entry), GFP_NOIO | __GFP_NOWARN);
+	if (!entry)
+		return false;
+
+	entry->checksum = checksum;
+	entry->handle = handle;
+	entry->len = len;
+	entry->refcount = 1;
+
+	spin_lock(&zram->dedup_lock);
+
+	link = &zram->dedup_by_checksum.rb_node;
+	while (*link) {
+		parent = *link;
+		tmp = rb_entry(parent, struct zram_dedup_entry, checksum_node);
+		if (checksum < tmp->checksum)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&entry->checksum_node, parent, link);
+	rb_insert_color(&entry->checksum_node, &zram->dedup_by_checksum);
+
+	parent = NULL;
+	link = &zram->dedup_by_handle.rb_node;
+	while (*link) {
+		parent = *link;
+		tmp = rb_entry(parent, struct zram_dedup_entry, handle_node);
+		if (handle < tmp->handle)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&entry->handle_node, parent, link);
+	rb_insert_color(&entry->handle_node, &zram->dedup_by_handle);
+
+	spin_unlock(&zram->dedup_lock);
+
+	atomic64_add(sizeof(*entry), &zram->stats.meta_data_size);
+
+	return true;
+}
+
+/*
+ * Drop the reference of a ZRAM_DEDUP slot on @handle, and free the object
+ * with the last one.
+ */
+void zram_dedup_put(struct zram *zram, unsigned long handle, unsigned int len)
+{
+	struct rb_node *node;
+	struct zram_dedup_entry *entry = NULL;
+
+	spin_lock(&zram->dedup_lock);
+
+	node = zram->dedup_by_handle.rb_node;
+	while (node) {
+		entry = rb_entry(node, struct zram_dedup_entry, handle_node);
+		if (handle < entry->handle)
+			node = node->rb_left;
+		else if (handle > entry->handle)
+			node = node->rb_right;
+		else
+			break;
+	}
+
+	if (WARN_ON_ONCE(!node)) {
+		spin_unlock(&zram->dedup_lock);
+		return;
+	}
+
+	if (--entry->refcount) {
+		spin_unlock(&zram->dedup_lock);
+		atomic64_sub(len, &zram->stats.dup_data_size);
+		return;
+	}
+
+	rb_erase(&entry->checksum_node, &zram->dedup_by_checksum);
+	rb_erase(&entry->handle_node, &zram->dedup_by_handle);
+	spin_unlock(&zram->dedup_lock);
+
+	zs_free(zram->mem_pool, handle);
+	atomic64_sub(len, &zram->stats.compr_data_size);
+	atomic64_sub(sizeof(*entry), &zram->stats.meta_data_size);
+	kfree(entry);
+}
@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+/*
+ * Same-content page deduplication for zram
+ */
+
+#ifndef _ZRAM_DEDUP_H_
+#define _ZRAM_DEDUP_H_
+
+#include <linux/rbtree.h>
+#include <linux/spinlock.h>
+
+struct zram;
+
+/* One compressed object shared by all the slots with the same content */
+struct zram_dedup_entry {
+	struct rb_node checksum_node;
+	struct rb_node handle_node;
+	unsigned long checksum;
+	unsigned long handle;
+	unsigned int len;
+	unsigned int refcount;
+};
+
+#ifdef CONFIG_ZRAM_DEDUP
+static inline bool zram_dedup_enabled(struct zram *zram)
+{
+	return zram->use_dedup;
+}
+
+void zram_dedup_init(struct zram *zram);
+unsigned long zram_dedup_checksum(struct page *page);
+unsigned long zram_dedup_find(struct zram *zram, struct page *page,
+			      unsigned long checksum, unsigned int *len);
+bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		       unsigned int len, unsigned long checksum);
+void zram_dedup_put(struct zram *zram, unsigned long handle, unsigned int len);
+#else
+static inline bool zram_dedup_enabled(struct zram *zram)
+{
+	return false;
+}
+
+static inline void zram_dedup_init(struct zram *zram) {}
+static inline unsigned long zram_dedup_checksum(struct page *page)
+{
+	return 0;
+}
+
+static inline unsigned long zram_dedup_find(struct zram *zram,
+		struct page *page, unsigned long checksum, unsigned int *len)
+{
+	return 0;
+}
+
+static inline bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		unsigned int len, unsigned long checksum)
+{
+	return false;
+}
+
+static inline void zram_dedup_put(struct zram *zram, unsigned long handle,
+		unsigned int len) {}
+#endif
+
+#endif /* _ZRAM_DEDUP_H_ */
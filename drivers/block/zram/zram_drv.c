@@ -58,6 +58,8 @@ static const struct block_device_operations zram_wb_devops;
 static void zram_free_page(struct zram *zram, size_t index);
 static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 				u32 index, int offset, struct bio *bio);
+static int zram_read_from_zspool(struct zram *zram, struct page *page,
+				 u32 index, struct zcomp_strm *zstrm);
 
 
 static int zram_slot_trylock(struct zram *zram, u32 index)
@@ -1023,6 +1025,358 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return len;
 }
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recompressor, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+/* An empty string disables recompression */
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recompressor)];
+	size_t sz;
+
+	strlcpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[--sz] = 0x00;
+
+	if (sz && !zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recompressor, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+
+static int zram_recomp_create(struct zram *zram)
+{
+	struct zcomp *comp;
+
+	if (!zram->recompressor[0])
+		return 0;
+
+	comp = zcomp_create(zram->recompressor, NULL, 0);
+	if (IS_ERR(comp)) {
+		pr_err("Cannot initialise %s compressing backend\n",
+				zram->recompressor);
+		return PTR_ERR(comp);
+	}
+
+	zram->recomp = comp;
+	return 0;
+}
+
+static void zram_recomp_destroy(struct zram *zram)
+{
+	if (zram->recomp)
+		zcomp_destroy(zram->recomp);
+	zram->recomp = NULL;
+}
+
+/*
+ * Re-encode the slot with the secondary algorithm. Runs with the slot lock
+ * held, so the new object is allocated without direct reclaim; the caller
+ * gives up on -ENOMEM.
+ */
+static int zram_recompress(struct zram *zram, u32 index, struct page *page)
+{
+	unsigned int comp_len_old = zram_get_obj_size(zram, index);
+	unsigned int comp_len_new;
+	bool idle = zram_test_flag(zram, index, ZRAM_IDLE);
+	struct zcomp_strm *zstrm;
+	unsigned long handle;
+	void *src, *dst;
+	int ret;
+
+	ret = zram_read_from_zspool(zram, page, index, NULL);
+	if (ret)
+		return ret;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &comp_len_new);
+	kunmap_atomic(src);
+
+	if (ret) {
+		zcomp_stream_put(zram->recomp);
+		return ret;
+	}
+
+	/* Don't try again until the page is rewritten */
+	if (comp_len_new >= huge_class_size || comp_len_new >= comp_len_old) {
+		zcomp_stream_put(zram->recomp);
+		zram_set_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+		return 0;
+	}
+
+	handle = zs_malloc(zram->mem_pool, comp_len_new,
+			__GFP_KSWAPD_RECLAIM |
+			__GFP_NOWARN |
+			__GFP_HIGHMEM |
+			__GFP_MOVABLE);
+	if (!handle) {
+		zcomp_stream_put(zram->recomp);
+		return -ENOMEM;
+	}
+
+	dst = zs_map_object(zram->mem_pool, handle, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, comp_len_new);
+	zcomp_stream_put(zram->recomp);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	zram_free_page(zram, index);
+	zram_set_handle(zram, index, handle);
+	zram_set_obj_size(zram, index, comp_len_new);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+	/* Keep the page eligible for idle writeback */
+	if (idle)
+		zram_set_flag(zram, index, ZRAM_IDLE);
+
+	atomic64_add(comp_len_new, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.pages_stored);
+	return 0;
+}
+
+#define IDLE_RECOMPRESS BIT(0)
+#define HUGE_RECOMPRESS BIT(1)
+
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
+	unsigned long index;
+	struct page *page;
+	ssize_t ret = len;
+	int mode, err = 0;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = IDLE_RECOMPRESS;
+	else if (sysfs_streq(buf, "huge"))
+		mode = HUGE_RECOMPRESS;
+	else if (sysfs_streq(buf, "huge_idle"))
+		mode = IDLE_RECOMPRESS | HUGE_RECOMPRESS;
+	else
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		ret = -EINVAL;
+		goto release_init_lock;
+	}
+
+	if (!zram->recomp) {
+		ret = -ENODEV;
+		goto release_init_lock;
+	}
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page) {
+		ret = -ENOMEM;
+		goto release_init_lock;
+	}
+
+	for (index = 0; index < nr_pages; index++) {
+		zram_slot_lock(zram, index);
+		if (!zram_allocated(zram, index))
+			goto next;
+
+		if (zram_test_flag(zram, index, ZRAM_WB) ||
+				zram_test_flag(zram, index, ZRAM_SAME) ||
+				zram_test_flag(zram, index, ZRAM_UNDER_WB) ||
+				zram_test_flag(zram, index, ZRAM_RECOMP) ||
+				zram_test_flag(zram, index, ZRAM_INCOMPRESSIBLE) ||
+				zram_test_flag(zram, index, ZRAM_DEDUP))
+			goto next;
+
+		if (mode & IDLE_RECOMPRESS &&
+			  !zram_test_flag(zram, index, ZRAM_IDLE))
+			goto next;
+		if (mode & HUGE_RECOMPRESS &&
+			  !zram_test_flag(zram, index, ZRAM_HUGE))
+			goto next;
+
+		err = zram_recompress(zram, index, page);
+next:
+		zram_slot_unlock(zram, index);
+		if (err) {
+			ret = err;
+			break;
+		}
+
+		cond_resched();
+	}
+
+	__free_page(page);
+release_init_lock:
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#else
+static int zram_recomp_create(struct zram *zram)
+{
+	return 0;
+}
+
+static void zram_recomp_destroy(struct zram *zram) {}
+#endif
+
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+static ssize_t comp_dict_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t len;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	len = zram->dict_len;
+	up_read(&zram->init_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%zu\n", len);
+}
+
+/*
+ * Load the zstd dictionary the pages get compressed against, from the file
+ * at the written path. An empty path drops the dictionary.
+ */
+static ssize_t comp_dict_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	char *file_name;
+	size_t sz;
+	struct file *file;
+	void *dict = NULL;
+	loff_t dict_len = 0, pos = 0;
+	int err = 0;
+	struct zram *zram = dev_to_zram(dev);
+
+	file_name = kmalloc(PATH_MAX, GFP_KERNEL);
+	if (!file_name)
+		return -ENOMEM;
+
+	strlcpy(file_name, buf, PATH_MAX);
+	/* ignore trailing newline */
+	sz = strlen(file_name);
+	if (sz > 0 && file_name[sz - 1] == '\n')
+		file_name[sz - 1] = 0x00;
+
+	if (file_name[0]) {
+		file = filp_open(file_name, O_RDONLY|O_LARGEFILE, 0);
+		if (IS_ERR(file)) {
+			err = PTR_ERR(file);
+			goto out;
+		}
+
+		dict_len = i_size_read(file_inode(file));
+		if (!dict_len || dict_len > ZRAM_DICT_MAX) {
+			err = -EINVAL;
+		} else {
+			dict = kvmalloc(dict_len, GFP_KERNEL);
+			if (!dict)
+				err = -ENOMEM;
+			else if (kernel_read(file, dict, dict_len,
+					     &pos) != dict_len)
+				err = -EIO;
+		}
+		fput(file);
+		if (err)
+			goto out;
+	}
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dictionary for initialized device\n");
+		err = -EBUSY;
+		goto out;
+	}
+
+	swap(zram->dict, dict);
+	zram->dict_len = dict_len;
+	up_write(&zram->init_lock);
+out:
+	kvfree(dict);
+	kfree(file_name);
+	return err ? err : len;
+}
+
+static struct zcomp *zram_comp_create(struct zram *zram)
+{
+	return zcomp_create(zram->compressor, zram->dict, zram->dict_len);
+}
+
+static void zram_dict_free(struct zram *zram)
+{
+	kvfree(zram->dict);
+	zram->dict = NULL;
+	zram->dict_len = 0;
+}
+#else
+static struct zcomp *zram_comp_create(struct zram *zram)
+{
+	return zcomp_create(zram->compressor, NULL, 0);
+}
+
+static void zram_dict_free(struct zram *zram) {}
+#endif
+
+#ifdef CONFIG_ZRAM_DEDUP
+static ssize_t use_dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	bool val;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	val = zram->use_dedup;
+	up_read(&zram->init_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", val);
+}
+
+static ssize_t use_dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	bool val;
+	struct zram *zram = dev_to_zram(dev);
+
+	if (kstrtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dedup usage for initialized device\n");
+		return -EBUSY;
+	}
+
+	zram->use_dedup = val;
+	up_write(&zram->init_lock);
+	return len;
+}
+#endif
+
 static ssize_t compact_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
@@ -1079,7 +1433,7 @@ static ssize_t mm_stat_show(struct device *dev,
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
 
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu\n",
+			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu %8llu %8llu\n",
 			orig_size << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.compr_data_size),
 			mem_used << PAGE_SHIFT,
@@ -1088,7 +1442,9 @@ static ssize_t mm_stat_show(struct device *dev,
 			(u64)atomic64_read(&zram->stats.same_pages),
 			atomic_long_read(&pool_stats.pages_compacted),
 			(u64)atomic64_read(&zram->stats.huge_pages),
-			(u64)atomic64_read(&zram->stats.huge_pages_since));
+			(u64)atomic64_read(&zram->stats.huge_pages_since),
+			(u64)atomic64_read(&zram->stats.dup_data_size),
+			(u64)atomic64_read(&zram->stats.meta_data_size));
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1187,6 +1543,9 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (zram_test_flag(zram, index, ZRAM_IDLE))
 		zram_clear_flag(zram, index, ZRAM_IDLE);
 
+	zram_clear_flag(zram, index, ZRAM_RECOMP);
+	zram_clear_flag(zram, index, ZRAM_INCOMPRESSIBLE);
+
 	if (zram_test_flag(zram, index, ZRAM_HUGE)) {
 		zram_clear_flag(zram, index, ZRAM_HUGE);
 		atomic64_dec(&zram->stats.huge_pages);
@@ -1212,6 +1571,12 @@ static void zram_free_page(struct zram *zram, size_t index)
 	if (!handle)
 		return;
 
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		zram_dedup_put(zram, handle, zram_get_obj_size(zram, index));
+		goto out;
+	}
+
 	zs_free(zram->mem_pool, handle);
 
 	atomic64_sub(zram_get_obj_size(zram, index),
@@ -1224,29 +1589,29 @@ static void zram_free_page(struct zram *zram, size_t index)
 		~(1UL << ZRAM_LOCK | 1UL << ZRAM_UNDER_WB));
 }
 
-static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
-				struct bio *bio, bool partial_io)
+static struct zcomp *zram_get_comp(struct zram *zram, u32 index)
 {
-	struct zcomp_strm *zstrm;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram_test_flag(zram, index, ZRAM_RECOMP))
+		return zram->recomp;
+#endif
+	return zram->comp;
+}
+
+/*
+ * Caller should hold the slot lock, and the slot must not be ZRAM_WB. If
+ * @zstrm is NULL, a stream of the slot's compressor is taken if needed;
+ * otherwise it must be a stream of that compressor.
+ */
+static int zram_read_from_zspool(struct zram *zram, struct page *page,
+				 u32 index, struct zcomp_strm *zstrm)
+{
+	struct zcomp *comp = NULL;
 	unsigned long handle;
 	unsigned int size;
 	void *src, *dst;
 	int ret;
 
-	zram_slot_lock(zram, index);
-	if (zram_test_flag(zram, index, ZRAM_WB)) {
-		struct bio_vec bvec;
-
-		zram_slot_unlock(zram, index);
-
-		bvec.bv_page = page;
-		bvec.bv_len = PAGE_SIZE;
-		bvec.bv_offset = 0;
-		return read_from_bdev(zram, &bvec,
-				zram_get_element(zram, index),
-				bio, partial_io);
-	}
-
 	handle = zram_get_handle(zram, index);
 	if (!handle || zram_test_flag(zram, index, ZRAM_SAME)) {
 		unsigned long value;
@@ -1256,14 +1621,14 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		mem = kmap_atomic(page);
 		zram_fill_page(mem, PAGE_SIZE, value);
 		kunmap_atomic(mem);
-		zram_slot_unlock(zram, index);
 		return 0;
 	}
 
 	size = zram_get_obj_size(zram, index);
-
-	if (size != PAGE_SIZE)
-		zstrm = zcomp_stream_get(zram->comp);
+	if (size != PAGE_SIZE && !zstrm) {
+		comp = zram_get_comp(zram, index);
+		zstrm = zcomp_stream_get(comp);
+	}
 
 	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
 	if (size == PAGE_SIZE) {
@@ -1275,9 +1640,34 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		if (comp)
+			zcomp_stream_put(comp);
 	}
 	zs_unmap_object(zram->mem_pool, handle);
+
+	return ret;
+}
+
+static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
+				struct bio *bio, bool partial_io)
+{
+	int ret;
+
+	zram_slot_lock(zram, index);
+	if (zram_test_flag(zram, index, ZRAM_WB)) {
+		struct bio_vec bvec;
+
+		zram_slot_unlock(zram, index);
+
+		bvec.bv_page = page;
+		bvec.bv_len = PAGE_SIZE;
+		bvec.bv_offset = 0;
+		return read_from_bdev(zram, &bvec,
+				zram_get_element(zram, index),
+				bio, partial_io);
+	}
+
+	ret = zram_read_from_zspool(zram, page, index, NULL);
 	zram_slot_unlock(zram, index);
 
 	/* Should NEVER happen. Return bio error if it does. */
@@ -1332,6 +1722,8 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	struct page *page = bvec->bv_page;
 	unsigned long element = 0;
 	enum zram_pageflags flags = 0;
+	unsigned long checksum = 0;
+	bool dedup = false;
 
 	mem = kmap_atomic(page);
 	if (page_same_filled(mem, &element)) {
@@ -1343,6 +1735,15 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	}
 	kunmap_atomic(mem);
 
+	if (zram_dedup_enabled(zram)) {
+		checksum = zram_dedup_checksum(page);
+		handle = zram_dedup_find(zram, page, checksum, &comp_len);
+		if (handle) {
+			dedup = true;
+			goto out;
+		}
+	}
+
 compress_again:
 	zstrm = zcomp_stream_get(zram->comp);
 	src = kmap_atomic(page);
@@ -1409,6 +1810,9 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	zcomp_stream_put(zram->comp);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
+
+	if (zram_dedup_enabled(zram))
+		dedup = zram_dedup_insert(zram, handle, comp_len, checksum);
 out:
 	/*
 	 * Free memory associated with this sector
@@ -1429,6 +1833,8 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	}  else {
 		zram_set_handle(zram, index, handle);
 		zram_set_obj_size(zram, index, comp_len);
+		if (dedup)
+			zram_set_flag(zram, index, ZRAM_DEDUP);
 	}
 	zram_slot_unlock(zram, index);
 
@@ -1549,6 +1955,92 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 	return ret;
 }
 
+/*
+ * Maximum number of pages of a read bio decompressed under one stream
+ * acquisition. This bounds the time spent with preemption disabled.
+ */
+#define ZRAM_READ_BATCH		16
+
+struct zram_read_batch {
+	struct zcomp *comp;
+	struct zcomp_strm *zstrm;
+	unsigned int nr_pages;
+};
+
+static void zram_read_batch_end(struct zram_read_batch *batch)
+{
+	if (batch->zstrm)
+		zcomp_stream_put(batch->comp);
+
+	batch->comp = NULL;
+	batch->zstrm = NULL;
+	batch->nr_pages = 0;
+}
+
+/*
+ * Read a full page of a multi-page bio with the stream kept in @batch,
+ * rather than taking and releasing one per page. Returns -EAGAIN if the page
+ * has to go through zram_bvec_rw() instead, i.e. if it is on the backing
+ * device.
+ */
+static int zram_bvec_read_batched(struct zram *zram, struct page *page,
+				  u32 index, struct zram_read_batch *batch)
+{
+	struct zcomp *comp;
+	int ret;
+
+	if (batch->nr_pages >= ZRAM_READ_BATCH)
+		zram_read_batch_end(batch);
+
+	zram_slot_lock(zram, index);
+	if (zram_test_flag(zram, index, ZRAM_WB)) {
+		zram_slot_unlock(zram, index);
+		return -EAGAIN;
+	}
+
+	comp = zram_get_comp(zram, index);
+	if (batch->comp != comp) {
+		zram_read_batch_end(batch);
+		batch->comp = comp;
+		batch->zstrm = zcomp_stream_get(comp);
+	}
+
+	ret = zram_read_from_zspool(zram, page, index, batch->zstrm);
+	batch->nr_pages++;
+	zram_accessed(zram, index);
+	zram_slot_unlock(zram, index);
+
+	/* Should NEVER happen. Return bio error if it does. */
+	if (WARN_ON(ret))
+		pr_err("Decompression failed! err=%d, page=%u\n", ret, index);
+
+	return ret;
+}
+
+static int zram_bvec_read_rw(struct zram *zram, struct bio_vec *bvec,
+			     u32 index, int offset, struct bio *bio,
+			     struct zram_read_batch *batch)
+{
+	int ret = -EAGAIN;
+
+	if (bvec->bv_len == PAGE_SIZE)
+		ret = zram_bvec_read_batched(zram, bvec->bv_page, index, batch);
+
+	if (ret == -EAGAIN) {
+		/* The slow path may sleep */
+		zram_read_batch_end(batch);
+		return zram_bvec_rw(zram, bvec, index, offset, REQ_OP_READ,
+				    bio);
+	}
+
+	atomic64_inc(&zram->stats.num_reads);
+	flush_dcache_page(bvec->bv_page);
+	if (unlikely(ret < 0))
+		atomic64_inc(&zram->stats.failed_reads);
+
+	return ret;
+}
+
 static void __zram_make_request(struct zram *zram, struct bio *bio)
 {
 	int offset;
@@ -1556,6 +2048,9 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 	struct bio_vec bvec;
 	struct bvec_iter iter;
 	unsigned long start_time;
+	struct zram_read_batch batch = {};
+	bool batched;
+	int ret;
 
 	index = bio->bi_iter.bi_sector >> SECTORS_PER_PAGE_SHIFT;
 	offset = (bio->bi_iter.bi_sector &
@@ -1571,6 +2066,10 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 		break;
 	}
 
+	/* Only multi-page reads benefit from keeping the stream */
+	batched = bio_op(bio) == REQ_OP_READ &&
+		  bio->bi_iter.bi_size > PAGE_SIZE;
+
 	start_time = bio_start_io_acct(bio);
 	bio_for_each_segment(bvec, bio, iter) {
 		struct bio_vec bv = bvec;
@@ -1579,8 +2078,13 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 		do {
 			bv.bv_len = min_t(unsigned int, PAGE_SIZE - offset,
 							unwritten);
-			if (zram_bvec_rw(zram, &bv, index, offset,
-					 bio_op(bio), bio) < 0) {
+			if (batched)
+				ret = zram_bvec_read_rw(zram, &bv, index,
+							offset, bio, &batch);
+			else
+				ret = zram_bvec_rw(zram, &bv, index, offset,
+						   bio_op(bio), bio);
+			if (ret < 0) {
 				bio->bi_status = BLK_STS_IOERR;
 				break;
 			}
@@ -1591,6 +2095,7 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 			update_position(&index, &offset, &bv);
 		} while (unwritten);
 	}
+	zram_read_batch_end(&batch);
 	bio_end_io_acct(bio, start_time);
 	bio_endio(bio);
 }
@@ -1713,6 +2218,7 @@ static void zram_reset_device(struct zram *zram)
 	zram_meta_free(zram, disksize);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(comp);
+	zram_recomp_destroy(zram);
 	reset_bdev(zram);
 }
 
@@ -1741,7 +2247,7 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_unlock;
 	}
 
-	comp = zcomp_create(zram->compressor);
+	comp = zram_comp_create(zram);
 	if (IS_ERR(comp)) {
 		pr_err("Cannot initialise %s compressing backend\n",
 				zram->compressor);
@@ -1749,6 +2255,10 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+	err = zram_recomp_create(zram);
+	if (err)
+		goto out_free_comp;
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity_and_notify(zram->disk, zram->disksize >> SECTOR_SHIFT);
@@ -1756,6 +2266,8 @@ static ssize_t disksize_store(struct device *dev,
 
 	return len;
 
+out_free_comp:
+	zcomp_destroy(comp);
 out_free_meta:
 	zram_meta_free(zram, disksize);
 out_unlock:
@@ -1842,6 +2354,16 @@ static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_WO(idle);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+static DEVICE_ATTR_RW(comp_dict);
+#endif
+#ifdef CONFIG_ZRAM_DEDUP
+static DEVICE_ATTR_RW(use_dedup);
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
 static DEVICE_ATTR_WO(writeback);
@@ -1859,6 +2381,16 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_idle.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+	&dev_attr_comp_dict.attr,
+#endif
+#ifdef CONFIG_ZRAM_DEDUP
+	&dev_attr_use_dedup.attr,
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
 	&dev_attr_writeback.attr,
@@ -1906,6 +2438,7 @@ static int zram_add(void)
 #ifdef CONFIG_ZRAM_WRITEBACK
 	spin_lock_init(&zram->wb_limit_lock);
 #endif
+	zram_dedup_init(zram);
 	queue = blk_alloc_queue(NUMA_NO_NODE);
 	if (!queue) {
 		pr_err("Error allocating disk queue for device %d\n",
@@ -2002,6 +2535,7 @@ static int zram_remove(struct zram *zram)
 	del_gendisk(zram->disk);
 	blk_cleanup_queue(zram->disk->queue);
 	put_disk(zram->disk);
+	zram_dict_free(zram);
 	kfree(zram);
 	return 0;
 }
@@ -2095,6 +2629,8 @@ static int __init zram_init(void)
 {
 	int ret;
 
+	BUILD_BUG_ON(__NR_ZRAM_PAGEFLAGS > BITS_PER_LONG);
+
 	ret = cpuhp_setup_state_multi(CPUHP_ZCOMP_PREPARE, "block/zram:prepare",
 				      zcomp_cpu_up_prepare, zcomp_cpu_dead);
 	if (ret < 0)
@@ -15,6 +15,7 @@
 #ifndef _ZRAM_DRV_H_
 #define _ZRAM_DRV_H_
 
+#include <linux/rbtree.h>
 #include <linux/rwsem.h>
 #include <linux/zsmalloc.h>
 #include <linux/crypto.h>
@@ -27,6 +28,8 @@
 #define ZRAM_LOGICAL_BLOCK_SIZE	(1 << ZRAM_LOGICAL_BLOCK_SHIFT)
 #define ZRAM_SECTOR_PER_LOGICAL_BLOCK	\
 	(1 << (ZRAM_LOGICAL_BLOCK_SHIFT - SECTOR_SHIFT))
+/* zstd dictionaries are typically trained to ~100K, leave some room */
+#define ZRAM_DICT_MAX	(1 << 20)
 
 
 /*
@@ -39,7 +42,7 @@
  * The lower ZRAM_FLAG_SHIFT bits is for object size (excluding header),
  * the higher bits is for zram_pageflags.
  */
-#define ZRAM_FLAG_SHIFT 24
+#define ZRAM_FLAG_SHIFT (PAGE_SHIFT + 1)
 
 /* Flags for zram pages (table[page_no].flags) */
 enum zram_pageflags {
@@ -50,6 +53,9 @@ enum zram_pageflags {
 	ZRAM_UNDER_WB,	/* page is under writeback */
 	ZRAM_HUGE,	/* Incompressible page */
 	ZRAM_IDLE,	/* not accessed page since last idle marking */
+	ZRAM_RECOMP,	/* page is compressed with the secondary algorithm */
+	ZRAM_INCOMPRESSIBLE, /* recompression wouldn't save memory */
+	ZRAM_DEDUP,	/* handle is shared through the dedup index */
 
 	__NR_ZRAM_PAGEFLAGS,
 };
@@ -83,6 +89,8 @@ struct zram_stats {
 	atomic_long_t max_used_pages;	/* no. of maximum pages stored */
 	atomic64_t writestall;		/* no. of write slow paths */
 	atomic64_t miss_free;		/* no. of missed free */
+	atomic64_t dup_data_size;	/* compressed size of deduped pages */
+	atomic64_t meta_data_size;	/* size of the dedup index */
 #ifdef	CONFIG_ZRAM_WRITEBACK
 	atomic64_t bd_count;		/* no. of pages in backing device */
 	atomic64_t bd_reads;		/* no. of reads from backing device */
@@ -94,6 +102,10 @@ struct zram {
 	struct zram_table_entry *table;
 	struct zs_pool *mem_pool;
 	struct zcomp *comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	/* secondary compressor, NULL if recomp_algorithm isn't set */
+	struct zcomp *recomp;
+#endif
 	struct gendisk *disk;
 	/* Prevent concurrent execution of device init */
 	struct rw_semaphore init_lock;
@@ -109,6 +121,14 @@ struct zram {
 	 */
 	u64 disksize;	/* bytes */
 	char compressor[CRYPTO_MAX_ALG_NAME];
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	char recompressor[CRYPTO_MAX_ALG_NAME];
+#endif
+#ifdef CONFIG_ZRAM_ZSTD_DICT
+	/* zstd dictionary loaded from comp_dict, kept across resets */
+	void *dict;
+	size_t dict_len;
+#endif
 	/*
 	 * zram is claimed so open request will be failed
 	 */
@@ -125,5 +145,14 @@ struct zram {
 #ifdef CONFIG_ZRAM_MEMORY_TRACKING
 	struct dentry *debugfs_dir;
 #endif
+#ifdef CONFIG_ZRAM_DEDUP
+	bool use_dedup;
+	/* Protects the two trees of struct zram_dedup_entry */
+	spinlock_t dedup_lock;
+	struct rb_root dedup_by_checksum;
+	struct rb_root dedup_by_handle;
+#endif
 };
+
+#include "zram_dedup.h"
 #endif
@@ -56,28 +56,42 @@ static int ingenic_rng_read(struct hwrng *rng, void *buf, size_t max, bool wait)
 {
 	struct ingenic_rng *priv = container_of(rng, struct ingenic_rng, rng);
 	u32 *data = buf;
+	size_t read = 0;
 	u32 status;
 	int ret;
 
-	if (priv->version >= ID_X1000) {
-		ret = readl_poll_timeout(priv->base + RNG_REG_ERNG_OFFSET, status,
-					 status & ERNG_READY, 10, 1000);
-		if (ret == -ETIMEDOUT) {
-			pr_err("%s: Wait for RNG data ready timeout\n", __func__);
-			return ret;
+	/*
+	 * Fill the whole buffer when the caller can wait, instead of making the
+	 * hwrng core call us again for every word.
+	 */
+	do {
+		if (priv->version >= ID_X1000) {
+			ret = readl_poll_timeout(priv->base + RNG_REG_ERNG_OFFSET,
+						 status, status & ERNG_READY,
+						 10, 1000);
+			if (ret == -ETIMEDOUT) {
+				if (read)
+					break;
+				pr_err("%s: Wait for RNG data ready timeout\n", __func__);
+				return ret;
+			}
+		} else if (read) {
+			/*
+			 * A delay is required so that the current RNG data is not
+			 * bit shifted version of previous RNG data which could
+			 * happen if random data is read continuously from this
+			 * device.
+			 */
+			usleep_range(20, 40);
+		} else {
+			udelay(20);
 		}
-	} else {
-		/*
-		 * A delay is required so that the current RNG data is not bit shifted
-		 * version of previous RNG data which could happen if random data is
-		 * read continuously from this device.
-		 */
-		udelay(20);
-	}
 
-	*data = readl(priv->base + RNG_REG_RNG_OFFSET);
+		*data++ = readl(priv->base + RNG_REG_RNG_OFFSET);
+		read += sizeof(*data);
+	} while (wait && max - read >= sizeof(*data));
 
-	return 4;
+	return read;
 }
 
 static int ingenic_rng_probe(struct platform_device *pdev)
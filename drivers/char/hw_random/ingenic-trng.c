@@ -61,19 +61,33 @@ static int ingenic_trng_read(struct hwrng *rng, void *buf, size_t max, bool wait
 {
 	struct ingenic_trng *trng = container_of(rng, struct ingenic_trng, rng);
 	u32 *data = buf;
+	size_t read = 0;
 	u32 status;
 	int ret;
 
-	ret = readl_poll_timeout(trng->base + TRNG_REG_STATUS_OFFSET, status,
-				 status & STATUS_RANDOM_RDY, 10, 1000);
-	if (ret == -ETIMEDOUT) {
-		pr_err("%s: Wait for DTRNG data ready timeout\n", __func__);
-		return ret;
+	/* Fill as much of the buffer as possible, one word at a time */
+	while (max - read >= sizeof(*data)) {
+		status = readl(trng->base + TRNG_REG_STATUS_OFFSET);
+		if (!(status & STATUS_RANDOM_RDY)) {
+			/* Return what we have rather than waiting for more */
+			if (read || !wait)
+				break;
+
+			ret = readl_poll_timeout(trng->base + TRNG_REG_STATUS_OFFSET,
+						 status, status & STATUS_RANDOM_RDY,
+						 10, 1000);
+			if (ret == -ETIMEDOUT) {
+				pr_err("%s: Wait for DTRNG data ready timeout\n",
+				       __func__);
+				return ret;
+			}
+		}
+
+		*data++ = readl(trng->base + TRNG_REG_RANDOMNUM_OFFSET);
+		read += sizeof(*data);
 	}
 
-	*data = readl(trng->base + TRNG_REG_RANDOMNUM_OFFSET);
-
-	return 4;
+	return read;
 }
 
 static int ingenic_trng_probe(struct platform_device *pdev)
@@ -432,14 +432,11 @@ ingenic_clk_calc_hw_div(const struct ingenic_cgu_clk_info *clk_info,
 }
 
 static unsigned
-ingenic_clk_calc_div(struct clk_hw *hw,
-		     const struct ingenic_cgu_clk_info *clk_info,
-		     unsigned long parent_rate, unsigned long req_rate)
+__ingenic_clk_calc_div(const struct ingenic_cgu_clk_info *clk_info, u8 parent,
+		       unsigned long parent_rate, unsigned long req_rate)
 {
 	unsigned int div, hw_div;
-	u8 parent;
 
-	parent = ingenic_clk_get_parent(hw);
 	if (clk_info->div.bypass_mask & BIT(parent))
 		return 1;
 
@@ -467,6 +464,15 @@ ingenic_clk_calc_div(struct clk_hw *hw,
 	return div;
 }
 
+static unsigned
+ingenic_clk_calc_div(struct clk_hw *hw,
+		     const struct ingenic_cgu_clk_info *clk_info,
+		     unsigned long parent_rate, unsigned long req_rate)
+{
+	return __ingenic_clk_calc_div(clk_info, ingenic_clk_get_parent(hw),
+				      parent_rate, req_rate);
+}
+
 static long
 ingenic_clk_round_rate(struct clk_hw *hw, unsigned long req_rate,
 		       unsigned long *parent_rate)
@@ -485,6 +491,49 @@ ingenic_clk_round_rate(struct clk_hw *hw, unsigned long req_rate,
 	return DIV_ROUND_UP(*parent_rate, div);
 }
 
+static int
+ingenic_clk_determine_rate(struct clk_hw *hw, struct clk_rate_request *req)
+{
+	struct ingenic_clk *ingenic_clk = to_ingenic_clk(hw);
+	const struct ingenic_cgu_clk_info *clk_info = to_clk_info(ingenic_clk);
+	unsigned long parent_rate, rate, best_rate = 0;
+	unsigned long delta, best_delta = ULONG_MAX;
+	struct clk_hw *parent, *best_parent = NULL;
+	unsigned int i, div;
+
+	for (i = 0; i < clk_hw_get_num_parents(hw); i++) {
+		parent = clk_hw_get_parent_by_index(hw, i);
+		if (!parent)
+			continue;
+
+		parent_rate = clk_hw_get_rate(parent);
+		if (!parent_rate)
+			continue;
+
+		div = __ingenic_clk_calc_div(clk_info, i, parent_rate,
+					     req->rate);
+		rate = DIV_ROUND_UP(parent_rate, div);
+		if (rate < req->min_rate || rate > req->max_rate)
+			continue;
+
+		delta = rate > req->rate ? rate - req->rate : req->rate - rate;
+		if (delta < best_delta) {
+			best_parent = parent;
+			best_rate = rate;
+			best_delta = delta;
+		}
+	}
+
+	if (!best_parent)
+		return -EINVAL;
+
+	req->best_parent_hw = best_parent;
+	req->best_parent_rate = clk_hw_get_rate(best_parent);
+	req->rate = best_rate;
+
+	return 0;
+}
+
 static inline int ingenic_clk_check_stable(struct ingenic_cgu *cgu,
 					   const struct ingenic_cgu_clk_info *clk_info)
 {
@@ -504,7 +553,7 @@ ingenic_clk_set_rate(struct clk_hw *hw, unsigned long req_rate,
 	struct ingenic_cgu *cgu = ingenic_clk->cgu;
 	unsigned long rate, flags;
 	unsigned int hw_div, div;
-	u32 reg, mask;
+	u32 reg, orig, mask;
 	int ret = 0;
 
 	if (clk_info->type & CGU_CLK_DIV) {
@@ -520,7 +569,7 @@ ingenic_clk_set_rate(struct clk_hw *hw, unsigned long req_rate,
 			hw_div = ((div / clk_info->div.div) - 1);
 
 		spin_lock_irqsave(&cgu->lock, flags);
-		reg = readl(cgu->base + clk_info->div.reg);
+		reg = orig = readl(cgu->base + clk_info->div.reg);
 
 		/* update the divide */
 		mask = GENMASK(clk_info->div.bits - 1, 0);
@@ -531,6 +580,16 @@ ingenic_clk_set_rate(struct clk_hw *hw, unsigned long req_rate,
 		if (clk_info->div.stop_bit != -1)
 			reg &= ~BIT(clk_info->div.stop_bit);
 
+		/*
+		 * The divider is already programmed; don't go through a change
+		 * cycle, which stalls the clocks sharing the register until
+		 * the busy bit clears.
+		 */
+		if (reg == orig) {
+			spin_unlock_irqrestore(&cgu->lock, flags);
+			return 0;
+		}
+
 		/* set the change enable bit */
 		if (clk_info->div.ce_bit != -1)
 			reg |= BIT(clk_info->div.ce_bit);
@@ -610,6 +669,20 @@ static const struct clk_ops ingenic_clk_ops = {
 	.is_enabled = ingenic_clk_is_enabled,
 };
 
+/* For CGU_CLK_MUX_BEST_RATE clocks, which pick their parent from the rate */
+static const struct clk_ops ingenic_clk_best_rate_ops = {
+	.get_parent = ingenic_clk_get_parent,
+	.set_parent = ingenic_clk_set_parent,
+
+	.recalc_rate = ingenic_clk_recalc_rate,
+	.determine_rate = ingenic_clk_determine_rate,
+	.set_rate = ingenic_clk_set_rate,
+
+	.enable = ingenic_clk_enable,
+	.disable = ingenic_clk_disable,
+	.is_enabled = ingenic_clk_is_enabled,
+};
+
 /*
  * Setup functions.
  */
@@ -719,6 +792,17 @@ static int ingenic_register_clock(struct ingenic_cgu *cgu, unsigned idx)
 			       __func__, caps);
 			goto out;
 		}
+	} else if (caps & CGU_CLK_MUX_BEST_RATE) {
+		clk_init.ops = &ingenic_clk_best_rate_ops;
+
+		if (!(clk_info->type & CGU_CLK_MUX) ||
+		    !(clk_info->type & CGU_CLK_DIV)) {
+			pr_err("%s: best rate clock '%s' needs a mux and a divider\n",
+			       __func__, clk_info->name);
+			goto out;
+		}
+
+		caps &= ~CGU_CLK_MUX_BEST_RATE;
 	} else {
 		clk_init.ops = &ingenic_clk_ops;
 	}
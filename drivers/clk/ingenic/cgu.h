@@ -135,7 +135,9 @@ struct ingenic_cgu_custom_info {
 /**
  * struct ingenic_cgu_clk_info - information about a clock
  * @name: name of the clock
- * @type: a bitmask formed from CGU_CLK_* values
+ * @type: a bitmask formed from CGU_CLK_* values. With CGU_CLK_MUX_BEST_RATE,
+ *        a rate change may switch the mux to whichever parent gives the rate
+ *        closest to the requested one
  * @parents: an array of the indices of potential parents of this clock
  *           within the clock_info array of the CGU, or -1 in entries
  *           which correspond to no valid parent
@@ -159,6 +161,7 @@ struct ingenic_cgu_clk_info {
 		CGU_CLK_DIV		= BIT(5),
 		CGU_CLK_FIXDIV		= BIT(6),
 		CGU_CLK_CUSTOM		= BIT(7),
+		CGU_CLK_MUX_BEST_RATE	= BIT(8),
 	} type;
 
 	int parents[4];
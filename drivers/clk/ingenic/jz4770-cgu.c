@@ -281,7 +281,8 @@ static const struct ingenic_cgu_clk_info jz4770_cgu_clocks[] = {
 		.div = { CGU_REG_PCMCDR, 0, 1, 9, -1, -1, -1 },
 	},
 	[JZ4770_CLK_I2S] = {
-		"i2s", CGU_CLK_DIV | CGU_CLK_GATE | CGU_CLK_MUX,
+		"i2s", CGU_CLK_DIV | CGU_CLK_GATE | CGU_CLK_MUX |
+			CGU_CLK_MUX_BEST_RATE,
 		.parents = { JZ4770_CLK_EXT, -1,
 			JZ4770_CLK_PLL0, JZ4770_CLK_PLL1 },
 		.mux = { CGU_REG_I2SCDR, 30, 2 },
@@ -7,7 +7,9 @@
  */
 
 #include <linux/clk.h>
+#include <linux/clockchips.h>
 #include <linux/clocksource.h>
+#include <linux/interrupt.h>
 #include <linux/mfd/ingenic-tcu.h>
 #include <linux/mfd/syscon.h>
 #include <linux/of.h>
@@ -25,6 +27,7 @@
  * The TCU_REG_OST_CNT{L,R} from <linux/mfd/ingenic-tcu.h> are only for the
  * regmap; these are for use with the __iomem pointer.
  */
+#define OST_REG_DR		0x0
 #define OST_REG_CNTL		0x4
 #define OST_REG_CNTH		0x8
 
@@ -37,6 +40,10 @@ struct ingenic_ost {
 	struct clk *clk;
 
 	struct clocksource cs;
+
+	struct clock_event_device cevt;
+	void __iomem *cnt_reg;
+	bool armed;
 };
 
 static struct ingenic_ost *ingenic_ost;
@@ -63,6 +70,102 @@ static u64 notrace ingenic_ost_clocksource_readh(struct clocksource *cs)
 	return ingenic_ost_read_cnth();
 }
 
+static inline struct ingenic_ost *to_ingenic_ost(struct clock_event_device *evt)
+{
+	return container_of(evt, struct ingenic_ost, cevt);
+}
+
+static int ingenic_ost_cevt_set_state_shutdown(struct clock_event_device *evt)
+{
+	struct ingenic_ost *ost = to_ingenic_ost(evt);
+
+	WRITE_ONCE(ost->armed, false);
+
+	return 0;
+}
+
+static int ingenic_ost_cevt_set_next(unsigned long next,
+				     struct clock_event_device *evt)
+{
+	struct ingenic_ost *ost = to_ingenic_ost(evt);
+	u32 cmp = readl(ost->cnt_reg) + next;
+
+	/*
+	 * The counter is free-running, and the interrupt is raised when it
+	 * matches the compare value.
+	 */
+	writel(cmp, ost->regs + OST_REG_DR);
+	WRITE_ONCE(ost->armed, true);
+
+	/* If the counter already went past the compare value, we missed it. */
+	if ((s32)(cmp - readl(ost->cnt_reg)) <= 0)
+		return -ETIME;
+
+	return 0;
+}
+
+static irqreturn_t ingenic_ost_cevt_cb(int irq, void *dev_id)
+{
+	struct clock_event_device *evt = dev_id;
+	struct ingenic_ost *ost = to_ingenic_ost(evt);
+
+	/*
+	 * The compare value matches again each time the counter wraps around;
+	 * only report the event that was programmed.
+	 */
+	if (!READ_ONCE(ost->armed))
+		return IRQ_HANDLED;
+
+	WRITE_ONCE(ost->armed, false);
+
+	if (evt->event_handler)
+		evt->event_handler(evt);
+
+	return IRQ_HANDLED;
+}
+
+static int __init ingenic_ost_register_cevt(struct platform_device *pdev,
+					    struct ingenic_ost *ost,
+					    unsigned long rate)
+{
+	struct clock_event_device *cevt = &ost->cevt;
+	struct device *dev = &pdev->dev;
+	int irq, err;
+
+	/* The OST interrupt is optional in the devicetree. */
+	irq = platform_get_irq_optional(pdev, 0);
+	if (irq == -ENXIO)
+		return 0;
+	if (irq < 0)
+		return irq;
+
+	err = devm_request_irq(dev, irq, ingenic_ost_cevt_cb, IRQF_TIMER,
+			       "ingenic-ost", cevt);
+	if (err) {
+		dev_err(dev, "Unable to request IRQ: %d\n", err);
+		return err;
+	}
+
+	cevt->name = "ingenic-ost";
+	/* A single global timer, not a per-CPU one */
+	cevt->cpumask = cpu_possible_mask;
+	cevt->features = CLOCK_EVT_FEAT_ONESHOT;
+	cevt->rating = 300;
+	cevt->irq = irq;
+	cevt->set_state_shutdown = ingenic_ost_cevt_set_state_shutdown;
+	cevt->set_state_oneshot_stopped = ingenic_ost_cevt_set_state_shutdown;
+	cevt->set_next_event = ingenic_ost_cevt_set_next;
+
+	/*
+	 * The 32-bit compare register allows much longer idle periods than
+	 * the 16-bit TCU channels. Keep the maximum delta within half of the
+	 * counter's range, so that a missed deadline can be detected.
+	 */
+	clockevents_config_and_register(cevt, rate, 16, 0x7fffffff);
+
+	return 0;
+}
+
 static int __init ingenic_ost_probe(struct platform_device *pdev)
 {
 	const struct ingenic_ost_soc_info *soc_info;
@@ -82,6 +185,7 @@ static int __init ingenic_ost_probe(struct platform_device *pdev)
 		return -ENOMEM;
 
 	ingenic_ost = ost;
+	platform_set_drvdata(pdev, ost);
 
 	ost->regs = devm_platform_ioremap_resource(pdev, 0);
 	if (IS_ERR(ost->regs))
@@ -138,6 +242,15 @@ static int __init ingenic_ost_probe(struct platform_device *pdev)
 	else
 		sched_clock_register(ingenic_ost_read_cnth, 32, rate);
 
+	if (soc_info->is64bit)
+		ost->cnt_reg = ost->regs + OST_REG_CNTL;
+	else
+		ost->cnt_reg = ost->regs + OST_REG_CNTH;
+
+	err = ingenic_ost_register_cevt(pdev, ost, rate);
+	if (err)
+		dev_warn(dev, "Unable to register clockevent: %d\n", err);
+
 	return 0;
 }
 
@@ -115,6 +115,15 @@ static const struct of_device_id blacklist[] __initconst = {
 	{ .compatible = "fsl,imx8mn", },
 	{ .compatible = "fsl,imx8mp", },
 
+	{ .compatible = "ingenic,jz4725b", },
+	{ .compatible = "ingenic,jz4740", },
+	{ .compatible = "ingenic,jz4760", },
+	{ .compatible = "ingenic,jz4760b", },
+	{ .compatible = "ingenic,jz4770", },
+	{ .compatible = "ingenic,jz4780", },
+	{ .compatible = "ingenic,x1000", },
+	{ .compatible = "ingenic,x1830", },
+
 	{ .compatible = "marvell,armadaxp", },
 
 	{ .compatible = "mediatek,mt2701", },
@@ -14,7 +14,10 @@
 #define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
 
 #include <linux/export.h>
+#include <linux/input.h>
 #include <linux/kernel_stat.h>
+#include <linux/sched.h>
+#include <linux/sched/clock.h>
 #include <linux/slab.h>
 
 #include "cpufreq_governor.h"
@@ -118,6 +121,7 @@ unsigned int dbs_update(struct cpufreq_policy *policy)
 	unsigned int ignore_nice = dbs_data->ignore_nice_load;
 	unsigned int max_load = 0, idle_periods = UINT_MAX;
 	unsigned int sampling_rate, io_busy, j;
+	unsigned int uclamp_min = 0;
 
 	/*
 	 * Sometimes governors may use an additional multiplier to increase
@@ -221,14 +225,175 @@ unsigned int dbs_update(struct cpufreq_policy *policy)
 
 		if (load > max_load)
 			max_load = load;
+
+		uclamp_min = max(uclamp_min, READ_ONCE(j_cdbs->uclamp_min));
+		WRITE_ONCE(j_cdbs->uclamp_min, 0);
 	}
 
 	policy_dbs->idle_periods = idle_periods;
 
+	/*
+	 * Tasks with a utilization floor ran during the interval: report at
+	 * least the matching load, so that a cgroup with cpu.uclamp.min set to
+	 * the maximum gets the maximum frequency whatever the load.
+	 */
+	if (dbs_data->uclamp_boost)
+		max_load = max(max_load, uclamp_min * 100 / SCHED_CAPACITY_SCALE);
+
 	return max_load;
 }
 EXPORT_SYMBOL_GPL(dbs_update);
 
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+/* local_clock() of the last key or axis event */
+static u64 dbs_input_boost_time;
+
+/* Number of dbs_data with a nonzero input_boost_duration */
+static DEFINE_MUTEX(dbs_input_mutex);
+static unsigned int dbs_input_users;
+
+static void dbs_input_event(struct input_handle *handle, unsigned int type,
+			    unsigned int code, int value)
+{
+	if (type == EV_KEY || type == EV_ABS)
+		WRITE_ONCE(dbs_input_boost_time, local_clock());
+}
+
+static int dbs_input_connect(struct input_handler *handler,
+			     struct input_dev *dev,
+			     const struct input_device_id *id)
+{
+	struct input_handle *handle;
+	int error;
+
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = "cpufreq_dbs";
+
+	error = input_register_handle(handle);
+	if (error)
+		goto err_free_handle;
+
+	error = input_open_device(handle);
+	if (error)
+		goto err_unregister_handle;
+
+	return 0;
+
+err_unregister_handle:
+	input_unregister_handle(handle);
+err_free_handle:
+	kfree(handle);
+	return error;
+}
+
+static void dbs_input_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+static const struct input_device_id dbs_input_ids[] = {
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT,
+		.evbit = { BIT_MASK(EV_KEY) },
+	},
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT,
+		.evbit = { BIT_MASK(EV_ABS) },
+	},
+	{ },
+};
+
+static struct input_handler dbs_input_handler = {
+	.event		= dbs_input_event,
+	.connect	= dbs_input_connect,
+	.disconnect	= dbs_input_disconnect,
+	.name		= "cpufreq_dbs",
+	.id_table	= dbs_input_ids,
+};
+
+/* Called with dbs_input_mutex held */
+static void dbs_input_get(void)
+{
+	int ret;
+
+	if (dbs_input_users++)
+		return;
+
+	ret = input_register_handler(&dbs_input_handler);
+	if (ret) {
+		pr_warn("Unable to register input handler: %d\n", ret);
+		dbs_input_users = 0;
+	}
+}
+
+/* Called with dbs_input_mutex held */
+static void dbs_input_put(void)
+{
+	if (dbs_input_users && !--dbs_input_users)
+		input_unregister_handler(&dbs_input_handler);
+}
+
+/*
+ * Set the input boost duration of @dbs_data. The input handler, which opens
+ * every input device, is only registered while a duration is nonzero, so that
+ * input events don't reach the governor for nothing.
+ */
+void dbs_input_boost_set(struct dbs_data *dbs_data, unsigned int duration)
+{
+	mutex_lock(&dbs_input_mutex);
+
+	if (duration && !dbs_data->input_boost_duration)
+		dbs_input_get();
+	else if (!duration && dbs_data->input_boost_duration)
+		dbs_input_put();
+
+	dbs_data->input_boost_duration = duration;
+
+	mutex_unlock(&dbs_input_mutex);
+}
+EXPORT_SYMBOL_GPL(dbs_input_boost_set);
+
+/* Whether an input event happened since the last sample of the policy */
+static bool dbs_input_boost_pending(struct policy_dbs_info *policy_dbs)
+{
+	return policy_dbs->dbs_data->input_boost_duration &&
+	       READ_ONCE(dbs_input_boost_time) != policy_dbs->input_boost_time;
+}
+
+/*
+ * Frequency to run at least at, or 0, if the last input event was less than
+ * input_boost_duration ago.
+ */
+unsigned int dbs_input_boost_freq(struct cpufreq_policy *policy)
+{
+	struct policy_dbs_info *policy_dbs = policy->governor_data;
+	struct dbs_data *dbs_data = policy_dbs->dbs_data;
+	u64 boost_time = READ_ONCE(dbs_input_boost_time);
+
+	if (!dbs_data->input_boost_duration || !boost_time)
+		return 0;
+
+	if ((s64)(local_clock() - boost_time) >
+	    (s64)dbs_data->input_boost_duration * NSEC_PER_USEC)
+		return 0;
+
+	return dbs_data->input_boost_freq ? : policy->max;
+}
+EXPORT_SYMBOL_GPL(dbs_input_boost_freq);
+#else
+static inline bool dbs_input_boost_pending(struct policy_dbs_info *policy_dbs)
+{
+	return false;
+}
+#endif /* CONFIG_CPU_FREQ_GOV_INPUT_BOOST */
+
 static void dbs_work_handler(struct work_struct *work)
 {
 	struct policy_dbs_info *policy_dbs;
@@ -266,6 +431,21 @@ static void dbs_irq_work(struct irq_work *irq_work)
 	schedule_work_on(smp_processor_id(), &policy_dbs->work);
 }
 
+/*
+ * The hook runs on the CPU of the updated runqueue, with the task running
+ * there as current most of the time, which is good enough to notice the
+ * tasks that want a higher frequency over a sampling interval.
+ */
+static void dbs_update_uclamp(struct cpu_dbs_info *cdbs)
+{
+#ifdef CONFIG_UCLAMP_TASK
+	struct uclamp_se *uc_se = &current->uclamp[UCLAMP_MIN];
+
+	if (uc_se->active && uc_se->value > READ_ONCE(cdbs->uclamp_min))
+		WRITE_ONCE(cdbs->uclamp_min, uc_se->value);
+#endif
+}
+
 static void dbs_update_util_handler(struct update_util_data *data, u64 time,
 				    unsigned int flags)
 {
@@ -273,6 +453,9 @@ static void dbs_update_util_handler(struct update_util_data *data, u64 time,
 	struct policy_dbs_info *policy_dbs = cdbs->policy_dbs;
 	u64 delta_ns, lst;
 
+	if (policy_dbs->dbs_data->uclamp_boost)
+		dbs_update_uclamp(cdbs);
+
 	if (!cpufreq_this_cpu_can_update(policy_dbs->policy))
 		return;
 
@@ -292,7 +475,9 @@ static void dbs_update_util_handler(struct update_util_data *data, u64 time,
 	smp_rmb();
 	lst = READ_ONCE(policy_dbs->last_sample_time);
 	delta_ns = time - lst;
-	if ((s64)delta_ns < policy_dbs->sample_delay_ns)
+	/* Don't wait for the end of the period to react to an input event */
+	if ((s64)delta_ns < policy_dbs->sample_delay_ns &&
+	    !dbs_input_boost_pending(policy_dbs))
 		return;
 
 	/*
@@ -314,6 +499,9 @@ static void dbs_update_util_handler(struct update_util_data *data, u64 time,
 		}
 	}
 
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+	policy_dbs->input_boost_time = READ_ONCE(dbs_input_boost_time);
+#endif
 	policy_dbs->last_sample_time = time;
 	policy_dbs->work_in_progress = true;
 	irq_work_queue(&policy_dbs->irq_work);
@@ -393,6 +581,7 @@ int cpufreq_dbs_governor_init(struct cpufreq_policy *policy)
 	struct dbs_governor *gov = dbs_governor_of(policy);
 	struct dbs_data *dbs_data;
 	struct policy_dbs_info *policy_dbs;
+	unsigned int duration;
 	int ret = 0;
 
 	/* State should be equivalent to EXIT */
@@ -431,6 +620,11 @@ int cpufreq_dbs_governor_init(struct cpufreq_policy *policy)
 	if (ret)
 		goto free_policy_dbs_info;
 
+	/* Take the input handler if gov->init() set a boost duration */
+	duration = dbs_data->input_boost_duration;
+	dbs_data->input_boost_duration = 0;
+	dbs_input_boost_set(dbs_data, duration);
+
 	/*
 	 * The sampling interval should not be less than the transition latency
 	 * of the CPU and it also cannot be too small for dbs_update() to work
@@ -462,6 +656,7 @@ int cpufreq_dbs_governor_init(struct cpufreq_policy *policy)
 
 	if (!have_governor_per_policy())
 		gov->gdbs_data = NULL;
+	dbs_input_boost_set(dbs_data, 0);
 	gov->exit(dbs_data);
 	kfree(dbs_data);
 
@@ -492,6 +687,7 @@ void cpufreq_dbs_governor_exit(struct cpufreq_policy *policy)
 		if (!have_governor_per_policy())
 			gov->gdbs_data = NULL;
 
+		dbs_input_boost_set(dbs_data, 0);
 		gov->exit(dbs_data);
 		kfree(dbs_data);
 	}
@@ -43,6 +43,9 @@ struct dbs_data {
 	unsigned int sampling_down_factor;
 	unsigned int up_threshold;
 	unsigned int io_is_busy;
+	unsigned int uclamp_boost;
+	unsigned int input_boost_duration;
+	unsigned int input_boost_freq;
 };
 
 static inline struct dbs_data *to_dbs_data(struct gov_attr_set *attr_set)
@@ -95,6 +98,7 @@ struct policy_dbs_info {
 	/* Multiplier for increasing sample delay temporarily. */
 	unsigned int rate_mult;
 	unsigned int idle_periods;	/* For conservative */
+	u64 input_boost_time;	/* Last input event seen by the hook */
 	/* Status indicators */
 	bool is_shared;		/* This object is used by multiple CPUs */
 	bool work_in_progress;	/* Work is being queued up or in progress */
@@ -118,6 +122,11 @@ struct cpu_dbs_info {
 	 * wake-up from idle.
 	 */
 	unsigned int prev_load;
+	/*
+	 * Highest utilization floor (uclamp.min of the task or its cgroup)
+	 * seen on this CPU since the last sample, if uclamp_boost is set.
+	 */
+	unsigned int uclamp_min;
 	struct update_util_data update_util;
 	struct policy_dbs_info *policy_dbs;
 };
@@ -179,4 +188,20 @@ void od_unregister_powersave_bias_handler(void);
 ssize_t store_sampling_rate(struct gov_attr_set *attr_set, const char *buf,
 			    size_t count);
 void gov_update_cpu_data(struct dbs_data *dbs_data);
+
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+void dbs_input_boost_set(struct dbs_data *dbs_data, unsigned int duration);
+unsigned int dbs_input_boost_freq(struct cpufreq_policy *policy);
+#else
+static inline void dbs_input_boost_set(struct dbs_data *dbs_data,
+				       unsigned int duration)
+{
+	dbs_data->input_boost_duration = duration;
+}
+
+static inline unsigned int dbs_input_boost_freq(struct cpufreq_policy *policy)
+{
+	return 0;
+}
+#endif
 #endif /* _CPUFREQ_GOVERNOR_H */
@@ -25,6 +25,7 @@
 #define MICRO_FREQUENCY_MIN_SAMPLE_RATE		(10000)
 #define MIN_FREQUENCY_UP_THRESHOLD		(1)
 #define MAX_FREQUENCY_UP_THRESHOLD		(100)
+#define DEF_INPUT_BOOST_DURATION		(100000)
 
 static struct od_ops od_ops;
 
@@ -155,6 +156,9 @@ static void od_update(struct cpufreq_policy *policy)
 		max_f = policy->cpuinfo.max_freq;
 		freq_next = min_f + load * (max_f - min_f) / 100;
 
+		/* Still within the boost window of an input event */
+		freq_next = max(freq_next, dbs_input_boost_freq(policy));
+
 		/* No longer fully busy, reset rate_mult */
 		policy_dbs->rate_mult = 1;
 
@@ -288,6 +292,57 @@ static ssize_t store_ignore_nice_load(struct gov_attr_set *attr_set,
 	return count;
 }
 
+static ssize_t store_uclamp_boost(struct gov_attr_set *attr_set,
+				  const char *buf, size_t count)
+{
+	struct dbs_data *dbs_data = to_dbs_data(attr_set);
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%u", &input);
+	if (ret != 1)
+		return -EINVAL;
+
+	dbs_data->uclamp_boost = !!input;
+
+	return count;
+}
+
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+static ssize_t store_input_boost_duration(struct gov_attr_set *attr_set,
+					  const char *buf, size_t count)
+{
+	struct dbs_data *dbs_data = to_dbs_data(attr_set);
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%u", &input);
+	if (ret != 1)
+		return -EINVAL;
+
+	dbs_input_boost_set(dbs_data, input);
+
+	return count;
+}
+
+static ssize_t store_input_boost_freq(struct gov_attr_set *attr_set,
+				      const char *buf, size_t count)
+{
+	struct dbs_data *dbs_data = to_dbs_data(attr_set);
+	unsigned int input;
+	int ret;
+
+	ret = sscanf(buf, "%u", &input);
+	if (ret != 1)
+		return -EINVAL;
+
+	/* 0 boosts to the maximum frequency of the policy */
+	dbs_data->input_boost_freq = input;
+
+	return count;
+}
+#endif
+
 static ssize_t store_powersave_bias(struct gov_attr_set *attr_set,
 				    const char *buf, size_t count)
 {
@@ -317,6 +372,11 @@ gov_show_one_common(up_threshold);
 gov_show_one_common(sampling_down_factor);
 gov_show_one_common(ignore_nice_load);
 gov_show_one_common(io_is_busy);
+gov_show_one_common(uclamp_boost);
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+gov_show_one_common(input_boost_duration);
+gov_show_one_common(input_boost_freq);
+#endif
 gov_show_one(od, powersave_bias);
 
 gov_attr_rw(sampling_rate);
@@ -324,6 +384,11 @@ gov_attr_rw(io_is_busy);
 gov_attr_rw(up_threshold);
 gov_attr_rw(sampling_down_factor);
 gov_attr_rw(ignore_nice_load);
+gov_attr_rw(uclamp_boost);
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+gov_attr_rw(input_boost_duration);
+gov_attr_rw(input_boost_freq);
+#endif
 gov_attr_rw(powersave_bias);
 
 static struct attribute *od_attributes[] = {
@@ -333,6 +398,11 @@ static struct attribute *od_attributes[] = {
 	&ignore_nice_load.attr,
 	&powersave_bias.attr,
 	&io_is_busy.attr,
+	&uclamp_boost.attr,
+#ifdef CONFIG_CPU_FREQ_GOV_INPUT_BOOST
+	&input_boost_duration.attr,
+	&input_boost_freq.attr,
+#endif
 	NULL
 };
 
@@ -375,6 +445,7 @@ static int od_init(struct dbs_data *dbs_data)
 	dbs_data->ignore_nice_load = 0;
 	tuners->powersave_bias = default_powersave_bias;
 	dbs_data->io_is_busy = should_io_be_busy();
+	dbs_data->input_boost_duration = DEF_INPUT_BOOST_DURATION;
 
 	dbs_data->tuners = tuners;
 	return 0;
@@ -0,0 +1,391 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * CPU frequency scaling for Ingenic SoCs
+ *
+ * The CPU clock of the Ingenic SoCs is a divider of the main PLL. Retuning
+ * the PLL requires waiting for it to relock, and changes the rate of every
+ * other clock derived from it; switching the divider on the other hand is
+ * glitch-free and takes effect within a few cycles. This driver only
+ * exposes the OPPs that can be reached by changing the divider, so that
+ * frequency transitions are cheap enough for the governors to follow
+ * bursty loads closely.
+ *
+ * The power drawn by the core at each OPP, measured on the board, can be
+ * given in the opp-microwatt property of the OPP nodes; it is then
+ * registered in the energy model, for the thermal framework and the
+ * scheduler to use.
+ */
+
+#include <linux/clk.h>
+#include <linux/cpu.h>
+#include <linux/cpufreq.h>
+#include <linux/energy_model.h>
+#include <linux/err.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/of_device.h>
+#include <linux/platform_device.h>
+#include <linux/pm_opp.h>
+
+#include <asm/cpu-info.h>
+
+/* Number of round trips used to measure the transition latency */
+#define INGENIC_CPUFREQ_LATENCY_LOOPS	4
+
+struct ingenic_cpufreq {
+	struct device *cpu_dev;
+	struct clk *clk;
+	unsigned int latency_ns;
+};
+
+static struct ingenic_cpufreq ingenic_cpufreq;
+
+static int ingenic_cpufreq_notifier(struct notifier_block *nb,
+				    unsigned long val, void *data)
+{
+	if (val == CPUFREQ_POSTCHANGE)
+		current_cpu_data.udelay_val = loops_per_jiffy;
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block ingenic_cpufreq_notifier_block = {
+	.notifier_call = ingenic_cpufreq_notifier,
+};
+
+static int ingenic_cpufreq_target(struct cpufreq_policy *policy,
+				  unsigned int index)
+{
+	unsigned long rate = policy->freq_table[index].frequency * 1000UL;
+
+	return clk_set_rate(policy->clk, rate);
+}
+
+/*
+ * Disable the OPPs that cannot be obtained from the current PLL rate with
+ * the CPU divider alone. The CGU's divider clocks do not propagate rate
+ * changes to their parent, so clk_round_rate() tells us exactly which rates
+ * are reachable without touching the PLL.
+ */
+static int ingenic_cpufreq_filter_opps(struct ingenic_cpufreq *cpufreq)
+{
+	struct device *cpu_dev = cpufreq->cpu_dev;
+	unsigned long freq = 0;
+	struct dev_pm_opp *opp;
+	int count = 0;
+	long rate;
+
+	for (;; freq++) {
+		opp = dev_pm_opp_find_freq_ceil(cpu_dev, &freq);
+		if (IS_ERR(opp))
+			break;
+
+		dev_pm_opp_put(opp);
+
+		rate = clk_round_rate(cpufreq->clk, freq);
+		if (rate != freq) {
+			dev_dbg(cpu_dev, "Disabling OPP %lu Hz, needs PLL change\n",
+				freq);
+			dev_pm_opp_disable(cpu_dev, freq);
+			continue;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+/*
+ * Measure how long a transition takes, by going back and forth between the
+ * current and the lowest frequencies. The value from the device tree, if
+ * any, is used as a lower bound.
+ */
+static unsigned int ingenic_cpufreq_measure_latency(struct ingenic_cpufreq *cpufreq,
+						    struct cpufreq_policy *policy)
+{
+	unsigned long cur = clk_get_rate(cpufreq->clk);
+	unsigned long low = policy->freq_table[0].frequency * 1000UL;
+	unsigned int latency = dev_pm_opp_get_max_clock_latency(cpufreq->cpu_dev);
+	ktime_t start;
+	s64 delta;
+	int i, ret;
+
+	if (low == cur)
+		return latency ?: CPUFREQ_ETERNAL;
+
+	start = ktime_get();
+
+	for (i = 0; i < INGENIC_CPUFREQ_LATENCY_LOOPS; i++) {
+		ret = clk_set_rate(cpufreq->clk, low);
+		if (!ret)
+			ret = clk_set_rate(cpufreq->clk, cur);
+		if (ret) {
+			dev_warn(cpufreq->cpu_dev,
+				 "Unable to measure transition latency: %d\n",
+				 ret);
+			return latency ?: CPUFREQ_ETERNAL;
+		}
+	}
+
+	delta = ktime_to_ns(ktime_sub(ktime_get(), start));
+	delta = div_s64(delta, 2 * INGENIC_CPUFREQ_LATENCY_LOOPS);
+
+	dev_dbg(cpufreq->cpu_dev, "Transition latency: %lld ns\n", delta);
+
+	return max_t(unsigned int, latency, delta);
+}
+
+/*
+ * Return the power of the lowest OPP at or above *freq (in kHz), from the
+ * opp-microwatt property of its node.
+ */
+static int ingenic_cpufreq_active_power(unsigned long *power,
+					unsigned long *freq,
+					struct device *cpu_dev)
+{
+	unsigned long freq_hz = *freq * 1000;
+	struct device_node *np;
+	struct dev_pm_opp *opp;
+	u32 uw;
+	int ret;
+
+	opp = dev_pm_opp_find_freq_ceil(cpu_dev, &freq_hz);
+	if (IS_ERR(opp))
+		return PTR_ERR(opp);
+
+	np = dev_pm_opp_get_of_node(opp);
+	dev_pm_opp_put(opp);
+
+	ret = of_property_read_u32(np, "opp-microwatt", &uw);
+	of_node_put(np);
+	if (ret)
+		return ret;
+
+	*power = DIV_ROUND_UP(uw, 1000);
+	*freq = freq_hz / 1000;
+
+	return 0;
+}
+
+static void ingenic_cpufreq_register_em(struct ingenic_cpufreq *cpufreq,
+					struct cpufreq_policy *policy)
+{
+	struct em_data_callback em_cb = EM_DATA_CB(ingenic_cpufreq_active_power);
+	struct device *cpu_dev = cpufreq->cpu_dev;
+	struct device_node *np;
+	struct dev_pm_opp *opp;
+	unsigned long freq = 0;
+	bool measured;
+	int nr_opps, ret;
+
+	nr_opps = dev_pm_opp_get_opp_count(cpu_dev);
+	if (nr_opps <= 0)
+		return;
+
+	/* Use the measured power if given for the first OPP */
+	opp = dev_pm_opp_find_freq_ceil(cpu_dev, &freq);
+	if (IS_ERR(opp))
+		return;
+
+	np = dev_pm_opp_get_of_node(opp);
+	dev_pm_opp_put(opp);
+	measured = of_property_read_bool(np, "opp-microwatt");
+	of_node_put(np);
+
+	if (measured)
+		ret = em_dev_register_perf_domain(cpu_dev, nr_opps, &em_cb,
+						  policy->cpus, true);
+	else
+		/* Estimate it from the dynamic-power-coefficient otherwise */
+		ret = dev_pm_opp_of_register_em(cpu_dev, policy->cpus);
+
+	if (ret)
+		dev_dbg(cpu_dev, "No energy model registered: %d\n", ret);
+}
+
+static int ingenic_cpufreq_init(struct cpufreq_policy *policy)
+{
+	struct ingenic_cpufreq *cpufreq = &ingenic_cpufreq;
+	struct cpufreq_frequency_table *freq_table;
+	int ret;
+
+	ret = dev_pm_opp_init_cpufreq_table(cpufreq->cpu_dev, &freq_table);
+	if (ret) {
+		dev_err(cpufreq->cpu_dev, "Failed to init cpufreq table: %d\n",
+			ret);
+		return ret;
+	}
+
+	policy->clk = cpufreq->clk;
+	policy->freq_table = freq_table;
+
+	if (!cpufreq->latency_ns)
+		cpufreq->latency_ns = ingenic_cpufreq_measure_latency(cpufreq,
+								      policy);
+
+	policy->cpuinfo.transition_latency = cpufreq->latency_ns;
+
+	if (IS_ENABLED(CONFIG_ENERGY_MODEL))
+		ingenic_cpufreq_register_em(cpufreq, policy);
+
+	return 0;
+}
+
+static int ingenic_cpufreq_exit(struct cpufreq_policy *policy)
+{
+	em_dev_unregister_perf_domain(ingenic_cpufreq.cpu_dev);
+	dev_pm_opp_free_cpufreq_table(ingenic_cpufreq.cpu_dev,
+				      &policy->freq_table);
+
+	return 0;
+}
+
+static struct cpufreq_driver ingenic_cpufreq_driver = {
+	.name		= "ingenic-cpufreq",
+	.flags		= CPUFREQ_NEED_INITIAL_FREQ_CHECK,
+	.verify		= cpufreq_generic_frequency_table_verify,
+	.target_index	= ingenic_cpufreq_target,
+	.get		= cpufreq_generic_get,
+	.init		= ingenic_cpufreq_init,
+	.exit		= ingenic_cpufreq_exit,
+	.attr		= cpufreq_generic_attr,
+};
+
+static int ingenic_cpufreq_probe(struct platform_device *pdev)
+{
+	struct ingenic_cpufreq *cpufreq = &ingenic_cpufreq;
+	struct device *cpu_dev;
+	int ret;
+
+	cpu_dev = get_cpu_device(0);
+	if (!cpu_dev)
+		return -ENODEV;
+
+	cpufreq->cpu_dev = cpu_dev;
+
+	cpufreq->clk = clk_get(cpu_dev, NULL);
+	if (IS_ERR(cpufreq->clk))
+		return dev_err_probe(&pdev->dev, PTR_ERR(cpufreq->clk),
+				     "Unable to get CPU clock\n");
+
+	ret = dev_pm_opp_of_add_table(cpu_dev);
+	if (ret) {
+		dev_err(&pdev->dev, "Unable to add OPP table: %d\n", ret);
+		goto err_put_clk;
+	}
+
+	if (ingenic_cpufreq_filter_opps(cpufreq) < 2) {
+		dev_err(&pdev->dev, "Not enough usable OPPs\n");
+		ret = -ENODEV;
+		goto err_remove_table;
+	}
+
+	ret = cpufreq_register_driver(&ingenic_cpufreq_driver);
+	if (ret) {
+		dev_err(&pdev->dev, "Failed to register driver: %d\n", ret);
+		goto err_remove_table;
+	}
+
+	ret = cpufreq_register_notifier(&ingenic_cpufreq_notifier_block,
+					CPUFREQ_TRANSITION_NOTIFIER);
+	if (ret) {
+		dev_err(&pdev->dev, "Failed to register notifier: %d\n", ret);
+		goto err_unregister_driver;
+	}
+
+	return 0;
+
+err_unregister_driver:
+	cpufreq_unregister_driver(&ingenic_cpufreq_driver);
+err_remove_table:
+	dev_pm_opp_of_remove_table(cpu_dev);
+err_put_clk:
+	clk_put(cpufreq->clk);
+	return ret;
+}
+
+static int ingenic_cpufreq_remove(struct platform_device *pdev)
+{
+	struct ingenic_cpufreq *cpufreq = &ingenic_cpufreq;
+
+	cpufreq_unregister_notifier(&ingenic_cpufreq_notifier_block,
+				    CPUFREQ_TRANSITION_NOTIFIER);
+	cpufreq_unregister_driver(&ingenic_cpufreq_driver);
+	dev_pm_opp_of_remove_table(cpufreq->cpu_dev);
+	clk_put(cpufreq->clk);
+
+	return 0;
+}
+
+static struct platform_driver ingenic_cpufreq_platdrv = {
+	.probe	= ingenic_cpufreq_probe,
+	.remove	= ingenic_cpufreq_remove,
+	.driver	= {
+		.name	= "ingenic-cpufreq",
+	},
+};
+
+static const struct of_device_id ingenic_cpufreq_machines[] __initconst = {
+	{ .compatible = "ingenic,jz4725b", },
+	{ .compatible = "ingenic,jz4740", },
+	{ .compatible = "ingenic,jz4760", },
+	{ .compatible = "ingenic,jz4760b", },
+	{ .compatible = "ingenic,jz4770", },
+	{ .compatible = "ingenic,jz4780", },
+	{ .compatible = "ingenic,x1000", },
+	{ .compatible = "ingenic,x1830", },
+	{ /* sentinel */ }
+};
+
+static struct platform_device *ingenic_cpufreq_pdev;
+
+static int __init ingenic_cpufreq_module_init(void)
+{
+	struct device_node *np, *cpu_np;
+	bool has_opps;
+	int ret;
+
+	np = of_find_node_by_path("/");
+	if (!np)
+		return -ENODEV;
+
+	if (!of_match_node(ingenic_cpufreq_machines, np)) {
+		of_node_put(np);
+		return -ENODEV;
+	}
+	of_node_put(np);
+
+	/* Only probe if the CPU node describes its operating points */
+	cpu_np = of_cpu_device_node_get(0);
+	has_opps = !!of_get_property(cpu_np, "operating-points-v2", NULL);
+	of_node_put(cpu_np);
+
+	if (!has_opps)
+		return -ENODEV;
+
+	ret = platform_driver_register(&ingenic_cpufreq_platdrv);
+	if (ret)
+		return ret;
+
+	ingenic_cpufreq_pdev = platform_device_register_simple("ingenic-cpufreq",
+							       -1, NULL, 0);
+	if (IS_ERR(ingenic_cpufreq_pdev)) {
+		platform_driver_unregister(&ingenic_cpufreq_platdrv);
+		return PTR_ERR(ingenic_cpufreq_pdev);
+	}
+
+	return 0;
+}
+module_init(ingenic_cpufreq_module_init);
+
+static void __exit ingenic_cpufreq_module_exit(void)
+{
+	platform_device_unregister(ingenic_cpufreq_pdev);
+	platform_driver_unregister(&ingenic_cpufreq_platdrv);
+}
+module_exit(ingenic_cpufreq_module_exit);
+
+MODULE_DESCRIPTION("Ingenic CPUFreq driver");
+MODULE_LICENSE("GPL");
@@ -10,11 +10,13 @@
 
 #include <linux/kernel.h>
 #include <linux/cpuidle.h>
+#include <linux/interrupt.h>
 #include <linux/time.h>
 #include <linux/ktime.h>
 #include <linux/hrtimer.h>
 #include <linux/tick.h>
 #include <linux/sched.h>
+#include <linux/sched/clock.h>
 #include <linux/sched/loadavg.h>
 #include <linux/sched/stat.h>
 #include <linux/math64.h>
@@ -272,6 +274,9 @@ static int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 	u64 interactivity_req;
 	unsigned long nr_iowaiters;
 	ktime_t delta, delta_tick;
+#ifdef CONFIG_CPU_IDLE_GOV_MENU_IRQ_TIMINGS
+	u64 now, next_irq;
+#endif
 	int i, idx;
 
 	if (data->needs_update) {
@@ -335,6 +340,17 @@ static int menu_select(struct cpuidle_driver *drv, struct cpuidle_device *dev,
 			latency_req = interactivity_req;
 	}
 
+#ifdef CONFIG_CPU_IDLE_GOV_MENU_IRQ_TIMINGS
+	/*
+	 * Periodic device interrupts are not timer events, but they can be
+	 * predicted from their past occurrences.
+	 */
+	now = local_clock();
+	next_irq = irq_timings_next_event(now);
+	if (next_irq != U64_MAX && next_irq - now < predicted_ns)
+		predicted_ns = next_irq - now;
+#endif
+
 	/*
 	 * Find the idle state with the lowest power while satisfying
 	 * our constraints.
@@ -573,6 +589,10 @@ static struct cpuidle_governor menu_governor = {
  */
 static int __init init_menu(void)
 {
+#ifdef CONFIG_CPU_IDLE_GOV_MENU_IRQ_TIMINGS
+	irq_timings_enable();
+#endif
+
 	return cpuidle_register_governor(&menu_governor);
 }
 
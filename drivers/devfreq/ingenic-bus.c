@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Bus frequency scaling driver for Ingenic SoCs
+ *
+ * The rate of the memory and AHB bus clocks only has to cover the bandwidth
+ * that the DMA masters (LCD controller, IPU, MMC...) actually need. This
+ * driver registers a devfreq device for one such bus clock, and an
+ * interconnect provider through which the drivers of those masters vote for
+ * the bandwidth they need. The devfreq device runs the powersave governor,
+ * so that the clock runs at the lowest OPP that satisfies all the votes.
+ *
+ * Consumers point their "interconnects" property to the masters node of the
+ * provider, and the memory node of the provider; see
+ * <dt-bindings/interconnect/ingenic,bus.h>.
+ */
+
+#include <dt-bindings/interconnect/ingenic,bus.h>
+
+#include <linux/clk.h>
+#include <linux/devfreq.h>
+#include <linux/device.h>
+#include <linux/idr.h>
+#include <linux/interconnect-provider.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/pm_opp.h>
+#include <linux/pm_qos.h>
+
+/* Bus width in bytes, when not specified in the device tree */
+#define INGENIC_BUS_DEFAULT_WIDTH	4
+
+/*
+ * Maximum bus load, in percent. The bus is shared, and the masters are
+ * bursty; keep some margin so that the LCD controller does not underrun.
+ */
+#define INGENIC_BUS_MAX_LOAD		70
+
+struct ingenic_bus {
+	struct device *dev;
+	struct clk *clk;
+
+	struct devfreq_dev_profile profile;
+	struct devfreq *devfreq;
+
+	struct icc_provider provider;
+	struct icc_node *masters, *memory;
+	int base_id;
+
+	struct dev_pm_qos_request qos_req;
+	u32 width;
+};
+
+static DEFINE_IDA(ingenic_bus_ida);
+
+static int ingenic_bus_target(struct device *dev, unsigned long *freq,
+			      u32 flags)
+{
+	struct dev_pm_opp *new_opp;
+
+	new_opp = devfreq_recommended_opp(dev, freq, flags);
+	if (IS_ERR(new_opp)) {
+		dev_err(dev, "Failed to get recommended OPP: %ld\n",
+			PTR_ERR(new_opp));
+		return PTR_ERR(new_opp);
+	}
+	dev_pm_opp_put(new_opp);
+
+	return dev_pm_opp_set_rate(dev, *freq);
+}
+
+static int ingenic_bus_get_cur_freq(struct device *dev, unsigned long *freq)
+{
+	struct ingenic_bus *bus = dev_get_drvdata(dev);
+
+	*freq = clk_get_rate(bus->clk);
+
+	return 0;
+}
+
+static int ingenic_bus_icc_set(struct icc_node *src, struct icc_node *dst)
+{
+	struct ingenic_bus *bus = dst->data;
+	u64 freq_khz;
+	int ret;
+
+	/* Bandwidths are in kB/s; PM QoS frequencies in kHz */
+	freq_khz = (u64)max(dst->avg_bw, dst->peak_bw) * 100;
+	freq_khz = div_u64(freq_khz, bus->width * INGENIC_BUS_MAX_LOAD);
+
+	ret = dev_pm_qos_update_request(&bus->qos_req,
+					min_t(u64, freq_khz, S32_MAX));
+	if (ret < 0) {
+		dev_err(bus->dev, "Failed to update PM QoS: %d\n", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+static struct icc_node *ingenic_bus_icc_xlate(struct of_phandle_args *spec,
+					      void *data)
+{
+	struct ingenic_bus *bus = data;
+
+	switch (spec->args[0]) {
+	case INGENIC_BUS_MASTERS:
+		return bus->masters;
+	case INGENIC_BUS_MEMORY:
+		return bus->memory;
+	default:
+		return ERR_PTR(-EINVAL);
+	}
+}
+
+static struct icc_node *ingenic_bus_icc_node_create(struct ingenic_bus *bus,
+						    unsigned int id,
+						    const char *suffix)
+{
+	struct icc_node *node;
+
+	node = icc_node_create(bus->base_id + id);
+	if (IS_ERR(node))
+		return node;
+
+	node->name = devm_kasprintf(bus->dev, GFP_KERNEL, "%pOFn-%s",
+				    bus->dev->of_node, suffix);
+	node->data = bus;
+
+	return node;
+}
+
+static int ingenic_bus_icc_init(struct ingenic_bus *bus)
+{
+	struct icc_provider *provider = &bus->provider;
+	int ret;
+
+	ret = ida_alloc(&ingenic_bus_ida, GFP_KERNEL);
+	if (ret < 0)
+		return ret;
+
+	bus->base_id = ret * 2;
+
+	provider->set = ingenic_bus_icc_set;
+	provider->aggregate = icc_std_aggregate;
+	provider->xlate = ingenic_bus_icc_xlate;
+	provider->dev = bus->dev;
+	provider->data = bus;
+
+	ret = icc_provider_add(provider);
+	if (ret)
+		goto err_free_id;
+
+	bus->masters = ingenic_bus_icc_node_create(bus, INGENIC_BUS_MASTERS,
+						   "masters");
+	if (IS_ERR(bus->masters)) {
+		ret = PTR_ERR(bus->masters);
+		goto err_provider_del;
+	}
+
+	bus->memory = ingenic_bus_icc_node_create(bus, INGENIC_BUS_MEMORY,
+						  "memory");
+	if (IS_ERR(bus->memory)) {
+		ret = PTR_ERR(bus->memory);
+		icc_node_destroy(bus->masters->id);
+		goto err_provider_del;
+	}
+
+	icc_node_add(bus->masters, provider);
+	icc_node_add(bus->memory, provider);
+
+	ret = icc_link_create(bus->masters, bus->memory->id);
+	if (ret)
+		goto err_nodes_remove;
+
+	return 0;
+
+err_nodes_remove:
+	icc_nodes_remove(provider);
+err_provider_del:
+	icc_provider_del(provider);
+err_free_id:
+	ida_free(&ingenic_bus_ida, bus->base_id / 2);
+	return ret;
+}
+
+static void ingenic_bus_icc_exit(struct ingenic_bus *bus)
+{
+	icc_link_destroy(bus->masters, bus->memory);
+	icc_nodes_remove(&bus->provider);
+	icc_provider_del(&bus->provider);
+	ida_free(&ingenic_bus_ida, bus->base_id / 2);
+}
+
+static int ingenic_bus_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct ingenic_bus *bus;
+	int ret;
+
+	bus = devm_kzalloc(dev, sizeof(*bus), GFP_KERNEL);
+	if (!bus)
+		return -ENOMEM;
+
+	bus->dev = dev;
+	platform_set_drvdata(pdev, bus);
+
+	if (of_property_read_u32(dev->of_node, "ingenic,bus-width", &bus->width))
+		bus->width = INGENIC_BUS_DEFAULT_WIDTH;
+
+	if (!bus->width) {
+		dev_err(dev, "Invalid bus width\n");
+		return -EINVAL;
+	}
+
+	/*
+	 * The bus clock is always enabled, as the SoC would not run without
+	 * it; we only change its rate.
+	 */
+	bus->clk = devm_clk_get(dev, NULL);
+	if (IS_ERR(bus->clk))
+		return dev_err_probe(dev, PTR_ERR(bus->clk),
+				     "Unable to get bus clock\n");
+
+	ret = dev_pm_opp_of_add_table(dev);
+	if (ret) {
+		dev_err(dev, "Unable to add OPP table: %d\n", ret);
+		return ret;
+	}
+
+	bus->profile.target = ingenic_bus_target;
+	bus->profile.get_cur_freq = ingenic_bus_get_cur_freq;
+	bus->profile.initial_freq = clk_get_rate(bus->clk);
+
+	bus->devfreq = devm_devfreq_add_device(dev, &bus->profile,
+					       DEVFREQ_GOV_POWERSAVE, NULL);
+	if (IS_ERR(bus->devfreq)) {
+		ret = PTR_ERR(bus->devfreq);
+		dev_err(dev, "Failed to add devfreq device: %d\n", ret);
+		goto err_remove_table;
+	}
+
+	ret = dev_pm_qos_add_request(dev, &bus->qos_req,
+				     DEV_PM_QOS_MIN_FREQUENCY, 0);
+	if (ret < 0) {
+		dev_err(dev, "Failed to add PM QoS request: %d\n", ret);
+		goto err_remove_devfreq;
+	}
+
+	ret = ingenic_bus_icc_init(bus);
+	if (ret) {
+		dev_err(dev, "Failed to register interconnect: %d\n", ret);
+		goto err_remove_qos;
+	}
+
+	return 0;
+
+err_remove_qos:
+	dev_pm_qos_remove_request(&bus->qos_req);
+err_remove_devfreq:
+	devm_devfreq_remove_device(dev, bus->devfreq);
+err_remove_table:
+	dev_pm_opp_of_remove_table(dev);
+	return ret;
+}
+
+static int ingenic_bus_remove(struct platform_device *pdev)
+{
+	struct ingenic_bus *bus = platform_get_drvdata(pdev);
+
+	ingenic_bus_icc_exit(bus);
+	dev_pm_qos_remove_request(&bus->qos_req);
+	devm_devfreq_remove_device(bus->dev, bus->devfreq);
+	dev_pm_opp_of_remove_table(bus->dev);
+
+	return 0;
+}
+
+static const struct of_device_id ingenic_bus_of_match[] = {
+	{ .compatible = "ingenic,jz4770-bus", },
+	{ .compatible = "ingenic,jz4780-bus", },
+	{ /* sentinel */ },
+};
+MODULE_DEVICE_TABLE(of, ingenic_bus_of_match);
+
+static struct platform_driver ingenic_bus_driver = {
+	.probe		= ingenic_bus_probe,
+	.remove		= ingenic_bus_remove,
+	.driver = {
+		.name	= "ingenic-bus-devfreq",
+		.of_match_table = ingenic_bus_of_match,
+		.sync_state = icc_sync_state,
+	},
+};
+module_platform_driver(ingenic_bus_driver);
+
+MODULE_DESCRIPTION("Ingenic bus frequency scaling driver");
+MODULE_LICENSE("GPL");
@@ -15,6 +15,7 @@
 #include <linux/of_device.h>
 #include <linux/of_dma.h>
 #include <linux/platform_device.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 
 #include "dmaengine.h"
@@ -58,6 +59,7 @@
 #define JZ_DMA_DCS_TT		BIT(3)
 #define JZ_DMA_DCS_AR		BIT(4)
 #define JZ_DMA_DCS_DES8		BIT(30)
+#define JZ_DMA_DCS_NDES		BIT(31)
 
 #define JZ_DMA_DCM_LINK		BIT(0)
 #define JZ_DMA_DCM_TIE		BIT(1)
@@ -116,11 +118,27 @@ struct jz4780_dma_hwdesc {
 #define JZ_DMA_MAX_DESC		\
 	(JZ_DMA_DESC_BLOCK_SIZE / sizeof(struct jz4780_dma_hwdesc))
 
+/* Number of freed descriptor blocks kept around for reuse, per channel. */
+#define JZ_DMA_MAX_FREE_DESCS	4
+
+/**
+ * struct jz4780_dma_desc - software descriptor of a DMA transaction
+ * @vdesc: virt-dma descriptor
+ * @desc: hardware descriptors. Points to @hwdesc for a transaction with a
+ * single descriptor, which is programmed directly into the channel registers
+ * instead of being fetched by the controller.
+ * @desc_phys: bus address of the hardware descriptors, when not inline
+ * @hwdesc: storage for the hardware descriptor of a single-entry transaction
+ * @count: number of hardware descriptors
+ * @type: transaction type
+ * @status: DCS register value at the end of the transaction
+ */
 struct jz4780_dma_desc {
 	struct virt_dma_desc vdesc;
 
 	struct jz4780_dma_hwdesc *desc;
 	dma_addr_t desc_phys;
+	struct jz4780_dma_hwdesc hwdesc;
 	unsigned int count;
 	enum dma_transaction_type type;
 	uint32_t status;
@@ -131,12 +149,19 @@ struct jz4780_dma_chan {
 	unsigned int id;
 	struct dma_pool *desc_pool;
 
+	/* Descriptors with a hardware block, recycled by jz4780_dma_desc_put */
+	spinlock_t free_lock;
+	struct list_head free_descs;
+	unsigned int nb_free_descs;
+	unsigned long desc_reused, desc_allocated;
+
 	uint32_t transfer_type;
 	uint32_t transfer_shift;
 	struct dma_slave_config	config;
 
 	struct jz4780_dma_desc *desc;
 	unsigned int curr_hwdesc;
+	bool paused;
 };
 
 struct jz4780_dma_soc_data {
@@ -227,15 +252,65 @@ static inline void jz4780_dma_chan_disable(struct jz4780_dma_dev *jzdma,
 		jz4780_dma_ctrl_writel(jzdma, JZ_DMA_REG_DCKEC, BIT(chn));
 }
 
+static inline bool jz4780_dma_desc_is_inline(struct jz4780_dma_desc *desc)
+{
+	return desc->desc == &desc->hwdesc;
+}
+
+/* The DCS bits selecting how the channel gets the descriptor of a transfer */
+static inline uint32_t jz4780_dma_desc_dcs(struct jz4780_dma_desc *desc)
+{
+	return jz4780_dma_desc_is_inline(desc) ? JZ_DMA_DCS_NDES : 0;
+}
+
 static struct jz4780_dma_desc *jz4780_dma_desc_alloc(
 	struct jz4780_dma_chan *jzchan, unsigned int count,
 	enum dma_transaction_type type)
 {
+	struct jz4780_dma_hwdesc *hwdesc;
 	struct jz4780_dma_desc *desc;
+	unsigned long flags;
+	dma_addr_t phys;
 
 	if (count > JZ_DMA_MAX_DESC)
 		return NULL;
 
+	/*
+	 * A non-cyclic transaction with a single hardware descriptor doesn't
+	 * need a descriptor block, the channel registers are programmed
+	 * directly in jz4780_dma_begin().
+	 */
+	if (count == 1 && type != DMA_CYCLIC) {
+		desc = kzalloc(sizeof(*desc), GFP_NOWAIT);
+		if (!desc)
+			return NULL;
+
+		desc->desc = &desc->hwdesc;
+		goto out_init;
+	}
+
+	spin_lock_irqsave(&jzchan->free_lock, flags);
+	desc = list_first_entry_or_null(&jzchan->free_descs,
+					struct jz4780_dma_desc, vdesc.node);
+	if (desc) {
+		list_del(&desc->vdesc.node);
+		jzchan->nb_free_descs--;
+		jzchan->desc_reused++;
+	} else {
+		jzchan->desc_allocated++;
+	}
+	spin_unlock_irqrestore(&jzchan->free_lock, flags);
+
+	if (desc) {
+		hwdesc = desc->desc;
+		phys = desc->desc_phys;
+
+		memset(desc, 0, sizeof(*desc));
+		desc->desc = hwdesc;
+		desc->desc_phys = phys;
+		goto out_init;
+	}
+
 	desc = kzalloc(sizeof(*desc), GFP_NOWAIT);
 	if (!desc)
 		return NULL;
@@ -247,18 +322,59 @@ static struct jz4780_dma_desc *jz4780_dma_desc_alloc(
 		return NULL;
 	}
 
+out_init:
 	desc->count = count;
 	desc->type = type;
 	return desc;
 }
 
+static void jz4780_dma_desc_put(struct jz4780_dma_chan *jzchan,
+				struct jz4780_dma_desc *desc)
+{
+	unsigned long flags;
+
+	if (jz4780_dma_desc_is_inline(desc)) {
+		kfree(desc);
+		return;
+	}
+
+	spin_lock_irqsave(&jzchan->free_lock, flags);
+	if (jzchan->nb_free_descs < JZ_DMA_MAX_FREE_DESCS) {
+		list_add(&desc->vdesc.node, &jzchan->free_descs);
+		jzchan->nb_free_descs++;
+		desc = NULL;
+	}
+	spin_unlock_irqrestore(&jzchan->free_lock, flags);
+
+	if (desc) {
+		dma_pool_free(jzchan->desc_pool, desc->desc, desc->desc_phys);
+		kfree(desc);
+	}
+}
+
 static void jz4780_dma_desc_free(struct virt_dma_desc *vdesc)
 {
 	struct jz4780_dma_desc *desc = to_jz4780_dma_desc(vdesc);
 	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(vdesc->tx.chan);
 
-	dma_pool_free(jzchan->desc_pool, desc->desc, desc->desc_phys);
-	kfree(desc);
+	jz4780_dma_desc_put(jzchan, desc);
+}
+
+static void jz4780_dma_free_descs(struct jz4780_dma_chan *jzchan)
+{
+	struct jz4780_dma_desc *desc, *tmp;
+	unsigned long flags;
+	LIST_HEAD(head);
+
+	spin_lock_irqsave(&jzchan->free_lock, flags);
+	list_splice_init(&jzchan->free_descs, &head);
+	jzchan->nb_free_descs = 0;
+	spin_unlock_irqrestore(&jzchan->free_lock, flags);
+
+	list_for_each_entry_safe(desc, tmp, &head, vdesc.node) {
+		dma_pool_free(jzchan->desc_pool, desc->desc, desc->desc_phys);
+		kfree(desc);
+	}
 }
 
 static uint32_t jz4780_dma_transfer_size(struct jz4780_dma_chan *jzchan,
@@ -372,7 +488,7 @@ static struct dma_async_tx_descriptor *jz4780_dma_prep_slave_sg(
 					      sg_dma_len(&sgl[i]),
 					      direction);
 		if (err < 0) {
-			jz4780_dma_desc_free(&jzchan->desc->vdesc);
+			jz4780_dma_desc_put(jzchan, desc);
 			return NULL;
 		}
 
@@ -419,7 +535,7 @@ static struct dma_async_tx_descriptor *jz4780_dma_prep_dma_cyclic(
 		err = jz4780_dma_setup_hwdesc(jzchan, &desc->desc[i], buf_addr,
 					      period_len, direction);
 		if (err < 0) {
-			jz4780_dma_desc_free(&jzchan->desc->vdesc);
+			jz4780_dma_desc_put(jzchan, desc);
 			return NULL;
 		}
 
@@ -476,6 +592,79 @@ static struct dma_async_tx_descriptor *jz4780_dma_prep_dma_memcpy(
 	return vchan_tx_prep(&jzchan->vchan, &desc->vdesc, flags);
 }
 
+static struct dma_async_tx_descriptor *jz4780_dma_prep_interleaved(
+	struct dma_chan *chan, struct dma_interleaved_template *xt,
+	unsigned long flags)
+{
+	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
+	struct jz4780_dma_dev *jzdma = jz4780_dma_chan_parent(jzchan);
+	size_t len, src_stride, dst_stride;
+	struct jz4780_dma_desc *desc;
+	dma_addr_t src, dst;
+	unsigned int i;
+	uint32_t tsz;
+
+	/*
+	 * Only 2D memory-to-memory transfers are supported, with one chunk
+	 * per frame (i.e. one line of a rectangle), each of them being
+	 * transferred by its own hardware descriptor.
+	 */
+	if (xt->dir != DMA_MEM_TO_MEM || xt->frame_size != 1 ||
+	    !xt->src_inc || !xt->dst_inc || !xt->numf || !xt->sgl[0].size)
+		return NULL;
+
+	len = xt->sgl[0].size;
+	src_stride = len + dmaengine_get_src_icg(xt, &xt->sgl[0]);
+	dst_stride = len + dmaengine_get_dst_icg(xt, &xt->sgl[0]);
+
+	desc = jz4780_dma_desc_alloc(jzchan, xt->numf, DMA_INTERLEAVE);
+	if (!desc)
+		return NULL;
+
+	/* The transfer size must be suitable for all the lines. */
+	tsz = jz4780_dma_transfer_size(jzchan, xt->src_start | xt->dst_start |
+				       len | src_stride | dst_stride,
+				       &jzchan->transfer_shift);
+
+	jzchan->transfer_type = JZ_DMA_DRT_AUTO;
+
+	src = xt->src_start;
+	dst = xt->dst_start;
+
+	for (i = 0; i < xt->numf; i++) {
+		desc->desc[i].dsa = src;
+		desc->desc[i].dta = dst;
+		desc->desc[i].dcm = JZ_DMA_DCM_TIE | JZ_DMA_DCM_SAI |
+				    JZ_DMA_DCM_DAI |
+				    tsz << JZ_DMA_DCM_TSZ_SHIFT |
+				    JZ_DMA_WIDTH_32_BIT << JZ_DMA_DCM_SP_SHIFT |
+				    JZ_DMA_WIDTH_32_BIT << JZ_DMA_DCM_DP_SHIFT;
+		desc->desc[i].dtc = len >> jzchan->transfer_shift;
+
+		if (i != (xt->numf - 1) &&
+		    !(jzdma->soc_data->flags & JZ_SOC_DATA_BREAK_LINKS)) {
+			desc->desc[i].dcm |= JZ_DMA_DCM_LINK;
+			desc->desc[i].dtc |=
+				(((i + 1) * sizeof(*desc->desc)) >> 4) << 24;
+		}
+
+		src += src_stride;
+		dst += dst_stride;
+	}
+
+	return vchan_tx_prep(&jzchan->vchan, &desc->vdesc, flags);
+}
+
+/*
+ * A cyclic transfer only needs an interrupt per period if the client asked
+ * for one; audio streams without period wakeups just poll the position.
+ */
+static bool jz4780_dma_cyclic_wants_irq(struct jz4780_dma_desc *desc)
+{
+	return desc->vdesc.tx.callback &&
+	       (desc->vdesc.tx.flags & DMA_PREP_INTERRUPT);
+}
+
 static void jz4780_dma_begin(struct jz4780_dma_chan *jzchan)
 {
 	struct jz4780_dma_dev *jzdma = jz4780_dma_chan_parent(jzchan);
@@ -489,11 +678,13 @@ static void jz4780_dma_begin(struct jz4780_dma_chan *jzchan)
 			return;
 
 		list_del(&vdesc->node);
+		jzchan->paused = false;
 
 		jzchan->desc = to_jz4780_dma_desc(vdesc);
 		jzchan->curr_hwdesc = 0;
 
-		if (jzchan->desc->type == DMA_CYCLIC && vdesc->tx.callback) {
+		if (jzchan->desc->type == DMA_CYCLIC &&
+		    jz4780_dma_cyclic_wants_irq(jzchan->desc)) {
 			/*
 			 * The DMA controller doesn't support triggering an
 			 * interrupt after processing each descriptor, only
@@ -524,6 +715,27 @@ static void jz4780_dma_begin(struct jz4780_dma_chan *jzchan)
 	/* Enable the channel's clock. */
 	jz4780_dma_chan_enable(jzdma, jzchan->id);
 
+	if (jz4780_dma_desc_is_inline(jzchan->desc)) {
+		struct jz4780_dma_hwdesc *hwdesc = jzchan->desc->desc;
+
+		/* Single descriptor: program the transfer directly. */
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS,
+				      JZ_DMA_DCS_NDES);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DRT,
+				      jzchan->transfer_type);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DSA,
+				      hwdesc->dsa);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DTA,
+				      hwdesc->dta);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DTC,
+				      hwdesc->dtc);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCM,
+				      hwdesc->dcm);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS,
+				      JZ_DMA_DCS_NDES | JZ_DMA_DCS_CTE);
+		return;
+	}
+
 	/* Use 4-word descriptors. */
 	jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS, 0);
 
@@ -575,6 +787,7 @@ static int jz4780_dma_terminate_all(struct dma_chan *chan)
 
 	/* Clear the DMA status and stop the transfer. */
 	jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS, 0);
+	jzchan->paused = false;
 	if (jzchan->desc) {
 		vchan_terminate_vdesc(&jzchan->desc->vdesc);
 		jzchan->desc = NULL;
@@ -590,6 +803,53 @@ static int jz4780_dma_terminate_all(struct dma_chan *chan)
 	return 0;
 }
 
+/*
+ * Clearing CTE stops the channel with its registers, and the current
+ * descriptor address, left as they are: setting it again resumes the transfer
+ * where it stopped, and the residue stays accurate in between.
+ */
+static int jz4780_dma_pause(struct dma_chan *chan)
+{
+	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
+	struct jz4780_dma_dev *jzdma = jz4780_dma_chan_parent(jzchan);
+	unsigned long flags;
+	uint32_t dcs;
+
+	spin_lock_irqsave(&jzchan->vchan.lock, flags);
+
+	if (jzchan->desc && !jzchan->paused) {
+		dcs = jz4780_dma_chn_readl(jzdma, jzchan->id, JZ_DMA_REG_DCS);
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS,
+				      dcs & ~JZ_DMA_DCS_CTE);
+		jzchan->paused = true;
+	}
+
+	spin_unlock_irqrestore(&jzchan->vchan.lock, flags);
+
+	return 0;
+}
+
+static int jz4780_dma_resume(struct dma_chan *chan)
+{
+	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
+	struct jz4780_dma_dev *jzdma = jz4780_dma_chan_parent(jzchan);
+	unsigned long flags;
+	uint32_t dcs;
+
+	spin_lock_irqsave(&jzchan->vchan.lock, flags);
+
+	if (jzchan->desc && jzchan->paused) {
+		dcs = jz4780_dma_chn_readl(jzdma, jzchan->id, JZ_DMA_REG_DCS);
+		dcs |= jz4780_dma_desc_dcs(jzchan->desc) | JZ_DMA_DCS_CTE;
+		jz4780_dma_chn_writel(jzdma, jzchan->id, JZ_DMA_REG_DCS, dcs);
+	}
+	jzchan->paused = false;
+
+	spin_unlock_irqrestore(&jzchan->vchan.lock, flags);
+
+	return 0;
+}
+
 static void jz4780_dma_synchronize(struct dma_chan *chan)
 {
 	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
@@ -626,7 +886,31 @@ static size_t jz4780_dma_desc_residue(struct jz4780_dma_chan *jzchan,
 
 	if (next_sg != 0)
 		count += jz4780_dma_chn_readl(jzdma, jzchan->id,
-					 JZ_DMA_REG_DTC);
+					 JZ_DMA_REG_DTC) & GENMASK(23, 0);
+
+	return count << jzchan->transfer_shift;
+}
+
+/*
+ * Residue of a cyclic transfer whose descriptors are still linked. The
+ * controller walks them without any interrupt, so curr_hwdesc is stale; the
+ * current descriptor is found from the offset of the next one, which DTCn
+ * holds in its upper 8 bits along with the remaining count.
+ */
+static size_t jz4780_dma_linked_residue(struct jz4780_dma_chan *jzchan,
+	struct jz4780_dma_desc *desc)
+{
+	struct jz4780_dma_dev *jzdma = jz4780_dma_chan_parent(jzchan);
+	unsigned int count, dtc, i;
+
+	dtc = jz4780_dma_chn_readl(jzdma, jzchan->id, JZ_DMA_REG_DTC);
+	count = dtc & GENMASK(23, 0);
+
+	/* The last descriptor links back to the first one, at offset 0 */
+	i = ((dtc >> 24) << 4) / sizeof(*desc->desc);
+	if (i)
+		for (; i < desc->count; i++)
+			count += desc->desc[i].dtc & GENMASK(23, 0);
 
 	return count << jzchan->transfer_shift;
 }
@@ -651,15 +935,23 @@ static enum dma_status jz4780_dma_tx_status(struct dma_chan *chan,
 		/* On the issued list, so hasn't been processed yet */
 		residue = jz4780_dma_desc_residue(jzchan,
 					to_jz4780_dma_desc(vdesc), 0);
-	} else if (cookie == jzchan->desc->vdesc.tx.cookie) {
-		residue = jz4780_dma_desc_residue(jzchan, jzchan->desc,
-					jzchan->curr_hwdesc + 1);
+	} else if (jzchan->desc && cookie == jzchan->desc->vdesc.tx.cookie) {
+		if (jzchan->desc->type == DMA_CYCLIC &&
+		    !jz4780_dma_cyclic_wants_irq(jzchan->desc))
+			residue = jz4780_dma_linked_residue(jzchan,
+							    jzchan->desc);
+		else
+			residue = jz4780_dma_desc_residue(jzchan, jzchan->desc,
+						jzchan->curr_hwdesc + 1);
 	}
 	dma_set_residue(txstate, residue);
 
 	if (vdesc && jzchan->desc && vdesc == &jzchan->desc->vdesc
 	    && jzchan->desc->status & (JZ_DMA_DCS_AR | JZ_DMA_DCS_HLT))
 		status = DMA_ERROR;
+	else if (status == DMA_IN_PROGRESS && jzchan->paused && jzchan->desc &&
+		 cookie == jzchan->desc->vdesc.tx.cookie)
+		status = DMA_PAUSED;
 
 out_unlock_irqrestore:
 	spin_unlock_irqrestore(&jzchan->vchan.lock, flags);
@@ -706,11 +998,17 @@ static bool jz4780_dma_chan_irq(struct jz4780_dma_dev *jzdma,
 
 				jz4780_dma_begin(jzchan);
 			} else {
-				/* False positive - continue the transfer */
+				/*
+				 * False positive - continue the transfer, still
+				 * without a descriptor if it was programmed
+				 * directly.
+				 */
 				ack = false;
-				jz4780_dma_chn_writel(jzdma, jzchan->id,
-						      JZ_DMA_REG_DCS,
-						      JZ_DMA_DCS_CTE);
+				if (!jzchan->paused)
+					jz4780_dma_chn_writel(jzdma, jzchan->id,
+							      JZ_DMA_REG_DCS,
+							      jz4780_dma_desc_dcs(desc) |
+							      JZ_DMA_DCS_CTE);
 			}
 		}
 	} else {
@@ -752,6 +1050,8 @@ static irqreturn_t jz4780_dma_irq_handler(int irq, void *data)
 static int jz4780_dma_alloc_chan_resources(struct dma_chan *chan)
 {
 	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
+	struct jz4780_dma_desc *desc;
+	unsigned int i;
 
 	jzchan->desc_pool = dma_pool_create(dev_name(&chan->dev->device),
 					    chan->device->dev,
@@ -763,6 +1063,28 @@ static int jz4780_dma_alloc_chan_resources(struct dma_chan *chan)
 		return -ENOMEM;
 	}
 
+	/*
+	 * Fill the free list now, where we can sleep, so that preparing a
+	 * transaction doesn't have to go to the pool with GFP_NOWAIT.
+	 */
+	for (i = 0; i < JZ_DMA_MAX_FREE_DESCS; i++) {
+		desc = kzalloc(sizeof(*desc), GFP_KERNEL);
+		if (!desc)
+			break;
+
+		desc->desc = dma_pool_alloc(jzchan->desc_pool, GFP_KERNEL,
+					    &desc->desc_phys);
+		if (!desc->desc) {
+			kfree(desc);
+			break;
+		}
+
+		jz4780_dma_desc_put(jzchan, desc);
+	}
+
+	jzchan->desc_reused = 0;
+	jzchan->desc_allocated = 0;
+
 	return 0;
 }
 
@@ -771,10 +1093,32 @@ static void jz4780_dma_free_chan_resources(struct dma_chan *chan)
 	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
 
 	vchan_free_chan_resources(&jzchan->vchan);
+	jz4780_dma_free_descs(jzchan);
 	dma_pool_destroy(jzchan->desc_pool);
 	jzchan->desc_pool = NULL;
 }
 
+#ifdef CONFIG_DEBUG_FS
+static void jz4780_dma_dbg_summary_show(struct seq_file *s,
+					struct dma_device *dd)
+{
+	struct jz4780_dma_chan *jzchan;
+	struct dma_chan *chan;
+
+	list_for_each_entry(chan, &dd->channels, device_node) {
+		if (!chan->client_count)
+			continue;
+
+		jzchan = to_jz4780_dma_chan(chan);
+		seq_printf(s, " %-13s| %s, descs: %lu reused, %lu allocated, %u free\n",
+			   dma_chan_name(chan), chan->dbg_client_name ?: "in-use",
+			   READ_ONCE(jzchan->desc_reused),
+			   READ_ONCE(jzchan->desc_allocated),
+			   READ_ONCE(jzchan->nb_free_descs));
+	}
+}
+#endif
+
 static bool jz4780_dma_filter_fn(struct dma_chan *chan, void *param)
 {
 	struct jz4780_dma_chan *jzchan = to_jz4780_dma_chan(chan);
@@ -897,6 +1241,7 @@ static int jz4780_dma_probe(struct platform_device *pdev)
 	dd = &jzdma->dma_device;
 
 	dma_cap_set(DMA_MEMCPY, dd->cap_mask);
+	dma_cap_set(DMA_INTERLEAVE, dd->cap_mask);
 	if (!(soc_data->flags & JZ_SOC_DATA_ONLY_MEMCPY)) {
 		dma_cap_set(DMA_SLAVE, dd->cap_mask);
 		dma_cap_set(DMA_CYCLIC, dd->cap_mask);
@@ -909,11 +1254,17 @@ static int jz4780_dma_probe(struct platform_device *pdev)
 	dd->device_prep_slave_sg = jz4780_dma_prep_slave_sg;
 	dd->device_prep_dma_cyclic = jz4780_dma_prep_dma_cyclic;
 	dd->device_prep_dma_memcpy = jz4780_dma_prep_dma_memcpy;
+	dd->device_prep_interleaved_dma = jz4780_dma_prep_interleaved;
 	dd->device_config = jz4780_dma_config;
+	dd->device_pause = jz4780_dma_pause;
+	dd->device_resume = jz4780_dma_resume;
 	dd->device_terminate_all = jz4780_dma_terminate_all;
 	dd->device_synchronize = jz4780_dma_synchronize;
 	dd->device_tx_status = jz4780_dma_tx_status;
 	dd->device_issue_pending = jz4780_dma_issue_pending;
+#ifdef CONFIG_DEBUG_FS
+	dd->dbg_summary_show = jz4780_dma_dbg_summary_show;
+#endif
 	dd->src_addr_widths = JZ_DMA_BUSWIDTHS;
 	dd->dst_addr_widths = JZ_DMA_BUSWIDTHS;
 	dd->directions = BIT(DMA_DEV_TO_MEM) | BIT(DMA_MEM_TO_DEV);
@@ -936,6 +1287,9 @@ static int jz4780_dma_probe(struct platform_device *pdev)
 		jzchan = &jzdma->chan[i];
 		jzchan->id = i;
 
+		spin_lock_init(&jzchan->free_lock);
+		INIT_LIST_HEAD(&jzchan->free_descs);
+
 		vchan_init(&jzchan->vchan, dd);
 		jzchan->vchan.desc_free = jz4780_dma_desc_free;
 	}
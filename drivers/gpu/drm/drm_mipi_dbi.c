@@ -263,7 +263,7 @@ static void mipi_dbi_fb_dirty(struct drm_framebuffer *fb, struct drm_rect *rect)
 	struct mipi_dbi *dbi = &dbidev->dbi;
 	bool swap = dbi->swap_bytes;
 	int idx, ret = 0;
-	bool full;
+	bool contiguous;
 	void *tr;
 
 	if (WARN_ON(!fb))
@@ -272,18 +272,23 @@ static void mipi_dbi_fb_dirty(struct drm_framebuffer *fb, struct drm_rect *rect)
 	if (!drm_dev_enter(fb->dev, &idx))
 		return;
 
-	full = width == fb->width && height == fb->height;
+	/*
+	 * A rect spanning whole lines of a framebuffer without padding is a
+	 * contiguous part of it, which can be sent as is.
+	 */
+	contiguous = width == fb->width &&
+		     fb->pitches[0] == width * fb->format->cpp[0];
 
 	DRM_DEBUG_KMS("Flushing [FB:%d] " DRM_RECT_FMT "\n", fb->base.id, DRM_RECT_ARG(rect));
 
-	if (!dbi->dc || !full || swap ||
+	if (!dbi->dc || !contiguous || swap ||
 	    fb->format->format == DRM_FORMAT_XRGB8888) {
 		tr = dbidev->tx_buf;
 		ret = mipi_dbi_buf_copy(dbidev->tx_buf, fb, rect, swap);
 		if (ret)
 			goto err_msg;
 	} else {
-		tr = cma_obj->vaddr;
+		tr = cma_obj->vaddr + rect->y1 * fb->pitches[0];
 	}
 
 	mipi_dbi_set_window_address(dbidev, rect->x1, rect->x2 - 1, rect->y1,
@@ -6,10 +6,17 @@
 
 #include "ingenic-drm.h"
 
+#define CREATE_TRACE_POINTS
+#include "ingenic-drm-trace.h"
+
 #include <linux/component.h>
 #include <linux/clk.h>
+#include <linux/completion.h>
 #include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/interconnect.h>
 #include <linux/io.h>
+#include <linux/math64.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
 #include <linux/of_device.h>
@@ -17,6 +24,8 @@
 #include <linux/platform_device.h>
 #include <linux/pm.h>
 #include <linux/regmap.h>
+#include <linux/seq_file.h>
+#include <linux/workqueue.h>
 
 #include <drm/drm_atomic.h>
 #include <drm/drm_atomic_helper.h>
@@ -26,6 +35,7 @@
 #include <drm/drm_crtc.h>
 #include <drm/drm_crtc_helper.h>
 #include <drm/drm_damage_helper.h>
+#include <drm/drm_debugfs.h>
 #include <drm/drm_drv.h>
 #include <drm/drm_encoder.h>
 #include <drm/drm_gem_cma_helper.h>
@@ -34,6 +44,7 @@
 #include <drm/drm_fourcc.h>
 #include <drm/drm_gem_atomic_helper.h>
 #include <drm/drm_gem_framebuffer_helper.h>
+#include <drm/drm_ioctl.h>
 #include <drm/drm_irq.h>
 #include <drm/drm_managed.h>
 #include <drm/drm_of.h>
@@ -42,6 +53,7 @@
 #include <drm/drm_plane_helper.h>
 #include <drm/drm_probe_helper.h>
 #include <drm/drm_vblank.h>
+#include <drm/ingenic_drm.h>
 
 struct ingenic_dma_hwdesc {
 	u32 next;
@@ -50,9 +62,25 @@ struct ingenic_dma_hwdesc {
 	u32 cmd;
 } __aligned(16);
 
+#define INGENIC_DRM_ASYNC_SLOTS			3
+
+#define INGENIC_DRM_COLORKEY_ENABLE		BIT(24)
+
+/* Resolution and number of the buckets of the commit latency histogram */
+#define INGENIC_DRM_LATENCY_BUCKET_US		2000
+#define INGENIC_DRM_LATENCY_BUCKETS		32
+
+/* Maximum size of the f0 plane when used as a cursor plane */
+#define INGENIC_DRM_CURSOR_SIZE			64
+
+static bool ingenic_drm_f0_cursor;
+module_param_named(f0_cursor, ingenic_drm_f0_cursor, bool, 0400);
+MODULE_PARM_DESC(f0_cursor, "Expose the f0 plane as a cursor plane");
+
 struct ingenic_dma_hwdescs {
 	struct ingenic_dma_hwdesc hwdesc[2];
 	struct ingenic_dma_hwdesc hwdesc_pal;
+	struct ingenic_dma_hwdesc hwdesc_async[2][INGENIC_DRM_ASYNC_SLOTS];
 	u16 palette[256] __aligned(16);
 };
 
@@ -65,10 +93,51 @@ struct jz_soc_info {
 	unsigned int num_formats_f0, num_formats_f1;
 };
 
+/*
+ * DMA descriptors used to scan out a framebuffer in doublescan mode, one per
+ * output line. They are shared by the framebuffers created from the same GEM
+ * object, and freed when the last of them and the object are gone. users is
+ * protected by ingenic_drm.hwdescs_lock.
+ */
+struct ingenic_drm_hwdescs {
+	struct ingenic_dma_hwdesc *hwdesc;
+	dma_addr_t phys;
+	size_t size;
+	unsigned int users;
+};
+
+struct ingenic_drm_fb {
+	struct drm_framebuffer base;
+	struct ingenic_drm_hwdescs *hwdescs;
+};
+
 struct ingenic_gem_object {
 	struct drm_gem_cma_object base;
-	struct ingenic_dma_hwdesc *hwdescs;
-	dma_addr_t hwdescs_phys;
+
+	/*
+	 * Descriptors given to the next framebuffer created from this object,
+	 * if they are big enough, so that clients which create a new
+	 * framebuffer for each frame from the same (e.g. imported) buffer
+	 * don't allocate them each time. Protected by ingenic_drm.hwdescs_lock.
+	 */
+	struct ingenic_drm_hwdescs *hwdescs;
+
+	/* Actual size of the buffer obtained from the buffer cache */
+	size_t buf_size;
+
+	/* Buffer of the fbdev emulation, see ingenic_drm_fbdev_flush() */
+	bool fbdev;
+};
+
+struct ingenic_drm_plane_state {
+	struct drm_plane_state base;
+
+	/*
+	 * Color key of the f0 plane: pixels of that color are transparent. The
+	 * value is in RGB888 format, with INGENIC_DRM_COLORKEY_ENABLE set to
+	 * enable color keying.
+	 */
+	u32 colorkey;
 };
 
 struct ingenic_drm_private_state {
@@ -93,6 +162,9 @@ struct ingenic_drm_private_state {
 	 * per output line.
 	 */
 	bool doublescan;
+
+	/* Memory bandwidth needed by the f0 and f1 planes, in kB/s */
+	u32 avg_bw[2], peak_bw[2];
 };
 
 struct ingenic_drm {
@@ -110,11 +182,31 @@ struct ingenic_drm {
 	struct clk *lcd_clk, *pix_clk, *dma_clk;
 	const struct jz_soc_info *soc_info;
 
+	/*
+	 * Path to the memory, used to vote for the bandwidth needed by the
+	 * planes. The current vote is only updated from the commit tail.
+	 */
+	struct icc_path *icc_path;
+	u32 avg_bw, peak_bw;
+
 	struct ingenic_dma_hwdescs *dma_hwdescs;
 	dma_addr_t dma_hwdescs_phys;
 
 	bool panel_is_sharp;
 
+	/* Cache of the DMA buffers backing the GEM objects */
+	struct ingenic_drm_pool *pool;
+
+	/*
+	 * Statistics of the synchronous commits that did not need a modeset,
+	 * exported through debugfs. The latency is the time between the start
+	 * of the commit tail and the VBLANK at which the new state started to
+	 * be scanned out; a commit misses VBLANKs when it takes longer than a
+	 * frame. Only updated from the commit tail.
+	 */
+	u32 commits, missed_vblanks;
+	u32 latency[INGENIC_DRM_LATENCY_BUCKETS];
+
 	/*
 	 * clk_mutex is used to synchronize the pixel clock rate update with
 	 * the VBLANK. When the pixel clock's parent clock needs to be updated,
@@ -131,6 +223,45 @@ struct ingenic_drm {
 	struct notifier_block clock_nb;
 
 	struct drm_private_obj private_obj;
+
+	/*
+	 * Asynchronous page flips (mailbox mode) use a ring of DMA descriptors
+	 * per plane. A new framebuffer is written to a descriptor that is
+	 * neither the one being scanned out nor the last one queued, then all
+	 * the other descriptors of the plane are redirected to it; the LCD
+	 * controller picks it up at the beginning of the next frame, and a
+	 * newer flip simply replaces a queued one. async_pending is the index
+	 * of the last queued descriptor, or -1 if the plane is not in
+	 * asynchronous mode. A reference to the framebuffer of each
+	 * descriptor is held as long as it may be scanned out.
+	 *
+	 * When entering asynchronous mode, the framebuffer of the main
+	 * descriptor may still be scanned out until the end of the frame:
+	 * async_old_fb holds it, along with a VBLANK reference, until an EOF
+	 * interrupt finds that the main descriptor isn't in use anymore.
+	 */
+	struct drm_framebuffer *async_fb[2][INGENIC_DRM_ASYNC_SLOTS];
+	int async_pending[2];
+	struct drm_framebuffer *async_old_fb[2];
+	struct work_struct async_old_fb_work;
+
+	/* Memory-to-memory DMA channel used for blits, may be NULL */
+	struct dma_chan *blit_chan;
+	struct mutex blit_mutex;
+
+	/* Protects the DMA descriptors of the GEM objects */
+	struct mutex hwdescs_lock;
+
+	/*
+	 * Plane scanning out the buffer of the fbdev emulation, if any, and
+	 * the range of that buffer written back periodically.
+	 */
+	struct drm_plane *fbdev_plane;
+	dma_addr_t fbdev_addr;
+	size_t fbdev_size;
+	struct delayed_work fbdev_flush_work;
+
+	struct drm_property *colorkey_prop;
 };
 
 struct ingenic_drm_bec {
@@ -146,6 +277,12 @@ to_ingenic_drm_bec(struct drm_encoder *encoder)
 	return container_of(encoder, struct ingenic_drm_bec, encoder);
 }
 
+static inline struct ingenic_drm_plane_state *
+to_ingenic_drm_plane_state(const struct drm_plane_state *state)
+{
+	return container_of(state, struct ingenic_drm_plane_state, base);
+}
+
 static inline struct ingenic_drm_private_state *
 to_ingenic_drm_priv_state(struct drm_private_state *state)
 {
@@ -221,6 +358,11 @@ static inline struct ingenic_gem_object *to_ingenic_gem_obj(struct drm_gem_objec
 	return container_of(gem_obj, struct ingenic_gem_object, base.base);
 }
 
+static inline struct ingenic_drm_fb *to_ingenic_drm_fb(struct drm_framebuffer *fb)
+{
+	return container_of(fb, struct ingenic_drm_fb, base);
+}
+
 static inline dma_addr_t dma_hwdesc_addr(const struct ingenic_drm *priv, bool use_f1)
 {
 	u32 offset = offsetof(struct ingenic_dma_hwdescs, hwdesc[use_f1]);
@@ -235,6 +377,15 @@ static inline dma_addr_t dma_hwdesc_pal_addr(const struct ingenic_drm *priv)
 	return priv->dma_hwdescs_phys + offset;
 }
 
+static inline dma_addr_t dma_hwdesc_async_addr(const struct ingenic_drm *priv,
+					       bool use_f1, unsigned int slot)
+{
+	u32 offset = offsetof(struct ingenic_dma_hwdescs,
+			      hwdesc_async[use_f1][slot]);
+
+	return priv->dma_hwdescs_phys + offset;
+}
+
 static int ingenic_drm_update_pixclk(struct notifier_block *nb,
 				     unsigned long action,
 				     void *data)
@@ -245,7 +396,12 @@ static int ingenic_drm_update_pixclk(struct notifier_block *nb,
 	case PRE_RATE_CHANGE:
 		mutex_lock(&priv->clk_mutex);
 		priv->update_clk_rate = true;
-		drm_crtc_wait_one_vblank(&priv->crtc);
+
+		/* Only wait for the end of the frame if one is being scanned */
+		if (!drm_crtc_vblank_get(&priv->crtc)) {
+			drm_crtc_wait_one_vblank(&priv->crtc);
+			drm_crtc_vblank_put(&priv->crtc);
+		}
 		return NOTIFY_OK;
 	default:
 		mutex_unlock(&priv->clk_mutex);
@@ -445,11 +601,21 @@ static void ingenic_drm_crtc_atomic_flush(struct drm_crtc *crtc,
 	struct ingenic_drm *priv = drm_crtc_get_priv(crtc);
 	struct drm_crtc_state *crtc_state = drm_atomic_get_new_crtc_state(state,
 									  crtc);
+	struct drm_crtc_state *old_crtc_state = drm_atomic_get_old_crtc_state(state,
+									      crtc);
 	struct drm_pending_vblank_event *event = crtc_state->event;
 
 	if (drm_atomic_crtc_needs_modeset(crtc_state)) {
 		ingenic_drm_crtc_update_timings(priv, &crtc_state->adjusted_mode);
 		priv->update_clk_rate = true;
+	} else if (!drm_mode_equal(&old_crtc_state->adjusted_mode,
+				   &crtc_state->adjusted_mode)) {
+		/*
+		 * Only the vertical blanking changed, see
+		 * ingenic_drm_atomic_check().
+		 */
+		ingenic_drm_crtc_update_timings(priv, &crtc_state->adjusted_mode);
+		drm_calc_timestamping_constants(crtc, &crtc_state->adjusted_mode);
 	}
 
 	if (priv->update_clk_rate) {
@@ -464,7 +630,11 @@ static void ingenic_drm_crtc_atomic_flush(struct drm_crtc *crtc,
 		crtc_state->event = NULL;
 
 		spin_lock_irq(&crtc->dev->event_lock);
-		if (drm_crtc_vblank_get(crtc) == 0)
+		/*
+		 * Asynchronous flips complete right away, so that userspace can
+		 * queue a newer frame before the next VBLANK.
+		 */
+		if (!crtc_state->async_flip && drm_crtc_vblank_get(crtc) == 0)
 			drm_crtc_arm_vblank_event(crtc, event);
 		else
 			drm_crtc_send_vblank_event(crtc, event);
@@ -483,6 +653,7 @@ static int ingenic_drm_plane_atomic_check(struct drm_plane *plane,
 	struct ingenic_drm_private_state *priv_state;
 	struct drm_crtc_state *crtc_state;
 	struct drm_crtc *crtc = new_plane_state->crtc ?: old_plane_state->crtc;
+	unsigned int i;
 	int ret;
 
 	if (!crtc)
@@ -505,6 +676,20 @@ static int ingenic_drm_plane_atomic_check(struct drm_plane *plane,
 	if (ret)
 		return ret;
 
+	if (plane->type == DRM_PLANE_TYPE_CURSOR &&
+	    (new_plane_state->crtc_w > INGENIC_DRM_CURSOR_SIZE ||
+	     new_plane_state->crtc_h > INGENIC_DRM_CURSOR_SIZE))
+		return -EINVAL;
+
+	/*
+	 * A cursor partially off-screen is cropped to its visible part, whose
+	 * lines are fetched by the DMA in 32-bit words.
+	 */
+	if (plane->type == DRM_PLANE_TYPE_CURSOR && new_plane_state->visible &&
+	    new_plane_state->fb->format->cpp[0] != 4 &&
+	    drm_rect_width(&new_plane_state->dst) != new_plane_state->crtc_w)
+		return -EINVAL;
+
 	/*
 	 * If OSD is not available, check that the width/height match.
 	 * Note that state->src_* are in 16.16 fixed-point format.
@@ -529,18 +714,65 @@ static int ingenic_drm_plane_atomic_check(struct drm_plane *plane,
 	priv_state->use_palette = new_plane_state->fb &&
 		new_plane_state->fb->format->format == DRM_FORMAT_C8;
 
+	/*
+	 * The OSD blends the f0 plane using either the plane alpha or the
+	 * pixel alpha, but not both. It doesn't handle pre-multiplied alpha,
+	 * which is the default blend mode, so such planes are blended as
+	 * coverage: opaque and fully transparent pixels, which make up most
+	 * cursors and UI overlays, come out the same, only translucent pixels
+	 * come out slightly darker.
+	 */
+	if (new_plane_state->fb && new_plane_state->fb->format->has_alpha &&
+	    new_plane_state->pixel_blend_mode != DRM_MODE_BLEND_PIXEL_NONE &&
+	    new_plane_state->alpha != DRM_BLEND_ALPHA_OPAQUE) {
+		dev_dbg(priv->dev, "Unsupported blending mode\n");
+		return -EINVAL;
+	}
+
+	/* With doublescan, each line is fetched twice */
+	i = plane == &priv->f0 ? 0 : 1;
+	if (new_plane_state->fb && crtc_state->active) {
+		ingenic_drm_bandwidth(crtc_state, new_plane_state->fb->format,
+				      new_plane_state->crtc_w,
+				      new_plane_state->crtc_h,
+				      &priv_state->avg_bw[i],
+				      &priv_state->peak_bw[i]);
+	} else {
+		priv_state->avg_bw[i] = 0;
+		priv_state->peak_bw[i] = 0;
+	}
+
 	/*
 	 * Require full modeset if enabling or disabling a plane, or changing
-	 * its position, size or depth.
+	 * its position, size or depth. The cursor plane can be shown, hidden,
+	 * moved and resized freely, only its registers and descriptors have to
+	 * be written.
 	 */
-	if (priv->soc_info->has_osd &&
-	    (!old_plane_state->fb || !new_plane_state->fb ||
-	     old_plane_state->crtc_x != new_plane_state->crtc_x ||
-	     old_plane_state->crtc_y != new_plane_state->crtc_y ||
-	     old_plane_state->crtc_w != new_plane_state->crtc_w ||
-	     old_plane_state->crtc_h != new_plane_state->crtc_h ||
-	     old_plane_state->fb->format->format != new_plane_state->fb->format->format))
+	if (priv->soc_info->has_osd && plane->type == DRM_PLANE_TYPE_CURSOR) {
+		if (old_plane_state->fb && new_plane_state->fb &&
+		    old_plane_state->fb->format->format != new_plane_state->fb->format->format)
+			crtc_state->mode_changed = true;
+	} else if (priv->soc_info->has_osd &&
+		   (!old_plane_state->fb || !new_plane_state->fb ||
+		    old_plane_state->crtc_x != new_plane_state->crtc_x ||
+		    old_plane_state->crtc_y != new_plane_state->crtc_y ||
+		    old_plane_state->crtc_w != new_plane_state->crtc_w ||
+		    old_plane_state->crtc_h != new_plane_state->crtc_h ||
+		    old_plane_state->fb->format->format != new_plane_state->fb->format->format)) {
 		crtc_state->mode_changed = true;
+	}
+
+	/*
+	 * Asynchronous flips can only swap the framebuffer of a plane that
+	 * uses a single DMA descriptor.
+	 */
+	if (crtc_state->async_flip &&
+	    (drm_atomic_crtc_needs_modeset(crtc_state) ||
+	     !old_plane_state->fb || !new_plane_state->fb ||
+	     priv_state->doublescan || priv_state->use_palette)) {
+		dev_dbg(priv->dev, "Cannot perform asynchronous flip\n");
+		return -EINVAL;
+	}
 
 	drm_atomic_helper_check_plane_damage(state, new_plane_state);
 
@@ -562,6 +794,49 @@ static void ingenic_drm_plane_enable(struct ingenic_drm *priv,
 	}
 }
 
+void ingenic_drm_bandwidth(const struct drm_crtc_state *crtc_state,
+			   const struct drm_format_info *finfo,
+			   unsigned int width, unsigned int height,
+			   u32 *avg_bw, u32 *peak_bw)
+{
+	const struct drm_display_mode *mode = &crtc_state->adjusted_mode;
+	u64 bytes = 0, avg, peak;
+	unsigned int i;
+
+	for (i = 0; i < finfo->num_planes; i++)
+		bytes += (u64)finfo->cpp[i] *
+			drm_format_info_plane_width(finfo, width, i) *
+			drm_format_info_plane_height(finfo, height, i);
+
+	/* The result is in kB/s */
+	avg = div_u64(bytes * drm_mode_vrefresh(mode), 1000);
+
+	/* Pixels are only fetched during the active part of the frame */
+	peak = div_u64(avg * mode->crtc_htotal * mode->crtc_vtotal,
+		       max(mode->crtc_hdisplay * mode->crtc_vdisplay, 1));
+
+	*avg_bw = min_t(u64, avg, U32_MAX);
+	*peak_bw = min_t(u64, peak, U32_MAX);
+}
+
+static void ingenic_drm_set_bandwidth(struct ingenic_drm *priv,
+				      u32 avg_bw, u32 peak_bw)
+{
+	int ret;
+
+	if (avg_bw == priv->avg_bw && peak_bw == priv->peak_bw)
+		return;
+
+	ret = icc_set_bw(priv->icc_path, avg_bw, peak_bw);
+	if (ret) {
+		dev_warn(priv->dev, "Unable to set bandwidth: %d\n", ret);
+		return;
+	}
+
+	priv->avg_bw = avg_bw;
+	priv->peak_bw = peak_bw;
+}
+
 void ingenic_drm_plane_disable(struct device *dev, struct drm_plane *plane)
 {
 	struct ingenic_drm *priv = dev_get_drvdata(dev);
@@ -577,11 +852,163 @@ void ingenic_drm_plane_disable(struct device *dev, struct drm_plane *plane)
 	}
 }
 
+static void ingenic_drm_plane_set_position(struct ingenic_drm *priv,
+					   struct drm_plane *plane,
+					   const struct drm_plane_state *state)
+{
+	unsigned int xy_reg;
+
+	if (plane != &priv->f0)
+		xy_reg = JZ_REG_LCD_XYP1;
+	else
+		xy_reg = JZ_REG_LCD_XYP0;
+
+	regmap_write(priv->map, xy_reg,
+		     state->crtc_x << JZ_LCD_XYP01_XPOS_LSB |
+		     state->crtc_y << JZ_LCD_XYP01_YPOS_LSB);
+}
+
+/*
+ * The OSD cannot display a plane that is partially off-screen, so the cursor
+ * is cropped to its visible part, as clipped by atomic_check: its position
+ * and size registers get the visible rectangle, and if the lines are cropped,
+ * one DMA descriptor per line fetches their visible part.
+ */
+static void ingenic_drm_cursor_update(struct ingenic_drm *priv,
+				      struct drm_plane *plane,
+				      const struct drm_plane_state *state)
+{
+	struct drm_framebuffer *fb = state->fb;
+	unsigned int pitch = fb->pitches[0], cpp = fb->format->cpp[0];
+	unsigned int x = state->src.x1 >> 16, y = state->src.y1 >> 16;
+	unsigned int w = drm_rect_width(&state->dst);
+	unsigned int h = drm_rect_height(&state->dst);
+	bool use_f1 = plane != &priv->f0;
+	struct ingenic_drm_hwdescs *hwdescs;
+	struct ingenic_dma_hwdesc *hwdesc;
+	dma_addr_t addr, next_addr;
+	unsigned int i;
+
+	if (!state->visible) {
+		ingenic_drm_plane_disable(priv->dev, plane);
+		return;
+	}
+
+	addr = drm_fb_cma_get_gem_obj(fb, 0)->paddr + fb->offsets[0] +
+	       y * pitch + x * cpp;
+
+	if (fb->format->format == DRM_FORMAT_C8)
+		next_addr = dma_hwdesc_pal_addr(priv);
+	else
+		next_addr = dma_hwdesc_addr(priv, use_f1);
+
+	if (w * cpp == pitch) {
+		hwdesc = &priv->dma_hwdescs->hwdesc[use_f1];
+		hwdesc->addr = addr;
+		hwdesc->cmd = JZ_LCD_CMD_EOF_IRQ | (w * h * cpp / 4);
+		hwdesc->next = next_addr;
+	} else {
+		hwdescs = to_ingenic_drm_fb(fb)->hwdescs;
+		hwdesc = hwdescs->hwdesc;
+
+		for (i = 0; i < h; i++) {
+			hwdesc[i].next = hwdescs->phys + (i + 1) * sizeof(*hwdesc);
+			hwdesc[i].addr = addr + i * pitch;
+			hwdesc[i].cmd = w * cpp / 4;
+		}
+
+		hwdesc[h - 1].cmd |= JZ_LCD_CMD_EOF_IRQ;
+		hwdesc[h - 1].next = next_addr;
+		priv->dma_hwdescs->hwdesc[use_f1] = *hwdesc;
+	}
+
+	regmap_write(priv->map, use_f1 ? JZ_REG_LCD_XYP1 : JZ_REG_LCD_XYP0,
+		     state->dst.x1 << JZ_LCD_XYP01_XPOS_LSB |
+		     state->dst.y1 << JZ_LCD_XYP01_YPOS_LSB);
+	regmap_write(priv->map, use_f1 ? JZ_REG_LCD_SIZE1 : JZ_REG_LCD_SIZE0,
+		     w << JZ_LCD_SIZE01_WIDTH_LSB |
+		     h << JZ_LCD_SIZE01_HEIGHT_LSB);
+
+	ingenic_drm_plane_enable(priv, plane);
+}
+
+static void ingenic_drm_plane_update_blend(struct ingenic_drm *priv,
+					   const struct drm_plane_state *state)
+{
+	u32 colorkey = to_ingenic_drm_plane_state(state)->colorkey;
+	u32 osdc = 0, key = 0;
+
+	if (state->fb->format->has_alpha &&
+	    state->pixel_blend_mode != DRM_MODE_BLEND_PIXEL_NONE)
+		osdc = JZ_LCD_OSDC_ALPHAEN | JZ_LCD_OSDC_ALPHAMD;
+	else if (state->alpha != DRM_BLEND_ALPHA_OPAQUE)
+		osdc = JZ_LCD_OSDC_ALPHAEN;
+
+	if (colorkey & INGENIC_DRM_COLORKEY_ENABLE)
+		key = JZ_LCD_KEY_KEYEN | (colorkey & JZ_LCD_KEY_COLOR_MASK);
+
+	regmap_write(priv->map, JZ_REG_LCD_ALPHA, state->alpha >> 8);
+	regmap_write(priv->map, JZ_REG_LCD_KEY0, key);
+	regmap_update_bits(priv->map, JZ_REG_LCD_OSDC,
+			   JZ_LCD_OSDC_ALPHAEN | JZ_LCD_OSDC_ALPHAMD, osdc);
+}
+
+/* Period of the cache write-back of the fbdev buffer while it's on screen */
+#define INGENIC_DRM_FBDEV_FLUSH_MS	20
+
+/*
+ * The fbdev clients write into their mapping of the framebuffer without
+ * telling anybody. Its buffer is still allocated cached, as writes to
+ * uncached or write-combined memory are slow on these SoCs; instead, while
+ * it is on screen, the CPU cache is written back periodically.
+ */
+static void ingenic_drm_fbdev_flush(struct work_struct *work)
+{
+	struct ingenic_drm *priv = container_of(to_delayed_work(work),
+						struct ingenic_drm,
+						fbdev_flush_work);
+
+	if (!READ_ONCE(priv->fbdev_plane))
+		return;
+
+	dma_sync_single_for_device(priv->dev, priv->fbdev_addr,
+				   priv->fbdev_size, DMA_TO_DEVICE);
+
+	schedule_delayed_work(&priv->fbdev_flush_work,
+			      msecs_to_jiffies(INGENIC_DRM_FBDEV_FLUSH_MS));
+}
+
+static void ingenic_drm_update_fbdev_flush(struct ingenic_drm *priv,
+					   struct drm_plane *plane,
+					   struct drm_framebuffer *fb)
+{
+	struct drm_gem_cma_object *cma_obj;
+
+	if (fb && to_ingenic_gem_obj(drm_gem_fb_get_obj(fb, 0))->fbdev) {
+		cma_obj = drm_fb_cma_get_gem_obj(fb, 0);
+		if (!cma_obj->map_noncoherent)
+			return;
+
+		priv->fbdev_addr = cma_obj->paddr;
+		priv->fbdev_size = cma_obj->base.size;
+		WRITE_ONCE(priv->fbdev_plane, plane);
+		mod_delayed_work(system_wq, &priv->fbdev_flush_work, 0);
+	} else if (priv->fbdev_plane == plane) {
+		/*
+		 * A write-back already started is harmless, even once the
+		 * buffer has been freed.
+		 */
+		WRITE_ONCE(priv->fbdev_plane, NULL);
+		cancel_delayed_work(&priv->fbdev_flush_work);
+	}
+}
+
 static void ingenic_drm_plane_atomic_disable(struct drm_plane *plane,
 					     struct drm_atomic_state *state)
 {
 	struct ingenic_drm *priv = drm_device_get_priv(plane->dev);
 
+	ingenic_drm_update_fbdev_flush(priv, plane, NULL);
 	ingenic_drm_plane_disable(priv->dev, plane);
 }
 
@@ -590,7 +1017,7 @@ void ingenic_drm_plane_config(struct device *dev,
 {
 	struct ingenic_drm *priv = dev_get_drvdata(dev);
 	struct drm_plane_state *state = plane->state;
-	unsigned int xy_reg, size_reg;
+	unsigned int size_reg;
 	unsigned int ctrl = 0;
 
 	ingenic_drm_plane_enable(priv, plane);
@@ -631,6 +1058,7 @@ void ingenic_drm_plane_config(struct device *dev,
 			ctrl |= JZ_LCD_CTRL_BPP_24_COMP;
 			break;
 		case DRM_FORMAT_XRGB8888:
+		case DRM_FORMAT_ARGB8888:
 			ctrl |= JZ_LCD_CTRL_BPP_18_24;
 			break;
 		case DRM_FORMAT_XRGB2101010:
@@ -642,18 +1070,14 @@ void ingenic_drm_plane_config(struct device *dev,
 				   JZ_LCD_CTRL_BPP_MASK, ctrl);
 	}
 
-	if (priv->soc_info->has_osd) {
-		if (plane != &priv->f0) {
-			xy_reg = JZ_REG_LCD_XYP1;
+	/* The position and size of the cursor are set by its own update */
+	if (priv->soc_info->has_osd && plane->type != DRM_PLANE_TYPE_CURSOR) {
+		if (plane != &priv->f0)
 			size_reg = JZ_REG_LCD_SIZE1;
-		} else {
-			xy_reg = JZ_REG_LCD_XYP0;
+		else
 			size_reg = JZ_REG_LCD_SIZE0;
-		}
 
-		regmap_write(priv->map, xy_reg,
-			     state->crtc_x << JZ_LCD_XYP01_XPOS_LSB |
-			     state->crtc_y << JZ_LCD_XYP01_YPOS_LSB);
+		ingenic_drm_plane_set_position(priv, plane, state);
 		regmap_write(priv->map, size_reg,
 			     state->crtc_w << JZ_LCD_SIZE01_WIDTH_LSB |
 			     state->crtc_h << JZ_LCD_SIZE01_HEIGHT_LSB);
@@ -674,6 +1098,161 @@ static void ingenic_drm_update_palette(struct ingenic_drm *priv,
 	}
 }
 
+static void ingenic_drm_sync_damage(struct ingenic_drm *priv,
+				    struct drm_plane_state *oldstate,
+				    struct drm_plane_state *newstate)
+{
+	struct drm_framebuffer *fb = newstate->fb;
+	struct drm_atomic_helper_damage_iter iter;
+	const struct drm_gem_cma_object *cma_obj;
+	unsigned int cpp = fb->format->cpp[0];
+	unsigned int pitch = fb->pitches[0];
+	unsigned int y, line_bytes;
+	struct drm_rect clip;
+	dma_addr_t daddr;
+
+	cma_obj = drm_fb_cma_get_gem_obj(fb, 0);
+	if (!cma_obj->map_noncoherent)
+		return;
+
+	daddr = cma_obj->paddr + fb->offsets[0];
+
+	drm_atomic_helper_damage_iter_init(&iter, oldstate, newstate);
+
+	drm_atomic_for_each_plane_damage(&iter, &clip) {
+		line_bytes = (clip.x2 - clip.x1) * cpp;
+
+		/*
+		 * Writing back a single range is cheaper than doing one cache
+		 * operation per line, unless the damaged rectangle only covers
+		 * a small part of each line; in that case only write back the
+		 * damaged part of each line.
+		 */
+		if (line_bytes >= pitch / 2) {
+			dma_sync_single_for_device(priv->dev,
+						   daddr + clip.y1 * pitch,
+						   (clip.y2 - clip.y1) * pitch,
+						   DMA_TO_DEVICE);
+			continue;
+		}
+
+		for (y = clip.y1; y < clip.y2; y++) {
+			dma_sync_single_for_device(priv->dev,
+						   daddr + y * pitch + clip.x1 * cpp,
+						   line_bytes, DMA_TO_DEVICE);
+		}
+	}
+}
+
+static void ingenic_drm_release_async_old_fb(struct ingenic_drm *priv,
+					     unsigned int i)
+{
+	struct drm_framebuffer *fb = xchg(&priv->async_old_fb[i], NULL);
+
+	if (fb) {
+		drm_framebuffer_put(fb);
+		drm_crtc_vblank_put(&priv->crtc);
+	}
+}
+
+static void ingenic_drm_async_old_fb_work(struct work_struct *work)
+{
+	struct ingenic_drm *priv = container_of(work, struct ingenic_drm,
+						async_old_fb_work);
+	unsigned int i, fid;
+
+	for (i = 0; i < ARRAY_SIZE(priv->async_old_fb); i++) {
+		if (!READ_ONCE(priv->async_old_fb[i]))
+			continue;
+
+		regmap_read(priv->map, i ? JZ_REG_LCD_FID1 : JZ_REG_LCD_FID0, &fid);
+
+		/* Still fetching the main descriptor, or the palette before it */
+		if (fid == priv->dma_hwdescs->hwdesc[i].id ||
+		    fid == priv->dma_hwdescs->hwdesc_pal.id)
+			continue;
+
+		ingenic_drm_release_async_old_fb(priv, i);
+	}
+}
+
+static void ingenic_drm_release_async_fbs(struct ingenic_drm *priv)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(priv->async_fb); i++) {
+		if (priv->async_pending[i] >= 0)
+			continue;
+
+		ingenic_drm_release_async_old_fb(priv, i);
+
+		for (j = 0; j < INGENIC_DRM_ASYNC_SLOTS; j++) {
+			if (priv->async_fb[i][j]) {
+				drm_framebuffer_put(priv->async_fb[i][j]);
+				priv->async_fb[i][j] = NULL;
+			}
+		}
+	}
+}
+
+static void ingenic_drm_plane_async_flip(struct ingenic_drm *priv,
+					 struct drm_plane_state *state,
+					 struct drm_framebuffer *old_fb,
+					 bool use_f1, dma_addr_t addr, u32 cmd)
+{
+	struct ingenic_dma_hwdesc *slots = priv->dma_hwdescs->hwdesc_async[use_f1];
+	unsigned int i, fid, slot, live = INGENIC_DRM_ASYNC_SLOTS;
+	dma_addr_t slot_addr;
+
+	/* Find out which descriptor is being scanned out right now */
+	regmap_read(priv->map, use_f1 ? JZ_REG_LCD_FID1 : JZ_REG_LCD_FID0, &fid);
+
+	for (i = 0; i < INGENIC_DRM_ASYNC_SLOTS; i++) {
+		if (slots[i].id == fid)
+			live = i;
+	}
+
+	for (slot = 0; slot < INGENIC_DRM_ASYNC_SLOTS; slot++) {
+		if (slot != live && slot != priv->async_pending[use_f1])
+			break;
+	}
+
+	/* This descriptor cannot be fetched anymore; drop its framebuffer */
+	if (priv->async_fb[use_f1][slot])
+		drm_framebuffer_put(priv->async_fb[use_f1][slot]);
+
+	drm_framebuffer_get(state->fb);
+	priv->async_fb[use_f1][slot] = state->fb;
+
+	slot_addr = dma_hwdesc_async_addr(priv, use_f1, slot);
+	slots[slot].addr = addr;
+	slots[slot].cmd = cmd;
+	slots[slot].next = slot_addr;
+
+	/* Make sure the descriptor is complete before linking to it */
+	wmb();
+
+	priv->dma_hwdescs->hwdesc[use_f1].next = slot_addr;
+	for (i = 0; i < INGENIC_DRM_ASYNC_SLOTS; i++) {
+		if (i != slot)
+			slots[i].next = slot_addr;
+	}
+
+	/*
+	 * The framebuffer of the main descriptor is released by the cleanup
+	 * of this commit, while it may still be scanned out; hold on to it
+	 * until it isn't.
+	 */
+	if (priv->async_pending[use_f1] < 0 && old_fb &&
+	    !priv->async_old_fb[use_f1] &&
+	    !drm_crtc_vblank_get(&priv->crtc)) {
+		drm_framebuffer_get(old_fb);
+		WRITE_ONCE(priv->async_old_fb[use_f1], old_fb);
+	}
+
+	priv->async_pending[use_f1] = slot;
+}
+
 static void ingenic_drm_plane_atomic_update(struct drm_plane *plane,
 					    struct drm_atomic_state *state)
 {
@@ -684,40 +1263,82 @@ static void ingenic_drm_plane_atomic_update(struct drm_plane *plane,
 	struct drm_crtc_state *crtc_state;
 	struct ingenic_dma_hwdesc *hwdesc;
 	unsigned int width, height, cpp, i;
-	struct drm_gem_object *gem_obj;
-	struct ingenic_gem_object *obj;
+	struct ingenic_drm_hwdescs *hwdescs;
 	dma_addr_t addr, next_addr;
 	bool use_f1;
 	u32 fourcc;
 
 	if (newstate && newstate->fb) {
-		drm_fb_cma_sync_non_coherent(&priv->drm, oldstate, newstate);
+		ingenic_drm_sync_damage(priv, oldstate, newstate);
+		ingenic_drm_update_fbdev_flush(priv, plane, newstate->fb);
 
 		crtc_state = newstate->crtc->state;
 		use_f1 = priv->soc_info->has_osd && plane != &priv->f0;
+		priv_state = ingenic_drm_get_new_priv_state(priv, state);
+
+		if (priv->soc_info->has_osd && !use_f1)
+			ingenic_drm_plane_update_blend(priv, newstate);
+
+		if (plane->type == DRM_PLANE_TYPE_CURSOR) {
+			/* Showing the cursor doesn't go through a modeset */
+			if (drm_atomic_crtc_needs_modeset(crtc_state) ||
+			    !oldstate->fb) {
+				fourcc = newstate->fb->format->format;
+				ingenic_drm_plane_config(priv->dev, plane, fourcc);
+				crtc_state->color_mgmt_changed |= fourcc == DRM_FORMAT_C8;
+			}
+
+			ingenic_drm_cursor_update(priv, plane, newstate);
+
+			if (crtc_state->color_mgmt_changed)
+				ingenic_drm_update_palette(priv, crtc_state->gamma_lut->data);
+			return;
+		}
+
+		/*
+		 * If only the content of the framebuffer changed, the DMA
+		 * descriptors already point to the right memory; there is no
+		 * need to rebuild them (which, in doublescan mode, means
+		 * rewriting one descriptor per line).
+		 */
+		if (!drm_atomic_crtc_needs_modeset(crtc_state) &&
+		    !crtc_state->color_mgmt_changed &&
+		    oldstate->fb == newstate->fb &&
+		    oldstate->src_x == newstate->src_x &&
+		    oldstate->src_y == newstate->src_y &&
+		    oldstate->src_w == newstate->src_w &&
+		    oldstate->src_h == newstate->src_h &&
+		    oldstate->crtc_h == newstate->crtc_h)
+			return;
 
 		addr = drm_fb_cma_get_gem_addr(newstate->fb, newstate, 0);
 		width = newstate->src_w >> 16;
 		height = newstate->src_h >> 16;
 		cpp = newstate->fb->format->cpp[0];
 
-		gem_obj = drm_gem_fb_get_obj(newstate->fb, 0);
-		obj = to_ingenic_gem_obj(gem_obj);
+		if (crtc_state->async_flip) {
+			ingenic_drm_plane_async_flip(priv, newstate, oldstate->fb,
+						     use_f1, addr,
+						     JZ_LCD_CMD_EOF_IRQ |
+						     (width * height * cpp / 4));
+			return;
+		}
+
+		hwdescs = to_ingenic_drm_fb(newstate->fb)->hwdescs;
 
-		priv_state = ingenic_drm_get_new_priv_state(priv, state);
 		if (priv_state && priv_state->use_palette)
 			next_addr = dma_hwdesc_pal_addr(priv);
 		else
 			next_addr = dma_hwdesc_addr(priv, use_f1);
 
 		if (priv_state->doublescan) {
-			hwdesc = &obj->hwdescs[0];
+			hwdesc = &hwdescs->hwdesc[0];
 			/*
 			 * Use one DMA descriptor per output line, and display
 			 * each input line twice.
 			 */
 			for (i = 0; i < newstate->crtc_h; i++) {
-				hwdesc[i].next = obj->hwdescs_phys
+				hwdesc[i].next = hwdescs->phys
 					+ (i + 1) * sizeof(*hwdesc);
 				hwdesc[i].addr = addr + (i / 2) * newstate->fb->pitches[0];
 				hwdesc[i].cmd = newstate->fb->pitches[0] / 4;
@@ -735,6 +1356,22 @@ static void ingenic_drm_plane_atomic_update(struct drm_plane *plane,
 			hwdesc->next = next_addr;
 		}
 
+		if (priv->async_pending[use_f1] >= 0) {
+			/*
+			 * Leave asynchronous mode: redirect the descriptor ring
+			 * back to the main descriptor. The framebuffers will
+			 * be released once the next VBLANK has passed.
+			 */
+			wmb();
+
+			for (i = 0; i < INGENIC_DRM_ASYNC_SLOTS; i++) {
+				priv->dma_hwdescs->hwdesc_async[use_f1][i].next =
+					dma_hwdesc_addr(priv, use_f1);
+			}
+
+			priv->async_pending[use_f1] = -1;
+		}
+
 		if (drm_atomic_crtc_needs_modeset(crtc_state)) {
 			fourcc = newstate->fb->format->format;
 
@@ -748,6 +1385,44 @@ static void ingenic_drm_plane_atomic_update(struct drm_plane *plane,
 	}
 }
 
+static int ingenic_drm_plane_atomic_async_check(struct drm_plane *plane,
+						struct drm_atomic_state *state)
+{
+	struct drm_plane_state *old_plane_state = drm_atomic_get_old_plane_state(state,
+										 plane);
+	struct drm_plane_state *new_plane_state = drm_atomic_get_new_plane_state(state,
+										 plane);
+
+	/* Only moving the cursor can be done asynchronously */
+	if (plane->type != DRM_PLANE_TYPE_CURSOR ||
+	    !old_plane_state->fb || old_plane_state->fb != new_plane_state->fb ||
+	    old_plane_state->src_x != new_plane_state->src_x ||
+	    old_plane_state->src_y != new_plane_state->src_y ||
+	    old_plane_state->src_w != new_plane_state->src_w ||
+	    old_plane_state->src_h != new_plane_state->src_h ||
+	    old_plane_state->crtc_w != new_plane_state->crtc_w ||
+	    old_plane_state->crtc_h != new_plane_state->crtc_h)
+		return -EINVAL;
+
+	return 0;
+}
+
+static void ingenic_drm_plane_atomic_async_update(struct drm_plane *plane,
+						  struct drm_atomic_state *state)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(plane->dev);
+	struct drm_plane_state *new_plane_state = drm_atomic_get_new_plane_state(state,
+										 plane);
+
+	plane->state->crtc_x = new_plane_state->crtc_x;
+	plane->state->crtc_y = new_plane_state->crtc_y;
+	plane->state->src = new_plane_state->src;
+	plane->state->dst = new_plane_state->dst;
+	plane->state->visible = new_plane_state->visible;
+
+	ingenic_drm_cursor_update(priv, plane, plane->state);
+}
+
 static void ingenic_drm_encoder_atomic_mode_set(struct drm_encoder *encoder,
 						struct drm_crtc_state *crtc_state,
 						struct drm_connector_state *conn_state)
@@ -856,28 +1531,152 @@ static int ingenic_drm_bridge_atomic_check(struct drm_bridge *bridge,
 	return 0;
 }
 
-static void ingenic_drm_atomic_helper_commit_tail(struct drm_atomic_state *old_state)
+/*
+ * Returns true if the two modes only differ by their vertical blanking, i.e.
+ * they have the same pixel clock, horizontal timings and active area and
+ * only the refresh rate changes.
+ */
+static bool ingenic_drm_mode_vblank_only(const struct drm_display_mode *old,
+					 const struct drm_display_mode *new)
 {
-	/*
-	 * Just your regular drm_atomic_helper_commit_tail(), but only calls
-	 * drm_atomic_helper_wait_for_vblanks() if priv->no_vblank.
-	 */
-	struct drm_device *dev = old_state->dev;
-	struct ingenic_drm *priv = drm_device_get_priv(dev);
-	struct ingenic_drm_private_state *priv_state;
+	return old->crtc_clock == new->crtc_clock &&
+		old->crtc_hdisplay == new->crtc_hdisplay &&
+		old->crtc_hsync_start == new->crtc_hsync_start &&
+		old->crtc_hsync_end == new->crtc_hsync_end &&
+		old->crtc_htotal == new->crtc_htotal &&
+		old->crtc_vdisplay == new->crtc_vdisplay &&
+		old->flags == new->flags;
+}
 
-	drm_atomic_helper_commit_modeset_disables(dev, old_state);
+static int ingenic_drm_atomic_check(struct drm_device *drm,
+				    struct drm_atomic_state *state)
+{
+	struct drm_crtc_state *old_crtc_state, *new_crtc_state;
+	struct drm_crtc *crtc;
+	int ret, i;
 
-	drm_atomic_helper_commit_planes(dev, old_state, 0);
+	ret = drm_atomic_helper_check_modeset(drm, state);
+	if (ret)
+		return ret;
+
+	/*
+	 * Changing the vertical blanking of an enabled CRTC does not need a
+	 * modeset: the pixel clock and the planes stay the same, and the new
+	 * timings can be written while the LCD controller is running. This
+	 * allows userspace to match the refresh rate of the content without
+	 * the panel blanking. The planes may still require a modeset below.
+	 */
+	for_each_oldnew_crtc_in_state(state, crtc, old_crtc_state,
+				      new_crtc_state, i) {
+		if (new_crtc_state->mode_changed &&
+		    old_crtc_state->active && new_crtc_state->active &&
+		    !new_crtc_state->active_changed &&
+		    !new_crtc_state->connectors_changed &&
+		    ingenic_drm_mode_vblank_only(&old_crtc_state->adjusted_mode,
+						 &new_crtc_state->adjusted_mode))
+			new_crtc_state->mode_changed = false;
+	}
+
+	ret = drm_atomic_helper_check_planes(drm, state);
+	if (ret)
+		return ret;
+
+	if (state->legacy_cursor_update)
+		state->async_update = !drm_atomic_helper_async_check(drm, state);
+
+	return 0;
+}
+
+static void ingenic_drm_update_commit_stats(struct ingenic_drm *priv,
+					    ktime_t start, u64 vblank_start)
+{
+	unsigned int bucket, missed;
+	ktime_t vblank_time;
+	s64 latency;
+	u64 vblank;
+
+	vblank = drm_crtc_vblank_count_and_time(&priv->crtc, &vblank_time);
+	latency = ktime_us_delta(vblank_time, start);
+
+	/* The new state is normally latched at the first VBLANK */
+	missed = vblank > vblank_start + 1 ? vblank - vblank_start - 1 : 0;
+
+	bucket = clamp_t(s64, div_s64(latency, INGENIC_DRM_LATENCY_BUCKET_US),
+			 0, INGENIC_DRM_LATENCY_BUCKETS - 1);
+
+	WRITE_ONCE(priv->latency[bucket], priv->latency[bucket] + 1);
+	WRITE_ONCE(priv->missed_vblanks, priv->missed_vblanks + missed);
+	WRITE_ONCE(priv->commits, priv->commits + 1);
+
+	trace_ingenic_drm_commit_latency(&priv->drm, latency, missed);
+}
+
+static void ingenic_drm_atomic_helper_commit_tail(struct drm_atomic_state *old_state)
+{
+	/*
+	 * Just your regular drm_atomic_helper_commit_tail(), but only calls
+	 * drm_atomic_helper_wait_for_vblanks() if priv->no_vblank.
+	 */
+	struct drm_device *dev = old_state->dev;
+	struct ingenic_drm *priv = drm_device_get_priv(dev);
+	struct ingenic_drm_private_state *priv_state;
+	struct drm_crtc_state *crtc_state;
+	struct drm_crtc *crtc = &priv->crtc;
+	u32 avg_bw = 0, peak_bw = 0;
+	u64 vblank_start;
+	bool async_flip;
+	ktime_t start;
+
+	start = ktime_get();
+	vblank_start = drm_crtc_vblank_count(crtc);
+	trace_ingenic_drm_commit_begin(dev, vblank_start);
+
+	priv_state = ingenic_drm_get_new_priv_state(priv, old_state);
+
+	if (priv_state) {
+		avg_bw = priv_state->avg_bw[0] + priv_state->avg_bw[1];
+		peak_bw = priv_state->peak_bw[0] + priv_state->peak_bw[1];
+
+		/*
+		 * The old framebuffers are scanned out until the next VBLANK,
+		 * so only lower the bandwidth once the commit is done.
+		 */
+		ingenic_drm_set_bandwidth(priv, max(avg_bw, priv->avg_bw),
+					  max(peak_bw, priv->peak_bw));
+	}
+
+	drm_atomic_helper_commit_modeset_disables(dev, old_state);
+	trace_ingenic_drm_commit_disables(dev, drm_crtc_vblank_count(crtc));
+
+	drm_atomic_helper_commit_planes(dev, old_state, 0);
+	trace_ingenic_drm_commit_planes(dev, drm_crtc_vblank_count(crtc));
 
 	drm_atomic_helper_commit_modeset_enables(dev, old_state);
+	trace_ingenic_drm_commit_enables(dev, drm_crtc_vblank_count(crtc));
 
 	drm_atomic_helper_commit_hw_done(old_state);
 
-	priv_state = ingenic_drm_get_new_priv_state(priv, old_state);
+	crtc_state = drm_atomic_get_new_crtc_state(old_state, crtc);
+	async_flip = crtc_state && crtc_state->async_flip;
 
-	if (!priv_state || !priv_state->no_vblank)
-		drm_atomic_helper_wait_for_vblanks(dev, old_state);
+	if (!async_flip) {
+		if (!priv_state || !priv_state->no_vblank) {
+			drm_atomic_helper_wait_for_vblanks(dev, old_state);
+
+			/* The VBLANK counter is meaningless across a modeset */
+			if (crtc_state && crtc_state->active &&
+			    !drm_atomic_crtc_needs_modeset(crtc_state))
+				ingenic_drm_update_commit_stats(priv, start,
+								vblank_start);
+		}
+
+		ingenic_drm_release_async_fbs(priv);
+	}
+
+	trace_ingenic_drm_commit_done(dev, drm_crtc_vblank_count(crtc));
+
+	if (priv_state)
+		ingenic_drm_set_bandwidth(priv, avg_bw, peak_bw);
 
 	drm_atomic_helper_cleanup_planes(dev, old_state);
 }
@@ -892,9 +1691,14 @@ static irqreturn_t ingenic_drm_irq_handler(int irq, void *arg)
 	regmap_update_bits(priv->map, JZ_REG_LCD_STATE,
 			   JZ_LCD_STATE_EOF_IRQ, 0);
 
-	if (state & JZ_LCD_STATE_EOF_IRQ)
+	if (state & JZ_LCD_STATE_EOF_IRQ) {
 		drm_crtc_handle_vblank(&priv->crtc);
 
+		if (READ_ONCE(priv->async_old_fb[0]) ||
+		    READ_ONCE(priv->async_old_fb[1]))
+			schedule_work(&priv->async_old_fb_work);
+	}
+
 	return IRQ_HANDLED;
 }
 
@@ -915,15 +1719,59 @@ static void ingenic_drm_disable_vblank(struct drm_crtc *crtc)
 	regmap_update_bits(priv->map, JZ_REG_LCD_CTRL, JZ_LCD_CTRL_EOF_IRQ, 0);
 }
 
+static struct ingenic_drm_hwdescs *
+ingenic_drm_alloc_hwdescs(struct ingenic_drm *priv, size_t size)
+{
+	struct ingenic_drm_hwdescs *hwdescs;
+
+	hwdescs = kzalloc(sizeof(*hwdescs), GFP_KERNEL);
+	if (!hwdescs)
+		return NULL;
+
+	hwdescs->size = size;
+	hwdescs->hwdesc = ingenic_drm_pool_alloc(priv->pool, &hwdescs->size,
+						 INGENIC_DRM_BUF_COHERENT,
+						 &hwdescs->phys);
+	if (!hwdescs->hwdesc) {
+		kfree(hwdescs);
+		return NULL;
+	}
+
+	hwdescs->users = 1;
+
+	return hwdescs;
+}
+
+/* Must be called with priv->hwdescs_lock held */
+static void ingenic_drm_put_hwdescs(struct ingenic_drm *priv,
+				    struct ingenic_drm_hwdescs *hwdescs)
+{
+	if (!hwdescs || --hwdescs->users)
+		return;
+
+	ingenic_drm_pool_free(priv->pool, hwdescs->size,
+			      INGENIC_DRM_BUF_COHERENT,
+			      hwdescs->hwdesc, hwdescs->phys);
+	kfree(hwdescs);
+}
+
+static void ingenic_drm_gem_free_hwdescs(struct ingenic_drm *priv,
+					 struct ingenic_gem_object *obj)
+{
+	mutex_lock(&priv->hwdescs_lock);
+	ingenic_drm_put_hwdescs(priv, obj->hwdescs);
+	obj->hwdescs = NULL;
+	mutex_unlock(&priv->hwdescs_lock);
+}
+
 static void ingenic_drm_gem_fb_destroy(struct drm_framebuffer *fb)
 {
 	struct ingenic_drm *priv = drm_device_get_priv(fb->dev);
-	struct drm_gem_object *gem_obj = drm_gem_fb_get_obj(fb, 0);
-	struct ingenic_gem_object *obj = to_ingenic_gem_obj(gem_obj);
 
-	dma_free_coherent(priv->dev,
-			  sizeof(*obj->hwdescs) * fb->height,
-			  obj->hwdescs, obj->hwdescs_phys);
+	mutex_lock(&priv->hwdescs_lock);
+	ingenic_drm_put_hwdescs(priv, to_ingenic_drm_fb(fb)->hwdescs);
+	mutex_unlock(&priv->hwdescs_lock);
+
 	drm_gem_fb_destroy(fb);
 }
 
@@ -949,32 +1797,84 @@ static const struct drm_framebuffer_funcs ingenic_drm_gem_fb_funcs = {
 	.dirty          = ingenic_drm_atomic_helper_dirtyfb,
 };
 
+/*
+ * Framebuffers backed by write-combined buffers need no cache maintenance,
+ * so they don't need to be told about the damage either; neither does the
+ * one of the fbdev emulation, see ingenic_drm_fbdev_flush(). Without a dirty
+ * callback, the fbdev emulation maps it directly instead of going through
+ * a shadow buffer and deferred I/O.
+ */
+static const struct drm_framebuffer_funcs ingenic_drm_gem_fb_funcs_wc = {
+	.destroy	= ingenic_drm_gem_fb_destroy,
+	.create_handle	= drm_gem_fb_create_handle,
+};
+
 static struct drm_framebuffer *
 ingenic_drm_gem_fb_create(struct drm_device *dev, struct drm_file *file,
 			  const struct drm_mode_fb_cmd2 *mode_cmd)
 {
 	struct ingenic_drm *priv = drm_device_get_priv(dev);
+	const struct drm_framebuffer_funcs *funcs;
+	struct ingenic_drm_hwdescs *hwdescs;
 	struct drm_gem_object *gem_obj;
 	struct ingenic_gem_object *obj;
+	struct ingenic_drm_fb *ifb;
 	struct drm_framebuffer *fb;
+	size_t size;
+	int ret;
 
-	fb = drm_gem_fb_create_with_funcs(dev, file, mode_cmd,
-					  &ingenic_drm_gem_fb_funcs);
-	if (IS_ERR(fb))
-		return fb;
+	gem_obj = drm_gem_object_lookup(file, mode_cmd->handles[0]);
+	if (!gem_obj)
+		return ERR_PTR(-ENOENT);
+
+	if (to_drm_gem_cma_obj(gem_obj)->map_noncoherent &&
+	    !to_ingenic_gem_obj(gem_obj)->fbdev)
+		funcs = &ingenic_drm_gem_fb_funcs;
+	else
+		funcs = &ingenic_drm_gem_fb_funcs_wc;
+	drm_gem_object_put(gem_obj);
+
+	ifb = kzalloc(sizeof(*ifb), GFP_KERNEL);
+	if (!ifb)
+		return ERR_PTR(-ENOMEM);
+
+	fb = &ifb->base;
+	ret = drm_gem_fb_init_with_funcs(dev, fb, file, mode_cmd, funcs);
+	if (ret) {
+		kfree(ifb);
+		return ERR_PTR(ret);
+	}
 
 	gem_obj = drm_gem_fb_get_obj(fb, 0);
 	obj = to_ingenic_gem_obj(gem_obj);
 
 	/*
-	 * Create (fb->height * 2) DMA descriptors, in case we want to use the
-	 * doublescan feature.
+	 * Use (fb->height * 2) DMA descriptors, in case we want to use the
+	 * doublescan feature. Reuse the ones of the GEM object if they are big
+	 * enough, otherwise allocate bigger ones for this and the next
+	 * framebuffers; the ones already in use stay with their framebuffers.
 	 */
-	obj->hwdescs = dma_alloc_coherent(priv->dev,
-					  sizeof(*obj->hwdescs) * fb->height * 2,
-					  &obj->hwdescs_phys,
-					  GFP_KERNEL);
-	if (!obj->hwdescs) {
+	size = sizeof(*hwdescs->hwdesc) * fb->height * 2;
+
+	mutex_lock(&priv->hwdescs_lock);
+
+	hwdescs = obj->hwdescs;
+	if (!hwdescs || hwdescs->size < size) {
+		hwdescs = ingenic_drm_alloc_hwdescs(priv, size);
+		if (hwdescs) {
+			ingenic_drm_put_hwdescs(priv, obj->hwdescs);
+			obj->hwdescs = hwdescs;
+		}
+	}
+
+	if (hwdescs) {
+		hwdescs->users++;
+		ifb->hwdescs = hwdescs;
+	}
+
+	mutex_unlock(&priv->hwdescs_lock);
+
+	if (!hwdescs) {
 		drm_gem_fb_destroy(fb);
 		return ERR_PTR(-ENOMEM);
 	}
@@ -982,21 +1882,336 @@ ingenic_drm_gem_fb_create(struct drm_device *dev, struct drm_file *file,
 	return fb;
 }
 
+static void ingenic_drm_gem_import_free_object(struct drm_gem_object *gem_obj)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(gem_obj->dev);
+
+	ingenic_drm_gem_free_hwdescs(priv, to_ingenic_gem_obj(gem_obj));
+	drm_gem_cma_free_object(gem_obj);
+}
+
+/* Same as the CMA helpers' defaults, but also frees the DMA descriptors */
+static const struct drm_gem_object_funcs ingenic_drm_gem_import_funcs = {
+	.free		= ingenic_drm_gem_import_free_object,
+	.print_info	= drm_gem_cma_print_info,
+	.get_sg_table	= drm_gem_cma_get_sg_table,
+	.vmap		= drm_gem_cma_vmap,
+	.mmap		= drm_gem_cma_mmap,
+	.vm_ops		= &drm_gem_cma_vm_ops,
+};
+
 static struct drm_gem_object *
 ingenic_drm_gem_create_object(struct drm_device *drm, size_t size)
+{
+	struct ingenic_gem_object *obj;
+
+	obj = kzalloc(sizeof(*obj), GFP_KERNEL);
+	if (!obj)
+		return ERR_PTR(-ENOMEM);
+
+	obj->base.base.funcs = &ingenic_drm_gem_import_funcs;
+
+	return &obj->base.base;
+}
+
+static void ingenic_drm_gem_free_object(struct drm_gem_object *gem_obj)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(gem_obj->dev);
+	struct ingenic_gem_object *obj = to_ingenic_gem_obj(gem_obj);
+
+	ingenic_drm_gem_free_hwdescs(priv, obj);
+
+	if (obj->base.vaddr) {
+		ingenic_drm_pool_free(priv->pool, obj->buf_size,
+				      obj->base.map_noncoherent ?
+				      INGENIC_DRM_BUF_NONCOHERENT :
+				      INGENIC_DRM_BUF_WC,
+				      obj->base.vaddr, obj->base.paddr);
+	}
+
+	drm_gem_object_release(gem_obj);
+	kfree(obj);
+}
+
+static const struct drm_gem_object_funcs ingenic_drm_gem_funcs = {
+	.free		= ingenic_drm_gem_free_object,
+	.print_info	= drm_gem_cma_print_info,
+	.get_sg_table	= drm_gem_cma_get_sg_table,
+	.vmap		= drm_gem_cma_vmap,
+	.mmap		= drm_gem_cma_mmap,
+	.vm_ops		= &drm_gem_cma_vm_ops,
+};
+
+/*
+ * Same as drm_gem_cma_create(), but the backing memory comes from the buffer
+ * cache. Imported buffers still go through the CMA helpers.
+ */
+static struct ingenic_gem_object *
+ingenic_drm_gem_create(struct drm_device *drm, size_t size, bool fbdev)
 {
 	struct ingenic_drm *priv = drm_device_get_priv(drm);
 	struct ingenic_gem_object *obj;
+	struct drm_gem_object *gem_obj;
+	int ret;
+
+	size = round_up(size, PAGE_SIZE);
 
 	obj = kzalloc(sizeof(*obj), GFP_KERNEL);
 	if (!obj)
 		return ERR_PTR(-ENOMEM);
 
+	gem_obj = &obj->base.base;
+	gem_obj->funcs = &ingenic_drm_gem_funcs;
+
+	ret = drm_gem_object_init(drm, gem_obj, size);
+	if (ret) {
+		kfree(obj);
+		return ERR_PTR(ret);
+	}
+
+	ret = drm_gem_create_mmap_offset(gem_obj);
+	if (ret)
+		goto err_put;
+
 	obj->base.map_noncoherent = priv->soc_info->map_noncoherent;
+	obj->fbdev = fbdev;
+	obj->buf_size = size;
+	obj->base.vaddr = ingenic_drm_pool_alloc(priv->pool, &obj->buf_size,
+						 obj->base.map_noncoherent ?
+						 INGENIC_DRM_BUF_NONCOHERENT :
+						 INGENIC_DRM_BUF_WC,
+						 &obj->base.paddr);
+	if (!obj->base.vaddr) {
+		dev_dbg(priv->dev, "Failed to allocate buffer of %zu bytes\n", size);
+		ret = -ENOMEM;
+		goto err_put;
+	}
 
-	return &obj->base.base;
+	return obj;
+
+err_put:
+	drm_gem_object_put(gem_obj);
+	return ERR_PTR(ret);
 }
 
+/*
+ * The fbdev clients write to the framebuffer without telling anybody; mark
+ * the buffer of the fbdev emulation, so that its cache is written back while
+ * it is on screen.
+ */
+static int ingenic_drm_dumb_create(struct drm_file *file,
+				   struct drm_device *drm,
+				   struct drm_mode_create_dumb *args)
+{
+	bool fbdev = drm->fb_helper && file == drm->fb_helper->client.file;
+	struct ingenic_gem_object *obj;
+	int ret;
+
+	args->pitch = DIV_ROUND_UP(args->width * args->bpp, 8);
+	args->size = args->pitch * args->height;
+
+	obj = ingenic_drm_gem_create(drm, args->size, fbdev);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+
+	ret = drm_gem_handle_create(file, &obj->base.base, &args->handle);
+	/* drop reference from allocate - handle holds it now. */
+	drm_gem_object_put(&obj->base.base);
+
+	return ret;
+}
+
+static struct drm_gem_object *
+ingenic_drm_gem_prime_import_sg_table(struct drm_device *drm,
+				      struct dma_buf_attachment *attach,
+				      struct sg_table *sgt)
+{
+	struct drm_gem_object *gem_obj;
+
+	gem_obj = drm_gem_cma_prime_import_sg_table(drm, attach, sgt);
+	if (IS_ERR(gem_obj))
+		return gem_obj;
+
+	/*
+	 * Imported buffers are typically filled by another device (e.g. the
+	 * VPU); keeping the CPU caches coherent is the job of the exporter
+	 * and of whoever accesses the buffer with the CPU, so there is no
+	 * need to write back the caches before each scanout.
+	 */
+	to_drm_gem_cma_obj(gem_obj)->map_noncoherent = false;
+
+	return gem_obj;
+}
+
+static void ingenic_drm_blit_done(void *data)
+{
+	complete(data);
+}
+
+/*
+ * The DMA controller chains one hardware descriptor per line, and can only
+ * chain a page worth of them, 256 with 4 KiB pages; taller rectangles are
+ * copied in several chunks.
+ */
+#define INGENIC_DRM_BLIT_MAX_LINES	256
+
+static int ingenic_drm_blit_chunk(struct ingenic_drm *priv,
+				  struct dma_interleaved_template *xt)
+{
+	struct dma_async_tx_descriptor *desc;
+	DECLARE_COMPLETION_ONSTACK(done);
+	dma_cookie_t cookie;
+	int ret;
+
+	desc = dmaengine_prep_interleaved_dma(priv->blit_chan, xt,
+					      DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+	if (!desc)
+		return -EINVAL;
+
+	desc->callback = ingenic_drm_blit_done;
+	desc->callback_param = &done;
+
+	cookie = dmaengine_submit(desc);
+	ret = dma_submit_error(cookie);
+	if (ret)
+		return ret;
+
+	dma_async_issue_pending(priv->blit_chan);
+
+	if (!wait_for_completion_timeout(&done, msecs_to_jiffies(1000))) {
+		dmaengine_terminate_sync(priv->blit_chan);
+		return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+static int ingenic_drm_gem_blit_ioctl(struct drm_device *drm, void *data,
+				      struct drm_file *file)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(drm);
+	struct drm_ingenic_gem_blit *args = data;
+	struct drm_gem_cma_object *src, *dst;
+	struct drm_gem_object *src_obj, *dst_obj;
+	struct dma_interleaved_template *xt;
+	u64 src_end, dst_end;
+	dma_addr_t src_addr, dst_addr;
+	size_t src_size, dst_size;
+	unsigned int line, lines;
+	struct device *dma_dev;
+	int ret = 0;
+
+	if (!priv->blit_chan)
+		return -ENODEV;
+
+	/* The caches are maintained for the device doing the transfer */
+	dma_dev = priv->blit_chan->device->dev;
+
+	if (args->flags || args->pad)
+		return -EINVAL;
+
+	if (!args->width || !args->height)
+		return 0;
+
+	if ((args->src_offset | args->dst_offset | args->src_pitch |
+	     args->dst_pitch | args->width) & 0x3)
+		return -EINVAL;
+
+	if (args->src_pitch < args->width || args->dst_pitch < args->width)
+		return -EINVAL;
+
+	src_obj = drm_gem_object_lookup(file, args->src_handle);
+	if (!src_obj)
+		return -ENOENT;
+
+	dst_obj = drm_gem_object_lookup(file, args->dst_handle);
+	if (!dst_obj) {
+		ret = -ENOENT;
+		goto out_put_src;
+	}
+
+	src = to_drm_gem_cma_obj(src_obj);
+	dst = to_drm_gem_cma_obj(dst_obj);
+
+	src_end = (u64)args->src_offset +
+		  (u64)args->src_pitch * (args->height - 1) + args->width;
+	dst_end = (u64)args->dst_offset +
+		  (u64)args->dst_pitch * (args->height - 1) + args->width;
+
+	if (src_end > src_obj->size || dst_end > dst_obj->size) {
+		ret = -EINVAL;
+		goto out_put_dst;
+	}
+
+	xt = kzalloc(struct_size(xt, sgl, 1), GFP_KERNEL);
+	if (!xt) {
+		ret = -ENOMEM;
+		goto out_put_dst;
+	}
+
+	src_addr = src->paddr + args->src_offset;
+	dst_addr = dst->paddr + args->dst_offset;
+	src_size = src_end - args->src_offset;
+	dst_size = dst_end - args->dst_offset;
+
+	xt->dir = DMA_MEM_TO_MEM;
+	xt->src_inc = true;
+	xt->dst_inc = true;
+	xt->src_sgl = true;
+	xt->dst_sgl = true;
+	xt->frame_size = 1;
+	xt->sgl[0].size = args->width;
+	xt->sgl[0].src_icg = args->src_pitch - args->width;
+	xt->sgl[0].dst_icg = args->dst_pitch - args->width;
+
+	/*
+	 * Write back what the CPU wrote to the source, and make sure that no
+	 * dirty cache line will overwrite the destination behind our back.
+	 * The destination range also covers the bytes between its lines,
+	 * which the CPU still owns, so it is written back rather than only
+	 * invalidated, and synced back with the same direction.
+	 */
+	if (src->map_noncoherent)
+		dma_sync_single_for_device(dma_dev, src_addr, src_size,
+					   DMA_TO_DEVICE);
+	if (dst->map_noncoherent)
+		dma_sync_single_for_device(dma_dev, dst_addr, dst_size,
+					   DMA_BIDIRECTIONAL);
+
+	mutex_lock(&priv->blit_mutex);
+
+	for (line = 0; line < args->height; line += lines) {
+		lines = min_t(unsigned int, args->height - line,
+			      INGENIC_DRM_BLIT_MAX_LINES);
+
+		xt->src_start = src_addr + (dma_addr_t)args->src_pitch * line;
+		xt->dst_start = dst_addr + (dma_addr_t)args->dst_pitch * line;
+		xt->numf = lines;
+
+		ret = ingenic_drm_blit_chunk(priv, xt);
+		if (ret)
+			break;
+	}
+
+	mutex_unlock(&priv->blit_mutex);
+
+	if (dst->map_noncoherent)
+		dma_sync_single_for_cpu(dma_dev, dst_addr, dst_size,
+					DMA_BIDIRECTIONAL);
+
+	kfree(xt);
+out_put_dst:
+	drm_gem_object_put(dst_obj);
+out_put_src:
+	drm_gem_object_put(src_obj);
+	return ret;
+}
+
+static const struct drm_ioctl_desc ingenic_drm_ioctls[] = {
+	DRM_IOCTL_DEF_DRV(INGENIC_GEM_BLIT, ingenic_drm_gem_blit_ioctl,
+			  DRM_RENDER_ALLOW),
+};
+
 static struct drm_private_state *
 ingenic_drm_duplicate_state(struct drm_private_obj *obj)
 {
@@ -1019,6 +2234,42 @@ static void ingenic_drm_destroy_state(struct drm_private_obj *obj,
 	kfree(priv_state);
 }
 
+static int ingenic_drm_commit_stats_show(struct seq_file *m, void *arg)
+{
+	struct drm_info_node *node = m->private;
+	struct ingenic_drm *priv = drm_device_get_priv(node->minor->dev);
+	unsigned int i, lo, hi;
+
+	seq_printf(m, "commits: %u\n", READ_ONCE(priv->commits));
+	seq_printf(m, "missed vblanks: %u\n", READ_ONCE(priv->missed_vblanks));
+	seq_puts(m, "latency (ms):\n");
+
+	for (i = 0; i < INGENIC_DRM_LATENCY_BUCKETS; i++) {
+		lo = i * INGENIC_DRM_LATENCY_BUCKET_US / 1000;
+		hi = (i + 1) * INGENIC_DRM_LATENCY_BUCKET_US / 1000;
+
+		if (i == INGENIC_DRM_LATENCY_BUCKETS - 1)
+			seq_printf(m, "  >= %-5u", lo);
+		else
+			seq_printf(m, "%3u-%-5u", lo, hi);
+
+		seq_printf(m, "%10u\n", READ_ONCE(priv->latency[i]));
+	}
+
+	return 0;
+}
+
+static const struct drm_info_list ingenic_drm_debugfs_list[] = {
+	{ "commit_stats", ingenic_drm_commit_stats_show, 0 },
+};
+
+static void ingenic_drm_debugfs_init(struct drm_minor *minor)
+{
+	drm_debugfs_create_files(ingenic_drm_debugfs_list,
+				 ARRAY_SIZE(ingenic_drm_debugfs_list),
+				 minor->debugfs_root, minor);
+}
+
 DEFINE_DRM_GEM_CMA_FOPS(ingenic_drm_fops);
 
 static const struct drm_driver ingenic_drm_driver_data = {
@@ -1027,25 +2278,104 @@ static const struct drm_driver ingenic_drm_driver_data = {
 	.desc			= "DRM module for Ingenic SoCs",
 	.date			= "20200716",
 	.major			= 1,
-	.minor			= 1,
+	.minor			= 2,
 	.patchlevel		= 0,
 
 	.fops			= &ingenic_drm_fops,
-	DRM_GEM_CMA_DRIVER_OPS,
+	.ioctls			= ingenic_drm_ioctls,
+	.num_ioctls		= ARRAY_SIZE(ingenic_drm_ioctls),
+	.dumb_create		= ingenic_drm_dumb_create,
+	.prime_handle_to_fd	= drm_gem_prime_handle_to_fd,
+	.prime_fd_to_handle	= drm_gem_prime_fd_to_handle,
+	.gem_prime_import_sg_table = ingenic_drm_gem_prime_import_sg_table,
+	.gem_prime_mmap		= drm_gem_prime_mmap,
 
 	.gem_create_object	= ingenic_drm_gem_create_object,
 
 	.irq_handler		= ingenic_drm_irq_handler,
+	.debugfs_init		= ingenic_drm_debugfs_init,
 };
 
+static int
+ingenic_drm_plane_atomic_get_property(struct drm_plane *plane,
+				      const struct drm_plane_state *state,
+				      struct drm_property *property, u64 *val)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(plane->dev);
+
+	if (property != priv->colorkey_prop)
+		return -EINVAL;
+
+	*val = to_ingenic_drm_plane_state(state)->colorkey;
+
+	return 0;
+}
+
+static int
+ingenic_drm_plane_atomic_set_property(struct drm_plane *plane,
+				      struct drm_plane_state *state,
+				      struct drm_property *property, u64 val)
+{
+	struct ingenic_drm *priv = drm_device_get_priv(plane->dev);
+
+	if (property != priv->colorkey_prop)
+		return -EINVAL;
+
+	to_ingenic_drm_plane_state(state)->colorkey = val;
+
+	return 0;
+}
+
+static void ingenic_drm_plane_reset(struct drm_plane *plane)
+{
+	struct ingenic_drm_plane_state *state;
+
+	if (plane->state)
+		plane->funcs->atomic_destroy_state(plane, plane->state);
+
+	state = kzalloc(sizeof(*state), GFP_KERNEL);
+	if (state)
+		__drm_atomic_helper_plane_reset(plane, &state->base);
+	else
+		plane->state = NULL;
+}
+
+static struct drm_plane_state *
+ingenic_drm_plane_duplicate_state(struct drm_plane *plane)
+{
+	struct ingenic_drm_plane_state *state;
+
+	if (WARN_ON(!plane->state))
+		return NULL;
+
+	state = kmemdup(to_ingenic_drm_plane_state(plane->state),
+			sizeof(*state), GFP_KERNEL);
+	if (!state)
+		return NULL;
+
+	__drm_atomic_helper_plane_duplicate_state(plane, &state->base);
+
+	return &state->base;
+}
+
+static void ingenic_drm_plane_destroy_state(struct drm_plane *plane,
+					    struct drm_plane_state *state)
+{
+	__drm_atomic_helper_plane_destroy_state(state);
+	kfree(to_ingenic_drm_plane_state(state));
+}
+
 static const struct drm_plane_funcs ingenic_drm_primary_plane_funcs = {
 	.update_plane		= drm_atomic_helper_update_plane,
 	.disable_plane		= drm_atomic_helper_disable_plane,
-	.reset			= drm_atomic_helper_plane_reset,
+	.reset			= ingenic_drm_plane_reset,
 	.destroy		= drm_plane_cleanup,
 
-	.atomic_duplicate_state	= drm_atomic_helper_plane_duplicate_state,
-	.atomic_destroy_state	= drm_atomic_helper_plane_destroy_state,
+	.atomic_duplicate_state	= ingenic_drm_plane_duplicate_state,
+	.atomic_destroy_state	= ingenic_drm_plane_destroy_state,
+
+	.atomic_get_property	= ingenic_drm_plane_atomic_get_property,
+	.atomic_set_property	= ingenic_drm_plane_atomic_set_property,
 };
 
 static const struct drm_crtc_funcs ingenic_drm_crtc_funcs = {
@@ -1065,6 +2395,8 @@ static const struct drm_plane_helper_funcs ingenic_drm_plane_helper_funcs = {
 	.atomic_update		= ingenic_drm_plane_atomic_update,
 	.atomic_check		= ingenic_drm_plane_atomic_check,
 	.atomic_disable		= ingenic_drm_plane_atomic_disable,
+	.atomic_async_check	= ingenic_drm_plane_atomic_async_check,
+	.atomic_async_update	= ingenic_drm_plane_atomic_async_update,
 	.prepare_fb		= drm_gem_plane_helper_prepare_fb,
 };
 
@@ -1093,7 +2425,7 @@ static const struct drm_bridge_funcs ingenic_drm_bridge_funcs = {
 static const struct drm_mode_config_funcs ingenic_drm_mode_config_funcs = {
 	.fb_create		= ingenic_drm_gem_fb_create,
 	.output_poll_changed	= drm_fb_helper_output_poll_changed,
-	.atomic_check		= drm_atomic_helper_check,
+	.atomic_check		= ingenic_drm_atomic_check,
 	.atomic_commit		= drm_atomic_helper_commit,
 };
 
@@ -1113,6 +2445,11 @@ static void ingenic_drm_unbind_all(void *d)
 	component_unbind_all(priv->dev, &priv->drm);
 }
 
+static void ingenic_drm_release_blit_chan(void *d)
+{
+	dma_release_channel(d);
+}
+
 static void __maybe_unused ingenic_drm_release_rmem(void *d)
 {
 	of_reserved_mem_device_release(d);
@@ -1134,6 +2471,11 @@ static void ingenic_drm_atomic_private_obj_fini(struct drm_device *drm, void *pr
 	drm_atomic_private_obj_fini(private_obj);
 }
 
+static void ingenic_drm_pool_fini(struct drm_device *drm, void *pool)
+{
+	ingenic_drm_pool_destroy(pool);
+}
+
 static int ingenic_drm_bind(struct device *dev, bool has_components)
 {
 	struct platform_device *pdev = to_platform_device(dev);
@@ -1141,7 +2483,8 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 	const struct jz_soc_info *soc_info;
 	struct ingenic_drm *priv;
 	struct clk *parent_clk;
-	struct drm_plane *primary;
+	struct drm_plane *primary, *cursor = NULL;
+	enum drm_plane_type type;
 	struct drm_bridge *bridge;
 	struct drm_panel *panel;
 	struct drm_connector *connector;
@@ -1192,6 +2535,7 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 	drm->mode_config.min_height = 0;
 	drm->mode_config.max_width = soc_info->max_width;
 	drm->mode_config.max_height = 4095;
+	drm->mode_config.async_page_flip = true;
 	drm->mode_config.funcs = &ingenic_drm_mode_config_funcs;
 	drm->mode_config.helper_private = &ingenic_drm_mode_config_helpers;
 
@@ -1217,24 +2561,35 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 	 * don't provide it.
 	 */
 	priv->dma_clk = devm_clk_get_optional(dev, "dma");
-	if (IS_ERR(priv->dma_clk)) {
-		dev_err(dev, "Failed to get dma clock\n");
-		return PTR_ERR(priv->dma_clk);
-	}
+	if (IS_ERR(priv->dma_clk))
+		return dev_err_probe(dev, PTR_ERR(priv->dma_clk),
+				     "Failed to get dma clock\n");
 
 	if (soc_info->needs_dev_clk) {
 		priv->lcd_clk = devm_clk_get(dev, "lcd");
-		if (IS_ERR(priv->lcd_clk)) {
-			dev_err(dev, "Failed to get lcd clock\n");
-			return PTR_ERR(priv->lcd_clk);
-		}
+		if (IS_ERR(priv->lcd_clk))
+			return dev_err_probe(dev, PTR_ERR(priv->lcd_clk),
+					     "Failed to get lcd clock\n");
 	}
 
 	priv->pix_clk = devm_clk_get(dev, "lcd_pclk");
-	if (IS_ERR(priv->pix_clk)) {
-		dev_err(dev, "Failed to get pixel clock\n");
-		return PTR_ERR(priv->pix_clk);
-	}
+	if (IS_ERR(priv->pix_clk))
+		return dev_err_probe(dev, PTR_ERR(priv->pix_clk),
+				     "Failed to get pixel clock\n");
+
+	/* The interconnect is optional; without it, the path is NULL */
+	priv->icc_path = devm_of_icc_get(dev, "memory");
+	if (IS_ERR(priv->icc_path))
+		return dev_err_probe(dev, PTR_ERR(priv->icc_path),
+				     "Failed to get interconnect path\n");
+
+	priv->pool = ingenic_drm_pool_create(dev);
+	if (IS_ERR(priv->pool))
+		return PTR_ERR(priv->pool);
+
+	ret = drmm_add_action_or_reset(drm, ingenic_drm_pool_fini, priv->pool);
+	if (ret)
+		return ret;
 
 	priv->dma_hwdescs = dmam_alloc_coherent(dev,
 						sizeof(*priv->dma_hwdescs),
@@ -1254,6 +2609,16 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 	priv->dma_hwdescs->hwdesc[1].next = dma_hwdesc_phys_f1;
 	priv->dma_hwdescs->hwdesc[1].id = 0xf1;
 
+	/* Configure DMA hwdescs used for asynchronous flips */
+	for (i = 0; i < INGENIC_DRM_ASYNC_SLOTS; i++) {
+		priv->dma_hwdescs->hwdesc_async[0][i].id = 0xf0 | (i + 1) << 8;
+		priv->dma_hwdescs->hwdesc_async[1][i].id = 0xf1 | (i + 1) << 8;
+	}
+	priv->async_pending[0] = -1;
+	priv->async_pending[1] = -1;
+	INIT_WORK(&priv->async_old_fb_work, ingenic_drm_async_old_fb_work);
+	INIT_DELAYED_WORK(&priv->fbdev_flush_work, ingenic_drm_fbdev_flush);
+
 	/* Configure DMA hwdesc for palette */
 	priv->dma_hwdescs->hwdesc_pal.next = dma_hwdesc_phys_f0;
 	priv->dma_hwdescs->hwdesc_pal.id = 0xc0;
@@ -1276,30 +2641,26 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 		return ret;
 	}
 
-	drm_plane_enable_fb_damage_clips(&priv->f1);
-
-	drm_crtc_helper_add(&priv->crtc, &ingenic_drm_crtc_helper_funcs);
-
-	ret = drm_crtc_init_with_planes(drm, &priv->crtc, primary,
-					NULL, &ingenic_drm_crtc_funcs, NULL);
-	if (ret) {
-		dev_err(dev, "Failed to init CRTC: %i\n", ret);
-		return ret;
-	}
-
-	drm_crtc_enable_color_mgmt(&priv->crtc, 0, false,
-				   ARRAY_SIZE(priv->dma_hwdescs->palette));
+	drm_plane_enable_fb_damage_clips(primary);
 
 	if (soc_info->has_osd) {
 		drm_plane_helper_add(&priv->f0,
 				     &ingenic_drm_plane_helper_funcs);
 
+		if (ingenic_drm_f0_cursor) {
+			cursor = &priv->f0;
+			type = DRM_PLANE_TYPE_CURSOR;
+			drm->mode_config.cursor_width = INGENIC_DRM_CURSOR_SIZE;
+			drm->mode_config.cursor_height = INGENIC_DRM_CURSOR_SIZE;
+		} else {
+			type = DRM_PLANE_TYPE_OVERLAY;
+		}
+
 		ret = drm_universal_plane_init(drm, &priv->f0, 1,
 					       &ingenic_drm_primary_plane_funcs,
 					       priv->soc_info->formats_f0,
 					       priv->soc_info->num_formats_f0,
-					       NULL, DRM_PLANE_TYPE_OVERLAY,
-					       NULL);
+					       NULL, type, NULL);
 		if (ret) {
 			dev_err(dev, "Failed to register overlay plane: %i\n",
 				ret);
@@ -1308,23 +2669,56 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 
 		drm_plane_enable_fb_damage_clips(&priv->f0);
 
-		if (IS_ENABLED(CONFIG_DRM_INGENIC_IPU) && has_components) {
-			ret = component_bind_all(dev, drm);
-			if (ret) {
-				if (ret != -EPROBE_DEFER)
-					dev_err(dev, "Failed to bind components: %i\n", ret);
-				return ret;
-			}
+		ret = drm_plane_create_alpha_property(&priv->f0);
+		if (ret)
+			return ret;
 
-			ret = devm_add_action_or_reset(dev, ingenic_drm_unbind_all, priv);
-			if (ret)
-				return ret;
+		ret = drm_plane_create_blend_mode_property(&priv->f0,
+				BIT(DRM_MODE_BLEND_PIXEL_NONE) |
+				BIT(DRM_MODE_BLEND_PREMULTI) |
+				BIT(DRM_MODE_BLEND_COVERAGE));
+		if (ret)
+			return ret;
 
-			priv->ipu_plane = drm_plane_from_index(drm, 2);
-			if (!priv->ipu_plane) {
-				dev_err(dev, "Failed to retrieve IPU plane\n");
-				return -EINVAL;
-			}
+		priv->colorkey_prop = drm_property_create_range(drm, 0,
+				"colorkey", 0,
+				INGENIC_DRM_COLORKEY_ENABLE | JZ_LCD_KEY_COLOR_MASK);
+		if (!priv->colorkey_prop) {
+			dev_err(dev, "Unable to create colorkey property\n");
+			return -ENOMEM;
+		}
+
+		drm_object_attach_property(&priv->f0.base,
+					   priv->colorkey_prop, 0);
+	}
+
+	drm_crtc_helper_add(&priv->crtc, &ingenic_drm_crtc_helper_funcs);
+
+	ret = drm_crtc_init_with_planes(drm, &priv->crtc, primary,
+					cursor, &ingenic_drm_crtc_funcs, NULL);
+	if (ret) {
+		dev_err(dev, "Failed to init CRTC: %i\n", ret);
+		return ret;
+	}
+
+	drm_crtc_enable_color_mgmt(&priv->crtc, 0, false,
+				   ARRAY_SIZE(priv->dma_hwdescs->palette));
+
+	if (soc_info->has_osd && IS_ENABLED(CONFIG_DRM_INGENIC_IPU) &&
+	    has_components) {
+		ret = component_bind_all(dev, drm);
+		if (ret)
+			return dev_err_probe(dev, ret,
+					     "Failed to bind components\n");
+
+		ret = devm_add_action_or_reset(dev, ingenic_drm_unbind_all, priv);
+		if (ret)
+			return ret;
+
+		priv->ipu_plane = drm_plane_from_index(drm, 2);
+		if (!priv->ipu_plane) {
+			dev_err(dev, "Failed to retrieve IPU plane\n");
+			return -EINVAL;
 		}
 	}
 
@@ -1345,9 +2739,8 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 			}
 			if (ret == -ENODEV)
 				break; /* we're done */
-			if (ret != -EPROBE_DEFER)
-				dev_err(dev, "Failed to get bridge handle\n");
-			return ret;
+			return dev_err_probe(dev, ret,
+					     "Failed to get bridge handle\n");
 		}
 
 		if (panel)
@@ -1449,6 +2842,8 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 		regmap_write(priv->map, JZ_REG_LCD_OSDC, JZ_LCD_OSDC_OSDEN);
 
 	mutex_init(&priv->clk_mutex);
+	mutex_init(&priv->blit_mutex);
+	mutex_init(&priv->hwdescs_lock);
 	priv->clock_nb.notifier_call = ingenic_drm_update_pixclk;
 
 	parent_clk = ingenic_drm_get_parent_clk(priv->pix_clk);
@@ -1473,6 +2868,29 @@ static int ingenic_drm_bind(struct device *dev, bool has_components)
 	if (ret)
 		goto err_private_state_free;
 
+	/*
+	 * The blit ioctl is optional, and only available if a DMA channel
+	 * able to perform 2D memory-to-memory transfers can be obtained.
+	 */
+	if (IS_ENABLED(CONFIG_DMA_ENGINE)) {
+		dma_cap_mask_t mask;
+		struct dma_chan *chan;
+
+		dma_cap_zero(mask);
+		dma_cap_set(DMA_INTERLEAVE, mask);
+
+		chan = dma_request_chan_by_mask(&mask);
+		if (!IS_ERR(chan)) {
+			ret = devm_add_action_or_reset(dev,
+						       ingenic_drm_release_blit_chan,
+						       chan);
+			if (ret)
+				goto err_clk_notifier_unregister;
+
+			priv->blit_chan = chan;
+		}
+	}
+
 	ret = drm_dev_register(drm, 0);
 	if (ret) {
 		dev_err(dev, "Failed to register DRM driver\n");
@@ -1522,6 +2940,12 @@ static void ingenic_drm_unbind(struct device *dev)
 
 	drm_dev_unregister(&priv->drm);
 	drm_atomic_helper_shutdown(&priv->drm);
+
+	cancel_work_sync(&priv->async_old_fb_work);
+	cancel_delayed_work_sync(&priv->fbdev_flush_work);
+	priv->async_pending[0] = -1;
+	priv->async_pending[1] = -1;
+	ingenic_drm_release_async_fbs(priv);
 }
 
 static const struct component_master_ops ingenic_master_ops = {
@@ -1610,6 +3034,7 @@ static const u32 jz4770_formats_f0[] = {
 	DRM_FORMAT_RGB565,
 	DRM_FORMAT_RGB888,
 	DRM_FORMAT_XRGB8888,
+	DRM_FORMAT_ARGB8888,
 	DRM_FORMAT_XRGB2101010,
 };
 
@@ -1662,6 +3087,7 @@ static struct platform_driver ingenic_drm_driver = {
 		.name = "ingenic-drm",
 		.pm = pm_ptr(&ingenic_drm_pm_ops),
 		.of_match_table = of_match_ptr(ingenic_drm_of_match),
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe = ingenic_drm_probe,
 	.remove = ingenic_drm_remove,
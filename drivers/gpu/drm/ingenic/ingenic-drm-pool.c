@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Ingenic JZ47xx KMS driver - Cache of DMA buffers
+//
+// Applications re-create all of their buffers every time they re-create their
+// swapchain, e.g. on a resolution change. Allocating and freeing that many
+// large contiguous buffers fragments the CMA area, until allocations start to
+// fail. Freed buffers are instead kept in a small cache, sorted by size, and
+// handed out again to the next allocations of a similar size. The cache is
+// emptied when the system runs short of memory, or when an allocation fails.
+
+#include "ingenic-drm.h"
+
+#include <linux/dma-mapping.h>
+#include <linux/list.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/shrinker.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+
+/*
+ * One list per allocation order; a cached buffer is reused for a request of
+ * the same order, so that no more than half of a buffer is wasted.
+ */
+#define INGENIC_DRM_POOL_ORDERS			11
+
+/* Maximum amount of memory kept in the cache */
+#define INGENIC_DRM_POOL_MAX_SIZE		SZ_8M
+
+struct ingenic_drm_pool_buf {
+	struct list_head node;
+	enum ingenic_drm_buf_type type;
+	size_t size;
+	void *vaddr;
+	dma_addr_t paddr;
+};
+
+struct ingenic_drm_pool {
+	struct device *dev;
+	struct shrinker shrinker;
+
+	/* Protects the lists and the size */
+	struct mutex lock;
+	struct list_head bufs[INGENIC_DRM_POOL_ORDERS];
+	size_t size;
+};
+
+static void *ingenic_drm_pool_dma_alloc(struct device *dev, size_t size,
+					enum ingenic_drm_buf_type type,
+					dma_addr_t *paddr)
+{
+	gfp_t gfp = GFP_KERNEL | __GFP_NOWARN;
+
+	switch (type) {
+	case INGENIC_DRM_BUF_WC:
+		return dma_alloc_wc(dev, size, paddr, gfp);
+	case INGENIC_DRM_BUF_NONCOHERENT:
+		return dma_alloc_noncoherent(dev, size, paddr,
+					     DMA_TO_DEVICE, gfp);
+	default:
+		return dma_alloc_coherent(dev, size, paddr, gfp);
+	}
+}
+
+static void ingenic_drm_pool_dma_free(struct device *dev, size_t size,
+				      enum ingenic_drm_buf_type type,
+				      void *vaddr, dma_addr_t paddr)
+{
+	switch (type) {
+	case INGENIC_DRM_BUF_WC:
+		dma_free_wc(dev, size, vaddr, paddr);
+		break;
+	case INGENIC_DRM_BUF_NONCOHERENT:
+		dma_free_noncoherent(dev, size, vaddr, paddr, DMA_TO_DEVICE);
+		break;
+	default:
+		dma_free_coherent(dev, size, vaddr, paddr);
+		break;
+	}
+}
+
+/* Free the @nr_pages oldest buffers, starting with the largest ones */
+static unsigned long ingenic_drm_pool_evict(struct ingenic_drm_pool *pool,
+					    unsigned long nr_pages)
+{
+	struct ingenic_drm_pool_buf *buf, *tmp;
+	unsigned long freed = 0;
+	LIST_HEAD(list);
+	int order;
+
+	mutex_lock(&pool->lock);
+
+	for (order = INGENIC_DRM_POOL_ORDERS - 1; order >= 0; order--) {
+		list_for_each_entry_safe_reverse(buf, tmp, &pool->bufs[order],
+						 node) {
+			if (freed >= nr_pages)
+				break;
+
+			list_move(&buf->node, &list);
+			pool->size -= buf->size;
+			freed += buf->size >> PAGE_SHIFT;
+		}
+	}
+
+	mutex_unlock(&pool->lock);
+
+	list_for_each_entry_safe(buf, tmp, &list, node) {
+		ingenic_drm_pool_dma_free(pool->dev, buf->size, buf->type,
+					  buf->vaddr, buf->paddr);
+		kfree(buf);
+	}
+
+	return freed;
+}
+
+static unsigned long
+ingenic_drm_pool_shrinker_count(struct shrinker *shrinker,
+				struct shrink_control *sc)
+{
+	struct ingenic_drm_pool *pool =
+		container_of(shrinker, struct ingenic_drm_pool, shrinker);
+
+	return READ_ONCE(pool->size) >> PAGE_SHIFT ?: SHRINK_EMPTY;
+}
+
+static unsigned long
+ingenic_drm_pool_shrinker_scan(struct shrinker *shrinker,
+			       struct shrink_control *sc)
+{
+	struct ingenic_drm_pool *pool =
+		container_of(shrinker, struct ingenic_drm_pool, shrinker);
+	unsigned long freed;
+
+	freed = ingenic_drm_pool_evict(pool, sc->nr_to_scan);
+
+	return freed ?: SHRINK_STOP;
+}
+
+/*
+ * Allocate a zeroed buffer of at least *size bytes. On success, *size is
+ * updated to the actual size of the buffer, which must be passed back to
+ * ingenic_drm_pool_free().
+ */
+void *ingenic_drm_pool_alloc(struct ingenic_drm_pool *pool, size_t *size,
+			     enum ingenic_drm_buf_type type,
+			     dma_addr_t *paddr)
+{
+	struct ingenic_drm_pool_buf *buf, *found = NULL;
+	size_t len = PAGE_ALIGN(*size);
+	int order = get_order(len);
+	void *vaddr;
+
+	if (order < INGENIC_DRM_POOL_ORDERS) {
+		mutex_lock(&pool->lock);
+
+		list_for_each_entry(buf, &pool->bufs[order], node) {
+			if (buf->type == type && buf->size >= len) {
+				list_del(&buf->node);
+				pool->size -= buf->size;
+				found = buf;
+				break;
+			}
+		}
+
+		mutex_unlock(&pool->lock);
+	}
+
+	if (found) {
+		vaddr = found->vaddr;
+		*paddr = found->paddr;
+		*size = found->size;
+		kfree(found);
+
+		/* The buffer may still hold data of another client */
+		memset(vaddr, 0, *size);
+		if (type == INGENIC_DRM_BUF_NONCOHERENT)
+			dma_sync_single_for_device(pool->dev, *paddr, *size,
+						   DMA_TO_DEVICE);
+
+		return vaddr;
+	}
+
+	vaddr = ingenic_drm_pool_dma_alloc(pool->dev, len, type, paddr);
+	if (!vaddr && READ_ONCE(pool->size)) {
+		/* Give the cached memory back, and try again */
+		ingenic_drm_pool_evict(pool, ULONG_MAX);
+		vaddr = ingenic_drm_pool_dma_alloc(pool->dev, len, type, paddr);
+	}
+
+	if (vaddr)
+		*size = len;
+
+	return vaddr;
+}
+
+/* Keep the buffer in the cache if there is room for it, free it otherwise */
+void ingenic_drm_pool_free(struct ingenic_drm_pool *pool, size_t size,
+			   enum ingenic_drm_buf_type type,
+			   void *vaddr, dma_addr_t paddr)
+{
+	struct ingenic_drm_pool_buf *buf = NULL;
+	int order = get_order(size);
+
+	if (order < INGENIC_DRM_POOL_ORDERS)
+		buf = kmalloc(sizeof(*buf), GFP_KERNEL | __GFP_NOWARN);
+
+	if (buf) {
+		buf->type = type;
+		buf->size = size;
+		buf->vaddr = vaddr;
+		buf->paddr = paddr;
+
+		mutex_lock(&pool->lock);
+
+		if (pool->size + size <= INGENIC_DRM_POOL_MAX_SIZE) {
+			list_add(&buf->node, &pool->bufs[order]);
+			pool->size += size;
+			buf = NULL;
+		}
+
+		mutex_unlock(&pool->lock);
+
+		if (!buf)
+			return;
+
+		kfree(buf);
+	}
+
+	ingenic_drm_pool_dma_free(pool->dev, size, type, vaddr, paddr);
+}
+
+struct ingenic_drm_pool *ingenic_drm_pool_create(struct device *dev)
+{
+	struct ingenic_drm_pool *pool;
+	unsigned int i;
+	int ret;
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (!pool)
+		return ERR_PTR(-ENOMEM);
+
+	pool->dev = dev;
+	mutex_init(&pool->lock);
+
+	for (i = 0; i < INGENIC_DRM_POOL_ORDERS; i++)
+		INIT_LIST_HEAD(&pool->bufs[i]);
+
+	pool->shrinker.count_objects = ingenic_drm_pool_shrinker_count;
+	pool->shrinker.scan_objects = ingenic_drm_pool_shrinker_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+
+	ret = register_shrinker(&pool->shrinker);
+	if (ret) {
+		kfree(pool);
+		return ERR_PTR(ret);
+	}
+
+	return pool;
+}
+
+void ingenic_drm_pool_destroy(struct ingenic_drm_pool *pool)
+{
+	unregister_shrinker(&pool->shrinker);
+	ingenic_drm_pool_evict(pool, ULONG_MAX);
+	mutex_destroy(&pool->lock);
+	kfree(pool);
+}
@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+//
+// Ingenic JZ47xx KMS driver - Tracepoints
+
+#if !defined(_INGENIC_DRM_TRACE_H_) || defined(TRACE_HEADER_MULTI_READ)
+#define _INGENIC_DRM_TRACE_H_
+
+#include <linux/tracepoint.h>
+#include <linux/types.h>
+
+#include <drm/drm_device.h>
+#include <drm/drm_file.h>
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM ingenic_drm
+#define TRACE_INCLUDE_FILE ingenic-drm-trace
+
+DECLARE_EVENT_CLASS(ingenic_drm_commit,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank),
+
+	TP_STRUCT__entry(
+		__field(u32, dev)
+		__field(u64, vblank)
+	),
+
+	TP_fast_assign(
+		__entry->dev = drm->primary->index;
+		__entry->vblank = vblank;
+	),
+
+	TP_printk("dev=%u, vblank=%llu", __entry->dev, __entry->vblank)
+);
+
+/* The commit tail starts */
+DEFINE_EVENT(ingenic_drm_commit, ingenic_drm_commit_begin,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank)
+);
+
+/* The outputs to be disabled are off */
+DEFINE_EVENT(ingenic_drm_commit, ingenic_drm_commit_disables,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank)
+);
+
+/* The planes have been updated, and the CRTC flushed */
+DEFINE_EVENT(ingenic_drm_commit, ingenic_drm_commit_planes,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank)
+);
+
+/* The outputs to be enabled are on */
+DEFINE_EVENT(ingenic_drm_commit, ingenic_drm_commit_enables,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank)
+);
+
+/* The new state is being scanned out */
+DEFINE_EVENT(ingenic_drm_commit, ingenic_drm_commit_done,
+	TP_PROTO(struct drm_device *drm, u64 vblank),
+	TP_ARGS(drm, vblank)
+);
+
+TRACE_EVENT(ingenic_drm_commit_latency,
+	TP_PROTO(struct drm_device *drm, s64 latency_us, unsigned int missed),
+	TP_ARGS(drm, latency_us, missed),
+
+	TP_STRUCT__entry(
+		__field(u32, dev)
+		__field(s64, latency_us)
+		__field(unsigned int, missed)
+	),
+
+	TP_fast_assign(
+		__entry->dev = drm->primary->index;
+		__entry->latency_us = latency_us;
+		__entry->missed = missed;
+	),
+
+	TP_printk("dev=%u, latency=%lldus, missed_vblanks=%u",
+		  __entry->dev, __entry->latency_us, __entry->missed)
+);
+
+#endif /* _INGENIC_DRM_TRACE_H_ */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH ../../drivers/gpu/drm/ingenic
+#include <trace/define_trace.h>
@@ -153,6 +153,8 @@
 #define JZ_LCD_RGBC_EVEN_BGR			(0x5 << 0)
 
 #define JZ_LCD_OSDC_OSDEN			BIT(0)
+#define JZ_LCD_OSDC_ALPHAMD			BIT(1)
+#define JZ_LCD_OSDC_ALPHAEN			BIT(2)
 #define JZ_LCD_OSDC_F0EN			BIT(3)
 #define JZ_LCD_OSDC_F1EN			BIT(4)
 
@@ -167,6 +169,9 @@
 
 #define JZ_LCD_OSDS_READY			BIT(0)
 
+#define JZ_LCD_KEY_KEYEN			BIT(31)
+#define JZ_LCD_KEY_COLOR_MASK			0xffffff
+
 #define JZ_LCD_IPUR_IPUREN			BIT(31)
 #define JZ_LCD_IPUR_IPUR_LSB			0
 
@@ -177,14 +182,37 @@
 #define JZ_LCD_SIZE01_HEIGHT_LSB		16
 
 struct device;
+struct drm_crtc_state;
+struct drm_format_info;
 struct drm_plane;
 struct drm_plane_state;
+struct ingenic_drm_pool;
 struct platform_driver;
 
+enum ingenic_drm_buf_type {
+	INGENIC_DRM_BUF_COHERENT,
+	INGENIC_DRM_BUF_WC,
+	INGENIC_DRM_BUF_NONCOHERENT,
+};
+
 void ingenic_drm_plane_config(struct device *dev,
 			      struct drm_plane *plane, u32 fourcc);
 void ingenic_drm_plane_disable(struct device *dev, struct drm_plane *plane);
 
+void ingenic_drm_bandwidth(const struct drm_crtc_state *crtc_state,
+			   const struct drm_format_info *finfo,
+			   unsigned int width, unsigned int height,
+			   u32 *avg_bw, u32 *peak_bw);
+
+struct ingenic_drm_pool *ingenic_drm_pool_create(struct device *dev);
+void ingenic_drm_pool_destroy(struct ingenic_drm_pool *pool);
+void *ingenic_drm_pool_alloc(struct ingenic_drm_pool *pool, size_t *size,
+			     enum ingenic_drm_buf_type type,
+			     dma_addr_t *paddr);
+void ingenic_drm_pool_free(struct ingenic_drm_pool *pool, size_t size,
+			   enum ingenic_drm_buf_type type,
+			   void *vaddr, dma_addr_t paddr);
+
 extern struct platform_driver *ingenic_ipu_driver_ptr;
 
 #endif /* DRIVERS_GPU_DRM_INGENIC_INGENIC_DRM_H */
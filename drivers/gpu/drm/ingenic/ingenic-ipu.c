@@ -11,11 +11,17 @@
 #include <linux/clk.h>
 #include <linux/component.h>
 #include <linux/gcd.h>
+#include <linux/interconnect.h>
 #include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/kref.h>
+#include <linux/list.h>
 #include <linux/module.h>
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/regmap.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
 #include <linux/time.h>
 
 #include <drm/drm_atomic.h>
@@ -32,7 +38,25 @@
 #include <drm/drm_property.h>
 #include <drm/drm_vblank.h>
 
-struct ingenic_ipu;
+/* Number of scaling coefficient tables kept around */
+#define INGENIC_IPU_COEF_CACHE_SIZE	8
+
+/*
+ * Values to write to one of the resize coefficient LUT registers. When vals
+ * is NULL, only the number of values is computed.
+ */
+struct ingenic_ipu_lut {
+	u32 *vals;
+	unsigned int len;
+};
+
+struct ingenic_ipu_coefs {
+	struct list_head list;
+	struct kref ref;
+	unsigned int num, denom, sharpness;
+	unsigned int len;
+	u32 vals[];
+};
 
 struct soc_info {
 	const u32 *formats;
@@ -40,15 +64,36 @@ struct soc_info {
 	bool has_bicubic;
 	bool manual_restart;
 
-	void (*set_coefs)(struct ingenic_ipu *ipu, unsigned int reg,
+	void (*set_coefs)(struct ingenic_ipu_lut *lut,
 			  unsigned int sharpness, bool downscale,
 			  unsigned int weight, unsigned int offset);
 };
 
+/*
+ * Shadow of the IPU registers, computed in .atomic_check and written in one
+ * burst when the IPU is (re)started.
+ */
+struct ingenic_ipu_regs {
+	u32 ctrl;
+	u32 d_fmt;
+	u32 in_gs, y_stride, uv_stride;
+	u32 out_gs, out_stride;
+	u32 coef_index;
+	u32 addr_y, addr_u, addr_v;
+};
+
 struct ingenic_ipu_private_state {
 	struct drm_private_state base;
 
 	unsigned int num_w, num_h, denom_w, denom_h;
+
+	/* Scaling coefficient tables, NULL when not scaling in that direction */
+	struct ingenic_ipu_coefs *coefs_w, *coefs_h;
+
+	struct ingenic_ipu_regs regs;
+
+	/* Memory bandwidth needed to read the source frames, in kB/s */
+	u32 avg_bw, peak_bw;
 };
 
 struct ingenic_ipu {
@@ -56,10 +101,26 @@ struct ingenic_ipu {
 	struct drm_device *drm;
 	struct device *dev, *master;
 	struct regmap *map;
+	void __iomem *base;
 	struct clk *clk;
 	const struct soc_info *soc_info;
 	bool clk_enabled;
 
+	/* Path to the memory, may be NULL, and the current vote */
+	struct icc_path *icc_path;
+	u32 avg_bw, peak_bw;
+
+	/*
+	 * Computed scaling coefficient tables, most recently used first.
+	 * Only accessed from the plane's .atomic_check, which holds the lock
+	 * of the private object. Each table is referenced by the cache and by
+	 * the private states using it.
+	 */
+	struct list_head coefs_cache;
+	unsigned int num_coefs;
+
+	/* Protects the addresses, which are written by the IRQ handler */
+	spinlock_t addr_lock;
 	dma_addr_t addr_y, addr_u, addr_v;
 
 	struct drm_property *sharpness_prop;
@@ -142,6 +203,14 @@ static inline s32 cubic_conv(s32 f_a, s32 f_x)
 		return 0;
 }
 
+static inline void ingenic_ipu_lut_push(struct ingenic_ipu_lut *lut, u32 val)
+{
+	if (lut->vals)
+		lut->vals[lut->len] = val;
+
+	lut->len++;
+}
+
 /*
  * On entry, "weight" is a coefficient suitable for bilinear mode,
  *  which is converted to a set of four suitable for bicubic mode.
@@ -152,7 +221,7 @@ static inline s32 cubic_conv(s32 f_a, s32 f_x)
  *
  * "offset" is increment to next source pixel sample location.
  */
-static void jz4760_set_coefs(struct ingenic_ipu *ipu, unsigned int reg,
+static void jz4760_set_coefs(struct ingenic_ipu_lut *lut,
 			     unsigned int sharpness, bool downscale,
 			     unsigned int weight, unsigned int offset)
 {
@@ -196,15 +265,15 @@ static void jz4760_set_coefs(struct ingenic_ipu *ipu, unsigned int reg,
 
 	val = ((w1 & JZ4760_IPU_RSZ_COEF_MASK) << JZ4760_IPU_RSZ_COEF31_LSB) |
 		((w0 & JZ4760_IPU_RSZ_COEF_MASK) << JZ4760_IPU_RSZ_COEF20_LSB);
-	regmap_write(ipu->map, reg, val);
+	ingenic_ipu_lut_push(lut, val);
 
 	val = ((w3 & JZ4760_IPU_RSZ_COEF_MASK) << JZ4760_IPU_RSZ_COEF31_LSB) |
 		((w2 & JZ4760_IPU_RSZ_COEF_MASK) << JZ4760_IPU_RSZ_COEF20_LSB) |
 		((offset & JZ4760_IPU_RSZ_OFFSET_MASK) << JZ4760_IPU_RSZ_OFFSET_LSB);
-	regmap_write(ipu->map, reg, val);
+	ingenic_ipu_lut_push(lut, val);
 }
 
-static void jz4725b_set_coefs(struct ingenic_ipu *ipu, unsigned int reg,
+static void jz4725b_set_coefs(struct ingenic_ipu_lut *lut,
 			      unsigned int sharpness, bool downscale,
 			      unsigned int weight, unsigned int offset)
 {
@@ -220,16 +289,17 @@ static void jz4725b_set_coefs(struct ingenic_ipu *ipu, unsigned int reg,
 	if (downscale || !!offset)
 		val |= JZ4725B_IPU_RSZ_LUT_IN_EN;
 
-	regmap_write(ipu->map, reg, val);
+	ingenic_ipu_lut_push(lut, val);
 
 	if (downscale) {
 		for (i = 1; i < offset; i++)
-			regmap_write(ipu->map, reg, JZ4725B_IPU_RSZ_LUT_IN_EN);
+			ingenic_ipu_lut_push(lut, JZ4725B_IPU_RSZ_LUT_IN_EN);
 	}
 }
 
 static void ingenic_ipu_set_downscale_coefs(struct ingenic_ipu *ipu,
-					    unsigned int reg,
+					    struct ingenic_ipu_lut *lut,
+					    unsigned int sharpness,
 					    unsigned int num,
 					    unsigned int denom)
 {
@@ -241,13 +311,12 @@ static void ingenic_ipu_set_downscale_coefs(struct ingenic_ipu *ipu,
 		weight_num += denom * 2;
 		offset = (weight_num - num) / (num * 2);
 
-		ipu->soc_info->set_coefs(ipu, reg, ipu->sharpness,
-					 true, weight, offset);
+		ipu->soc_info->set_coefs(lut, sharpness, true, weight, offset);
 	}
 }
 
 static void ingenic_ipu_set_integer_upscale_coefs(struct ingenic_ipu *ipu,
-						  unsigned int reg,
+						  struct ingenic_ipu_lut *lut,
 						  unsigned int num)
 {
 	/*
@@ -257,11 +326,12 @@ static void ingenic_ipu_set_integer_upscale_coefs(struct ingenic_ipu *ipu,
 	unsigned int i;
 
 	for (i = 0; i < num; i++)
-		ipu->soc_info->set_coefs(ipu, reg, 0, false, 512, i == num - 1);
+		ipu->soc_info->set_coefs(lut, 0, false, 512, i == num - 1);
 }
 
 static void ingenic_ipu_set_upscale_coefs(struct ingenic_ipu *ipu,
-					  unsigned int reg,
+					  struct ingenic_ipu_lut *lut,
+					  unsigned int sharpness,
 					  unsigned int num,
 					  unsigned int denom)
 {
@@ -275,23 +345,141 @@ static void ingenic_ipu_set_upscale_coefs(struct ingenic_ipu *ipu,
 		if (offset)
 			weight_num -= num;
 
-		ipu->soc_info->set_coefs(ipu, reg, ipu->sharpness,
-					 false, weight, offset);
+		ipu->soc_info->set_coefs(lut, sharpness, false, weight, offset);
+	}
+}
+
+static void ingenic_ipu_compute_coefs(struct ingenic_ipu *ipu,
+				      struct ingenic_ipu_lut *lut,
+				      unsigned int sharpness,
+				      unsigned int num, unsigned int denom)
+{
+	if (denom > num)
+		ingenic_ipu_set_downscale_coefs(ipu, lut, sharpness, num, denom);
+	else if (denom == 1)
+		ingenic_ipu_set_integer_upscale_coefs(ipu, lut, num);
+	else
+		ingenic_ipu_set_upscale_coefs(ipu, lut, sharpness, num, denom);
+}
+
+static void ingenic_ipu_release_coefs(struct kref *ref)
+{
+	kfree(container_of(ref, struct ingenic_ipu_coefs, ref));
+}
+
+static void ingenic_ipu_put_coefs(struct ingenic_ipu_coefs *coefs)
+{
+	if (coefs)
+		kref_put(&coefs->ref, ingenic_ipu_release_coefs);
+}
+
+static struct ingenic_ipu_coefs *
+ingenic_ipu_get_coefs(struct ingenic_ipu *ipu, unsigned int num,
+		      unsigned int denom, unsigned int sharpness)
+{
+	struct ingenic_ipu_lut lut = {};
+	struct ingenic_ipu_coefs *coefs;
+
+	list_for_each_entry(coefs, &ipu->coefs_cache, list) {
+		if (coefs->num == num && coefs->denom == denom &&
+		    coefs->sharpness == sharpness) {
+			list_move(&coefs->list, &ipu->coefs_cache);
+			kref_get(&coefs->ref);
+			return coefs;
+		}
 	}
+
+	/* Cache miss: compute the size of the table, then the table itself */
+	ingenic_ipu_compute_coefs(ipu, &lut, sharpness, num, denom);
+
+	if (ipu->num_coefs == INGENIC_IPU_COEF_CACHE_SIZE) {
+		coefs = list_last_entry(&ipu->coefs_cache,
+					struct ingenic_ipu_coefs, list);
+		list_del(&coefs->list);
+		ingenic_ipu_put_coefs(coefs);
+		ipu->num_coefs--;
+	}
+
+	coefs = kmalloc(struct_size(coefs, vals, lut.len), GFP_KERNEL);
+	if (!coefs)
+		return NULL;
+
+	/* One reference for the cache, one for the caller */
+	kref_init(&coefs->ref);
+	kref_get(&coefs->ref);
+	coefs->num = num;
+	coefs->denom = denom;
+	coefs->sharpness = sharpness;
+
+	lut.vals = coefs->vals;
+	lut.len = 0;
+	ingenic_ipu_compute_coefs(ipu, &lut, sharpness, num, denom);
+	coefs->len = lut.len;
+
+	list_add(&coefs->list, &ipu->coefs_cache);
+	ipu->num_coefs++;
+
+	return coefs;
+}
+
+static void ingenic_ipu_free_coefs(struct ingenic_ipu *ipu)
+{
+	struct ingenic_ipu_coefs *coefs, *tmp;
+
+	list_for_each_entry_safe(coefs, tmp, &ipu->coefs_cache, list) {
+		list_del(&coefs->list);
+		ingenic_ipu_put_coefs(coefs);
+	}
+
+	ipu->num_coefs = 0;
+}
+
+/*
+ * Look up the coefficient tables of the scaling ratios of a private state,
+ * so that .atomic_update only has to write them and cannot fail.
+ */
+static int ingenic_ipu_state_get_coefs(struct ingenic_ipu *ipu,
+				       struct ingenic_ipu_private_state *ipu_state)
+{
+	struct ingenic_ipu_coefs *coefs_w = NULL, *coefs_h = NULL;
+
+	if (ipu_state->num_w != 1 || ipu_state->denom_w != 1) {
+		coefs_w = ingenic_ipu_get_coefs(ipu, ipu_state->num_w,
+						ipu_state->denom_w,
+						ipu->sharpness);
+		if (!coefs_w)
+			return -ENOMEM;
+	}
+
+	if (ipu_state->num_h != 1 || ipu_state->denom_h != 1) {
+		coefs_h = ingenic_ipu_get_coefs(ipu, ipu_state->num_h,
+						ipu_state->denom_h,
+						ipu->sharpness);
+		if (!coefs_h) {
+			ingenic_ipu_put_coefs(coefs_w);
+			return -ENOMEM;
+		}
+	}
+
+	ingenic_ipu_put_coefs(ipu_state->coefs_w);
+	ingenic_ipu_put_coefs(ipu_state->coefs_h);
+	ipu_state->coefs_w = coefs_w;
+	ipu_state->coefs_h = coefs_h;
+
+	return 0;
 }
 
 static void ingenic_ipu_set_coefs(struct ingenic_ipu *ipu, unsigned int reg,
-				  unsigned int num, unsigned int denom)
+				  const struct ingenic_ipu_coefs *coefs)
 {
 	/* Begin programming the LUT */
 	regmap_write(ipu->map, reg, -1);
 
-	if (denom > num)
-		ingenic_ipu_set_downscale_coefs(ipu, reg, num, denom);
-	else if (denom == 1)
-		ingenic_ipu_set_integer_upscale_coefs(ipu, reg, num);
-	else
-		ingenic_ipu_set_upscale_coefs(ipu, reg, num, denom);
+	/*
+	 * The LUT register is a FIFO. The regmap has no cache, so it is safe
+	 * to bypass it and push the whole table in one go.
+	 */
+	iowrite32_rep(ipu->base + reg, coefs->vals, coefs->len);
 }
 
 static int reduce_fraction(unsigned int *num, unsigned int *denom)
@@ -320,88 +508,14 @@ static inline bool osd_changed(struct drm_plane_state *state,
 		state->crtc_h != oldstate->crtc_h;
 }
 
-static void ingenic_ipu_plane_atomic_update(struct drm_plane *plane,
-					    struct drm_atomic_state *state)
-{
-	struct ingenic_ipu *ipu = plane_to_ingenic_ipu(plane);
-	struct drm_plane_state *newstate = drm_atomic_get_new_plane_state(state, plane);
-	struct drm_plane_state *oldstate = drm_atomic_get_new_plane_state(state, plane);
-	const struct drm_format_info *finfo;
-	u32 ctrl, stride = 0, coef_index = 0, format = 0;
-	bool needs_modeset, upscaling_w, upscaling_h;
-	struct ingenic_ipu_private_state *ipu_state;
-	int err;
-
-	if (!newstate || !newstate->fb)
-		return;
-
-	ipu_state = ingenic_ipu_get_new_priv_state(ipu, state);
-	if (WARN_ON(!ipu_state))
-		return;
-
-	finfo = drm_format_info(newstate->fb->format->format);
-
-	if (!ipu->clk_enabled) {
-		err = clk_enable(ipu->clk);
-		if (err) {
-			dev_err(ipu->dev, "Unable to enable clock: %d\n", err);
-			return;
-		}
-
-		ipu->clk_enabled = true;
-	}
-
-	/* Reset all the registers if needed */
-	needs_modeset = drm_atomic_crtc_needs_modeset(newstate->crtc->state);
-	if (needs_modeset) {
-		regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL, JZ_IPU_CTRL_RST);
-
-		/* Enable the chip */
-		regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL,
-				JZ_IPU_CTRL_CHIP_EN | JZ_IPU_CTRL_LCDC_SEL);
-	}
-
-	drm_fb_cma_sync_non_coherent(ipu->drm, oldstate, newstate);
-
-	/* New addresses will be committed in vblank handler... */
-	ipu->addr_y = drm_fb_cma_get_gem_addr(newstate->fb, newstate, 0);
-	if (finfo->num_planes > 1)
-		ipu->addr_u = drm_fb_cma_get_gem_addr(newstate->fb, newstate,
-						      1);
-	if (finfo->num_planes > 2)
-		ipu->addr_v = drm_fb_cma_get_gem_addr(newstate->fb, newstate,
-						      2);
-
-	if (!needs_modeset)
-		return;
-
-	/* Or right here if we're doing a full modeset. */
-	regmap_write(ipu->map, JZ_REG_IPU_Y_ADDR, ipu->addr_y);
-	regmap_write(ipu->map, JZ_REG_IPU_U_ADDR, ipu->addr_u);
-	regmap_write(ipu->map, JZ_REG_IPU_V_ADDR, ipu->addr_v);
-
-	if (finfo->num_planes == 1)
-		regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL, JZ_IPU_CTRL_SPKG_SEL);
-
-	ingenic_drm_plane_config(ipu->master, plane, DRM_FORMAT_XRGB8888);
-
-	/* Set the input height/width/strides */
-	if (finfo->num_planes > 2)
-		stride = ((newstate->src_w >> 16) * finfo->cpp[2] / finfo->hsub)
-			<< JZ_IPU_UV_STRIDE_V_LSB;
+#define JZ_IPU_CTRL_SHADOW_MASK						\
+	(JZ_IPU_CTRL_ZOOM_SEL | JZ_IPU_CTRL_SPKG_SEL |				\
+	 JZ_IPU_CTRL_HRSZ_EN | JZ_IPU_CTRL_VRSZ_EN |				\
+	 JZ_IPU_CTRL_HSCALE | JZ_IPU_CTRL_VSCALE | JZ_IPU_CTRL_CSC_EN)
 
-	if (finfo->num_planes > 1)
-		stride |= ((newstate->src_w >> 16) * finfo->cpp[1] / finfo->hsub)
-			<< JZ_IPU_UV_STRIDE_U_LSB;
-
-	regmap_write(ipu->map, JZ_REG_IPU_UV_STRIDE, stride);
-
-	stride = ((newstate->src_w >> 16) * finfo->cpp[0]) << JZ_IPU_Y_STRIDE_Y_LSB;
-	regmap_write(ipu->map, JZ_REG_IPU_Y_STRIDE, stride);
-
-	regmap_write(ipu->map, JZ_REG_IPU_IN_GS,
-		     (stride << JZ_IPU_IN_GS_W_LSB) |
-		     ((newstate->src_h >> 16) << JZ_IPU_IN_GS_H_LSB));
+static u32 ingenic_ipu_get_d_fmt(const struct drm_format_info *finfo)
+{
+	u32 format;
 
 	switch (finfo->format) {
 	case DRM_FORMAT_XRGB1555:
@@ -459,48 +573,58 @@ static void ingenic_ipu_plane_atomic_update(struct drm_plane *plane,
 		break;
 	default:
 		WARN_ONCE(1, "Unsupported format");
+		format = 0;
 		break;
 	}
 
 	/* Fix output to RGB888 */
-	format |= JZ_IPU_D_FMT_OUT_FMT_RGB888;
+	return format | JZ_IPU_D_FMT_OUT_FMT_RGB888;
+}
 
-	/* Set pixel format */
-	regmap_write(ipu->map, JZ_REG_IPU_D_FMT, format);
+static void ingenic_ipu_compute_regs(struct ingenic_ipu *ipu,
+				     struct drm_plane_state *state,
+				     struct ingenic_ipu_private_state *ipu_state)
+{
+	const struct drm_format_info *finfo = state->fb->format;
+	struct ingenic_ipu_regs *regs = &ipu_state->regs;
+	bool upscaling_w, upscaling_h;
+	u32 ctrl = 0, coef_index = 0, stride = 0;
 
-	/* Set the output height/width/stride */
-	regmap_write(ipu->map, JZ_REG_IPU_OUT_GS,
-		     ((newstate->crtc_w * 4) << JZ_IPU_OUT_GS_W_LSB)
-		     | newstate->crtc_h << JZ_IPU_OUT_GS_H_LSB);
-	regmap_write(ipu->map, JZ_REG_IPU_OUT_STRIDE, newstate->crtc_w * 4);
+	regs->addr_y = drm_fb_cma_get_gem_addr(state->fb, state, 0);
+	regs->addr_u = finfo->num_planes > 1 ?
+		drm_fb_cma_get_gem_addr(state->fb, state, 1) : 0;
+	regs->addr_v = finfo->num_planes > 2 ?
+		drm_fb_cma_get_gem_addr(state->fb, state, 2) : 0;
 
-	if (finfo->is_yuv) {
-		regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL, JZ_IPU_CTRL_CSC_EN);
+	if (finfo->num_planes == 1)
+		ctrl |= JZ_IPU_CTRL_SPKG_SEL;
 
-		/*
-		 * Offsets for Chroma/Luma.
-		 * y = source Y - LUMA,
-		 * u = source Cb - CHROMA,
-		 * v = source Cr - CHROMA
-		 */
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_OFFSET,
-			     128 << JZ_IPU_CSC_OFFSET_CHROMA_LSB |
-			     0 << JZ_IPU_CSC_OFFSET_LUMA_LSB);
+	/* Set the input height/width/strides */
+	if (finfo->num_planes > 2)
+		stride = ((state->src_w >> 16) * finfo->cpp[2] / finfo->hsub)
+			<< JZ_IPU_UV_STRIDE_V_LSB;
 
-		/*
-		 * YUV422 to RGB conversion table.
-		 * R = C0 / 0x400 * y + C1 / 0x400 * v
-		 * G = C0 / 0x400 * y - C2 / 0x400 * u - C3 / 0x400 * v
-		 * B = C0 / 0x400 * y + C4 / 0x400 * u
-		 */
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_C0_COEF, 0x4a8);
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_C1_COEF, 0x662);
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_C2_COEF, 0x191);
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_C3_COEF, 0x341);
-		regmap_write(ipu->map, JZ_REG_IPU_CSC_C4_COEF, 0x811);
-	}
+	if (finfo->num_planes > 1)
+		stride |= ((state->src_w >> 16) * finfo->cpp[1] / finfo->hsub)
+			<< JZ_IPU_UV_STRIDE_U_LSB;
+
+	regs->uv_stride = stride;
+
+	stride = ((state->src_w >> 16) * finfo->cpp[0]) << JZ_IPU_Y_STRIDE_Y_LSB;
+	regs->y_stride = stride;
+
+	regs->in_gs = (stride << JZ_IPU_IN_GS_W_LSB) |
+		((state->src_h >> 16) << JZ_IPU_IN_GS_H_LSB);
 
-	ctrl = 0;
+	regs->d_fmt = ingenic_ipu_get_d_fmt(finfo);
+
+	/* Set the output height/width/stride */
+	regs->out_gs = ((state->crtc_w * 4) << JZ_IPU_OUT_GS_W_LSB)
+		| state->crtc_h << JZ_IPU_OUT_GS_H_LSB;
+	regs->out_stride = state->crtc_w * 4;
+
+	if (finfo->is_yuv)
+		ctrl |= JZ_IPU_CTRL_CSC_EN;
 
 	/*
 	 * Must set ZOOM_SEL before programming bicubic LUTs.
@@ -534,20 +658,143 @@ static void ingenic_ipu_plane_atomic_update(struct drm_plane *plane,
 		ctrl |= JZ_IPU_CTRL_VRSZ_EN;
 	}
 
-	regmap_update_bits(ipu->map, JZ_REG_IPU_CTRL, JZ_IPU_CTRL_ZOOM_SEL |
-			   JZ_IPU_CTRL_HRSZ_EN | JZ_IPU_CTRL_VRSZ_EN |
-			   JZ_IPU_CTRL_HSCALE | JZ_IPU_CTRL_VSCALE, ctrl);
+	regs->ctrl = ctrl;
+	regs->coef_index = coef_index;
+}
+
+static void ingenic_ipu_write_regs(struct ingenic_ipu *ipu,
+				   const struct ingenic_ipu_regs *regs)
+{
+	void __iomem *base = ipu->base;
+
+	/*
+	 * The regmap has no cache, so the registers can be written directly,
+	 * without going through the regmap lock for each one of them.
+	 */
+	writel(regs->addr_y, base + JZ_REG_IPU_Y_ADDR);
+	writel(regs->addr_u, base + JZ_REG_IPU_U_ADDR);
+	writel(regs->addr_v, base + JZ_REG_IPU_V_ADDR);
+	writel(regs->d_fmt, base + JZ_REG_IPU_D_FMT);
+	writel(regs->in_gs, base + JZ_REG_IPU_IN_GS);
+	writel(regs->y_stride, base + JZ_REG_IPU_Y_STRIDE);
+	writel(regs->uv_stride, base + JZ_REG_IPU_UV_STRIDE);
+	writel(regs->out_gs, base + JZ_REG_IPU_OUT_GS);
+	writel(regs->out_stride, base + JZ_REG_IPU_OUT_STRIDE);
+	writel(regs->coef_index, base + JZ_REG_IPU_RSZ_COEF_INDEX);
+
+	if (regs->ctrl & JZ_IPU_CTRL_CSC_EN) {
+		/*
+		 * Offsets for Chroma/Luma.
+		 * y = source Y - LUMA,
+		 * u = source Cb - CHROMA,
+		 * v = source Cr - CHROMA
+		 */
+		writel(128 << JZ_IPU_CSC_OFFSET_CHROMA_LSB |
+		       0 << JZ_IPU_CSC_OFFSET_LUMA_LSB,
+		       base + JZ_REG_IPU_CSC_OFFSET);
+
+		/*
+		 * YUV422 to RGB conversion table.
+		 * R = C0 / 0x400 * y + C1 / 0x400 * v
+		 * G = C0 / 0x400 * y - C2 / 0x400 * u - C3 / 0x400 * v
+		 * B = C0 / 0x400 * y + C4 / 0x400 * u
+		 */
+		writel(0x4a8, base + JZ_REG_IPU_CSC_C0_COEF);
+		writel(0x662, base + JZ_REG_IPU_CSC_C1_COEF);
+		writel(0x191, base + JZ_REG_IPU_CSC_C2_COEF);
+		writel(0x341, base + JZ_REG_IPU_CSC_C3_COEF);
+		writel(0x811, base + JZ_REG_IPU_CSC_C4_COEF);
+	}
+}
+
+/*
+ * Changing the scaling or the source size requires a full modeset, during
+ * which the IPU is stopped, so the new bandwidth can be set right away.
+ */
+static void ingenic_ipu_set_bandwidth(struct ingenic_ipu *ipu,
+				      u32 avg_bw, u32 peak_bw)
+{
+	int err;
+
+	if (avg_bw == ipu->avg_bw && peak_bw == ipu->peak_bw)
+		return;
+
+	err = icc_set_bw(ipu->icc_path, avg_bw, peak_bw);
+	if (err) {
+		dev_warn(ipu->dev, "Unable to set bandwidth: %d\n", err);
+		return;
+	}
+
+	ipu->avg_bw = avg_bw;
+	ipu->peak_bw = peak_bw;
+}
+
+static void ingenic_ipu_plane_atomic_update(struct drm_plane *plane,
+					    struct drm_atomic_state *state)
+{
+	struct ingenic_ipu *ipu = plane_to_ingenic_ipu(plane);
+	struct drm_plane_state *newstate = drm_atomic_get_new_plane_state(state, plane);
+	struct drm_plane_state *oldstate = drm_atomic_get_new_plane_state(state, plane);
+	struct ingenic_ipu_private_state *ipu_state;
+	const struct ingenic_ipu_regs *regs;
+	bool needs_modeset;
+	int err;
 
-	/* Set the LUT index register */
-	regmap_write(ipu->map, JZ_REG_IPU_RSZ_COEF_INDEX, coef_index);
+	if (!newstate || !newstate->fb)
+		return;
+
+	ipu_state = ingenic_ipu_get_new_priv_state(ipu, state);
+	if (WARN_ON(!ipu_state))
+		return;
+
+	regs = &ipu_state->regs;
+
+	ingenic_ipu_set_bandwidth(ipu, ipu_state->avg_bw, ipu_state->peak_bw);
+
+	if (!ipu->clk_enabled) {
+		err = clk_enable(ipu->clk);
+		if (err) {
+			dev_err(ipu->dev, "Unable to enable clock: %d\n", err);
+			return;
+		}
 
-	if (ipu_state->num_w != 1 || ipu_state->denom_w != 1)
+		ipu->clk_enabled = true;
+	}
+
+	drm_fb_cma_sync_non_coherent(ipu->drm, oldstate, newstate);
+
+	/* New addresses will be committed in vblank handler... */
+	spin_lock_irq(&ipu->addr_lock);
+	ipu->addr_y = regs->addr_y;
+	ipu->addr_u = regs->addr_u;
+	ipu->addr_v = regs->addr_v;
+	spin_unlock_irq(&ipu->addr_lock);
+
+	needs_modeset = drm_atomic_crtc_needs_modeset(newstate->crtc->state);
+	if (!needs_modeset)
+		return;
+
+	/* Or right here if we're doing a full modeset. */
+	regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL, JZ_IPU_CTRL_RST);
+
+	/* Enable the chip */
+	regmap_set_bits(ipu->map, JZ_REG_IPU_CTRL,
+			JZ_IPU_CTRL_CHIP_EN | JZ_IPU_CTRL_LCDC_SEL);
+
+	ingenic_drm_plane_config(ipu->master, plane, DRM_FORMAT_XRGB8888);
+
+	ingenic_ipu_write_regs(ipu, regs);
+
+	regmap_update_bits(ipu->map, JZ_REG_IPU_CTRL,
+			   JZ_IPU_CTRL_SHADOW_MASK, regs->ctrl);
+
+	if (ipu_state->coefs_w)
 		ingenic_ipu_set_coefs(ipu, JZ_REG_IPU_HRSZ_COEF_LUT,
-				      ipu_state->num_w, ipu_state->denom_w);
+				      ipu_state->coefs_w);
 
-	if (ipu_state->num_h != 1 || ipu_state->denom_h != 1)
+	if (ipu_state->coefs_h)
 		ingenic_ipu_set_coefs(ipu, JZ_REG_IPU_VRSZ_COEF_LUT,
-				      ipu_state->num_h, ipu_state->denom_h);
+				      ipu_state->coefs_h);
 
 	/* Clear STATUS register */
 	regmap_write(ipu->map, JZ_REG_IPU_STATUS, 0);
@@ -575,6 +822,7 @@ static int ingenic_ipu_plane_atomic_check(struct drm_plane *plane,
 	struct drm_crtc *crtc = new_plane_state->crtc ?: old_plane_state->crtc;
 	struct drm_crtc_state *crtc_state;
 	struct ingenic_ipu_private_state *ipu_state;
+	int err;
 
 	if (!crtc)
 		return 0;
@@ -587,6 +835,9 @@ static int ingenic_ipu_plane_atomic_check(struct drm_plane *plane,
 	if (IS_ERR(ipu_state))
 		return PTR_ERR(ipu_state);
 
+	ipu_state->avg_bw = 0;
+	ipu_state->peak_bw = 0;
+
 	/* Request a full modeset if we are enabling or disabling the IPU. */
 	if (!old_plane_state->crtc ^ !new_plane_state->crtc)
 		crtc_state->mode_changed = true;
@@ -610,7 +861,7 @@ static int ingenic_ipu_plane_atomic_check(struct drm_plane *plane,
 		return -EINVAL;
 
 	if (!osd_changed(new_plane_state, old_plane_state))
-		goto out_check_damage;
+		goto out_compute_regs;
 
 	crtc_state->mode_changed = true;
 
@@ -644,6 +895,20 @@ static int ingenic_ipu_plane_atomic_check(struct drm_plane *plane,
 	ipu_state->denom_w = denom_w;
 	ipu_state->denom_h = denom_h;
 
+out_compute_regs:
+	if (new_plane_state->fb) {
+		err = ingenic_ipu_state_get_coefs(ipu, ipu_state);
+		if (err)
+			return err;
+
+		ingenic_ipu_compute_regs(ipu, new_plane_state, ipu_state);
+
+		ingenic_drm_bandwidth(crtc_state, new_plane_state->fb->format,
+				      new_plane_state->src_w >> 16,
+				      new_plane_state->src_h >> 16,
+				      &ipu_state->avg_bw, &ipu_state->peak_bw);
+	}
+
 out_check_damage:
 	drm_atomic_helper_check_plane_damage(state, new_plane_state);
 
@@ -664,6 +929,8 @@ static void ingenic_ipu_plane_atomic_disable(struct drm_plane *plane,
 		clk_disable(ipu->clk);
 		ipu->clk_enabled = false;
 	}
+
+	ingenic_ipu_set_bandwidth(ipu, 0, 0);
 }
 
 static const struct drm_plane_helper_funcs ingenic_ipu_plane_helper_funcs = {
@@ -736,6 +1003,11 @@ ingenic_ipu_duplicate_state(struct drm_private_obj *obj)
 	if (!state)
 		return NULL;
 
+	if (state->coefs_w)
+		kref_get(&state->coefs_w->ref);
+	if (state->coefs_h)
+		kref_get(&state->coefs_h->ref);
+
 	__drm_atomic_helper_private_obj_duplicate_state(obj, &state->base);
 
 	return &state->base;
@@ -746,6 +1018,8 @@ static void ingenic_ipu_destroy_state(struct drm_private_obj *obj,
 {
 	struct ingenic_ipu_private_state *priv_state = to_ingenic_ipu_priv_state(state);
 
+	ingenic_ipu_put_coefs(priv_state->coefs_w);
+	ingenic_ipu_put_coefs(priv_state->coefs_h);
 	kfree(priv_state);
 }
 
@@ -768,9 +1042,11 @@ static irqreturn_t ingenic_ipu_irq_handler(int irq, void *arg)
 	regmap_write(ipu->map, JZ_REG_IPU_STATUS, 0);
 
 	/* Set previously cached addresses */
-	regmap_write(ipu->map, JZ_REG_IPU_Y_ADDR, ipu->addr_y);
-	regmap_write(ipu->map, JZ_REG_IPU_U_ADDR, ipu->addr_u);
-	regmap_write(ipu->map, JZ_REG_IPU_V_ADDR, ipu->addr_v);
+	spin_lock(&ipu->addr_lock);
+	writel(ipu->addr_y, ipu->base + JZ_REG_IPU_Y_ADDR);
+	writel(ipu->addr_u, ipu->base + JZ_REG_IPU_U_ADDR);
+	writel(ipu->addr_v, ipu->base + JZ_REG_IPU_V_ADDR);
+	spin_unlock(&ipu->addr_lock);
 
 	/* Run IPU for the new frame */
 	if (ipu->soc_info->manual_restart)
@@ -815,6 +1091,8 @@ static int ingenic_ipu_bind(struct device *dev, struct device *master, void *d)
 	ipu->drm = drm;
 	ipu->master = master;
 	ipu->soc_info = soc_info;
+	INIT_LIST_HEAD(&ipu->coefs_cache);
+	spin_lock_init(&ipu->addr_lock);
 
 	base = devm_platform_ioremap_resource(pdev, 0);
 	if (IS_ERR(base)) {
@@ -822,6 +1100,7 @@ static int ingenic_ipu_bind(struct device *dev, struct device *master, void *d)
 		return PTR_ERR(base);
 	}
 
+	ipu->base = base;
 	ipu->map = devm_regmap_init_mmio(dev, base, &ingenic_ipu_regmap_config);
 	if (IS_ERR(ipu->map)) {
 		dev_err(dev, "Failed to create regmap\n");
@@ -833,10 +1112,14 @@ static int ingenic_ipu_bind(struct device *dev, struct device *master, void *d)
 		return irq;
 
 	ipu->clk = devm_clk_get(dev, "ipu");
-	if (IS_ERR(ipu->clk)) {
-		dev_err(dev, "Failed to get pixel clock\n");
-		return PTR_ERR(ipu->clk);
-	}
+	if (IS_ERR(ipu->clk))
+		return dev_err_probe(dev, PTR_ERR(ipu->clk),
+				     "Failed to get pixel clock\n");
+
+	ipu->icc_path = devm_of_icc_get(dev, "memory");
+	if (IS_ERR(ipu->icc_path))
+		return dev_err_probe(dev, PTR_ERR(ipu->icc_path),
+				     "Failed to get interconnect path\n");
 
 	err = devm_request_irq(dev, irq, ingenic_ipu_irq_handler, 0,
 			       dev_name(dev), ipu);
@@ -908,6 +1191,7 @@ static void ingenic_ipu_unbind(struct device *dev,
 
 	drm_atomic_private_obj_fini(&ipu->private_obj);
 	clk_unprepare(ipu->clk);
+	ingenic_ipu_free_coefs(ipu);
 }
 
 static const struct component_ops ingenic_ipu_ops = {
@@ -988,6 +1272,7 @@ static struct platform_driver ingenic_ipu_driver = {
 	.driver = {
 		.name = "ingenic-ipu",
 		.of_match_table = ingenic_ipu_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe = ingenic_ipu_probe,
 	.remove = ingenic_ipu_remove,
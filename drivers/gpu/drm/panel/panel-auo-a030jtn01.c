@@ -16,6 +16,7 @@
 #include <linux/regulator/consumer.h>
 #include <linux/spi/spi.h>
 
+#include <drm/drm_connector.h>
 #include <drm/drm_modes.h>
 #include <drm/drm_panel.h>
 
@@ -35,6 +36,8 @@ struct a030jtn01 {
 
 	struct regulator *supply;
 	struct gpio_desc *reset_gpio;
+
+	enum drm_panel_orientation orientation;
 };
 
 static inline struct a030jtn01 *to_a030jtn01(struct drm_panel *panel)
@@ -153,6 +156,8 @@ static int a030jtn01_get_modes(struct drm_panel *panel,
 					 &panel_info->bus_format, 1);
 	connector->display_info.bus_flags = panel_info->bus_flags;
 
+	drm_connector_set_panel_orientation(connector, priv->orientation);
+
 	return panel_info->num_modes;
 }
 
@@ -206,15 +211,19 @@ static int a030jtn01_probe(struct spi_device *spi)
 		return -EINVAL;
 
 	priv->supply = devm_regulator_get(dev, "power");
-	if (IS_ERR(priv->supply)) {
-		dev_err(dev, "Failed to get power supply\n");
-		return PTR_ERR(priv->supply);
-	}
+	if (IS_ERR(priv->supply))
+		return dev_err_probe(dev, PTR_ERR(priv->supply),
+				     "Failed to get power supply\n");
 
 	priv->reset_gpio = devm_gpiod_get(dev, "reset", GPIOD_OUT_HIGH);
-	if (IS_ERR(priv->reset_gpio)) {
-		dev_err(dev, "Failed to get reset GPIO\n");
-		return PTR_ERR(priv->reset_gpio);
+	if (IS_ERR(priv->reset_gpio))
+		return dev_err_probe(dev, PTR_ERR(priv->reset_gpio),
+				     "Failed to get reset GPIO\n");
+
+	err = of_drm_get_panel_orientation(dev->of_node, &priv->orientation);
+	if (err) {
+		dev_err(dev, "Failed to get panel orientation: %d\n", err);
+		return err;
 	}
 
 	drm_panel_init(&priv->panel, dev, &a030jtn01_funcs,
@@ -286,6 +295,7 @@ static struct spi_driver a030jtn01_driver = {
 	.driver = {
 		.name = "auo-a030jtn01",
 		.of_match_table = a030jtn01_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe = a030jtn01_probe,
 	.remove = a030jtn01_remove,
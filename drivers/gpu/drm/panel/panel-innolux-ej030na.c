@@ -16,6 +16,7 @@
 #include <linux/regulator/consumer.h>
 #include <linux/spi/spi.h>
 
+#include <drm/drm_connector.h>
 #include <drm/drm_modes.h>
 #include <drm/drm_panel.h>
 
@@ -35,6 +36,8 @@ struct ej030na {
 
 	struct regulator *supply;
 	struct gpio_desc *reset_gpio;
+
+	enum drm_panel_orientation orientation;
 };
 
 static inline struct ej030na *to_ej030na(struct drm_panel *panel)
@@ -159,6 +162,8 @@ static int ej030na_get_modes(struct drm_panel *panel,
 					 &panel_info->bus_format, 1);
 	connector->display_info.bus_flags = panel_info->bus_flags;
 
+	drm_connector_set_panel_orientation(connector, priv->orientation);
+
 	return panel_info->num_modes;
 }
 
@@ -198,15 +203,19 @@ static int ej030na_probe(struct spi_device *spi)
 		return -EINVAL;
 
 	priv->supply = devm_regulator_get(dev, "power");
-	if (IS_ERR(priv->supply)) {
-		dev_err(dev, "Failed to get power supply\n");
-		return PTR_ERR(priv->supply);
-	}
+	if (IS_ERR(priv->supply))
+		return dev_err_probe(dev, PTR_ERR(priv->supply),
+				     "Failed to get power supply\n");
 
 	priv->reset_gpio = devm_gpiod_get(dev, "reset", GPIOD_OUT_HIGH);
-	if (IS_ERR(priv->reset_gpio)) {
-		dev_err(dev, "Failed to get reset GPIO\n");
-		return PTR_ERR(priv->reset_gpio);
+	if (IS_ERR(priv->reset_gpio))
+		return dev_err_probe(dev, PTR_ERR(priv->reset_gpio),
+				     "Failed to get reset GPIO\n");
+
+	err = of_drm_get_panel_orientation(dev->of_node, &priv->orientation);
+	if (err) {
+		dev_err(dev, "Failed to get panel orientation: %d\n", err);
+		return err;
 	}
 
 	drm_panel_init(&priv->panel, dev, &ej030na_funcs,
@@ -278,6 +287,7 @@ static struct spi_driver ej030na_driver = {
 	.driver = {
 		.name = "panel-innolux-ej030na",
 		.of_match_table = ej030na_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe = ej030na_probe,
 	.remove = ej030na_remove,
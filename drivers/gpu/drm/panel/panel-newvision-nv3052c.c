@@ -408,16 +408,14 @@ static int nv3052c_probe(struct mipi_dsi_device *dsi)
 	dsi->bus_type = priv->panel_info->bus_type;
 
 	priv->supply = devm_regulator_get(dev, "power");
-	if (IS_ERR(priv->supply)) {
-		dev_err(dev, "Failed to get power supply\n");
-		return PTR_ERR(priv->supply);
-	}
+	if (IS_ERR(priv->supply))
+		return dev_err_probe(dev, PTR_ERR(priv->supply),
+				     "Failed to get power supply\n");
 
 	priv->reset_gpio = devm_gpiod_get(dev, "reset", GPIOD_OUT_HIGH);
-	if (IS_ERR(priv->reset_gpio)) {
-		dev_err(dev, "Failed to get reset GPIO\n");
-		return PTR_ERR(priv->reset_gpio);
-	}
+	if (IS_ERR(priv->reset_gpio))
+		return dev_err_probe(dev, PTR_ERR(priv->reset_gpio),
+				     "Failed to get reset GPIO\n");
 
 	drm_panel_init(&priv->panel, dev, &nv3052c_funcs,
 		       DRM_MODE_CONNECTOR_DPI);
@@ -506,6 +504,7 @@ static struct mipi_dsi_driver nv3052c_driver = {
 	.driver = {
 		.name = "nv3052c",
 		.of_match_table = nv3052c_of_match,
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe = nv3052c_probe,
 	.remove = nv3052c_remove,
@@ -24,7 +24,7 @@
 
 #include "hwspinlock_internal.h"
 
-/* retry delay used in atomic context */
+/* maximum retry delay used in atomic context, doubled from 1us up to it */
 #define HWSPINLOCK_RETRY_DELAY_US	100
 
 /* radix tree tags */
@@ -207,7 +207,7 @@ int __hwspin_lock_timeout(struct hwspinlock *hwlock, unsigned int to,
 					int mode, unsigned long *flags)
 {
 	int ret;
-	unsigned long expire, atomic_delay = 0;
+	unsigned long expire, atomic_delay = 0, delay = 1;
 
 	expire = msecs_to_jiffies(to) + jiffies;
 
@@ -222,10 +222,17 @@ int __hwspin_lock_timeout(struct hwspinlock *hwlock, unsigned int to,
 		 * us to try again
 		 */
 		if (mode == HWLOCK_IN_ATOMIC) {
-			udelay(HWSPINLOCK_RETRY_DELAY_US);
-			atomic_delay += HWSPINLOCK_RETRY_DELAY_US;
+			udelay(delay);
+			atomic_delay += delay;
 			if (atomic_delay > to * 1000)
 				return -ETIMEDOUT;
+
+			/*
+			 * Locks are usually held briefly: don't wait for the
+			 * full delay before retrying a lock just taken.
+			 */
+			delay = min_t(unsigned long, 2 * delay,
+				      HWSPINLOCK_RETRY_DELAY_US);
 		} else {
 			if (time_is_before_eq_jiffies(expire))
 				return -ETIMEDOUT;
@@ -6,11 +6,16 @@
 
 #include <linux/bitops.h>
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/hwspinlock.h>
 #include <linux/kernel.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
 #include <linux/module.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
+#include <linux/sched/clock.h>
+#include <linux/seq_file.h>
 
 #include "hwspinlock_internal.h"
 
@@ -21,33 +26,83 @@
 #define AUX_SPIN1_LOCKED	BIT(0)
 #define AUX_SPIN2_LOCKED	BIT(1)
 
+/* Histogram buckets: [0, 2us), then [2^i, 2^(i+1)) us, the last one open */
+#define HIST_BUCKETS		12
+
+/**
+ * struct ingenic_lock - Ingenic VPU hwspinlock private structure
+ * @base: AUX spinlock registers
+ * @clk: AUX clock, enabled while the lock is held
+ * @wait_start: time of the first failed attempt of the current waiter, or 0
+ * @hold_start: time the lock was taken
+ * @wait_hist: histogram of the times waited for the lock when contended
+ * @hold_hist: histogram of the times the lock was held
+ * @bank: the hwspinlock device
+ *
+ * The statistics are only updated with the lock held, which serializes
+ * them, except @wait_start. A waiter which times out is accounted to the
+ * next acquisition of the lock.
+ */
 struct ingenic_lock {
 	void __iomem *base;
 	struct clk *clk;
+	u64 wait_start;
+	u64 hold_start;
+	unsigned long wait_hist[HIST_BUCKETS];
+	unsigned long hold_hist[HIST_BUCKETS];
 	struct hwspinlock_device bank;
 };
 
+static void ingenic_hwspinlock_account(unsigned long *hist, u64 ns)
+{
+	u64 us = div_u64(ns, NSEC_PER_USEC);
+	unsigned int i = 0;
+
+	if (us)
+		i = min_t(unsigned int, ilog2(us), HIST_BUCKETS - 1);
+
+	hist[i]++;
+}
+
 static int ingenic_hwspinlock_trylock(struct hwspinlock *lock)
 {
 	struct ingenic_lock *priv = lock->priv;
-	int err;
+	u64 now;
 	u32 val;
 
-	err = clk_enable(priv->clk);
-	if (err)
-		return err;
+	/* Nonzero means that the lock was taken */
+	if (clk_enable(priv->clk))
+		return 0;
 
 	readl(priv->base + REG_AUX_SPIN1);
 
 	val = readl(priv->base + REG_AUX_SPINLK);
-
-	return val == AUX_SPIN1_LOCKED;
+	now = local_clock();
+
+	if (val != AUX_SPIN1_LOCKED) {
+		clk_disable(priv->clk);
+		if (!priv->wait_start)
+			priv->wait_start = now;
+		return 0;
+	}
+
+	if (priv->wait_start) {
+		ingenic_hwspinlock_account(priv->wait_hist,
+					   now - priv->wait_start);
+		priv->wait_start = 0;
+	}
+	priv->hold_start = now;
+
+	return 1;
 }
 
 static void ingenic_hwspinlock_unlock(struct hwspinlock *lock)
 {
 	struct ingenic_lock *priv = lock->priv;
 
+	ingenic_hwspinlock_account(priv->hold_hist,
+				   local_clock() - priv->hold_start);
+
 	writel(0, priv->base + REG_AUX_SPINLK);
 	clk_disable(priv->clk);
 }
@@ -57,15 +112,37 @@ static const struct hwspinlock_ops ingenic_hwspinlock_ops = {
 	.unlock		= ingenic_hwspinlock_unlock,
 };
 
+static int ingenic_hwspinlock_stats_show(struct seq_file *m, void *v)
+{
+	struct ingenic_lock *priv = m->private;
+	unsigned int i;
+
+	seq_puts(m, "usecs wait hold\n");
+
+	for (i = 0; i < HIST_BUCKETS; i++)
+		seq_printf(m, "%lu %lu %lu\n", i ? BIT(i) : 0,
+			   READ_ONCE(priv->wait_hist[i]),
+			   READ_ONCE(priv->hold_hist[i]));
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(ingenic_hwspinlock_stats);
+
 static void ingenic_hwspinlock_clk_unprepare(void *d)
 {
 	clk_unprepare(d);
 }
 
+static void ingenic_hwspinlock_debugfs_remove(void *d)
+{
+	debugfs_remove(d);
+}
+
 static int ingenic_hwspinlock_probe(struct platform_device *pdev)
 {
 	struct device *dev = &pdev->dev;
 	struct ingenic_lock *priv;
+	struct dentry *dentry;
 	int err;
 
 	priv = devm_kzalloc(dev, struct_size(priv, bank.lock, 1), GFP_KERNEL);
@@ -96,6 +173,13 @@ static int ingenic_hwspinlock_probe(struct platform_device *pdev)
 	writel(AUX_SPIN1_LOCKED, priv->base + REG_AUX_SPIN1);
 	writel(AUX_SPIN2_LOCKED, priv->base + REG_AUX_SPIN2);
 
+	dentry = debugfs_create_file(dev_name(dev), 0444, NULL, priv,
+				     &ingenic_hwspinlock_stats_fops);
+	err = devm_add_action_or_reset(dev, ingenic_hwspinlock_debugfs_remove,
+				       dentry);
+	if (err)
+		return err;
+
 	return devm_hwspin_lock_register(dev, &priv->bank,
 					 &ingenic_hwspinlock_ops, 0, 1);
 }
@@ -16,6 +16,7 @@
 #include <linux/init.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
+#include <linux/iopoll.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/of_device.h>
@@ -121,6 +122,10 @@
 
 #define JZ4780_I2C_TIMEOUT	300
 
+/* Poll interval and timeout when waiting for the controller state, in us */
+#define JZ4780_I2C_POLL_US		10
+#define JZ4780_I2C_POLL_TIMEOUT_US	75000
+
 #define BUFSIZE 200
 
 enum ingenic_i2c_version {
@@ -183,56 +188,50 @@ static inline void jz4780_i2c_writew(struct jz4780_i2c *i2c,
 static int jz4780_i2c_disable(struct jz4780_i2c *i2c)
 {
 	unsigned short regval;
-	unsigned long loops = 5;
+	int ret;
 
 	jz4780_i2c_writew(i2c, JZ4780_I2C_ENB, 0);
 
-	do {
-		regval = jz4780_i2c_readw(i2c, JZ4780_I2C_ENSTA);
-		if (!(regval & JZ4780_I2C_ENB_I2C))
-			return 0;
-
-		usleep_range(5000, 15000);
-	} while (--loops);
+	ret = readw_poll_timeout(i2c->iomem + JZ4780_I2C_ENSTA, regval,
+				 !(regval & JZ4780_I2C_ENB_I2C),
+				 JZ4780_I2C_POLL_US,
+				 JZ4780_I2C_POLL_TIMEOUT_US);
+	if (ret)
+		dev_err(&i2c->adap.dev, "disable failed: ENSTA=0x%04x\n",
+			regval);
 
-	dev_err(&i2c->adap.dev, "disable failed: ENSTA=0x%04x\n", regval);
-	return -ETIMEDOUT;
+	return ret;
 }
 
 static int jz4780_i2c_enable(struct jz4780_i2c *i2c)
 {
 	unsigned short regval;
-	unsigned long loops = 5;
+	int ret;
 
 	jz4780_i2c_writew(i2c, JZ4780_I2C_ENB, 1);
 
-	do {
-		regval = jz4780_i2c_readw(i2c, JZ4780_I2C_ENSTA);
-		if (regval & JZ4780_I2C_ENB_I2C)
-			return 0;
-
-		usleep_range(5000, 15000);
-	} while (--loops);
+	ret = readw_poll_timeout(i2c->iomem + JZ4780_I2C_ENSTA, regval,
+				 regval & JZ4780_I2C_ENB_I2C,
+				 JZ4780_I2C_POLL_US,
+				 JZ4780_I2C_POLL_TIMEOUT_US);
+	if (ret)
+		dev_err(&i2c->adap.dev, "enable failed: ENSTA=0x%04x\n",
+			regval);
 
-	dev_err(&i2c->adap.dev, "enable failed: ENSTA=0x%04x\n", regval);
-	return -ETIMEDOUT;
+	return ret;
 }
 
 static int jz4780_i2c_set_target(struct jz4780_i2c *i2c, unsigned char address)
 {
 	unsigned short regval;
-	unsigned long loops = 5;
-
-	do {
-		regval = jz4780_i2c_readw(i2c, JZ4780_I2C_STA);
-		if ((regval & JZ4780_I2C_STA_TFE) &&
-		    !(regval & JZ4780_I2C_STA_MSTACT))
-			break;
-
-		usleep_range(5000, 15000);
-	} while (--loops);
+	int ret;
 
-	if (loops) {
+	ret = readw_poll_timeout(i2c->iomem + JZ4780_I2C_STA, regval,
+				 (regval & JZ4780_I2C_STA_TFE) &&
+				 !(regval & JZ4780_I2C_STA_MSTACT),
+				 JZ4780_I2C_POLL_US,
+				 JZ4780_I2C_POLL_TIMEOUT_US);
+	if (!ret) {
 		jz4780_i2c_writew(i2c, JZ4780_I2C_TAR, address);
 		return 0;
 	}
@@ -74,6 +74,9 @@
 #define JZ4770_ADC_BATTERY_VREF			1200
 #define JZ4770_ADC_BATTERY_VREF_BITS		12
 
+/* Default delay between two series of touchscreen-mode samples */
+#define JZ_ADC_DEFAULT_ADWAIT		80
+
 #define JZ_ADC_IRQ_AUX			BIT(0)
 #define JZ_ADC_IRQ_BATTERY		BIT(1)
 #define JZ_ADC_IRQ_TOUCH		BIT(2)
@@ -105,6 +108,9 @@ struct ingenic_adc {
 	struct mutex aux_lock;
 	const struct ingenic_adc_soc_data *soc_data;
 	bool low_vref_mode;
+	/* Rate of the clock that ADWAIT counts, in Hz */
+	unsigned long wait_clk_rate;
+	u16 adwait;
 };
 
 static void ingenic_adc_set_adcmd(struct iio_dev *iio_dev, unsigned long mask)
@@ -272,6 +278,24 @@ static int ingenic_adc_write_raw(struct iio_dev *iio_dev,
 		default:
 			return -EINVAL;
 		}
+	case IIO_CHAN_INFO_SAMP_FREQ:
+		if (val <= 0 || !adc->wait_clk_rate)
+			return -EINVAL;
+
+		/*
+		 * The rate can be changed while the buffer is enabled, which
+		 * is when the clock is running; the new delay applies to the
+		 * next series of samples.
+		 */
+		mutex_lock(&iio_dev->mlock);
+		adc->adwait = clamp_t(unsigned long,
+				      DIV_ROUND_CLOSEST(adc->wait_clk_rate, val),
+				      1, U16_MAX);
+		if (iio_buffer_enabled(iio_dev))
+			writew(adc->adwait, adc->base + JZ_ADC_REG_ADWAIT);
+		mutex_unlock(&iio_dev->mlock);
+
+		return 0;
 	default:
 		return -EINVAL;
 	}
@@ -331,6 +355,7 @@ static int jz4725b_adc_init_clk_div(struct device *dev, struct ingenic_adc *adc)
 
 	/* We also need a divider that produces a 10us clock. */
 	div_10us = DIV_ROUND_UP(rate, 100000);
+	adc->wait_clk_rate = rate / div_10us;
 
 	writel(((div_10us - 1) << JZ4725B_ADC_REG_ADCLK_CLKDIV10US_LSB) |
 	       (div_main - 1) << JZ_ADC_REG_ADCLK_CLKDIV_LSB,
@@ -366,6 +391,7 @@ static int jz4770_adc_init_clk_div(struct device *dev, struct ingenic_adc *adc)
 
 	/* We also need a divider that produces a 10us clock. */
 	div_10us = DIV_ROUND_UP(rate, 10000);
+	adc->wait_clk_rate = rate / div_10us;
 	/* And another, which produces a 1ms clock. */
 	div_ms = DIV_ROUND_UP(rate, 1000);
 
@@ -403,6 +429,7 @@ static const struct iio_chan_spec jz4740_channels[] = {
 static const struct iio_chan_spec jz4770_channels[] = {
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_XP,
 		.scan_index = 0,
@@ -414,6 +441,7 @@ static const struct iio_chan_spec jz4770_channels[] = {
 	},
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_YP,
 		.scan_index = 1,
@@ -425,6 +453,7 @@ static const struct iio_chan_spec jz4770_channels[] = {
 	},
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_XN,
 		.scan_index = 2,
@@ -436,6 +465,7 @@ static const struct iio_chan_spec jz4770_channels[] = {
 	},
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_YN,
 		.scan_index = 3,
@@ -447,6 +477,7 @@ static const struct iio_chan_spec jz4770_channels[] = {
 	},
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_XD,
 		.scan_index = 4,
@@ -458,6 +489,7 @@ static const struct iio_chan_spec jz4770_channels[] = {
 	},
 	{
 		.type = IIO_VOLTAGE,
+		.info_mask_shared_by_all = BIT(IIO_CHAN_INFO_SAMP_FREQ),
 		.indexed = 1,
 		.channel = INGENIC_ADC_TOUCH_YD,
 		.scan_index = 5,
@@ -638,6 +670,13 @@ static int ingenic_adc_read_raw(struct iio_dev *iio_dev,
 		}
 
 		return IIO_VAL_FRACTIONAL_LOG2;
+	case IIO_CHAN_INFO_SAMP_FREQ:
+		/*
+		 * This ignores the conversion time of the samples themselves,
+		 * which is small compared to the delay between two series.
+		 */
+		*val = adc->wait_clk_rate / adc->adwait;
+		return IIO_VAL_INT;
 	default:
 		return -EINVAL;
 	}
@@ -688,7 +727,7 @@ static int ingenic_adc_buffer_enable(struct iio_dev *iio_dev)
 			       JZ_ADC_REG_CFG_SAMPLE_NUM(4) |
 			       JZ_ADC_REG_CFG_PULL_UP(4));
 
-	writew(80, adc->base + JZ_ADC_REG_ADWAIT);
+	writew(adc->adwait, adc->base + JZ_ADC_REG_ADWAIT);
 	writew(2, adc->base + JZ_ADC_REG_ADSAME);
 	writeb((u8)~JZ_ADC_IRQ_TOUCH, adc->base + JZ_ADC_REG_CTRL);
 	writel(0, adc->base + JZ_ADC_REG_ADTCH);
@@ -766,6 +805,7 @@ static int ingenic_adc_probe(struct platform_device *pdev)
 	mutex_init(&adc->lock);
 	mutex_init(&adc->aux_lock);
 	adc->soc_data = soc_data;
+	adc->adwait = JZ_ADC_DEFAULT_ADWAIT;
 
 	irq = platform_get_irq(pdev, 0);
 	if (irq < 0)
@@ -135,6 +135,8 @@ static ssize_t iio_buffer_read(struct file *filp, char __user *buf,
 		to_wait = min_t(size_t, n / datum_size, rb->watermark);
 
 	add_wait_queue(&rb->pollq, &wait);
+	/* Pairs with wq_has_sleeper() in iio_push_to_buffer() */
+	smp_mb();
 	do {
 		if (!indio_dev->info) {
 			ret = -ENODEV;
@@ -181,6 +183,8 @@ static __poll_t iio_buffer_poll(struct file *filp,
 		return 0;
 
 	poll_wait(filp, &rb->pollq, wait);
+	/* Pairs with wq_has_sleeper() in iio_push_to_buffer() */
+	smp_mb();
 	if (iio_buffer_ready(indio_dev, rb, rb->watermark, 0))
 		return EPOLLIN | EPOLLRDNORM;
 	return 0;
@@ -1700,9 +1704,15 @@ static int iio_push_to_buffer(struct iio_buffer *buffer, const void *data)
 
 	/*
 	 * We can't just test for watermark to decide if we wake the poll queue
-	 * because read may request less samples than the watermark.
+	 * because read may request less samples than the watermark. Do skip
+	 * taking the wait queue lock for every sample while no reader sleeps.
+	 * The full barrier in wq_has_sleeper() orders the store of the sample
+	 * before the check for sleepers; readers pair it with an smp_mb()
+	 * between adding themselves to the queue and checking for data.
 	 */
-	wake_up_interruptible_poll(&buffer->pollq, EPOLLIN | EPOLLRDNORM);
+	if (wq_has_sleeper(&buffer->pollq))
+		wake_up_interruptible_poll(&buffer->pollq,
+					   EPOLLIN | EPOLLRDNORM);
 	return 0;
 }
 
@@ -11,7 +11,9 @@
 #define EVDEV_MINORS		32
 #define EVDEV_MIN_BUFFER_SIZE	64U
 #define EVDEV_BUF_PACKETS	8
+#define EVDEV_MAX_RING_SIZE	4096U
 
+#include <linux/eventfd.h>
 #include <linux/poll.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
@@ -49,6 +51,12 @@ struct evdev_client {
 	enum input_clock_type clk_type;
 	bool revoked;
 	unsigned long *evmasks[EV_CNT];
+	struct input_ring *ring; /* shared with userspace, see EVIOCSRING */
+	unsigned int ring_size;
+	unsigned int ring_head; /* position of the next event in the ring */
+	unsigned int ring_packet_head; /* ring->head, as last published */
+	bool ring_dropped;
+	struct eventfd_ctx *ring_eventfd;
 	unsigned int bufsize;
 	struct input_event buffer[];
 };
@@ -241,6 +249,80 @@ static void __pass_event(struct evdev_client *client,
 	}
 }
 
+/*
+ * Queue an event to the ring of the client. The tail is written by userspace,
+ * so it is only used to check for room: a bogus value makes the ring look
+ * full, and events are dropped.
+ */
+static void __pass_ring_event(struct evdev_client *client,
+			      const struct input_value *v, u64 time)
+{
+	struct input_ring *ring = client->ring;
+	unsigned int mask = client->ring_size - 1;
+	unsigned int tail = smp_load_acquire(&ring->tail);
+	unsigned int needed = client->ring_dropped ? 2 : 1;
+	struct input_ring_event *ev;
+
+	if (client->ring_head - tail > client->ring_size - needed) {
+		/* drop the partial packet, it is useless without its end */
+		client->ring_head = client->ring_packet_head;
+		client->ring_dropped = true;
+		return;
+	}
+
+	if (client->ring_dropped) {
+		ev = &ring->events[client->ring_head++ & mask];
+		ev->time = time;
+		ev->type = EV_SYN;
+		ev->code = SYN_DROPPED;
+		ev->value = 0;
+		client->ring_dropped = false;
+	}
+
+	ev = &ring->events[client->ring_head++ & mask];
+	ev->time = time;
+	ev->type = v->type;
+	ev->code = v->code;
+	ev->value = v->value;
+}
+
+/* Returns true if a packet was published. Caller must hold buffer_lock. */
+static bool __evdev_pass_ring(struct evdev_client *client,
+			      const struct input_value *vals, unsigned int count,
+			      ktime_t *ev_time)
+{
+	u64 time = ktime_to_ns(ev_time[client->clk_type]);
+	const struct input_value *v;
+	bool wakeup = false;
+
+	for (v = vals; v != vals + count; v++) {
+		if (__evdev_is_filtered(client, v->type, v->code))
+			continue;
+
+		if (v->type == EV_SYN && v->code == SYN_REPORT) {
+			/* drop empty SYN_REPORT */
+			if (client->ring_packet_head == client->ring_head)
+				continue;
+
+			__pass_ring_event(client, v, time);
+			if (client->ring_packet_head == client->ring_head)
+				continue;
+
+			/* pairs with the acquire in userspace */
+			client->ring_packet_head = client->ring_head;
+			smp_store_release(&client->ring->head,
+					  client->ring_packet_head);
+			kill_fasync(&client->fasync, SIGIO, POLL_IN);
+			wakeup = true;
+			continue;
+		}
+
+		__pass_ring_event(client, v, time);
+	}
+
+	return wakeup;
+}
+
 static void evdev_pass_values(struct evdev_client *client,
 			const struct input_value *vals, unsigned int count,
 			ktime_t *ev_time)
@@ -260,6 +342,11 @@ static void evdev_pass_values(struct evdev_client *client,
 	/* Interrupts are disabled, just acquire the lock. */
 	spin_lock(&client->buffer_lock);
 
+	if (client->ring) {
+		wakeup = __evdev_pass_ring(client, vals, count, ev_time);
+		goto out;
+	}
+
 	for (v = vals; v != vals + count; v++) {
 		if (__evdev_is_filtered(client, v->type, v->code))
 			continue;
@@ -278,11 +365,15 @@ static void evdev_pass_values(struct evdev_client *client,
 		__pass_event(client, &event);
 	}
 
+ out:
 	spin_unlock(&client->buffer_lock);
 
-	if (wakeup)
+	if (wakeup) {
 		wake_up_interruptible_poll(&client->wait,
 			EPOLLIN | EPOLLOUT | EPOLLRDNORM | EPOLLWRNORM);
+		if (client->ring_eventfd)
+			eventfd_signal(client->ring_eventfd, 1);
+	}
 }
 
 /*
@@ -451,6 +542,9 @@ static int evdev_release(struct inode *inode, struct file *file)
 	for (i = 0; i < EV_CNT; ++i)
 		bitmap_free(client->evmasks[i]);
 
+	if (client->ring_eventfd)
+		eventfd_ctx_put(client->ring_eventfd);
+	vfree(client->ring);
 	kvfree(client);
 
 	evdev_close_device(evdev);
@@ -567,6 +661,10 @@ static ssize_t evdev_read(struct file *file, char __user *buffer,
 	if (count != 0 && count < input_event_size())
 		return -EINVAL;
 
+	/* events go to the ring only */
+	if (READ_ONCE(client->ring))
+		return -EINVAL;
+
 	for (;;) {
 		if (!evdev->exist || client->revoked)
 			return -ENODEV;
@@ -611,6 +709,7 @@ static __poll_t evdev_poll(struct file *file, poll_table *wait)
 {
 	struct evdev_client *client = file->private_data;
 	struct evdev *evdev = client->evdev;
+	struct input_ring *ring;
 	__poll_t mask;
 
 	poll_wait(file, &client->wait, wait);
@@ -620,12 +719,38 @@ static __poll_t evdev_poll(struct file *file, poll_table *wait)
 	else
 		mask = EPOLLHUP | EPOLLERR;
 
-	if (client->packet_head != client->tail)
+	ring = READ_ONCE(client->ring);
+	if (ring) {
+		if (READ_ONCE(client->ring_packet_head) != READ_ONCE(ring->tail))
+			mask |= EPOLLIN | EPOLLRDNORM;
+	} else if (client->packet_head != client->tail) {
 		mask |= EPOLLIN | EPOLLRDNORM;
+	}
 
 	return mask;
 }
 
+static int evdev_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct evdev_client *client = file->private_data;
+	struct evdev *evdev = client->evdev;
+	int retval;
+
+	retval = mutex_lock_interruptible(&evdev->mutex);
+	if (retval)
+		return retval;
+
+	if (!evdev->exist || client->revoked)
+		retval = -ENODEV;
+	else if (!client->ring)
+		retval = -EINVAL;
+	else
+		retval = remap_vmalloc_range(vma, client->ring, vma->vm_pgoff);
+
+	mutex_unlock(&evdev->mutex);
+	return retval;
+}
+
 #ifdef CONFIG_COMPAT
 
 #define BITS_PER_LONG_COMPAT (sizeof(compat_long_t) * 8)
@@ -987,6 +1112,51 @@ static int evdev_set_mask(struct evdev_client *client,
 	return 0;
 }
 
+/* must be called with evdev-mutex held */
+static int evdev_set_ring(struct evdev_client *client,
+			  const struct input_ring_setup *setup)
+{
+	struct eventfd_ctx *eventfd = NULL;
+	struct input_ring *ring;
+	unsigned int size = setup->size ?: client->bufsize;
+
+	if (client->ring)
+		return -EBUSY;
+
+	if (!is_power_of_2(size) || size > EVDEV_MAX_RING_SIZE)
+		return -EINVAL;
+
+	if (setup->eventfd >= 0) {
+		eventfd = eventfd_ctx_fdget(setup->eventfd);
+		if (IS_ERR(eventfd))
+			return PTR_ERR(eventfd);
+	}
+
+	ring = vmalloc_user(struct_size(ring, events, size));
+	if (!ring) {
+		if (eventfd)
+			eventfd_ctx_put(eventfd);
+		return -ENOMEM;
+	}
+
+	ring->size = size;
+
+	/*
+	 * Events queued for read() are dropped, the client is expected to set
+	 * up the ring right after opening the device and sync its state.
+	 */
+	spin_lock_irq(&client->buffer_lock);
+	client->packet_head = client->head = client->tail;
+	client->ring_size = size;
+	client->ring_head = client->ring_packet_head = 0;
+	client->ring_dropped = false;
+	client->ring_eventfd = eventfd;
+	WRITE_ONCE(client->ring, ring);
+	spin_unlock_irq(&client->buffer_lock);
+
+	return 0;
+}
+
 /* must be called with evdev-mutex held */
 static int evdev_get_mask(struct evdev_client *client,
 			  unsigned int type,
@@ -1034,6 +1204,7 @@ static long evdev_do_ioctl(struct file *file, unsigned int cmd,
 	struct input_dev *dev = evdev->handle.dev;
 	struct input_absinfo abs;
 	struct input_mask mask;
+	struct input_ring_setup ring_setup;
 	struct ff_effect effect;
 	int __user *ip = (int __user *)p;
 	unsigned int i, t, u, v;
@@ -1125,6 +1296,12 @@ static long evdev_do_ioctl(struct file *file, unsigned int cmd,
 
 		return evdev_set_clk_type(client, i);
 
+	case EVIOCSRING:
+		if (copy_from_user(&ring_setup, p, sizeof(ring_setup)))
+			return -EFAULT;
+
+		return evdev_set_ring(client, &ring_setup);
+
 	case EVIOCGKEYCODE:
 		return evdev_handle_get_keycode(dev, p);
 
@@ -1294,6 +1471,7 @@ static const struct file_operations evdev_fops = {
 	.read		= evdev_read,
 	.write		= evdev_write,
 	.poll		= evdev_poll,
+	.mmap		= evdev_mmap,
 	.open		= evdev_open,
 	.release	= evdev_release,
 	.unlocked_ioctl	= evdev_ioctl,
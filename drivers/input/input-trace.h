@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM input
+#define TRACE_INCLUDE_FILE input-trace
+
+#if !defined(_INPUT_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _INPUT_TRACE_H
+
+#include <linux/input.h>
+#include <linux/tracepoint.h>
+
+/*
+ * A batch of events, usually a full packet ended by SYN_REPORT, is being
+ * passed to the handlers of an input device.
+ */
+TRACE_EVENT(input_events,
+	TP_PROTO(struct input_dev *dev, const struct input_value *vals,
+		 unsigned int count),
+	TP_ARGS(dev, vals, count),
+	TP_STRUCT__entry(
+		__string( name, dev->name ?: "" )
+		__field( unsigned int, count )
+		__field( unsigned int, type )
+		__field( unsigned int, code )
+		__field( int, value )
+	),
+	TP_fast_assign(
+		__assign_str(name, dev->name ?: "");
+		__entry->count = count;
+		__entry->type = vals[count - 1].type;
+		__entry->code = vals[count - 1].code;
+		__entry->value = vals[count - 1].value;
+	),
+	TP_printk("%s: count=%u, last=%u/%u/%d",
+		  __get_str(name), __entry->count,
+		  __entry->type, __entry->code, __entry->value)
+);
+
+#endif /* _INPUT_TRACE_H */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#include <trace/define_trace.h>
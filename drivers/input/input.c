@@ -26,6 +26,9 @@
 #include "input-compat.h"
 #include "input-poller.h"
 
+#define CREATE_TRACE_POINTS
+#include "input-trace.h"
+
 MODULE_AUTHOR("Vojtech Pavlik <vojtech@suse.cz>");
 MODULE_DESCRIPTION("Input core");
 MODULE_LICENSE("GPL");
@@ -134,6 +137,8 @@ static void input_pass_values(struct input_dev *dev,
 	if (!count)
 		return;
 
+	trace_input_events(dev, vals, count);
+
 	rcu_read_lock();
 
 	handle = rcu_dereference(dev->grab);
@@ -449,6 +454,41 @@ void input_event(struct input_dev *dev,
 }
 EXPORT_SYMBOL(input_event);
 
+/**
+ * input_event_batch() - report a batch of input events
+ * @dev: device that generated the events
+ * @vals: the events
+ * @count: number of events in @vals
+ *
+ * Same as calling input_event() for each of the events in turn, but
+ * takes the device's event lock only once for the whole batch. Meant for
+ * drivers which get a number of events at once, such as a whole frame
+ * ending with EV_SYN.
+ *
+ * NOTE: input_event_batch() may be safely used right after input device
+ * was allocated with input_allocate_device(), even before it is registered
+ * with input_register_device(), but the event will not reach any of the
+ * input handlers. Such early invocation of input_event_batch() may be
+ * used to 'seed' initial state of a switch or initial position of
+ * absolute axis, etc.
+ */
+void input_event_batch(struct input_dev *dev,
+		       const struct input_value *vals, unsigned int count)
+{
+	unsigned long flags;
+	unsigned int i;
+
+	spin_lock_irqsave(&dev->event_lock, flags);
+
+	for (i = 0; i < count; i++)
+		if (is_event_supported(vals[i].type, dev->evbit, EV_MAX))
+			input_handle_event(dev, vals[i].type, vals[i].code,
+					   vals[i].value);
+
+	spin_unlock_irqrestore(&dev->event_lock, flags);
+}
+EXPORT_SYMBOL(input_event_batch);
+
 /**
  * input_inject_event() - send input event from input handler
  * @handle: input handle to send event through
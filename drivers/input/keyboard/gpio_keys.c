@@ -30,8 +30,11 @@
 #include <linux/spinlock.h>
 #include <dt-bindings/input/gpio-keys.h>
 
+struct gpio_keys_drvdata;
+
 struct gpio_button_data {
 	const struct gpio_keys_button *button;
+	struct gpio_keys_drvdata *ddata;
 	struct input_dev *input;
 	struct gpio_desc *gpiod;
 
@@ -58,6 +61,17 @@ struct gpio_keys_drvdata {
 	struct input_dev *input;
 	struct mutex disable_lock;
 	unsigned short *keymap;
+
+	/* batch scan of all GPIO buttons, see gpio_keys_batch_scan() */
+	struct gpio_desc **batch_descs;
+	unsigned long *batch_values;
+	unsigned int batch_count;
+	unsigned int batch_debounce;	/* in msecs */
+	struct hrtimer batch_timer;
+	struct delayed_work batch_work;
+	bool batch_use_hrtimer;
+	bool batch_wakeup;
+
 	struct gpio_button_data data[];
 };
 
@@ -363,28 +377,34 @@ static struct attribute *gpio_keys_attrs[] = {
 };
 ATTRIBUTE_GROUPS(gpio_keys);
 
-static void gpio_keys_gpio_report_event(struct gpio_button_data *bdata)
+static void gpio_keys_report_value(struct gpio_button_data *bdata, int state)
 {
 	const struct gpio_keys_button *button = bdata->button;
 	struct input_dev *input = bdata->input;
 	unsigned int type = button->type ?: EV_KEY;
+
+	if (type == EV_ABS) {
+		if (state)
+			input_event(input, type, button->code, button->value);
+	} else {
+		input_event(input, type, *bdata->code, state);
+	}
+}
+
+static void gpio_keys_gpio_report_event(struct gpio_button_data *bdata)
+{
 	int state;
 
 	state = bdata->debounce_use_hrtimer ?
 			gpiod_get_value(bdata->gpiod) :
 			gpiod_get_value_cansleep(bdata->gpiod);
 	if (state < 0) {
-		dev_err(input->dev.parent,
+		dev_err(bdata->input->dev.parent,
 			"failed to get gpio state: %d\n", state);
 		return;
 	}
 
-	if (type == EV_ABS) {
-		if (state)
-			input_event(input, type, button->code, button->value);
-	} else {
-		input_event(input, type, *bdata->code, state);
-	}
+	gpio_keys_report_value(bdata, state);
 }
 
 static void gpio_keys_debounce_event(struct gpio_button_data *bdata)
@@ -414,12 +434,84 @@ static enum hrtimer_restart gpio_keys_debounce_timer(struct hrtimer *t)
 	return HRTIMER_NORESTART;
 }
 
-static irqreturn_t gpio_keys_gpio_isr(int irq, void *dev_id)
+/*
+ * In batch mode, the GPIO buttons are read all at once, which gpiolib turns
+ * into a single access per GPIO controller, and reported in a single packet.
+ * An edge on any of them restarts the debounce of the whole batch, so that
+ * a burst of interrupts only results in one scan.
+ */
+static void gpio_keys_batch_scan(struct gpio_keys_drvdata *ddata)
 {
-	struct gpio_button_data *bdata = dev_id;
+	unsigned int count = READ_ONCE(ddata->batch_count);
+	struct gpio_button_data *bdata;
+	unsigned int i, n = 0;
+	int error;
 
-	BUG_ON(irq != bdata->irq);
+	if (!count)
+		return;
+
+	error = ddata->batch_use_hrtimer ?
+		gpiod_get_array_value(count, ddata->batch_descs, NULL,
+				      ddata->batch_values) :
+		gpiod_get_array_value_cansleep(count, ddata->batch_descs, NULL,
+					       ddata->batch_values);
+	if (error) {
+		dev_err(ddata->input->dev.parent,
+			"failed to get gpio states: %d\n", error);
+		goto out;
+	}
+
+	/* The buttons were added to the batch in order */
+	for (i = 0; i < ddata->pdata->nbuttons && n < count; i++) {
+		bdata = &ddata->data[i];
+		if (!bdata->gpiod)
+			continue;
+
+		if (!bdata->disabled)
+			gpio_keys_report_value(bdata,
+					       test_bit(n, ddata->batch_values));
+		n++;
+	}
+
+	input_sync(ddata->input);
+
+out:
+	if (ddata->batch_wakeup)
+		pm_relax(ddata->input->dev.parent);
+}
+
+static void gpio_keys_batch_work_func(struct work_struct *work)
+{
+	struct gpio_keys_drvdata *ddata =
+		container_of(work, struct gpio_keys_drvdata, batch_work.work);
+
+	gpio_keys_batch_scan(ddata);
+}
+
+static enum hrtimer_restart gpio_keys_batch_timer(struct hrtimer *t)
+{
+	struct gpio_keys_drvdata *ddata =
+		container_of(t, struct gpio_keys_drvdata, batch_timer);
+
+	/* A button that can sleep may have joined the batch meanwhile */
+	if (!READ_ONCE(ddata->batch_use_hrtimer))
+		mod_delayed_work(system_wq, &ddata->batch_work, 0);
+	else
+		gpio_keys_batch_scan(ddata);
 
+	return HRTIMER_NORESTART;
+}
+
+static void gpio_keys_quiesce_batch(void *data)
+{
+	struct gpio_keys_drvdata *ddata = data;
+
+	hrtimer_cancel(&ddata->batch_timer);
+	cancel_delayed_work_sync(&ddata->batch_work);
+}
+
+static void gpio_keys_gpio_wakeup(struct gpio_button_data *bdata)
+{
 	if (bdata->button->wakeup) {
 		const struct gpio_keys_button *button = bdata->button;
 
@@ -434,6 +526,15 @@ static irqreturn_t gpio_keys_gpio_isr(int irq, void *dev_id)
 			input_report_key(bdata->input, button->code, 1);
 		}
 	}
+}
+
+static irqreturn_t gpio_keys_gpio_isr(int irq, void *dev_id)
+{
+	struct gpio_button_data *bdata = dev_id;
+
+	BUG_ON(irq != bdata->irq);
+
+	gpio_keys_gpio_wakeup(bdata);
 
 	if (bdata->debounce_use_hrtimer) {
 		hrtimer_start(&bdata->debounce_timer,
@@ -448,6 +549,28 @@ static irqreturn_t gpio_keys_gpio_isr(int irq, void *dev_id)
 	return IRQ_HANDLED;
 }
 
+static irqreturn_t gpio_keys_batch_isr(int irq, void *dev_id)
+{
+	struct gpio_button_data *bdata = dev_id;
+	struct gpio_keys_drvdata *ddata = bdata->ddata;
+
+	BUG_ON(irq != bdata->irq);
+
+	gpio_keys_gpio_wakeup(bdata);
+
+	if (READ_ONCE(ddata->batch_use_hrtimer)) {
+		hrtimer_start(&ddata->batch_timer,
+			      ms_to_ktime(ddata->batch_debounce),
+			      HRTIMER_MODE_REL);
+	} else {
+		mod_delayed_work(system_wq,
+				 &ddata->batch_work,
+				 msecs_to_jiffies(ddata->batch_debounce));
+	}
+
+	return IRQ_HANDLED;
+}
+
 static enum hrtimer_restart gpio_keys_irq_timer(struct hrtimer *t)
 {
 	struct gpio_button_data *bdata = container_of(t,
@@ -514,6 +637,7 @@ static int gpio_keys_setup_key(struct platform_device *pdev,
 	int irq;
 	int error;
 
+	bdata->ddata = ddata;
 	bdata->input = input;
 	bdata->button = button;
 	spin_lock_init(&bdata->lock);
@@ -598,7 +722,17 @@ static int gpio_keys_setup_key(struct platform_device *pdev,
 			     CLOCK_REALTIME, HRTIMER_MODE_REL);
 		bdata->debounce_timer.function = gpio_keys_debounce_timer;
 
-		isr = gpio_keys_gpio_isr;
+		if (ddata->pdata->batch_scan) {
+			isr = gpio_keys_batch_isr;
+			ddata->batch_debounce = max(ddata->batch_debounce,
+						    bdata->software_debounce);
+			if (gpiod_cansleep(bdata->gpiod))
+				WRITE_ONCE(ddata->batch_use_hrtimer, false);
+			if (button->wakeup)
+				ddata->batch_wakeup = true;
+		} else {
+			isr = gpio_keys_gpio_isr;
+		}
 		irqflags = IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING;
 
 		switch (button->wakeup_event_action) {
@@ -667,6 +801,12 @@ static int gpio_keys_setup_key(struct platform_device *pdev,
 	if (!button->can_disable)
 		irqflags |= IRQF_SHARED;
 
+	/* Only scan the button once it is completely set up */
+	if (isr == gpio_keys_batch_isr) {
+		ddata->batch_descs[ddata->batch_count] = bdata->gpiod;
+		WRITE_ONCE(ddata->batch_count, ddata->batch_count + 1);
+	}
+
 	error = devm_request_any_context_irq(dev, bdata->irq, isr, irqflags,
 					     desc, bdata);
 	if (error < 0) {
@@ -678,6 +818,35 @@ static int gpio_keys_setup_key(struct platform_device *pdev,
 	return 0;
 }
 
+static int gpio_keys_setup_batch(struct device *dev,
+				 struct gpio_keys_drvdata *ddata)
+{
+	int nbuttons = ddata->pdata->nbuttons;
+	int error;
+
+	ddata->batch_descs = devm_kcalloc(dev, nbuttons,
+					  sizeof(*ddata->batch_descs),
+					  GFP_KERNEL);
+	ddata->batch_values = devm_bitmap_zalloc(dev, nbuttons, GFP_KERNEL);
+	if (!ddata->batch_descs || !ddata->batch_values)
+		return -ENOMEM;
+
+	ddata->batch_use_hrtimer = true;
+	INIT_DELAYED_WORK(&ddata->batch_work, gpio_keys_batch_work_func);
+	hrtimer_init(&ddata->batch_timer, CLOCK_REALTIME, HRTIMER_MODE_REL);
+	ddata->batch_timer.function = gpio_keys_batch_timer;
+
+	/* Registered before the IRQs, so that it runs after they are freed */
+	error = devm_add_action(dev, gpio_keys_quiesce_batch, ddata);
+	if (error) {
+		dev_err(dev, "failed to register quiesce action, error: %d\n",
+			error);
+		return error;
+	}
+
+	return 0;
+}
+
 static void gpio_keys_report_state(struct gpio_keys_drvdata *ddata)
 {
 	struct input_dev *input = ddata->input;
@@ -749,6 +918,7 @@ gpio_keys_get_devtree_pdata(struct device *dev)
 	pdata->nbuttons = nbuttons;
 
 	pdata->rep = device_property_read_bool(dev, "autorepeat");
+	pdata->batch_scan = device_property_read_bool(dev, "linux,batch-scan");
 
 	device_property_read_string(dev, "label", &pdata->name);
 
@@ -858,6 +1028,12 @@ static int gpio_keys_probe(struct platform_device *pdev)
 	if (pdata->rep)
 		__set_bit(EV_REP, input->evbit);
 
+	if (pdata->batch_scan) {
+		error = gpio_keys_setup_batch(dev, ddata);
+		if (error)
+			return error;
+	}
+
 	for (i = 0; i < pdata->nbuttons; i++) {
 		const struct gpio_keys_button *button = &pdata->buttons[i];
 
@@ -33,6 +33,8 @@
 #define UINPUT_NAME		"uinput"
 #define UINPUT_BUFFER_SIZE	16
 #define UINPUT_NUM_REQUESTS	16
+/* Events injected per hold of the device's event lock */
+#define UINPUT_INJECT_BATCH	32
 
 enum uinput_state { UIST_NEW_DEVICE, UIST_SETUP_COMPLETE, UIST_CREATED };
 
@@ -572,7 +574,9 @@ static int uinput_setup_device_legacy(struct uinput_device *udev,
 static ssize_t uinput_inject_events(struct uinput_device *udev,
 				    const char __user *buffer, size_t count)
 {
+	struct input_value vals[UINPUT_INJECT_BATCH];
 	struct input_event ev;
+	unsigned int n = 0;
 	size_t bytes = 0;
 
 	if (count != 0 && count < input_event_size())
@@ -585,14 +589,25 @@ static ssize_t uinput_inject_events(struct uinput_device *udev,
 		 * count to let userspace know that it got it's buffers
 		 * all wrong.
 		 */
-		if (input_event_from_user(buffer + bytes, &ev))
+		if (input_event_from_user(buffer + bytes, &ev)) {
+			input_event_batch(udev->dev, vals, n);
 			return -EFAULT;
+		}
 
-		input_event(udev->dev, ev.type, ev.code, ev.value);
+		vals[n].type = ev.type;
+		vals[n].code = ev.code;
+		vals[n].value = ev.value;
 		bytes += input_event_size();
-		cond_resched();
+
+		if (++n == UINPUT_INJECT_BATCH) {
+			input_event_batch(udev->dev, vals, n);
+			n = 0;
+			cond_resched();
+		}
 	}
 
+	input_event_batch(udev->dev, vals, n);
+
 	return bytes;
 }
 
@@ -9,12 +9,18 @@
 #include <linux/irqchip.h>
 #include <linux/irqchip/chained_irq.h>
 #include <linux/mfd/ingenic-tcu.h>
-#include <linux/mfd/syscon.h>
+#include <linux/of_address.h>
 #include <linux/of_irq.h>
-#include <linux/regmap.h>
 
+/*
+ * The flag and mask registers are only ever accessed from here, and have
+ * set and clear aliases which make each update atomic. They are accessed
+ * directly, and not through the TCU regmap, so that the interrupt path
+ * doesn't contend for the regmap lock with the timer, PWM and clock
+ * drivers.
+ */
 struct ingenic_tcu {
-	struct regmap *map;
+	void __iomem *base;
 	struct clk *clk;
 	struct irq_domain *domain;
 	unsigned int nb_parent_irqs;
@@ -26,18 +32,15 @@ static void ingenic_tcu_intc_cascade(struct irq_desc *desc)
 	struct irq_chip *irq_chip = irq_data_get_irq_chip(&desc->irq_data);
 	struct irq_domain *domain = irq_desc_get_handler_data(desc);
 	struct irq_chip_generic *gc = irq_get_domain_generic_chip(domain, 0);
-	struct regmap *map = gc->private;
-	uint32_t irq_reg, irq_mask;
+	unsigned long irq_reg;
 	unsigned int i;
 
-	regmap_read(map, TCU_REG_TFR, &irq_reg);
-	regmap_read(map, TCU_REG_TMR, &irq_mask);
+	irq_reg = irq_reg_readl(gc, TCU_REG_TFR);
+	irq_reg &= ~irq_reg_readl(gc, TCU_REG_TMR);
 
 	chained_irq_enter(irq_chip, desc);
 
-	irq_reg &= ~irq_mask;
-
-	for_each_set_bit(i, (unsigned long *)&irq_reg, 32)
+	for_each_set_bit(i, &irq_reg, 32)
 		generic_handle_irq(irq_linear_revmap(domain, i));
 
 	chained_irq_exit(irq_chip, desc);
@@ -47,12 +50,11 @@ static void ingenic_tcu_gc_unmask_enable_reg(struct irq_data *d)
 {
 	struct irq_chip_generic *gc = irq_data_get_irq_chip_data(d);
 	struct irq_chip_type *ct = irq_data_get_chip_type(d);
-	struct regmap *map = gc->private;
 	u32 mask = d->mask;
 
 	irq_gc_lock(gc);
-	regmap_write(map, ct->regs.ack, mask);
-	regmap_write(map, ct->regs.enable, mask);
+	irq_reg_writel(gc, mask, ct->regs.ack);
+	irq_reg_writel(gc, mask, ct->regs.enable);
 	*ct->mask_cache |= mask;
 	irq_gc_unlock(gc);
 }
@@ -61,11 +63,10 @@ static void ingenic_tcu_gc_mask_disable_reg(struct irq_data *d)
 {
 	struct irq_chip_generic *gc = irq_data_get_irq_chip_data(d);
 	struct irq_chip_type *ct = irq_data_get_chip_type(d);
-	struct regmap *map = gc->private;
 	u32 mask = d->mask;
 
 	irq_gc_lock(gc);
-	regmap_write(map, ct->regs.disable, mask);
+	irq_reg_writel(gc, mask, ct->regs.disable);
 	*ct->mask_cache &= ~mask;
 	irq_gc_unlock(gc);
 }
@@ -74,12 +75,11 @@ static void ingenic_tcu_gc_mask_disable_reg_and_ack(struct irq_data *d)
 {
 	struct irq_chip_generic *gc = irq_data_get_irq_chip_data(d);
 	struct irq_chip_type *ct = irq_data_get_chip_type(d);
-	struct regmap *map = gc->private;
 	u32 mask = d->mask;
 
 	irq_gc_lock(gc);
-	regmap_write(map, ct->regs.ack, mask);
-	regmap_write(map, ct->regs.disable, mask);
+	irq_reg_writel(gc, mask, ct->regs.ack);
+	irq_reg_writel(gc, mask, ct->regs.disable);
 	irq_gc_unlock(gc);
 }
 
@@ -89,25 +89,25 @@ static int __init ingenic_tcu_irq_init(struct device_node *np,
 	struct irq_chip_generic *gc;
 	struct irq_chip_type *ct;
 	struct ingenic_tcu *tcu;
-	struct regmap *map;
 	unsigned int i;
 	int ret, irqs;
 
-	map = device_node_to_regmap(np);
-	if (IS_ERR(map))
-		return PTR_ERR(map);
-
 	tcu = kzalloc(sizeof(*tcu), GFP_KERNEL);
 	if (!tcu)
 		return -ENOMEM;
 
-	tcu->map = map;
+	tcu->base = of_iomap(np, 0);
+	if (!tcu->base) {
+		pr_crit("%s: Unable to map registers\n", __func__);
+		ret = -ENXIO;
+		goto err_free_tcu;
+	}
 
 	irqs = of_property_count_elems_of_size(np, "interrupts", sizeof(u32));
 	if (irqs < 0 || irqs > ARRAY_SIZE(tcu->parent_irqs)) {
 		pr_crit("%s: Invalid 'interrupts' property\n", __func__);
 		ret = -EINVAL;
-		goto err_free_tcu;
+		goto err_unmap_regs;
 	}
 
 	tcu->nb_parent_irqs = irqs;
@@ -116,7 +116,7 @@ static int __init ingenic_tcu_irq_init(struct device_node *np,
 					    NULL);
 	if (!tcu->domain) {
 		ret = -ENOMEM;
-		goto err_free_tcu;
+		goto err_unmap_regs;
 	}
 
 	ret = irq_alloc_domain_generic_chips(tcu->domain, 32, 1, "TCU",
@@ -131,7 +131,7 @@ static int __init ingenic_tcu_irq_init(struct device_node *np,
 	ct = gc->chip_types;
 
 	gc->wake_enabled = IRQ_MSK(32);
-	gc->private = tcu->map;
+	gc->reg_base = tcu->base;
 
 	ct->regs.disable = TCU_REG_TMSR;
 	ct->regs.enable = TCU_REG_TMCR;
@@ -142,7 +142,7 @@ static int __init ingenic_tcu_irq_init(struct device_node *np,
 	ct->chip.flags = IRQCHIP_MASK_ON_SUSPEND | IRQCHIP_SKIP_SET_WAKE;
 
 	/* Mask all IRQs by default */
-	regmap_write(tcu->map, TCU_REG_TMSR, IRQ_MSK(32));
+	irq_reg_writel(gc, IRQ_MSK(32), TCU_REG_TMSR);
 
 	/*
 	 * On JZ4740, timer 0 and timer 1 have their own interrupt line;
@@ -173,6 +173,8 @@ static int __init ingenic_tcu_irq_init(struct device_node *np,
 		irq_dispose_mapping(tcu->parent_irqs[i - 1]);
 out_domain_remove:
 	irq_domain_remove(tcu->domain);
+err_unmap_regs:
+	iounmap(tcu->base);
 err_free_tcu:
 	kfree(tcu);
 	return ret;
@@ -4,24 +4,45 @@
  *  Ingenic XBurst platform IRQ support
  */
 
+#include <linux/debugfs.h>
 #include <linux/errno.h>
 #include <linux/init.h>
 #include <linux/types.h>
 #include <linux/interrupt.h>
 #include <linux/ioport.h>
 #include <linux/irqchip.h>
+#include <linux/irqchip/chained_irq.h>
+#include <linux/jump_label.h>
+#include <linux/log2.h>
 #include <linux/of_address.h>
 #include <linux/of_irq.h>
+#include <linux/sched/clock.h>
+#include <linux/seq_file.h>
 #include <linux/timex.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
+#include <linux/uaccess.h>
 
 #include <asm/io.h>
 
+#define INTC_MAX_CHIPS		2
+
+/*
+ * Histogram of the time spent handling each interrupt. Bucket N counts the
+ * interrupts handled in less than 2^N microseconds; the last one counts all
+ * the others.
+ */
+#define INTC_STATS_BUCKETS	8
+
 struct ingenic_intc_data {
 	void __iomem *base;
 	struct irq_domain *domain;
 	unsigned num_chips;
+
+	/* Pending registers of the chips, to avoid looking up each chip */
+	void __iomem *pending[INTC_MAX_CHIPS];
+
+	u32 (*stats)[INTC_STATS_BUCKETS];
 };
 
 #define JZ_REG_INTC_STATUS	0x00
@@ -31,31 +52,52 @@ struct ingenic_intc_data {
 #define JZ_REG_INTC_PENDING	0x10
 #define CHIP_SIZE		0x20
 
-static irqreturn_t intc_cascade(int irq, void *data)
+static DEFINE_STATIC_KEY_FALSE(intc_stats_enabled);
+static struct ingenic_intc_data *ingenic_intc;
+
+static void intc_handle_irq_stats(struct ingenic_intc_data *intc,
+				  unsigned int hwirq)
 {
-	struct ingenic_intc_data *intc = irq_get_handler_data(irq);
-	struct irq_domain *domain = intc->domain;
-	struct irq_chip_generic *gc;
-	uint32_t pending;
-	unsigned i;
+	u64 start = local_clock();
+	unsigned int bucket;
+	u64 delta_us;
 
-	for (i = 0; i < intc->num_chips; i++) {
-		gc = irq_get_domain_generic_chip(domain, i * 32);
+	generic_handle_irq(irq_linear_revmap(intc->domain, hwirq));
 
-		pending = irq_reg_readl(gc, JZ_REG_INTC_PENDING);
-		if (!pending)
-			continue;
+	/* Dividing by 1024 is close enough */
+	delta_us = (local_clock() - start) >> 10;
+	bucket = delta_us ? min_t(unsigned int, ilog2(delta_us) + 1,
+				  INTC_STATS_BUCKETS - 1) : 0;
 
-		while (pending) {
-			int bit = __fls(pending);
+	intc->stats[hwirq][bucket]++;
+}
+
+static void intc_cascade(struct irq_desc *desc)
+{
+	struct ingenic_intc_data *intc = irq_desc_get_handler_data(desc);
+	struct irq_chip *chip = irq_desc_get_chip(desc);
+	unsigned long pending;
+	unsigned int i, bit;
 
-			irq = irq_linear_revmap(domain, bit + (i * 32));
-			generic_handle_irq(irq);
+	chained_irq_enter(chip, desc);
+
+	for (i = 0; i < intc->num_chips; i++) {
+		/* The pending register already takes the mask into account */
+		pending = readl(intc->pending[i]);
+
+		while (pending) {
+			bit = __fls(pending);
 			pending &= ~BIT(bit);
+
+			if (static_branch_unlikely(&intc_stats_enabled))
+				intc_handle_irq_stats(intc, bit + (i * 32));
+			else
+				generic_handle_irq(irq_linear_revmap(intc->domain,
+								     bit + (i * 32)));
 		}
 	}
 
-	return IRQ_HANDLED;
+	chained_irq_exit(chip, desc);
 }
 
 static int __init ingenic_intc_of_init(struct device_node *node,
@@ -80,10 +122,6 @@ static int __init ingenic_intc_of_init(struct device_node *node,
 		goto out_free;
 	}
 
-	err = irq_set_handler_data(parent_irq, intc);
-	if (err)
-		goto out_unmap_irq;
-
 	intc->num_chips = num_chips;
 	intc->base = of_iomap(node, 0);
 	if (!intc->base) {
@@ -111,6 +149,7 @@ static int __init ingenic_intc_of_init(struct device_node *node,
 
 		gc->wake_enabled = IRQ_MSK(32);
 		gc->reg_base = intc->base + (i * CHIP_SIZE);
+		intc->pending[i] = gc->reg_base + JZ_REG_INTC_PENDING;
 
 		ct = gc->chip_types;
 		ct->regs.enable = JZ_REG_INTC_CLEAR_MASK;
@@ -125,9 +164,14 @@ static int __init ingenic_intc_of_init(struct device_node *node,
 		irq_reg_writel(gc, IRQ_MSK(32), JZ_REG_INTC_SET_MASK);
 	}
 
-	if (request_irq(parent_irq, intc_cascade, IRQF_NO_SUSPEND,
-			"SoC intc cascade interrupt", NULL))
-		pr_err("Failed to register SoC intc cascade interrupt\n");
+	/*
+	 * Dispatch directly from the parent interrupt's flow handler, instead
+	 * of going through a regular interrupt action.
+	 */
+	irq_set_chained_handler_and_data(parent_irq, intc_cascade, intc);
+
+	ingenic_intc = intc;
+
 	return 0;
 
 out_domain_remove:
@@ -142,6 +186,112 @@ static int __init ingenic_intc_of_init(struct device_node *node,
 	return err;
 }
 
+#ifdef CONFIG_DEBUG_FS
+static int intc_stats_show(struct seq_file *s, void *unused)
+{
+	struct ingenic_intc_data *intc = s->private;
+	unsigned int hwirq, i;
+	char label[8];
+	u32 total;
+
+	seq_puts(s, "hwirq   irq");
+	for (i = 0; i < INTC_STATS_BUCKETS - 1; i++) {
+		snprintf(label, sizeof(label), "<%u", 1 << i);
+		seq_printf(s, " %9s", label);
+	}
+	snprintf(label, sizeof(label), ">=%u", 1 << (INTC_STATS_BUCKETS - 2));
+	seq_printf(s, " %9s (us)\n", label);
+
+	for (hwirq = 0; hwirq < intc->num_chips * 32; hwirq++) {
+		for (i = 0, total = 0; i < INTC_STATS_BUCKETS; i++)
+			total += intc->stats[hwirq][i];
+
+		if (!total)
+			continue;
+
+		seq_printf(s, "%5u %5u", hwirq,
+			   irq_find_mapping(intc->domain, hwirq));
+
+		for (i = 0; i < INTC_STATS_BUCKETS; i++)
+			seq_printf(s, " %9u", intc->stats[hwirq][i]);
+
+		seq_putc(s, '\n');
+	}
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(intc_stats);
+
+static ssize_t intc_stats_enable_read(struct file *file, char __user *buf,
+				      size_t count, loff_t *ppos)
+{
+	char val[3] = { '0', '\n' };
+
+	if (static_key_enabled(&intc_stats_enabled))
+		val[0] = '1';
+
+	return simple_read_from_buffer(buf, count, ppos, val, 2);
+}
+
+static ssize_t intc_stats_enable_write(struct file *file,
+				       const char __user *buf,
+				       size_t count, loff_t *ppos)
+{
+	struct ingenic_intc_data *intc = file->private_data;
+	unsigned int size;
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(buf, count, &enable);
+	if (ret)
+		return ret;
+
+	if (enable == static_key_enabled(&intc_stats_enabled))
+		return count;
+
+	if (enable) {
+		/* Start from a clean histogram */
+		size = intc->num_chips * 32 * sizeof(*intc->stats);
+		memset(intc->stats, 0, size);
+
+		static_branch_enable(&intc_stats_enabled);
+	} else {
+		static_branch_disable(&intc_stats_enabled);
+	}
+
+	return count;
+}
+
+static const struct file_operations intc_stats_enable_fops = {
+	.open = simple_open,
+	.read = intc_stats_enable_read,
+	.write = intc_stats_enable_write,
+	.llseek = default_llseek,
+};
+
+static int __init ingenic_intc_debugfs_init(void)
+{
+	struct ingenic_intc_data *intc = ingenic_intc;
+	struct dentry *dir;
+
+	if (!intc)
+		return 0;
+
+	intc->stats = kcalloc(intc->num_chips * 32, sizeof(*intc->stats),
+			      GFP_KERNEL);
+	if (!intc->stats)
+		return -ENOMEM;
+
+	dir = debugfs_create_dir("ingenic-intc", NULL);
+	debugfs_create_file("latency", 0444, dir, intc, &intc_stats_fops);
+	debugfs_create_file("latency_enable", 0644, dir, intc,
+			    &intc_stats_enable_fops);
+
+	return 0;
+}
+late_initcall(ingenic_intc_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
+
 static int __init intc_1chip_of_init(struct device_node *node,
 				     struct device_node *parent)
 {
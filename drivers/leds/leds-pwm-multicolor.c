@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * PWM-based multi-color LED control
+ *
+ * Based on leds-pwm.c
+ */
+
+#include <linux/err.h>
+#include <linux/kernel.h>
+#include <linux/led-class-multicolor.h>
+#include <linux/leds.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/of_platform.h>
+#include <linux/platform_device.h>
+#include <linux/property.h>
+#include <linux/pwm.h>
+
+struct pwm_led {
+	struct pwm_device *pwm;
+	struct pwm_state state;
+	bool active_low;
+};
+
+struct pwm_mc_led {
+	struct led_classdev_mc mc_cdev;
+	struct mutex lock;
+	struct pwm_led leds[];
+};
+
+static int led_pwm_mc_set(struct led_classdev *cdev,
+			  enum led_brightness brightness)
+{
+	struct led_classdev_mc *mc_cdev = lcdev_to_mccdev(cdev);
+	struct pwm_mc_led *priv = container_of(mc_cdev, struct pwm_mc_led,
+					       mc_cdev);
+	unsigned long long duty;
+	int i, ret = 0;
+
+	mutex_lock(&priv->lock);
+
+	led_mc_calc_color_components(mc_cdev, brightness);
+
+	/*
+	 * Compute the new state of every channel before applying any, so
+	 * that the channels are updated back to back. PWM drivers which can
+	 * change the duty cycle of a running channel in place take a single
+	 * register write each, and unchanged channels are skipped by the
+	 * PWM core.
+	 */
+	for (i = 0; i < mc_cdev->num_colors; i++) {
+		struct pwm_led *led = &priv->leds[i];
+
+		duty = led->state.period;
+		duty *= mc_cdev->subled_info[i].brightness;
+		do_div(duty, cdev->max_brightness);
+
+		if (led->active_low)
+			duty = led->state.period - duty;
+
+		led->state.duty_cycle = duty;
+		led->state.enabled = duty > 0;
+	}
+
+	for (i = 0; i < mc_cdev->num_colors; i++) {
+		ret = pwm_apply_state(priv->leds[i].pwm, &priv->leds[i].state);
+		if (ret)
+			break;
+	}
+
+	mutex_unlock(&priv->lock);
+
+	return ret;
+}
+
+static int led_pwm_mc_add_channel(struct device *dev, struct pwm_mc_led *priv,
+				  struct mc_subled *subled,
+				  struct fwnode_handle *fwnode)
+{
+	struct pwm_led *led = &priv->leds[priv->mc_cdev.num_colors];
+	u32 color;
+	int ret;
+
+	led->pwm = devm_fwnode_pwm_get(dev, fwnode, NULL);
+	if (IS_ERR(led->pwm))
+		return dev_err_probe(dev, PTR_ERR(led->pwm),
+				     "unable to request PWM\n");
+
+	pwm_init_state(led->pwm, &led->state);
+	led->active_low = fwnode_property_read_bool(fwnode, "active-low");
+
+	ret = fwnode_property_read_u32(fwnode, "color", &color);
+	if (ret) {
+		dev_err(dev, "cannot read color: %d\n", ret);
+		return ret;
+	}
+
+	subled[priv->mc_cdev.num_colors].color_index = color;
+	priv->mc_cdev.num_colors++;
+
+	return 0;
+}
+
+static int led_pwm_mc_probe(struct platform_device *pdev)
+{
+	struct fwnode_handle *mcnode, *fwnode;
+	struct led_init_data init_data = {};
+	struct device *dev = &pdev->dev;
+	struct led_classdev *cdev;
+	struct mc_subled *subled;
+	struct pwm_mc_led *priv;
+	unsigned int count = 0;
+	u32 max_brightness;
+	int ret;
+
+	mcnode = device_get_named_child_node(dev, "multi-led");
+	if (!mcnode) {
+		dev_err(dev, "expected multi-led node\n");
+		return -ENODEV;
+	}
+
+	fwnode_for_each_child_node(mcnode, fwnode)
+		count++;
+
+	if (!count) {
+		ret = -EINVAL;
+		goto out_put_mcnode;
+	}
+
+	priv = devm_kzalloc(dev, struct_size(priv, leds, count), GFP_KERNEL);
+	if (!priv) {
+		ret = -ENOMEM;
+		goto out_put_mcnode;
+	}
+
+	subled = devm_kcalloc(dev, count, sizeof(*subled), GFP_KERNEL);
+	if (!subled) {
+		ret = -ENOMEM;
+		goto out_put_mcnode;
+	}
+
+	mutex_init(&priv->lock);
+
+	ret = fwnode_property_read_u32(mcnode, "max-brightness",
+				       &max_brightness);
+	if (ret)
+		max_brightness = LED_FULL;
+
+	fwnode_for_each_child_node(mcnode, fwnode) {
+		ret = led_pwm_mc_add_channel(dev, priv, subled, fwnode);
+		if (ret) {
+			fwnode_handle_put(fwnode);
+			goto out_put_mcnode;
+		}
+	}
+
+	priv->mc_cdev.subled_info = subled;
+
+	cdev = &priv->mc_cdev.led_cdev;
+	cdev->brightness = LED_OFF;
+	cdev->max_brightness = max_brightness;
+	cdev->flags = LED_CORE_SUSPENDRESUME;
+	cdev->brightness_set_blocking = led_pwm_mc_set;
+
+	init_data.fwnode = mcnode;
+	ret = devm_led_classdev_multicolor_register_ext(dev, &priv->mc_cdev,
+							&init_data);
+	if (ret) {
+		dev_err(dev, "failed to register multicolor PWM led for %s: %d\n",
+			cdev->name, ret);
+		goto out_put_mcnode;
+	}
+
+	ret = led_pwm_mc_set(cdev, cdev->brightness);
+	if (ret) {
+		dev_err(dev, "failed to set led PWM value for %s: %d\n",
+			cdev->name, ret);
+		goto out_put_mcnode;
+	}
+
+	platform_set_drvdata(pdev, priv);
+
+out_put_mcnode:
+	fwnode_handle_put(mcnode);
+	return ret;
+}
+
+static const struct of_device_id of_pwm_leds_mc_match[] = {
+	{ .compatible = "pwm-leds-multicolor", },
+	{},
+};
+MODULE_DEVICE_TABLE(of, of_pwm_leds_mc_match);
+
+static struct platform_driver led_pwm_mc_driver = {
+	.probe		= led_pwm_mc_probe,
+	.driver		= {
+		.name	= "leds_pwm_multicolor",
+		.of_match_table = of_pwm_leds_mc_match,
+	},
+};
+module_platform_driver(led_pwm_mc_driver);
+
+MODULE_DESCRIPTION("multi-color PWM LED driver");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS("platform:leds-pwm-multicolor");
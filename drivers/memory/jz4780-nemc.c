@@ -56,6 +56,8 @@ struct jz4780_nemc {
 	struct clk *clk;
 	uint32_t clk_period;
 	unsigned long banks_present;
+	struct device_node *bank_nodes[JZ4780_NEMC_NUM_BANKS];
+	struct notifier_block clk_nb;
 };
 
 /**
@@ -139,11 +141,8 @@ void jz4780_nemc_assert(struct device *dev, unsigned int bank, bool assert)
 }
 EXPORT_SYMBOL(jz4780_nemc_assert);
 
-static uint32_t jz4780_nemc_clk_period(struct jz4780_nemc *nemc)
+static uint32_t jz4780_nemc_clk_period(unsigned long rate)
 {
-	unsigned long rate;
-
-	rate = clk_get_rate(nemc->clk);
 	if (!rate)
 		return 0;
 
@@ -268,6 +267,55 @@ static bool jz4780_nemc_configure_bank(struct jz4780_nemc *nemc,
 	return true;
 }
 
+/* Reconfigure the timings of all the banks in use for a clock rate. */
+static bool jz4780_nemc_retime(struct jz4780_nemc *nemc, unsigned long rate)
+{
+	unsigned int bank;
+	bool ok = true;
+
+	nemc->clk_period = jz4780_nemc_clk_period(rate);
+	if (!nemc->clk_period)
+		return false;
+
+	for_each_set_bit(bank, &nemc->banks_present, JZ4780_NEMC_NUM_BANKS)
+		ok &= jz4780_nemc_configure_bank(nemc, bank,
+						 nemc->bank_nodes[bank]);
+
+	return ok;
+}
+
+/*
+ * The timings are cycle counts, so they must follow the rate of the clock:
+ * lengthen them before the clock speeds up, and only shorten them once it
+ * has slowed down, so that they never get shorter than the device needs.
+ */
+static int jz4780_nemc_clk_notify(struct notifier_block *nb,
+				  unsigned long event, void *data)
+{
+	struct jz4780_nemc *nemc = container_of(nb, struct jz4780_nemc, clk_nb);
+	struct clk_notifier_data *cnd = data;
+
+	switch (event) {
+	case PRE_RATE_CHANGE:
+		if (cnd->new_rate > cnd->old_rate &&
+		    !jz4780_nemc_retime(nemc, cnd->new_rate)) {
+			jz4780_nemc_retime(nemc, cnd->old_rate);
+			return NOTIFY_BAD;
+		}
+		return NOTIFY_OK;
+	case POST_RATE_CHANGE:
+		if (cnd->new_rate < cnd->old_rate)
+			jz4780_nemc_retime(nemc, cnd->new_rate);
+		return NOTIFY_OK;
+	case ABORT_RATE_CHANGE:
+		if (cnd->new_rate > cnd->old_rate)
+			jz4780_nemc_retime(nemc, cnd->old_rate);
+		return NOTIFY_OK;
+	default:
+		return NOTIFY_DONE;
+	}
+}
+
 static int jz4780_nemc_probe(struct platform_device *pdev)
 {
 	struct device *dev = &pdev->dev;
@@ -325,7 +373,7 @@ static int jz4780_nemc_probe(struct platform_device *pdev)
 		return ret;
 	}
 
-	nemc->clk_period = jz4780_nemc_clk_period(nemc);
+	nemc->clk_period = jz4780_nemc_clk_period(clk_get_rate(nemc->clk));
 	if (!nemc->clk_period) {
 		dev_err(dev, "failed to calculate clock period\n");
 		clk_disable_unprepare(nemc->clk);
@@ -375,11 +423,22 @@ static int jz4780_nemc_probe(struct platform_device *pdev)
 		}
 
 		if (referenced) {
-			if (of_platform_device_create(child, NULL, nemc->dev))
+			if (of_platform_device_create(child, NULL, nemc->dev)) {
 				nemc->banks_present |= referenced;
+				for_each_set_bit(bank, &referenced,
+						 JZ4780_NEMC_NUM_BANKS)
+					nemc->bank_nodes[bank] =
+						of_node_get(child);
+			}
 		}
 	}
 
+	nemc->clk_nb.notifier_call = jz4780_nemc_clk_notify;
+	ret = clk_notifier_register(nemc->clk, &nemc->clk_nb);
+	if (ret)
+		dev_warn(dev, "timings won't follow clock rate changes: %d\n",
+			 ret);
+
 	platform_set_drvdata(pdev, nemc);
 	dev_info(dev, "JZ4780 NEMC initialised\n");
 	return 0;
@@ -388,6 +447,11 @@ static int jz4780_nemc_probe(struct platform_device *pdev)
 static int jz4780_nemc_remove(struct platform_device *pdev)
 {
 	struct jz4780_nemc *nemc = platform_get_drvdata(pdev);
+	unsigned int bank;
+
+	clk_notifier_unregister(nemc->clk, &nemc->clk_nb);
+	for (bank = 0; bank < JZ4780_NEMC_NUM_BANKS; bank++)
+		of_node_put(nemc->bank_nodes[bank]);
 
 	clk_disable_unprepare(nemc->clk);
 	return 0;
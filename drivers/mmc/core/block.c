@@ -27,10 +27,13 @@
 #include <linux/errno.h>
 #include <linux/hdreg.h>
 #include <linux/kdev_t.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
 #include <linux/blkdev.h>
 #include <linux/cdev.h>
 #include <linux/mutex.h>
 #include <linux/scatterlist.h>
+#include <linux/sizes.h>
 #include <linux/string_helpers.h>
 #include <linux/delay.h>
 #include <linux/capability.h>
@@ -83,6 +86,7 @@ static DEFINE_MUTEX(block_mutex);
  * or bootarg options.
  */
 static int perdev_minors = CONFIG_MMC_BLOCK_MINORS;
+static bool perf_probe;
 
 /*
  * We've only got one major, so number of mmcblk devices is
@@ -166,6 +170,10 @@ static DEFINE_MUTEX(open_lock);
 module_param(perdev_minors, int, 0444);
 MODULE_PARM_DESC(perdev_minors, "Minors numbers to allocate per device");
 
+module_param(perf_probe, bool, 0644);
+MODULE_PARM_DESC(perf_probe,
+		 "Measure the preferred write size of SD cards when probing them");
+
 static inline int mmc_blk_part_switch(struct mmc_card *card,
 				      unsigned int part_type);
 static void mmc_blk_rw_rq_prep(struct mmc_queue_req *mqrq,
@@ -1159,7 +1167,7 @@ static void mmc_blk_issue_flush(struct mmc_queue *mq, struct request *req)
 	struct mmc_card *card = md->queue.card;
 	int ret = 0;
 
-	ret = mmc_flush_cache(card);
+	ret = mmc_flush_cache(card->host);
 	blk_mq_end_request(req, ret ? BLK_STS_IOERR : BLK_STS_OK);
 }
 
@@ -1995,6 +2003,8 @@ static void mmc_blk_mq_post_req(struct mmc_queue *mq, struct request *req)
 
 	mmc_post_req(host, mrq, 0);
 
+	mmc_queue_put_budget(mq, req);
+
 	/*
 	 * Block layer timeouts race with completions which means the normal
 	 * completion path cannot be used during recovery.
@@ -2279,6 +2289,8 @@ static struct mmc_blk_data *mmc_blk_alloc_req(struct mmc_card *card,
 	struct mmc_blk_data *md;
 	int devidx, ret;
 	char cap_str[10];
+	bool cache_enabled = false;
+	bool fua_enabled = false;
 
 	devidx = ida_simple_get(&mmc_blk_ida, 0, max_devices, GFP_KERNEL);
 	if (devidx < 0) {
@@ -2375,13 +2387,16 @@ static struct mmc_blk_data *mmc_blk_alloc_req(struct mmc_card *card,
 			md->flags |= MMC_BLK_CMD23;
 	}
 
+	cache_enabled = mmc_cache_enabled(card->host);
 	if (mmc_card_mmc(card) &&
 	    md->flags & MMC_BLK_CMD23 &&
 	    ((card->ext_csd.rel_param & EXT_CSD_WR_REL_PARAM_EN) ||
 	     card->ext_csd.rel_sectors)) {
 		md->flags |= MMC_BLK_REL_WR;
-		blk_queue_write_cache(md->queue.queue, true, true);
+		fua_enabled = true;
+		cache_enabled = true;
 	}
+	blk_queue_write_cache(md->queue.queue, cache_enabled, fua_enabled);
 
 	string_get_size((u64)size, 512, STRING_UNITS_2,
 			cap_str, sizeof(cap_str));
@@ -2890,6 +2905,136 @@ static void mmc_blk_remove_debugfs(struct mmc_card *card,
 
 #endif /* CONFIG_DEBUG_FS */
 
+/* Area of the card rewritten by the write size probe, and largest size tried */
+#define MMC_BLK_PROBE_AREA	(SZ_512K >> 9)
+#define MMC_BLK_PROBE_MAX	(SZ_128K >> 9)
+
+static int mmc_blk_probe_transfer(struct mmc_card *card,
+				  struct scatterlist *sg, unsigned int addr,
+				  unsigned int blocks, bool write)
+{
+	struct mmc_request mrq = {};
+	struct mmc_command cmd = {};
+	struct mmc_command stop = {};
+	struct mmc_data data = {};
+
+	mrq.cmd = &cmd;
+	mrq.data = &data;
+	mrq.stop = &stop;
+
+	cmd.opcode = write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK;
+	cmd.arg = mmc_card_blockaddr(card) ? addr : addr << 9;
+	cmd.flags = MMC_RSP_R1 | MMC_CMD_ADTC;
+
+	stop.opcode = MMC_STOP_TRANSMISSION;
+	stop.flags = MMC_RSP_R1B | MMC_CMD_AC;
+
+	data.blksz = 512;
+	data.blocks = blocks;
+	data.flags = write ? MMC_DATA_WRITE : MMC_DATA_READ;
+	data.sg = sg;
+	data.sg_len = 1;
+	mmc_set_data_timeout(&data, card);
+
+	mmc_wait_for_req(card->host, &mrq);
+
+	if (cmd.error)
+		return cmd.error;
+	if (data.error)
+		return data.error;
+	if (stop.error)
+		return stop.error;
+
+	return card_busy_detect(card, MMC_BLK_TIMEOUT_MS, NULL);
+}
+
+/*
+ * Cheap SD cards only write fast in units of their internal flash pages,
+ * which they don't report. Time the rewrite of an area at the end of the
+ * card with increasingly large writes, and keep the smallest size that
+ * comes within 10% of the best throughput. The data is read back and
+ * written unchanged, but isn't safe against a power loss during the probe,
+ * hence the module parameter.
+ */
+static void mmc_blk_probe_write_size(struct mmc_card *card)
+{
+	struct mmc_host *host = card->host;
+	unsigned int max_blocks, blocks, best_blocks = 0, size, align, off, addr;
+	unsigned int i;
+	s64 elapsed[8] = {}, best = S64_MAX;
+	struct scatterlist sg;
+	struct page *page;
+	ktime_t start;
+	int err = 0;
+
+	/* The address argument of the commands is 32-bit anyway */
+	size = min_t(sector_t, (sector_t)card->csd.capacity <<
+		     (card->csd.read_blkbits - 9), UINT_MAX);
+	if (size < 4 * MMC_BLK_PROBE_AREA)
+		return;
+
+	max_blocks = min3(host->max_req_size >> 9, host->max_seg_size >> 9,
+			  host->max_blk_count);
+	max_blocks = min_t(unsigned int, max_blocks, MMC_BLK_PROBE_MAX);
+	if (max_blocks < 8)
+		return;
+	max_blocks = rounddown_pow_of_two(max_blocks);
+
+	page = alloc_pages(GFP_KERNEL | __GFP_NOWARN, get_order(max_blocks << 9));
+	if (!page)
+		return;
+
+	/*
+	 * The end of the card is the least likely to be in use by the
+	 * filesystem. Stay within a single allocation unit.
+	 */
+	align = card->pref_erase;
+	if (align < MMC_BLK_PROBE_AREA || align > size / 4)
+		align = MMC_BLK_PROBE_AREA;
+	addr = rounddown(size - MMC_BLK_PROBE_AREA, align);
+
+	mmc_get_card(card, NULL);
+
+	for (blocks = 8, i = 0; blocks <= max_blocks && !err;
+	     blocks <<= 1, i++) {
+		sg_init_one(&sg, page_address(page), blocks << 9);
+
+		for (off = 0; off < MMC_BLK_PROBE_AREA && !err; off += blocks) {
+			err = mmc_blk_probe_transfer(card, &sg, addr + off,
+						     blocks, false);
+			if (err)
+				break;
+
+			start = ktime_get();
+			err = mmc_blk_probe_transfer(card, &sg, addr + off,
+						     blocks, true);
+			elapsed[i] += ktime_us_delta(ktime_get(), start);
+		}
+
+		best = min(best, elapsed[i]);
+	}
+
+	mmc_put_card(card, NULL);
+	__free_pages(page, get_order(max_blocks << 9));
+
+	if (err) {
+		pr_warn("%s: write size probe failed: %d\n",
+			mmc_hostname(host), err);
+		return;
+	}
+
+	for (blocks = 8, i = 0; blocks <= max_blocks; blocks <<= 1, i++) {
+		if (elapsed[i] * 10 <= best * 11) {
+			best_blocks = blocks;
+			break;
+		}
+	}
+
+	card->pref_write = best_blocks;
+	pr_info("%s: preferred write size %u KiB\n",
+		mmc_hostname(host), best_blocks / 2);
+}
+
 static int mmc_blk_probe(struct mmc_card *card)
 {
 	struct mmc_blk_data *md, *part_md;
@@ -2903,6 +3048,10 @@ static int mmc_blk_probe(struct mmc_card *card)
 
 	mmc_fixup_device(card, mmc_blk_fixups);
 
+	if (perf_probe && mmc_card_sd(card) && !mmc_blk_readonly(card) &&
+	    !card->pref_write)
+		mmc_blk_probe_write_size(card);
+
 	card->complete_wq = alloc_workqueue("mmc_complete",
 					WQ_MEM_RECLAIM | WQ_HIGHPRI, 0);
 	if (!card->complete_wq) {
@@ -186,9 +186,13 @@ static void mmc_queue_setup_discard(struct request_queue *q,
 	blk_queue_flag_set(QUEUE_FLAG_DISCARD, q);
 	blk_queue_max_discard_sectors(q, max_discard);
 	q->limits.discard_granularity = card->pref_erase << 9;
-	/* granularity must not be greater than max. discard */
+	/*
+	 * granularity must not be greater than max. discard, fall back to the
+	 * unit the card writes in, if it was measured
+	 */
 	if (card->pref_erase > max_discard)
-		q->limits.discard_granularity = SECTOR_SIZE;
+		q->limits.discard_granularity =
+			max_t(unsigned int, card->pref_write << 9, SECTOR_SIZE);
 	if (mmc_can_secure_erase_trim(card))
 		blk_queue_flag_set(QUEUE_FLAG_SECERASE, q);
 }
@@ -216,6 +220,8 @@ static int __mmc_init_request(struct mmc_queue *mq, struct request *req,
 	if (!mq_rq->sg)
 		return -ENOMEM;
 
+	mq_rq->budget_token = -1;
+
 	return 0;
 }
 
@@ -241,6 +247,84 @@ static void mmc_mq_exit_request(struct blk_mq_tag_set *set, struct request *req,
 	mmc_exit_request(mq->queue, req);
 }
 
+/*
+ * Without a command queue, the host runs one request while the next one is
+ * being prepared. Requests dispatched beyond that would only wait in
+ * mmc_mq_queue_rq(), where nothing can be merged into them anymore, so they
+ * are kept in the block layer until the host can take them. Readahead then
+ * reaches the host as a few large requests, rather than many small ones.
+ */
+static int mmc_mq_get_budget(struct request_queue *q)
+{
+	struct mmc_queue *mq = q->queuedata;
+	unsigned long flags;
+	int ret = 0;
+
+	if (!mq->max_budget)
+		return 0;
+
+	spin_lock_irqsave(&mq->lock, flags);
+	if (mq->budget < mq->max_budget) {
+		mq->budget++;
+	} else {
+		mq->budget_starved = true;
+		ret = -1;
+	}
+	spin_unlock_irqrestore(&mq->lock, flags);
+
+	return ret;
+}
+
+static void __mmc_queue_put_budget(struct mmc_queue *mq)
+{
+	unsigned long flags;
+	bool run_queue;
+
+	spin_lock_irqsave(&mq->lock, flags);
+	mq->budget--;
+	run_queue = mq->budget_starved;
+	mq->budget_starved = false;
+	spin_unlock_irqrestore(&mq->lock, flags);
+
+	/* blk-mq doesn't restart a queue that ran out of budget by itself */
+	if (run_queue)
+		blk_mq_run_hw_queues(mq->queue, true);
+}
+
+static void mmc_mq_put_budget(struct request_queue *q, int budget_token)
+{
+	struct mmc_queue *mq = q->queuedata;
+
+	if (mq->max_budget && budget_token >= 0)
+		__mmc_queue_put_budget(mq);
+}
+
+/*
+ * Release the budget of a request that has left the host. This must be done
+ * before the request is completed or handed back to the block layer, as it
+ * may be freed and dispatched again right after that.
+ */
+void mmc_queue_put_budget(struct mmc_queue *mq, struct request *req)
+{
+	struct mmc_queue_req *mqrq = req_to_mmc_queue_req(req);
+
+	if (!mq->max_budget || mqrq->budget_token < 0)
+		return;
+
+	mqrq->budget_token = -1;
+	__mmc_queue_put_budget(mq);
+}
+
+static void mmc_mq_set_rq_budget_token(struct request *req, int token)
+{
+	req_to_mmc_queue_req(req)->budget_token = token;
+}
+
+static int mmc_mq_get_rq_budget_token(struct request *req)
+{
+	return req_to_mmc_queue_req(req)->budget_token;
+}
+
 static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 				    const struct blk_mq_queue_data *bd)
 {
@@ -252,10 +336,12 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 	enum mmc_issue_type issue_type;
 	enum mmc_issued issued;
 	bool get_card, cqe_retune_ok;
+	int budget_token;
 	int ret;
 
 	if (mmc_card_removed(mq->card)) {
 		req->rq_flags |= RQF_QUIET;
+		mmc_queue_put_budget(mq, req);
 		return BLK_STS_IOERR;
 	}
 
@@ -265,6 +351,7 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 
 	if (mq->recovery_needed || mq->busy) {
 		spin_unlock_irq(&mq->lock);
+		mmc_queue_put_budget(mq, req);
 		return BLK_STS_RESOURCE;
 	}
 
@@ -273,6 +360,7 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 		if (mmc_cqe_dcmd_busy(mq)) {
 			mq->cqe_busy |= MMC_CQE_DCMD_BUSY;
 			spin_unlock_irq(&mq->lock);
+			mmc_queue_put_budget(mq, req);
 			return BLK_STS_RESOURCE;
 		}
 		break;
@@ -283,6 +371,7 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 		 */
 		if (host->hsq_enabled && mq->in_flight[issue_type] > 2) {
 			spin_unlock_irq(&mq->lock);
+			mmc_queue_put_budget(mq, req);
 			return BLK_STS_RESOURCE;
 		}
 		break;
@@ -322,6 +411,12 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 
 	blk_mq_start_request(req);
 
+	/*
+	 * Synchronous requests are completed, and possibly freed, before
+	 * mmc_blk_mq_issue_rq() returns, so remember their budget here.
+	 */
+	budget_token = req_to_mmc_queue_req(req)->budget_token;
+
 	issued = mmc_blk_mq_issue_rq(mq, req);
 
 	switch (issued) {
@@ -347,6 +442,10 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 		spin_unlock_irq(&mq->lock);
 		if (put_card)
 			mmc_put_card(card, &mq->ctx);
+		if (issued == MMC_REQ_FINISHED)
+			mmc_mq_put_budget(q, budget_token);
+		else
+			mmc_queue_put_budget(mq, req);
 	} else {
 		WRITE_ONCE(mq->busy, false);
 	}
@@ -356,6 +455,10 @@ static blk_status_t mmc_mq_queue_rq(struct blk_mq_hw_ctx *hctx,
 
 static const struct blk_mq_ops mmc_mq_ops = {
 	.queue_rq	= mmc_mq_queue_rq,
+	.get_budget	= mmc_mq_get_budget,
+	.put_budget	= mmc_mq_put_budget,
+	.set_rq_budget_token = mmc_mq_set_rq_budget_token,
+	.get_rq_budget_token = mmc_mq_get_rq_budget_token,
 	.init_request	= mmc_mq_init_request,
 	.exit_request	= mmc_mq_exit_request,
 	.complete	= mmc_blk_mq_complete,
@@ -388,6 +491,8 @@ static void mmc_setup_queue(struct mmc_queue *mq, struct mmc_card *card)
 	}
 
 	blk_queue_logical_block_size(mq->queue, block_size);
+	if (card->pref_write)
+		blk_queue_io_min(mq->queue, card->pref_write << 9);
 	/*
 	 * After blk_queue_can_use_dma_map_merging() was called with succeed,
 	 * since it calls blk_queue_virt_boundary(), the mmc should not call
@@ -444,6 +549,16 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card)
 			min_t(int, card->ext_csd.cmdq_depth, host->cqe_qdepth);
 	else
 		mq->tag_set.queue_depth = MMC_QUEUE_DEPTH;
+
+	/*
+	 * Other hosts run one request at a time, and prepare the next one
+	 * meanwhile if they implement pre_req. Only dispatch that many.
+	 */
+	if (!host->cqe_enabled && !host->hsq_enabled)
+		mq->max_budget = host->ops->pre_req ? 2 : 1;
+	else
+		mq->max_budget = 0;
+	mq->budget = 0;
 	mq->tag_set.numa_node = NUMA_NO_NODE;
 	mq->tag_set.flags = BLK_MQ_F_SHOULD_MERGE | BLK_MQ_F_BLOCKING;
 	mq->tag_set.nr_hw_queues = 1;
@@ -21,6 +21,7 @@
 #include <linux/of_device.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/platform_device.h>
+#include <linux/regulator/consumer.h>
 #include <linux/rwsem.h>
 #include <linux/scatterlist.h>
 
@@ -120,6 +121,7 @@ enum jz4740_mmc_version {
 };
 
 enum jz4740_mmc_state {
+	JZ4740_MMC_STATE_SEND_SBC,
 	JZ4740_MMC_STATE_READ_RESPONSE,
 	JZ4740_MMC_STATE_TRANSFER_DATA,
 	JZ4740_MMC_STATE_SEND_STOP,
@@ -145,6 +147,18 @@ enum jz4780_cookie {
 	COOKIE_MAPPED,
 };
 
+/*
+ * A DMA descriptor prepared in pre_req, before its mmc_request is started.
+ * The MMC core can prepare the next request while the current one is still
+ * waiting for its command response, so up to two of them can be pending.
+ */
+struct jz4740_mmc_dma_prep {
+	struct mmc_data *data;
+	struct dma_async_tx_descriptor *desc;
+};
+
+#define JZ4740_MMC_NUM_DMA_PREP 2
+
 struct jz4740_mmc_host {
 	struct mmc_host *mmc;
 	struct platform_device *pdev;
@@ -166,6 +180,10 @@ struct jz4740_mmc_host {
 
 	uint32_t cmdat;
 
+	/* Sampling point delayed by a quarter or half of a period (X1000) */
+	bool smp_delay;
+	bool vqmmc_enabled;
+
 	uint32_t irq_mask;
 
 	spinlock_t lock;
@@ -179,6 +197,8 @@ struct jz4740_mmc_host {
 	struct dma_chan *dma_tx;
 	bool use_dma;
 
+	struct jz4740_mmc_dma_prep dma_prep[JZ4740_MMC_NUM_DMA_PREP];
+
 /* The DMA trigger level is 8 words, that is to say, the DMA read
  * trigger is when data words in MSC_RXFIFO is >= 8 and the DMA write
  * trigger is when data words in MSC_TXFIFO is < 8.
@@ -226,19 +246,39 @@ static void jz4740_mmc_release_dma_channels(struct jz4740_mmc_host *host)
 
 static int jz4740_mmc_acquire_dma_channels(struct jz4740_mmc_host *host)
 {
+	struct dma_slave_config conf = {
+		.src_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES,
+		.dst_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES,
+		.src_maxburst = JZ4740_MMC_FIFO_HALF_SIZE,
+		.dst_maxburst = JZ4740_MMC_FIFO_HALF_SIZE,
+	};
+
 	host->dma_tx = dma_request_chan(mmc_dev(host->mmc), "tx");
-	if (IS_ERR(host->dma_tx)) {
-		dev_err(mmc_dev(host->mmc), "Failed to get dma_tx channel\n");
-		return PTR_ERR(host->dma_tx);
-	}
+	if (IS_ERR(host->dma_tx))
+		return dev_err_probe(mmc_dev(host->mmc), PTR_ERR(host->dma_tx),
+				     "Failed to get dma_tx channel\n");
 
 	host->dma_rx = dma_request_chan(mmc_dev(host->mmc), "rx");
 	if (IS_ERR(host->dma_rx)) {
-		dev_err(mmc_dev(host->mmc), "Failed to get dma_rx channel\n");
 		dma_release_channel(host->dma_tx);
-		return PTR_ERR(host->dma_rx);
+		return dev_err_probe(mmc_dev(host->mmc), PTR_ERR(host->dma_rx),
+				     "Failed to get dma_rx channel\n");
 	}
 
+	/*
+	 * The FIFO addresses never change, so configure the channels once
+	 * here. This allows descriptors to be prepared in pre_req while the
+	 * channel is busy with the previous request.
+	 */
+	conf.direction = DMA_MEM_TO_DEV;
+	conf.dst_addr = host->mem_res->start + JZ_REG_MMC_TXFIFO;
+	dmaengine_slave_config(host->dma_tx, &conf);
+
+	conf.direction = DMA_DEV_TO_MEM;
+	conf.dst_addr = 0;
+	conf.src_addr = host->mem_res->start + JZ_REG_MMC_RXFIFO;
+	dmaengine_slave_config(host->dma_rx, &conf);
+
 	return 0;
 }
 
@@ -289,40 +329,86 @@ static int jz4740_mmc_prepare_dma_data(struct jz4740_mmc_host *host,
 	return data->sg_count;
 }
 
-static int jz4740_mmc_start_dma_transfer(struct jz4740_mmc_host *host,
-					 struct mmc_data *data)
+static struct dma_async_tx_descriptor *
+jz4740_mmc_prep_dma_desc(struct jz4740_mmc_host *host, struct mmc_data *data)
 {
 	struct dma_chan *chan = jz4740_mmc_get_dma_chan(host, data);
+	enum dma_transfer_direction dir;
 	struct dma_async_tx_descriptor *desc;
-	struct dma_slave_config conf = {
-		.src_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES,
-		.dst_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES,
-		.src_maxburst = JZ4740_MMC_FIFO_HALF_SIZE,
-		.dst_maxburst = JZ4740_MMC_FIFO_HALF_SIZE,
-	};
-	int sg_count;
 
-	if (data->flags & MMC_DATA_WRITE) {
-		conf.direction = DMA_MEM_TO_DEV;
-		conf.dst_addr = host->mem_res->start + JZ_REG_MMC_TXFIFO;
-	} else {
-		conf.direction = DMA_DEV_TO_MEM;
-		conf.src_addr = host->mem_res->start + JZ_REG_MMC_RXFIFO;
+	if (data->flags & MMC_DATA_WRITE)
+		dir = DMA_MEM_TO_DEV;
+	else
+		dir = DMA_DEV_TO_MEM;
+
+	/*
+	 * The whole scatterlist is turned into a single chain of hardware
+	 * descriptors, so the request completes without CPU intervention.
+	 */
+	desc = dmaengine_prep_slave_sg(chan, data->sg, data->sg_count, dir,
+				       DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+	if (!desc)
+		dev_err(mmc_dev(host->mmc),
+			"Failed to allocate DMA %s descriptor",
+			 dir == DMA_MEM_TO_DEV ? "TX" : "RX");
+
+	return desc;
+}
+
+static struct dma_async_tx_descriptor *
+jz4740_mmc_take_dma_desc(struct jz4740_mmc_host *host, struct mmc_data *data)
+{
+	struct dma_async_tx_descriptor *desc;
+	unsigned int i;
+
+	for (i = 0; i < JZ4740_MMC_NUM_DMA_PREP; i++) {
+		if (host->dma_prep[i].data == data) {
+			desc = host->dma_prep[i].desc;
+			host->dma_prep[i].data = NULL;
+			host->dma_prep[i].desc = NULL;
+			return desc;
+		}
+	}
+
+	return NULL;
+}
+
+static void jz4740_mmc_drop_dma_descs(struct jz4740_mmc_host *host,
+				      struct dma_chan *chan)
+{
+	unsigned int i;
+
+	/*
+	 * Terminating the channel frees the descriptors that were prepared
+	 * but not submitted, so forget about those that belong to it.
+	 */
+	dmaengine_terminate_all(chan);
+
+	for (i = 0; i < JZ4740_MMC_NUM_DMA_PREP; i++) {
+		if (host->dma_prep[i].data &&
+		    jz4740_mmc_get_dma_chan(host, host->dma_prep[i].data) == chan) {
+			host->dma_prep[i].data = NULL;
+			host->dma_prep[i].desc = NULL;
+		}
 	}
+}
 
-	sg_count = jz4740_mmc_prepare_dma_data(host, data, COOKIE_MAPPED);
-	if (sg_count < 0)
-		return sg_count;
+static int jz4740_mmc_start_dma_transfer(struct jz4740_mmc_host *host,
+					 struct mmc_data *data)
+{
+	struct dma_chan *chan = jz4740_mmc_get_dma_chan(host, data);
+	struct dma_async_tx_descriptor *desc;
+	int sg_count;
 
-	dmaengine_slave_config(chan, &conf);
-	desc = dmaengine_prep_slave_sg(chan, data->sg, sg_count,
-			conf.direction,
-			DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+	desc = jz4740_mmc_take_dma_desc(host, data);
 	if (!desc) {
-		dev_err(mmc_dev(host->mmc),
-			"Failed to allocate DMA %s descriptor",
-			 conf.direction == DMA_MEM_TO_DEV ? "TX" : "RX");
-		goto dma_unmap;
+		sg_count = jz4740_mmc_prepare_dma_data(host, data, COOKIE_MAPPED);
+		if (sg_count < 0)
+			return sg_count;
+
+		desc = jz4740_mmc_prep_dma_desc(host, data);
+		if (!desc)
+			goto dma_unmap;
 	}
 
 	dmaengine_submit(desc);
@@ -341,6 +427,7 @@ static void jz4740_mmc_pre_request(struct mmc_host *mmc,
 {
 	struct jz4740_mmc_host *host = mmc_priv(mmc);
 	struct mmc_data *data = mrq->data;
+	unsigned int i;
 
 	down_read(&host->clk_rwsem);
 
@@ -348,8 +435,24 @@ static void jz4740_mmc_pre_request(struct mmc_host *mmc,
 		return;
 
 	data->host_cookie = COOKIE_UNMAPPED;
-	if (jz4740_mmc_prepare_dma_data(host, data, COOKIE_PREMAPPED) < 0)
+	if (jz4740_mmc_prepare_dma_data(host, data, COOKIE_PREMAPPED) < 0) {
 		data->host_cookie = COOKIE_UNMAPPED;
+		return;
+	}
+
+	/*
+	 * Also build the descriptor chain now, while the previous request is
+	 * in flight, so that the data phase can start as soon as the command
+	 * response arrives.
+	 */
+	for (i = 0; i < JZ4740_MMC_NUM_DMA_PREP; i++) {
+		if (!host->dma_prep[i].data) {
+			host->dma_prep[i].desc = jz4740_mmc_prep_dma_desc(host, data);
+			if (host->dma_prep[i].desc)
+				host->dma_prep[i].data = data;
+			break;
+		}
+	}
 }
 
 static void jz4740_mmc_post_request(struct mmc_host *mmc,
@@ -367,7 +470,7 @@ static void jz4740_mmc_post_request(struct mmc_host *mmc,
 	if (err) {
 		struct dma_chan *chan = jz4740_mmc_get_dma_chan(host, data);
 
-		dmaengine_terminate_all(chan);
+		jz4740_mmc_drop_dma_descs(host, chan);
 	}
 }
 
@@ -426,16 +529,41 @@ static void jz4740_mmc_request_done(struct jz4740_mmc_host *host)
 {
 	struct mmc_request *req;
 	struct mmc_data *data;
+	unsigned int i;
 
 	req = host->req;
 	data = req->data;
 	host->req = NULL;
 
+	/*
+	 * If the request failed before its data phase, the descriptor that
+	 * was prepared for it was never submitted. Nothing is running on the
+	 * DMA channels at this point, so it is safe to terminate them.
+	 */
+	if (data && host->use_dma) {
+		for (i = 0; i < JZ4740_MMC_NUM_DMA_PREP; i++) {
+			if (host->dma_prep[i].data == data) {
+				jz4740_mmc_drop_dma_descs(host,
+					jz4740_mmc_get_dma_chan(host, data));
+				break;
+			}
+		}
+	}
+
 	if (data && data->host_cookie == COOKIE_MAPPED)
 		jz4740_mmc_dma_unmap(host, data);
 	mmc_request_done(host->mmc, req);
 }
 
+static void jz4740_mmc_wait_irq(struct jz4740_mmc_host *host,
+	unsigned int irq)
+{
+	set_bit(0, &host->waiting);
+	mod_timer(&host->timeout_timer,
+		  jiffies + msecs_to_jiffies(JZ_MMC_REQ_TIMEOUT_MS));
+	jz4740_mmc_set_irq_enabled(host, irq, true);
+}
+
 static unsigned int jz4740_mmc_poll_irq(struct jz4740_mmc_host *host,
 	unsigned int irq)
 {
@@ -447,10 +575,7 @@ static unsigned int jz4740_mmc_poll_irq(struct jz4740_mmc_host *host,
 	} while (!(status & irq) && --timeout);
 
 	if (timeout == 0) {
-		set_bit(0, &host->waiting);
-		mod_timer(&host->timeout_timer,
-			  jiffies + msecs_to_jiffies(JZ_MMC_REQ_TIMEOUT_MS));
-		jz4740_mmc_set_irq_enabled(host, irq, true);
+		jz4740_mmc_wait_irq(host, irq);
 		return true;
 	}
 
@@ -621,7 +746,10 @@ static void jz4740_mmc_timeout(struct timer_list *t)
 
 	jz4740_mmc_set_irq_enabled(host, JZ_MMC_IRQ_END_CMD_RES, false);
 
-	host->req->cmd->error = -ETIMEDOUT;
+	if (host->state == JZ4740_MMC_STATE_SEND_SBC)
+		host->req->sbc->error = -ETIMEDOUT;
+	else
+		host->req->cmd->error = -ETIMEDOUT;
 	jz4740_mmc_request_done(host);
 }
 
@@ -734,10 +862,26 @@ static irqreturn_t jz_mmc_irq_worker(int irq, void *devid)
 	struct mmc_data *data = cmd->data;
 	bool timeout = false;
 
+	if (host->state == JZ4740_MMC_STATE_SEND_SBC) {
+		if (!req->sbc->error) {
+			jz4740_mmc_read_response(host, req->sbc);
+
+			/* The block count is set, send the actual command */
+			host->state = JZ4740_MMC_STATE_READ_RESPONSE;
+			jz4740_mmc_wait_irq(host, JZ_MMC_IRQ_END_CMD_RES);
+			jz4740_mmc_send_command(host, cmd);
+			return IRQ_HANDLED;
+		}
+
+		host->state = JZ4740_MMC_STATE_DONE;
+	}
+
 	if (cmd->error)
 		host->state = JZ4740_MMC_STATE_DONE;
 
 	switch (host->state) {
+	case JZ4740_MMC_STATE_SEND_SBC:
+		break;
 	case JZ4740_MMC_STATE_READ_RESPONSE:
 		if (cmd->flags & MMC_RSP_PRESENT)
 			jz4740_mmc_read_response(host, cmd);
@@ -756,8 +900,22 @@ static irqreturn_t jz_mmc_irq_worker(int irq, void *devid)
 			 * jz4740_mmc_prepare_dma_data() and
 			 * jz4740_mmc_start_dma_transfer().
 			 */
-			timeout = jz4740_mmc_start_dma_transfer(host, data);
+			if (jz4740_mmc_start_dma_transfer(host, data)) {
+				data->error = -ENOMEM;
+				host->state = JZ4740_MMC_STATE_DONE;
+				break;
+			}
 			data->bytes_xfered = data->blocks * data->blksz;
+
+			/*
+			 * Don't spin on the IRQ register while the DMA
+			 * controller moves the data; sleep until the
+			 * controller signals the end of the transfer.
+			 */
+			jz4740_mmc_wait_irq(host, JZ_MMC_IRQ_DATA_TRAN_DONE);
+			host->state = JZ4740_MMC_STATE_SEND_STOP;
+			timeout = true;
+			break;
 		} else if (data->flags & MMC_DATA_READ)
 			/* Use PIO if DMA is not enabled.
 			 * Data transfer direction was defined before
@@ -784,9 +942,20 @@ static irqreturn_t jz_mmc_irq_worker(int irq, void *devid)
 		fallthrough;
 
 	case JZ4740_MMC_STATE_SEND_STOP:
+		if (data && host->use_dma)
+			jz4740_mmc_transfer_check_state(host, data);
+
 		if (!req->stop)
 			break;
 
+		/*
+		 * With a pre-defined transfer (CMD23), the card stops by
+		 * itself after the last block; CMD12 is only needed to
+		 * recover from an error.
+		 */
+		if (req->sbc && !(data && data->error))
+			break;
+
 		jz4740_mmc_send_command(host, req->stop);
 
 		if (mmc_resp_type(req->stop) & MMC_RSP_BUSY) {
@@ -856,6 +1025,27 @@ static irqreturn_t jz_mmc_irq(int irq, void *devid)
 	return IRQ_HANDLED;
 }
 
+static void jz4740_mmc_set_lpm(struct jz4740_mmc_host *host, int real_rate)
+{
+	uint32_t lpm;
+
+	if (real_rate > 25000000) {
+		if (host->version >= JZ_MMC_X1000) {
+			lpm = JZ_MMC_LPM_DRV_RISING_QTR_PHASE_DLY |
+			      JZ_MMC_LPM_LOW_POWER_MODE_EN;
+			if (host->smp_delay)
+				lpm |= JZ_MMC_LPM_SMP_RISING_QTR_OR_HALF_PHASE_DLY;
+			writel(lpm, host->base + JZ_REG_MMC_LPM);
+		} else if (host->version >= JZ_MMC_JZ4760) {
+			writel(JZ_MMC_LPM_DRV_RISING |
+				   JZ_MMC_LPM_LOW_POWER_MODE_EN,
+				   host->base + JZ_REG_MMC_LPM);
+		} else if (host->version >= JZ_MMC_JZ4725B)
+			writel(JZ_MMC_LPM_LOW_POWER_MODE_EN,
+				   host->base + JZ_REG_MMC_LPM);
+	}
+}
+
 static int jz4740_mmc_set_clock_rate(struct jz4740_mmc_host *host, int rate)
 {
 	int div = 0;
@@ -873,20 +1063,8 @@ static int jz4740_mmc_set_clock_rate(struct jz4740_mmc_host *host, int rate)
 
 	writew(div, host->base + JZ_REG_MMC_CLKRT);
 
-	if (real_rate > 25000000) {
-		if (host->version >= JZ_MMC_X1000) {
-			writel(JZ_MMC_LPM_DRV_RISING_QTR_PHASE_DLY |
-				   JZ_MMC_LPM_SMP_RISING_QTR_OR_HALF_PHASE_DLY |
-				   JZ_MMC_LPM_LOW_POWER_MODE_EN,
-				   host->base + JZ_REG_MMC_LPM);
-		} else if (host->version >= JZ_MMC_JZ4760) {
-			writel(JZ_MMC_LPM_DRV_RISING |
-				   JZ_MMC_LPM_LOW_POWER_MODE_EN,
-				   host->base + JZ_REG_MMC_LPM);
-		} else if (host->version >= JZ_MMC_JZ4725B)
-			writel(JZ_MMC_LPM_LOW_POWER_MODE_EN,
-				   host->base + JZ_REG_MMC_LPM);
-	}
+	jz4740_mmc_set_lpm(host, real_rate);
+	host->mmc->actual_clock = real_rate;
 
 	return real_rate;
 }
@@ -900,11 +1078,15 @@ static void jz4740_mmc_request(struct mmc_host *mmc, struct mmc_request *req)
 	jz4740_mmc_write_irq_reg(host, ~0);
 	jz4740_mmc_set_irq_enabled(host, JZ_MMC_IRQ_END_CMD_RES, true);
 
-	host->state = JZ4740_MMC_STATE_READ_RESPONSE;
+	if (req->sbc)
+		host->state = JZ4740_MMC_STATE_SEND_SBC;
+	else
+		host->state = JZ4740_MMC_STATE_READ_RESPONSE;
+
 	set_bit(0, &host->waiting);
 	mod_timer(&host->timeout_timer,
 		  jiffies + msecs_to_jiffies(JZ_MMC_REQ_TIMEOUT_MS));
-	jz4740_mmc_send_command(host, req->cmd);
+	jz4740_mmc_send_command(host, req->sbc ?: req->cmd);
 }
 
 static void jz4740_mmc_set_ios(struct mmc_host *mmc, struct mmc_ios *ios)
@@ -918,6 +1100,12 @@ static void jz4740_mmc_set_ios(struct mmc_host *mmc, struct mmc_ios *ios)
 		jz4740_mmc_reset(host);
 		if (!IS_ERR(mmc->supply.vmmc))
 			mmc_regulator_set_ocr(mmc, mmc->supply.vmmc, ios->vdd);
+		if (!IS_ERR(mmc->supply.vqmmc) && !host->vqmmc_enabled) {
+			if (regulator_enable(mmc->supply.vqmmc))
+				dev_err(mmc_dev(mmc), "Failed to enable vqmmc\n");
+			else
+				host->vqmmc_enabled = true;
+		}
 		host->cmdat |= JZ_MMC_CMDAT_INIT;
 		clk_prepare_enable(host->clk);
 		break;
@@ -926,6 +1114,10 @@ static void jz4740_mmc_set_ios(struct mmc_host *mmc, struct mmc_ios *ios)
 	default:
 		if (!IS_ERR(mmc->supply.vmmc))
 			mmc_regulator_set_ocr(mmc, mmc->supply.vmmc, 0);
+		if (host->vqmmc_enabled) {
+			regulator_disable(mmc->supply.vqmmc);
+			host->vqmmc_enabled = false;
+		}
 		clk_disable_unprepare(host->clk);
 		break;
 	}
@@ -953,6 +1145,50 @@ static void jz4740_mmc_enable_sdio_irq(struct mmc_host *mmc, int enable)
 	jz4740_mmc_set_irq_enabled(host, JZ_MMC_IRQ_SDIO, enable);
 }
 
+static int jz4740_mmc_start_signal_voltage_switch(struct mmc_host *mmc,
+						  struct mmc_ios *ios)
+{
+	int ret;
+
+	/* The bus pins follow vqmmc, there is nothing to program here */
+	ret = mmc_regulator_set_vqmmc(mmc, ios);
+
+	return ret < 0 ? ret : 0;
+}
+
+static int jz4740_mmc_try_tuning(struct jz4740_mmc_host *host, u32 opcode,
+				 bool smp_delay)
+{
+	host->smp_delay = smp_delay;
+
+	jz4740_mmc_clock_disable(host);
+	jz4740_mmc_set_lpm(host, host->mmc->actual_clock);
+
+	return mmc_send_tuning(host->mmc, opcode, NULL);
+}
+
+static int jz4740_mmc_execute_tuning(struct mmc_host *mmc, u32 opcode)
+{
+	struct jz4740_mmc_host *host = mmc_priv(mmc);
+
+	/* Only the X1000 can move its sampling point */
+	if (host->version < JZ_MMC_X1000)
+		return 0;
+
+	/*
+	 * There are only two sampling points to choose from. Keep the delayed
+	 * one, which is the default, unless only the other one works.
+	 */
+	if (!jz4740_mmc_try_tuning(host, opcode, true) ||
+	    !jz4740_mmc_try_tuning(host, opcode, false))
+		return 0;
+
+	jz4740_mmc_try_tuning(host, opcode, true);
+	dev_err(mmc_dev(mmc), "No working sampling point found\n");
+
+	return -EIO;
+}
+
 static const struct mmc_host_ops jz4740_mmc_ops = {
 	.request	= jz4740_mmc_request,
 	.pre_req	= jz4740_mmc_pre_request,
@@ -961,6 +1197,8 @@ static const struct mmc_host_ops jz4740_mmc_ops = {
 	.get_ro		= mmc_gpio_get_ro,
 	.get_cd		= mmc_gpio_get_cd,
 	.enable_sdio_irq = jz4740_mmc_enable_sdio_irq,
+	.start_signal_voltage_switch = jz4740_mmc_start_signal_voltage_switch,
+	.execute_tuning	= jz4740_mmc_execute_tuning,
 };
 
 static inline struct jz4740_mmc_host *
@@ -1055,8 +1293,8 @@ static int jz4740_mmc_probe(struct platform_device* pdev)
 
 	host->clk = devm_clk_get(&pdev->dev, "mmc");
 	if (IS_ERR(host->clk)) {
-		ret = PTR_ERR(host->clk);
-		dev_err(&pdev->dev, "Failed to get mmc clock\n");
+		ret = dev_err_probe(&pdev->dev, PTR_ERR(host->clk),
+				    "Failed to get mmc clock\n");
 		goto err_free_host;
 	}
 
@@ -1073,6 +1311,18 @@ static int jz4740_mmc_probe(struct platform_device* pdev)
 		mmc->f_max = JZ_MMC_CLK_RATE;
 	mmc->f_min = mmc->f_max / 128;
 	mmc->ocr_avail = MMC_VDD_32_33 | MMC_VDD_33_34;
+	mmc->caps |= MMC_CAP_CMD23;
+
+	/*
+	 * The UHS-I modes need the I/O supply to switch to 1.8V, and a bus
+	 * clock that only the JZ4780 and later can reach. There is no DDR
+	 * mode, and the clock doesn't go as high as SDR104 needs.
+	 */
+	if (host->version < JZ_MMC_JZ4780 || IS_ERR(mmc->supply.vqmmc))
+		mmc->caps &= ~MMC_CAP_UHS;
+	else
+		mmc->caps &= ~(MMC_CAP_UHS_SDR104 | MMC_CAP_UHS_DDR50);
+	host->smp_delay = true;
 
 	/*
 	 * We use a fixed timeout of 5s, hence inform the core about it. A
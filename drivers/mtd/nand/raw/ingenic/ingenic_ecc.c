@@ -51,6 +51,55 @@ int ingenic_ecc_correct(struct ingenic_ecc *ecc,
 	return ecc->ops->correct(ecc, params, buf, ecc_code);
 }
 
+/**
+ * ingenic_ecc_can_pipeline() - check for split correction support
+ * @ecc: ECC device.
+ *
+ * Return: true if the ECC controller supports starting a correction with
+ * ingenic_ecc_correct_start() and collecting its result later with
+ * ingenic_ecc_correct_finish().
+ */
+bool ingenic_ecc_can_pipeline(struct ingenic_ecc *ecc)
+{
+	return ecc->ops->correct_start && ecc->ops->correct_finish;
+}
+
+/**
+ * ingenic_ecc_correct_start() - start detecting bit errors
+ * @ecc: ECC device.
+ * @params: ECC parameters.
+ * @buf: raw data read from the chip.
+ * @ecc_code: ECC read from the chip.
+ *
+ * Feeds the raw data and the ECC to the controller, without waiting for the
+ * result. The caller can do some other work (e.g. read the next ECC step from
+ * the NAND chip) and must then call ingenic_ecc_correct_finish(), with the
+ * same @params and @buf, before using the ECC controller again.
+ *
+ * Return: 0 on success, a negative error code otherwise.
+ */
+int ingenic_ecc_correct_start(struct ingenic_ecc *ecc,
+			      struct ingenic_ecc_params *params,
+			      u8 *buf, u8 *ecc_code)
+{
+	return ecc->ops->correct_start(ecc, params, buf, ecc_code);
+}
+
+/**
+ * ingenic_ecc_correct_finish() - wait for and apply a correction
+ * @ecc: ECC device.
+ * @params: ECC parameters.
+ * @buf: raw data passed to ingenic_ecc_correct_start().
+ *
+ * Return: the number of bit errors corrected, -EBADMSG if there are too many
+ * errors to correct or -ETIMEDOUT if we timed out waiting for the controller.
+ */
+int ingenic_ecc_correct_finish(struct ingenic_ecc *ecc,
+			       struct ingenic_ecc_params *params, u8 *buf)
+{
+	return ecc->ops->correct_finish(ecc, params, buf);
+}
+
 /**
  * ingenic_ecc_get() - get the ECC controller device
  * @np: ECC device tree node.
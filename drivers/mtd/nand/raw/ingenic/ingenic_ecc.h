@@ -50,6 +50,25 @@ int ingenic_ecc_correct(struct ingenic_ecc *ecc,
 	return -ENODEV;
 }
 
+static inline bool ingenic_ecc_can_pipeline(struct ingenic_ecc *ecc)
+{
+	return false;
+}
+
+static inline int ingenic_ecc_correct_start(struct ingenic_ecc *ecc,
+					    struct ingenic_ecc_params *params,
+					    u8 *buf, u8 *ecc_code)
+{
+	return -ENODEV;
+}
+
+static inline int ingenic_ecc_correct_finish(struct ingenic_ecc *ecc,
+					     struct ingenic_ecc_params *params,
+					     u8 *buf)
+{
+	return -ENODEV;
+}
+
 void ingenic_ecc_release(struct ingenic_ecc *ecc)
 {
 }
@@ -68,6 +87,11 @@ struct ingenic_ecc_ops {
 	int (*correct)(struct ingenic_ecc *ecc,
 			struct ingenic_ecc_params *params,
 			u8 *buf, u8 *ecc_code);
+	int (*correct_start)(struct ingenic_ecc *ecc,
+			     struct ingenic_ecc_params *params,
+			     u8 *buf, u8 *ecc_code);
+	int (*correct_finish)(struct ingenic_ecc *ecc,
+			      struct ingenic_ecc_params *params, u8 *buf);
 };
 
 struct ingenic_ecc {
@@ -180,6 +180,67 @@ static int ingenic_nand_ecc_correct(struct nand_chip *chip, u8 *dat,
 	return ingenic_ecc_correct(nfc->ecc, &params, dat, read_ecc);
 }
 
+/*
+ * Page read for ECC controllers that can decode an ECC step in the background:
+ * the OOB area is read first, so that the decoding of one step can be started
+ * before the data of the next step is read from the chip.
+ */
+static int ingenic_nand_read_page_pipelined(struct nand_chip *chip, u8 *buf,
+					   int oob_required, int page)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+	struct ingenic_nfc *nfc = to_ingenic_nfc(chip->controller);
+	int i, eccsize = chip->ecc.size, eccbytes = chip->ecc.bytes;
+	u8 *ecc_code = chip->ecc.code_buf;
+	unsigned int max_bitflips = 0;
+	struct ingenic_ecc_params params;
+	int ret, stat;
+	u8 *p;
+
+	params.size = eccsize;
+	params.bytes = eccbytes;
+	params.strength = chip->ecc.strength;
+
+	ret = nand_read_page_op(chip, page, mtd->writesize, chip->oob_poi,
+				mtd->oobsize);
+	if (ret)
+		return ret;
+
+	ret = mtd_ooblayout_get_eccbytes(mtd, ecc_code, chip->oob_poi, 0,
+					 chip->ecc.total);
+	if (ret)
+		return ret;
+
+	ret = nand_change_read_column_op(chip, 0, buf, eccsize, false);
+	if (ret)
+		return ret;
+
+	for (i = 0, p = buf; i < chip->ecc.steps; i++, p += eccsize) {
+		ret = ingenic_ecc_correct_start(nfc->ecc, &params, p,
+						&ecc_code[i * eccbytes]);
+		if (ret)
+			return ret;
+
+		/* Read the next step while the ECC controller is busy */
+		if (i + 1 < chip->ecc.steps)
+			ret = nand_read_data_op(chip, p + eccsize, eccsize,
+						false, false);
+
+		stat = ingenic_ecc_correct_finish(nfc->ecc, &params, p);
+		if (ret)
+			return ret;
+
+		if (stat < 0) {
+			mtd->ecc_stats.failed++;
+		} else {
+			mtd->ecc_stats.corrected += stat;
+			max_bitflips = max_t(unsigned int, max_bitflips, stat);
+		}
+	}
+
+	return max_bitflips;
+}
+
 static int ingenic_nand_attach_chip(struct nand_chip *chip)
 {
 	struct mtd_info *mtd = nand_to_mtd(chip);
@@ -204,6 +265,10 @@ static int ingenic_nand_attach_chip(struct nand_chip *chip)
 		chip->ecc.hwctl = ingenic_nand_ecc_hwctl;
 		chip->ecc.calculate = ingenic_nand_ecc_calculate;
 		chip->ecc.correct = ingenic_nand_ecc_correct;
+
+		/* Changing the read column requires a large page chip. */
+		if (ingenic_ecc_can_pipeline(nfc->ecc) && mtd->writesize > 512)
+			chip->ecc.read_page = ingenic_nand_read_page_pipelined;
 		fallthrough;
 	case NAND_ECC_ENGINE_TYPE_SOFT:
 		dev_info(nfc->dev, "using %s (strength %d, size %d, bytes %d)\n",
@@ -180,19 +180,25 @@ static int jz4780_calculate(struct ingenic_ecc *bch,
 	return ret;
 }
 
-static int jz4780_correct(struct ingenic_ecc *bch,
-			  struct ingenic_ecc_params *params,
-			  u8 *buf, u8 *ecc_code)
+static int jz4780_correct_start(struct ingenic_ecc *bch,
+				struct ingenic_ecc_params *params,
+				u8 *buf, u8 *ecc_code)
 {
-	u32 reg, mask, index;
-	int i, ret, count;
-
 	mutex_lock(&bch->lock);
 
 	jz4780_bch_reset(bch, params, false);
 	jz4780_bch_write_data(bch, buf, params->size);
 	jz4780_bch_write_data(bch, ecc_code, params->bytes);
 
+	return 0;
+}
+
+static int jz4780_correct_finish(struct ingenic_ecc *bch,
+				 struct ingenic_ecc_params *params, u8 *buf)
+{
+	u32 reg, mask, index;
+	int i, ret, count;
+
 	if (!jz4780_bch_wait_complete(bch, BCH_BHINT_DECF, &reg)) {
 		dev_err(bch->dev, "timed out while correcting data\n");
 		ret = -ETIMEDOUT;
@@ -229,6 +235,15 @@ static int jz4780_correct(struct ingenic_ecc *bch,
 	return ret;
 }
 
+static int jz4780_correct(struct ingenic_ecc *bch,
+			  struct ingenic_ecc_params *params,
+			  u8 *buf, u8 *ecc_code)
+{
+	jz4780_correct_start(bch, params, buf, ecc_code);
+
+	return jz4780_correct_finish(bch, params, buf);
+}
+
 static int jz4780_bch_probe(struct platform_device *pdev)
 {
 	struct ingenic_ecc *bch;
@@ -248,6 +263,8 @@ static const struct ingenic_ecc_ops jz4780_bch_ops = {
 	.disable = jz4780_bch_disable,
 	.calculate = jz4780_calculate,
 	.correct = jz4780_correct,
+	.correct_start = jz4780_correct_start,
+	.correct_finish = jz4780_correct_finish,
 };
 
 static const struct of_device_id jz4780_bch_dt_match[] = {
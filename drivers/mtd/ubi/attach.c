@@ -72,6 +72,7 @@
 #include <linux/err.h>
 #include <linux/slab.h>
 #include <linux/crc32.h>
+#include <linux/ktime.h>
 #include <linux/math64.h>
 #include <linux/random.h>
 #include "ubi.h"
@@ -958,6 +959,8 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
+	ubi->attach_scanned_pebs += 1;
+
 	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
 		return err;
@@ -1556,6 +1559,10 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 {
 	int err;
 	struct ubi_attach_info *ai;
+	ktime_t start = ktime_get();
+
+	ubi->attach_scanned_pebs = 0;
+	ubi->attach_fastmap_pebs = 0;
 
 	ai = alloc_ai();
 	if (!ai)
@@ -1598,6 +1605,10 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	ubi->mean_ec = ai->mean_ec;
 	dbg_gen("max. sequence number:       %llu", ai->max_sqnum);
 
+	if (ubi->fast_attach)
+		ubi->attach_fastmap_pebs = max(ubi->good_peb_count -
+					       ubi->attach_scanned_pebs, 0);
+
 	err = ubi_read_volume_table(ubi, ai);
 	if (err)
 		goto out_ai;
@@ -1634,6 +1645,11 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	}
 #endif
 
+	ubi->attach_time_us = ktime_us_delta(ktime_get(), start);
+	ubi_msg(ubi, "attached in %llu us, %d PEBs scanned, %d PEBs from fastmap",
+		ubi->attach_time_us, ubi->attach_scanned_pebs,
+		ubi->attach_fastmap_pebs);
+
 	destroy_ai(ai);
 	return 0;
 
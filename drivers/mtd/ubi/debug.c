@@ -493,6 +493,26 @@ static const struct file_operations eraseblk_count_fops = {
 	.release = eraseblk_count_release,
 };
 
+static int attach_stats_show(struct seq_file *s, void *unused)
+{
+	struct ubi_device *ubi;
+
+	ubi = ubi_get_device((unsigned long)s->private);
+	if (!ubi)
+		return -ENODEV;
+
+	seq_printf(s, "fast_attach: %d\n", ubi->fast_attach);
+	seq_printf(s, "scanned_pebs: %d\n", ubi->attach_scanned_pebs);
+	seq_printf(s, "fastmap_pebs: %d\n", ubi->attach_fastmap_pebs);
+	seq_printf(s, "good_pebs: %d\n", ubi->good_peb_count);
+	seq_printf(s, "attach_time_us: %llu\n", ubi->attach_time_us);
+
+	ubi_put_device(ubi);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(attach_stats);
+
 /**
  * ubi_debugfs_init_dev - initialize debugfs for an UBI device.
  * @ubi: UBI device description object
@@ -558,6 +578,9 @@ int ubi_debugfs_init_dev(struct ubi_device *ubi)
 	debugfs_create_file("detailed_erase_block_info", S_IRUSR, d->dfs_dir,
 			    (void *)ubi_num, &eraseblk_count_fops);
 
+	debugfs_create_file("attach_stats", S_IRUSR, d->dfs_dir,
+			    (void *)ubi_num, &attach_stats_fops);
+
 	return 0;
 }
 
@@ -437,6 +437,8 @@ static int scan_pool(struct ubi_device *ubi, struct ubi_attach_info *ai,
 			goto out;
 		}
 
+		ubi->attach_scanned_pebs += 1;
+
 		err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 		if (err && err != UBI_IO_BITFLIPS) {
 			ubi_err(ubi, "unable to read EC header! PEB:%i err:%i",
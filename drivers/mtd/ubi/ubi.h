@@ -549,6 +549,12 @@ struct ubi_debug_info {
  *                  time (MTD write buffer size)
  * @mtd: MTD device descriptor
  *
+ * @attach_scanned_pebs: count of physical eraseblocks whose headers were read
+ *                       when attaching the MTD device
+ * @attach_fastmap_pebs: count of physical eraseblocks whose state was loaded
+ *                       from the fastmap when attaching the MTD device
+ * @attach_time_us: time taken to attach the MTD device, in microseconds
+ *
  * @peb_buf: a buffer of PEB size used for different purposes
  * @buf_mutex: protects @peb_buf
  * @ckvol_mutex: serializes static volume checking when opening
@@ -650,6 +656,10 @@ struct ubi_device {
 	int max_write_size;
 	struct mtd_info *mtd;
 
+	int attach_scanned_pebs;
+	int attach_fastmap_pebs;
+	u64 attach_time_us;
+
 	void *peb_buf;
 	struct mutex buf_mutex;
 	struct mutex ckvol_mutex;
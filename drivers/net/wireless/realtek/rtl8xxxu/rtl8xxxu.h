@@ -1278,6 +1278,21 @@ struct rtl8xxxu_ra_report {
 	u8 desc_rate;
 };
 
+/*
+ * Counters of the RX path, exported through ethtool -S. Each of them is only
+ * updated from one context, either the URB completion or the URB submission.
+ */
+struct rtl8xxxu_rx_stats {
+	unsigned long urbs;
+	unsigned long urb_errors;
+	unsigned long packets;
+	unsigned long copied;
+	unsigned long copy_failed;
+	unsigned long recycled;
+	unsigned long allocated;
+	unsigned long alloc_failed;
+};
+
 struct rtl8xxxu_priv {
 	struct ieee80211_hw *hw;
 	struct usb_device *udev;
@@ -1293,6 +1308,8 @@ struct rtl8xxxu_priv {
 	int rx_urb_pending_count;
 	bool shutdown;
 	struct work_struct rx_urb_wq;
+	struct sk_buff_head rx_skb_pool;
+	struct rtl8xxxu_rx_stats rx_stats;
 
 	u8 mac_addr[ETH_ALEN];
 	char chip_name[8];
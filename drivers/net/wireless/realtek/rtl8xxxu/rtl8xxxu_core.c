@@ -4426,7 +4426,7 @@ void rtl8xxxu_gen1_init_aggregation(struct rtl8xxxu_priv *priv)
 	page_thresh = (priv->fops->rx_agg_buf_size / 512);
 	if (rtl8xxxu_dma_agg_pages >= 0) {
 		if (rtl8xxxu_dma_agg_pages <= page_thresh)
-			timeout = page_thresh;
+			page_thresh = rtl8xxxu_dma_agg_pages;
 		else if (rtl8xxxu_dma_agg_pages <= 6)
 			dev_err(&priv->udev->dev,
 				"%s: dma_agg_pages=%i too small, minimum is 6\n",
@@ -5111,6 +5111,30 @@ static void rtl8xxxu_free_rx_resources(struct rtl8xxxu_priv *priv)
 	}
 
 	spin_unlock_irqrestore(&priv->rx_urb_lock, flags);
+
+	skb_queue_purge(&priv->rx_skb_pool);
+}
+
+/*
+ * Give an aggregation buffer back to the pool once all of its packets have
+ * been copied out, so the next URB submission doesn't have to allocate one.
+ */
+static void rtl8xxxu_recycle_rx_skb(struct rtl8xxxu_priv *priv,
+				    struct sk_buff *skb)
+{
+	if (skb_cloned(skb) ||
+	    skb_queue_len(&priv->rx_skb_pool) >= RTL8XXXU_RX_URBS) {
+		dev_kfree_skb_any(skb);
+		return;
+	}
+
+	/* Undo the pulls of the parser, __netdev_alloc_skb() reserved this */
+	skb->data = skb->head + NET_SKB_PAD;
+	skb->len = 0;
+	skb_reset_tail_pointer(skb);
+
+	skb_queue_tail(&priv->rx_skb_pool, skb);
+	priv->rx_stats.recycled++;
 }
 
 static void rtl8xxxu_queue_rx_urb(struct rtl8xxxu_priv *priv,
@@ -5545,19 +5569,20 @@ int rtl8xxxu_parse_rxdesc16(struct rtl8xxxu_priv *priv, struct sk_buff *skb)
 	struct ieee80211_rx_status *rx_status;
 	struct rtl8xxxu_rxdesc16 *rx_desc;
 	struct rtl8723au_phy_stats *phy_stats;
-	struct sk_buff *next_skb = NULL;
+	struct sk_buff *rx_skb;
 	__le32 *_rx_desc_le;
 	u32 *_rx_desc;
-	int drvinfo_sz, desc_shift;
+	u8 *data = skb->data;
+	int drvinfo_sz, desc_shift, hdr_len;
 	int i, pkt_cnt, pkt_len, urb_len, pkt_offset;
 
 	urb_len = skb->len;
 	pkt_cnt = 0;
 
 	do {
-		rx_desc = (struct rtl8xxxu_rxdesc16 *)skb->data;
-		_rx_desc_le = (__le32 *)skb->data;
-		_rx_desc = (u32 *)skb->data;
+		rx_desc = (struct rtl8xxxu_rxdesc16 *)data;
+		_rx_desc_le = (__le32 *)data;
+		_rx_desc = (u32 *)data;
 
 		for (i = 0;
 		     i < (sizeof(struct rtl8xxxu_rxdesc16) / sizeof(u32)); i++)
@@ -5573,28 +5598,44 @@ int rtl8xxxu_parse_rxdesc16(struct rtl8xxxu_priv *priv, struct sk_buff *skb)
 
 		drvinfo_sz = rx_desc->drvinfo_sz * 8;
 		desc_shift = rx_desc->shift;
-		pkt_offset = roundup(pkt_len + drvinfo_sz + desc_shift +
-				     sizeof(struct rtl8xxxu_rxdesc16), 128);
+		hdr_len = sizeof(struct rtl8xxxu_rxdesc16) + drvinfo_sz +
+			desc_shift;
+		pkt_offset = roundup(pkt_len + hdr_len, 128);
+
+		if (hdr_len + pkt_len > urb_len)
+			break;
+
+		phy_stats = (struct rtl8723au_phy_stats *)
+			(data + sizeof(struct rtl8xxxu_rxdesc16));
 
 		/*
-		 * Only clone the skb if there's enough data at the end to
-		 * at least cover the rx descriptor
+		 * A lone packet is handed up in the URB buffer itself. When
+		 * the buffer holds several, each of them is copied into a
+		 * small skb instead of cloning the buffer: a clone would pin
+		 * the whole aggregate until the last packet is freed, and
+		 * charge each packet for all of it. The buffer is then
+		 * recycled for the next URB.
 		 */
-		if (pkt_cnt > 1 &&
-		    urb_len > (pkt_offset + sizeof(struct rtl8xxxu_rxdesc16)))
-			next_skb = skb_clone(skb, GFP_ATOMIC);
+		if (data == skb->data &&
+		    (pkt_cnt <= 1 ||
+		     urb_len <= pkt_offset + sizeof(struct rtl8xxxu_rxdesc16))) {
+			rx_skb = skb;
+			skb = NULL;
+			skb_pull(rx_skb, hdr_len);
+			skb_trim(rx_skb, pkt_len);
+		} else {
+			rx_skb = dev_alloc_skb(pkt_len);
+			if (!rx_skb) {
+				priv->rx_stats.copy_failed++;
+				goto next;
+			}
+			skb_put_data(rx_skb, data + hdr_len, pkt_len);
+			priv->rx_stats.copied++;
+		}
 
-		rx_status = IEEE80211_SKB_RXCB(skb);
+		rx_status = IEEE80211_SKB_RXCB(rx_skb);
 		memset(rx_status, 0, sizeof(struct ieee80211_rx_status));
 
-		skb_pull(skb, sizeof(struct rtl8xxxu_rxdesc16));
-
-		phy_stats = (struct rtl8723au_phy_stats *)skb->data;
-
-		skb_pull(skb, drvinfo_sz + desc_shift);
-
-		skb_trim(skb, pkt_len);
-
 		if (rx_desc->phy_stats)
 			rtl8xxxu_rx_parse_phystats(priv, rx_status, phy_stats,
 						   rx_desc->rxmcs);
@@ -5619,15 +5660,18 @@ int rtl8xxxu_parse_rxdesc16(struct rtl8xxxu_priv *priv, struct sk_buff *skb)
 		rx_status->freq = hw->conf.chandef.chan->center_freq;
 		rx_status->band = hw->conf.chandef.chan->band;
 
-		ieee80211_rx_irqsafe(hw, skb);
-
-		skb = next_skb;
-		if (skb)
-			skb_pull(next_skb, pkt_offset);
+		ieee80211_rx_irqsafe(hw, rx_skb);
+		priv->rx_stats.packets++;
 
+next:
+		data += pkt_offset;
 		pkt_cnt--;
 		urb_len -= pkt_offset;
-	} while (skb && urb_len > 0 && pkt_cnt > 0);
+	} while (urb_len > (int)sizeof(struct rtl8xxxu_rxdesc16) &&
+		 pkt_cnt > 0);
+
+	if (skb)
+		rtl8xxxu_recycle_rx_skb(priv, skb);
 
 	return RX_TYPE_DATA_PKT;
 }
@@ -5689,6 +5733,7 @@ int rtl8xxxu_parse_rxdesc24(struct rtl8xxxu_priv *priv, struct sk_buff *skb)
 	rx_status->band = hw->conf.chandef.chan->band;
 
 	ieee80211_rx_irqsafe(hw, skb);
+	priv->rx_stats.packets++;
 	return RX_TYPE_DATA_PKT;
 }
 
@@ -5704,6 +5749,7 @@ static void rtl8xxxu_rx_complete(struct urb *urb)
 	skb_put(skb, urb->actual_length);
 
 	if (urb->status == 0) {
+		priv->rx_stats.urbs++;
 		priv->fops->parse_rx_desc(priv, skb);
 
 		skb = NULL;
@@ -5711,6 +5757,7 @@ static void rtl8xxxu_rx_complete(struct urb *urb)
 		rtl8xxxu_queue_rx_urb(priv, rx_urb);
 	} else {
 		dev_dbg(dev, "%s: status %i\n",	__func__, urb->status);
+		priv->rx_stats.urb_errors++;
 		goto cleanup;
 	}
 	return;
@@ -5738,9 +5785,15 @@ static int rtl8xxxu_submit_rx_urb(struct rtl8xxxu_priv *priv,
 		skb_size = IEEE80211_MAX_FRAME_LEN;
 	}
 
-	skb = __netdev_alloc_skb(NULL, skb_size, GFP_KERNEL);
-	if (!skb)
-		return -ENOMEM;
+	skb = skb_dequeue(&priv->rx_skb_pool);
+	if (!skb) {
+		skb = __netdev_alloc_skb(NULL, skb_size, GFP_KERNEL);
+		if (!skb) {
+			priv->rx_stats.alloc_failed++;
+			return -ENOMEM;
+		}
+		priv->rx_stats.allocated++;
+	}
 
 	memset(skb->data, 0, rx_desc_sz);
 	usb_fill_bulk_urb(&rx_urb->urb, priv->udev, priv->pipe_in, skb->data,
@@ -6135,6 +6188,57 @@ rtl8xxxu_sta_statistics(struct ieee80211_hw *hw, struct ieee80211_vif *vif,
 	sinfo->filled |= BIT_ULL(NL80211_STA_INFO_TX_BITRATE);
 }
 
+static const char rtl8xxxu_gstrings_stats[][ETH_GSTRING_LEN] = {
+	"rx_urbs",
+	"rx_urb_errors",
+	"rx_packets",
+	"rx_copied",
+	"rx_copy_failed",
+	"rx_buf_recycled",
+	"rx_buf_allocated",
+	"rx_buf_alloc_failed",
+};
+
+#define RTL8XXXU_SSTATS_LEN	ARRAY_SIZE(rtl8xxxu_gstrings_stats)
+
+static void rtl8xxxu_get_et_strings(struct ieee80211_hw *hw,
+				    struct ieee80211_vif *vif,
+				    u32 sset, u8 *data)
+{
+	if (sset == ETH_SS_STATS)
+		memcpy(data, rtl8xxxu_gstrings_stats,
+		       sizeof(rtl8xxxu_gstrings_stats));
+}
+
+static int rtl8xxxu_get_et_sset_count(struct ieee80211_hw *hw,
+				      struct ieee80211_vif *vif, int sset)
+{
+	if (sset == ETH_SS_STATS)
+		return RTL8XXXU_SSTATS_LEN;
+
+	return 0;
+}
+
+static void rtl8xxxu_get_et_stats(struct ieee80211_hw *hw,
+				  struct ieee80211_vif *vif,
+				  struct ethtool_stats *stats, u64 *data)
+{
+	struct rtl8xxxu_priv *priv = hw->priv;
+	struct rtl8xxxu_rx_stats *rx = &priv->rx_stats;
+	int i = 0;
+
+	data[i++] = READ_ONCE(rx->urbs);
+	data[i++] = READ_ONCE(rx->urb_errors);
+	data[i++] = READ_ONCE(rx->packets);
+	data[i++] = READ_ONCE(rx->copied);
+	data[i++] = READ_ONCE(rx->copy_failed);
+	data[i++] = READ_ONCE(rx->recycled);
+	data[i++] = READ_ONCE(rx->allocated);
+	data[i++] = READ_ONCE(rx->alloc_failed);
+
+	WARN_ON(i != RTL8XXXU_SSTATS_LEN);
+}
+
 static u8 rtl8xxxu_signal_to_snr(int signal)
 {
 	if (signal < RTL8XXXU_NOISE_FLOOR_MIN)
@@ -6446,6 +6550,9 @@ static const struct ieee80211_ops rtl8xxxu_ops = {
 	.set_key = rtl8xxxu_set_key,
 	.ampdu_action = rtl8xxxu_ampdu_action,
 	.sta_statistics = rtl8xxxu_sta_statistics,
+	.get_et_strings = rtl8xxxu_get_et_strings,
+	.get_et_sset_count = rtl8xxxu_get_et_sset_count,
+	.get_et_stats = rtl8xxxu_get_et_stats,
 };
 
 static int rtl8xxxu_parse_usb(struct rtl8xxxu_priv *priv,
@@ -6598,6 +6705,7 @@ static int rtl8xxxu_probe(struct usb_interface *interface,
 	spin_lock_init(&priv->tx_urb_lock);
 	INIT_LIST_HEAD(&priv->rx_urb_pending_list);
 	spin_lock_init(&priv->rx_urb_lock);
+	skb_queue_head_init(&priv->rx_skb_pool);
 	INIT_WORK(&priv->rx_urb_wq, rtl8xxxu_rx_urb_work);
 	INIT_DELAYED_WORK(&priv->ra_watchdog, rtl8xxxu_watchdog_callback);
 	INIT_WORK(&priv->c2hcmd_work, rtl8xxxu_c2hcmd_callback);
@@ -24,6 +24,7 @@
 #include <linux/bitops.h>
 #include <linux/clk.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/nvmem-provider.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
@@ -38,6 +39,8 @@
 /* We read 32 byte chunks to avoid complexity in the driver. */
 #define JZ_EFU_READ_SIZE 32
 
+#define JZ_EFU_SIZE 1024
+
 #define EFUCTRL_ADDR_MASK	0x3FF
 #define EFUCTRL_ADDR_SHIFT	21
 #define EFUCTRL_LEN_MASK	0x1F
@@ -59,65 +62,89 @@
 #define EFUSTATE_WR_DONE	BIT(1)
 #define EFUSTATE_RD_DONE	BIT(0)
 
+/*
+ * The efuse is programmed in the factory and never changes afterwards, so
+ * each chunk is only read from the hardware once, then served from @cache.
+ * @lock serializes the read sequences and protects @cache and @cached.
+ */
 struct jz4780_efuse {
 	struct device *dev;
 	struct regmap *map;
 	struct clk *clk;
+	struct mutex lock;
+	DECLARE_BITMAP(cached, JZ_EFU_SIZE / JZ_EFU_READ_SIZE);
+	u32 cache[JZ_EFU_SIZE / sizeof(u32)];
 };
 
+/* Read the chunk starting at @start into the cache. */
+static int jz4780_efuse_read_chunk(struct jz4780_efuse *efuse, size_t start)
+{
+	unsigned int tmp;
+	u32 ctrl;
+	int ret;
+
+	ctrl = (start << EFUCTRL_ADDR_SHIFT)
+		| ((JZ_EFU_READ_SIZE - 1) << EFUCTRL_LEN_SHIFT)
+		| EFUCTRL_RD_EN;
+
+	regmap_update_bits(efuse->map, JZ_EFUCTRL,
+			   (EFUCTRL_ADDR_MASK << EFUCTRL_ADDR_SHIFT) |
+			   (EFUCTRL_LEN_MASK << EFUCTRL_LEN_SHIFT) |
+			   EFUCTRL_PG_EN | EFUCTRL_WR_EN |
+			   EFUCTRL_RD_EN,
+			   ctrl);
+
+	/* Reading 32 bytes takes far less than a millisecond: poll finely */
+	ret = regmap_read_poll_timeout(efuse->map, JZ_EFUSTATE,
+				       tmp, tmp & EFUSTATE_RD_DONE,
+				       10, 50 * MSEC_PER_SEC);
+	if (ret < 0) {
+		dev_err(efuse->dev, "Time out while reading efuse data");
+		return ret;
+	}
+
+	ret = regmap_bulk_read(efuse->map, JZ_EFUDATA(0),
+			       &efuse->cache[start / sizeof(u32)],
+			       JZ_EFU_READ_SIZE / sizeof(u32));
+	if (ret < 0)
+		return ret;
+
+	set_bit(start / JZ_EFU_READ_SIZE, efuse->cached);
+
+	return 0;
+}
+
 /* main entry point */
 static int jz4780_efuse_read(void *context, unsigned int offset,
 			     void *val, size_t bytes)
 {
 	struct jz4780_efuse *efuse = context;
+	unsigned int end = offset + bytes;
+	size_t start;
+	int ret = 0;
+
+	mutex_lock(&efuse->lock);
+
+	for (start = round_down(offset, JZ_EFU_READ_SIZE); start < end;
+	     start += JZ_EFU_READ_SIZE) {
+		if (test_bit(start / JZ_EFU_READ_SIZE, efuse->cached))
+			continue;
 
-	while (bytes > 0) {
-		size_t start = offset & ~(JZ_EFU_READ_SIZE - 1);
-		size_t chunk = min(bytes, (start + JZ_EFU_READ_SIZE)
-				    - offset);
-		char buf[JZ_EFU_READ_SIZE];
-		unsigned int tmp;
-		u32 ctrl;
-		int ret;
-
-		ctrl = (start << EFUCTRL_ADDR_SHIFT)
-			| ((JZ_EFU_READ_SIZE - 1) << EFUCTRL_LEN_SHIFT)
-			| EFUCTRL_RD_EN;
-
-		regmap_update_bits(efuse->map, JZ_EFUCTRL,
-				   (EFUCTRL_ADDR_MASK << EFUCTRL_ADDR_SHIFT) |
-				   (EFUCTRL_LEN_MASK << EFUCTRL_LEN_SHIFT) |
-				   EFUCTRL_PG_EN | EFUCTRL_WR_EN |
-				   EFUCTRL_RD_EN,
-				   ctrl);
-
-		ret = regmap_read_poll_timeout(efuse->map, JZ_EFUSTATE,
-					       tmp, tmp & EFUSTATE_RD_DONE,
-					       1 * MSEC_PER_SEC,
-					       50 * MSEC_PER_SEC);
-		if (ret < 0) {
-			dev_err(efuse->dev, "Time out while reading efuse data");
-			return ret;
-		}
-
-		ret = regmap_bulk_read(efuse->map, JZ_EFUDATA(0),
-				       buf, JZ_EFU_READ_SIZE / sizeof(u32));
-		if (ret < 0)
-			return ret;
-
-		memcpy(val, &buf[offset - start], chunk);
-
-		val += chunk;
-		offset += chunk;
-		bytes -= chunk;
+		ret = jz4780_efuse_read_chunk(efuse, start);
+		if (ret)
+			goto out_unlock;
 	}
 
-	return 0;
+	memcpy(val, (u8 *)efuse->cache + offset, bytes);
+
+out_unlock:
+	mutex_unlock(&efuse->lock);
+	return ret;
 }
 
 static struct nvmem_config jz4780_efuse_nvmem_config = {
 	.name = "jz4780-efuse",
-	.size = 1024,
+	.size = JZ_EFU_SIZE,
 	.word_size = 1,
 	.stride = 1,
 	.owner = THIS_MODULE,
@@ -178,6 +205,7 @@ static int jz4780_efuse_probe(struct platform_device *pdev)
 	clk_rate = clk_get_rate(efuse->clk);
 
 	efuse->dev = dev;
+	mutex_init(&efuse->lock);
 
 	/*
 	 * rd_adj and rd_strobe are 4 bit values
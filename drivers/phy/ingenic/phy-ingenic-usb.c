@@ -13,6 +13,7 @@
 #include <linux/module.h>
 #include <linux/phy/phy.h>
 #include <linux/platform_device.h>
+#include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
 
 /* OTGPHY register offsets */
@@ -93,8 +94,19 @@ struct ingenic_usb_phy {
 	void __iomem *base;
 	struct clk *clk;
 	struct regulator *vcc_supply;
+	bool initialized;
 };
 
+/* Time for the PHY to be usable again once SIDDQ is deasserted */
+#define INGENIC_USB_PHY_SIDDQ_SETTLE_US		30
+
+/*
+ * Keep the PHY up for a little while after it's powered off, so that a
+ * device quickly replugged, or a bus briefly suspended, doesn't pay for a
+ * power down / power up cycle.
+ */
+#define INGENIC_USB_PHY_AUTOSUSPEND_MS		500
+
 static int ingenic_usb_phy_init(struct phy *phy)
 {
 	struct ingenic_usb_phy *priv = phy_get_drvdata(phy);
@@ -115,6 +127,8 @@ static int ingenic_usb_phy_init(struct phy *phy)
 	writel(reg & ~USBPCR_POR, priv->base + REG_USBPCR_OFFSET);
 	usleep_range(300, 1000);
 
+	priv->initialized = true;
+
 	return 0;
 }
 
@@ -122,6 +136,8 @@ static int ingenic_usb_phy_exit(struct phy *phy)
 {
 	struct ingenic_usb_phy *priv = phy_get_drvdata(phy);
 
+	priv->initialized = false;
+
 	clk_disable_unprepare(priv->clk);
 	regulator_disable(priv->vcc_supply);
 
@@ -148,6 +164,9 @@ static int ingenic_usb_phy_power_off(struct phy *phy)
 
 	regulator_disable(priv->vcc_supply);
 
+	/* Start the autosuspend delay once the PHY core drops our reference */
+	pm_runtime_mark_last_busy(phy->dev.parent);
+
 	return 0;
 }
 
@@ -312,6 +331,56 @@ static const struct ingenic_soc_info x2000_soc_info = {
 	.usb_phy_init = x2000_usb_phy_init,
 };
 
+static int __maybe_unused ingenic_usb_phy_runtime_suspend(struct device *dev)
+{
+	struct ingenic_usb_phy *priv = dev_get_drvdata(dev);
+	u32 reg;
+
+	if (!priv->initialized)
+		return 0;
+
+	/*
+	 * Power down the analog part of the PHY. The configuration written
+	 * by ingenic_usb_phy_init() is retained, so resuming doesn't need to
+	 * go through the power-on reset sequence again.
+	 */
+	reg = readl(priv->base + REG_USBPCR_OFFSET);
+	writel(reg | USBPCR_SIDDQ, priv->base + REG_USBPCR_OFFSET);
+
+	clk_disable_unprepare(priv->clk);
+
+	return 0;
+}
+
+static int __maybe_unused ingenic_usb_phy_runtime_resume(struct device *dev)
+{
+	struct ingenic_usb_phy *priv = dev_get_drvdata(dev);
+	int err;
+	u32 reg;
+
+	if (!priv->initialized)
+		return 0;
+
+	err = clk_prepare_enable(priv->clk);
+	if (err) {
+		dev_err(dev, "Unable to start clock: %d\n", err);
+		return err;
+	}
+
+	reg = readl(priv->base + REG_USBPCR_OFFSET);
+	writel(reg & ~USBPCR_SIDDQ, priv->base + REG_USBPCR_OFFSET);
+	usleep_range(INGENIC_USB_PHY_SIDDQ_SETTLE_US,
+		     2 * INGENIC_USB_PHY_SIDDQ_SETTLE_US);
+
+	return 0;
+}
+
+static void ingenic_usb_phy_disable_rpm(void *dev)
+{
+	pm_runtime_dont_use_autosuspend(dev);
+	pm_runtime_disable(dev);
+}
+
 static int ingenic_usb_phy_probe(struct platform_device *pdev)
 {
 	struct ingenic_usb_phy *priv;
@@ -329,6 +398,8 @@ static int ingenic_usb_phy_probe(struct platform_device *pdev)
 		return -ENODEV;
 	}
 
+	platform_set_drvdata(pdev, priv);
+
 	priv->base = devm_platform_ioremap_resource(pdev, 0);
 	if (IS_ERR(priv->base)) {
 		dev_err(dev, "Failed to map registers\n");
@@ -351,6 +422,18 @@ static int ingenic_usb_phy_probe(struct platform_device *pdev)
 		return err;
 	}
 
+	/*
+	 * Runtime PM must be enabled before the PHY is created, so that the
+	 * PHY core keeps us resumed for as long as the PHY is powered on.
+	 */
+	pm_runtime_set_autosuspend_delay(dev, INGENIC_USB_PHY_AUTOSUSPEND_MS);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+
+	err = devm_add_action_or_reset(dev, ingenic_usb_phy_disable_rpm, dev);
+	if (err)
+		return err;
+
 	priv->phy = devm_phy_create(dev, NULL, &ingenic_usb_phy_ops);
 	if (IS_ERR(priv->phy))
 		return PTR_ERR(priv->phy);
@@ -395,11 +478,17 @@ static const struct of_device_id ingenic_usb_phy_of_matches[] = {
 };
 MODULE_DEVICE_TABLE(of, ingenic_usb_phy_of_matches);
 
+static const struct dev_pm_ops ingenic_usb_phy_pm_ops = {
+	SET_RUNTIME_PM_OPS(ingenic_usb_phy_runtime_suspend,
+			   ingenic_usb_phy_runtime_resume, NULL)
+};
+
 static struct platform_driver ingenic_usb_phy_driver = {
 	.probe		= ingenic_usb_phy_probe,
 	.driver		= {
 		.name	= "ingenic-usb-phy",
 		.of_match_table = ingenic_usb_phy_of_matches,
+		.pm	= &ingenic_usb_phy_pm_ops,
 	},
 };
 module_platform_driver(ingenic_usb_phy_driver);
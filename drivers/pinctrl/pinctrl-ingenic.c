@@ -123,6 +123,7 @@ struct ingenic_chip_info {
 struct ingenic_pinctrl {
 	struct device *dev;
 	struct regmap *map;
+	void __iomem *base;
 	struct pinctrl_dev *pctl;
 	struct pinctrl_pin_desc *pdesc;
 
@@ -134,6 +135,9 @@ struct ingenic_gpio_chip {
 	struct gpio_chip gc;
 	struct irq_chip irq_chip;
 	unsigned int irq, reg_base;
+
+	/* Registers of the port, for lockless access to the pin levels */
+	void __iomem *base;
 };
 
 static const u32 jz4730_pull_ups[4] = {
@@ -2861,23 +2865,49 @@ static void jz4730_gpio_set_bits(struct ingenic_gpio_chip *jzgc,
 	regmap_update_bits(jzgc->jzpc->map, jzgc->reg_base + reg, mask, value << (idx * 2));
 }
 
+/*
+ * The pin level and data registers are accessed directly instead of through
+ * the regmap. Reading the pin levels has no side effect, and on all SoCs but
+ * the JZ4730 the data register has set and clear registers, so no locking is
+ * needed. This makes a big difference for bit-banged buses.
+ */
+static inline u32 ingenic_gpio_get_values(struct ingenic_gpio_chip *jzgc)
+{
+	return readl(jzgc->base + GPIO_PIN);
+}
+
 static inline bool ingenic_gpio_get_value(struct ingenic_gpio_chip *jzgc,
 					  u8 offset)
 {
-	unsigned int val = ingenic_gpio_read_reg(jzgc, GPIO_PIN);
+	return !!(ingenic_gpio_get_values(jzgc) & BIT(offset));
+}
 
-	return !!(val & BIT(offset));
+static void ingenic_gpio_set_values(struct ingenic_gpio_chip *jzgc,
+				    u32 mask, u32 bits)
+{
+	u8 reg;
+
+	if (jzgc->jzpc->info->version == ID_JZ4730) {
+		regmap_update_bits(jzgc->jzpc->map,
+				   jzgc->reg_base + JZ4730_GPIO_DATA, mask, bits);
+		return;
+	}
+
+	if (jzgc->jzpc->info->version >= ID_JZ4770)
+		reg = JZ4770_GPIO_PAT0;
+	else
+		reg = JZ4740_GPIO_DATA;
+
+	if (mask & bits)
+		writel(mask & bits, jzgc->base + REG_SET(reg));
+	if (mask & ~bits)
+		writel(mask & ~bits, jzgc->base + REG_CLEAR(reg));
 }
 
 static void ingenic_gpio_set_value(struct ingenic_gpio_chip *jzgc,
 				   u8 offset, int value)
 {
-	if (jzgc->jzpc->info->version >= ID_JZ4770)
-		ingenic_gpio_set_bit(jzgc, JZ4770_GPIO_PAT0, offset, !!value);
-	else if (jzgc->jzpc->info->version >= ID_JZ4740)
-		ingenic_gpio_set_bit(jzgc, JZ4740_GPIO_DATA, offset, !!value);
-	else
-		ingenic_gpio_set_bit(jzgc, JZ4730_GPIO_DATA, offset, !!value);
+	ingenic_gpio_set_values(jzgc, BIT(offset), value ? BIT(offset) : 0);
 }
 
 static void irq_set_type(struct ingenic_gpio_chip *jzgc,
@@ -3099,6 +3129,24 @@ static int ingenic_gpio_get(struct gpio_chip *gc, unsigned int offset)
 	return (int) ingenic_gpio_get_value(jzgc, offset);
 }
 
+static void ingenic_gpio_set_multiple(struct gpio_chip *gc,
+		unsigned long *mask, unsigned long *bits)
+{
+	struct ingenic_gpio_chip *jzgc = gpiochip_get_data(gc);
+
+	ingenic_gpio_set_values(jzgc, *mask, *bits);
+}
+
+static int ingenic_gpio_get_multiple(struct gpio_chip *gc,
+		unsigned long *mask, unsigned long *bits)
+{
+	struct ingenic_gpio_chip *jzgc = gpiochip_get_data(gc);
+
+	*bits = ingenic_gpio_get_values(jzgc) & *mask;
+
+	return 0;
+}
+
 static int ingenic_gpio_direction_input(struct gpio_chip *gc,
 		unsigned int offset)
 {
@@ -3691,6 +3739,7 @@ static int __init ingenic_gpio_probe(struct ingenic_pinctrl *jzpc,
 
 	jzgc->jzpc = jzpc;
 	jzgc->reg_base = bank * jzpc->info->reg_offset;
+	jzgc->base = jzpc->base + jzgc->reg_base;
 
 	jzgc->gc.label = devm_kasprintf(dev, GFP_KERNEL, "GPIO%c", 'A' + bank);
 	if (!jzgc->gc.label)
@@ -3709,6 +3758,8 @@ static int __init ingenic_gpio_probe(struct ingenic_pinctrl *jzpc,
 
 	jzgc->gc.set = ingenic_gpio_set;
 	jzgc->gc.get = ingenic_gpio_get;
+	jzgc->gc.set_multiple = ingenic_gpio_set_multiple;
+	jzgc->gc.get_multiple = ingenic_gpio_get_multiple;
 	jzgc->gc.direction_input = ingenic_gpio_direction_input;
 	jzgc->gc.direction_output = ingenic_gpio_direction_output;
 	jzgc->gc.get_direction = ingenic_gpio_get_direction;
@@ -3787,6 +3838,7 @@ static int __init ingenic_pinctrl_probe(struct platform_device *pdev)
 	}
 
 	jzpc->dev = dev;
+	jzpc->base = base;
 	jzpc->info = chip_info;
 
 	pctl_desc = devm_kzalloc(&pdev->dev, sizeof(*pctl_desc), GFP_KERNEL);
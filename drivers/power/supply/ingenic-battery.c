@@ -6,12 +6,25 @@
  * based on drivers/power/supply/jz4740-battery.c
  */
 
+#include <linux/devm-helpers.h>
 #include <linux/iio/consumer.h>
+#include <linux/jiffies.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
 #include <linux/power_supply.h>
 #include <linux/property.h>
+#include <linux/workqueue.h>
+
+/* Readings younger than this are served from the cache */
+#define INGENIC_BATTERY_CACHE_MS	5000
+
+/* Period of the background sampling */
+#define INGENIC_BATTERY_POLL_MS		60000
+
+/* Voltage change that warrants a power_supply_changed() notification */
+#define INGENIC_BATTERY_HYSTERESIS_UV	20000
 
 struct ingenic_battery {
 	struct device *dev;
@@ -19,31 +32,130 @@ struct ingenic_battery {
 	struct power_supply_desc desc;
 	struct power_supply *battery;
 	struct power_supply_battery_info info;
+
+	struct delayed_work work;
+	struct mutex lock;
+	unsigned long sample_time;
+	int voltage_uv;
+	int notified_uv;
+	bool sampled;
 };
 
+/*
+ * Return the filtered battery voltage, capturing a new ADC sample only if
+ * the cached one is too old. The ADC readings are noisy, so they are
+ * averaged over the last few samples.
+ */
+static int ingenic_battery_voltage(struct ingenic_battery *bat, int *uv,
+				   bool force)
+{
+	int ret = 0, val;
+
+	mutex_lock(&bat->lock);
+
+	if (!force && bat->sampled &&
+	    time_before(jiffies, bat->sample_time +
+			msecs_to_jiffies(INGENIC_BATTERY_CACHE_MS)))
+		goto out;
+
+	ret = iio_read_channel_processed(bat->channel, &val);
+	if (ret < 0)
+		goto out_unlock;
+
+	val *= 1000;
+	if (bat->sampled)
+		bat->voltage_uv = (3 * bat->voltage_uv + val) / 4;
+	else
+		bat->voltage_uv = val;
+
+	bat->sample_time = jiffies;
+	bat->sampled = true;
+	ret = 0;
+out:
+	*uv = bat->voltage_uv;
+out_unlock:
+	mutex_unlock(&bat->lock);
+	return ret;
+}
+
+static int ingenic_battery_health(struct ingenic_battery *bat, int uv)
+{
+	struct power_supply_battery_info *info = &bat->info;
+
+	if (uv < info->voltage_min_design_uv)
+		return POWER_SUPPLY_HEALTH_DEAD;
+	if (uv > info->voltage_max_design_uv)
+		return POWER_SUPPLY_HEALTH_OVERVOLTAGE;
+
+	return POWER_SUPPLY_HEALTH_GOOD;
+}
+
+/*
+ * Estimate the capacity from the voltage, with the OCV table of the battery
+ * if it has one, or linearly between the design voltages otherwise.
+ */
+static int ingenic_battery_capacity(struct ingenic_battery *bat, int uv)
+{
+	struct power_supply_battery_info *info = &bat->info;
+	int min_uv = info->voltage_min_design_uv;
+	int max_uv = info->voltage_max_design_uv;
+
+	if (info->ocv_table_size[0] > 0)
+		return power_supply_batinfo_ocv2cap(info, uv, 20);
+
+	if (max_uv <= min_uv)
+		return -ENODATA;
+
+	uv = clamp(uv, min_uv, max_uv);
+
+	return DIV_ROUND_CLOSEST((uv - min_uv) * 100, max_uv - min_uv);
+}
+
+static void ingenic_battery_work(struct work_struct *work)
+{
+	struct ingenic_battery *bat = container_of(to_delayed_work(work),
+						   struct ingenic_battery,
+						   work);
+	int uv;
+
+	if (!ingenic_battery_voltage(bat, &uv, true) &&
+	    (abs(uv - bat->notified_uv) >= INGENIC_BATTERY_HYSTERESIS_UV ||
+	     ingenic_battery_health(bat, uv) !=
+	     ingenic_battery_health(bat, bat->notified_uv))) {
+		bat->notified_uv = uv;
+		power_supply_changed(bat->battery);
+	}
+
+	queue_delayed_work(system_freezable_power_efficient_wq, &bat->work,
+			   msecs_to_jiffies(INGENIC_BATTERY_POLL_MS));
+}
+
 static int ingenic_battery_get_property(struct power_supply *psy,
 					enum power_supply_property psp,
 					union power_supply_propval *val)
 {
 	struct ingenic_battery *bat = power_supply_get_drvdata(psy);
 	struct power_supply_battery_info *info = &bat->info;
-	int ret;
+	int ret, uv;
 
 	switch (psp) {
 	case POWER_SUPPLY_PROP_HEALTH:
-		ret = iio_read_channel_processed(bat->channel, &val->intval);
-		val->intval *= 1000;
-		if (val->intval < info->voltage_min_design_uv)
-			val->intval = POWER_SUPPLY_HEALTH_DEAD;
-		else if (val->intval > info->voltage_max_design_uv)
-			val->intval = POWER_SUPPLY_HEALTH_OVERVOLTAGE;
-		else
-			val->intval = POWER_SUPPLY_HEALTH_GOOD;
-		return ret;
+		ret = ingenic_battery_voltage(bat, &uv, false);
+		if (ret)
+			return ret;
+		val->intval = ingenic_battery_health(bat, uv);
+		return 0;
 	case POWER_SUPPLY_PROP_VOLTAGE_NOW:
-		ret = iio_read_channel_processed(bat->channel, &val->intval);
-		val->intval *= 1000;
-		return ret;
+		return ingenic_battery_voltage(bat, &val->intval, false);
+	case POWER_SUPPLY_PROP_CAPACITY:
+		ret = ingenic_battery_voltage(bat, &uv, false);
+		if (ret)
+			return ret;
+		ret = ingenic_battery_capacity(bat, uv);
+		if (ret < 0)
+			return ret;
+		val->intval = ret;
+		return 0;
 	case POWER_SUPPLY_PROP_VOLTAGE_MIN_DESIGN:
 		val->intval = info->voltage_min_design_uv;
 		return 0;
@@ -116,6 +228,7 @@ static int ingenic_battery_set_scale(struct ingenic_battery *bat)
 static enum power_supply_property ingenic_battery_properties[] = {
 	POWER_SUPPLY_PROP_HEALTH,
 	POWER_SUPPLY_PROP_VOLTAGE_NOW,
+	POWER_SUPPLY_PROP_CAPACITY,
 	POWER_SUPPLY_PROP_VOLTAGE_MIN_DESIGN,
 	POWER_SUPPLY_PROP_VOLTAGE_MAX_DESIGN,
 };
@@ -133,6 +246,7 @@ static int ingenic_battery_probe(struct platform_device *pdev)
 		return -ENOMEM;
 
 	bat->dev = dev;
+	mutex_init(&bat->lock);
 	bat->channel = devm_iio_channel_get(dev, "battery");
 	if (IS_ERR(bat->channel))
 		return PTR_ERR(bat->channel);
@@ -143,6 +257,8 @@ static int ingenic_battery_probe(struct platform_device *pdev)
 	desc->properties = ingenic_battery_properties;
 	desc->num_properties = ARRAY_SIZE(ingenic_battery_properties);
 	desc->get_property = ingenic_battery_get_property;
+	/* Readings don't change faster than the cache is refreshed */
+	desc->changed_min_interval_ms = INGENIC_BATTERY_CACHE_MS;
 	psy_cfg.drv_data = bat;
 	psy_cfg.of_node = dev->of_node;
 
@@ -165,7 +281,18 @@ static int ingenic_battery_probe(struct platform_device *pdev)
 		return bat->info.voltage_max_design_uv;
 	}
 
-	return ingenic_battery_set_scale(bat);
+	ret = ingenic_battery_set_scale(bat);
+	if (ret)
+		return ret;
+
+	ret = devm_delayed_work_autocancel(dev, &bat->work,
+					   ingenic_battery_work);
+	if (ret)
+		return ret;
+
+	queue_delayed_work(system_freezable_power_efficient_wq, &bat->work, 0);
+
+	return 0;
 }
 
 #ifdef CONFIG_OF
@@ -73,11 +73,27 @@ static int __power_supply_changed_work(struct device *dev, void *data)
 	return 0;
 }
 
+/*
+ * How long a change reported now has to wait before it is notified, called
+ * with changed_lock held.
+ */
+static unsigned long power_supply_changed_delay(struct power_supply *psy)
+{
+	unsigned int interval_ms = psy->desc->changed_min_interval_ms;
+	unsigned long now = jiffies, next;
+
+	if (!interval_ms)
+		return 0;
+
+	next = psy->changed_time + msecs_to_jiffies(interval_ms);
+	return time_before(now, next) ? next - now : 0;
+}
+
 static void power_supply_changed_work(struct work_struct *work)
 {
 	unsigned long flags;
 	struct power_supply *psy = container_of(work, struct power_supply,
-						changed_work);
+						changed_work.work);
 
 	dev_dbg(&psy->dev, "%s\n", __func__);
 
@@ -91,6 +107,7 @@ static void power_supply_changed_work(struct work_struct *work)
 	 */
 	if (likely(psy->changed)) {
 		psy->changed = false;
+		psy->changed_time = jiffies;
 		spin_unlock_irqrestore(&psy->changed_lock, flags);
 		class_for_each_device(power_supply_class, NULL, psy,
 				      __power_supply_changed_work);
@@ -104,24 +121,32 @@ static void power_supply_changed_work(struct work_struct *work)
 	/*
 	 * Hold the wakeup_source until all events are processed.
 	 * power_supply_changed() might have called again and have set 'changed'
-	 * to true.
+	 * to true. A change held back by changed_min_interval_ms does not keep
+	 * the system awake until it is notified.
 	 */
-	if (likely(!psy->changed))
+	if (likely(!psy->changed) || power_supply_changed_delay(psy))
 		pm_relax(&psy->dev);
 	spin_unlock_irqrestore(&psy->changed_lock, flags);
 }
 
 void power_supply_changed(struct power_supply *psy)
 {
-	unsigned long flags;
+	unsigned long flags, delay;
 
 	dev_dbg(&psy->dev, "%s\n", __func__);
 
 	spin_lock_irqsave(&psy->changed_lock, flags);
 	psy->changed = true;
-	pm_stay_awake(&psy->dev);
+	delay = power_supply_changed_delay(psy);
+	if (!delay)
+		pm_stay_awake(&psy->dev);
 	spin_unlock_irqrestore(&psy->changed_lock, flags);
-	schedule_work(&psy->changed_work);
+
+	/*
+	 * If the work is already pending, the change is reported along with
+	 * the earlier ones when it runs.
+	 */
+	schedule_delayed_work(&psy->changed_work, delay);
 }
 EXPORT_SYMBOL_GPL(power_supply_changed);
 
@@ -1137,7 +1162,7 @@ __power_supply_register(struct device *parent,
 	if (rc)
 		goto dev_set_name_failed;
 
-	INIT_WORK(&psy->changed_work, power_supply_changed_work);
+	INIT_DELAYED_WORK(&psy->changed_work, power_supply_changed_work);
 	INIT_DELAYED_WORK(&psy->deferred_register_work,
 			  power_supply_deferred_register_work);
 
@@ -1148,6 +1173,9 @@ __power_supply_register(struct device *parent,
 	}
 
 	spin_lock_init(&psy->changed_lock);
+	/* Don't hold back the first notification */
+	psy->changed_time = jiffies -
+			    msecs_to_jiffies(desc->changed_min_interval_ms);
 	rc = device_add(dev);
 	if (rc)
 		goto device_add_failed;
@@ -1341,7 +1369,7 @@ void power_supply_unregister(struct power_supply *psy)
 {
 	WARN_ON(atomic_dec_return(&psy->use_cnt));
 	psy->removing = true;
-	cancel_work_sync(&psy->changed_work);
+	cancel_delayed_work_sync(&psy->changed_work);
 	cancel_delayed_work_sync(&psy->deferred_register_work);
 	sysfs_remove_link(&psy->dev.kobj, "powers");
 	power_supply_remove_hwmon_sysfs(psy);
@@ -6,6 +6,10 @@
  * Limitations:
  * - The .apply callback doesn't complete the currently running period before
  *   reconfiguring the hardware.
+ * - When only the duty cycle of an enabled PWM changes, the new value is
+ *   written to TDHR while the counter runs. It takes effect at the end of
+ *   the current period, so .apply returns before the new duty cycle is
+ *   output.
  */
 
 #include <linux/clk.h>
@@ -120,6 +124,34 @@ static void jz4740_pwm_disable(struct pwm_chip *chip, struct pwm_device *pwm)
 	regmap_write(jz->map, TCU_REG_TECR, BIT(pwm->hwpwm));
 }
 
+/*
+ * Update the duty cycle of a running PWM, without stopping the counter and
+ * going through its reinitialization. The period, thus the clock rate, is
+ * unchanged, so the duty value can be computed from the current rate.
+ */
+static int jz4740_pwm_update_duty(struct jz4740_pwm_chip *jz4740,
+				  struct pwm_device *pwm,
+				  const struct pwm_state *state)
+{
+	struct clk *clk = pwm_get_chip_data(pwm);
+	unsigned long rate = clk_get_rate(clk);
+	unsigned long long tmp;
+	unsigned long period, duty;
+
+	tmp = (unsigned long long)rate * state->period;
+	do_div(tmp, NSEC_PER_SEC);
+	period = tmp;
+
+	tmp = (unsigned long long)rate * state->duty_cycle;
+	do_div(tmp, NSEC_PER_SEC);
+	duty = tmp;
+
+	if (duty >= period)
+		duty = period - 1;
+
+	return regmap_write(jz4740->map, TCU_REG_TDHRc(pwm->hwpwm), duty);
+}
+
 static int jz4740_pwm_apply(struct pwm_chip *chip, struct pwm_device *pwm,
 			    const struct pwm_state *state)
 {
@@ -130,6 +162,15 @@ static int jz4740_pwm_apply(struct pwm_chip *chip, struct pwm_device *pwm,
 	long rate;
 	int err;
 
+	/*
+	 * Fast path for the backlight and rumble drivers, which mostly change
+	 * the duty cycle of an enabled PWM.
+	 */
+	if (pwm->state.enabled && state->enabled &&
+	    pwm->state.period == state->period &&
+	    pwm->state.polarity == state->polarity)
+		return jz4740_pwm_update_duty(jz4740, pwm, state);
+
 	/*
 	 * Limit the clock to a maximum rate that still gives us a period value
 	 * which fits in 16 bits.
@@ -6,12 +6,21 @@
 
 #include <linux/bitops.h>
 #include <linux/clk.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-mapping.h>
 #include <linux/err.h>
+#include <linux/fs.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
+#include <linux/miscdevice.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/platform_device.h>
 #include <linux/remoteproc.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+
+#include <uapi/linux/ingenic-vpu.h>
 
 #include "remoteproc_internal.h"
 
@@ -57,6 +66,8 @@ static const struct vpu_mem_map vpu_mem_map[] = {
  * @mem_info: array of struct vpu_mem_info, which contain the mapping info of
  *            each of the external memories
  * @dev: private pointer to the device
+ * @rproc: the remote processor, whose private data is this structure
+ * @miscdev: character device used to share DMABUFs with the VPU
  */
 struct vpu {
 	int irq;
@@ -64,6 +75,34 @@ struct vpu {
 	void __iomem *aux_base;
 	struct vpu_mem_info mem_info[ARRAY_SIZE(vpu_mem_map)];
 	struct device *dev;
+	struct rproc *rproc;
+	struct miscdevice miscdev;
+};
+
+/**
+ * struct vpu_dmabuf - DMABUF mapped for the VPU
+ * @list: entry in the list of the DMABUFs mapped through a file
+ * @dmabuf: the DMABUF
+ * @attach: attachment of the DMABUF to the VPU device
+ * @sgt: scatter/gather table of the mapping
+ */
+struct vpu_dmabuf {
+	struct list_head list;
+	struct dma_buf *dmabuf;
+	struct dma_buf_attachment *attach;
+	struct sg_table *sgt;
+};
+
+/**
+ * struct vpu_file - Per-file private data of the VPU character device
+ * @vpu: the VPU
+ * @lock: protects @dmabufs
+ * @dmabufs: list of the DMABUFs mapped through this file
+ */
+struct vpu_file {
+	struct vpu *vpu;
+	struct mutex lock;
+	struct list_head dmabufs;
 };
 
 static int ingenic_rproc_prepare(struct rproc *rproc)
@@ -163,6 +202,205 @@ static irqreturn_t vpu_interrupt(int irq, void *data)
 	return rproc_vq_interrupt(rproc, vring);
 }
 
+static void vpu_dmabuf_release(struct vpu_dmabuf *buf)
+{
+	dma_buf_unmap_attachment(buf->attach, buf->sgt, DMA_BIDIRECTIONAL);
+	dma_buf_detach(buf->dmabuf, buf->attach);
+	dma_buf_put(buf->dmabuf);
+	kfree(buf);
+}
+
+static int vpu_map_dmabuf(struct vpu_file *vfile,
+			  struct ingenic_vpu_dmabuf __user *uarg)
+{
+	struct device *dev = vfile->vpu->dev;
+	struct ingenic_vpu_dmabuf arg;
+	struct vpu_dmabuf *buf;
+	struct scatterlist *sg;
+	dma_addr_t next;
+	unsigned int i;
+	int ret;
+
+	if (copy_from_user(&arg, uarg, sizeof(arg)))
+		return -EFAULT;
+
+	if (arg.flags)
+		return -EINVAL;
+
+	buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	buf->dmabuf = dma_buf_get(arg.fd);
+	if (IS_ERR(buf->dmabuf)) {
+		ret = PTR_ERR(buf->dmabuf);
+		goto err_free;
+	}
+
+	buf->attach = dma_buf_attach(buf->dmabuf, dev);
+	if (IS_ERR(buf->attach)) {
+		ret = PTR_ERR(buf->attach);
+		goto err_put;
+	}
+
+	buf->sgt = dma_buf_map_attachment(buf->attach, DMA_BIDIRECTIONAL);
+	if (IS_ERR(buf->sgt)) {
+		ret = PTR_ERR(buf->sgt);
+		goto err_detach;
+	}
+
+	/* The VPU has no MMU; the buffer must be contiguous */
+	next = sg_dma_address(buf->sgt->sgl);
+	for_each_sgtable_dma_sg(buf->sgt, sg, i) {
+		if (sg_dma_address(sg) != next) {
+			dev_dbg(dev, "DMABUF is not contiguous\n");
+			ret = -EINVAL;
+			goto err_unmap;
+		}
+
+		next += sg_dma_len(sg);
+	}
+
+	/*
+	 * The exporter may skip the CPU cache maintenance; make sure that no
+	 * dirty cache line will be written back over the VPU's output.
+	 */
+	dma_sync_sgtable_for_device(dev, buf->sgt, DMA_BIDIRECTIONAL);
+
+	arg.da = sg_dma_address(buf->sgt->sgl);
+	arg.size = buf->dmabuf->size;
+
+	if (copy_to_user(uarg, &arg, sizeof(arg))) {
+		ret = -EFAULT;
+		goto err_unmap;
+	}
+
+	mutex_lock(&vfile->lock);
+	list_add(&buf->list, &vfile->dmabufs);
+	mutex_unlock(&vfile->lock);
+
+	return 0;
+
+err_unmap:
+	dma_buf_unmap_attachment(buf->attach, buf->sgt, DMA_BIDIRECTIONAL);
+err_detach:
+	dma_buf_detach(buf->dmabuf, buf->attach);
+err_put:
+	dma_buf_put(buf->dmabuf);
+err_free:
+	kfree(buf);
+	return ret;
+}
+
+static int vpu_unmap_dmabuf(struct vpu_file *vfile,
+			    struct ingenic_vpu_dmabuf __user *uarg)
+{
+	struct ingenic_vpu_dmabuf arg;
+	struct vpu_dmabuf *buf, *found = NULL;
+	struct dma_buf *dmabuf;
+
+	if (copy_from_user(&arg, uarg, sizeof(arg)))
+		return -EFAULT;
+
+	dmabuf = dma_buf_get(arg.fd);
+	if (IS_ERR(dmabuf))
+		return PTR_ERR(dmabuf);
+
+	mutex_lock(&vfile->lock);
+	list_for_each_entry(buf, &vfile->dmabufs, list) {
+		if (buf->dmabuf == dmabuf) {
+			list_del(&buf->list);
+			found = buf;
+			break;
+		}
+	}
+	mutex_unlock(&vfile->lock);
+
+	dma_buf_put(dmabuf);
+
+	if (!found)
+		return -ENOENT;
+
+	vpu_dmabuf_release(found);
+
+	return 0;
+}
+
+static long vpu_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
+{
+	struct vpu_file *vfile = filp->private_data;
+	void __user *argp = (void __user *)arg;
+
+	switch (cmd) {
+	case INGENIC_VPU_MAP_DMABUF:
+		return vpu_map_dmabuf(vfile, argp);
+	case INGENIC_VPU_UNMAP_DMABUF:
+		return vpu_unmap_dmabuf(vfile, argp);
+	default:
+		return -ENOTTY;
+	}
+}
+
+static int vpu_open(struct inode *inode, struct file *filp)
+{
+	struct vpu *vpu = container_of(filp->private_data, struct vpu, miscdev);
+	struct vpu_file *vfile;
+
+	vfile = kzalloc(sizeof(*vfile), GFP_KERNEL);
+	if (!vfile)
+		return -ENOMEM;
+
+	/*
+	 * The file may outlive the driver's binding, which frees the remote
+	 * processor and this structure with it; keep both alive, as well as
+	 * the device the DMABUFs are attached to, until the file is released.
+	 */
+	get_device(&vpu->rproc->dev);
+	get_device(vpu->dev);
+
+	vfile->vpu = vpu;
+	mutex_init(&vfile->lock);
+	INIT_LIST_HEAD(&vfile->dmabufs);
+
+	filp->private_data = vfile;
+
+	return 0;
+}
+
+static int vpu_release(struct inode *inode, struct file *filp)
+{
+	struct vpu_file *vfile = filp->private_data;
+	struct vpu *vpu = vfile->vpu;
+	struct vpu_dmabuf *buf, *tmp;
+
+	list_for_each_entry_safe(buf, tmp, &vfile->dmabufs, list) {
+		list_del(&buf->list);
+		vpu_dmabuf_release(buf);
+	}
+
+	mutex_destroy(&vfile->lock);
+	kfree(vfile);
+
+	put_device(vpu->dev);
+	put_device(&vpu->rproc->dev);
+
+	return 0;
+}
+
+static const struct file_operations vpu_fops = {
+	.owner = THIS_MODULE,
+	.open = vpu_open,
+	.release = vpu_release,
+	.unlocked_ioctl = vpu_ioctl,
+	.compat_ioctl = compat_ptr_ioctl,
+	.llseek = noop_llseek,
+};
+
+static void ingenic_rproc_misc_deregister(void *d)
+{
+	misc_deregister(d);
+}
+
 static int ingenic_rproc_probe(struct platform_device *pdev)
 {
 	struct device *dev = &pdev->dev;
@@ -179,8 +417,12 @@ static int ingenic_rproc_probe(struct platform_device *pdev)
 
 	rproc->auto_boot = auto_boot;
 
+	/* The VPU is started and stopped around every video played */
+	rproc->keep_firmware = true;
+
 	vpu = rproc->priv;
 	vpu->dev = &pdev->dev;
+	vpu->rproc = rproc;
 	platform_set_drvdata(pdev, vpu);
 
 	mem = platform_get_resource_byname(pdev, IORESOURCE_MEM, "aux");
@@ -244,6 +486,22 @@ static int ingenic_rproc_probe(struct platform_device *pdev)
 		return ret;
 	}
 
+	vpu->miscdev.minor = MISC_DYNAMIC_MINOR;
+	vpu->miscdev.name = "ingenic-vpu";
+	vpu->miscdev.fops = &vpu_fops;
+	vpu->miscdev.parent = dev;
+
+	ret = misc_register(&vpu->miscdev);
+	if (ret) {
+		dev_err(dev, "Failed to register misc device\n");
+		return ret;
+	}
+
+	ret = devm_add_action_or_reset(dev, ingenic_rproc_misc_deregister,
+				       &vpu->miscdev);
+	if (ret)
+		return ret;
+
 	return 0;
 }
 
@@ -1304,6 +1304,47 @@ static int rproc_alloc_registered_carveouts(struct rproc *rproc)
 }
 
 
+/*
+ * Get the firmware image to boot @rproc with.  If the driver asked for the
+ * image to be kept, it is requested only on the first boot and kept in
+ * @rproc->fw_cache for the next ones.  Called with @rproc->lock held.
+ */
+static int rproc_request_firmware(struct rproc *rproc,
+				  const struct firmware **fw)
+{
+	int ret;
+
+	if (rproc->fw_cache) {
+		*fw = rproc->fw_cache;
+		return 0;
+	}
+
+	ret = request_firmware(fw, rproc->firmware, &rproc->dev);
+	if (ret < 0) {
+		dev_err(&rproc->dev, "request_firmware failed: %d\n", ret);
+		return ret;
+	}
+
+	if (rproc->keep_firmware)
+		rproc->fw_cache = *fw;
+
+	return 0;
+}
+
+static void rproc_release_firmware(struct rproc *rproc,
+				   const struct firmware *fw)
+{
+	if (fw != rproc->fw_cache)
+		release_firmware(fw);
+}
+
+/* Called with @rproc->lock held, or once the rproc is released. */
+static void rproc_drop_firmware_cache(struct rproc *rproc)
+{
+	release_firmware(rproc->fw_cache);
+	rproc->fw_cache = NULL;
+}
+
 /**
  * rproc_resource_cleanup() - clean up and free all acquired resources
  * @rproc: rproc handle
@@ -1905,16 +1946,16 @@ int rproc_trigger_recovery(struct rproc *rproc)
 	rproc->ops->coredump(rproc);
 
 	/* load firmware */
-	ret = request_firmware(&firmware_p, rproc->firmware, dev);
-	if (ret < 0) {
-		dev_err(dev, "request_firmware failed: %d\n", ret);
+	ret = rproc_request_firmware(rproc, &firmware_p);
+	if (ret < 0)
 		goto unlock_mutex;
-	}
 
 	/* boot the remote processor up again */
 	ret = rproc_start(rproc, firmware_p);
 
-	release_firmware(firmware_p);
+	rproc_release_firmware(rproc, firmware_p);
+	if (ret)
+		rproc_drop_firmware_cache(rproc);
 
 unlock_mutex:
 	mutex_unlock(&rproc->lock);
@@ -2005,15 +2046,16 @@ int rproc_boot(struct rproc *rproc)
 		dev_info(dev, "powering up %s\n", rproc->name);
 
 		/* load firmware */
-		ret = request_firmware(&firmware_p, rproc->firmware, dev);
-		if (ret < 0) {
-			dev_err(dev, "request_firmware failed: %d\n", ret);
+		ret = rproc_request_firmware(rproc, &firmware_p);
+		if (ret < 0)
 			goto downref_rproc;
-		}
 
 		ret = rproc_fw_boot(rproc, firmware_p);
 
-		release_firmware(firmware_p);
+		rproc_release_firmware(rproc, firmware_p);
+		/* Don't keep an image which failed to boot */
+		if (ret)
+			rproc_drop_firmware_cache(rproc);
 	}
 
 downref_rproc:
@@ -2247,6 +2289,7 @@ int rproc_set_firmware(struct rproc *rproc, const char *fw_name)
 
 	kfree_const(rproc->firmware);
 	rproc->firmware = p;
+	rproc_drop_firmware_cache(rproc);
 
 out:
 	mutex_unlock(&rproc->lock);
@@ -2397,6 +2440,7 @@ static void rproc_type_release(struct device *dev)
 	if (rproc->index >= 0)
 		ida_simple_remove(&rproc_dev_index, rproc->index);
 
+	rproc_drop_firmware_cache(rproc);
 	kfree_const(rproc->firmware);
 	kfree_const(rproc->name);
 	kfree(rproc->ops);
@@ -779,13 +779,28 @@ static void rpmsg_recv_done(struct virtqueue *rvq)
 		return;
 	}
 
-	while (msg) {
-		err = rpmsg_recv_single(vrp, dev, msg, len);
-		if (err)
-			break;
+	/*
+	 * The remote processor doesn't need to interrupt us for the messages
+	 * it sends while we're draining the ring, we'll see them anyway.
+	 */
+	virtqueue_disable_cb(rvq);
+
+	for (;;) {
+		while (msg) {
+			err = rpmsg_recv_single(vrp, dev, msg, len);
+			if (err)
+				break;
 
-		msgs_received++;
+			msgs_received++;
+
+			msg = virtqueue_get_buf(rvq, &len);
+		}
+
+		/* Catch the messages which raced with enabling interrupts */
+		if (virtqueue_enable_cb(rvq) || err)
+			break;
 
+		virtqueue_disable_cb(rvq);
 		msg = virtqueue_get_buf(rvq, &len);
 	}
 
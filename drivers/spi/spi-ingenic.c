@@ -48,6 +48,9 @@
 
 #define SPI_INGENIC_FIFO_SIZE		128u
 
+/* Maximum number of scatterlist entries of a batch of DMA transfers */
+#define SPI_INGENIC_MAX_BATCH_SG	64u
+
 struct jz_soc_info {
 	u32 bits_per_word_mask;
 	struct reg_field flen_field;
@@ -61,6 +64,16 @@ struct ingenic_spi {
 
 	struct regmap *map;
 	struct regmap_field *flen_field;
+
+	/* Clock divider and word size currently programmed */
+	u32 speed_hz, bits_per_word;
+	/* Word size the DMA channels are configured for */
+	unsigned int dma_bits;
+
+	/* Scatterlists of the current batch of DMA transfers */
+	struct sg_table batch_rx_sg, batch_tx_sg;
+	/* Last transfer of the current batch, if any */
+	struct spi_transfer *batch_last;
 };
 
 static int spi_ingenic_wait(struct ingenic_spi *priv,
@@ -100,12 +113,18 @@ static void spi_ingenic_prepare_transfer(struct ingenic_spi *priv,
 	u32 cdiv, speed_hz = xfer->speed_hz ?: spi->max_speed_hz,
 	    bits_per_word = xfer->bits_per_word ?: spi->bits_per_word;
 
-	cdiv = clk_hz / (speed_hz * 2);
-	cdiv = clamp(cdiv, 1u, 0x100u) - 1;
+	if (speed_hz != priv->speed_hz) {
+		cdiv = clk_hz / (speed_hz * 2);
+		cdiv = clamp(cdiv, 1u, 0x100u) - 1;
 
-	regmap_write(priv->map, REG_SSIGR, cdiv);
+		regmap_write(priv->map, REG_SSIGR, cdiv);
+		priv->speed_hz = speed_hz;
+	}
 
-	regmap_field_write(priv->flen_field, bits_per_word - 2);
+	if (bits_per_word != priv->bits_per_word) {
+		regmap_field_write(priv->flen_field, bits_per_word - 2);
+		priv->bits_per_word = bits_per_word;
+	}
 }
 
 static void spi_ingenic_finalize_transfer(void *controller)
@@ -113,22 +132,19 @@ static void spi_ingenic_finalize_transfer(void *controller)
 	spi_finalize_current_transfer(controller);
 }
 
-static int spi_ingenic_prepare_dma(struct spi_controller *ctlr,
-				   struct dma_chan *chan,
-				   struct sg_table *sg,
-				   enum dma_transfer_direction dir,
-				   unsigned int bits)
+static int spi_ingenic_config_dma(struct spi_controller *ctlr,
+				  unsigned int bits)
 {
 	struct ingenic_spi *priv = spi_controller_get_devdata(ctlr);
 	struct dma_slave_config cfg = {
-		.direction = dir,
 		.src_addr = priv->mem_res->start + REG_SSIDR,
 		.dst_addr = priv->mem_res->start + REG_SSIDR,
 	};
-	struct dma_async_tx_descriptor *desc;
-	dma_cookie_t cookie;
 	int ret;
 
+	if (bits == priv->dma_bits)
+		return 0;
+
 	if (bits > 16) {
 		cfg.src_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES;
 		cfg.dst_addr_width = DMA_SLAVE_BUSWIDTH_4_BYTES;
@@ -143,10 +159,30 @@ static int spi_ingenic_prepare_dma(struct spi_controller *ctlr,
 		cfg.src_maxburst = cfg.dst_maxburst = 1;
 	}
 
-	ret = dmaengine_slave_config(chan, &cfg);
+	cfg.direction = DMA_DEV_TO_MEM;
+	ret = dmaengine_slave_config(ctlr->dma_rx, &cfg);
 	if (ret)
 		return ret;
 
+	cfg.direction = DMA_MEM_TO_DEV;
+	ret = dmaengine_slave_config(ctlr->dma_tx, &cfg);
+	if (ret)
+		return ret;
+
+	priv->dma_bits = bits;
+
+	return 0;
+}
+
+static int spi_ingenic_prepare_dma(struct spi_controller *ctlr,
+				   struct dma_chan *chan,
+				   struct sg_table *sg,
+				   enum dma_transfer_direction dir)
+{
+	struct dma_async_tx_descriptor *desc;
+	dma_cookie_t cookie;
+	int ret;
+
 	desc = dmaengine_prep_slave_sg(chan, sg->sgl, sg->nents, dir,
 				       DMA_PREP_INTERRUPT);
 	if (!desc)
@@ -169,19 +205,24 @@ static int spi_ingenic_prepare_dma(struct spi_controller *ctlr,
 }
 
 static int spi_ingenic_dma_tx(struct spi_controller *ctlr,
-			      struct spi_transfer *xfer, unsigned int bits)
+			      struct sg_table *rx_sg, struct sg_table *tx_sg,
+			      unsigned int bits)
 {
 	int ret;
 
-	ret = spi_ingenic_prepare_dma(ctlr, ctlr->dma_rx,
-				      &xfer->rx_sg, DMA_DEV_TO_MEM, bits);
+	ret = spi_ingenic_config_dma(ctlr, bits);
 	if (ret)
 		return ret;
 
-	ret = spi_ingenic_prepare_dma(ctlr, ctlr->dma_tx,
-				      &xfer->tx_sg, DMA_MEM_TO_DEV, bits);
+	ret = spi_ingenic_prepare_dma(ctlr, ctlr->dma_rx, rx_sg,
+				      DMA_DEV_TO_MEM);
+	if (ret)
+		return ret;
+
+	ret = spi_ingenic_prepare_dma(ctlr, ctlr->dma_tx, tx_sg,
+				      DMA_MEM_TO_DEV);
 	if (ret) {
-		/* TODO: Unqueue and free up RX descriptor */
+		dmaengine_terminate_sync(ctlr->dma_rx);
 		return ret;
 	}
 
@@ -191,6 +232,135 @@ static int spi_ingenic_dma_tx(struct spi_controller *ctlr,
 	return 1;
 }
 
+static bool spi_ingenic_can_batch(struct spi_transfer *xfer,
+				  struct spi_transfer *next)
+{
+	return !xfer->cs_change && !xfer->delay.value &&
+		!xfer->word_delay.value && !next->word_delay.value &&
+		next->speed_hz == xfer->speed_hz &&
+		next->bits_per_word == xfer->bits_per_word;
+}
+
+/*
+ * Find how many of the transfers following @xfer in the current message can be
+ * sent along with it, as one DMA transaction per direction.
+ */
+static struct spi_transfer *
+spi_ingenic_find_batch(struct spi_controller *ctlr, struct spi_transfer *xfer,
+		       unsigned int *rx_nents, unsigned int *tx_nents)
+{
+	struct list_head *transfers = &ctlr->cur_msg->transfers;
+	unsigned int rx = xfer->rx_sg.nents, tx = xfer->tx_sg.nents;
+	unsigned int len = xfer->len;
+	struct spi_transfer *last = xfer, *next;
+
+	while (!list_is_last(&last->transfer_list, transfers)) {
+		next = list_next_entry(last, transfer_list);
+
+		/*
+		 * The SPI core only waits for the first transfer of the batch,
+		 * with a 200 ms tolerance; make sure the whole batch fits.
+		 */
+		if (!spi_ingenic_can_batch(last, next) ||
+		    rx + next->rx_sg.nents > SPI_INGENIC_MAX_BATCH_SG ||
+		    tx + next->tx_sg.nents > SPI_INGENIC_MAX_BATCH_SG ||
+		    len + next->len > xfer->speed_hz / 40)
+			break;
+
+		rx += next->rx_sg.nents;
+		tx += next->tx_sg.nents;
+		len += next->len;
+		last = next;
+	}
+
+	*rx_nents = rx;
+	*tx_nents = tx;
+
+	return last;
+}
+
+static int spi_ingenic_merge_sg(struct sg_table *sgt, unsigned int nents,
+				struct spi_transfer *first,
+				struct spi_transfer *last, bool rx)
+{
+	struct scatterlist *dst, *src;
+	struct spi_transfer *xfer;
+	struct sg_table *xfer_sgt;
+	unsigned int i;
+	int ret;
+
+	ret = sg_alloc_table(sgt, nents, GFP_KERNEL);
+	if (ret)
+		return ret;
+
+	dst = sgt->sgl;
+	xfer = first;
+
+	for (;;) {
+		xfer_sgt = rx ? &xfer->rx_sg : &xfer->tx_sg;
+
+		for_each_sg(xfer_sgt->sgl, src, xfer_sgt->nents, i) {
+			sg_dma_address(dst) = sg_dma_address(src);
+			sg_dma_len(dst) = sg_dma_len(src);
+			dst = sg_next(dst);
+		}
+
+		if (xfer == last)
+			break;
+
+		xfer = list_next_entry(xfer, transfer_list);
+	}
+
+	return 0;
+}
+
+static void spi_ingenic_free_batch(struct ingenic_spi *priv)
+{
+	sg_free_table(&priv->batch_rx_sg);
+	sg_free_table(&priv->batch_tx_sg);
+	priv->batch_last = NULL;
+}
+
+static int spi_ingenic_dma_tx_batch(struct spi_controller *ctlr,
+				    struct spi_transfer *xfer,
+				    unsigned int bits)
+{
+	struct ingenic_spi *priv = spi_controller_get_devdata(ctlr);
+	unsigned int rx_nents, tx_nents;
+	struct spi_transfer *last;
+	int ret;
+
+	last = spi_ingenic_find_batch(ctlr, xfer, &rx_nents, &tx_nents);
+	if (last == xfer)
+		return spi_ingenic_dma_tx(ctlr, &xfer->rx_sg, &xfer->tx_sg, bits);
+
+	spi_ingenic_free_batch(priv);
+
+	ret = spi_ingenic_merge_sg(&priv->batch_rx_sg, rx_nents,
+				   xfer, last, true);
+	if (ret)
+		goto out_free_batch;
+
+	ret = spi_ingenic_merge_sg(&priv->batch_tx_sg, tx_nents,
+				   xfer, last, false);
+	if (ret)
+		goto out_free_batch;
+
+	ret = spi_ingenic_dma_tx(ctlr, &priv->batch_rx_sg,
+				 &priv->batch_tx_sg, bits);
+	if (ret < 0)
+		goto out_free_batch;
+
+	priv->batch_last = last;
+
+	return ret;
+
+out_free_batch:
+	spi_ingenic_free_batch(priv);
+	/* Fall back to sending the transfers one by one. */
+	return spi_ingenic_dma_tx(ctlr, &xfer->rx_sg, &xfer->tx_sg, bits);
+}
+
 #define SPI_INGENIC_TX(x)							\
 static int spi_ingenic_tx##x(struct ingenic_spi *priv,				\
 			     struct spi_transfer *xfer)				\
@@ -239,10 +409,18 @@ static int spi_ingenic_transfer_one(struct spi_controller *ctlr,
 	struct ingenic_spi *priv = spi_controller_get_devdata(ctlr);
 	unsigned int bits = xfer->bits_per_word ?: spi->bits_per_word;
 
+	if (priv->batch_last) {
+		/* Already sent along with the previous transfers. */
+		if (xfer == priv->batch_last)
+			priv->batch_last = NULL;
+
+		return 0;
+	}
+
 	spi_ingenic_prepare_transfer(priv, spi, xfer);
 
 	if (ctlr->cur_msg_mapped && ctlr->can_dma)
-		return spi_ingenic_dma_tx(ctlr, xfer, bits);
+		return spi_ingenic_dma_tx_batch(ctlr, xfer, bits);
 
 	if (bits > 16)
 		return spi_ingenic_tx32(priv, xfer);
@@ -263,6 +441,8 @@ static int spi_ingenic_prepare_message(struct spi_controller *ctlr,
 	unsigned int ssicr1_mask = REG_SSICR1_PHA | REG_SSICR1_POL | cs;
 	unsigned int ssicr0 = 0, ssicr1 = 0;
 
+	priv->batch_last = NULL;
+
 	if (priv->soc_info->has_trendian) {
 		ssicr0_mask |= REG_SSICR0_RENDIAN_LSB | REG_SSICR0_TENDIAN_LSB;
 
@@ -293,6 +473,16 @@ static int spi_ingenic_prepare_message(struct spi_controller *ctlr,
 	return 0;
 }
 
+static int spi_ingenic_unprepare_message(struct spi_controller *ctlr,
+					 struct spi_message *message)
+{
+	struct ingenic_spi *priv = spi_controller_get_devdata(ctlr);
+
+	spi_ingenic_free_batch(priv);
+
+	return 0;
+}
+
 static int spi_ingenic_prepare_hardware(struct spi_controller *ctlr)
 {
 	struct ingenic_spi *priv = spi_controller_get_devdata(ctlr);
@@ -302,6 +492,9 @@ static int spi_ingenic_prepare_hardware(struct spi_controller *ctlr)
 	if (ret)
 		return ret;
 
+	priv->speed_hz = 0;
+	priv->bits_per_word = 0;
+
 	regmap_write(priv->map, REG_SSICR0, REG_SSICR0_EACLRUN);
 	regmap_write(priv->map, REG_SSICR1, 0);
 	regmap_write(priv->map, REG_SSISR, 0);
@@ -417,6 +610,7 @@ static int spi_ingenic_probe(struct platform_device *pdev)
 	ctlr->prepare_transfer_hardware = spi_ingenic_prepare_hardware;
 	ctlr->unprepare_transfer_hardware = spi_ingenic_unprepare_hardware;
 	ctlr->prepare_message = spi_ingenic_prepare_message;
+	ctlr->unprepare_message = spi_ingenic_unprepare_message;
 	ctlr->set_cs = spi_ingenic_set_cs;
 	ctlr->transfer_one = spi_ingenic_transfer_one;
 	ctlr->mode_bits = SPI_MODE_3 | SPI_LSB_FIRST | SPI_LOOP | SPI_CS_HIGH;
@@ -31,6 +31,7 @@ struct ingenic_uart_data {
 	struct clk	*clk_module;
 	struct clk	*clk_baud;
 	int		line;
+	struct uart_8250_dma dma;
 };
 
 static const struct of_device_id of_match[];
@@ -152,6 +153,10 @@ static void ingenic_uart_serial_out(struct uart_port *p, int offset, int value)
 	case UART_FCR:
 		/* UART module enable */
 		value |= UART_FCR_UME;
+
+		/* Raise DMA requests */
+		if (up_to_u8250p(p)->dma)
+			value |= UART_FCR_DMA_SELECT;
 		break;
 
 	case UART_IER:
@@ -248,6 +253,17 @@ static int ingenic_uart_probe(struct platform_device *pdev)
 	uart.tx_loadsz = cdata->tx_loadsz;
 	uart.capabilities = UART_CAP_FIFO | UART_CAP_RTOIE;
 
+	/*
+	 * Use the DMA channels if the device tree gives them. The core falls
+	 * back to PIO if they can't be requested, and never uses them for
+	 * the console.
+	 */
+	if (of_property_read_bool(pdev->dev.of_node, "dmas")) {
+		data->dma.rxconf.src_maxburst = cdata->fifosize / 4;
+		data->dma.txconf.dst_maxburst = cdata->fifosize / 4;
+		uart.dma = &data->dma;
+	}
+
 	/* Check for a fixed line number */
 	line = of_alias_get_id(pdev->dev.of_node, "serial");
 	if (line >= 0)
@@ -15,6 +15,7 @@
 /* #define VERBOSE_DEBUG */
 
 #include <linux/blkdev.h>
+#include <linux/dma-mapping.h>
 #include <linux/pagemap.h>
 #include <linux/export.h>
 #include <linux/fs_parser.h>
@@ -226,6 +227,10 @@ struct ffs_io_data {
 	struct sg_table sgt;
 	bool use_sg;
 
+	/* User pages the request maps directly, instead of buf */
+	struct page **pages;
+	unsigned int n_pages;
+
 	struct ffs_data *ffs;
 };
 
@@ -804,8 +809,72 @@ static inline void *ffs_alloc_buffer(struct ffs_io_data *io_data,
 	return kmalloc(data_len, GFP_KERNEL);
 }
 
+/*
+ * Map the user buffer itself as the scatterlist of the request, so that
+ * large transfers on controllers doing scatter-gather skip the copy through
+ * a bounce buffer. Only done for a single user segment, aligned so that the
+ * DMA does not share a cache line with unrelated data, and not padded for
+ * the controller; returns false if the bounce buffer has to be used.
+ */
+static bool ffs_get_user_pages(struct ffs_io_data *io_data, size_t data_len)
+{
+	struct iov_iter *iter = &io_data->data;
+	unsigned long addr;
+	size_t offset;
+	ssize_t len;
+
+	if (!iter_is_iovec(iter) || iter->nr_segs != 1 ||
+	    iov_iter_count(iter) != data_len)
+		return false;
+
+	addr = (unsigned long)iter->iov->iov_base + iter->iov_offset;
+	if (!IS_ALIGNED(addr | data_len, dma_get_cache_alignment()))
+		return false;
+
+	len = iov_iter_get_pages_alloc(iter, &io_data->pages, data_len, &offset);
+	if (len < 0) {
+		io_data->pages = NULL;
+		return false;
+	}
+
+	io_data->n_pages = DIV_ROUND_UP(offset + len, PAGE_SIZE);
+	if (len != data_len ||
+	    sg_alloc_table_from_pages(&io_data->sgt, io_data->pages,
+				      io_data->n_pages, offset, len,
+				      GFP_KERNEL)) {
+		release_pages(io_data->pages, io_data->n_pages);
+		kvfree(io_data->pages);
+		io_data->pages = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+static void ffs_put_user_pages(struct ffs_io_data *io_data)
+{
+	unsigned int i;
+
+	sg_free_table(&io_data->sgt);
+
+	for (i = 0; i < io_data->n_pages; i++) {
+		/* The controller wrote to the pages of a read */
+		if (io_data->read)
+			set_page_dirty_lock(io_data->pages[i]);
+		put_page(io_data->pages[i]);
+	}
+
+	kvfree(io_data->pages);
+	io_data->pages = NULL;
+}
+
 static inline void ffs_free_buffer(struct ffs_io_data *io_data)
 {
+	if (io_data->pages) {
+		ffs_put_user_pages(io_data);
+		return;
+	}
+
 	if (!io_data->buf)
 		return;
 
@@ -825,7 +894,7 @@ static void ffs_user_copy_worker(struct work_struct *work)
 					 io_data->req->actual;
 	bool kiocb_has_eventfd = io_data->kiocb->ki_flags & IOCB_EVENTFD;
 
-	if (io_data->read && ret > 0) {
+	if (io_data->read && ret > 0 && !io_data->pages) {
 		kthread_use_mm(io_data->mm);
 		ret = ffs_copy_to_iter(io_data->buf, ret, &io_data->data);
 		kthread_unuse_mm(io_data->mm);
@@ -1014,15 +1083,21 @@ static ssize_t ffs_epfile_io(struct file *file, struct ffs_io_data *io_data)
 		io_data->use_sg = gadget->sg_supported && data_len > PAGE_SIZE;
 		spin_unlock_irq(&epfile->ffs->eps_lock);
 
-		data = ffs_alloc_buffer(io_data, data_len);
-		if (!data) {
-			ret = -ENOMEM;
-			goto error_mutex;
-		}
-		if (!io_data->read &&
-		    !copy_from_iter_full(data, data_len, &io_data->data)) {
-			ret = -EFAULT;
-			goto error_mutex;
+		if (io_data->use_sg && ffs_get_user_pages(io_data, data_len)) {
+			/* A read advances the iterator once it completes */
+			if (!io_data->read)
+				iov_iter_advance(&io_data->data, data_len);
+		} else {
+			data = ffs_alloc_buffer(io_data, data_len);
+			if (!data) {
+				ret = -ENOMEM;
+				goto error_mutex;
+			}
+			if (!io_data->read &&
+			    !copy_from_iter_full(data, data_len, &io_data->data)) {
+				ret = -EFAULT;
+				goto error_mutex;
+			}
 		}
 	}
 
@@ -1087,13 +1162,17 @@ static ssize_t ffs_epfile_io(struct file *file, struct ffs_io_data *io_data)
 			interrupted = ep->status < 0;
 		}
 
-		if (interrupted)
+		if (interrupted) {
 			ret = -EINTR;
-		else if (io_data->read && ep->status > 0)
+		} else if (io_data->read && ep->status > 0 && io_data->pages) {
+			iov_iter_advance(&io_data->data, ep->status);
+			ret = ep->status;
+		} else if (io_data->read && ep->status > 0) {
 			ret = __ffs_epfile_read_data(epfile, data, ep->status,
 						     &io_data->data);
-		else
+		} else {
 			ret = ep->status;
+		}
 		goto error_mutex;
 	} else if (!(req = usb_ep_alloc_request(ep->ep, GFP_ATOMIC))) {
 		ret = -ENOMEM;
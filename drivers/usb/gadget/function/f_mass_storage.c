@@ -203,6 +203,7 @@
 #include <linux/dcache.h>
 #include <linux/delay.h>
 #include <linux/device.h>
+#include <linux/fadvise.h>
 #include <linux/fcntl.h>
 #include <linux/file.h>
 #include <linux/fs.h>
@@ -232,6 +233,9 @@
 #define FSG_DRIVER_DESC		"Mass Storage Function"
 #define FSG_DRIVER_VERSION	"2009/09/11"
 
+/* Writes at least this large start the writeback of the backing file */
+#define FSG_WRITEBACK_MIN	(4 * FSG_BUFLEN)
+
 static const char fsg_string_interface[] = "Mass Storage";
 
 #include "storage_common.h"
@@ -656,6 +660,15 @@ static int do_read(struct fsg_common *common)
 	if (unlikely(amount_left == 0))
 		return -EIO;		/* No default reply */
 
+	/*
+	 * The reads below only ask for one buffer at a time, which keeps the
+	 * readahead window small. Start reading the whole transfer now, so
+	 * that the backing storage works while the buffers go over USB.
+	 */
+	if (amount_left > FSG_BUFLEN)
+		vfs_fadvise(curlun->filp, file_offset, amount_left,
+			    POSIX_FADV_WILLNEED);
+
 	for (;;) {
 		/*
 		 * Figure out how much we need to read:
@@ -923,6 +936,16 @@ static int do_write(struct fsg_common *common)
 		}
 	}
 
+	/*
+	 * Large writes are file data being streamed: start writing it back
+	 * now, without waiting, rather than letting the dirty pages pile up
+	 * until the writer gets throttled. Small writes are mostly metadata
+	 * of the host filesystem, which it will rewrite soon.
+	 */
+	if (common->data_size_from_cmnd >= FSG_WRITEBACK_MIN &&
+	    !(curlun->filp->f_flags & O_SYNC))
+		filemap_flush(curlun->filp->f_mapping);
+
 	return -EIO;		/* No default reply */
 }
 
@@ -16,6 +16,7 @@
 #include <linux/module.h>
 #include <linux/device.h>
 #include <linux/etherdevice.h>
+#include <linux/hrtimer.h>
 
 #include <linux/atomic.h>
 
@@ -77,6 +78,10 @@ struct f_rndis {
 	struct usb_ep			*notify;
 	struct usb_request		*notify_req;
 	atomic_t			notify_count;
+
+	/* transfer being filled with several packets, see rndis_add_header */
+	struct sk_buff			*tx_skb;
+	struct hrtimer			tx_timer;
 };
 
 static inline struct f_rndis *func_to_rndis(struct usb_function *f)
@@ -367,21 +372,114 @@ static struct usb_gadget_strings *rndis_strings[] = {
 
 /*-------------------------------------------------------------------------*/
 
+/*
+ * Hosts may accept several packet messages in one transfer; Windows asks for
+ * up to 16 KiB.  While the network stack has more packets for us, they are
+ * packed together, and the transfer is sent when the stack is done or the
+ * transfer is full.  The timer sends a transfer left pending because the
+ * last packet didn't fit in it, or because no request was free.
+ */
+#define RNDIS_TX_MAX_SIZE	16384
+#define RNDIS_TX_ALIGN		8
+#define RNDIS_TX_TIMEOUT_NSECS	300000
+
+static struct sk_buff *rndis_tx_flush(struct f_rndis *rndis)
+{
+	struct sk_buff *skb = rndis->tx_skb;
+
+	rndis->tx_skb = NULL;
+	return skb;
+}
+
+static struct sk_buff *rndis_tx_pack(struct f_rndis *rndis,
+				     struct sk_buff *skb, u32 max_size)
+{
+	struct rndis_packet_msg_type *header;
+	struct sk_buff *skb2 = NULL;
+	u32 len;
+
+	len = ALIGN(sizeof(*header) + skb->len, RNDIS_TX_ALIGN);
+	if (rndis->tx_skb && rndis->tx_skb->len + len > max_size)
+		skb2 = rndis_tx_flush(rndis);
+
+	if (!rndis->tx_skb) {
+		rndis->tx_skb = alloc_skb(max(max_size, len), GFP_ATOMIC);
+		if (!rndis->tx_skb) {
+			rndis->params->dev->stats.tx_dropped++;
+			dev_kfree_skb_any(skb);
+			return skb2;
+		}
+		rndis->tx_skb->dev = skb->dev;
+		hrtimer_start(&rndis->tx_timer, RNDIS_TX_TIMEOUT_NSECS,
+			      HRTIMER_MODE_REL_SOFT);
+	}
+
+	/* MessageLength includes the padding up to the next message */
+	header = skb_put_zero(rndis->tx_skb, sizeof(*header));
+	header->MessageType = cpu_to_le32(RNDIS_MSG_PACKET);
+	header->MessageLength = cpu_to_le32(len);
+	header->DataOffset = cpu_to_le32(36);
+	header->DataLength = cpu_to_le32(skb->len);
+	skb_copy_bits(skb, 0, skb_put(rndis->tx_skb, skb->len), skb->len);
+	skb_put_zero(rndis->tx_skb, len - sizeof(*header) - skb->len);
+	dev_consume_skb_any(skb);
+
+	if (!skb2 && !netdev_xmit_more())
+		skb2 = rndis_tx_flush(rndis);
+
+	return skb2;
+}
+
 static struct sk_buff *rndis_add_header(struct gether *port,
 					struct sk_buff *skb)
 {
+	struct f_rndis *rndis = func_to_rndis(&port->func);
+	u32 max_size;
 	struct sk_buff *skb2;
 
+	/* called back by rndis_tx_timeout() */
 	if (!skb)
-		return NULL;
+		return rndis_tx_flush(rndis);
+
+	max_size = min_t(u32, rndis->params->host_max_xfer_size,
+			 RNDIS_TX_MAX_SIZE);
+	if (rndis->tx_skb || (netdev_xmit_more() &&
+			      max_size >= 2 * (sizeof(struct rndis_packet_msg_type)
+					       + skb->len)))
+		return rndis_tx_pack(rndis, skb, max_size);
 
 	skb2 = skb_realloc_headroom(skb, sizeof(struct rndis_packet_msg_type));
 	rndis_add_hdr(skb2);
+	if (!skb2)
+		rndis->params->dev->stats.tx_dropped++;
 
 	dev_kfree_skb(skb);
 	return skb2;
 }
 
+static enum hrtimer_restart rndis_tx_timeout(struct hrtimer *timer)
+{
+	struct f_rndis *rndis = container_of(timer, struct f_rndis, tx_timer);
+	struct net_device *net = rndis->params->dev;
+	bool pending;
+
+	netif_tx_lock(net);
+	if (rndis->tx_skb)
+		net->netdev_ops->ndo_start_xmit(NULL, net);
+	pending = rndis->tx_skb != NULL;
+	netif_tx_unlock(net);
+
+	/*
+	 * Try again later if no request was free, unless the port was
+	 * disconnected meanwhile.
+	 */
+	if (!pending || !netif_carrier_ok(net))
+		return HRTIMER_NORESTART;
+
+	hrtimer_forward_now(timer, ns_to_ktime(RNDIS_TX_TIMEOUT_NSECS));
+	return HRTIMER_RESTART;
+}
+
 static void rndis_response_available(void *_rndis)
 {
 	struct f_rndis			*rndis = _rndis;
@@ -591,6 +689,12 @@ static int rndis_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 		 */
 		rndis->port.cdc_filter = 0;
 
+		/*
+		 * Drop what was packed for the previous connection. Nothing is
+		 * packed while the port is disconnected.
+		 */
+		dev_kfree_skb_any(rndis_tx_flush(rndis));
+
 		DBG(cdev, "RNDIS RX/TX early activation ... \n");
 		net = gether_connect(&rndis->port);
 		if (IS_ERR(net))
@@ -619,6 +723,13 @@ static void rndis_disable(struct usb_function *f)
 	rndis_uninit(rndis->params);
 	gether_disconnect(&rndis->port);
 
+	/*
+	 * This may run in interrupt context, where the timer can't be waited
+	 * for. Once disconnected, it won't send the pending transfer anymore,
+	 * which is freed at the next connection or at unbind.
+	 */
+	hrtimer_try_to_cancel(&rndis->tx_timer);
+
 	usb_ep_disable(rndis->notify);
 	rndis->notify->desc = NULL;
 }
@@ -971,6 +1082,9 @@ static void rndis_unbind(struct usb_configuration *c, struct usb_function *f)
 {
 	struct f_rndis		*rndis = func_to_rndis(f);
 
+	hrtimer_cancel(&rndis->tx_timer);
+	dev_kfree_skb_any(rndis_tx_flush(rndis));
+
 	kfree(f->os_desc_table);
 	f->os_desc_n = 0;
 	usb_free_all_descriptors(f);
@@ -1007,6 +1121,9 @@ static struct usb_function *rndis_alloc(struct usb_function_instance *fi)
 	rndis->port.header_len = sizeof(struct rndis_packet_msg_type);
 	rndis->port.wrap = rndis_add_header;
 	rndis->port.unwrap = rndis_rm_hdr;
+	rndis->port.supports_multi_frame = true;
+	hrtimer_init(&rndis->tx_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_SOFT);
+	rndis->tx_timer.function = rndis_tx_timeout;
 
 	rndis->port.func.name = "rndis";
 	/* descriptors are per-instance copies */
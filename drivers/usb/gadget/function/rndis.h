@@ -164,6 +164,7 @@ typedef struct rndis_params {
 	u32			medium;
 	u32			speed;
 	u32			media_state;
+	u32			host_max_xfer_size;	/* from the host's INIT */
 
 	const u8		*host_mac;
 	u16			*filter;
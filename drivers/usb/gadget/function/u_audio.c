@@ -13,6 +13,7 @@
  */
 
 #include <linux/module.h>
+#include <asm/unaligned.h>
 #include <sound/core.h>
 #include <sound/pcm.h>
 #include <sound/pcm_params.h>
@@ -23,6 +24,14 @@
 #define PRD_SIZE_MAX	PAGE_SIZE
 #define MIN_PERIODS	4
 
+/*
+ * The capture rate reported on the feedback endpoint is measured over windows
+ * of one second, smoothed over FBACK_SMOOTH windows, and kept within
+ * 1/FBACK_MAX_DEV of the nominal rate.
+ */
+#define FBACK_SMOOTH	8
+#define FBACK_MAX_DEV	200
+
 /* Runtime data params for one stream */
 struct uac_rtd_params {
 	struct snd_uac_chip *uac; /* parent chip */
@@ -38,6 +47,9 @@ struct uac_rtd_params {
 	unsigned int max_psize;	/* MaxPacketSize of endpoint */
 
 	struct usb_request **reqs;
+
+	bool fb_ep_enabled; /* if the feedback ep is enabled */
+	struct usb_request *req_fback;
 };
 
 struct snd_uac_chip {
@@ -57,6 +69,12 @@ struct snd_uac_chip {
 	unsigned int p_pktsize;
 	unsigned int p_pktsize_residue;
 	unsigned int p_framesize;
+
+	/* capture rate measurement, for the feedback endpoint */
+	unsigned int c_interval;	/* OUT packets per second */
+	unsigned int c_fb_packets;	/* packets in the current window */
+	snd_pcm_uframes_t c_fb_appl_ptr; /* appl_ptr when it started */
+	u32 c_fback;			/* samples per ms, Q16.16 */
 };
 
 static const struct snd_pcm_hardware uac_pcm_hardware = {
@@ -70,6 +88,96 @@ static const struct snd_pcm_hardware uac_pcm_hardware = {
 	.periods_min = MIN_PERIODS,
 };
 
+static u32 u_audio_nominal_fback(struct snd_uac_chip *uac)
+{
+	return div_u64((u64)uac->audio_dev->params.c_srate << 16, 1000);
+}
+
+/*
+ * Measure how fast the application reads the capture stream, against the
+ * USB frame clock given by the OUT packets.  The host then sends samples at
+ * the rate the application consumes them, instead of its own, so the buffer
+ * neither overruns nor runs dry because of drift between the two clocks.
+ *
+ * Called for each OUT packet, with the stream locked and running.
+ */
+static void u_audio_fback_update(struct snd_uac_chip *uac,
+				 struct snd_pcm_runtime *runtime)
+{
+	snd_pcm_uframes_t appl_ptr = runtime->control->appl_ptr;
+	u32 nominal, rate;
+	s64 frames;
+
+	if (!uac->c_fb_packets++) {
+		uac->c_fb_appl_ptr = appl_ptr;
+		return;
+	}
+
+	if (uac->c_fb_packets <= uac->c_interval)
+		return;
+
+	frames = (s64)appl_ptr - uac->c_fb_appl_ptr;
+	if (frames < 0)
+		frames += runtime->boundary;
+
+	/* frames per ms, over c_fb_packets - 1 packet intervals */
+	rate = div_u64((u64)frames * uac->c_interval << 16,
+		       (uac->c_fb_packets - 1) * 1000);
+
+	nominal = u_audio_nominal_fback(uac);
+	rate = clamp(rate, nominal - nominal / FBACK_MAX_DEV,
+		     nominal + nominal / FBACK_MAX_DEV);
+
+	WRITE_ONCE(uac->c_fback, uac->c_fback +
+		   ((s32)(rate - uac->c_fback)) / FBACK_SMOOTH);
+
+	uac->c_fb_packets = 1;
+	uac->c_fb_appl_ptr = appl_ptr;
+}
+
+/*
+ * Encode the capture rate for the host: in samples per frame as Q10.14 on
+ * three bytes at full speed, in samples per microframe as Q16.16 otherwise.
+ */
+static void u_audio_set_fback(struct snd_uac_chip *uac, struct usb_request *req)
+{
+	u32 ff = READ_ONCE(uac->c_fback);
+
+	if (uac->audio_dev->gadget->speed == USB_SPEED_FULL)
+		ff >>= 2;
+	else
+		ff >>= 3;
+
+	put_unaligned_le32(ff, req->buf);
+}
+
+static void u_audio_iso_fback_complete(struct usb_ep *ep,
+				       struct usb_request *req)
+{
+	struct uac_rtd_params *prm = req->context;
+	struct snd_uac_chip *uac = prm->uac;
+	int status = req->status;
+
+	/* i/f shutting down */
+	if (!prm->fb_ep_enabled) {
+		kfree(req->buf);
+		usb_ep_free_request(ep, req);
+		return;
+	}
+
+	if (req->status == -ESHUTDOWN)
+		return;
+
+	if (status)
+		pr_debug("%s: iso_complete status(%d) %d/%d\n",
+			__func__, status, req->actual, req->length);
+
+	u_audio_set_fback(uac, req);
+
+	if (usb_ep_queue(ep, req, GFP_ATOMIC))
+		dev_err(uac->card->dev, "%d Error!\n", __LINE__);
+}
+
 static void u_audio_iso_complete(struct usb_ep *ep, struct usb_request *req)
 {
 	unsigned int pending;
@@ -163,6 +271,9 @@ static void u_audio_iso_complete(struct usb_ep *ep, struct usb_request *req)
 	/* update hw_ptr after data is copied to memory */
 	prm->hw_ptr = (hw_ptr + req->actual) % runtime->dma_bytes;
 	hw_ptr = prm->hw_ptr;
+
+	if (prm->fb_ep_enabled)
+		u_audio_fback_update(uac, runtime);
 	snd_pcm_stream_unlock(substream);
 
 	if ((hw_ptr % snd_pcm_lib_period_bytes(substream)) < req->actual)
@@ -191,6 +302,8 @@ static int uac_pcm_trigger(struct snd_pcm_substream *substream, int cmd)
 
 	/* Reset */
 	prm->hw_ptr = 0;
+	if (substream->stream == SNDRV_PCM_STREAM_CAPTURE)
+		uac->c_fb_packets = 0;
 
 	switch (cmd) {
 	case SNDRV_PCM_TRIGGER_START:
@@ -335,6 +448,27 @@ static inline void free_ep(struct uac_rtd_params *prm, struct usb_ep *ep)
 		dev_err(uac->card->dev, "%s:%d Error!\n", __func__, __LINE__);
 }
 
+static inline void free_ep_fback(struct uac_rtd_params *prm, struct usb_ep *ep)
+{
+	struct snd_uac_chip *uac = prm->uac;
+
+	if (!prm->fb_ep_enabled)
+		return;
+
+	prm->fb_ep_enabled = false;
+
+	if (prm->req_fback) {
+		if (usb_ep_dequeue(ep, prm->req_fback)) {
+			kfree(prm->req_fback->buf);
+			usb_ep_free_request(ep, prm->req_fback);
+		}
+		prm->req_fback = NULL;
+	}
+
+	if (usb_ep_disable(ep))
+		dev_err(uac->card->dev, "%s:%d Error!\n", __func__, __LINE__);
+}
+
 
 int u_audio_start_capture(struct g_audio *audio_dev)
 {
@@ -342,9 +476,10 @@ int u_audio_start_capture(struct g_audio *audio_dev)
 	struct usb_gadget *gadget = audio_dev->gadget;
 	struct device *dev = &gadget->dev;
 	struct usb_request *req;
-	struct usb_ep *ep;
+	struct usb_ep *ep, *ep_fback;
 	struct uac_rtd_params *prm;
 	struct uac_params *params = &audio_dev->params;
+	unsigned int factor;
 	int req_len, i;
 
 	ep = audio_dev->out_ep;
@@ -352,6 +487,13 @@ int u_audio_start_capture(struct g_audio *audio_dev)
 	config_ep_by_speed(gadget, &audio_dev->func, ep);
 	req_len = ep->maxpacket;
 
+	/* pre-calculate the capture endpoint's interval */
+	if (gadget->speed == USB_SPEED_FULL)
+		factor = 1000;
+	else
+		factor = 8000;
+	uac->c_interval = factor / (1 << (ep->desc->bInterval - 1));
+
 	prm->ep_enabled = true;
 	usb_ep_enable(ep);
 
@@ -374,6 +516,40 @@ int u_audio_start_capture(struct g_audio *audio_dev)
 			dev_err(dev, "%s:%d Error!\n", __func__, __LINE__);
 	}
 
+	ep_fback = audio_dev->in_ep_fback;
+	if (!ep_fback)
+		return 0;
+
+	/* Start from the nominal rate until the first measurement */
+	uac->c_fback = u_audio_nominal_fback(uac);
+	uac->c_fb_packets = 0;
+
+	config_ep_by_speed(gadget, &audio_dev->func, ep_fback);
+	prm->fb_ep_enabled = true;
+	usb_ep_enable(ep_fback);
+
+	req = usb_ep_alloc_request(ep_fback, GFP_ATOMIC);
+	if (req == NULL)
+		return -ENOMEM;
+
+	/* Room for the four bytes u_audio_set_fback() writes */
+	req->buf = kzalloc(sizeof(u32), GFP_ATOMIC);
+	if (!req->buf) {
+		usb_ep_free_request(ep_fback, req);
+		return -ENOMEM;
+	}
+
+	prm->req_fback = req;
+
+	req->zero = 0;
+	req->context = prm;
+	req->length = min_t(unsigned int, ep_fback->maxpacket, sizeof(u32));
+	req->complete = u_audio_iso_fback_complete;
+	u_audio_set_fback(uac, req);
+
+	if (usb_ep_queue(ep_fback, req, GFP_ATOMIC))
+		dev_err(dev, "%s:%d Error!\n", __func__, __LINE__);
+
 	return 0;
 }
 EXPORT_SYMBOL_GPL(u_audio_start_capture);
@@ -382,6 +558,8 @@ void u_audio_stop_capture(struct g_audio *audio_dev)
 {
 	struct snd_uac_chip *uac = audio_dev->uac;
 
+	if (audio_dev->in_ep_fback)
+		free_ep_fback(&uac->c_prm, audio_dev->in_ep_fback);
 	free_ep(&uac->c_prm, audio_dev->out_ep);
 }
 EXPORT_SYMBOL_GPL(u_audio_stop_capture);
@@ -31,6 +31,8 @@ struct g_audio {
 
 	struct usb_ep *in_ep;
 	struct usb_ep *out_ep;
+	/* feedback IN endpoint of an asynchronous out_ep, or NULL */
+	struct usb_ep *in_ep_fback;
 
 	/* Max packet size for all in_ep possible speeds */
 	unsigned int in_ep_maxpsize;
@@ -63,7 +63,9 @@ struct eth_dev {
 	struct list_head	tx_reqs, rx_reqs;
 	atomic_t		tx_qlen;
 
+	/* frames received, waiting for eth_poll() */
 	struct sk_buff_head	rx_frames;
+	struct napi_struct	napi;
 
 	unsigned		qmult;
 
@@ -89,6 +91,9 @@ struct eth_dev {
 
 #define RX_EXTRA	20	/* bytes guarding against rx overflows */
 
+/* frames waiting for eth_poll(); more are dropped, like a full backlog */
+#define RX_FRAMES_MAX	1000
+
 #define DEFAULT_QLEN	2	/* double buffering by default */
 
 /* for dual-speed hardware, use deeper queues at high/super speed */
@@ -254,56 +259,56 @@ rx_submit(struct eth_dev *dev, struct usb_request *req, gfp_t gfp_flags)
 
 static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 {
-	struct sk_buff	*skb = req->context, *skb2;
+	struct sk_buff	*skb = req->context;
 	struct eth_dev	*dev = ep->driver_data;
 	int		status = req->status;
+	struct sk_buff_head frames;
+	unsigned long	flags;
 
 	switch (status) {
 
 	/* normal completion */
 	case 0:
 		skb_put(skb, req->actual);
+		skb_queue_head_init(&frames);
 
 		if (dev->unwrap) {
-			unsigned long	flags;
-
 			spin_lock_irqsave(&dev->lock, flags);
 			if (dev->port_usb) {
 				status = dev->unwrap(dev->port_usb,
 							skb,
-							&dev->rx_frames);
+							&frames);
 			} else {
 				dev_kfree_skb_any(skb);
 				status = -ENOTCONN;
 			}
 			spin_unlock_irqrestore(&dev->lock, flags);
 		} else {
-			skb_queue_tail(&dev->rx_frames, skb);
+			__skb_queue_tail(&frames, skb);
 		}
 		skb = NULL;
 
-		skb2 = skb_dequeue(&dev->rx_frames);
-		while (skb2) {
-			if (status < 0
-					|| ETH_HLEN > skb2->len
-					|| skb2->len > GETHER_MAX_ETH_FRAME_LEN) {
-				dev->net->stats.rx_errors++;
-				dev->net->stats.rx_length_errors++;
-				DBG(dev, "rx length %d\n", skb2->len);
-				dev_kfree_skb_any(skb2);
-				goto next_frame;
-			}
-			skb2->protocol = eth_type_trans(skb2, dev->net);
-			dev->net->stats.rx_packets++;
-			dev->net->stats.rx_bytes += skb2->len;
+		if (status < 0) {
+			dev->net->stats.rx_errors++;
+			dev->net->stats.rx_length_errors++;
+			DBG(dev, "rx unwrap %d\n", status);
+			skb_queue_purge(&frames);
+			break;
+		}
 
-			/* no buffer copies needed, unless hardware can't
-			 * use skb buffers.
-			 */
-			status = netif_rx(skb2);
-next_frame:
-			skb2 = skb_dequeue(&dev->rx_frames);
+		/* hand the frames over to eth_poll(), for GRO */
+		spin_lock_irqsave(&dev->rx_frames.lock, flags);
+		while (skb_queue_len(&dev->rx_frames) < RX_FRAMES_MAX &&
+		       (skb = __skb_dequeue(&frames)))
+			__skb_queue_tail(&dev->rx_frames, skb);
+		spin_unlock_irqrestore(&dev->rx_frames.lock, flags);
+		skb = NULL;
+
+		if (!skb_queue_empty(&frames)) {
+			dev->net->stats.rx_dropped += skb_queue_len(&frames);
+			skb_queue_purge(&frames);
 		}
+		napi_schedule(&dev->napi);
 		break;
 
 	/* software-driven interface shutdown */
@@ -344,6 +349,47 @@ static void rx_complete(struct usb_ep *ep, struct usb_request *req)
 		rx_submit(dev, req, GFP_ATOMIC);
 }
 
+/*
+ * Frames are passed up from NAPI context rather than with netif_rx() from
+ * the completion handler, so that GRO can merge those of a TCP stream into
+ * fewer, larger packets for the network stack.
+ */
+static int eth_poll(struct napi_struct *napi, int budget)
+{
+	struct eth_dev	*dev = container_of(napi, struct eth_dev, napi);
+	struct sk_buff	*skb;
+	int		work_done = 0;
+
+	while (work_done < budget) {
+		skb = skb_dequeue(&dev->rx_frames);
+		if (!skb)
+			break;
+		work_done++;
+
+		if (ETH_HLEN > skb->len
+				|| skb->len > GETHER_MAX_ETH_FRAME_LEN) {
+			dev->net->stats.rx_errors++;
+			dev->net->stats.rx_length_errors++;
+			DBG(dev, "rx length %d\n", skb->len);
+			dev_kfree_skb_any(skb);
+			continue;
+		}
+		skb->protocol = eth_type_trans(skb, dev->net);
+		dev->net->stats.rx_packets++;
+		dev->net->stats.rx_bytes += skb->len;
+
+		/* no buffer copies needed, unless hardware can't
+		 * use skb buffers.
+		 */
+		napi_gro_receive(napi, skb);
+	}
+
+	if (work_done < budget)
+		napi_complete_done(napi, work_done);
+
+	return work_done;
+}
+
 static int prealloc(struct list_head *list, struct usb_ep *ep, unsigned n)
 {
 	unsigned		i;
@@ -627,6 +673,7 @@ static int eth_open(struct net_device *net)
 	struct gether	*link;
 
 	DBG(dev, "%s\n", __func__);
+	napi_enable(&dev->napi);
 	if (netif_carrier_ok(dev->net))
 		eth_start(dev, GFP_KERNEL);
 
@@ -646,6 +693,8 @@ static int eth_stop(struct net_device *net)
 
 	VDBG(dev, "%s\n", __func__);
 	netif_stop_queue(net);
+	napi_disable(&dev->napi);
+	skb_queue_purge(&dev->rx_frames);
 
 	DBG(dev, "stop stats: rx/tx %ld/%ld, errs %ld/%ld\n",
 		dev->net->stats.rx_packets, dev->net->stats.tx_packets,
@@ -766,6 +815,7 @@ struct eth_dev *gether_setup_name(struct usb_gadget *g,
 	INIT_LIST_HEAD(&dev->rx_reqs);
 
 	skb_queue_head_init(&dev->rx_frames);
+	netif_napi_add(net, &dev->napi, eth_poll, NAPI_POLL_WEIGHT);
 
 	/* network device setup */
 	dev->net = net;
@@ -832,6 +882,7 @@ struct net_device *gether_setup_name_default(const char *netname)
 	INIT_LIST_HEAD(&dev->rx_reqs);
 
 	skb_queue_head_init(&dev->rx_frames);
+	netif_napi_add(net, &dev->napi, eth_poll, NAPI_POLL_WEIGHT);
 
 	/* network device setup */
 	dev->net = net;
@@ -1198,6 +1249,7 @@ void gether_disconnect(struct gether *link)
 	}
 	spin_unlock(&dev->req_lock);
 	link->out_ep->desc = NULL;
+	skb_queue_purge(&dev->rx_frames);
 
 	/* finish forgetting about this USB link episode */
 	dev->header_len = 0;
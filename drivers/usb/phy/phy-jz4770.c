@@ -10,6 +10,7 @@
 #include <linux/io.h>
 #include <linux/module.h>
 #include <linux/platform_device.h>
+#include <linux/pm_runtime.h>
 #include <linux/regulator/consumer.h>
 #include <linux/usb/otg.h>
 #include <linux/usb/phy.h>
@@ -109,8 +110,18 @@ struct jz4770_phy {
 	void __iomem *base;
 	struct clk *clk;
 	struct regulator *vcc_supply;
+
+	bool initialized;
+	bool suspended;
+	bool powered_down;
 };
 
+/* Time for the PHY to be usable again once SIDDQ is deasserted */
+#define JZ4770_PHY_SIDDQ_SETTLE_US	30
+
+/* Delay before a suspended PHY actually gets powered down */
+#define JZ4770_PHY_AUTOSUSPEND_MS	500
+
 static inline struct jz4770_phy *otg_to_jz4770_phy(struct usb_otg *otg)
 {
 	return container_of(otg, struct jz4770_phy, otg);
@@ -121,12 +132,40 @@ static inline struct jz4770_phy *phy_to_jz4770_phy(struct usb_phy *phy)
 	return container_of(phy, struct jz4770_phy, phy);
 }
 
+/*
+ * SIDDQ also powers down the line state detectors of the PHY: with it
+ * asserted, a connect or disconnect, a resume from the host or a remote
+ * wakeup from the device would all go unnoticed. Only power the PHY down
+ * when none of that is needed, that is when it may not wake up the system
+ * and no host or gadget controller is bound to it.
+ */
+static bool jz4770_phy_can_power_down(struct jz4770_phy *priv)
+{
+	return !device_may_wakeup(priv->dev) && !priv->otg.host &&
+		!priv->otg.gadget;
+}
+
+/* Bring a powered down PHY back up, now that a controller needs it */
+static void jz4770_phy_power_up(struct jz4770_phy *priv)
+{
+	if (!priv->powered_down)
+		return;
+
+	pm_runtime_get_sync(priv->dev);
+	pm_runtime_mark_last_busy(priv->dev);
+	pm_runtime_put_autosuspend(priv->dev);
+}
+
 static int ingenic_usb_phy_set_peripheral(struct usb_otg *otg,
 				     struct usb_gadget *gadget)
 {
 	struct jz4770_phy *priv = otg_to_jz4770_phy(otg);
 	u32 reg;
 
+	otg->gadget = gadget;
+	if (gadget)
+		jz4770_phy_power_up(priv);
+
 	if (priv->soc_info->version >= ID_X1000) {
 		reg = readl(priv->base + REG_USBPCR1_OFFSET);
 		reg |= USBPCR1_BVLD_REG;
@@ -146,6 +185,10 @@ static int ingenic_usb_phy_set_host(struct usb_otg *otg, struct usb_bus *host)
 	struct jz4770_phy *priv = otg_to_jz4770_phy(otg);
 	u32 reg;
 
+	otg->host = host;
+	if (host)
+		jz4770_phy_power_up(priv);
+
 	reg = readl(priv->base + REG_USBPCR_OFFSET);
 	reg &= ~(USBPCR_VBUSVLDEXT | USBPCR_VBUSVLDEXTSEL | USBPCR_OTG_DISABLE);
 	reg |= USBPCR_USB_MODE;
@@ -160,16 +203,21 @@ static int ingenic_usb_phy_init(struct usb_phy *phy)
 	int err;
 	u32 reg;
 
+	/* Held until shutdown, or until the PHY is suspended */
+	err = pm_runtime_resume_and_get(priv->dev);
+	if (err < 0)
+		return err;
+
 	err = regulator_enable(priv->vcc_supply);
 	if (err) {
 		dev_err(priv->dev, "Unable to enable VCC: %d\n", err);
-		return err;
+		goto err_put_rpm;
 	}
 
 	err = clk_prepare_enable(priv->clk);
 	if (err) {
 		dev_err(priv->dev, "Unable to start clock: %d\n", err);
-		return err;
+		goto err_disable_regulator;
 	}
 
 	priv->soc_info->usb_phy_init(phy);
@@ -180,15 +228,98 @@ static int ingenic_usb_phy_init(struct usb_phy *phy)
 	writel(reg & ~USBPCR_POR, priv->base + REG_USBPCR_OFFSET);
 	usleep_range(300, 1000);
 
+	priv->initialized = true;
+	priv->suspended = false;
+
 	return 0;
+
+err_disable_regulator:
+	regulator_disable(priv->vcc_supply);
+err_put_rpm:
+	pm_runtime_put(priv->dev);
+	return err;
 }
 
 static void ingenic_usb_phy_shutdown(struct usb_phy *phy)
 {
 	struct jz4770_phy *priv = phy_to_jz4770_phy(phy);
 
+	/* The clock must be running again before it can be stopped */
+	if (priv->suspended)
+		pm_runtime_get_sync(priv->dev);
+
+	priv->initialized = false;
+
 	clk_disable_unprepare(priv->clk);
 	regulator_disable(priv->vcc_supply);
+
+	pm_runtime_put(priv->dev);
+}
+
+static int ingenic_usb_phy_set_suspend(struct usb_phy *phy, int suspend)
+{
+	struct jz4770_phy *priv = phy_to_jz4770_phy(phy);
+	int err;
+
+	if (!priv->initialized || priv->suspended == !!suspend)
+		return 0;
+
+	if (suspend) {
+		pm_runtime_mark_last_busy(priv->dev);
+		pm_runtime_put_autosuspend(priv->dev);
+	} else {
+		err = pm_runtime_resume_and_get(priv->dev);
+		if (err < 0)
+			return err;
+	}
+
+	priv->suspended = !!suspend;
+
+	return 0;
+}
+
+static int __maybe_unused jz4770_phy_runtime_suspend(struct device *dev)
+{
+	struct jz4770_phy *priv = dev_get_drvdata(dev);
+	u32 reg;
+
+	if (!priv->initialized || !jz4770_phy_can_power_down(priv))
+		return 0;
+
+	/*
+	 * Power down the analog part of the PHY. Its configuration is
+	 * retained, so that resuming doesn't need a power-on reset.
+	 */
+	reg = readl(priv->base + REG_USBPCR_OFFSET);
+	writel(reg | USBPCR_SIDDQ, priv->base + REG_USBPCR_OFFSET);
+
+	clk_disable_unprepare(priv->clk);
+	priv->powered_down = true;
+
+	return 0;
+}
+
+static int __maybe_unused jz4770_phy_runtime_resume(struct device *dev)
+{
+	struct jz4770_phy *priv = dev_get_drvdata(dev);
+	int err;
+	u32 reg;
+
+	if (!priv->powered_down)
+		return 0;
+
+	err = clk_prepare_enable(priv->clk);
+	if (err) {
+		dev_err(dev, "Unable to start clock: %d\n", err);
+		return err;
+	}
+
+	reg = readl(priv->base + REG_USBPCR_OFFSET);
+	writel(reg & ~USBPCR_SIDDQ, priv->base + REG_USBPCR_OFFSET);
+	usleep_range(JZ4770_PHY_SIDDQ_SETTLE_US, 2 * JZ4770_PHY_SIDDQ_SETTLE_US);
+	priv->powered_down = false;
+
+	return 0;
 }
 
 static void ingenic_usb_phy_remove(void *phy)
@@ -196,6 +327,12 @@ static void ingenic_usb_phy_remove(void *phy)
 	usb_remove_phy(phy);
 }
 
+static void jz4770_phy_disable_rpm(void *dev)
+{
+	pm_runtime_dont_use_autosuspend(dev);
+	pm_runtime_disable(dev);
+}
+
 static void jz4770_usb_phy_init(struct usb_phy *phy)
 {
 	struct jz4770_phy *priv = phy_to_jz4770_phy(phy);
@@ -309,6 +446,7 @@ static int jz4770_phy_probe(struct platform_device *pdev)
 	priv->phy.label = "ingenic-usb-phy";
 	priv->phy.init = ingenic_usb_phy_init;
 	priv->phy.shutdown = ingenic_usb_phy_shutdown;
+	priv->phy.set_suspend = ingenic_usb_phy_set_suspend;
 
 	priv->otg.state = OTG_STATE_UNDEFINED;
 	priv->otg.usb_phy = &priv->phy;
@@ -337,6 +475,14 @@ static int jz4770_phy_probe(struct platform_device *pdev)
 		return err;
 	}
 
+	pm_runtime_set_autosuspend_delay(dev, JZ4770_PHY_AUTOSUSPEND_MS);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+
+	err = devm_add_action_or_reset(dev, jz4770_phy_disable_rpm, dev);
+	if (err)
+		return err;
+
 	err = usb_add_phy(&priv->phy, USB_PHY_TYPE_USB2);
 	if (err) {
 		if (err != -EPROBE_DEFER)
@@ -347,11 +493,17 @@ static int jz4770_phy_probe(struct platform_device *pdev)
 	return devm_add_action_or_reset(dev, ingenic_usb_phy_remove, &priv->phy);
 }
 
+static const struct dev_pm_ops jz4770_phy_pm_ops = {
+	SET_RUNTIME_PM_OPS(jz4770_phy_runtime_suspend,
+			   jz4770_phy_runtime_resume, NULL)
+};
+
 static struct platform_driver ingenic_phy_driver = {
 	.probe		= jz4770_phy_probe,
 	.driver		= {
 		.name	= "jz4770-phy",
 		.of_match_table = ingenic_usb_phy_of_matches,
+		.pm	= &jz4770_phy_pm_ops,
 	},
 };
 module_platform_driver(ingenic_phy_driver);
@@ -124,9 +124,11 @@ typedef tagptr1_t compressed_page_t;
 	tagptr_fold(compressed_page_t, page, 1)
 
 static struct workqueue_struct *z_erofs_workqueue __read_mostly;
+static struct workqueue_struct *z_erofs_local_workqueue __read_mostly;
 
 void z_erofs_exit_zip_subsystem(void)
 {
+	destroy_workqueue(z_erofs_local_workqueue);
 	destroy_workqueue(z_erofs_workqueue);
 	z_erofs_destroy_pcluster_pool();
 }
@@ -142,7 +144,17 @@ static inline int z_erofs_init_workqueue(void)
 	z_erofs_workqueue = alloc_workqueue("erofs_unzipd",
 					    WQ_UNBOUND | WQ_HIGHPRI,
 					    onlinecpus + onlinecpus / 4);
-	return z_erofs_workqueue ? 0 : -ENOMEM;
+	if (!z_erofs_workqueue)
+		return -ENOMEM;
+
+	/* per-CPU workers for decompressing on the CPU completing the I/O */
+	z_erofs_local_workqueue = alloc_workqueue("erofs_unzipd_local",
+						  WQ_HIGHPRI, 1);
+	if (!z_erofs_local_workqueue) {
+		destroy_workqueue(z_erofs_workqueue);
+		return -ENOMEM;
+	}
+	return 0;
 }
 
 int __init z_erofs_init_zip_subsystem(void)
@@ -800,7 +812,15 @@ static void z_erofs_decompress_kickoff(struct z_erofs_decompressqueue *io,
 		return;
 	/* Use workqueue and sync decompression for atomic contexts only */
 	if (in_atomic() || irqs_disabled()) {
-		queue_work(z_erofs_workqueue, &io->u.work);
+		/*
+		 * If this CPU was idle before the completion interrupt, start
+		 * decompressing on it as soon as the interrupt returns, rather
+		 * than waking up an unbound worker on another CPU.
+		 */
+		if (is_idle_task(current))
+			queue_work(z_erofs_local_workqueue, &io->u.work);
+		else
+			queue_work(z_erofs_workqueue, &io->u.work);
 		sbi->ctx.readahead_sync_decompress = true;
 		return;
 	}
@@ -1061,17 +1081,80 @@ static void z_erofs_decompress_queue(const struct z_erofs_decompressqueue *io,
 	}
 }
 
+static struct z_erofs_pcluster *
+z_erofs_decompressqueue_pop(struct z_erofs_decompressqueue *bgq)
+{
+	struct z_erofs_pcluster *pcl = NULL;
+
+	spin_lock(&bgq->u.lock);
+	if (bgq->head != Z_EROFS_PCLUSTER_TAIL_CLOSED) {
+		DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL);
+		DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_NIL);
+
+		pcl = container_of(bgq->head, struct z_erofs_pcluster, next);
+		/* must be read before anyone decompresses (and resets) it */
+		bgq->head = READ_ONCE(pcl->next);
+	}
+	spin_unlock(&bgq->u.lock);
+	return pcl;
+}
+
+/* pclusters of a queue are independent, so workers take them in turn */
+static void z_erofs_decompressqueue_run(struct z_erofs_decompressqueue *bgq)
+{
+	struct z_erofs_pcluster *pcl;
+	LIST_HEAD(pagepool);
+
+	while ((pcl = z_erofs_decompressqueue_pop(bgq)))
+		z_erofs_decompress_pcluster(bgq->sb, pcl, &pagepool);
+
+	put_pages_list(&pagepool);
+
+	/* the last worker frees the queue, no one waits for the others */
+	if (atomic_dec_and_test(&bgq->u.workers))
+		kvfree(bgq);
+}
+
+static void z_erofs_decompress_helper_work(struct work_struct *work)
+{
+	struct z_erofs_decompress_helper *helper =
+		container_of(work, struct z_erofs_decompress_helper, work);
+
+	z_erofs_decompressqueue_run(helper->io);
+}
+
 static void z_erofs_decompressqueue_work(struct work_struct *work)
 {
 	struct z_erofs_decompressqueue *bgq =
 		container_of(work, struct z_erofs_decompressqueue, u.work);
-	LIST_HEAD(pagepool);
+	z_erofs_next_pcluster_t owned = bgq->head;
+	unsigned int i, nr_helpers = 0, max_helpers;
 
 	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL_CLOSED);
-	z_erofs_decompress_queue(bgq, &pagepool);
 
-	put_pages_list(&pagepool);
-	kvfree(bgq);
+	/* one helper for each extra pcluster, bounded by the online CPUs */
+	max_helpers = min_t(unsigned int, num_online_cpus() - 1,
+			    Z_EROFS_MAX_DECOMPRESS_HELPERS);
+	while (nr_helpers < max_helpers) {
+		owned = READ_ONCE(container_of(owned, struct z_erofs_pcluster,
+					       next)->next);
+		if (owned == Z_EROFS_PCLUSTER_TAIL_CLOSED)
+			break;
+		++nr_helpers;
+	}
+
+	spin_lock_init(&bgq->u.lock);
+	atomic_set(&bgq->u.workers, nr_helpers + 1);
+
+	for (i = 0; i < nr_helpers; ++i) {
+		struct z_erofs_decompress_helper *helper = &bgq->u.helpers[i];
+
+		helper->io = bgq;
+		INIT_WORK(&helper->work, z_erofs_decompress_helper_work);
+		queue_work(z_erofs_workqueue, &helper->work);
+	}
+
+	z_erofs_decompressqueue_run(bgq);
 }
 
 static struct page *pickup_page_for_submission(struct z_erofs_pcluster *pcl,
@@ -84,6 +84,16 @@ struct z_erofs_pcluster {
 
 #define Z_EROFS_PCLUSTER_NIL            (NULL)
 
+/* max number of extra workers decompressing a background queue */
+#define Z_EROFS_MAX_DECOMPRESS_HELPERS	3
+
+struct z_erofs_decompressqueue;
+
+struct z_erofs_decompress_helper {
+	struct work_struct work;
+	struct z_erofs_decompressqueue *io;
+};
+
 struct z_erofs_decompressqueue {
 	struct super_block *sb;
 	atomic_t pending_bios;
@@ -91,7 +101,15 @@ struct z_erofs_decompressqueue {
 
 	union {
 		wait_queue_head_t wait;
-		struct work_struct work;
+		struct {
+			struct work_struct work;
+			/* protects head against concurrent workers */
+			spinlock_t lock;
+			/* workers still referencing this queue */
+			atomic_t workers;
+			struct z_erofs_decompress_helper
+				helpers[Z_EROFS_MAX_DECOMPRESS_HELPERS];
+		};
 	} u;
 };
 
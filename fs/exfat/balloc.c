@@ -141,7 +141,8 @@ void exfat_free_bitmap(struct exfat_sb_info *sbi)
 	kfree(sbi->vol_amap);
 }
 
-int exfat_set_bitmap(struct inode *inode, unsigned int clu, bool sync)
+int exfat_set_bitmap(struct inode *inode, unsigned int clu,
+		struct exfat_bh_batch *batch)
 {
 	int i, b;
 	unsigned int ent_idx;
@@ -154,13 +155,13 @@ int exfat_set_bitmap(struct inode *inode, unsigned int clu, bool sync)
 	b = BITMAP_OFFSET_BIT_IN_SECTOR(sb, ent_idx);
 
 	set_bit_le(b, sbi->vol_amap[i]->b_data);
-	exfat_update_bh(sbi->vol_amap[i], sync);
-	return 0;
+	return exfat_bh_batch_add(batch, sbi->vol_amap[i]);
 }
 
-void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync)
+int exfat_clear_bitmap(struct inode *inode, unsigned int clu,
+		struct exfat_bh_batch *batch)
 {
-	int i, b;
+	int i, b, err;
 	unsigned int ent_idx;
 	struct super_block *sb = inode->i_sb;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
@@ -172,7 +173,7 @@ void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync)
 	b = BITMAP_OFFSET_BIT_IN_SECTOR(sb, ent_idx);
 
 	clear_bit_le(b, sbi->vol_amap[i]->b_data);
-	exfat_update_bh(sbi->vol_amap[i], sync);
+	err = exfat_bh_batch_add(batch, sbi->vol_amap[i]);
 
 	if (opts->discard) {
 		int ret_discard;
@@ -186,6 +187,8 @@ void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync)
 			opts->discard = 0;
 		}
 	}
+
+	return err;
 }
 
 /*
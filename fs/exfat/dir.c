@@ -7,6 +7,9 @@
 #include <linux/compat.h>
 #include <linux/bio.h>
 #include <linux/buffer_head.h>
+#include <linux/iversion.h>
+#include <linux/math64.h>
+#include <linux/sched/mm.h>
 
 #include "exfat_raw.h"
 #include "exfat_fs.h"
@@ -921,9 +924,10 @@ enum {
  *   -ENOENT:   entry with the name does not exist
  *   -EIO:      I/O error
  */
-int exfat_find_dir_entry(struct super_block *sb, struct exfat_inode_info *ei,
-		struct exfat_chain *p_dir, struct exfat_uni_name *p_uniname,
-		int num_entries, unsigned int type, struct exfat_hint *hint_opt)
+static int __exfat_find_dir_entry(struct super_block *sb,
+		struct exfat_inode_info *ei, struct exfat_chain *p_dir,
+		struct exfat_uni_name *p_uniname, int num_entries,
+		unsigned int type, struct exfat_hint *hint_opt)
 {
 	int i, rewind = 0, dentry = 0, end_eidx = 0, num_ext = 0, len;
 	int order, step, name_len = 0;
@@ -1134,6 +1138,172 @@ int exfat_find_dir_entry(struct super_block *sb, struct exfat_inode_info *ei,
 	return dentry - num_ext;
 }
 
+/*
+ * In-memory index of the entry sets of a directory, by name hash, so that
+ * lookups in large directories do not scan all the entries. It is built on
+ * the first lookup, and thrown away when the directory is modified, i.e. when
+ * its i_version changes.
+ */
+struct exfat_dir_index_entry {
+	unsigned int clu;	/* cluster of the file entry */
+	int dentry;		/* index of the file entry in the directory */
+	int next;		/* next entry in the same bucket, or -1 */
+	u16 name_hash;
+	unsigned char name_len;
+};
+
+struct exfat_dir_index {
+	u64 version;
+	unsigned int hash_mask;
+	int *buckets;
+	struct exfat_dir_index_entry entries[];
+};
+
+void exfat_free_dir_index(struct exfat_inode_info *ei)
+{
+	if (!ei->dir_index)
+		return;
+
+	kvfree(ei->dir_index->buckets);
+	kvfree(ei->dir_index);
+	ei->dir_index = NULL;
+}
+
+static struct exfat_dir_index *exfat_build_dir_index(struct super_block *sb,
+		struct exfat_inode_info *ei, struct exfat_chain *p_dir)
+{
+	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+	struct inode *dir = &ei->vfs_inode;
+	struct exfat_dir_index *index;
+	struct exfat_dir_index_entry *e;
+	struct exfat_chain clu;
+	unsigned int nofs_flags, entry_type, file_clu = 0, bucket;
+	int i, dentry = 0, file_dentry = -1, max_files, nr_files = 0;
+
+	/* each entry set has at least a file, a stream and a name entry */
+	max_files = div_u64(EXFAT_B_TO_DEN(i_size_read(dir)), 3) + 1;
+
+	nofs_flags = memalloc_nofs_save();
+	index = kvmalloc(struct_size(index, entries, max_files), GFP_KERNEL);
+	if (index) {
+		index->hash_mask = roundup_pow_of_two(max_files) - 1;
+		index->buckets = kvmalloc_array(index->hash_mask + 1,
+				sizeof(int), GFP_KERNEL);
+	}
+	memalloc_nofs_restore(nofs_flags);
+	if (!index || !index->buckets)
+		goto free_index;
+
+	index->version = inode_peek_iversion_raw(dir);
+	memset(index->buckets, 0xff, (index->hash_mask + 1) * sizeof(int));
+
+	exfat_chain_dup(&clu, p_dir);
+	while (clu.dir != EXFAT_EOF_CLUSTER) {
+		for (i = 0; i < sbi->dentries_per_clu; i++, dentry++) {
+			struct exfat_dentry *ep;
+			struct buffer_head *bh;
+
+			ep = exfat_get_dentry(sb, &clu, i, &bh, NULL);
+			if (!ep)
+				goto free_index;
+
+			entry_type = exfat_get_entry_type(ep);
+			if (entry_type == TYPE_UNUSED) {
+				brelse(bh);
+				return index;
+			}
+
+			if (entry_type == TYPE_FILE || entry_type == TYPE_DIR) {
+				file_clu = clu.dir;
+				file_dentry = dentry;
+			} else if (entry_type == TYPE_STREAM &&
+				   file_dentry >= 0) {
+				/* more entry sets than can fit, corrupted */
+				if (nr_files == max_files) {
+					brelse(bh);
+					goto free_index;
+				}
+
+				e = &index->entries[nr_files];
+				e->clu = file_clu;
+				e->dentry = file_dentry;
+				e->name_hash =
+					le16_to_cpu(ep->dentry.stream.name_hash);
+				e->name_len = ep->dentry.stream.name_len;
+
+				bucket = e->name_hash & index->hash_mask;
+				e->next = index->buckets[bucket];
+				index->buckets[bucket] = nr_files++;
+
+				file_dentry = -1;
+			} else {
+				file_dentry = -1;
+			}
+			brelse(bh);
+		}
+
+		if (clu.flags == ALLOC_NO_FAT_CHAIN) {
+			if (--clu.size > 0)
+				clu.dir++;
+			else
+				clu.dir = EXFAT_EOF_CLUSTER;
+		} else {
+			if (exfat_get_next_cluster(sb, &clu.dir))
+				goto free_index;
+		}
+	}
+	return index;
+
+free_index:
+	if (index)
+		kvfree(index->buckets);
+	kvfree(index);
+	return NULL;
+}
+
+/*
+ * Look the name up in the index of the directory, and start the search from
+ * the matching entry set, which is then found right away. The full search is
+ * only done on hash collisions, or if the index cannot be built.
+ */
+int exfat_find_dir_entry(struct super_block *sb, struct exfat_inode_info *ei,
+		struct exfat_chain *p_dir, struct exfat_uni_name *p_uniname,
+		int num_entries, unsigned int type, struct exfat_hint *hint_opt)
+{
+	struct exfat_dir_index *index = ei->dir_index;
+	struct exfat_dir_index_entry *e;
+	int i;
+
+	if (index &&
+	    index->version != inode_peek_iversion_raw(&ei->vfs_inode)) {
+		exfat_free_dir_index(ei);
+		index = NULL;
+	}
+
+	if (!index) {
+		index = exfat_build_dir_index(sb, ei, p_dir);
+		if (!index)
+			return __exfat_find_dir_entry(sb, ei, p_dir, p_uniname,
+					num_entries, type, hint_opt);
+		ei->dir_index = index;
+	}
+
+	i = index->buckets[p_uniname->name_hash & index->hash_mask];
+	for (; i >= 0; i = e->next) {
+		e = &index->entries[i];
+		if (e->name_hash != p_uniname->name_hash ||
+		    e->name_len != p_uniname->name_len)
+			continue;
+
+		ei->hint_stat.clu = e->clu;
+		ei->hint_stat.eidx = e->dentry;
+		return __exfat_find_dir_entry(sb, ei, p_dir, p_uniname,
+				num_entries, type, hint_opt);
+	}
+
+	return -ENOENT;
+}
+
 int exfat_count_ext_entries(struct super_block *sb, struct exfat_chain *p_dir,
 		int entry, struct exfat_dentry *ep)
 {
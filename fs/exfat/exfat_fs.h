@@ -9,6 +9,7 @@
 #include <linux/fs.h>
 #include <linux/ratelimit.h>
 #include <linux/nls.h>
+#include <linux/workqueue.h>
 
 #define EXFAT_SUPER_MAGIC       0x2011BAB0UL
 #define EXFAT_ROOT_INO		1
@@ -206,6 +207,19 @@ struct exfat_mount_options {
 	unsigned utf8:1, /* Use of UTF-8 character set */
 		 discard:1; /* Issue discard requests on deletions */
 	int time_offset; /* Offset of timestamps from UTC (in minutes) */
+	unsigned int commit_interval; /* Metadata flush interval (in seconds) */
+};
+
+/*
+ * Buffer heads dirtied by a single cluster allocation or free. With sync set,
+ * they are written out together, in block order, instead of one at a time.
+ */
+#define EXFAT_BH_BATCH_SIZE	16
+
+struct exfat_bh_batch {
+	struct buffer_head *bhs[EXFAT_BH_BATCH_SIZE];
+	int nr_bhs;
+	int sync;
 };
 
 /*
@@ -246,6 +260,9 @@ struct exfat_sb_info {
 	spinlock_t inode_hash_lock;
 	struct hlist_head inode_hashtable[EXFAT_HASH_SIZE];
 
+	struct super_block *sb;
+	struct delayed_work commit_work; /* flushes metadata every commit_interval */
+
 	struct rcu_head rcu;
 };
 
@@ -273,6 +290,8 @@ struct exfat_inode_info {
 	struct exfat_hint hint_stat;
 	/* hint for first empty entry */
 	struct exfat_hint_femp hint_femp;
+	/* name hash index of a directory, protected by sbi->s_lock */
+	struct exfat_dir_index *dir_index;
 
 	spinlock_t cache_lru_lock;
 	struct list_head cache_lru;
@@ -384,6 +403,7 @@ static inline int exfat_sector_to_cluster(struct exfat_sb_info *sbi,
 /* super.c */
 int exfat_set_volume_dirty(struct super_block *sb);
 int exfat_clear_volume_dirty(struct super_block *sb);
+void exfat_schedule_commit(struct super_block *sb);
 
 /* fatent.c */
 #define exfat_get_next_cluster(sb, pclu) exfat_ent_get(sb, *(pclu), pclu)
@@ -408,8 +428,10 @@ int exfat_count_num_clusters(struct super_block *sb,
 /* balloc.c */
 int exfat_load_bitmap(struct super_block *sb);
 void exfat_free_bitmap(struct exfat_sb_info *sbi);
-int exfat_set_bitmap(struct inode *inode, unsigned int clu, bool sync);
-void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync);
+int exfat_set_bitmap(struct inode *inode, unsigned int clu,
+		struct exfat_bh_batch *batch);
+int exfat_clear_bitmap(struct inode *inode, unsigned int clu,
+		struct exfat_bh_batch *batch);
 unsigned int exfat_find_free_bitmap(struct super_block *sb, unsigned int clu);
 int exfat_count_used_clusters(struct super_block *sb, unsigned int *ret_count);
 int exfat_trim_fs(struct inode *inode, struct fstrim_range *range);
@@ -458,6 +480,7 @@ int exfat_calc_num_entries(struct exfat_uni_name *p_uniname);
 int exfat_find_dir_entry(struct super_block *sb, struct exfat_inode_info *ei,
 		struct exfat_chain *p_dir, struct exfat_uni_name *p_uniname,
 		int num_entries, unsigned int type, struct exfat_hint *hint_opt);
+void exfat_free_dir_index(struct exfat_inode_info *ei);
 int exfat_alloc_new_dir(struct inode *inode, struct exfat_chain *clu);
 int exfat_find_location(struct super_block *sb, struct exfat_chain *p_dir,
 		int entry, sector_t *sector, int *offset);
@@ -482,6 +505,7 @@ struct inode *exfat_iget(struct super_block *sb, loff_t i_pos);
 int exfat_write_inode(struct inode *inode, struct writeback_control *wbc);
 void exfat_evict_inode(struct inode *inode);
 int exfat_block_truncate_page(struct inode *inode, loff_t from);
+extern const struct iomap_ops exfat_iomap_ops;
 
 /* exfat/nls.c */
 unsigned short exfat_toupper(struct super_block *sb, unsigned short a);
@@ -522,6 +546,9 @@ u16 exfat_calc_chksum16(void *data, int len, u16 chksum, int type);
 u32 exfat_calc_chksum32(void *data, int len, u32 chksum, int type);
 void exfat_update_bh(struct buffer_head *bh, int sync);
 int exfat_update_bhs(struct buffer_head **bhs, int nr_bhs, int sync);
+void exfat_bh_batch_init(struct exfat_bh_batch *batch, int sync);
+int exfat_bh_batch_add(struct exfat_bh_batch *batch, struct buffer_head *bh);
+int exfat_bh_batch_flush(struct exfat_bh_batch *batch);
 void exfat_chain_set(struct exfat_chain *ec, unsigned int dir,
 		unsigned int size, unsigned char flags);
 void exfat_chain_dup(struct exfat_chain *dup, struct exfat_chain *ec);
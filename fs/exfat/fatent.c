@@ -11,7 +11,7 @@
 #include "exfat_fs.h"
 
 static int exfat_mirror_bh(struct super_block *sb, sector_t sec,
-		struct buffer_head *bh)
+		struct buffer_head *bh, struct exfat_bh_batch *batch)
 {
 	struct buffer_head *c_bh;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
@@ -24,10 +24,7 @@ static int exfat_mirror_bh(struct super_block *sb, sector_t sec,
 		if (!c_bh)
 			return -ENOMEM;
 		memcpy(c_bh->b_data, bh->b_data, sb->s_blocksize);
-		set_buffer_uptodate(c_bh);
-		mark_buffer_dirty(c_bh);
-		if (sb->s_flags & SB_SYNCHRONOUS)
-			err = sync_dirty_buffer(c_bh);
+		err = exfat_bh_batch_add(batch, c_bh);
 		brelse(c_bh);
 	}
 
@@ -58,13 +55,14 @@ static int __exfat_ent_get(struct super_block *sb, unsigned int loc,
 	return 0;
 }
 
-int exfat_ent_set(struct super_block *sb, unsigned int loc,
-		unsigned int content)
+static int __exfat_ent_set(struct super_block *sb, unsigned int loc,
+		unsigned int content, struct exfat_bh_batch *batch)
 {
 	unsigned int off;
 	sector_t sec;
 	__le32 *fat_entry;
 	struct buffer_head *bh;
+	int err;
 
 	sec = FAT_ENT_OFFSET_SECTOR(sb, loc);
 	off = FAT_ENT_OFFSET_BYTE_IN_SECTOR(sb, loc);
@@ -75,10 +73,23 @@ int exfat_ent_set(struct super_block *sb, unsigned int loc,
 
 	fat_entry = (__le32 *)&(bh->b_data[off]);
 	*fat_entry = cpu_to_le32(content);
-	exfat_update_bh(bh, sb->s_flags & SB_SYNCHRONOUS);
-	exfat_mirror_bh(sb, sec, bh);
+	err = exfat_bh_batch_add(batch, bh);
+	if (!err)
+		err = exfat_mirror_bh(sb, sec, bh, batch);
 	brelse(bh);
-	return 0;
+	return err;
+}
+
+int exfat_ent_set(struct super_block *sb, unsigned int loc,
+		unsigned int content)
+{
+	struct exfat_bh_batch batch;
+	int err, flush_err;
+
+	exfat_bh_batch_init(&batch, sb->s_flags & SB_SYNCHRONOUS);
+	err = __exfat_ent_set(sb, loc, content, &batch);
+	flush_err = exfat_bh_batch_flush(&batch);
+	return err ? err : flush_err;
 }
 
 static inline bool is_valid_cluster(struct exfat_sb_info *sbi,
@@ -133,32 +144,48 @@ int exfat_ent_get(struct super_block *sb, unsigned int loc,
 	return 0;
 }
 
-int exfat_chain_cont_cluster(struct super_block *sb, unsigned int chain,
-		unsigned int len)
+static int __exfat_chain_cont_cluster(struct super_block *sb,
+		unsigned int chain, unsigned int len,
+		struct exfat_bh_batch *batch)
 {
 	if (!len)
 		return 0;
 
 	while (len > 1) {
-		if (exfat_ent_set(sb, chain, chain + 1))
+		if (__exfat_ent_set(sb, chain, chain + 1, batch))
 			return -EIO;
 		chain++;
 		len--;
 	}
 
-	if (exfat_ent_set(sb, chain, EXFAT_EOF_CLUSTER))
+	if (__exfat_ent_set(sb, chain, EXFAT_EOF_CLUSTER, batch))
 		return -EIO;
 	return 0;
 }
 
+int exfat_chain_cont_cluster(struct super_block *sb, unsigned int chain,
+		unsigned int len)
+{
+	struct exfat_bh_batch batch;
+	int err;
+
+	/* A chain spans consecutive FAT sectors, write them in one go */
+	exfat_bh_batch_init(&batch, sb->s_flags & SB_SYNCHRONOUS);
+	err = __exfat_chain_cont_cluster(sb, chain, len, &batch);
+	if (exfat_bh_batch_flush(&batch))
+		err = -EIO;
+	return err;
+}
+
 /* This function must be called with bitmap_lock held */
 static int __exfat_free_cluster(struct inode *inode, struct exfat_chain *p_chain)
 {
 	struct super_block *sb = inode->i_sb;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
-	int cur_cmap_i, next_cmap_i;
+	struct exfat_bh_batch batch;
 	unsigned int num_clusters = 0;
 	unsigned int clu;
+	int ret = 0;
 
 	/* invalid cluster number */
 	if (p_chain->dir == EXFAT_FREE_CLUSTER ||
@@ -178,46 +205,26 @@ static int __exfat_free_cluster(struct inode *inode, struct exfat_chain *p_chain
 
 	clu = p_chain->dir;
 
-	cur_cmap_i = next_cmap_i =
-		BITMAP_OFFSET_SECTOR_INDEX(sb, CLUSTER_TO_BITMAP_ENT(clu));
+	/*
+	 * The bitmap sectors are only written once all the clusters are
+	 * cleared, however many clusters each of them covers.
+	 */
+	exfat_bh_batch_init(&batch, IS_DIRSYNC(inode));
 
 	if (p_chain->flags == ALLOC_NO_FAT_CHAIN) {
-		unsigned int last_cluster = p_chain->dir + p_chain->size - 1;
 		do {
-			bool sync = false;
-
-			if (clu < last_cluster)
-				next_cmap_i =
-				  BITMAP_OFFSET_SECTOR_INDEX(sb, CLUSTER_TO_BITMAP_ENT(clu+1));
-
-			/* flush bitmap only if index would be changed or for last cluster */
-			if (clu == last_cluster || cur_cmap_i != next_cmap_i) {
-				sync = true;
-				cur_cmap_i = next_cmap_i;
-			}
-
-			exfat_clear_bitmap(inode, clu, (sync && IS_DIRSYNC(inode)));
+			if (exfat_clear_bitmap(inode, clu, &batch))
+				ret = -EIO;
 			clu++;
 			num_clusters++;
 		} while (num_clusters < p_chain->size);
 	} else {
 		do {
-			bool sync = false;
 			unsigned int n_clu = clu;
 			int err = exfat_get_next_cluster(sb, &n_clu);
 
-			if (err || n_clu == EXFAT_EOF_CLUSTER)
-				sync = true;
-			else
-				next_cmap_i =
-				  BITMAP_OFFSET_SECTOR_INDEX(sb, CLUSTER_TO_BITMAP_ENT(n_clu));
-
-			if (cur_cmap_i != next_cmap_i) {
-				sync = true;
-				cur_cmap_i = next_cmap_i;
-			}
-
-			exfat_clear_bitmap(inode, clu, (sync && IS_DIRSYNC(inode)));
+			if (exfat_clear_bitmap(inode, clu, &batch))
+				ret = -EIO;
 			clu = n_clu;
 			num_clusters++;
 
@@ -228,7 +235,9 @@ static int __exfat_free_cluster(struct inode *inode, struct exfat_chain *p_chain
 
 dec_used_clus:
 	sbi->used_clusters -= num_clusters;
-	return 0;
+	if (exfat_bh_batch_flush(&batch))
+		ret = -EIO;
+	return ret;
 }
 
 int exfat_free_cluster(struct inode *inode, struct exfat_chain *p_chain)
@@ -239,6 +248,7 @@ int exfat_free_cluster(struct inode *inode, struct exfat_chain *p_chain)
 	ret = __exfat_free_cluster(inode, p_chain);
 	mutex_unlock(&EXFAT_SB(inode->i_sb)->bitmap_lock);
 
+	exfat_schedule_commit(inode->i_sb);
 	return ret;
 }
 
@@ -327,6 +337,7 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 	unsigned int hint_clu, new_clu, last_clu = EXFAT_EOF_CLUSTER;
 	struct super_block *sb = inode->i_sb;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+	struct exfat_bh_batch bmap_batch, fat_batch;
 
 	total_cnt = EXFAT_DATA_CLUSTER_COUNT(sbi);
 
@@ -342,6 +353,13 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 
 	mutex_lock(&sbi->bitmap_lock);
 
+	/*
+	 * Collect the bitmap and FAT sectors touched by the whole allocation,
+	 * so that each of them is written once at the end.
+	 */
+	exfat_bh_batch_init(&bmap_batch, sync_bmap);
+	exfat_bh_batch_init(&fat_batch, sb->s_flags & SB_SYNCHRONOUS);
+
 	hint_clu = p_chain->dir;
 	/* find new cluster */
 	if (hint_clu == EXFAT_EOF_CLUSTER) {
@@ -364,10 +382,10 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 			hint_clu);
 		hint_clu = EXFAT_FIRST_CLUSTER;
 		if (p_chain->flags == ALLOC_NO_FAT_CHAIN) {
-			if (exfat_chain_cont_cluster(sb, p_chain->dir,
-					num_clusters)) {
+			if (__exfat_chain_cont_cluster(sb, p_chain->dir,
+					num_clusters, &fat_batch)) {
 				ret = -EIO;
-				goto unlock;
+				goto free_cluster;
 			}
 			p_chain->flags = ALLOC_FAT_CHAIN;
 		}
@@ -379,8 +397,8 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 	       EXFAT_EOF_CLUSTER) {
 		if (new_clu != hint_clu &&
 		    p_chain->flags == ALLOC_NO_FAT_CHAIN) {
-			if (exfat_chain_cont_cluster(sb, p_chain->dir,
-					num_clusters)) {
+			if (__exfat_chain_cont_cluster(sb, p_chain->dir,
+					num_clusters, &fat_batch)) {
 				ret = -EIO;
 				goto free_cluster;
 			}
@@ -388,7 +406,7 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 		}
 
 		/* update allocation bitmap */
-		if (exfat_set_bitmap(inode, new_clu, sync_bmap)) {
+		if (exfat_set_bitmap(inode, new_clu, &bmap_batch)) {
 			ret = -EIO;
 			goto free_cluster;
 		}
@@ -397,7 +415,8 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 
 		/* update FAT table */
 		if (p_chain->flags == ALLOC_FAT_CHAIN) {
-			if (exfat_ent_set(sb, new_clu, EXFAT_EOF_CLUSTER)) {
+			if (__exfat_ent_set(sb, new_clu, EXFAT_EOF_CLUSTER,
+					&fat_batch)) {
 				ret = -EIO;
 				goto free_cluster;
 			}
@@ -406,7 +425,7 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 		if (p_chain->dir == EXFAT_EOF_CLUSTER) {
 			p_chain->dir = new_clu;
 		} else if (p_chain->flags == ALLOC_FAT_CHAIN) {
-			if (exfat_ent_set(sb, last_clu, new_clu)) {
+			if (__exfat_ent_set(sb, last_clu, new_clu, &fat_batch)) {
 				ret = -EIO;
 				goto free_cluster;
 			}
@@ -414,11 +433,19 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 		last_clu = new_clu;
 
 		if (--num_alloc == 0) {
+			ret = exfat_bh_batch_flush(&bmap_batch);
+			if (exfat_bh_batch_flush(&fat_batch))
+				ret = -EIO;
+			if (ret)
+				goto free_cluster;
+
 			sbi->clu_srch_ptr = hint_clu;
 			sbi->used_clusters += num_clusters;
 
 			p_chain->size += num_clusters;
 			mutex_unlock(&sbi->bitmap_lock);
+
+			exfat_schedule_commit(sb);
 			return 0;
 		}
 
@@ -427,8 +454,8 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 			hint_clu = EXFAT_FIRST_CLUSTER;
 
 			if (p_chain->flags == ALLOC_NO_FAT_CHAIN) {
-				if (exfat_chain_cont_cluster(sb, p_chain->dir,
-						num_clusters)) {
+				if (__exfat_chain_cont_cluster(sb, p_chain->dir,
+						num_clusters, &fat_batch)) {
 					ret = -EIO;
 					goto free_cluster;
 				}
@@ -437,6 +464,8 @@ int exfat_alloc_cluster(struct inode *inode, unsigned int num_alloc,
 		}
 	}
 free_cluster:
+	exfat_bh_batch_flush(&bmap_batch);
+	exfat_bh_batch_flush(&fat_batch);
 	if (num_clusters)
 		__exfat_free_cluster(inode, p_chain);
 unlock:
@@ -8,6 +8,8 @@
 #include <linux/cred.h>
 #include <linux/buffer_head.h>
 #include <linux/blkdev.h>
+#include <linux/backing-dev.h>
+#include <linux/iomap.h>
 
 #include "exfat_raw.h"
 #include "exfat_fs.h"
@@ -333,6 +335,9 @@ int exfat_setattr(struct user_namespace *mnt_userns, struct dentry *dentry,
 	}
 
 	if (attr->ia_valid & ATTR_SIZE) {
+		/* Don't free the clusters under an in-flight direct I/O */
+		inode_dio_wait(inode);
+
 		error = exfat_block_truncate_page(inode, attr->ia_size);
 		if (error)
 			goto out;
@@ -415,10 +420,94 @@ int exfat_file_fsync(struct file *filp, loff_t start, loff_t end, int datasync)
 	return blkdev_issue_flush(inode->i_sb->s_bdev);
 }
 
+static ssize_t exfat_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
+{
+	struct inode *inode = file_inode(iocb->ki_filp);
+	ssize_t ret;
+
+	if (!(iocb->ki_flags & IOCB_DIRECT))
+		return generic_file_read_iter(iocb, to);
+
+	if (!iov_iter_count(to))
+		return 0;
+
+	inode_lock_shared(inode);
+	file_accessed(iocb->ki_filp);
+	ret = iomap_dio_rw(iocb, to, &exfat_iomap_ops, NULL, 0);
+	inode_unlock_shared(inode);
+
+	return ret;
+}
+
+static ssize_t exfat_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
+{
+	struct file *file = iocb->ki_filp;
+	struct inode *inode = file_inode(file);
+	loff_t pos, end;
+	ssize_t ret;
+	int err;
+
+	if (!(iocb->ki_flags & IOCB_DIRECT))
+		return generic_file_write_iter(iocb, from);
+
+	inode_lock(inode);
+	ret = generic_write_checks(iocb, from);
+	if (ret <= 0)
+		goto unlock;
+
+	ret = file_remove_privs(file);
+	if (ret)
+		goto unlock;
+	ret = file_update_time(file);
+	if (ret)
+		goto unlock;
+
+	/*
+	 * Extending writes have to zero the gap from ->i_size_ondisk, allocate
+	 * the clusters through ->write_begin() and update i_size, so they fall
+	 * back to buffered I/O.
+	 */
+	if (iocb->ki_pos + iov_iter_count(from) <= i_size_read(inode)) {
+		ret = iomap_dio_rw(iocb, from, &exfat_iomap_ops, NULL, 0);
+		if (ret != -ENOTBLK)
+			goto unlock;
+	}
+
+	/*
+	 * Write through the page cache, then write the pages back and drop
+	 * them, so that the data is on disk as with direct I/O.
+	 */
+	pos = iocb->ki_pos;
+	current->backing_dev_info = inode_to_bdi(inode);
+	ret = generic_perform_write(file, from, pos);
+	current->backing_dev_info = NULL;
+	if (ret > 0) {
+		end = pos + ret - 1;
+		err = filemap_write_and_wait_range(file->f_mapping, pos, end);
+		if (!err) {
+			iocb->ki_pos = pos + ret;
+			invalidate_mapping_pages(file->f_mapping,
+						 pos >> PAGE_SHIFT,
+						 end >> PAGE_SHIFT);
+		} else {
+			ret = err;
+		}
+	}
+	inode_unlock(inode);
+
+	if (ret > 0)
+		ret = generic_write_sync(iocb, ret);
+	return ret;
+
+unlock:
+	inode_unlock(inode);
+	return ret;
+}
+
 const struct file_operations exfat_file_operations = {
 	.llseek		= generic_file_llseek,
-	.read_iter	= generic_file_read_iter,
-	.write_iter	= generic_file_write_iter,
+	.read_iter	= exfat_file_read_iter,
+	.write_iter	= exfat_file_write_iter,
 	.unlocked_ioctl = exfat_ioctl,
 #ifdef CONFIG_COMPAT
 	.compat_ioctl = exfat_compat_ioctl,
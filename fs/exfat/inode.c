@@ -6,6 +6,7 @@
 #include <linux/init.h>
 #include <linux/buffer_head.h>
 #include <linux/mpage.h>
+#include <linux/iomap.h>
 #include <linux/bio.h>
 #include <linux/blkdev.h>
 #include <linux/time.h>
@@ -435,38 +436,74 @@ static int exfat_write_end(struct file *file, struct address_space *mapping,
 	return err;
 }
 
-static ssize_t exfat_direct_IO(struct kiocb *iocb, struct iov_iter *iter)
+/*
+ * Map the blocks at @offset for direct I/O. Direct writes never extend the
+ * file, allocation is left to the buffered path, so only lookups are done
+ * here. Consecutive clusters of the chain are merged into a single extent,
+ * so that a large request is issued as a few big bios.
+ */
+static int exfat_iomap_begin(struct inode *inode, loff_t offset,
+		loff_t length, unsigned int flags, struct iomap *iomap,
+		struct iomap *srcmap)
 {
-	struct address_space *mapping = iocb->ki_filp->f_mapping;
-	struct inode *inode = mapping->host;
-	loff_t size = iocb->ki_pos + iov_iter_count(iter);
-	int rw = iov_iter_rw(iter);
-	ssize_t ret;
+	struct super_block *sb = inode->i_sb;
+	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+	sector_t iblock = offset >> sb->s_blocksize_bits;
+	sector_t end = EXFAT_B_TO_BLK_ROUND_UP(offset + length, sb);
+	sector_t last_block, next;
+	unsigned int clu_offset, cluster, next_cluster;
+	int err = 0;
 
-	if (rw == WRITE) {
-		/*
-		 * FIXME: blockdev_direct_IO() doesn't use ->write_begin(),
-		 * so we need to update the ->i_size_aligned to block boundary.
-		 *
-		 * But we must fill the remaining area or hole by nul for
-		 * updating ->i_size_aligned
-		 *
-		 * Return 0, and fallback to normal buffered write.
-		 */
-		if (EXFAT_I(inode)->i_size_aligned < size)
-			return 0;
+	iomap->bdev = sb->s_bdev;
+	iomap->offset = EXFAT_BLK_TO_B(iblock, sb);
+
+	mutex_lock(&sbi->s_lock);
+	last_block = EXFAT_B_TO_BLK_ROUND_UP(i_size_read(inode), sb);
+
+	cluster = EXFAT_EOF_CLUSTER;
+	clu_offset = iblock >> sbi->sect_per_clus_bits;
+	if (iblock < last_block) {
+		err = exfat_map_cluster(inode, clu_offset, &cluster, 0);
+		if (err)
+			goto unlock;
 	}
 
-	/*
-	 * Need to use the DIO_LOCKING for avoiding the race
-	 * condition of exfat_get_block() and ->truncate().
-	 */
-	ret = blockdev_direct_IO(iocb, inode, iter, exfat_get_block);
-	if (ret < 0 && (rw & WRITE))
-		exfat_write_failed(mapping, size);
-	return ret;
+	if (cluster == EXFAT_EOF_CLUSTER) {
+		err = (flags & IOMAP_WRITE) ? -EIO : 0;
+		iomap->type = IOMAP_HOLE;
+		iomap->addr = IOMAP_NULL_ADDR;
+		iomap->length = EXFAT_BLK_TO_B(end - iblock, sb);
+		goto unlock;
+	}
+
+	end = min(end, last_block);
+
+	next = (sector_t)(clu_offset + 1) << sbi->sect_per_clus_bits;
+	next_cluster = cluster;
+	while (next < end) {
+		unsigned int clu;
+
+		err = exfat_map_cluster(inode, ++clu_offset, &clu, 0);
+		if (err)
+			goto unlock;
+		if (clu != ++next_cluster)
+			break;
+		next += sbi->sect_per_clus;
+	}
+
+	iomap->type = IOMAP_MAPPED;
+	iomap->addr = EXFAT_BLK_TO_B(exfat_cluster_to_sector(sbi, cluster) +
+			(iblock & (sbi->sect_per_clus - 1)), sb);
+	iomap->length = EXFAT_BLK_TO_B(min(next, end) - iblock, sb);
+unlock:
+	mutex_unlock(&sbi->s_lock);
+	return err;
 }
 
+const struct iomap_ops exfat_iomap_ops = {
+	.iomap_begin	= exfat_iomap_begin,
+};
+
 static sector_t exfat_aop_bmap(struct address_space *mapping, sector_t block)
 {
 	sector_t blocknr;
@@ -497,7 +534,7 @@ static const struct address_space_operations exfat_aops = {
 	.writepages	= exfat_writepages,
 	.write_begin	= exfat_write_begin,
 	.write_end	= exfat_write_end,
-	.direct_IO	= exfat_direct_IO,
+	.direct_IO	= noop_direct_IO,
 	.bmap		= exfat_aop_bmap
 };
 
@@ -654,5 +691,6 @@ void exfat_evict_inode(struct inode *inode)
 	invalidate_inode_buffers(inode);
 	clear_inode(inode);
 	exfat_cache_inval_inode(inode);
+	exfat_free_dir_index(EXFAT_I(inode));
 	exfat_unhash_inode(inode);
 }
@@ -10,6 +10,8 @@
 #include <linux/fs.h>
 #include <linux/slab.h>
 #include <linux/buffer_head.h>
+#include <linux/blkdev.h>
+#include <linux/sort.h>
 
 #include "exfat_raw.h"
 #include "exfat_fs.h"
@@ -191,6 +193,80 @@ int exfat_update_bhs(struct buffer_head **bhs, int nr_bhs, int sync)
 	return err;
 }
 
+void exfat_bh_batch_init(struct exfat_bh_batch *batch, int sync)
+{
+	batch->nr_bhs = 0;
+	batch->sync = sync;
+}
+
+static int exfat_bh_cmp(const void *a, const void *b)
+{
+	const struct buffer_head *bh1 = *(const struct buffer_head **)a;
+	const struct buffer_head *bh2 = *(const struct buffer_head **)b;
+
+	if (bh1->b_blocknr < bh2->b_blocknr)
+		return -1;
+	return bh1->b_blocknr > bh2->b_blocknr;
+}
+
+/*
+ * Write out the buffers of a batch, in block order and under a plug so that
+ * neighbouring bitmap and FAT sectors go to the device as a single request.
+ */
+int exfat_bh_batch_flush(struct exfat_bh_batch *batch)
+{
+	struct blk_plug plug;
+	int i, err = 0;
+
+	if (!batch->nr_bhs)
+		return 0;
+
+	sort(batch->bhs, batch->nr_bhs, sizeof(batch->bhs[0]), exfat_bh_cmp,
+	     NULL);
+
+	blk_start_plug(&plug);
+	for (i = 0; i < batch->nr_bhs; i++)
+		write_dirty_buffer(batch->bhs[i], 0);
+	blk_finish_plug(&plug);
+
+	for (i = 0; i < batch->nr_bhs; i++) {
+		wait_on_buffer(batch->bhs[i]);
+		if (!err && !buffer_uptodate(batch->bhs[i]))
+			err = -EIO;
+		brelse(batch->bhs[i]);
+	}
+
+	batch->nr_bhs = 0;
+	return err;
+}
+
+/*
+ * Dirty @bh. Without sync, writeback is left to the flusher or the commit
+ * work; otherwise @bh is written by the next exfat_bh_batch_flush(), once
+ * however many times it is dirtied until then.
+ */
+int exfat_bh_batch_add(struct exfat_bh_batch *batch, struct buffer_head *bh)
+{
+	int i, err = 0;
+
+	set_buffer_uptodate(bh);
+	mark_buffer_dirty(bh);
+
+	if (!batch->sync)
+		return 0;
+
+	for (i = 0; i < batch->nr_bhs; i++)
+		if (batch->bhs[i] == bh)
+			return 0;
+
+	if (batch->nr_bhs == EXFAT_BH_BATCH_SIZE)
+		err = exfat_bh_batch_flush(batch);
+
+	get_bh(bh);
+	batch->bhs[batch->nr_bhs++] = bh;
+	return err;
+}
+
 void exfat_chain_set(struct exfat_chain *ec, unsigned int dir,
 		unsigned int size, unsigned char flags)
 {
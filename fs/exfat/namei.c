@@ -1349,8 +1349,12 @@ static int exfat_rename(struct user_namespace *mnt_userns,
 	new_inode = new_dentry->d_inode;
 
 	err = __exfat_rename(old_dir, EXFAT_I(old_inode), new_dir, new_dentry);
-	if (err)
+	if (err) {
+		/* the entries may have been partially moved */
+		exfat_free_dir_index(EXFAT_I(old_dir));
+		exfat_free_dir_index(EXFAT_I(new_dir));
 		goto unlock;
+	}
 
 	inode_inc_iversion(new_dir);
 	new_dir->i_ctime = new_dir->i_mtime = new_dir->i_atime =
@@ -44,6 +44,8 @@ static void exfat_put_super(struct super_block *sb)
 {
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
 
+	cancel_delayed_work_sync(&sbi->commit_work);
+
 	mutex_lock(&sbi->s_lock);
 	exfat_free_bitmap(sbi);
 	brelse(sbi->boot_bh);
@@ -69,6 +71,29 @@ static int exfat_sync_fs(struct super_block *sb, int wait)
 	return err;
 }
 
+/*
+ * Write back the bitmap and FAT sectors dirtied since the last run, so that
+ * at most commit_interval seconds of allocations are lost on power cut,
+ * without writing each of them as they are made.
+ */
+static void exfat_commit_work(struct work_struct *work)
+{
+	struct exfat_sb_info *sbi = container_of(to_delayed_work(work),
+			struct exfat_sb_info, commit_work);
+
+	sync_blockdev(sbi->sb->s_bdev);
+}
+
+void exfat_schedule_commit(struct super_block *sb)
+{
+	struct exfat_sb_info *sbi = EXFAT_SB(sb);
+
+	/* Does nothing if a commit is already pending */
+	if (sbi->options.commit_interval)
+		queue_delayed_work(system_long_wq, &sbi->commit_work,
+				sbi->options.commit_interval * HZ);
+}
+
 static int exfat_statfs(struct dentry *dentry, struct kstatfs *buf)
 {
 	struct super_block *sb = dentry->d_sb;
@@ -175,6 +200,8 @@ static int exfat_show_options(struct seq_file *m, struct dentry *root)
 		seq_puts(m, ",discard");
 	if (opts->time_offset)
 		seq_printf(m, ",time_offset=%d", opts->time_offset);
+	if (opts->commit_interval)
+		seq_printf(m, ",commit=%u", opts->commit_interval);
 	return 0;
 }
 
@@ -217,6 +244,7 @@ enum {
 	Opt_errors,
 	Opt_discard,
 	Opt_time_offset,
+	Opt_commit,
 
 	/* Deprecated options */
 	Opt_utf8,
@@ -243,6 +271,7 @@ static const struct fs_parameter_spec exfat_parameters[] = {
 	fsparam_enum("errors",			Opt_errors, exfat_param_enums),
 	fsparam_flag("discard",			Opt_discard),
 	fsparam_s32("time_offset",		Opt_time_offset),
+	fsparam_u32("commit",			Opt_commit),
 	__fsparam(NULL, "utf8",			Opt_utf8, fs_param_deprecated,
 		  NULL),
 	__fsparam(NULL, "debug",		Opt_debug, fs_param_deprecated,
@@ -305,6 +334,11 @@ static int exfat_parse_param(struct fs_context *fc, struct fs_parameter *param)
 			return -EINVAL;
 		opts->time_offset = result.int_32;
 		break;
+	case Opt_commit:
+		if (result.uint_32 > INT_MAX / HZ)
+			return -EINVAL;
+		opts->commit_interval = result.uint_32;
+		break;
 	case Opt_utf8:
 	case Opt_debug:
 	case Opt_namecase:
@@ -622,6 +656,8 @@ static int exfat_fill_super(struct super_block *sb, struct fs_context *fc)
 	struct inode *root_inode;
 	int err;
 
+	sbi->sb = sb;
+
 	if (opts->allow_utime == (unsigned short)-1)
 		opts->allow_utime = ~opts->fs_dmask & 0022;
 
@@ -753,6 +789,7 @@ static int exfat_init_fs_context(struct fs_context *fc)
 
 	mutex_init(&sbi->s_lock);
 	mutex_init(&sbi->bitmap_lock);
+	INIT_DELAYED_WORK(&sbi->commit_work, exfat_commit_work);
 	ratelimit_state_init(&sbi->ratelimit, DEFAULT_RATELIMIT_INTERVAL,
 			DEFAULT_RATELIMIT_BURST);
 
@@ -787,6 +824,7 @@ static void exfat_inode_init_once(void *foo)
 	ei->cache_valid_id = EXFAT_CACHE_VALID + 1;
 	INIT_LIST_HEAD(&ei->cache_lru);
 	INIT_HLIST_NODE(&ei->i_hash_fat);
+	ei->dir_index = NULL;
 	inode_init_once(&ei->vfs_inode);
 }
 
@@ -12,11 +12,15 @@
 #include <linux/slab.h>
 #include "fat.h"
 
-/* this must be > 0. */
-#define FAT_MAX_CACHE	8
+/*
+ * this must be > 0. The caches are looked up through a rbtree, so this can
+ * be large enough to map the whole chain of big fragmented files.
+ */
+#define FAT_MAX_CACHE	64
 
 struct fat_cache {
 	struct list_head cache_list;
+	struct rb_node rb_node;	/* in the cache_tree, sorted by fcluster */
 	int nr_contig;	/* number of contiguous clusters */
 	int fcluster;	/* cluster number in the file. */
 	int dcluster;	/* cluster number on disk. */
@@ -81,25 +85,25 @@ static int fat_cache_lookup(struct inode *inode, int fclus,
 			    struct fat_cache_id *cid,
 			    int *cached_fclus, int *cached_dclus)
 {
-	static struct fat_cache nohit = { .fcluster = 0, };
-
-	struct fat_cache *hit = &nohit, *p;
+	struct fat_cache *hit = NULL, *p;
+	struct rb_node *node;
 	int offset = -1;
 
 	spin_lock(&MSDOS_I(inode)->cache_lru_lock);
-	list_for_each_entry(p, &MSDOS_I(inode)->cache_lru, cache_list) {
-		/* Find the cache of "fclus" or nearest cache. */
-		if (p->fcluster <= fclus && hit->fcluster < p->fcluster) {
+	/* Find the cache of "fclus" or nearest cache. */
+	node = MSDOS_I(inode)->cache_tree.rb_node;
+	while (node) {
+		p = rb_entry(node, struct fat_cache, rb_node);
+		if (p->fcluster <= fclus) {
 			hit = p;
-			if ((hit->fcluster + hit->nr_contig) < fclus) {
-				offset = hit->nr_contig;
-			} else {
-				offset = fclus - hit->fcluster;
-				break;
-			}
+			node = node->rb_right;
+		} else {
+			node = node->rb_left;
 		}
 	}
-	if (hit != &nohit) {
+	if (hit) {
+		offset = min(fclus - hit->fcluster, hit->nr_contig);
+
 		fat_cache_update_lru(inode, hit);
 
 		cid->id = MSDOS_I(inode)->cache_valid_id;
@@ -117,9 +121,11 @@ static int fat_cache_lookup(struct inode *inode, int fclus,
 static struct fat_cache *fat_cache_merge(struct inode *inode,
 					 struct fat_cache_id *new)
 {
+	struct rb_node *node = MSDOS_I(inode)->cache_tree.rb_node;
 	struct fat_cache *p;
 
-	list_for_each_entry(p, &MSDOS_I(inode)->cache_lru, cache_list) {
+	while (node) {
+		p = rb_entry(node, struct fat_cache, rb_node);
 		/* Find the same part as "new" in cluster-chain. */
 		if (p->fcluster == new->fcluster) {
 			BUG_ON(p->dcluster != new->dcluster);
@@ -127,10 +133,30 @@ static struct fat_cache *fat_cache_merge(struct inode *inode,
 				p->nr_contig = new->nr_contig;
 			return p;
 		}
+		node = new->fcluster < p->fcluster ? node->rb_left :
+						     node->rb_right;
 	}
 	return NULL;
 }
 
+static void fat_cache_insert(struct inode *inode, struct fat_cache *cache)
+{
+	struct rb_node **link = &MSDOS_I(inode)->cache_tree.rb_node;
+	struct rb_node *parent = NULL;
+	struct fat_cache *p;
+
+	while (*link) {
+		parent = *link;
+		p = rb_entry(parent, struct fat_cache, rb_node);
+		if (cache->fcluster < p->fcluster)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&cache->rb_node, parent, link);
+	rb_insert_color(&cache->rb_node, &MSDOS_I(inode)->cache_tree);
+}
+
 static void fat_cache_add(struct inode *inode, struct fat_cache_id *new)
 {
 	struct fat_cache *cache, *tmp;
@@ -168,10 +194,12 @@ static void fat_cache_add(struct inode *inode, struct fat_cache_id *new)
 		} else {
 			struct list_head *p = MSDOS_I(inode)->cache_lru.prev;
 			cache = list_entry(p, struct fat_cache, cache_list);
+			rb_erase(&cache->rb_node, &MSDOS_I(inode)->cache_tree);
 		}
 		cache->fcluster = new->fcluster;
 		cache->dcluster = new->dcluster;
 		cache->nr_contig = new->nr_contig;
+		fat_cache_insert(inode, cache);
 	}
 out_update_lru:
 	fat_cache_update_lru(inode, cache);
@@ -195,6 +223,7 @@ static void __fat_cache_inval_inode(struct inode *inode)
 		i->nr_caches--;
 		fat_cache_free(cache);
 	}
+	i->cache_tree = RB_ROOT;
 	/* Update. The copy of caches before this id is discarded. */
 	i->cache_valid_id++;
 	if (i->cache_valid_id == FAT_CACHE_VALID)
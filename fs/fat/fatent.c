@@ -4,6 +4,7 @@
  */
 
 #include <linux/blkdev.h>
+#include <linux/sched/mm.h>
 #include <linux/sched/signal.h>
 #include "fat.h"
 
@@ -461,6 +462,75 @@ static void fat_collect_bhs(struct buffer_head **bhs, int *nr_bhs,
 	}
 }
 
+static int __fat_count_free_clusters(struct super_block *sb);
+
+/*
+ * Build the in-memory bitmap of the free clusters, so that the allocator can
+ * skip the FAT blocks without free entries instead of reading them. This
+ * needs a scan of the whole FAT, so it is only done on the first allocation.
+ * If that fails, the allocator reads the FAT linearly until the next remount
+ * rather than retrying the allocation and the scan on every allocation.
+ */
+static void fat_build_free_map(struct super_block *sb)
+{
+	struct msdos_sb_info *sbi = MSDOS_SB(sb);
+	unsigned int nofs_flags;
+
+	nofs_flags = memalloc_nofs_save();
+	sbi->free_map = kvzalloc(BITS_TO_LONGS(sbi->max_cluster) *
+				 sizeof(unsigned long),
+				 GFP_KERNEL | __GFP_NOWARN);
+	memalloc_nofs_restore(nofs_flags);
+	if (!sbi->free_map)
+		goto failed;
+
+	if (__fat_count_free_clusters(sb)) {
+		kvfree(sbi->free_map);
+		sbi->free_map = NULL;
+		goto failed;
+	}
+
+	return;
+
+failed:
+	sbi->free_map_failed = 1;
+}
+
+/* Let the next allocation try to build the free cluster map again. */
+void fat_retry_free_map(struct super_block *sb)
+{
+	struct msdos_sb_info *sbi = MSDOS_SB(sb);
+
+	lock_fat(sbi);
+	sbi->free_map_failed = 0;
+	unlock_fat(sbi);
+}
+
+/*
+ * Move the entry to the next free cluster according to the free map, and
+ * return the number of entries skipped (more than the number of clusters if
+ * there is no free cluster).
+ */
+static int fat_skip_used_clusters(struct msdos_sb_info *sbi,
+				  struct fat_entry *fatent)
+{
+	unsigned long next;
+	int skipped;
+
+	next = find_next_bit(sbi->free_map, sbi->max_cluster, fatent->entry);
+	if (next < sbi->max_cluster) {
+		skipped = next - fatent->entry;
+	} else {
+		skipped = sbi->max_cluster - fatent->entry;
+		next = find_next_bit(sbi->free_map, sbi->max_cluster,
+				     FAT_START_ENT);
+		skipped += next - FAT_START_ENT;
+	}
+	fatent->entry = next;
+
+	return skipped;
+}
+
 int fat_alloc_clusters(struct inode *inode, int *cluster, int nr_cluster)
 {
 	struct super_block *sb = inode->i_sb;
@@ -473,6 +543,9 @@ int fat_alloc_clusters(struct inode *inode, int *cluster, int nr_cluster)
 	BUG_ON(nr_cluster > (MAX_BUF_PER_PAGE / 2));	/* fixed limit */
 
 	lock_fat(sbi);
+	if (!sbi->free_map && !sbi->free_map_failed)
+		fat_build_free_map(sb);
+
 	if (sbi->free_clusters != -1 && sbi->free_clus_valid &&
 	    sbi->free_clusters < nr_cluster) {
 		unlock_fat(sbi);
@@ -487,6 +560,12 @@ int fat_alloc_clusters(struct inode *inode, int *cluster, int nr_cluster)
 	while (count < sbi->max_cluster) {
 		if (fatent.entry >= sbi->max_cluster)
 			fatent.entry = FAT_START_ENT;
+		if (sbi->free_map) {
+			/* Don't read the blocks without free entries */
+			count += fat_skip_used_clusters(sbi, &fatent);
+			if (count >= sbi->max_cluster)
+				break;
+		}
 		fatent_set_entry(&fatent, fatent.entry);
 		err = fat_ent_read_block(sb, &fatent);
 		if (err)
@@ -504,6 +583,8 @@ int fat_alloc_clusters(struct inode *inode, int *cluster, int nr_cluster)
 
 				fat_collect_bhs(bhs, &nr_bhs, &fatent);
 
+				if (sbi->free_map)
+					__clear_bit(entry, sbi->free_map);
 				sbi->prev_free = entry;
 				if (sbi->free_clusters != -1)
 					sbi->free_clusters--;
@@ -593,6 +674,8 @@ int fat_free_clusters(struct inode *inode, int cluster)
 		}
 
 		ops->ent_put(&fatent, FAT_ENT_FREE);
+		if (sbi->free_map)
+			__set_bit(fatent.entry, sbi->free_map);
 		if (sbi->free_clusters != -1) {
 			sbi->free_clusters++;
 			dirty_fsinfo = 1;
@@ -711,17 +794,17 @@ static void fat_ent_reada(struct super_block *sb, struct fatent_ra *ra,
 	ra->cur++;
 }
 
-int fat_count_free_clusters(struct super_block *sb)
+/* Must be called with the FAT locked. Also fills the free map, if any. */
+static int __fat_count_free_clusters(struct super_block *sb)
 {
 	struct msdos_sb_info *sbi = MSDOS_SB(sb);
 	const struct fatent_operations *ops = sbi->fatent_ops;
 	struct fat_entry fatent;
 	struct fatent_ra fatent_ra;
-	int err = 0, free;
+	int err, free;
 
-	lock_fat(sbi);
-	if (sbi->free_clusters != -1 && sbi->free_clus_valid)
-		goto out;
+	if (sbi->free_map)
+		bitmap_zero(sbi->free_map, sbi->max_cluster);
 
 	free = 0;
 	fatent_init(&fatent);
@@ -733,11 +816,14 @@ int fat_count_free_clusters(struct super_block *sb)
 
 		err = fat_ent_read_block(sb, &fatent);
 		if (err)
-			goto out;
+			return err;
 
 		do {
-			if (ops->ent_get(&fatent) == FAT_ENT_FREE)
+			if (ops->ent_get(&fatent) == FAT_ENT_FREE) {
+				if (sbi->free_map)
+					__set_bit(fatent.entry, sbi->free_map);
 				free++;
+			}
 		} while (fat_ent_next(sbi, &fatent));
 		cond_resched();
 	}
@@ -745,7 +831,17 @@ int fat_count_free_clusters(struct super_block *sb)
 	sbi->free_clus_valid = 1;
 	mark_fsinfo_dirty(sb);
 	fatent_brelse(&fatent);
-out:
+	return 0;
+}
+
+int fat_count_free_clusters(struct super_block *sb)
+{
+	struct msdos_sb_info *sbi = MSDOS_SB(sb);
+	int err = 0;
+
+	lock_fat(sbi);
+	if (sbi->free_clusters == -1 || !sbi->free_clus_valid)
+		err = __fat_count_free_clusters(sb);
 	unlock_fat(sbi);
 	return err;
 }
@@ -16,6 +16,7 @@
 #include <linux/fsnotify.h>
 #include <linux/security.h>
 #include <linux/falloc.h>
+#include <linux/iomap.h>
 #include "fat.h"
 
 static long fat_fallocate(struct file *file, int mode,
@@ -198,11 +199,95 @@ int fat_file_fsync(struct file *filp, loff_t start, loff_t end, int datasync)
 	return blkdev_issue_flush(inode->i_sb->s_bdev);
 }
 
+static ssize_t fat_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
+{
+	struct inode *inode = file_inode(iocb->ki_filp);
+	ssize_t ret;
+
+	if (!(iocb->ki_flags & IOCB_DIRECT))
+		return generic_file_read_iter(iocb, to);
+
+	if (!iov_iter_count(to))
+		return 0;
+
+	inode_lock_shared(inode);
+	file_accessed(iocb->ki_filp);
+	ret = iomap_dio_rw(iocb, to, &fat_iomap_ops, NULL, 0);
+	inode_unlock_shared(inode);
+
+	return ret;
+}
+
+static ssize_t fat_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
+{
+	struct file *file = iocb->ki_filp;
+	struct inode *inode = file_inode(file);
+	loff_t pos, end;
+	ssize_t ret;
+	int err;
+
+	if (!(iocb->ki_flags & IOCB_DIRECT))
+		return generic_file_write_iter(iocb, from);
+
+	inode_lock(inode);
+	ret = generic_write_checks(iocb, from);
+	if (ret <= 0)
+		goto out_unlock;
+
+	ret = file_remove_privs(file);
+	if (ret)
+		goto out_unlock;
+	ret = file_update_time(file);
+	if (ret)
+		goto out_unlock;
+
+	/*
+	 * Extending writes have to zero the gap from ->mmu_private, allocate
+	 * the clusters through ->write_begin() and update i_size, so they fall
+	 * back to buffered I/O.
+	 */
+	if (iocb->ki_pos + iov_iter_count(from) <= i_size_read(inode)) {
+		ret = iomap_dio_rw(iocb, from, &fat_iomap_ops, NULL, 0);
+		if (ret != -ENOTBLK)
+			goto out_unlock;
+	}
+
+	/*
+	 * Write through the page cache, then write the pages back and drop
+	 * them, so that the data is on disk as with direct I/O.
+	 */
+	pos = iocb->ki_pos;
+	current->backing_dev_info = inode_to_bdi(inode);
+	ret = generic_perform_write(file, from, pos);
+	current->backing_dev_info = NULL;
+	if (ret > 0) {
+		end = pos + ret - 1;
+		err = filemap_write_and_wait_range(file->f_mapping, pos, end);
+		if (!err) {
+			iocb->ki_pos = pos + ret;
+			invalidate_mapping_pages(file->f_mapping,
+						 pos >> PAGE_SHIFT,
+						 end >> PAGE_SHIFT);
+		} else {
+			ret = err;
+		}
+	}
+	inode_unlock(inode);
+
+	if (ret > 0)
+		ret = generic_write_sync(iocb, ret);
+	return ret;
+
+out_unlock:
+	inode_unlock(inode);
+	return ret;
+}
+
 
 const struct file_operations fat_file_operations = {
 	.llseek		= generic_file_llseek,
-	.read_iter	= generic_file_read_iter,
-	.write_iter	= generic_file_write_iter,
+	.read_iter	= fat_file_read_iter,
+	.write_iter	= fat_file_write_iter,
 	.mmap		= generic_file_mmap,
 	.release	= fat_file_release,
 	.unlocked_ioctl	= fat_generic_ioctl,
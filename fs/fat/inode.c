@@ -14,6 +14,7 @@
 #include <linux/module.h>
 #include <linux/pagemap.h>
 #include <linux/mpage.h>
+#include <linux/iomap.h>
 #include <linux/vfs.h>
 #include <linux/seq_file.h>
 #include <linux/parser.h>
@@ -257,41 +258,62 @@ static int fat_write_end(struct file *file, struct address_space *mapping,
 	return err;
 }
 
-static ssize_t fat_direct_IO(struct kiocb *iocb, struct iov_iter *iter)
+/*
+ * Map the blocks at @offset for direct I/O. Direct writes never extend the
+ * file, allocation is left to the buffered path, so only lookups are done
+ * here. As many clusters as the FAT chain keeps contiguous are merged into a
+ * single extent, so that a large request is issued as a few big bios.
+ */
+static int fat_iomap_begin(struct inode *inode, loff_t offset, loff_t length,
+			   unsigned int flags, struct iomap *iomap,
+			   struct iomap *srcmap)
 {
-	struct file *file = iocb->ki_filp;
-	struct address_space *mapping = file->f_mapping;
-	struct inode *inode = mapping->host;
-	size_t count = iov_iter_count(iter);
-	loff_t offset = iocb->ki_pos;
-	ssize_t ret;
-
-	if (iov_iter_rw(iter) == WRITE) {
-		/*
-		 * FIXME: blockdev_direct_IO() doesn't use ->write_begin(),
-		 * so we need to update the ->mmu_private to block boundary.
-		 *
-		 * But we must fill the remaining area or hole by nul for
-		 * updating ->mmu_private.
-		 *
-		 * Return 0, and fallback to normal buffered write.
-		 */
-		loff_t size = offset + count;
-		if (MSDOS_I(inode)->mmu_private < size)
-			return 0;
+	struct super_block *sb = inode->i_sb;
+	unsigned int blkbits = inode->i_blkbits;
+	sector_t iblock = offset >> blkbits;
+	sector_t end = (offset + length + sb->s_blocksize - 1) >> blkbits;
+	sector_t phys, next, next_phys;
+	unsigned long mapped_blocks;
+	int err;
+
+	err = fat_bmap(inode, iblock, &phys, &mapped_blocks, 0, false);
+	if (err)
+		return err;
+
+	iomap->bdev = sb->s_bdev;
+	iomap->offset = (loff_t)iblock << blkbits;
+
+	if (!phys) {
+		if (flags & IOMAP_WRITE)
+			return -EIO;
+		iomap->type = IOMAP_HOLE;
+		iomap->addr = IOMAP_NULL_ADDR;
+		iomap->length = (loff_t)(end - iblock) << blkbits;
+		return 0;
 	}
 
-	/*
-	 * FAT need to use the DIO_LOCKING for avoiding the race
-	 * condition of fat_get_block() and ->truncate().
-	 */
-	ret = blockdev_direct_IO(iocb, inode, iter, fat_get_block);
-	if (ret < 0 && iov_iter_rw(iter) == WRITE)
-		fat_write_failed(mapping, offset + count);
+	next = iblock + mapped_blocks;
+	while (next < end) {
+		err = fat_bmap(inode, next, &next_phys, &mapped_blocks, 0,
+			       false);
+		if (err)
+			return err;
+		if (next_phys != phys + (next - iblock))
+			break;
+		next += mapped_blocks;
+	}
 
-	return ret;
+	iomap->type = IOMAP_MAPPED;
+	iomap->addr = (u64)phys << blkbits;
+	iomap->length = (loff_t)(min(next, end) - iblock) << blkbits;
+
+	return 0;
 }
 
+const struct iomap_ops fat_iomap_ops = {
+	.iomap_begin	= fat_iomap_begin,
+};
+
 static int fat_get_block_bmap(struct inode *inode, sector_t iblock,
 		struct buffer_head *bh_result, int create)
 {
@@ -348,7 +370,7 @@ static const struct address_space_operations fat_aops = {
 	.writepages	= fat_writepages,
 	.write_begin	= fat_write_begin,
 	.write_end	= fat_write_end,
-	.direct_IO	= fat_direct_IO,
+	.direct_IO	= noop_direct_IO,
 	.bmap		= _fat_bmap
 };
 
@@ -721,6 +743,7 @@ static void fat_reset_iocharset(struct fat_mount_options *opts)
 static void delayed_free(struct rcu_head *p)
 {
 	struct msdos_sb_info *sbi = container_of(p, struct msdos_sb_info, rcu);
+	kvfree(sbi->free_map);
 	unload_nls(sbi->nls_disk);
 	unload_nls(sbi->nls_io);
 	fat_reset_iocharset(&sbi->options);
@@ -772,6 +795,7 @@ static void init_once(void *foo)
 	ei->nr_caches = 0;
 	ei->cache_valid_id = FAT_CACHE_VALID + 1;
 	INIT_LIST_HEAD(&ei->cache_lru);
+	ei->cache_tree = RB_ROOT;
 	INIT_HLIST_NODE(&ei->i_fat_hash);
 	INIT_HLIST_NODE(&ei->i_dir_hash);
 	inode_init_once(&ei->vfs_inode);
@@ -807,6 +831,8 @@ static int fat_remount(struct super_block *sb, int *flags, char *data)
 
 	sync_filesystem(sb);
 
+	fat_retry_free_map(sb);
+
 	/* make sure we update state on remount. */
 	new_rdonly = *flags & SB_RDONLY;
 	if (new_rdonly != sb_rdonly(sb)) {
@@ -15,6 +15,7 @@
 
 #include <linux/fuse.h>
 #include <linux/fs.h>
+#include <linux/idr.h>
 #include <linux/mount.h>
 #include <linux/wait.h>
 #include <linux/list.h>
@@ -180,6 +181,14 @@ struct fuse_conn;
 struct fuse_mount;
 struct fuse_release_args;
 
+/** Backing file the I/O of a FUSE_PASSTHROUGH file is forwarded to */
+struct fuse_passthrough {
+	struct file *filp;
+
+	/* Credentials of the daemon, used to access the backing file */
+	struct cred *cred;
+};
+
 /** FUSE specific file data */
 struct fuse_file {
 	/** Fuse connection for this file */
@@ -231,6 +240,9 @@ struct fuse_file {
 	/** Wait queue head for poll */
 	wait_queue_head_t poll_wait;
 
+	/** Backing file, filp is NULL unless passthrough was set up */
+	struct fuse_passthrough passthrough;
+
 	/** Has flock been performed on this file? */
 	bool flock:1;
 };
@@ -648,6 +660,9 @@ struct fuse_conn {
 	 */
 	unsigned handle_killpriv_v2:1;
 
+	/** Can read/write/mmap be passed through to a backing file? */
+	unsigned passthrough:1;
+
 	/*
 	 * The following bitfields are only for optimization purposes
 	 * and hence races in setting them will not cause malfunction
@@ -804,6 +819,12 @@ struct fuse_conn {
 
 	/** List of filesystems using this connection */
 	struct list_head mounts;
+
+	/** Backing files registered by the daemon, not yet used by an open */
+	struct idr passthrough_req;
+
+	/** Protects passthrough_req */
+	spinlock_t passthrough_req_lock;
 };
 
 /*
@@ -1244,6 +1265,16 @@ void fuse_dax_inode_cleanup(struct inode *inode);
 bool fuse_dax_check_alignment(struct fuse_conn *fc, unsigned int map_alignment);
 void fuse_dax_cancel_work(struct fuse_conn *fc);
 
+/* passthrough.c */
+int fuse_passthrough_open(struct fuse_dev *fud, u32 lower_fd);
+int fuse_passthrough_setup(struct fuse_conn *fc, struct fuse_file *ff,
+			   struct fuse_open_out *openarg);
+void fuse_passthrough_release(struct fuse_passthrough *passthrough);
+void fuse_passthrough_free_reqs(struct fuse_conn *fc);
+ssize_t fuse_passthrough_read_iter(struct kiocb *iocb, struct iov_iter *to);
+ssize_t fuse_passthrough_write_iter(struct kiocb *iocb, struct iov_iter *from);
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma);
+
 /* ioctl.c */
 long fuse_file_ioctl(struct file *file, unsigned int cmd, unsigned long arg);
 long fuse_file_compat_ioctl(struct file *file, unsigned int cmd,
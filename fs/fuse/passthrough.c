@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * FUSE passthrough: read/write/mmap of a fuse file are forwarded to a
+ * backing file opened by the daemon, without a round trip through
+ * /dev/fuse.
+ */
+
+#include "fuse_i.h"
+
+#include <linux/cred.h>
+#include <linux/file.h>
+#include <linux/uio.h>
+
+struct fuse_aio_req {
+	struct kiocb iocb;
+	struct kiocb *iocb_fuse;
+};
+
+static rwf_t fuse_iocb_to_rwf(int ifl)
+{
+	rwf_t flags = 0;
+
+	if (ifl & IOCB_NOWAIT)
+		flags |= RWF_NOWAIT;
+	if (ifl & IOCB_HIPRI)
+		flags |= RWF_HIPRI;
+	if (ifl & IOCB_DSYNC)
+		flags |= RWF_DSYNC;
+	if (ifl & IOCB_SYNC)
+		flags |= RWF_SYNC;
+
+	return flags;
+}
+
+/* Update the size of the fuse inode after a write to the backing file */
+static void fuse_passthrough_copyattr(struct file *fuse_filp,
+				      struct file *passthrough_filp)
+{
+	struct inode *inode = file_inode(fuse_filp);
+	struct fuse_inode *fi = get_fuse_inode(inode);
+	struct fuse_conn *fc = get_fuse_conn(inode);
+
+	spin_lock(&fi->lock);
+	fi->attr_version = atomic64_inc_return(&fc->attr_version);
+	i_size_write(inode, i_size_read(file_inode(passthrough_filp)));
+	spin_unlock(&fi->lock);
+
+	/* mtime and ctime changed as well */
+	fuse_invalidate_attr(inode);
+}
+
+static void fuse_aio_cleanup_handler(struct fuse_aio_req *aio_req)
+{
+	struct kiocb *iocb = &aio_req->iocb;
+	struct kiocb *iocb_fuse = aio_req->iocb_fuse;
+
+	if (iocb->ki_flags & IOCB_WRITE) {
+		/* Actually acquired in fuse_passthrough_write_iter() */
+		__sb_writers_acquired(file_inode(iocb->ki_filp)->i_sb,
+				      SB_FREEZE_WRITE);
+		file_end_write(iocb->ki_filp);
+		fuse_passthrough_copyattr(iocb_fuse->ki_filp, iocb->ki_filp);
+	}
+
+	iocb_fuse->ki_pos = iocb->ki_pos;
+	kfree(aio_req);
+}
+
+static void fuse_aio_rw_complete(struct kiocb *iocb, long res, long res2)
+{
+	struct fuse_aio_req *aio_req =
+		container_of(iocb, struct fuse_aio_req, iocb);
+	struct kiocb *iocb_fuse = aio_req->iocb_fuse;
+
+	fuse_aio_cleanup_handler(aio_req);
+	iocb_fuse->ki_complete(iocb_fuse, res, res2);
+}
+
+ssize_t fuse_passthrough_read_iter(struct kiocb *iocb_fuse,
+				   struct iov_iter *iter)
+{
+	struct fuse_file *ff = iocb_fuse->ki_filp->private_data;
+	struct file *passthrough_filp = ff->passthrough.filp;
+	struct fuse_aio_req *aio_req;
+	const struct cred *old_cred;
+	ssize_t ret;
+
+	if (!iov_iter_count(iter))
+		return 0;
+
+	old_cred = override_creds(ff->passthrough.cred);
+	if (is_sync_kiocb(iocb_fuse)) {
+		ret = vfs_iter_read(passthrough_filp, iter, &iocb_fuse->ki_pos,
+				    fuse_iocb_to_rwf(iocb_fuse->ki_flags));
+	} else {
+		ret = -ENOMEM;
+		aio_req = kmalloc(sizeof(*aio_req), GFP_KERNEL);
+		if (!aio_req)
+			goto out;
+
+		aio_req->iocb_fuse = iocb_fuse;
+		kiocb_clone(&aio_req->iocb, iocb_fuse, passthrough_filp);
+		aio_req->iocb.ki_complete = fuse_aio_rw_complete;
+		ret = vfs_iocb_iter_read(passthrough_filp, &aio_req->iocb, iter);
+		if (ret != -EIOCBQUEUED)
+			fuse_aio_cleanup_handler(aio_req);
+	}
+out:
+	revert_creds(old_cred);
+
+	return ret;
+}
+
+ssize_t fuse_passthrough_write_iter(struct kiocb *iocb_fuse,
+				    struct iov_iter *iter)
+{
+	struct file *fuse_filp = iocb_fuse->ki_filp;
+	struct fuse_file *ff = fuse_filp->private_data;
+	struct inode *inode = file_inode(fuse_filp);
+	struct file *passthrough_filp = ff->passthrough.filp;
+	struct fuse_aio_req *aio_req;
+	const struct cred *old_cred;
+	ssize_t ret;
+
+	if (!iov_iter_count(iter))
+		return 0;
+
+	inode_lock(inode);
+	old_cred = override_creds(ff->passthrough.cred);
+	if (is_sync_kiocb(iocb_fuse)) {
+		file_start_write(passthrough_filp);
+		ret = vfs_iter_write(passthrough_filp, iter, &iocb_fuse->ki_pos,
+				     fuse_iocb_to_rwf(iocb_fuse->ki_flags));
+		file_end_write(passthrough_filp);
+		if (ret > 0)
+			fuse_passthrough_copyattr(fuse_filp, passthrough_filp);
+	} else {
+		ret = -ENOMEM;
+		aio_req = kmalloc(sizeof(*aio_req), GFP_KERNEL);
+		if (!aio_req)
+			goto out;
+
+		file_start_write(passthrough_filp);
+		/* Pacify lockdep, see fuse_aio_cleanup_handler() */
+		__sb_writers_release(file_inode(passthrough_filp)->i_sb,
+				     SB_FREEZE_WRITE);
+
+		aio_req->iocb_fuse = iocb_fuse;
+		kiocb_clone(&aio_req->iocb, iocb_fuse, passthrough_filp);
+		aio_req->iocb.ki_complete = fuse_aio_rw_complete;
+		ret = vfs_iocb_iter_write(passthrough_filp, &aio_req->iocb, iter);
+		if (ret != -EIOCBQUEUED)
+			fuse_aio_cleanup_handler(aio_req);
+	}
+out:
+	revert_creds(old_cred);
+	inode_unlock(inode);
+
+	return ret;
+}
+
+int fuse_passthrough_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct fuse_file *ff = file->private_data;
+	struct file *passthrough_filp = ff->passthrough.filp;
+	const struct cred *old_cred;
+	int ret;
+
+	if (!passthrough_filp->f_op->mmap)
+		return -ENODEV;
+
+	if (WARN_ON(file != vma->vm_file))
+		return -EIO;
+
+	vma_set_file(vma, passthrough_filp);
+
+	old_cred = override_creds(ff->passthrough.cred);
+	ret = call_mmap(vma->vm_file, vma);
+	revert_creds(old_cred);
+
+	file_accessed(file);
+
+	return ret;
+}
+
+/*
+ * Register @lower_fd as the backing file of the next open that replies with
+ * the returned identifier in passthrough_fh. The caller has to be privileged,
+ * as the backing file doesn't show up in the open files of any process once
+ * the daemon closes its descriptor.
+ */
+int fuse_passthrough_open(struct fuse_dev *fud, u32 lower_fd)
+{
+	struct fuse_conn *fc = fud->fc;
+	struct fuse_passthrough *passthrough;
+	struct file *passthrough_filp;
+	struct super_block *sb;
+	int res;
+
+	if (!fc->passthrough || !capable(CAP_SYS_ADMIN))
+		return -EPERM;
+
+	passthrough_filp = fget(lower_fd);
+	if (!passthrough_filp)
+		return -EBADF;
+
+	res = -EINVAL;
+	if (!passthrough_filp->f_op->read_iter)
+		goto out_fput;
+
+	/* Only a writable file needs to support writes */
+	if ((passthrough_filp->f_mode & FMODE_WRITE) &&
+	    !passthrough_filp->f_op->write_iter)
+		goto out_fput;
+
+	/* Don't pass through to another passthrough fuse file */
+	sb = file_inode(passthrough_filp)->i_sb;
+	if (sb->s_stack_depth >= FILESYSTEM_MAX_STACK_DEPTH)
+		goto out_fput;
+
+	res = -ENOMEM;
+	passthrough = kmalloc(sizeof(*passthrough), GFP_KERNEL);
+	if (!passthrough)
+		goto out_fput;
+
+	passthrough->filp = passthrough_filp;
+	passthrough->cred = prepare_creds();
+	if (!passthrough->cred)
+		goto out_free;
+
+	idr_preload(GFP_KERNEL);
+	spin_lock(&fc->passthrough_req_lock);
+	res = idr_alloc(&fc->passthrough_req, passthrough, 1, 0, GFP_ATOMIC);
+	spin_unlock(&fc->passthrough_req_lock);
+	idr_preload_end();
+
+	if (res > 0)
+		return res;
+
+	put_cred(passthrough->cred);
+out_free:
+	kfree(passthrough);
+out_fput:
+	fput(passthrough_filp);
+
+	return res;
+}
+
+/*
+ * Called when the reply to an open carries a passthrough_fh. On failure the
+ * file falls back to the regular fuse I/O paths.
+ */
+int fuse_passthrough_setup(struct fuse_conn *fc, struct fuse_file *ff,
+			   struct fuse_open_out *openarg)
+{
+	struct fuse_passthrough *passthrough;
+	int passthrough_fh = openarg->passthrough_fh;
+
+	if (passthrough_fh <= 0)
+		return -EINVAL;
+
+	/* Identifiers are only valid for a single open */
+	spin_lock(&fc->passthrough_req_lock);
+	passthrough = idr_remove(&fc->passthrough_req, passthrough_fh);
+	spin_unlock(&fc->passthrough_req_lock);
+
+	if (!passthrough)
+		return -EINVAL;
+
+	ff->passthrough = *passthrough;
+	kfree(passthrough);
+
+	return 0;
+}
+
+void fuse_passthrough_release(struct fuse_passthrough *passthrough)
+{
+	if (passthrough->filp) {
+		fput(passthrough->filp);
+		passthrough->filp = NULL;
+	}
+	if (passthrough->cred) {
+		put_cred(passthrough->cred);
+		passthrough->cred = NULL;
+	}
+}
+
+static int fuse_passthrough_free_req(int id, void *p, void *data)
+{
+	struct fuse_passthrough *passthrough = p;
+
+	fuse_passthrough_release(passthrough);
+	kfree(passthrough);
+
+	return 0;
+}
+
+/* Drop the backing files that were registered but never used by an open */
+void fuse_passthrough_free_reqs(struct fuse_conn *fc)
+{
+	idr_for_each(&fc->passthrough_req, fuse_passthrough_free_req, NULL);
+	idr_destroy(&fc->passthrough_req);
+}
@@ -176,6 +176,73 @@ __releases(&journal->j_state_lock)
 	}
 }
 
+/*
+ * Background checkpointing starts when less than this many transactions
+ * worth of log space is left, and stops when it has freed that much.  Writers
+ * only wait for a checkpoint once less than one transaction worth is left.
+ */
+#define JBD2_BG_CHECKPOINT_TRANSACTIONS	2
+
+static bool jbd2_log_space_low(journal_t *journal)
+{
+	bool low;
+
+	read_lock(&journal->j_state_lock);
+	low = jbd2_log_space_left(journal) <
+	      JBD2_BG_CHECKPOINT_TRANSACTIONS *
+	      journal->j_max_transaction_buffers;
+	read_unlock(&journal->j_state_lock);
+
+	return low;
+}
+
+/*
+ * jbd2_log_start_checkpoint: free log space before writers have to wait
+ * for it.
+ *
+ * Called by the journal thread after a commit.  If the journal asked for it
+ * with JBD2_BG_CHECKPOINT and the log is getting full, the oldest
+ * transactions are checkpointed from a work item, instead of by the next
+ * writer which runs out of space in __jbd2_log_wait_for_space().
+ */
+void jbd2_log_start_checkpoint(journal_t *journal)
+{
+	if (!(journal->j_flags & JBD2_BG_CHECKPOINT) ||
+	    is_journal_aborted(journal))
+		return;
+
+	if (jbd2_log_space_low(journal))
+		queue_work(system_unbound_wq, &journal->j_checkpoint_work);
+}
+
+void jbd2_checkpoint_work(struct work_struct *work)
+{
+	journal_t *journal = container_of(work, journal_t, j_checkpoint_work);
+	bool more;
+
+	mutex_lock_io(&journal->j_checkpoint_mutex);
+
+	while (!is_journal_aborted(journal) && jbd2_log_space_low(journal)) {
+		spin_lock(&journal->j_list_lock);
+		more = journal->j_checkpoint_transactions != NULL;
+		spin_unlock(&journal->j_list_lock);
+
+		if (!more || jbd2_log_do_checkpoint(journal))
+			break;
+		cond_resched();
+	}
+
+	/*
+	 * jbd2_log_do_checkpoint() only advances the tail past what was
+	 * checkpointed before it was called; release the space freed by the
+	 * last one.
+	 */
+	if (!is_journal_aborted(journal))
+		jbd2_cleanup_journal_tail(journal);
+
+	mutex_unlock(&journal->j_checkpoint_mutex);
+}
+
 static void
 __flush_batch(journal_t *journal, int *batch_count)
 {
@@ -56,6 +56,11 @@ module_param_named(jbd2_debug, jbd2_journal_enable_debug, ushort, 0644);
 MODULE_PARM_DESC(jbd2_debug, "Debugging level for jbd2");
 #endif
 
+static bool jbd2_bg_checkpoint;
+module_param_named(bg_checkpoint, jbd2_bg_checkpoint, bool, 0644);
+MODULE_PARM_DESC(bg_checkpoint,
+		 "Checkpoint from a work item before the log is full");
+
 EXPORT_SYMBOL(jbd2_journal_extend);
 EXPORT_SYMBOL(jbd2_journal_stop);
 EXPORT_SYMBOL(jbd2_journal_lock_updates);
@@ -211,6 +216,7 @@ static int kjournald2(void *arg)
 		write_unlock(&journal->j_state_lock);
 		del_timer_sync(&journal->j_commit_timer);
 		jbd2_journal_commit_transaction(journal);
+		jbd2_log_start_checkpoint(journal);
 		write_lock(&journal->j_state_lock);
 		goto loop;
 	}
@@ -822,17 +828,23 @@ EXPORT_SYMBOL(jbd2_transaction_committed);
  * committing that transaction before waiting for it to complete.  If
  * the transaction id is stale, it is by definition already completed,
  * so just return SUCCESS.
+ *
+ * The commit is delayed a little, so that the fsyncs of other tasks can
+ * share it; see jbd2_journal_batch_sync().
  */
 int jbd2_complete_transaction(journal_t *journal, tid_t tid)
 {
 	int	need_to_wait = 1;
+	ktime_t	start_time;
 
 	read_lock(&journal->j_state_lock);
 	if (journal->j_running_transaction &&
 	    journal->j_running_transaction->t_tid == tid) {
 		if (journal->j_commit_request != tid) {
 			/* transaction not yet started, so request it */
+			start_time = journal->j_running_transaction->t_start_time;
 			read_unlock(&journal->j_state_lock);
+			jbd2_journal_batch_sync(journal, start_time);
 			jbd2_log_start_commit(journal, tid);
 			goto wait_commit;
 		}
@@ -1323,6 +1335,7 @@ static journal_t *journal_init_common(struct block_device *bdev,
 	mutex_init(&journal->j_abort_mutex);
 	mutex_init(&journal->j_barrier);
 	mutex_init(&journal->j_checkpoint_mutex);
+	INIT_WORK(&journal->j_checkpoint_work, jbd2_checkpoint_work);
 	spin_lock_init(&journal->j_revoke_lock);
 	spin_lock_init(&journal->j_list_lock);
 	rwlock_init(&journal->j_state_lock);
@@ -1334,6 +1347,8 @@ static journal_t *journal_init_common(struct block_device *bdev,
 
 	/* The journal is marked for error until we succeed with recovery! */
 	journal->j_flags = JBD2_ABORT;
+	if (jbd2_bg_checkpoint)
+		journal->j_flags |= JBD2_BG_CHECKPOINT;
 
 	/* Set up a default-sized revoke table for the new mount. */
 	err = jbd2_journal_init_revoke(journal, JOURNAL_REVOKE_DEFAULT_HASH);
@@ -1964,6 +1979,7 @@ int jbd2_journal_destroy(journal_t *journal)
 
 	/* Wait for the commit thread to wake up and die. */
 	journal_kill_thread(journal);
+	cancel_work_sync(&journal->j_checkpoint_work);
 
 	/* Force a final log commit */
 	if (journal->j_running_transaction)
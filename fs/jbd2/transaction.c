@@ -1767,6 +1767,67 @@ int jbd2_journal_forget(handle_t *handle, struct buffer_head *bh)
 	return err;
 }
 
+/**
+ * jbd2_journal_batch_sync() - wait for other synchronous updates to join
+ * @journal: journal about to be committed
+ * @start_time: start time of the running transaction
+ *
+ * Implement synchronous transaction batching.  If the update was
+ * synchronous, don't force a commit immediately.  Let's yield and let
+ * another thread piggyback onto this transaction.  Keep doing that while
+ * new threads continue to arrive.  It doesn't cost much - we're about to
+ * run a commit and sleep on IO anyway.  Speeds up many-threaded, many-dir
+ * operations by 30x or more...  This is used both for handles marked
+ * synchronous and for fsync(), which forces the commit of the running
+ * transaction through jbd2_complete_transaction().
+ *
+ * We try and optimize the sleep time against what the underlying disk can
+ * do, instead of having a static sleep time.  This is useful for the case
+ * where our storage is so fast that it is more optimal to go ahead and
+ * force a flush and wait for the transaction to be committed than it is to
+ * wait for an arbitrary amount of time for new writers to join the
+ * transaction.  We achieve this by measuring how long it takes to commit a
+ * transaction, and compare it with how long this transaction has been
+ * running, and if run time < commit time then we sleep for the delta and
+ * commit.  This greatly helps super fast disks that would see slowdowns as
+ * more threads started doing fsyncs.
+ *
+ * But don't do this if this process was the most recent one to perform a
+ * synchronous write.  We do this to detect the case where a single process
+ * is doing a stream of sync writes.  No point in waiting for joiners in
+ * that case.
+ *
+ * Setting max_batch_time to 0 disables this completely.
+ */
+void jbd2_journal_batch_sync(journal_t *journal, ktime_t start_time)
+{
+	pid_t pid = current->pid;
+	u64 commit_time, trans_time;
+
+	if (journal->j_last_sync_writer == pid || !journal->j_max_batch_time)
+		return;
+
+	journal->j_last_sync_writer = pid;
+
+	read_lock(&journal->j_state_lock);
+	commit_time = journal->j_average_commit_time;
+	read_unlock(&journal->j_state_lock);
+
+	trans_time = ktime_to_ns(ktime_sub(ktime_get(), start_time));
+
+	commit_time = max_t(u64, commit_time,
+			    1000*journal->j_min_batch_time);
+	commit_time = min_t(u64, commit_time,
+			    1000*journal->j_max_batch_time);
+
+	if (trans_time < commit_time) {
+		ktime_t expires = ktime_add_ns(ktime_get(), commit_time);
+
+		set_current_state(TASK_UNINTERRUPTIBLE);
+		schedule_hrtimeout(&expires, HRTIMER_MODE_ABS);
+	}
+}
+
 /**
  * jbd2_journal_stop() - complete a transaction
  * @handle: transaction to complete.
@@ -1789,7 +1850,6 @@ int jbd2_journal_stop(handle_t *handle)
 	journal_t *journal;
 	int err = 0, wait_for_commit = 0;
 	tid_t tid;
-	pid_t pid;
 
 	if (--handle->h_ref > 0) {
 		jbd_debug(4, "h_ref %d -> %d\n", handle->h_ref + 1,
@@ -1820,61 +1880,8 @@ int jbd2_journal_stop(handle_t *handle)
 				(handle->h_requested_credits -
 				 handle->h_total_credits));
 
-	/*
-	 * Implement synchronous transaction batching.  If the handle
-	 * was synchronous, don't force a commit immediately.  Let's
-	 * yield and let another thread piggyback onto this
-	 * transaction.  Keep doing that while new threads continue to
-	 * arrive.  It doesn't cost much - we're about to run a commit
-	 * and sleep on IO anyway.  Speeds up many-threaded, many-dir
-	 * operations by 30x or more...
-	 *
-	 * We try and optimize the sleep time against what the
-	 * underlying disk can do, instead of having a static sleep
-	 * time.  This is useful for the case where our storage is so
-	 * fast that it is more optimal to go ahead and force a flush
-	 * and wait for the transaction to be committed than it is to
-	 * wait for an arbitrary amount of time for new writers to
-	 * join the transaction.  We achieve this by measuring how
-	 * long it takes to commit a transaction, and compare it with
-	 * how long this transaction has been running, and if run time
-	 * < commit time then we sleep for the delta and commit.  This
-	 * greatly helps super fast disks that would see slowdowns as
-	 * more threads started doing fsyncs.
-	 *
-	 * But don't do this if this process was the most recent one
-	 * to perform a synchronous write.  We do this to detect the
-	 * case where a single process is doing a stream of sync
-	 * writes.  No point in waiting for joiners in that case.
-	 *
-	 * Setting max_batch_time to 0 disables this completely.
-	 */
-	pid = current->pid;
-	if (handle->h_sync && journal->j_last_sync_writer != pid &&
-	    journal->j_max_batch_time) {
-		u64 commit_time, trans_time;
-
-		journal->j_last_sync_writer = pid;
-
-		read_lock(&journal->j_state_lock);
-		commit_time = journal->j_average_commit_time;
-		read_unlock(&journal->j_state_lock);
-
-		trans_time = ktime_to_ns(ktime_sub(ktime_get(),
-						   transaction->t_start_time));
-
-		commit_time = max_t(u64, commit_time,
-				    1000*journal->j_min_batch_time);
-		commit_time = min_t(u64, commit_time,
-				    1000*journal->j_max_batch_time);
-
-		if (trans_time < commit_time) {
-			ktime_t expires = ktime_add_ns(ktime_get(),
-						       commit_time);
-			set_current_state(TASK_UNINTERRUPTIBLE);
-			schedule_hrtimeout(&expires, HRTIMER_MODE_ABS);
-		}
-	}
+	if (handle->h_sync)
+		jbd2_journal_batch_sync(journal, transaction->t_start_time);
 
 	if (handle->h_sync)
 		transaction->t_synchronous_commit = 1;
@@ -30,6 +30,9 @@ static inline struct super_block *fsnotify_conn_sb(
 /* destroy all events sitting in this groups notification queue */
 extern void fsnotify_flush_notify(struct fsnotify_group *group);
 
+/* wake up the readers of the group at the end of a batch */
+extern void fsnotify_notification_timer(struct timer_list *t);
+
 /* protects reads of inode and vfsmount marks list */
 extern struct srcu_struct fsnotify_mark_srcu;
 
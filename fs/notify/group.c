@@ -83,6 +83,9 @@ void fsnotify_destroy_group(struct fsnotify_group *group)
 	 */
 	fsnotify_flush_notify(group);
 
+	/* No new batch can start, cancel the wakeup of the last one */
+	del_timer_sync(&group->notification_timer);
+
 	/*
 	 * Destroy overflow event (we cannot use fsnotify_destroy_event() as
 	 * that deliberately ignores overflow events.
@@ -128,6 +131,7 @@ static struct fsnotify_group *__fsnotify_alloc_group(
 	INIT_LIST_HEAD(&group->notification_list);
 	init_waitqueue_head(&group->notification_waitq);
 	group->max_events = UINT_MAX;
+	timer_setup(&group->notification_timer, fsnotify_notification_timer, 0);
 
 	mutex_init(&group->mark_mutex);
 	INIT_LIST_HEAD(&group->marks_list);
@@ -12,6 +12,11 @@ struct inotify_event_info {
 	char name[];
 };
 
+/* How far back in the queue a new event is coalesced */
+#define INOTIFY_COALESCE_DEPTH		128
+/* Longest window INOTIFY_IOC_SETCOALESCE accepts, in milliseconds */
+#define INOTIFY_COALESCE_MAX_MS		10000
+
 struct inotify_inode_mark {
 	struct fsnotify_mark fsn_mark;
 	int wd;
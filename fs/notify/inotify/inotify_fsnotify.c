@@ -46,14 +46,36 @@ static bool event_compare(struct fsnotify_event *old_fsn,
 	return false;
 }
 
+/*
+ * Without coalescing, an event is only merged with the tail of the queue. With
+ * coalescing, it is merged with the last queued event of the same object if
+ * they are identical, which still keeps the order of the events of every
+ * object. Renames aren't coalesced, their cookies pair them in order.
+ */
 static int inotify_merge(struct fsnotify_group *group,
 			 struct fsnotify_event *event)
 {
 	struct list_head *list = &group->notification_list;
+	struct inotify_event_info *old, *new = INOTIFY_E(event);
 	struct fsnotify_event *last_event;
+	unsigned int depth = 0;
+
+	if (!group->notification_delay || new->sync_cookie) {
+		last_event = list_entry(list->prev, struct fsnotify_event,
+					list);
+		return event_compare(last_event, event);
+	}
 
-	last_event = list_entry(list->prev, struct fsnotify_event, list);
-	return event_compare(last_event, event);
+	list_for_each_entry_reverse(last_event, list, list) {
+		old = INOTIFY_E(last_event);
+		if (old->wd == new->wd && old->name_len == new->name_len &&
+		    (!old->name_len || !strcmp(old->name, new->name)))
+			return event_compare(last_event, event);
+		if (++depth >= INOTIFY_COALESCE_DEPTH)
+			break;
+	}
+
+	return 0;
 }
 
 int inotify_handle_inode_event(struct fsnotify_mark *inode_mark, u32 mask,
@@ -308,6 +308,14 @@ static long inotify_ioctl(struct file *file, unsigned int cmd,
 		spin_unlock(&group->notification_lock);
 		ret = put_user(send_len, (int __user *) p);
 		break;
+	case INOTIFY_IOC_SETCOALESCE:
+		ret = -EINVAL;
+		if (arg <= INOTIFY_COALESCE_MAX_MS) {
+			fsnotify_set_notification_delay(group,
+							msecs_to_jiffies(arg));
+			ret = 0;
+		}
+		break;
 #ifdef CONFIG_CHECKPOINT_RESTORE
 	case INOTIFY_IOC_SETNEXTWD:
 		ret = -EINVAL;
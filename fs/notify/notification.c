@@ -77,6 +77,10 @@ void fsnotify_destroy_event(struct fsnotify_group *group,
  * 1 if the event was merged with some other queued event
  * 2 if the event was not queued - either the queue of events has overflown
  *   or the group is shutting down.
+ *
+ * If the group has a notification delay, the readers aren't woken up for every
+ * event but once the first event of a batch has waited for the delay, so that
+ * they get the whole batch in a single read.
  */
 int fsnotify_add_event(struct fsnotify_group *group,
 		       struct fsnotify_event *event,
@@ -122,6 +126,15 @@ int fsnotify_add_event(struct fsnotify_group *group,
 	list_add_tail(&event->list, list);
 	if (insert)
 		insert(group, event);
+
+	/* Don't hold the overflow back, the readers are already late */
+	if (group->notification_delay && ret != 2) {
+		if (!timer_pending(&group->notification_timer))
+			mod_timer(&group->notification_timer,
+				  jiffies + group->notification_delay);
+		spin_unlock(&group->notification_lock);
+		return ret;
+	}
 	spin_unlock(&group->notification_lock);
 
 	wake_up(&group->notification_waitq);
@@ -129,6 +142,28 @@ int fsnotify_add_event(struct fsnotify_group *group,
 	return ret;
 }
 
+void fsnotify_notification_timer(struct timer_list *t)
+{
+	struct fsnotify_group *group = from_timer(group, t, notification_timer);
+
+	wake_up(&group->notification_waitq);
+	kill_fasync(&group->fsn_fa, SIGIO, POLL_IN);
+}
+
+void fsnotify_set_notification_delay(struct fsnotify_group *group,
+				     unsigned long delay)
+{
+	spin_lock(&group->notification_lock);
+	group->notification_delay = delay;
+	spin_unlock(&group->notification_lock);
+
+	/* Deliver the current batch if the events aren't batched anymore */
+	if (!delay && del_timer_sync(&group->notification_timer)) {
+		wake_up(&group->notification_waitq);
+		kill_fasync(&group->fsn_fa, SIGIO, POLL_IN);
+	}
+}
+
 void fsnotify_remove_queued_event(struct fsnotify_group *group,
 				  struct fsnotify_event *event)
 {
@@ -266,6 +266,8 @@ static int ovl_instantiate(struct dentry *dentry, struct inode *inode,
 	};
 
 	ovl_dir_modified(dentry->d_parent, false);
+	ovl_dir_cache_update(dentry->d_parent, &dentry->d_name, newdentry,
+			     OVL_DIR_ADD);
 	ovl_dentry_set_upper_alias(dentry);
 	ovl_dentry_update_reval(dentry, newdentry,
 			DCACHE_OP_REVALIDATE | DCACHE_OP_WEAK_REVALIDATE);
@@ -781,6 +783,8 @@ static int ovl_remove_and_whiteout(struct dentry *dentry,
 		goto out_d_drop;
 
 	ovl_dir_modified(dentry->d_parent, true);
+	ovl_dir_cache_update(dentry->d_parent, &dentry->d_name, NULL,
+			     OVL_DIR_WHITEOUT);
 out_d_drop:
 	d_drop(dentry);
 out_dput_upper:
@@ -826,6 +830,9 @@ static int ovl_remove_upper(struct dentry *dentry, bool is_dir,
 	else
 		err = vfs_unlink(&init_user_ns, dir, upper, NULL);
 	ovl_dir_modified(dentry->d_parent, ovl_type_origin(dentry));
+	if (!err)
+		ovl_dir_cache_update(dentry->d_parent, &dentry->d_name, NULL,
+				     OVL_DIR_REMOVE);
 
 	/*
 	 * Keeping this dentry hashed would mean having to release
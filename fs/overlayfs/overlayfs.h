@@ -445,12 +445,20 @@ static inline int ovl_verify_upper(struct ovl_fs *ofs, struct dentry *index,
 }
 
 /* readdir.c */
+enum ovl_dir_change {
+	OVL_DIR_ADD,		/* entry created in upper */
+	OVL_DIR_WHITEOUT,	/* entry replaced by a whiteout */
+	OVL_DIR_REMOVE,		/* upper entry removed */
+};
+
 extern const struct file_operations ovl_dir_operations;
 struct file *ovl_dir_real_file(const struct file *file, bool want_upper);
 int ovl_check_empty_dir(struct dentry *dentry, struct list_head *list);
 void ovl_cleanup_whiteouts(struct dentry *upper, struct list_head *list);
 void ovl_cache_free(struct list_head *list);
 void ovl_dir_cache_free(struct inode *inode);
+void ovl_dir_cache_update(struct dentry *dir, const struct qstr *name,
+			  struct dentry *upper, enum ovl_dir_change change);
 int ovl_check_d_type_supported(struct path *realpath);
 int ovl_workdir_cleanup(struct inode *dir, struct vfsmount *mnt,
 			struct dentry *dentry, int level);
@@ -235,13 +235,27 @@ void ovl_dir_cache_free(struct inode *inode)
 	}
 }
 
+/*
+ * The merged cache of a dir is kept after the last file iterating it is
+ * closed, so that the next opendir() does not have to read all the layers
+ * again. It is freed when it goes stale, or with the inode. This is only done
+ * when the layers are on the same st_dev: otherwise d_ino of an entry changes
+ * when it is copied up, which does not invalidate the cache of its parent.
+ */
+static bool ovl_cache_keep(struct ovl_dir_cache *cache, struct dentry *dentry)
+{
+	return ovl_dir_cache(d_inode(dentry)) == cache &&
+	       ovl_dentry_version_get(dentry) == cache->version &&
+	       ovl_same_dev(dentry->d_sb);
+}
+
 static void ovl_cache_put(struct ovl_dir_file *od, struct dentry *dentry)
 {
 	struct ovl_dir_cache *cache = od->cache;
 
 	WARN_ON(cache->refcount <= 0);
 	cache->refcount--;
-	if (!cache->refcount) {
+	if (!cache->refcount && !ovl_cache_keep(cache, dentry)) {
 		if (ovl_dir_cache(d_inode(dentry)) == cache)
 			ovl_set_dir_cache(d_inode(dentry), NULL);
 
@@ -250,6 +264,84 @@ static void ovl_cache_put(struct ovl_dir_file *od, struct dentry *dentry)
 	}
 }
 
+/*
+ * Apply a change made to @dir through the overlay to its merged cache, so
+ * that it does not have to be read again. Must be called after
+ * ovl_dir_modified(), with @dir locked.
+ *
+ * The cache can only be changed in place when no file is iterating it, and
+ * when it was up to date before the change. Otherwise it is left stale, to be
+ * rebuilt by the next ovl_cache_get().
+ */
+void ovl_dir_cache_update(struct dentry *dir, const struct qstr *name,
+			  struct dentry *upper, enum ovl_dir_change change)
+{
+	struct ovl_dir_cache *cache = ovl_dir_cache(d_inode(dir));
+	u64 version = ovl_dentry_version_get(dir);
+	struct ovl_cache_entry *p;
+	size_t size;
+
+	if (!cache || cache->refcount || ovl_dir_is_real(dir) ||
+	    cache->version != version - 1)
+		return;
+
+	p = ovl_cache_entry_find(&cache->root, name->name, name->len);
+
+	switch (change) {
+	case OVL_DIR_ADD:
+		if (!p) {
+			struct rb_node **newp = &cache->root.rb_node;
+			struct rb_node *parent = NULL;
+
+			size = offsetof(struct ovl_cache_entry,
+					name[name->len + 1]);
+			p = kmalloc(size, GFP_KERNEL);
+			if (!p)
+				return;
+
+			memcpy(p->name, name->name, name->len);
+			p->name[name->len] = '\0';
+			p->len = name->len;
+
+			ovl_cache_entry_find_link(p->name, p->len, &newp,
+						  &parent);
+			list_add_tail(&p->l_node, &cache->entries);
+			rb_link_node(&p->node, parent, newp);
+			rb_insert_color(&p->node, &cache->root);
+		} else if (!p->is_whiteout) {
+			return;
+		}
+
+		p->type = S_DT(d_inode(upper)->i_mode);
+		p->real_ino = d_inode(upper)->i_ino;
+		/* Set by ovl_iterate(), as for any upper entry */
+		p->ino = 0;
+		p->is_upper = true;
+		p->is_whiteout = false;
+		break;
+
+	case OVL_DIR_WHITEOUT:
+		if (!p || p->is_whiteout)
+			return;
+
+		p->type = DT_CHR;
+		p->is_upper = true;
+		p->is_whiteout = true;
+		break;
+
+	case OVL_DIR_REMOVE:
+		if (!p || p->is_whiteout)
+			return;
+
+		rb_erase(&p->node, &cache->root);
+		list_del(&p->l_node);
+		kfree(p);
+		break;
+	}
+
+	cache->version = version;
+}
+
 static int ovl_fill_merge(struct dir_context *ctx, const char *name,
 			  int namelen, loff_t offset, u64 ino,
 			  unsigned int d_type)
@@ -401,6 +493,12 @@ static struct ovl_dir_cache *ovl_cache_get(struct dentry *dentry)
 		cache->refcount++;
 		return cache;
 	}
+
+	/* A stale cache still in use is freed by its last user */
+	if (cache && !cache->refcount) {
+		ovl_cache_free(&cache->entries);
+		kfree(cache);
+	}
 	ovl_set_dir_cache(d_inode(dentry), NULL);
 
 	cache = kzalloc(sizeof(struct ovl_dir_cache), GFP_KERNEL);
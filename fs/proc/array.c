@@ -647,7 +647,6 @@ static int do_task_stat(struct seq_file *m, struct pid_namespace *ns,
 	else
 		seq_puts(m, " 0");
 
-	seq_putc(m, '\n');
 	if (mm)
 		mmput(mm);
 	return 0;
@@ -656,17 +655,20 @@ static int do_task_stat(struct seq_file *m, struct pid_namespace *ns,
 int proc_tid_stat(struct seq_file *m, struct pid_namespace *ns,
 			struct pid *pid, struct task_struct *task)
 {
-	return do_task_stat(m, ns, pid, task, 0);
+	do_task_stat(m, ns, pid, task, 0);
+	seq_putc(m, '\n');
+	return 0;
 }
 
 int proc_tgid_stat(struct seq_file *m, struct pid_namespace *ns,
 			struct pid *pid, struct task_struct *task)
 {
-	return do_task_stat(m, ns, pid, task, 1);
+	do_task_stat(m, ns, pid, task, 1);
+	seq_putc(m, '\n');
+	return 0;
 }
 
-int proc_pid_statm(struct seq_file *m, struct pid_namespace *ns,
-			struct pid *pid, struct task_struct *task)
+static void do_task_statm(struct seq_file *m, struct task_struct *task)
 {
 	struct mm_struct *mm = get_task_mm(task);
 
@@ -693,12 +695,92 @@ int proc_pid_statm(struct seq_file *m, struct pid_namespace *ns,
 		seq_put_decimal_ull(m, " ", 0);
 		seq_put_decimal_ull(m, " ", data);
 		seq_put_decimal_ull(m, " ", 0);
-		seq_putc(m, '\n');
 	} else {
-		seq_write(m, "0 0 0 0 0 0 0\n", 14);
+		seq_write(m, "0 0 0 0 0 0 0", 13);
+	}
+}
+
+int proc_pid_statm(struct seq_file *m, struct pid_namespace *ns,
+			struct pid *pid, struct task_struct *task)
+{
+	do_task_statm(m, task);
+	seq_putc(m, '\n');
+	return 0;
+}
+
+/*
+ * /proc/tasks has a line per process visible in the pid namespace, made of
+ * the fields of its stat file followed by the fields of its statm file, so
+ * that monitors don't have to open and read two files per process.
+ */
+static void *proc_tasks_find(struct seq_file *m, loff_t *pos)
+{
+	struct super_block *sb = file_inode(m->file)->i_sb;
+	struct pid_namespace *ns = proc_pid_ns(sb);
+	struct tgid_iter iter;
+
+	if (*pos >= PID_MAX_LIMIT)
+		return NULL;
+
+	iter.tgid = *pos;
+	iter.task = NULL;
+	for (iter = next_tgid(ns, iter); iter.task;
+	     iter.tgid += 1, iter = next_tgid(ns, iter)) {
+		/* Skip the processes whose directory couldn't be opened */
+		if (has_pid_permissions(proc_sb_info(sb), iter.task,
+					HIDEPID_NO_ACCESS)) {
+			*pos = iter.tgid;
+			return iter.task;
+		}
 	}
+
+	*pos = PID_MAX_LIMIT;
+	return NULL;
+}
+
+static void *proc_tasks_start(struct seq_file *m, loff_t *pos)
+{
+	return proc_tasks_find(m, pos);
+}
+
+static void *proc_tasks_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	put_task_struct(v);
+	++*pos;
+	return proc_tasks_find(m, pos);
+}
+
+static void proc_tasks_stop(struct seq_file *m, void *v)
+{
+	if (v)
+		put_task_struct(v);
+}
+
+static int proc_tasks_show(struct seq_file *m, void *v)
+{
+	struct task_struct *task = v;
+	struct pid_namespace *ns = proc_pid_ns(file_inode(m->file)->i_sb);
+
+	do_task_stat(m, ns, task_tgid(task), task, 1);
+	seq_putc(m, ' ');
+	do_task_statm(m, task);
+	seq_putc(m, '\n');
+	return 0;
+}
+
+static const struct seq_operations proc_tasks_seq_ops = {
+	.start	= proc_tasks_start,
+	.next	= proc_tasks_next,
+	.stop	= proc_tasks_stop,
+	.show	= proc_tasks_show,
+};
+
+static int __init proc_tasks_init(void)
+{
+	proc_create_seq("tasks", 0444, NULL, &proc_tasks_seq_ops);
 	return 0;
 }
+fs_initcall(proc_tasks_init);
 
 #ifdef CONFIG_PROC_CHILDREN
 static struct pid *
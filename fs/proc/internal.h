@@ -161,6 +161,13 @@ extern int proc_pid_statm(struct seq_file *, struct pid_namespace *,
 /*
  * base.c
  */
+struct tgid_iter {
+	unsigned int tgid;
+	struct task_struct *task;
+};
+extern struct tgid_iter next_tgid(struct pid_namespace *, struct tgid_iter);
+extern bool has_pid_permissions(struct proc_fs_info *, struct task_struct *,
+				enum proc_hidepid);
 extern const struct dentry_operations pid_dentry_operations;
 extern int pid_getattr(struct user_namespace *, const struct path *,
 		       struct kstat *, u32, unsigned int);
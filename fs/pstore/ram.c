@@ -22,6 +22,7 @@
 #include <linux/of.h>
 #include <linux/of_address.h>
 #include "internal.h"
+#include "ram_internal.h"
 
 #define RAMOOPS_KERNMSG_HDR "===="
 #define MIN_MEM_SIZE 4096UL
@@ -35,6 +36,11 @@ static ulong ramoops_console_size = MIN_MEM_SIZE;
 module_param_named(console_size, ramoops_console_size, ulong, 0400);
 MODULE_PARM_DESC(console_size, "size of kernel console log");
 
+static char *ramoops_console_compress;
+module_param_named(console_compress, ramoops_console_compress, charp, 0400);
+MODULE_PARM_DESC(console_compress,
+		"compression algorithm to keep a longer console history with");
+
 static ulong ramoops_ftrace_size = MIN_MEM_SIZE;
 module_param_named(ftrace_size, ramoops_ftrace_size, ulong, 0400);
 MODULE_PARM_DESC(ftrace_size, "size of ftrace log");
@@ -78,6 +84,8 @@ MODULE_PARM_DESC(dump_oops,
 struct ramoops_context {
 	struct persistent_ram_zone **dprzs;	/* Oops dump zones */
 	struct persistent_ram_zone *cprz;	/* Console zone */
+	struct persistent_ram_zone *hprz;	/* Console history zone */
+	struct ramoops_console_history *chist;
 	struct persistent_ram_zone **fprzs;	/* Ftrace zones */
 	struct persistent_ram_zone *mprz;	/* PMSG zone */
 	phys_addr_t phys_addr;
@@ -207,8 +215,22 @@ static ssize_t ramoops_pstore_read(struct pstore_record *record)
 		}
 	}
 
-	if (!prz_ok(prz) && !cxt->console_read_cnt++)
+	if (!prz_ok(prz) && !cxt->console_read_cnt++) {
+		/* The history already comes with the raw tail appended */
+		if (cxt->chist) {
+			size = ramoops_console_history_read(cxt->chist,
+							    cxt->cprz,
+							    &record->buf);
+			/* Falls back to the raw tail if the history failed */
+			if (size > 0) {
+				record->type = PSTORE_TYPE_CONSOLE;
+				record->id = 0;
+				goto out;
+			}
+			size = 0;
+		}
 		prz = ramoops_get_next_prz(&cxt->cprz, 0 /* single */, record);
+	}
 
 	if (!prz_ok(prz) && !cxt->pmsg_read_cnt++)
 		prz = ramoops_get_next_prz(&cxt->mprz, 0 /* single */, record);
@@ -314,6 +336,9 @@ static int notrace ramoops_pstore_write(struct pstore_record *record)
 		if (!cxt->cprz)
 			return -ENOMEM;
 		persistent_ram_write(cxt->cprz, record->buf, record->size);
+		if (cxt->chist)
+			ramoops_console_history_write(cxt->chist, record->buf,
+						      record->size);
 		return 0;
 	} else if (record->type == PSTORE_TYPE_FTRACE) {
 		int zonenum;
@@ -416,6 +441,8 @@ static int ramoops_pstore_erase(struct pstore_record *record)
 		break;
 	case PSTORE_TYPE_CONSOLE:
 		prz = cxt->cprz;
+		if (cxt->chist)
+			ramoops_console_history_erase(cxt->chist);
 		break;
 	case PSTORE_TYPE_FTRACE:
 		if (record->id >= cxt->max_ftrace_cnt)
@@ -774,10 +801,38 @@ static int ramoops_probe(struct platform_device *pdev)
 	if (err)
 		goto fail_out;
 
-	err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, &paddr,
-			       cxt->console_size, 0);
-	if (err)
-		goto fail_init_cprz;
+	/*
+	 * With console_compress, a quarter of the console area keeps the raw
+	 * tail of the output, and the rest the compressed history.
+	 */
+	if (ramoops_console_history_supported(ramoops_console_compress,
+					      cxt->console_size)) {
+		size_t tail_size = cxt->console_size / 4;
+
+		err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, &paddr,
+				       tail_size, 0);
+		if (err)
+			goto fail_init_cprz;
+
+		err = ramoops_init_prz("console-history", dev, cxt, &cxt->hprz,
+				       &paddr, cxt->console_size - tail_size,
+				       RAMOOPS_CONSOLE_HISTORY_SIG);
+		if (err)
+			goto fail_init_hprz;
+
+		cxt->chist = ramoops_console_history_new(cxt->hprz,
+							 ramoops_console_compress);
+		if (IS_ERR(cxt->chist)) {
+			err = PTR_ERR(cxt->chist);
+			cxt->chist = NULL;
+			goto fail_init_chist;
+		}
+	} else {
+		err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, &paddr,
+				       cxt->console_size, 0);
+		if (err)
+			goto fail_init_cprz;
+	}
 
 	cxt->max_ftrace_cnt = (cxt->flags & RAMOOPS_FLAG_FTRACE_PER_CPU)
 				? nr_cpu_ids
@@ -860,6 +915,12 @@ static int ramoops_probe(struct platform_device *pdev)
 	persistent_ram_free(cxt->mprz);
 fail_init_mprz:
 fail_init_fprz:
+	ramoops_console_history_free(cxt->chist);
+	cxt->chist = NULL;
+fail_init_chist:
+	persistent_ram_free(cxt->hprz);
+	cxt->hprz = NULL;
+fail_init_hprz:
 	persistent_ram_free(cxt->cprz);
 fail_init_cprz:
 	ramoops_free_przs(cxt);
@@ -877,6 +938,10 @@ static int ramoops_remove(struct platform_device *pdev)
 	cxt->pstore.bufsize = 0;
 
 	persistent_ram_free(cxt->mprz);
+	ramoops_console_history_free(cxt->chist);
+	cxt->chist = NULL;
+	persistent_ram_free(cxt->hprz);
+	cxt->hprz = NULL;
 	persistent_ram_free(cxt->cprz);
 	ramoops_free_przs(cxt);
 
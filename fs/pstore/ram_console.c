@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Compressed console history for ramoops
+ *
+ * The console zone only holds the last console_size bytes of output. With
+ * console_compress set, ramoops gives a quarter of that zone to the raw tail
+ * of the output, and the rest to a history of compressed chunks. The console
+ * writer only copies the output into a staging buffer. Full chunks are
+ * compressed later from a work item, so printk doesn't wait for the
+ * compressor. printk may run with scheduler or workqueue locks held, so the
+ * work item is scheduled from an irq_work, the same way printk defers its
+ * own wakeups. After a reset, the history is decompressed and followed by the
+ * part of the tail that didn't make it into a chunk.
+ */
+
+#define pr_fmt(fmt) "ramoops: " fmt
+
+#include <linux/bitops.h>
+#include <linux/crc32.h>
+#include <linux/crypto.h>
+#include <linux/irq_work.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+
+#include "ram_internal.h"
+
+#define RAMOOPS_CONSOLE_CHUNK_SIZE	4096
+/* Leave room for the expansion of incompressible data */
+#define RAMOOPS_CONSOLE_ZBUF_SIZE	(2 * RAMOOPS_CONSOLE_CHUNK_SIZE)
+/* The raw tail has to outlast a few chunks being compressed */
+#define RAMOOPS_CONSOLE_MIN_SIZE	(16 * RAMOOPS_CONSOLE_CHUNK_SIZE)
+/* How much of the history has to match the tail to join them */
+#define RAMOOPS_CONSOLE_JOIN_SIZE	64
+
+#define RAMOOPS_CONSOLE_CHUNK_MAGIC	0x4b4e4843 /* CHNK */
+/* Chunks were dropped before this one */
+#define RAMOOPS_CONSOLE_CHUNK_GAP	BIT(0)
+
+static const char ramoops_console_gap[] = "\n[console history lost]\n";
+
+/* Header of a chunk in the history zone, followed by its payload */
+struct ramoops_console_chunk {
+	u32 magic;
+	u32 crc;		/* of the payload */
+	u32 size;		/* of the payload */
+	u32 orig_size;		/* equal to size if stored uncompressed */
+	u32 flags;
+};
+
+struct ramoops_console_history {
+	struct persistent_ram_zone *prz;
+	struct crypto_comp *tfm;
+	struct irq_work irq_work;
+	struct work_struct work;
+
+	/* Staging buffers, only touched by the serialized console writes */
+	char *stage[2];
+	unsigned int stage_cur;
+	size_t stage_len;
+	bool dropped;
+
+	/* Bit 0 is set while stage[stage_full] waits for the work */
+	unsigned long busy;
+	unsigned int stage_full;
+	bool gap;
+	void *zbuf;
+};
+
+bool ramoops_console_history_supported(const char *algo, size_t console_size)
+{
+	if (!algo || !*algo)
+		return false;
+
+	if (console_size < RAMOOPS_CONSOLE_MIN_SIZE) {
+		pr_warn("console_size must be at least %u to compress it\n",
+			RAMOOPS_CONSOLE_MIN_SIZE);
+		return false;
+	}
+
+	if (!crypto_has_comp(algo, 0, 0)) {
+		pr_warn("console compression '%s' is not available\n", algo);
+		return false;
+	}
+
+	return true;
+}
+
+static void ramoops_console_history_work(struct work_struct *work)
+{
+	struct ramoops_console_history *hist =
+		container_of(work, struct ramoops_console_history, work);
+	const char *src = hist->stage[hist->stage_full];
+	struct ramoops_console_chunk chunk;
+	unsigned int zlen = RAMOOPS_CONSOLE_ZBUF_SIZE;
+	const void *payload = hist->zbuf;
+
+	if (crypto_comp_compress(hist->tfm, src, RAMOOPS_CONSOLE_CHUNK_SIZE,
+				 hist->zbuf, &zlen) ||
+	    zlen >= RAMOOPS_CONSOLE_CHUNK_SIZE) {
+		payload = src;
+		zlen = RAMOOPS_CONSOLE_CHUNK_SIZE;
+	}
+
+	chunk.magic = RAMOOPS_CONSOLE_CHUNK_MAGIC;
+	chunk.crc = crc32_le(~0, payload, zlen);
+	chunk.size = zlen;
+	chunk.orig_size = RAMOOPS_CONSOLE_CHUNK_SIZE;
+	chunk.flags = hist->gap ? RAMOOPS_CONSOLE_CHUNK_GAP : 0;
+
+	/* A chunk cut short by a reset fails its CRC and is skipped */
+	persistent_ram_write(hist->prz, &chunk, sizeof(chunk));
+	persistent_ram_write(hist->prz, payload, zlen);
+
+	clear_bit_unlock(0, &hist->busy);
+}
+
+static void ramoops_console_history_irq_work(struct irq_work *irq_work)
+{
+	struct ramoops_console_history *hist =
+		container_of(irq_work, struct ramoops_console_history, irq_work);
+
+	schedule_work(&hist->work);
+}
+
+void notrace ramoops_console_history_write(struct ramoops_console_history *hist,
+					   const char *s, size_t count)
+{
+	size_t len;
+
+	while (count) {
+		len = min(count, RAMOOPS_CONSOLE_CHUNK_SIZE - hist->stage_len);
+		memcpy(hist->stage[hist->stage_cur] + hist->stage_len, s, len);
+		hist->stage_len += len;
+		s += len;
+		count -= len;
+
+		if (hist->stage_len < RAMOOPS_CONSOLE_CHUNK_SIZE)
+			break;
+		hist->stage_len = 0;
+
+		/*
+		 * The chunk is dropped if the previous one is still being
+		 * compressed, or if the workqueue can't be relied upon
+		 * anymore. The raw tail keeps the latest output regardless.
+		 */
+		if (oops_in_progress || test_and_set_bit_lock(0, &hist->busy)) {
+			hist->dropped = true;
+			continue;
+		}
+
+		hist->stage_full = hist->stage_cur;
+		hist->gap = hist->dropped;
+		hist->dropped = false;
+		hist->stage_cur ^= 1;
+		irq_work_queue(&hist->irq_work);
+	}
+}
+
+/* Find the next chunk at or after *off which passes its CRC */
+static bool ramoops_console_next_chunk(const char *old, size_t size,
+				       size_t *off,
+				       struct ramoops_console_chunk *chunk)
+{
+	for (; *off + sizeof(*chunk) <= size; (*off)++) {
+		const char *payload = old + *off + sizeof(*chunk);
+
+		memcpy(chunk, old + *off, sizeof(*chunk));
+		if (chunk->magic != RAMOOPS_CONSOLE_CHUNK_MAGIC ||
+		    chunk->orig_size > RAMOOPS_CONSOLE_CHUNK_SIZE ||
+		    chunk->size > chunk->orig_size ||
+		    chunk->size > size - *off - sizeof(*chunk))
+			continue;
+
+		if (crc32_le(~0, payload, chunk->size) == chunk->crc)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Return where the raw tail starts to follow the history, that is right after
+ * the end of the history, if the tail still holds it.
+ */
+static size_t ramoops_console_join(const char *tail, size_t tail_size,
+				   const char *end, size_t len)
+{
+	size_t i;
+
+	len = min_t(size_t, len, RAMOOPS_CONSOLE_JOIN_SIZE);
+	if (!len || tail_size < len)
+		return 0;
+
+	end -= len;
+	for (i = tail_size - len + 1; i-- > 0; ) {
+		if (!memcmp(tail + i, end, len))
+			return i + len;
+	}
+
+	return 0;
+}
+
+ssize_t ramoops_console_history_read(struct ramoops_console_history *hist,
+				     struct persistent_ram_zone *tail,
+				     char **buf)
+{
+	const char *old = persistent_ram_old(hist->prz);
+	size_t old_size = persistent_ram_old_size(hist->prz);
+	const char *raw = persistent_ram_old(tail);
+	size_t raw_size = persistent_ram_old_size(tail);
+	struct ramoops_console_chunk chunk;
+	size_t off, start, size = 0, len = 0;
+	unsigned int dlen;
+	char *out;
+
+	for (off = 0; ramoops_console_next_chunk(old, old_size, &off, &chunk);
+	     off += sizeof(chunk) + chunk.size) {
+		size += chunk.orig_size;
+		if (chunk.flags & RAMOOPS_CONSOLE_CHUNK_GAP)
+			size += sizeof(ramoops_console_gap) - 1;
+	}
+	if (!size)
+		return 0;
+
+	out = kmalloc(size + raw_size, GFP_KERNEL);
+	if (!out)
+		return -ENOMEM;
+
+	for (off = 0; ramoops_console_next_chunk(old, old_size, &off, &chunk);
+	     off += sizeof(chunk) + chunk.size) {
+		const char *payload = old + off + sizeof(chunk);
+
+		if (chunk.flags & RAMOOPS_CONSOLE_CHUNK_GAP) {
+			memcpy(out + len, ramoops_console_gap,
+			       sizeof(ramoops_console_gap) - 1);
+			len += sizeof(ramoops_console_gap) - 1;
+		}
+
+		if (chunk.size == chunk.orig_size) {
+			memcpy(out + len, payload, chunk.size);
+			len += chunk.size;
+			continue;
+		}
+
+		dlen = chunk.orig_size;
+		if (!crypto_comp_decompress(hist->tfm, payload, chunk.size,
+					    out + len, &dlen))
+			len += dlen;
+	}
+
+	start = ramoops_console_join(raw, raw_size, out + len, len);
+	memcpy(out + len, raw + start, raw_size - start);
+	len += raw_size - start;
+
+	*buf = out;
+	return len;
+}
+
+void ramoops_console_history_erase(struct ramoops_console_history *hist)
+{
+	persistent_ram_free_old(hist->prz);
+	persistent_ram_zap(hist->prz);
+}
+
+struct ramoops_console_history *
+ramoops_console_history_new(struct persistent_ram_zone *prz, const char *algo)
+{
+	struct ramoops_console_history *hist;
+	int err = -ENOMEM;
+
+	hist = kzalloc(sizeof(*hist), GFP_KERNEL);
+	if (!hist)
+		return ERR_PTR(-ENOMEM);
+
+	hist->tfm = crypto_alloc_comp(algo, 0, 0);
+	if (IS_ERR_OR_NULL(hist->tfm)) {
+		err = hist->tfm ? PTR_ERR(hist->tfm) : -ENOMEM;
+		goto fail_free;
+	}
+
+	hist->stage[0] = kmalloc(2 * RAMOOPS_CONSOLE_CHUNK_SIZE, GFP_KERNEL);
+	if (!hist->stage[0])
+		goto fail_tfm;
+	hist->stage[1] = hist->stage[0] + RAMOOPS_CONSOLE_CHUNK_SIZE;
+
+	hist->zbuf = kmalloc(RAMOOPS_CONSOLE_ZBUF_SIZE, GFP_KERNEL);
+	if (!hist->zbuf)
+		goto fail_stage;
+
+	hist->prz = prz;
+	init_irq_work(&hist->irq_work, ramoops_console_history_irq_work);
+	INIT_WORK(&hist->work, ramoops_console_history_work);
+
+	return hist;
+
+fail_stage:
+	kfree(hist->stage[0]);
+fail_tfm:
+	crypto_free_comp(hist->tfm);
+fail_free:
+	kfree(hist);
+	return ERR_PTR(err);
+}
+
+void ramoops_console_history_free(struct ramoops_console_history *hist)
+{
+	if (IS_ERR_OR_NULL(hist))
+		return;
+
+	irq_work_sync(&hist->irq_work);
+	cancel_work_sync(&hist->work);
+	kfree(hist->zbuf);
+	kfree(hist->stage[0]);
+	crypto_free_comp(hist->tfm);
+	kfree(hist);
+}
@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+#ifndef __PSTORE_RAM_INTERNAL_H__
+#define __PSTORE_RAM_INTERNAL_H__
+
+#include <linux/err.h>
+#include <linux/pstore_ram.h>
+#include <linux/types.h>
+
+/* Signature of the console history zone, so it isn't mistaken for another */
+#define RAMOOPS_CONSOLE_HISTORY_SIG	0x54534948 /* HIST */
+
+struct ramoops_console_history;
+
+#ifdef CONFIG_PSTORE_COMPRESS
+extern bool ramoops_console_history_supported(const char *algo,
+					      size_t console_size);
+extern struct ramoops_console_history *
+ramoops_console_history_new(struct persistent_ram_zone *prz, const char *algo);
+extern void ramoops_console_history_free(struct ramoops_console_history *hist);
+extern void ramoops_console_history_write(struct ramoops_console_history *hist,
+					  const char *s, size_t count);
+extern ssize_t
+ramoops_console_history_read(struct ramoops_console_history *hist,
+			     struct persistent_ram_zone *tail, char **buf);
+extern void ramoops_console_history_erase(struct ramoops_console_history *hist);
+#else
+static inline bool ramoops_console_history_supported(const char *algo,
+						     size_t console_size)
+{
+	return false;
+}
+static inline struct ramoops_console_history *
+ramoops_console_history_new(struct persistent_ram_zone *prz, const char *algo)
+{
+	return ERR_PTR(-EOPNOTSUPP);
+}
+static inline void
+ramoops_console_history_free(struct ramoops_console_history *hist) { }
+static inline void
+ramoops_console_history_write(struct ramoops_console_history *hist,
+			      const char *s, size_t count) { }
+static inline ssize_t
+ramoops_console_history_read(struct ramoops_console_history *hist,
+			     struct persistent_ram_zone *tail, char **buf)
+{
+	return 0;
+}
+static inline void
+ramoops_console_history_erase(struct ramoops_console_history *hist) { }
+#endif
+
+#endif /* __PSTORE_RAM_INTERNAL_H__ */
@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * bench.c
+ */
+
+/*
+ * Decompressor benchmark. Reading /sys/kernel/debug/squashfs/decompress_bench
+ * compresses a synthetic datablock with each of the compressors built into
+ * the kernel, then runs the matching squashfs decompressor wrapper on it for
+ * a fixed amount of time. The wrappers are called exactly as the read path
+ * calls them, from a bio into a page actor, so that the throughput includes
+ * the copies done by each wrapper, and can be used to choose the compressor
+ * of the images built for a given device.
+ *
+ * XZ is not benchmarked, as the kernel has no XZ encoder.
+ */
+
+#include <linux/bio.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/ktime.h>
+#include <linux/lz4.h>
+#include <linux/lzo.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/zlib.h>
+#include <linux/zstd.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs.h"
+#include "decompressor.h"
+#include "page_actor.h"
+
+/* Size of the benchmarked datablock, the default of mksquashfs */
+#define BENCH_BLOCK_SIZE	(128 * 1024)
+#define BENCH_PAGES		(BENCH_BLOCK_SIZE >> PAGE_SHIFT)
+
+/* LZO does not check the size of its output buffer */
+#define BENCH_COMP_SIZE		lzo1x_worst_compress(BENCH_BLOCK_SIZE)
+
+/* Time spent running each decompressor */
+#define BENCH_DURATION_NS	(200 * NSEC_PER_MSEC)
+
+struct squashfs_bench_comp {
+	const struct squashfs_decompressor *decomp;
+	int (*compress)(const void *src, void *dst, int dst_len);
+};
+
+#ifdef CONFIG_SQUASHFS_LZ4
+static int bench_lz4_compress(const void *src, void *dst, int dst_len)
+{
+	void *wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	int len;
+
+	if (!wrkmem)
+		return -ENOMEM;
+
+	len = LZ4_compress_default(src, dst, BENCH_BLOCK_SIZE, dst_len, wrkmem);
+	vfree(wrkmem);
+
+	return len ? len : -EINVAL;
+}
+#endif
+
+#ifdef CONFIG_SQUASHFS_LZO
+static int bench_lzo_compress(const void *src, void *dst, int dst_len)
+{
+	void *wrkmem = vmalloc(LZO1X_1_MEM_COMPRESS);
+	size_t len = dst_len;
+	int err;
+
+	if (!wrkmem)
+		return -ENOMEM;
+
+	err = lzo1x_1_compress(src, BENCH_BLOCK_SIZE, dst, &len, wrkmem);
+	vfree(wrkmem);
+
+	return err == LZO_E_OK ? len : -EINVAL;
+}
+#endif
+
+#ifdef CONFIG_SQUASHFS_ZLIB
+static int bench_zlib_compress(const void *src, void *dst, int dst_len)
+{
+	z_stream stream = {};
+	int err;
+
+	stream.workspace = vmalloc(zlib_deflate_workspacesize(MAX_WBITS,
+							      MAX_MEM_LEVEL));
+	if (!stream.workspace)
+		return -ENOMEM;
+
+	/* mksquashfs compresses at level 9 by default */
+	err = zlib_deflateInit(&stream, 9);
+	if (err == Z_OK) {
+		stream.next_in = src;
+		stream.avail_in = BENCH_BLOCK_SIZE;
+		stream.next_out = dst;
+		stream.avail_out = dst_len;
+
+		err = zlib_deflate(&stream, Z_FINISH);
+		zlib_deflateEnd(&stream);
+	}
+	vfree(stream.workspace);
+
+	return err == Z_STREAM_END ? stream.total_out : -EINVAL;
+}
+#endif
+
+#ifdef CONFIG_SQUASHFS_ZSTD
+static int bench_zstd_compress(const void *src, void *dst, int dst_len)
+{
+	/* mksquashfs compresses at level 15 by default */
+	ZSTD_parameters params = ZSTD_getParams(15, BENCH_BLOCK_SIZE, 0);
+	size_t wksp_size = ZSTD_CCtxWorkspaceBound(params.cParams);
+	ZSTD_CCtx *cctx;
+	void *wksp;
+	size_t len;
+
+	wksp = vmalloc(wksp_size);
+	if (!wksp)
+		return -ENOMEM;
+
+	cctx = ZSTD_initCCtx(wksp, wksp_size);
+	len = cctx ? ZSTD_compressCCtx(cctx, dst, dst_len, src,
+				       BENCH_BLOCK_SIZE, params) : 0;
+	vfree(wksp);
+
+	return !cctx || ZSTD_isError(len) ? -EINVAL : len;
+}
+#endif
+
+static const struct squashfs_bench_comp squashfs_bench_comps[] = {
+#ifdef CONFIG_SQUASHFS_LZ4
+	{ &squashfs_lz4_comp_ops, bench_lz4_compress },
+#endif
+#ifdef CONFIG_SQUASHFS_LZO
+	{ &squashfs_lzo_comp_ops, bench_lzo_compress },
+#endif
+#ifdef CONFIG_SQUASHFS_ZLIB
+	{ &squashfs_zlib_comp_ops, bench_zlib_compress },
+#endif
+#ifdef CONFIG_SQUASHFS_ZSTD
+	{ &squashfs_zstd_comp_ops, bench_zstd_compress },
+#endif
+};
+
+/*
+ * Fill the block with pseudo-random words, which compresses about as well as
+ * the text, scripts and executables found on a typical root filesystem.
+ */
+static void squashfs_bench_fill(char *data)
+{
+	static const char * const words[] = {
+		"squashfs", "block", "inode", "fragment", "cache", "page",
+		"0x00000000", "\n\t", "if (", "return ", "struct ", "    ",
+		"the ", "of ", "and ", "to ", "a ", "in ", "is ", "that ",
+	};
+	u32 seed = 0x5175a54f;
+	const char *word;
+	int pos = 0, len;
+
+	while (pos < BENCH_BLOCK_SIZE) {
+		seed = seed * 1103515245 + 12345;
+		word = words[(seed >> 16) % ARRAY_SIZE(words)];
+
+		len = min_t(int, strlen(word), BENCH_BLOCK_SIZE - pos);
+		memcpy(data + pos, word, len);
+		pos += len;
+	}
+}
+
+static int squashfs_bench_run(struct seq_file *s,
+			      const struct squashfs_bench_comp *comp,
+			      const char *src, void *tmp, void **buffer)
+{
+	const struct squashfs_decompressor *decomp = comp->decomp;
+	struct squashfs_sb_info msblk = { .block_size = BENCH_BLOCK_SIZE };
+	struct squashfs_page_actor *actor;
+	struct page *pages[BENCH_PAGES];
+	unsigned int i, nr_pages = 0;
+	struct bio *bio = NULL;
+	u64 bytes = 0, mbps;
+	ktime_t start;
+	void *stream;
+	int len, res, err;
+	s64 ns;
+
+	len = comp->compress(src, tmp, BENCH_COMP_SIZE);
+	if (len < 0 || len >= BENCH_BLOCK_SIZE) {
+		/* squashfs would store the block uncompressed */
+		seq_printf(s, "%-8s%12s\n", decomp->name, "n/a");
+		return 0;
+	}
+
+	stream = decomp->init(&msblk, NULL);
+	if (IS_ERR(stream))
+		return PTR_ERR(stream);
+
+	actor = squashfs_page_actor_init(buffer, BENCH_PAGES, 0);
+	if (!actor) {
+		err = -ENOMEM;
+		goto out_free_stream;
+	}
+
+	/* Give the compressed data to the wrapper the way the read path does */
+	nr_pages = DIV_ROUND_UP(len, PAGE_SIZE);
+	bio = bio_kmalloc(GFP_KERNEL, nr_pages);
+	if (!bio) {
+		err = -ENOMEM;
+		goto out_free_actor;
+	}
+
+	for (i = 0; i < nr_pages; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i]) {
+			nr_pages = i;
+			err = -ENOMEM;
+			goto out_free_bio;
+		}
+
+		memcpy(page_address(pages[i]), tmp + i * PAGE_SIZE,
+		       min_t(int, len - i * PAGE_SIZE, PAGE_SIZE));
+		bio_add_page(bio, pages[i], PAGE_SIZE, 0);
+	}
+
+	res = decomp->decompress(&msblk, stream, bio, 0, len, actor);
+	for (i = 0; res == BENCH_BLOCK_SIZE && i < BENCH_PAGES; i++)
+		if (memcmp(buffer[i], src + i * PAGE_SIZE, PAGE_SIZE))
+			break;
+
+	if (i != BENCH_PAGES) {
+		seq_printf(s, "%-8s%12s\n", decomp->name, "mismatch");
+		err = 0;
+		goto out_free_bio;
+	}
+
+	start = ktime_get();
+	do {
+		res = decomp->decompress(&msblk, stream, bio, 0, len, actor);
+		if (res < 0) {
+			err = res;
+			goto out_free_bio;
+		}
+
+		bytes += res;
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		cond_resched();
+	} while (ns < BENCH_DURATION_NS);
+
+	mbps = div64_u64(bytes * NSEC_PER_SEC, ns * SZ_1M);
+
+	seq_printf(s, "%-8s%11d%%%12llu\n", decomp->name,
+		   len * 100 / BENCH_BLOCK_SIZE, mbps);
+	err = 0;
+
+out_free_bio:
+	for (i = 0; i < nr_pages; i++)
+		__free_page(pages[i]);
+	bio_put(bio);
+out_free_actor:
+	kfree(actor);
+out_free_stream:
+	decomp->free(stream);
+	return err;
+}
+
+static int squashfs_bench_show(struct seq_file *s, void *unused)
+{
+	void *buffer[BENCH_PAGES] = {};
+	void *src, *tmp;
+	unsigned int i;
+	int err = -ENOMEM;
+
+	src = vmalloc(BENCH_BLOCK_SIZE);
+	tmp = vmalloc(BENCH_COMP_SIZE);
+	if (!src || !tmp)
+		goto out_free;
+
+	/* The cache allocates its buffers one page at a time as well */
+	for (i = 0; i < BENCH_PAGES; i++) {
+		buffer[i] = kmalloc(PAGE_SIZE, GFP_KERNEL);
+		if (!buffer[i])
+			goto out_free;
+	}
+
+	squashfs_bench_fill(src);
+
+	seq_printf(s, "%-8s%12s%12s\n", "comp", "ratio", "MiB/s");
+
+	for (i = 0; i < ARRAY_SIZE(squashfs_bench_comps); i++) {
+		err = squashfs_bench_run(s, &squashfs_bench_comps[i], src, tmp,
+					 buffer);
+		if (err)
+			break;
+	}
+
+out_free:
+	for (i = 0; i < BENCH_PAGES; i++)
+		kfree(buffer[i]);
+	vfree(tmp);
+	vfree(src);
+	return err;
+}
+DEFINE_SHOW_ATTRIBUTE(squashfs_bench);
+
+static struct dentry *squashfs_debugfs_dir;
+
+void __init squashfs_bench_init(void)
+{
+	squashfs_debugfs_dir = debugfs_create_dir("squashfs", NULL);
+	debugfs_create_file("decompress_bench", 0400, squashfs_debugfs_dir,
+			    NULL, &squashfs_bench_fops);
+}
+
+void squashfs_bench_exit(void)
+{
+	debugfs_remove_recursive(squashfs_debugfs_dir);
+}
@@ -73,8 +73,8 @@ static int copy_bio_to_actor(struct bio *bio,
 	return copied_bytes;
 }
 
-static int squashfs_bio_read(struct super_block *sb, u64 index, int length,
-			     struct bio **biop, int *block_offset)
+static struct bio *squashfs_bio_alloc(struct super_block *sb, u64 index,
+				      int length, gfp_t gfp)
 {
 	struct squashfs_sb_info *msblk = sb->s_fs_info;
 	const u64 read_start = round_down(index, msblk->devblksize);
@@ -88,12 +88,12 @@ static int squashfs_bio_read(struct super_block *sb, u64 index, int length,
 	struct bio *bio;
 
 	if (page_count <= BIO_MAX_VECS)
-		bio = bio_alloc(GFP_NOIO, page_count);
+		bio = bio_alloc(gfp, page_count);
 	else
-		bio = bio_kmalloc(GFP_NOIO, page_count);
+		bio = bio_kmalloc(gfp, page_count);
 
 	if (!bio)
-		return -ENOMEM;
+		return ERR_PTR(-ENOMEM);
 
 	bio_set_dev(bio, sb->s_bdev);
 	bio->bi_opf = READ;
@@ -102,7 +102,7 @@ static int squashfs_bio_read(struct super_block *sb, u64 index, int length,
 	for (i = 0; i < page_count; ++i) {
 		unsigned int len =
 			min_t(unsigned int, PAGE_SIZE - offset, total_len);
-		struct page *page = alloc_page(GFP_NOIO);
+		struct page *page = alloc_page(gfp);
 
 		if (!page) {
 			error = -ENOMEM;
@@ -116,18 +116,49 @@ static int squashfs_bio_read(struct super_block *sb, u64 index, int length,
 		total_len -= len;
 	}
 
+	return bio;
+
+out_free_bio:
+	bio_free_pages(bio);
+	bio_put(bio);
+	return ERR_PTR(error);
+}
+
+static int squashfs_bio_read(struct super_block *sb, u64 index, int length,
+			     struct bio **biop, int *block_offset)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	struct bio *bio;
+	int error;
+
+	bio = squashfs_bio_alloc(sb, index, length, GFP_NOIO);
+	if (IS_ERR(bio))
+		return PTR_ERR(bio);
+
 	error = submit_bio_wait(bio);
-	if (error)
-		goto out_free_bio;
+	if (error) {
+		bio_free_pages(bio);
+		bio_put(bio);
+		return error;
+	}
 
 	*biop = bio;
 	*block_offset = index & ((1 << msblk->devblksize_log2) - 1);
 	return 0;
+}
 
-out_free_bio:
-	bio_free_pages(bio);
-	bio_put(bio);
-	return error;
+static int squashfs_bio_to_actor(struct squashfs_sb_info *msblk,
+				 struct bio *bio, int offset, int length,
+				 bool compressed,
+				 struct squashfs_page_actor *output)
+{
+	if (!compressed)
+		return copy_bio_to_actor(bio, output, offset, length);
+
+	if (!msblk->stream)
+		return -EIO;
+
+	return squashfs_decompress(msblk, bio, offset, length, output);
 }
 
 /*
@@ -212,15 +243,8 @@ int squashfs_read_data(struct super_block *sb, u64 index, int length,
 	if (res)
 		goto out;
 
-	if (compressed) {
-		if (!msblk->stream) {
-			res = -EIO;
-			goto out_free_bio;
-		}
-		res = squashfs_decompress(msblk, bio, offset, length, output);
-	} else {
-		res = copy_bio_to_actor(bio, output, offset, length);
-	}
+	res = squashfs_bio_to_actor(msblk, bio, offset, length, compressed,
+				    output);
 
 out_free_bio:
 	bio_free_pages(bio);
@@ -231,3 +255,84 @@ int squashfs_read_data(struct super_block *sb, u64 index, int length,
 
 	return res;
 }
+
+static void squashfs_read_end_io(struct bio *bio)
+{
+	struct squashfs_read_req *req = bio->bi_private;
+
+	complete(&req->done);
+}
+
+/*
+ * Submit the read of a datablock, without waiting for it to complete.  This
+ * allows the reads of several datablocks to be in flight while the previous
+ * ones are being decompressed.  The read must then be completed with
+ * squashfs_read_data_finish().
+ *
+ * Returns -ENOMEM if the memory for the read cannot be obtained with @gfp, in
+ * which case the caller may retry later, once it has completed the reads
+ * already in flight.
+ */
+int squashfs_read_data_submit(struct super_block *sb, u64 index, int length,
+			      struct squashfs_read_req *req, gfp_t gfp)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	struct bio *bio;
+
+	req->compressed = SQUASHFS_COMPRESSED_BLOCK(length);
+	req->length = SQUASHFS_COMPRESSED_SIZE_BLOCK(length);
+	req->index = index;
+
+	TRACE("Block @ 0x%llx, %scompressed size %d\n", index,
+	      req->compressed ? "" : "un", req->length);
+
+	if (req->length < 0 || req->length > msblk->block_size ||
+	    (index + req->length) > msblk->bytes_used) {
+		ERROR("Failed to read block 0x%llx: %d\n", index, -EIO);
+		return -EIO;
+	}
+
+	bio = squashfs_bio_alloc(sb, index, req->length, gfp);
+	if (IS_ERR(bio))
+		return PTR_ERR(bio);
+
+	init_completion(&req->done);
+	req->bio = bio;
+	req->offset = index & ((1 << msblk->devblksize_log2) - 1);
+
+	bio->bi_private = req;
+	bio->bi_end_io = squashfs_read_end_io;
+	submit_bio(bio);
+
+	return 0;
+}
+
+/*
+ * Wait for a read submitted with squashfs_read_data_submit() to complete, and
+ * decompress the datablock into @output.  If @output is NULL, the data is
+ * discarded.  Returns the number of bytes decompressed, or a negative error.
+ */
+int squashfs_read_data_finish(struct super_block *sb,
+			      struct squashfs_read_req *req,
+			      struct squashfs_page_actor *output)
+{
+	struct bio *bio = req->bio;
+	int res;
+
+	wait_for_completion_io(&req->done);
+
+	res = blk_status_to_errno(bio->bi_status);
+	if (!res && output)
+		res = squashfs_bio_to_actor(sb->s_fs_info, bio, req->offset,
+					    req->length, req->compressed,
+					    output);
+
+	bio_free_pages(bio);
+	bio_put(bio);
+	req->bio = NULL;
+
+	if (res < 0)
+		ERROR("Failed to read block 0x%llx: %d\n", req->index, res);
+
+	return res;
+}
@@ -67,6 +67,8 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 		}
 
 		if (n == cache->entries) {
+			unsigned long oldest = ULONG_MAX;
+
 			/*
 			 * Block not in cache, if all cache entries are used
 			 * go to sleep waiting for one to become available.
@@ -81,19 +83,22 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 			}
 
 			/*
-			 * At least one unused cache entry.  A simple
-			 * round-robin strategy is used to choose the entry to
-			 * be evicted from the cache.
+			 * At least one unused cache entry.  The least recently
+			 * used one is evicted from the cache.
 			 */
-			i = cache->next_blk;
-			for (n = 0; n < cache->entries; n++) {
-				if (cache->entry[i].refcount == 0)
-					break;
-				i = (i + 1) % cache->entries;
+			for (n = 0, i = 0; n < cache->entries; n++) {
+				entry = &cache->entry[n];
+				if (entry->refcount == 0 &&
+				    entry->last_used < oldest) {
+					oldest = entry->last_used;
+					i = n;
+				}
 			}
 
-			cache->next_blk = (i + 1) % cache->entries;
+			cache->curr_blk = i;
+			cache->misses++;
 			entry = &cache->entry[i];
+			entry->last_used = ++cache->clock;
 
 			/*
 			 * Initialise chosen cache entry, and fill it in from
@@ -141,6 +146,8 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 		if (entry->refcount == 0)
 			cache->unused--;
 		entry->refcount++;
+		entry->last_used = ++cache->clock;
+		cache->hits++;
 
 		/*
 		 * If the entry is currently being filled in by another process
@@ -238,7 +245,6 @@ struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 	}
 
 	cache->curr_blk = 0;
-	cache->next_blk = 0;
 	cache->unused = entries;
 	cache->entries = entries;
 	cache->block_size = block_size;
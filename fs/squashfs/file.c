@@ -39,6 +39,7 @@
 #include "squashfs_fs_sb.h"
 #include "squashfs_fs_i.h"
 #include "squashfs.h"
+#include "page_actor.h"
 
 /*
  * Locate cache slot in range [offset, index] for specified inode.  If
@@ -495,6 +496,206 @@ static int squashfs_readpage(struct file *file, struct page *page)
 }
 
 
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+/*
+ * Maximum number of datablocks whose read is in flight while the current one
+ * is decompressed.  Their compressed data is held in memory until then.
+ */
+#define SQUASHFS_READAHEAD_DEPTH	4
+
+struct squashfs_readahead_block {
+	struct squashfs_read_req req;
+	struct page **page;
+	int pages;
+	int expected;
+	u64 block;
+	int bsize;
+	bool submitted;
+};
+
+static void squashfs_readahead_release(struct squashfs_readahead_block *rab,
+				       bool uptodate)
+{
+	int i;
+
+	/*
+	 * Pages that are not uptodate are simply released, they will be read
+	 * again through squashfs_readpage() if they are needed.
+	 */
+	for (i = 0; i < rab->pages; i++) {
+		if (uptodate) {
+			flush_dcache_page(rab->page[i]);
+			SetPageUptodate(rab->page[i]);
+		}
+		unlock_page(rab->page[i]);
+		put_page(rab->page[i]);
+	}
+
+	rab->pages = 0;
+}
+
+/*
+ * Grab the pages of the next datablock of the readahead window and submit
+ * its read.  Returns 1 if the datablock has been queued, 0 if its pages were
+ * released right away, or -ENODATA at the end of the readahead window.
+ *
+ * Only full datablocks of the file are handled.  Fragments, sparse blocks
+ * and partial datablocks are left to squashfs_readpage().
+ */
+static int squashfs_readahead_start(struct readahead_control *ractl,
+				    struct squashfs_readahead_block *rab,
+				    bool in_flight)
+{
+	struct inode *inode = ractl->mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int shift = msblk->block_log - PAGE_SHIFT;
+	int mask = (1 << shift) - 1;
+	int file_end = i_size_read(inode) >> msblk->block_log;
+	pgoff_t next;
+	int index, res;
+
+	/* Don't let a batch span two datablocks */
+	next = readahead_index(ractl) +
+		(readahead_batch_length(ractl) >> PAGE_SHIFT);
+
+	rab->pages = __readahead_batch(ractl, rab->page,
+				       (mask + 1) - (next & mask));
+	if (!rab->pages)
+		return -ENODATA;
+
+	index = rab->page[0]->index >> shift;
+	rab->expected = index == file_end ?
+			(i_size_read(inode) & (msblk->block_size - 1)) :
+			msblk->block_size;
+
+	if (index > file_end || (rab->page[0]->index & mask) ||
+	    rab->pages != DIV_ROUND_UP(rab->expected, PAGE_SIZE) ||
+	    (index == file_end &&
+	     squashfs_i(inode)->fragment_block != SQUASHFS_INVALID_BLK))
+		goto out_release;
+
+	rab->bsize = read_blocklist(inode, index, &rab->block);
+	if (rab->bsize <= 0)
+		goto out_release;
+
+	/*
+	 * Don't wait for memory to become available while other reads are in
+	 * flight, their datablocks will be decompressed first.
+	 */
+	res = squashfs_read_data_submit(inode->i_sb, rab->block, rab->bsize,
+					&rab->req, in_flight ?
+					GFP_NOWAIT | __GFP_NOWARN : GFP_NOIO);
+	if (res && res != -ENOMEM)
+		goto out_release;
+
+	rab->submitted = !res;
+	return 1;
+
+out_release:
+	squashfs_readahead_release(rab, false);
+	return 0;
+}
+
+static void squashfs_readahead_finish(struct super_block *sb,
+				      struct squashfs_readahead_block *rab)
+{
+	struct squashfs_page_actor *actor;
+	int res, bytes;
+
+	if (!rab->submitted) {
+		res = squashfs_read_data_submit(sb, rab->block, rab->bsize,
+						&rab->req, GFP_NOIO);
+		if (res)
+			goto out_release;
+	}
+
+	/* Decompress directly into the page cache pages */
+	actor = squashfs_page_actor_init_special(rab->page, rab->pages, 0);
+
+	res = squashfs_read_data_finish(sb, &rab->req, actor);
+	kfree(actor);
+
+	if (!actor || res != rab->expected)
+		goto out_release;
+
+	/* Last page may have trailing bytes not filled */
+	bytes = res % PAGE_SIZE;
+	if (bytes)
+		zero_user_segment(rab->page[rab->pages - 1], bytes, PAGE_SIZE);
+
+	squashfs_readahead_release(rab, true);
+	return;
+
+out_release:
+	squashfs_readahead_release(rab, false);
+}
+
+/*
+ * Read the whole readahead window, keeping the reads of the next datablocks
+ * in flight while a datablock is decompressed.  With a multi-threaded
+ * decompressor, the device is then kept busy all along.
+ */
+static void squashfs_readahead(struct readahead_control *ractl)
+{
+	struct inode *inode = ractl->mapping->host;
+	struct super_block *sb = inode->i_sb;
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	struct squashfs_readahead_block rab[SQUASHFS_READAHEAD_DEPTH];
+	size_t mask = msblk->block_size - 1;
+	loff_t start = readahead_pos(ractl) & ~mask;
+	size_t len = readahead_length(ractl) + readahead_pos(ractl) - start;
+	int max_pages = msblk->block_size >> PAGE_SHIFT;
+	unsigned int head = 0, count = 0, i;
+	struct squashfs_readahead_block *next;
+	struct page **pages;
+	bool done = false;
+	int res;
+
+	/* Read full datablocks */
+	readahead_expand(ractl, start, (len | mask) + 1);
+
+	pages = kmalloc_array(SQUASHFS_READAHEAD_DEPTH * max_pages,
+			      sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return;
+
+	for (i = 0; i < SQUASHFS_READAHEAD_DEPTH; i++)
+		rab[i].page = pages + i * max_pages;
+
+	for (;;) {
+		while (!done && count < SQUASHFS_READAHEAD_DEPTH) {
+			next = &rab[(head + count) % SQUASHFS_READAHEAD_DEPTH];
+
+			res = squashfs_readahead_start(ractl, next, count);
+			if (res < 0) {
+				done = true;
+				break;
+			}
+
+			if (!res)
+				continue;
+
+			/* Out of memory, complete the reads in flight first */
+			count++;
+			if (!next->submitted)
+				break;
+		}
+
+		if (!count)
+			break;
+
+		squashfs_readahead_finish(sb, &rab[head]);
+		head = (head + 1) % SQUASHFS_READAHEAD_DEPTH;
+		count--;
+	}
+
+	kfree(pages);
+}
+#endif
+
 const struct address_space_operations squashfs_aops = {
-	.readpage = squashfs_readpage
+	.readpage = squashfs_readpage,
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+	.readahead = squashfs_readahead,
+#endif
 };
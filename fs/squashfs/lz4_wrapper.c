@@ -88,6 +88,34 @@ static void lz4_free(void *strm)
 }
 
 
+/*
+ * Return the compressed data in place if it lies in virtually contiguous
+ * memory, which it does whenever the bio pages were allocated next to each
+ * other, so that it does not need to be copied to the input buffer.
+ */
+static void *lz4_contiguous_input(struct bio *bio, int offset, int length)
+{
+	struct bvec_iter_all iter_all = {};
+	struct bio_vec *bvec = bvec_init_iter_all(&iter_all);
+	void *start = NULL, *end = NULL, *data;
+
+	while (length > 0 && bio_next_segment(bio, &iter_all)) {
+		data = page_address(bvec->bv_page) + bvec->bv_offset;
+
+		if (!start)
+			start = end = data + offset;
+		else if (data != end)
+			return NULL;
+
+		end += bvec->bv_len - offset;
+		length -= bvec->bv_len - offset;
+		offset = 0;
+	}
+
+	return length > 0 ? NULL : start;
+}
+
+
 static int lz4_uncompress(struct squashfs_sb_info *msblk, void *strm,
 	struct bio *bio, int offset, int length,
 	struct squashfs_page_actor *output)
@@ -95,28 +123,46 @@ static int lz4_uncompress(struct squashfs_sb_info *msblk, void *strm,
 	struct bvec_iter_all iter_all = {};
 	struct bio_vec *bvec = bvec_init_iter_all(&iter_all);
 	struct squashfs_lz4 *stream = strm;
-	void *buff = stream->input, *data;
+	void *buff = stream->input, *data, *input;
 	int bytes = length, res;
 
-	while (bio_next_segment(bio, &iter_all)) {
-		int avail = min(bytes, ((int)bvec->bv_len) - offset);
+	input = lz4_contiguous_input(bio, offset, length);
+	if (!input) {
+		input = stream->input;
 
-		data = page_address(bvec->bv_page) + bvec->bv_offset;
-		memcpy(buff, data + offset, avail);
-		buff += avail;
-		bytes -= avail;
-		offset = 0;
+		while (bio_next_segment(bio, &iter_all)) {
+			int avail = min(bytes, ((int)bvec->bv_len) - offset);
+
+			data = page_address(bvec->bv_page) + bvec->bv_offset;
+			memcpy(buff, data + offset, avail);
+			buff += avail;
+			bytes -= avail;
+			offset = 0;
+		}
 	}
 
-	res = LZ4_decompress_safe(stream->input, stream->output,
-		length, output->length);
+	/* A single page destination is decompressed into directly */
+	if (output->pages == 1) {
+		data = squashfs_first_page(output);
+		res = LZ4_decompress_safe(input, data, length,
+			min_t(int, output->length, PAGE_SIZE));
+		squashfs_finish_page(output);
+
+		return res < 0 ? -EIO : res;
+	}
 
+	/*
+	 * The pages may be mapped with kmap_atomic(), so only map them once
+	 * the whole block is decompressed.
+	 */
+	res = LZ4_decompress_safe(input, stream->output,
+		length, output->length);
 	if (res < 0)
 		return -EIO;
 
 	bytes = res;
-	data = squashfs_first_page(output);
 	buff = stream->output;
+	data = squashfs_first_page(output);
 	while (data) {
 		if (bytes <= PAGE_SIZE) {
 			memcpy(data, buff, bytes);
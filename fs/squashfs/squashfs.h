@@ -14,9 +14,32 @@
 
 #define WARNING(s, args...)	pr_warn("SQUASHFS: "s, ## args)
 
+/* bench.c */
+#ifdef CONFIG_SQUASHFS_DECOMP_BENCH
+extern void squashfs_bench_init(void);
+extern void squashfs_bench_exit(void);
+#else
+static inline void squashfs_bench_init(void) { }
+static inline void squashfs_bench_exit(void) { }
+#endif
+
 /* block.c */
+struct squashfs_read_req {
+	struct bio		*bio;
+	struct completion	done;
+	u64			index;
+	int			offset;
+	int			length;
+	bool			compressed;
+};
+
 extern int squashfs_read_data(struct super_block *, u64, int, u64 *,
 				struct squashfs_page_actor *);
+extern int squashfs_read_data_submit(struct super_block *, u64, int,
+				struct squashfs_read_req *, gfp_t);
+extern int squashfs_read_data_finish(struct super_block *,
+				struct squashfs_read_req *,
+				struct squashfs_page_actor *);
 
 /* cache.c */
 extern struct squashfs_cache *squashfs_cache_init(char *, int, int);
@@ -71,6 +94,12 @@ extern struct inode *squashfs_iget(struct super_block *, long long,
 				unsigned int);
 extern int squashfs_read_inode(struct inode *, long long);
 
+/* sysfs.c */
+extern int squashfs_sysfs_register(struct super_block *);
+extern void squashfs_sysfs_unregister(struct super_block *);
+extern int squashfs_sysfs_init(void);
+extern void squashfs_sysfs_exit(void);
+
 /* xattr.c */
 extern ssize_t squashfs_listxattr(struct dentry *, char *, size_t);
 
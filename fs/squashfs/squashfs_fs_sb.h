@@ -10,13 +10,14 @@
  * squashfs_fs_sb.h
  */
 
+#include <linux/kobject.h>
+
 #include "squashfs_fs.h"
 
 struct squashfs_cache {
 	char			*name;
 	int			entries;
 	int			curr_blk;
-	int			next_blk;
 	int			num_waiters;
 	int			unused;
 	int			block_size;
@@ -24,6 +25,9 @@ struct squashfs_cache {
 	spinlock_t		lock;
 	wait_queue_head_t	wait_queue;
 	struct squashfs_cache_entry *entry;
+	unsigned long		clock;
+	unsigned long		hits;
+	unsigned long		misses;
 };
 
 struct squashfs_cache_entry {
@@ -34,6 +38,7 @@ struct squashfs_cache_entry {
 	int			pending;
 	int			error;
 	int			num_waiters;
+	unsigned long		last_used;
 	wait_queue_head_t	wait_queue;
 	struct squashfs_cache	*cache;
 	void			**data;
@@ -65,5 +70,8 @@ struct squashfs_sb_info {
 	unsigned int				fragments;
 	int					xattr_ids;
 	unsigned int				ids;
+	unsigned int				fragment_cache_entries;
+	struct kobject				kobj;
+	struct completion			kobj_unregister;
 };
 #endif
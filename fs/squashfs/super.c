@@ -18,6 +18,7 @@
 
 #include <linux/fs.h>
 #include <linux/fs_context.h>
+#include <linux/fs_parser.h>
 #include <linux/vfs.h>
 #include <linux/slab.h>
 #include <linux/mutex.h>
@@ -25,6 +26,7 @@
 #include <linux/init.h>
 #include <linux/module.h>
 #include <linux/magic.h>
+#include <linux/seq_file.h>
 #include <linux/xattr.h>
 
 #include "squashfs_fs.h"
@@ -37,6 +39,51 @@
 static struct file_system_type squashfs_fs_type;
 static const struct super_operations squashfs_super_ops;
 
+/* Upper limit of the fragment_cache mount option */
+#define SQUASHFS_MAX_CACHED_FRAGMENTS	64
+
+enum squashfs_param {
+	Opt_fragment_cache,
+};
+
+static const struct fs_parameter_spec squashfs_fs_parameters[] = {
+	fsparam_u32("fragment_cache", Opt_fragment_cache),
+	{}
+};
+
+struct squashfs_mount_opts {
+	unsigned int fragment_cache_entries;
+};
+
+static int squashfs_parse_param(struct fs_context *fc,
+				struct fs_parameter *param)
+{
+	struct squashfs_mount_opts *opts = fc->fs_private;
+	struct fs_parse_result result;
+	int opt;
+
+	opt = fs_parse(fc, squashfs_fs_parameters, param, &result);
+	if (opt < 0)
+		return opt;
+
+	switch (opt) {
+	case Opt_fragment_cache:
+		/* The caches are only allocated at mount time */
+		if (fc->purpose == FS_CONTEXT_FOR_RECONFIGURE) {
+			warnfc(fc, "fragment_cache cannot be changed on remount");
+			break;
+		}
+		if (result.uint_32 < 1 ||
+		    result.uint_32 > SQUASHFS_MAX_CACHED_FRAGMENTS)
+			return invalfc(fc, "fragment_cache must be between 1 and %d",
+				       SQUASHFS_MAX_CACHED_FRAGMENTS);
+		opts->fragment_cache_entries = result.uint_32;
+		break;
+	}
+
+	return 0;
+}
+
 static const struct squashfs_decompressor *supported_squashfs_filesystem(
 	struct fs_context *fc,
 	short major, short minor, short id)
@@ -67,6 +114,7 @@ static const struct squashfs_decompressor *supported_squashfs_filesystem(
 
 static int squashfs_fill_super(struct super_block *sb, struct fs_context *fc)
 {
+	struct squashfs_mount_opts *opts = fc->fs_private;
 	struct squashfs_sb_info *msblk;
 	struct squashfs_super_block *sblk = NULL;
 	struct inode *root;
@@ -89,6 +137,7 @@ static int squashfs_fill_super(struct super_block *sb, struct fs_context *fc)
 	msblk->devblksize_log2 = ffz(~msblk->devblksize);
 
 	mutex_init(&msblk->meta_index_mutex);
+	msblk->fragment_cache_entries = opts->fragment_cache_entries;
 
 	/*
 	 * msblk->bytes_used is checked in squashfs_read_table to ensure reads
@@ -270,7 +319,7 @@ static int squashfs_fill_super(struct super_block *sb, struct fs_context *fc)
 		goto check_directory_table;
 
 	msblk->fragment_cache = squashfs_cache_init("fragment",
-		SQUASHFS_CACHED_FRAGMENTS, msblk->block_size);
+		msblk->fragment_cache_entries, msblk->block_size);
 	if (msblk->fragment_cache == NULL) {
 		err = -ENOMEM;
 		goto failed_mount;
@@ -322,6 +371,14 @@ static int squashfs_fill_super(struct super_block *sb, struct fs_context *fc)
 		goto failed_mount;
 	}
 
+	err = squashfs_sysfs_register(sb);
+	if (err) {
+		ERROR("Failed to register with sysfs\n");
+		dput(sb->s_root);
+		sb->s_root = NULL;
+		goto failed_mount;
+	}
+
 	TRACE("Leaving squashfs_fill_super\n");
 	kfree(sblk);
 	return 0;
@@ -355,17 +412,44 @@ static int squashfs_reconfigure(struct fs_context *fc)
 	return 0;
 }
 
+static void squashfs_free_fs_context(struct fs_context *fc)
+{
+	kfree(fc->fs_private);
+}
+
 static const struct fs_context_operations squashfs_context_ops = {
+	.free		= squashfs_free_fs_context,
+	.parse_param	= squashfs_parse_param,
 	.get_tree	= squashfs_get_tree,
 	.reconfigure	= squashfs_reconfigure,
 };
 
 static int squashfs_init_fs_context(struct fs_context *fc)
 {
+	struct squashfs_mount_opts *opts;
+
+	opts = kzalloc(sizeof(*opts), GFP_KERNEL);
+	if (!opts)
+		return -ENOMEM;
+
+	opts->fragment_cache_entries = SQUASHFS_CACHED_FRAGMENTS;
+
+	fc->fs_private = opts;
 	fc->ops = &squashfs_context_ops;
 	return 0;
 }
 
+static int squashfs_show_options(struct seq_file *s, struct dentry *root)
+{
+	struct squashfs_sb_info *msblk = root->d_sb->s_fs_info;
+
+	if (msblk->fragment_cache_entries != SQUASHFS_CACHED_FRAGMENTS)
+		seq_printf(s, ",fragment_cache=%u",
+			   msblk->fragment_cache_entries);
+
+	return 0;
+}
+
 static int squashfs_statfs(struct dentry *dentry, struct kstatfs *buf)
 {
 	struct squashfs_sb_info *msblk = dentry->d_sb->s_fs_info;
@@ -390,6 +474,7 @@ static void squashfs_put_super(struct super_block *sb)
 {
 	if (sb->s_fs_info) {
 		struct squashfs_sb_info *sbi = sb->s_fs_info;
+		squashfs_sysfs_unregister(sb);
 		squashfs_cache_delete(sbi->block_cache);
 		squashfs_cache_delete(sbi->fragment_cache);
 		squashfs_cache_delete(sbi->read_page);
@@ -444,12 +529,21 @@ static int __init init_squashfs_fs(void)
 	if (err)
 		return err;
 
+	err = squashfs_sysfs_init();
+	if (err) {
+		destroy_inodecache();
+		return err;
+	}
+
 	err = register_filesystem(&squashfs_fs_type);
 	if (err) {
+		squashfs_sysfs_exit();
 		destroy_inodecache();
 		return err;
 	}
 
+	squashfs_bench_init();
+
 	pr_info("version 4.0 (2009/01/31) Phillip Lougher\n");
 
 	return 0;
@@ -458,7 +552,9 @@ static int __init init_squashfs_fs(void)
 
 static void __exit exit_squashfs_fs(void)
 {
+	squashfs_bench_exit();
 	unregister_filesystem(&squashfs_fs_type);
+	squashfs_sysfs_exit();
 	destroy_inodecache();
 }
 
@@ -481,6 +577,7 @@ static struct file_system_type squashfs_fs_type = {
 	.owner = THIS_MODULE,
 	.name = "squashfs",
 	.init_fs_context = squashfs_init_fs_context,
+	.parameters = squashfs_fs_parameters,
 	.kill_sb = kill_block_super,
 	.fs_flags = FS_REQUIRES_DEV
 };
@@ -491,6 +588,7 @@ static const struct super_operations squashfs_super_ops = {
 	.free_inode = squashfs_free_inode,
 	.statfs = squashfs_statfs,
 	.put_super = squashfs_put_super,
+	.show_options = squashfs_show_options,
 };
 
 module_init(init_squashfs_fs);
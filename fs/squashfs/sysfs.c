@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * sysfs.c
+ */
+
+/*
+ * Each mounted filesystem gets a directory in /sys/fs/squashfs, named after
+ * the block device, which exports the hit and miss counts of the metadata
+ * and fragment caches so that the fragment_cache mount option can be tuned.
+ */
+
+#include <linux/fs.h>
+#include <linux/kobject.h>
+#include <linux/sysfs.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs.h"
+
+static struct kset *squashfs_kset;
+
+#define SQUASHFS_STAT_ATTR(_name, _cache, _field)			\
+static ssize_t _name##_show(struct kobject *kobj,			\
+			    struct kobj_attribute *attr, char *buf)	\
+{									\
+	struct squashfs_sb_info *msblk =				\
+		container_of(kobj, struct squashfs_sb_info, kobj);	\
+	struct squashfs_cache *cache = msblk->_cache;			\
+									\
+	/* There is no fragment cache if the image has no fragments */	\
+	return sysfs_emit(buf, "%lu\n",					\
+			  cache ? READ_ONCE(cache->_field) : 0);	\
+}									\
+static struct kobj_attribute squashfs_attr_##_name = __ATTR_RO(_name)
+
+SQUASHFS_STAT_ATTR(metadata_cache_hits, block_cache, hits);
+SQUASHFS_STAT_ATTR(metadata_cache_misses, block_cache, misses);
+SQUASHFS_STAT_ATTR(fragment_cache_hits, fragment_cache, hits);
+SQUASHFS_STAT_ATTR(fragment_cache_misses, fragment_cache, misses);
+
+static ssize_t fragment_cache_entries_show(struct kobject *kobj,
+					   struct kobj_attribute *attr,
+					   char *buf)
+{
+	struct squashfs_sb_info *msblk =
+		container_of(kobj, struct squashfs_sb_info, kobj);
+
+	return sysfs_emit(buf, "%u\n", msblk->fragment_cache_entries);
+}
+static struct kobj_attribute squashfs_attr_fragment_cache_entries =
+	__ATTR_RO(fragment_cache_entries);
+
+static struct attribute *squashfs_attrs[] = {
+	&squashfs_attr_metadata_cache_hits.attr,
+	&squashfs_attr_metadata_cache_misses.attr,
+	&squashfs_attr_fragment_cache_hits.attr,
+	&squashfs_attr_fragment_cache_misses.attr,
+	&squashfs_attr_fragment_cache_entries.attr,
+	NULL,
+};
+ATTRIBUTE_GROUPS(squashfs);
+
+static void squashfs_sb_release(struct kobject *kobj)
+{
+	struct squashfs_sb_info *msblk =
+		container_of(kobj, struct squashfs_sb_info, kobj);
+
+	complete(&msblk->kobj_unregister);
+}
+
+static struct kobj_type squashfs_sb_ktype = {
+	.default_groups	= squashfs_groups,
+	.sysfs_ops	= &kobj_sysfs_ops,
+	.release	= squashfs_sb_release,
+};
+
+int squashfs_sysfs_register(struct super_block *sb)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	int err;
+
+	init_completion(&msblk->kobj_unregister);
+	msblk->kobj.kset = squashfs_kset;
+
+	err = kobject_init_and_add(&msblk->kobj, &squashfs_sb_ktype, NULL,
+				   "%s", sb->s_id);
+	if (err) {
+		kobject_put(&msblk->kobj);
+		wait_for_completion(&msblk->kobj_unregister);
+	}
+
+	return err;
+}
+
+void squashfs_sysfs_unregister(struct super_block *sb)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+
+	kobject_del(&msblk->kobj);
+	kobject_put(&msblk->kobj);
+	wait_for_completion(&msblk->kobj_unregister);
+}
+
+int __init squashfs_sysfs_init(void)
+{
+	squashfs_kset = kset_create_and_add("squashfs", NULL, fs_kobj);
+
+	return squashfs_kset ? 0 : -ENOMEM;
+}
+
+void squashfs_sysfs_exit(void)
+{
+	kset_unregister(squashfs_kset);
+}
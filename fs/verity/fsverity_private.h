@@ -14,6 +14,7 @@
 
 #define pr_fmt(fmt) "fs-verity: " fmt
 
+#include <crypto/hash_info.h>
 #include <crypto/sha2.h>
 #include <linux/fsverity.h>
 #include <linux/mempool.h>
@@ -26,18 +27,13 @@ struct ahash_request;
  */
 #define FS_VERITY_MAX_LEVELS		8
 
-/*
- * Largest digest size among all hash algorithms supported by fs-verity.
- * Currently assumed to be <= size of fsverity_descriptor::root_hash.
- */
-#define FS_VERITY_MAX_DIGEST_SIZE	SHA512_DIGEST_SIZE
-
 /* A hash algorithm supported by fs-verity */
 struct fsverity_hash_alg {
 	struct crypto_ahash *tfm; /* hash tfm, allocated on demand */
 	const char *name;	  /* crypto API name, e.g. sha256 */
 	unsigned int digest_size; /* digest size in bytes, e.g. 32 for SHA-256 */
 	unsigned int block_size;  /* block size in bytes, e.g. 64 for SHA-256 */
+	enum hash_algo algo_id;	  /* the same algorithm in crypto/hash_info.h */
 	mempool_t req_pool;	  /* mempool with a preallocated hash request */
 };
 
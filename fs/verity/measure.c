@@ -57,3 +57,34 @@ int fsverity_ioctl_measure(struct file *filp, void __user *_uarg)
 	return 0;
 }
 EXPORT_SYMBOL_GPL(fsverity_ioctl_measure);
+
+/**
+ * fsverity_get_digest() - get a verity file's digest
+ * @inode: inode to get digest of
+ * @digest: (out) pointer to the digest
+ * @alg: (out) pointer to the hash algorithm enumeration
+ *
+ * Return the file digest that the kernel is enforcing for reads from a verity
+ * file, for use by other kernel subsystems such as IMA.  Unlike
+ * fsverity_ioctl_measure() the algorithm is returned as a crypto/hash_info.h
+ * enumeration.
+ *
+ * Return: 0 on success, -ENODATA if @inode is not a verity file
+ */
+int fsverity_get_digest(struct inode *inode,
+			u8 digest[FS_VERITY_MAX_DIGEST_SIZE],
+			enum hash_algo *alg)
+{
+	const struct fsverity_info *vi;
+	const struct fsverity_hash_alg *hash_alg;
+
+	vi = fsverity_get_info(inode);
+	if (!vi)
+		return -ENODATA; /* not a verity file */
+
+	hash_alg = vi->tree_params.hash_alg;
+	memcpy(digest, vi->file_digest, hash_alg->digest_size);
+	*alg = hash_alg->algo_id;
+
+	return 0;
+}
@@ -66,6 +66,36 @@ static inline int cmp_hashes(const struct fsverity_info *vi,
 	return -EBADMSG;
 }
 
+/*
+ * The last verified level 0 hash page used by verify_page(), kept across the
+ * data pages of a bio.  Consecutive data pages mostly share it, so they can
+ * take their hashes from it directly instead of looking it up again.
+ */
+struct verify_cache {
+	struct page *hpage;	/* referenced and PageChecked, or NULL */
+	pgoff_t hindex;
+};
+
+static void verify_cache_drop(struct verify_cache *vc)
+{
+	if (vc->hpage)
+		put_page(vc->hpage);
+	vc->hpage = NULL;
+}
+
+/* Keep @hpage, which holds level 0 hash block @hindex, in @vc if given */
+static void verify_cache_keep(struct verify_cache *vc, struct page *hpage,
+			      pgoff_t hindex)
+{
+	if (!vc) {
+		put_page(hpage);
+		return;
+	}
+	verify_cache_drop(vc);
+	vc->hpage = hpage;
+	vc->hindex = hindex;
+}
+
 /*
  * Verify a single data page against the file's Merkle tree.
  *
@@ -81,11 +111,15 @@ static inline int cmp_hashes(const struct fsverity_info *vi,
  * Note that multiple processes may race to verify a hash page and mark it
  * Checked, but it doesn't matter; the result will be the same either way.
  *
+ * If @vc is given, the level 0 hash page is left in it once verified, and a
+ * data page whose hash is in the page already there is checked against it
+ * without walking the tree at all.
+ *
  * Return: true if the page is valid, else false.
  */
 static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 			struct ahash_request *req, struct page *data_page,
-			unsigned long level0_ra_pages)
+			unsigned long level0_ra_pages, struct verify_cache *vc)
 {
 	const struct merkle_tree_params *params = &vi->tree_params;
 	const unsigned int hsize = params->digest_size;
@@ -95,6 +129,7 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 	const u8 *want_hash;
 	u8 real_hash[FS_VERITY_MAX_DIGEST_SIZE];
 	struct page *hpages[FS_VERITY_MAX_LEVELS];
+	pgoff_t hindex0 = 0;
 	unsigned int hoffsets[FS_VERITY_MAX_LEVELS];
 	int err;
 
@@ -103,6 +138,18 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 
 	pr_debug_ratelimited("Verifying data page %lu...\n", index);
 
+	if (vc && vc->hpage) {
+		unsigned int hoffset;
+
+		hash_at_level(params, index, 0, &hindex0, &hoffset);
+		if (vc->hindex == hindex0) {
+			extract_hash(vc->hpage, hoffset, hsize, _want_hash);
+			want_hash = _want_hash;
+			level = 0;
+			goto descend;
+		}
+	}
+
 	/*
 	 * Starting at the leaf level, ascend the tree saving hash pages along
 	 * the way until we find a verified hash page, indicated by PageChecked;
@@ -114,6 +161,8 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		struct page *hpage;
 
 		hash_at_level(params, index, level, &hindex, &hoffset);
+		if (level == 0)
+			hindex0 = hindex;
 
 		pr_debug_ratelimited("Level %d: hindex=%lu, hoffset=%u\n",
 				     level, hindex, hoffset);
@@ -131,7 +180,10 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		if (PageChecked(hpage)) {
 			extract_hash(hpage, hoffset, hsize, _want_hash);
 			want_hash = _want_hash;
-			put_page(hpage);
+			if (level == 0)
+				verify_cache_keep(vc, hpage, hindex);
+			else
+				put_page(hpage);
 			pr_debug_ratelimited("Hash page already checked, want %s:%*phN\n",
 					     params->hash_alg->name,
 					     hsize, want_hash);
@@ -160,7 +212,10 @@ static bool verify_page(struct inode *inode, const struct fsverity_info *vi,
 		SetPageChecked(hpage);
 		extract_hash(hpage, hoffset, hsize, _want_hash);
 		want_hash = _want_hash;
-		put_page(hpage);
+		if (level == 1)
+			verify_cache_keep(vc, hpage, hindex0);
+		else
+			put_page(hpage);
 		pr_debug("Verified hash page at level %d, now want %s:%*phN\n",
 			 level - 1, params->hash_alg->name, hsize, want_hash);
 	}
@@ -196,7 +251,7 @@ bool fsverity_verify_page(struct page *page)
 	/* This allocation never fails, since it's mempool-backed. */
 	req = fsverity_alloc_hash_request(vi->tree_params.hash_alg, GFP_NOFS);
 
-	valid = verify_page(inode, vi, req, page, 0);
+	valid = verify_page(inode, vi, req, page, 0, NULL);
 
 	fsverity_free_hash_request(vi->tree_params.hash_alg, req);
 
@@ -228,6 +283,7 @@ void fsverity_verify_bio(struct bio *bio)
 	struct ahash_request *req;
 	struct bio_vec *bv;
 	struct bvec_iter_all iter_all;
+	struct verify_cache vc = {};
 	unsigned long max_ra_pages = 0;
 
 	/* This allocation never fails, since it's mempool-backed. */
@@ -255,10 +311,11 @@ void fsverity_verify_bio(struct bio *bio)
 			min(max_ra_pages, params->level0_blocks - level0_index);
 
 		if (!PageError(page) &&
-		    !verify_page(inode, vi, req, page, level0_ra_pages))
+		    !verify_page(inode, vi, req, page, level0_ra_pages, &vc))
 			SetPageError(page);
 	}
 
+	verify_cache_drop(&vc);
 	fsverity_free_hash_request(params->hash_alg, req);
 }
 EXPORT_SYMBOL_GPL(fsverity_verify_bio);
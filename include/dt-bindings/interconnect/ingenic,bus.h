@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause) */
+/*
+ * Interconnect nodes of the Ingenic bus frequency scaling driver
+ */
+
+#ifndef __DT_BINDINGS_INTERCONNECT_INGENIC_BUS_H__
+#define __DT_BINDINGS_INTERCONNECT_INGENIC_BUS_H__
+
+#define INGENIC_BUS_MASTERS	0
+#define INGENIC_BUS_MEMORY	1
+
+#endif /* __DT_BINDINGS_INTERCONNECT_INGENIC_BUS_H__ */
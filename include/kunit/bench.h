@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * KUnit API to time a piece of code from a test case.
+ */
+
+#ifndef _KUNIT_BENCH_H
+#define _KUNIT_BENCH_H
+
+#include <linux/types.h>
+
+struct kunit;
+
+/* Maximum number of timed runs of a benchmark. */
+#define KUNIT_BENCH_MAX_RUNS	10000
+
+/**
+ * struct kunit_bench - describes a benchmark run by kunit_bench_run().
+ * @name: the name the results are logged under.
+ * @warmup: number of untimed runs before the timed ones.
+ * @runs: number of timed runs, at most %KUNIT_BENCH_MAX_RUNS.
+ * @cycles: count cycles with get_cycles() rather than time with
+ *	    local_clock(), on architectures which have a cycle counter.
+ * @max_median: the test fails if the median run took longer, unless 0.
+ * @max_p99: the test fails if the 99th percentile run took longer,
+ *	     unless 0.
+ *
+ * The limits are in the unit of the measurement, nanoseconds or cycles.
+ */
+struct kunit_bench {
+	const char *name;
+	unsigned int warmup;
+	unsigned int runs;
+	bool cycles;
+	u64 max_median;
+	u64 max_p99;
+};
+
+/**
+ * struct kunit_bench_result - the distribution of the timed runs.
+ * @min: the fastest run.
+ * @median: the median run.
+ * @p90: the 90th percentile run.
+ * @p99: the 99th percentile run.
+ * @max: the slowest run.
+ *
+ * All of them are in the unit of the measurement, nanoseconds or cycles.
+ */
+struct kunit_bench_result {
+	u64 min;
+	u64 median;
+	u64 p90;
+	u64 p99;
+	u64 max;
+};
+
+/**
+ * kunit_bench_run() - time a function from a test case.
+ * @test: the test context object.
+ * @bench: the benchmark to run.
+ * @fn: the function to time, called with @test and @data.
+ * @data: passed to @fn.
+ * @result: filled with the results if not NULL.
+ *
+ * Runs @fn @bench->warmup times, then @bench->runs times timing each run,
+ * and logs the distribution of the timed runs to the test log, which shows
+ * in debugfs. Fails the test if a limit in @bench is exceeded.
+ *
+ * Return: 0 on success, or -errno if the benchmark couldn't run.
+ */
+int kunit_bench_run(struct kunit *test, const struct kunit_bench *bench,
+		    void (*fn)(struct kunit *test, void *data), void *data,
+		    struct kunit_bench_result *result);
+
+#endif /* _KUNIT_BENCH_H */
@@ -341,6 +341,9 @@ struct cgroup_freezer_state {
 	/* Should the cgroup actually be frozen? */
 	int e_freeze;
 
+	/* Bytes of anonymous memory to prefetch for each process on thaw */
+	u64 thaw_prefetch;
+
 	/* Fields below are protected by css_set_lock */
 
 	/* Number of frozen descendant cgroups */
@@ -15,6 +15,7 @@
 #include <linux/list.h>
 #include <linux/path.h> /* struct path */
 #include <linux/spinlock.h>
+#include <linux/timer.h>
 #include <linux/types.h>
 #include <linux/atomic.h>
 #include <linux/user_namespace.h>
@@ -194,6 +195,8 @@ struct fsnotify_group {
 	wait_queue_head_t notification_waitq;	/* read() on the notification file blocks on this waitq */
 	unsigned int q_len;			/* events on the queue */
 	unsigned int max_events;		/* maximum events allowed on the list */
+	unsigned long notification_delay;	/* jiffies to batch the wakeups of the readers over */
+	struct timer_list notification_timer;	/* wakes the readers up at the end of a batch */
 	/*
 	 * Valid fsnotify group priorities.  Events are send in order from highest
 	 * priority to lowest priority.  We default to the lowest priority.
@@ -488,6 +491,9 @@ extern int fsnotify_add_event(struct fsnotify_group *group,
 					   struct fsnotify_event *),
 			      void (*insert)(struct fsnotify_group *,
 					     struct fsnotify_event *));
+/* batch the wakeups of the readers over @delay jiffies, 0 to wake per event */
+extern void fsnotify_set_notification_delay(struct fsnotify_group *group,
+					    unsigned long delay);
 /* Queue overflow event to a notification group */
 static inline void fsnotify_queue_overflow(struct fsnotify_group *group)
 {
@@ -43,6 +43,8 @@ struct gpio_keys_button {
  * @nbuttons:		number of elements in @buttons array
  * @poll_interval:	polling interval in msecs - for polling driver only
  * @rep:		enable input subsystem auto repeat
+ * @batch_scan:		read and debounce all GPIO buttons together, and
+ *			report them in a single packet
  * @enable:		platform hook for enabling the device
  * @disable:		platform hook for disabling the device
  * @name:		input device name
@@ -52,6 +54,7 @@ struct gpio_keys_platform_data {
 	int nbuttons;
 	unsigned int poll_interval;
 	unsigned int rep:1;
+	unsigned int batch_scan:1;
 	int (*enable)(struct device *dev);
 	void (*disable)(struct device *dev);
 	const char *name;
@@ -17,6 +17,13 @@ struct irq_desc;
 struct irq_domain;
 struct pt_regs;
 
+/*
+ * Slots of desc->thread_latency: slot n counts the irq thread wakeups after
+ * which the thread ran within 2^(n-1) to 2^n us, the last one also those past
+ * 16 ms, by which time an audio period has been missed anyway.
+ */
+#define IRQ_THREAD_LATENCY_BUCKETS	16
+
 /**
  * struct irq_desc - interrupt descriptor
  * @irq_common_data:	per irq and chip data passed down to chip functions
@@ -50,6 +57,7 @@ struct pt_regs;
  * @request_mutex:	mutex to protect request/free before locking desc->lock
  * @dir:		/proc/irq/ procfs entry
  * @debugfs_file:	dentry for the debugfs file
+ * @thread_latency:	histogram of the irq thread wakeup latency
  * @name:		flow handler name for /proc/interrupts output
  */
 struct irq_desc {
@@ -93,6 +101,7 @@ struct irq_desc {
 #ifdef CONFIG_GENERIC_IRQ_DEBUGFS
 	struct dentry		*debugfs_file;
 	const char		*dev_name;
+	unsigned long		thread_latency[IRQ_THREAD_LATENCY_BUCKETS];
 #endif
 #ifdef CONFIG_SPARSE_IRQ
 	struct rcu_head		rcu;
@@ -25,6 +25,7 @@
 #include <linux/stddef.h>
 #include <linux/mutex.h>
 #include <linux/timer.h>
+#include <linux/workqueue.h>
 #include <linux/slab.h>
 #include <linux/bit_spinlock.h>
 #include <linux/blkdev.h>
@@ -894,6 +895,14 @@ struct journal_s
 	 */
 	struct mutex		j_checkpoint_mutex;
 
+	/**
+	 * @j_checkpoint_work:
+	 *
+	 * Checkpoints in the background when the log runs low on space,
+	 * if JBD2_BG_CHECKPOINT is set.
+	 */
+	struct work_struct	j_checkpoint_work;
+
 	/**
 	 * @j_chkpt_bhs:
 	 *
@@ -1370,6 +1379,7 @@ JBD2_FEATURE_INCOMPAT_FUNCS(fast_commit,	FAST_COMMIT)
 						 * mode */
 #define JBD2_FAST_COMMIT_ONGOING	0x100	/* Fast commit is ongoing */
 #define JBD2_FULL_COMMIT_ONGOING	0x200	/* Full commit is ongoing */
+#define JBD2_BG_CHECKPOINT	0x400	/* Checkpoint before the log is full */
 
 /*
  * Function declarations for the journaling transaction and buffer
@@ -1620,7 +1630,10 @@ int jbd2_log_wait_commit(journal_t *journal, tid_t tid);
 int jbd2_transaction_committed(journal_t *journal, tid_t tid);
 int jbd2_complete_transaction(journal_t *journal, tid_t tid);
 int jbd2_log_do_checkpoint(journal_t *journal);
+void jbd2_log_start_checkpoint(journal_t *journal);
+void jbd2_checkpoint_work(struct work_struct *work);
 int jbd2_trans_will_send_data_barrier(journal_t *journal, tid_t tid);
+void jbd2_journal_batch_sync(journal_t *journal, ktime_t start_time);
 
 void __jbd2_log_wait_for_space(journal_t *journal);
 extern void __jbd2_journal_drop_transaction(journal_t *, transaction_t *);
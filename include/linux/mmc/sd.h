@@ -22,6 +22,10 @@
 #define SD_ERASE_WR_BLK_START    32   /* ac   [31:0] data addr   R1  */
 #define SD_ERASE_WR_BLK_END      33   /* ac   [31:0] data addr   R1  */
 
+  /* class 11 */
+#define SD_READ_EXTR_SINGLE      48   /* adtc [31:0]             R1  */
+#define SD_WRITE_EXTR_SINGLE     49   /* adtc [31:0]             R1  */
+
   /* Application commands */
 #define SD_APP_SET_BUS_WIDTH      6   /* ac   [1:0] bus width    R1  */
 #define SD_APP_SD_STATUS         13   /* adtc                    R1  */
@@ -267,6 +267,9 @@ struct xt_table_info {
 	unsigned int stacksize;
 	void ***jumpstack;
 
+	/* Optional lookup structure built by the family, e.g. ip_tables */
+	void *classifier;
+
 	unsigned char entries[] __aligned(8);
 };
 
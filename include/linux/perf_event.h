@@ -734,6 +734,7 @@ struct perf_event {
 
 	/* delayed work for NMIs and such */
 	int				pending_wakeup;
+	int				pending_idle_wakeup;
 	int				pending_kill;
 	int				pending_disable;
 	unsigned long			pending_addr;	/* SIGTRAP */
@@ -268,6 +268,14 @@ struct power_supply_desc {
 	bool no_thermal;
 	/* For APM emulation, think legacy userspace. */
 	int use_for_apm;
+
+	/*
+	 * Minimum time between two change notifications, the changes reported
+	 * in between are merged into a single uevent sent when it elapses.
+	 * They don't hold the wakeup source while they wait.
+	 * Zero notifies every change right away.
+	 */
+	unsigned int changed_min_interval_ms;
 };
 
 struct power_supply {
@@ -285,9 +293,10 @@ struct power_supply {
 
 	/* private */
 	struct device dev;
-	struct work_struct changed_work;
+	struct delayed_work changed_work;
 	struct delayed_work deferred_register_work;
 	spinlock_t changed_lock;
+	unsigned long changed_time;
 	bool changed;
 	bool initialized;
 	bool removing;
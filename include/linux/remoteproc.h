@@ -522,6 +522,9 @@ struct rproc_dump_segment {
  * @table_sz: size of @cached_table
  * @has_iommu: flag to indicate if remote processor is behind an MMU
  * @auto_boot: flag to indicate if remote processor should be auto-started
+ * @keep_firmware: flag to indicate if the firmware image should be kept in
+ *		   memory between boots, rather than requested on every boot
+ * @fw_cache: the firmware image kept from the last boot, if @keep_firmware
  * @dump_segments: list of segments in the firmware
  * @nb_vdev: number of vdev currently handled by rproc
  * @char_dev: character device of the rproc
@@ -559,6 +562,8 @@ struct rproc {
 	size_t table_sz;
 	bool has_iommu;
 	bool auto_boot;
+	bool keep_firmware;
+	const struct firmware *fw_cache;
 	struct list_head dump_segments;
 	int nb_vdev;
 	u8 elf_class;
@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * Userspace API of the Ingenic JZ47xx DRM driver.
+ */
+
+#ifndef _UAPI_INGENIC_DRM_H_
+#define _UAPI_INGENIC_DRM_H_
+
+#include "drm.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * struct drm_ingenic_gem_blit - copy a rectangle between two GEM objects
+ * @src_handle: handle of the source GEM object
+ * @dst_handle: handle of the destination GEM object, may be the same as
+ *	@src_handle as long as the two rectangles don't overlap
+ * @src_offset: offset in bytes of the rectangle's first line in the source
+ * @dst_offset: offset in bytes of the rectangle's first line in the
+ *	destination
+ * @src_pitch: distance in bytes between two lines in the source
+ * @dst_pitch: distance in bytes between two lines in the destination
+ * @width: size in bytes of one line of the rectangle
+ * @height: number of lines of the rectangle
+ * @flags: must be zero
+ * @pad: must be zero
+ *
+ * The copy is performed by the DMA controller; the ioctl returns once it is
+ * complete. All offsets, pitches and the width must be multiples of 4.
+ */
+struct drm_ingenic_gem_blit {
+	__u32 src_handle;
+	__u32 dst_handle;
+	__u32 src_offset;
+	__u32 dst_offset;
+	__u32 src_pitch;
+	__u32 dst_pitch;
+	__u32 width;
+	__u32 height;
+	__u32 flags;
+	__u32 pad;
+};
+
+#define DRM_INGENIC_GEM_BLIT		0x00
+
+#define DRM_IOCTL_INGENIC_GEM_BLIT	DRM_IOW(DRM_COMMAND_BASE + DRM_INGENIC_GEM_BLIT, struct drm_ingenic_gem_blit)
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _UAPI_INGENIC_DRM_H_ */
@@ -181,6 +181,11 @@
  *  - add FUSE_OPEN_KILL_SUIDGID
  *  - extend fuse_setxattr_in, add FUSE_SETXATTR_EXT
  *  - add FUSE_SETXATTR_ACL_KILL_SGID
+ *
+ *  7.34
+ *  - add FUSE_PASSTHROUGH, FUSE_DEV_IOC_PASSTHROUGH_OPEN and
+ *    struct fuse_passthrough_out
+ *  - add passthrough_fh to fuse_open_out
  */
 
 #ifndef _LINUX_FUSE_H
@@ -216,7 +221,7 @@
 #define FUSE_KERNEL_VERSION 7
 
 /** Minor version number of this interface */
-#define FUSE_KERNEL_MINOR_VERSION 33
+#define FUSE_KERNEL_MINOR_VERSION 34
 
 /** The node ID of the root inode */
 #define FUSE_ROOT_ID 1
@@ -333,6 +338,9 @@ struct fuse_file_lock {
  *			write/truncate sgid is killed only if file has group
  *			execute permission. (Same as Linux VFS behavior).
  * FUSE_SETXATTR_EXT:	Server supports extended struct fuse_setxattr_in
+ * FUSE_PASSTHROUGH: read/write/mmap of files opened with a passthrough_fh
+ *		     obtained from FUSE_DEV_IOC_PASSTHROUGH_OPEN go directly
+ *		     to the backing file
  */
 #define FUSE_ASYNC_READ		(1 << 0)
 #define FUSE_POSIX_LOCKS	(1 << 1)
@@ -364,6 +372,7 @@ struct fuse_file_lock {
 #define FUSE_SUBMOUNTS		(1 << 27)
 #define FUSE_HANDLE_KILLPRIV_V2	(1 << 28)
 #define FUSE_SETXATTR_EXT	(1 << 29)
+#define FUSE_PASSTHROUGH	(1U << 31)
 
 /**
  * CUSE INIT request/reply flags
@@ -635,7 +644,7 @@ struct fuse_create_in {
 struct fuse_open_out {
 	uint64_t	fh;
 	uint32_t	open_flags;
-	uint32_t	padding;
+	uint32_t	passthrough_fh;
 };
 
 struct fuse_release_in {
@@ -919,6 +928,23 @@ struct fuse_notify_retrieve_in {
 /* Device ioctls: */
 #define FUSE_DEV_IOC_MAGIC		229
 #define FUSE_DEV_IOC_CLONE		_IOR(FUSE_DEV_IOC_MAGIC, 0, uint32_t)
+#define FUSE_DEV_IOC_PASSTHROUGH_OPEN	_IOW(FUSE_DEV_IOC_MAGIC, 1, \
+					     struct fuse_passthrough_out)
+
+/**
+ * struct fuse_passthrough_out - argument of FUSE_DEV_IOC_PASSTHROUGH_OPEN
+ *
+ * @fd: open file to pass the I/O of a fuse file through to
+ * @flags: must be zero
+ *
+ * The ioctl returns an identifier to put in fuse_open_out.passthrough_fh
+ * when replying to the FUSE_OPEN or FUSE_CREATE of the fuse file. Each
+ * identifier can only be used once.
+ */
+struct fuse_passthrough_out {
+	uint32_t	fd;
+	uint32_t	flags;
+};
 
 struct fuse_lseek_in {
 	uint64_t	fh;
@@ -128,6 +128,10 @@ struct tpacket_auxdata {
 
 /* Rx ring - feature request bits */
 #define TP_FT_REQ_FILL_RXHASH	0x1
+/* Stretch tp_retire_blk_tov up to 8 times when the packet rate is low */
+#define TP_FT_REQ_ADAPTIVE_TOV	0x2
+/* Wake up once for several blocks filled in a row, not for every block */
+#define TP_FT_REQ_COALESCE_WAKEUP	0x4
 
 struct tpacket_hdr {
 	unsigned long	tp_status;
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * IOCTLs for the Ingenic JZ47xx VPU remoteproc driver.
+ */
+
+#ifndef _UAPI_LINUX_INGENIC_VPU_H_
+#define _UAPI_LINUX_INGENIC_VPU_H_
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define INGENIC_VPU_MAGIC	0xB8
+
+/**
+ * struct ingenic_vpu_dmabuf - DMABUF shared with the VPU
+ * @fd: file descriptor of the DMABUF
+ * @flags: must be zero
+ * @da: (out) address of the buffer as seen by the VPU
+ * @size: (out) size of the buffer, in bytes
+ */
+struct ingenic_vpu_dmabuf {
+	__s32 fd;
+	__u32 flags;
+	__u64 da;
+	__u64 size;
+};
+
+/*
+ * The INGENIC_VPU_MAP_DMABUF ioctl maps a physically contiguous DMABUF (e.g.
+ * a DRM dumb buffer exported with PRIME) for the VPU, and returns its device
+ * address, so that the VPU firmware can write decoded frames directly into a
+ * buffer that can be scanned out. The mapping is released with
+ * INGENIC_VPU_UNMAP_DMABUF, or when the file is closed.
+ */
+#define INGENIC_VPU_MAP_DMABUF		_IOWR(INGENIC_VPU_MAGIC, 1, struct ingenic_vpu_dmabuf)
+#define INGENIC_VPU_UNMAP_DMABUF	_IOW(INGENIC_VPU_MAGIC, 2, struct ingenic_vpu_dmabuf)
+
+#endif /* _UAPI_LINUX_INGENIC_VPU_H_ */
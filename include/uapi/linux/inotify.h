@@ -78,7 +78,13 @@ struct inotify_event {
  *
  * INOTIFY_IOC_SETNEXTWD: set desired number of next created
  * watch descriptor.
+ *
+ * INOTIFY_IOC_SETCOALESCE: set a window, in milliseconds, over which
+ * the events are coalesced before waking up the readers, 0 to disable.
+ * An event is then merged with the last queued event of the same
+ * object when they are identical.
  */
 #define INOTIFY_IOC_SETNEXTWD	_IOW('I', 0, __s32)
+#define INOTIFY_IOC_SETCOALESCE	_IOW('I', 1, __u32)
 
 #endif /* _UAPI_LINUX_INOTIFY_H */
@@ -126,6 +126,56 @@ struct input_mask {
 	__u64 codes_ptr;
 };
 
+/**
+ * struct input_ring_event - event stored in the ring set up with EVIOCSRING
+ * @time: timestamp in nanoseconds, of the clock set with EVIOCSCLOCKID
+ * @type: event type, as in struct input_event
+ * @code: event code
+ * @value: event value
+ */
+struct input_ring_event {
+	__u64 time;
+	__u16 type;
+	__u16 code;
+	__s32 value;
+};
+
+/**
+ * struct input_ring - ring mapped by the client after EVIOCSRING
+ * @head: written by the kernel, index past the last complete packet
+ * @tail: written by the client, index of the next event it will consume
+ * @size: number of events in the ring, a power of two
+ * @reserved: must be ignored
+ * @events: the event at index i is events[i & (size - 1)]
+ *
+ * Indices run freely and wrap at 2^32. The kernel only advances @head past
+ * whole packets, so the client sees the events from @tail to @head once it
+ * has read @head with acquire semantics. It must store @tail with release
+ * semantics once it is done with the events.
+ *
+ * When the ring is full, new events are dropped. Once there is room again,
+ * the kernel queues SYN_DROPPED, and the client must resync the device
+ * state as it does with read().
+ */
+struct input_ring {
+	__u32 head;
+	__u32 tail;
+	__u32 size;
+	__u32 reserved;
+	struct input_ring_event events[];
+};
+
+/**
+ * struct input_ring_setup - argument of EVIOCSRING
+ * @size: number of events in the ring, a power of two, or 0 for the size
+ *	of the read() buffer
+ * @eventfd: eventfd signalled when a packet is added to the ring, or -1
+ */
+struct input_ring_setup {
+	__u32 size;
+	__s32 eventfd;
+};
+
 #define EVIOCGVERSION		_IOR('E', 0x01, int)			/* get driver version */
 #define EVIOCGID		_IOR('E', 0x02, struct input_id)	/* get device ID */
 #define EVIOCGREP		_IOR('E', 0x03, unsigned int[2])	/* get repeat settings */
@@ -239,6 +289,22 @@ struct input_mask {
 
 #define EVIOCSCLOCKID		_IOW('E', 0xa0, int)			/* Set clockid to be used for timestamps */
 
+/**
+ * EVIOCSRING - Deliver the events to a shared memory ring
+ *
+ * This ioctl allocates a struct input_ring for the client, which is then
+ * mapped by calling mmap() on the device at offset 0, with a length of
+ * sizeof(struct input_ring) + size * sizeof(struct input_ring_event),
+ * PROT_READ | PROT_WRITE and MAP_SHARED. From then on, all the events of
+ * the client are delivered to the ring, which can be consumed without any
+ * system call; read() fails with EINVAL. poll() and the optional eventfd
+ * can still be used to wait for new packets.
+ *
+ * A ring can only be set up once per file descriptor; the ioctl fails with
+ * EBUSY afterwards. EINVAL is returned if the size is invalid.
+ */
+#define EVIOCSRING		_IOW('E', 0xa1, struct input_ring_setup)	/* Set up an event ring */
+
 /*
  * IDs.
  */
@@ -342,6 +342,10 @@ enum
 	LINUX_MIB_TLSRXDEVICE,			/* TlsRxDevice */
 	LINUX_MIB_TLSDECRYPTERROR,		/* TlsDecryptError */
 	LINUX_MIB_TLSRXDEVICERESYNC,		/* TlsRxDeviceResync */
+	LINUX_MIB_TLSTXSWRECORDS,		/* TlsTxSwRecords */
+	LINUX_MIB_TLSTXSWCRYPTOUSECS,		/* TlsTxSwCryptoUsecs */
+	LINUX_MIB_TLSRXSWRECORDS,		/* TlsRxSwRecords */
+	LINUX_MIB_TLSRXSWCRYPTOUSECS,		/* TlsRxSwCryptoUsecs */
 	__LINUX_MIB_TLSMAX
 };
 
@@ -11,6 +11,8 @@
 #include <linux/timex.h>
 #include <linux/smp.h>
 #include <linux/percpu.h>
+#include <linux/math64.h>
+#include <linux/sched/clock.h>
 
 unsigned long lpj_fine;
 unsigned long preset_lpj;
@@ -173,6 +175,69 @@ static unsigned long calibrate_delay_direct(void)
 }
 #endif
 
+#ifdef CONFIG_GENERIC_SCHED_CLOCK
+/*
+ * Once a clocksource driver has registered a fine grained sched_clock(),
+ * e.g. from a SoC timer it knows the exact rate of, a few milliseconds of
+ * __delay() timed against it are enough to find loops_per_jiffy, instead of
+ * the jiffy-by-jiffy binary search below.
+ */
+#define SCHED_CLOCK_MAX_RES_NS		10000
+#define SCHED_CLOCK_MIN_STEPS		256
+#define SCHED_CLOCK_TRIALS		3
+
+static u64 sched_clock_next(u64 t)
+{
+	u64 now;
+
+	do {
+		now = sched_clock();
+	} while (now == t);
+
+	return now;
+}
+
+static unsigned long calibrate_delay_sched_clock(void)
+{
+	unsigned long loops = (1 << 12);
+	u64 t, res, delta, best = U64_MAX;
+	int i;
+
+	/* The jiffies based fallback is far too coarse for this */
+	t = sched_clock_next(sched_clock());
+	res = sched_clock_next(t) - t;
+	if (!res || res > SCHED_CLOCK_MAX_RES_NS)
+		return 0;
+
+	/* Find a loop count long enough to hide the clock resolution */
+	for (;;) {
+		t = sched_clock();
+		__delay(loops);
+		delta = sched_clock() - t;
+		if (delta >= res * SCHED_CLOCK_MIN_STEPS)
+			break;
+		if (loops > ULONG_MAX / 2)
+			return 0;
+		loops <<= 1;
+	}
+
+	/* Interrupts only make a run slower, so keep the fastest one */
+	for (i = 0; i < SCHED_CLOCK_TRIALS; i++) {
+		t = sched_clock_next(sched_clock());
+		__delay(loops);
+		delta = sched_clock() - t;
+		best = min(best, delta);
+	}
+
+	return div64_u64((u64)loops * (NSEC_PER_SEC / HZ), best);
+}
+#else
+static unsigned long calibrate_delay_sched_clock(void)
+{
+	return 0;
+}
+#endif
+
 /*
  * This is the number of bits of precision for the loops_per_jiffy.  Each
  * time we refine our estimate after the first takes 1.5/HZ seconds, so try
@@ -298,6 +363,9 @@ void calibrate_delay(void)
 		if (!printed)
 			pr_info("Calibrating delay using timer "
 				"specific routine.. ");
+	} else if ((lpj = calibrate_delay_sched_clock()) != 0) {
+		if (!printed)
+			pr_info("Calibrating delay using sched_clock.. ");
 	} else {
 		if (!printed)
 			pr_info("Calibrating delay loop... ");
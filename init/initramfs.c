@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 #include <linux/init.h>
 #include <linux/async.h>
+#include <linux/completion.h>
 #include <linux/fs.h>
 #include <linux/slab.h>
 #include <linux/types.h>
@@ -333,6 +334,59 @@ static int __init maybe_link(void)
 static __initdata struct file *wfile;
 static __initdata loff_t wfile_pos;
 
+/*
+ * initramfs_early= lists, comma separated, the files and directories that
+ * the archive holds first, e.g. "init,lib/firmware,lib/modules".  Once the
+ * first regular file or symlink outside of them shows up, everything before
+ * it has been unpacked and wait_for_initramfs_early() callers may go on.
+ */
+static __initdata char *early_files;
+static __initdata bool early_done;
+static DECLARE_COMPLETION(initramfs_early_done);
+
+static int __init initramfs_early_setup(char *str)
+{
+	early_files = str;
+	return 1;
+}
+__setup("initramfs_early=", initramfs_early_setup);
+
+static bool __init is_early_file(const char *path)
+{
+	const char *p = early_files, *end;
+	size_t len;
+
+	while (*path == '/')
+		path++;
+
+	while (*p) {
+		while (*p == '/')
+			p++;
+		end = strchrnul(p, ',');
+		len = end - p;
+		while (len && p[len - 1] == '/')
+			len--;
+
+		if (len && !strncmp(path, p, len) &&
+		    (path[len] == '\0' || path[len] == '/'))
+			return true;
+
+		p = *end ? end + 1 : end;
+	}
+
+	return false;
+}
+
+static void __init early_check(const char *path)
+{
+	if (early_done || !early_files || is_early_file(path))
+		return;
+
+	early_done = true;
+	pr_info("Early part of initramfs unpacked\n");
+	complete_all(&initramfs_early_done);
+}
+
 static int __init do_name(void)
 {
 	state = SkipIt;
@@ -341,9 +395,14 @@ static int __init do_name(void)
 		free_hash();
 		return 0;
 	}
+	/* Let device probing run on single CPU systems, once per entry */
+	cond_resched();
 	clean_path(collected, mode);
 	if (S_ISREG(mode)) {
-		int ml = maybe_link();
+		int ml;
+
+		early_check(collected);
+		ml = maybe_link();
 		if (ml >= 0) {
 			int openflags = O_WRONLY|O_CREAT;
 			if (ml != 1)
@@ -403,6 +462,7 @@ static int __init do_copy(void)
 static int __init do_symlink(void)
 {
 	collected[N_ALIGN(name_len) + body_len] = '\0';
+	early_check(collected);
 	clean_path(collected, 0);
 	init_symlink(collected + N_ALIGN(name_len), collected);
 	init_chown(collected, uid, gid, AT_SYMLINK_NOFOLLOW);
@@ -667,6 +727,8 @@ static void __init populate_initrd_image(char *err)
 }
 #endif /* CONFIG_BLK_DEV_RAM */
 
+static bool initramfs_populated;
+
 static void __init do_populate_rootfs(void *unused, async_cookie_t cookie)
 {
 	/* Load the built in initramfs */
@@ -702,6 +764,9 @@ static void __init do_populate_rootfs(void *unused, async_cookie_t cookie)
 	initrd_end = 0;
 
 	flush_delayed_fput();
+
+	smp_store_release(&initramfs_populated, true);
+	complete_all(&initramfs_early_done);
 }
 
 static ASYNC_DOMAIN_EXCLUSIVE(initramfs_domain);
@@ -723,6 +788,22 @@ void wait_for_initramfs(void)
 }
 EXPORT_SYMBOL_GPL(wait_for_initramfs);
 
+/*
+ * Wait for the part of the initramfs listed in initramfs_early=, or for all
+ * of it without that option.  Returns true if all of it is unpacked, so the
+ * caller knows whether a missing file may still show up.
+ */
+bool wait_for_initramfs_early(void)
+{
+	if (!initramfs_cookie) {
+		wait_for_initramfs();
+		return true;
+	}
+	wait_for_completion(&initramfs_early_done);
+	return smp_load_acquire(&initramfs_populated);
+}
+EXPORT_SYMBOL_GPL(wait_for_initramfs_early);
+
 static int __init populate_rootfs(void)
 {
 	initramfs_cookie = async_schedule_domain(do_populate_rootfs, NULL,
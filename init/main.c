@@ -83,6 +83,7 @@
 #include <linux/blkdev.h>
 #include <linux/elevator.h>
 #include <linux/sched/clock.h>
+#include <linux/sched/cputime.h>
 #include <linux/sched/task.h>
 #include <linux/sched/task_stack.h>
 #include <linux/context_tracking.h>
@@ -98,6 +99,7 @@
 #include <linux/kcsan.h>
 #include <linux/init_syscalls.h>
 #include <linux/stackdepot.h>
+#include <linux/tracefs.h>
 
 #include <asm/io.h>
 #include <asm/bugs.h>
@@ -1236,18 +1238,148 @@ static inline void do_trace_initcall_finish(initcall_t fn, int ret)
 }
 #endif /* !TRACEPOINTS_ENABLED */
 
+#ifdef CONFIG_TRACING
+/*
+ * With initcall_timeline, every initcall run during boot is recorded with its
+ * level, start time, duration and the part of it spent off the CPU (waiting
+ * for async work, probing, firmware, ...), along with the async waits of the
+ * boot itself.  The records are listed in tracefs as initcall_timeline;
+ * "level;function duration" lines built from them can be fed to a flamegraph.
+ */
+static bool initcall_timeline __ro_after_init;
+core_param(initcall_timeline, initcall_timeline, bool, 0444);
+
+struct initcall_record {
+	struct list_head list;
+	char level[12];
+	char *name;
+	u64 start;
+	u64 duration;
+	u64 runtime;
+	int ret;
+};
+
+static LIST_HEAD(initcall_records);
+static DEFINE_MUTEX(initcall_records_lock);
+static char initcall_cur_level[12] = "early";
+
+static __printf(2, 3) struct initcall_record *
+initcall_record_begin(const char *level, const char *fmt, ...)
+{
+	struct initcall_record *rec;
+	va_list args;
+
+	if (!initcall_timeline || system_state >= SYSTEM_RUNNING)
+		return NULL;
+
+	rec = kzalloc(sizeof(*rec), GFP_KERNEL);
+	if (!rec)
+		return NULL;
+
+	va_start(args, fmt);
+	rec->name = kvasprintf(GFP_KERNEL, fmt, args);
+	va_end(args);
+	if (!rec->name) {
+		kfree(rec);
+		return NULL;
+	}
+
+	strscpy(rec->level, level, sizeof(rec->level));
+	rec->runtime = task_sched_runtime(current);
+	rec->start = local_clock();
+	return rec;
+}
+
+static void initcall_record_end(struct initcall_record *rec, int ret)
+{
+	if (!rec)
+		return;
+
+	rec->duration = local_clock() - rec->start;
+	rec->runtime = task_sched_runtime(current) - rec->runtime;
+	rec->ret = ret;
+
+	mutex_lock(&initcall_records_lock);
+	list_add_tail(&rec->list, &initcall_records);
+	mutex_unlock(&initcall_records_lock);
+}
+
+static void *initcall_timeline_start(struct seq_file *m, loff_t *pos)
+{
+	mutex_lock(&initcall_records_lock);
+	if (!*pos)
+		seq_puts(m, "# level function start_us duration_us blocked_us ret\n");
+	return seq_list_start(&initcall_records, *pos);
+}
+
+static void *initcall_timeline_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	return seq_list_next(v, &initcall_records, pos);
+}
+
+static void initcall_timeline_stop(struct seq_file *m, void *v)
+{
+	mutex_unlock(&initcall_records_lock);
+}
+
+static int initcall_timeline_show(struct seq_file *m, void *v)
+{
+	const struct initcall_record *rec =
+		list_entry(v, struct initcall_record, list);
+	u64 blocked = rec->duration > rec->runtime ?
+		      rec->duration - rec->runtime : 0;
+
+	seq_printf(m, "%s %s %llu %llu %llu %d\n", rec->level, rec->name,
+		   div_u64(rec->start, NSEC_PER_USEC),
+		   div_u64(rec->duration, NSEC_PER_USEC),
+		   div_u64(blocked, NSEC_PER_USEC), rec->ret);
+	return 0;
+}
+
+static const struct seq_operations initcall_timeline_sops = {
+	.start	= initcall_timeline_start,
+	.next	= initcall_timeline_next,
+	.stop	= initcall_timeline_stop,
+	.show	= initcall_timeline_show,
+};
+DEFINE_SEQ_ATTRIBUTE(initcall_timeline);
+
+static int __init initcall_timeline_init(void)
+{
+	if (initcall_timeline)
+		tracefs_create_file("initcall_timeline", 0400, NULL, NULL,
+				    &initcall_timeline_fops);
+	return 0;
+}
+fs_initcall(initcall_timeline_init);
+#else
+struct initcall_record;
+
+static char initcall_cur_level[12] __maybe_unused;
+
+static inline __printf(2, 3) struct initcall_record *
+initcall_record_begin(const char *level, const char *fmt, ...)
+{
+	return NULL;
+}
+static inline void initcall_record_end(struct initcall_record *rec, int ret) { }
+#endif /* CONFIG_TRACING */
+
 int __init_or_module do_one_initcall(initcall_t fn)
 {
 	int count = preempt_count();
+	struct initcall_record *rec;
 	char msgbuf[64];
 	int ret;
 
 	if (initcall_blacklisted(fn))
 		return -EPERM;
 
+	rec = initcall_record_begin(initcall_cur_level, "%ps", fn);
 	do_trace_initcall_start(fn);
 	ret = fn();
 	do_trace_initcall_finish(fn, ret);
+	initcall_record_end(rec, ret);
 
 	msgbuf[0] = 0;
 
@@ -1317,6 +1449,8 @@ static void __init do_initcall_level(int level, char *command_line)
 		   level, level,
 		   NULL, ignore_unknown_bootoption);
 
+	strscpy(initcall_cur_level, initcall_level_names[level],
+		sizeof(initcall_cur_level));
 	trace_initcall_level(initcall_level_names[level]);
 	for (fn = initcall_levels[level]; fn < initcall_levels[level+1]; fn++)
 		do_one_initcall(initcall_from_entry(fn));
@@ -1442,11 +1576,14 @@ void __weak free_initmem(void)
 
 static int __ref kernel_init(void *unused)
 {
+	struct initcall_record *rec;
 	int ret;
 
 	kernel_init_freeable();
 	/* need to finish all async __init code before freeing the memory */
+	rec = initcall_record_begin("wait", "async_synchronize_full");
 	async_synchronize_full();
+	initcall_record_end(rec, 0);
 	kprobe_free_init_mem();
 	ftrace_free_init_mem();
 	kgdb_free_init_mem();
@@ -1524,6 +1661,8 @@ void __init console_on_rootfs(void)
 
 static noinline void __init kernel_init_freeable(void)
 {
+	struct initcall_record *rec;
+
 	/*
 	 * Wait until kthreadd is all set-up.
 	 */
@@ -1561,7 +1700,9 @@ static noinline void __init kernel_init_freeable(void)
 
 	kunit_run_all_tests();
 
+	rec = initcall_record_begin("wait", "wait_for_initramfs");
 	wait_for_initramfs();
+	initcall_record_end(rec, 0);
 	console_on_rootfs();
 
 	/*
@@ -54,6 +54,14 @@ struct mqueue_fs_context {
 #define SEND		0
 #define RECV		1
 
+/*
+ * Queues of small messages keep up to MQ_POOL_MAX freed message buffers,
+ * sized for mq_msgsize, so that steady traffic doesn't allocate.  The
+ * memory is part of what the queue is already charged for.
+ */
+#define MQ_POOL_MAX		16
+#define MQ_POOL_MSGSIZE_MAX	8192
+
 #define STATE_NONE	0
 #define STATE_READY	1
 
@@ -152,6 +160,11 @@ struct mqueue_inode_info {
 	struct ext_wait_queue e_wait_q[2];
 
 	unsigned long qsize; /* size of queue in memory (sum of all msgs) */
+
+	/* free message buffers, linked by m_list */
+	struct list_head msg_pool;
+	unsigned int msg_pool_len;
+	unsigned int msg_pool_max;
 };
 
 static struct file_system_type mqueue_fs_type;
@@ -288,6 +301,74 @@ static inline struct msg_msg *msg_get(struct mqueue_inode_info *info)
 	return msg;
 }
 
+/* Preallocate the message buffers of a new queue, as far as memory allows */
+static void mq_pool_fill(struct mqueue_inode_info *info, unsigned int max)
+{
+	struct msg_msg *msg;
+
+	info->msg_pool_max = max;
+	while (info->msg_pool_len < max) {
+		msg = alloc_msg(info->attr.mq_msgsize);
+		if (!msg)
+			break;
+		list_add(&msg->m_list, &info->msg_pool);
+		info->msg_pool_len++;
+	}
+}
+
+static void mq_free_msg(struct mqueue_inode_info *info, struct msg_msg *msg)
+{
+	if (info->msg_pool_max) {
+		reset_msg(msg);
+
+		spin_lock(&info->lock);
+		if (info->msg_pool_len < info->msg_pool_max) {
+			list_add(&msg->m_list, &info->msg_pool);
+			info->msg_pool_len++;
+			msg = NULL;
+		}
+		spin_unlock(&info->lock);
+		if (!msg)
+			return;
+	}
+
+	free_msg(msg);
+}
+
+static struct msg_msg *mq_load_msg(struct mqueue_inode_info *info,
+				   const void __user *src, size_t len)
+{
+	struct msg_msg *msg;
+	int err;
+
+	if (!info->msg_pool_max)
+		return load_msg(src, len);
+
+	spin_lock(&info->lock);
+	msg = list_first_entry_or_null(&info->msg_pool, struct msg_msg,
+				       m_list);
+	if (msg) {
+		list_del(&msg->m_list);
+		info->msg_pool_len--;
+	}
+	spin_unlock(&info->lock);
+
+	/* Pooled buffers have to fit any message of the queue */
+	if (!msg) {
+		msg = alloc_msg(info->attr.mq_msgsize);
+		if (!msg)
+			return ERR_PTR(-ENOMEM);
+	}
+
+	err = load_msg_into(msg, src, len);
+	if (err) {
+		mq_free_msg(info, msg);
+		return ERR_PTR(err);
+	}
+
+	return msg;
+}
+
 static struct inode *mqueue_get_inode(struct super_block *sb,
 		struct ipc_namespace *ipc_ns, umode_t mode,
 		struct mq_attr *attr)
@@ -325,6 +406,9 @@ static struct inode *mqueue_get_inode(struct super_block *sb,
 		info->msg_tree = RB_ROOT;
 		info->msg_tree_rightmost = NULL;
 		info->node_cache = NULL;
+		INIT_LIST_HEAD(&info->msg_pool);
+		info->msg_pool_len = 0;
+		info->msg_pool_max = 0;
 		memset(&info->attr, 0, sizeof(info->attr));
 		info->attr.mq_maxmsg = min(ipc_ns->mq_msg_max,
 					   ipc_ns->mq_msg_default);
@@ -384,6 +468,10 @@ static struct inode *mqueue_get_inode(struct super_block *sb,
 
 		/* all is ok */
 		info->user = get_uid(u);
+
+		if (info->attr.mq_msgsize <= MQ_POOL_MSGSIZE_MAX)
+			mq_pool_fill(info, min_t(long, info->attr.mq_maxmsg,
+						 MQ_POOL_MAX));
 	} else if (S_ISDIR(mode)) {
 		inc_nlink(inode);
 		/* Some things misbehave if size == 0 on a directory */
@@ -512,6 +600,8 @@ static void mqueue_evict_inode(struct inode *inode)
 	spin_lock(&info->lock);
 	while ((msg = msg_get(info)) != NULL)
 		list_add_tail(&msg->m_list, &tmp_msg);
+	list_splice_init(&info->msg_pool, &tmp_msg);
+	info->msg_pool_len = 0;
 	kfree(info->node_cache);
 	spin_unlock(&info->lock);
 
@@ -1095,7 +1185,7 @@ static int do_mq_timedsend(mqd_t mqdes, const char __user *u_msg_ptr,
 
 	/* First try to allocate memory, before doing anything with
 	 * existing queues. */
-	msg_ptr = load_msg(u_msg_ptr, msg_len);
+	msg_ptr = mq_load_msg(info, u_msg_ptr, msg_len);
 	if (IS_ERR(msg_ptr)) {
 		ret = PTR_ERR(msg_ptr);
 		goto out_fput;
@@ -1157,7 +1247,7 @@ static int do_mq_timedsend(mqd_t mqdes, const char __user *u_msg_ptr,
 	wake_up_q(&wake_q);
 out_free:
 	if (ret)
-		free_msg(msg_ptr);
+		mq_free_msg(info, msg_ptr);
 out_fput:
 	fdput(f);
 out:
@@ -1260,7 +1350,7 @@ static int do_mq_timedreceive(mqd_t mqdes, char __user *u_msg_ptr,
 			store_msg(u_msg_ptr, msg_ptr, msg_ptr->m_ts)) {
 			ret = -EFAULT;
 		}
-		free_msg(msg_ptr);
+		mq_free_msg(info, msg_ptr);
 	}
 out_fput:
 	fdput(f);
@@ -43,7 +43,7 @@ struct msg_msgseg {
 #define DATALEN_SEG	((size_t)PAGE_SIZE-sizeof(struct msg_msgseg))
 
 
-static struct msg_msg *alloc_msg(size_t len)
+struct msg_msg *alloc_msg(size_t len)
 {
 	struct msg_msg *msg;
 	struct msg_msgseg **pseg;
@@ -81,38 +81,46 @@ static struct msg_msg *alloc_msg(size_t len)
 	return NULL;
 }
 
-struct msg_msg *load_msg(const void __user *src, size_t len)
+/*
+ * Load len bytes into a message from alloc_msg() of at least that size.
+ * On failure the message is left for the caller to free or reuse.
+ */
+int load_msg_into(struct msg_msg *msg, const void __user *src, size_t len)
 {
-	struct msg_msg *msg;
 	struct msg_msgseg *seg;
-	int err = -EFAULT;
 	size_t alen;
 
-	msg = alloc_msg(len);
-	if (msg == NULL)
-		return ERR_PTR(-ENOMEM);
-
 	alen = min(len, DATALEN_MSG);
 	if (copy_from_user(msg + 1, src, alen))
-		goto out_err;
+		return -EFAULT;
 
 	for (seg = msg->next; seg != NULL; seg = seg->next) {
 		len -= alen;
 		src = (char __user *)src + alen;
 		alen = min(len, DATALEN_SEG);
 		if (copy_from_user(seg + 1, src, alen))
-			goto out_err;
+			return -EFAULT;
 	}
 
-	err = security_msg_msg_alloc(msg);
-	if (err)
-		goto out_err;
+	return security_msg_msg_alloc(msg);
+}
 
-	return msg;
+struct msg_msg *load_msg(const void __user *src, size_t len)
+{
+	struct msg_msg *msg;
+	int err;
 
-out_err:
-	free_msg(msg);
-	return ERR_PTR(err);
+	msg = alloc_msg(len);
+	if (msg == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	err = load_msg_into(msg, src, len);
+	if (err) {
+		free_msg(msg);
+		return ERR_PTR(err);
+	}
+
+	return msg;
 }
 #ifdef CONFIG_CHECKPOINT_RESTORE
 struct msg_msg *copy_msg(struct msg_msg *src, struct msg_msg *dst)
@@ -166,6 +174,12 @@ int store_msg(void __user *dest, struct msg_msg *msg, size_t len)
 	return 0;
 }
 
+/* Drop what the message was loaded with, keeping its buffers for reuse */
+void reset_msg(struct msg_msg *msg)
+{
+	security_msg_msg_free(msg);
+}
+
 void free_msg(struct msg_msg *msg)
 {
 	struct msg_msgseg *seg;
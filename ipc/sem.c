@@ -108,6 +108,10 @@ struct sem {
 	struct list_head pending_const; /* pending single-sop operations */
 					/* that do not alter the semaphore*/
 	time64_t	 sem_otime;	/* candidate for sem_otime */
+	/* single-sop semops, by lock taken, and those that had to sleep */
+	unsigned long	fast_ops;
+	unsigned long	slow_ops;
+	unsigned long	sleeps;
 } ____cacheline_aligned_in_smp;
 
 /* One sem_array data structure for each set of semaphores in the system. */
@@ -267,7 +271,7 @@ void __init sem_init(void)
 {
 	sem_init_ns(&init_ipc_ns);
 	ipc_init_proc_interface("sysvipc/sem",
-				"       key      semid perms      nsems   uid   gid  cuid  cgid      otime      ctime\n",
+				"       key      semid perms      nsems   uid   gid  cuid  cgid      otime      ctime    fastops    slowops     sleeps\n",
 				IPC_SEM_IDS, sysvipc_sem_proc_show);
 }
 
@@ -2082,6 +2086,15 @@ static long do_semtimedop(int semid, struct sembuf __user *tsops,
 
 	error = -EIDRM;
 	locknum = sem_lock(sma, sops, nsops);
+	if (nsops == 1) {
+		int idx = array_index_nospec(sops->sem_num, sma->sem_nsems);
+
+		/* Serialized by either lock, see complexmode_enter() */
+		if (locknum == SEM_GLOBAL_LOCK)
+			sma->sems[idx].slow_ops++;
+		else
+			sma->sems[idx].fast_ops++;
+	}
 	/*
 	 * We eventually might perform the following check in a lockless
 	 * fashion, considering ipc_valid_object() locking constraints.
@@ -2139,6 +2152,7 @@ static long do_semtimedop(int semid, struct sembuf __user *tsops,
 		struct sem *curr;
 		int idx = array_index_nospec(sops->sem_num, sma->sem_nsems);
 		curr = &sma->sems[idx];
+		curr->sleeps++;
 
 		if (alter) {
 			if (sma->complex_count) {
@@ -2431,7 +2445,9 @@ static int sysvipc_sem_proc_show(struct seq_file *s, void *it)
 	struct user_namespace *user_ns = seq_user_ns(s);
 	struct kern_ipc_perm *ipcp = it;
 	struct sem_array *sma = container_of(ipcp, struct sem_array, sem_perm);
+	unsigned long fast_ops = 0, slow_ops = 0, sleeps = 0;
 	time64_t sem_otime;
+	int i;
 
 	/*
 	 * The proc interface isn't aware of sem_lock(), it calls
@@ -2443,8 +2459,14 @@ static int sysvipc_sem_proc_show(struct seq_file *s, void *it)
 
 	sem_otime = get_semotime(sma);
 
+	for (i = 0; i < sma->sem_nsems; i++) {
+		fast_ops += sma->sems[i].fast_ops;
+		slow_ops += sma->sems[i].slow_ops;
+		sleeps += sma->sems[i].sleeps;
+	}
+
 	seq_printf(s,
-		   "%10d %10d  %4o %10u %5u %5u %5u %5u %10llu %10llu\n",
+		   "%10d %10d  %4o %10u %5u %5u %5u %5u %10llu %10llu %10lu %10lu %10lu\n",
 		   sma->sem_perm.key,
 		   sma->sem_perm.id,
 		   sma->sem_perm.mode,
@@ -2454,7 +2476,8 @@ static int sysvipc_sem_proc_show(struct seq_file *s, void *it)
 		   from_kuid_munged(user_ns, sma->sem_perm.cuid),
 		   from_kgid_munged(user_ns, sma->sem_perm.cgid),
 		   sem_otime,
-		   sma->sem_ctime);
+		   sma->sem_ctime,
+		   fast_ops, slow_ops, sleeps);
 
 	complexmode_tryleave(sma);
 
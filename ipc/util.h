@@ -193,7 +193,11 @@ static inline void ipc_update_pid(struct pid **pos, struct pid *pid)
 int ipc_parse_version(int *cmd);
 #endif
 
+extern struct msg_msg *alloc_msg(size_t len);
+extern void reset_msg(struct msg_msg *msg);
 extern void free_msg(struct msg_msg *msg);
+extern int load_msg_into(struct msg_msg *msg, const void __user *src,
+			 size_t len);
 extern struct msg_msg *load_msg(const void __user *src, size_t len);
 extern struct msg_msg *copy_msg(struct msg_msg *src, struct msg_msg *dst);
 extern int store_msg(void __user *dest, struct msg_msg *msg, size_t len);
@@ -3667,6 +3667,37 @@ static ssize_t cgroup_freeze_write(struct kernfs_open_file *of,
 	return nbytes;
 }
 
+static int cgroup_thaw_prefetch_show(struct seq_file *seq, void *v)
+{
+	struct cgroup *cgrp = seq_css(seq)->cgroup;
+
+	seq_printf(seq, "%llu\n", cgrp->freezer.thaw_prefetch);
+
+	return 0;
+}
+
+static ssize_t cgroup_thaw_prefetch_write(struct kernfs_open_file *of,
+					  char *buf, size_t nbytes, loff_t off)
+{
+	struct cgroup *cgrp;
+	ssize_t ret;
+	u64 bytes;
+
+	ret = kstrtou64(strstrip(buf), 0, &bytes);
+	if (ret)
+		return ret;
+
+	cgrp = cgroup_kn_lock_live(of->kn, false);
+	if (!cgrp)
+		return -ENOENT;
+
+	cgrp->freezer.thaw_prefetch = round_down(bytes, PAGE_SIZE);
+
+	cgroup_kn_unlock(of->kn);
+
+	return nbytes;
+}
+
 static int cgroup_file_open(struct kernfs_open_file *of)
 {
 	struct cftype *cft = of_cft(of);
@@ -4859,6 +4890,12 @@ static struct cftype cgroup_base_files[] = {
 		.seq_show = cgroup_freeze_show,
 		.write = cgroup_freeze_write,
 	},
+	{
+		.name = "cgroup.thaw_prefetch",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.seq_show = cgroup_thaw_prefetch_show,
+		.write = cgroup_thaw_prefetch_write,
+	},
 	{
 		.name = "cpu.stat",
 		.seq_show = cpu_stat_show,
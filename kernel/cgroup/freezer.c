@@ -1,8 +1,14 @@
 //SPDX-License-Identifier: GPL-2.0
 #include <linux/cgroup.h>
+#include <linux/kthread.h>
+#include <linux/mm.h>
+#include <linux/mman.h>
 #include <linux/sched.h>
+#include <linux/sched/mm.h>
 #include <linux/sched/task.h>
 #include <linux/sched/signal.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
 
 #include "cgroup-internal.h"
 
@@ -171,6 +177,84 @@ static void cgroup_freeze_task(struct task_struct *task, bool freeze)
 	unlock_task_sighand(task, &flags);
 }
 
+/* Maximum number of VMAs prefetched per process on thaw */
+#define THAW_PREFETCH_VMAS	16
+
+struct cgroup_thaw_prefetch {
+	struct work_struct work;
+	struct mm_struct *mm;
+	u64 budget;
+};
+
+/*
+ * Swap in anonymous memory of a thawed process, lowest addresses first, up
+ * to the cgroup's cgroup.thaw_prefetch bytes.  This runs from a workqueue
+ * so that reading back (and decompressing, for zram) the pages doesn't
+ * delay the thaw itself.  File backed memory is left to the regular
+ * readahead.
+ */
+static void cgroup_thaw_prefetch_workfn(struct work_struct *work)
+{
+	struct cgroup_thaw_prefetch *tp =
+		container_of(work, struct cgroup_thaw_prefetch, work);
+	struct {
+		unsigned long start;
+		size_t len;
+	} ranges[THAW_PREFETCH_VMAS];
+	struct mm_struct *mm = tp->mm;
+	struct vm_area_struct *vma;
+	u64 budget = tp->budget;
+	unsigned int i, nr = 0;
+
+	mmap_read_lock(mm);
+	for (vma = mm->mmap; vma && budget && nr < THAW_PREFETCH_VMAS;
+	     vma = vma->vm_next) {
+		if (!vma_is_anonymous(vma))
+			continue;
+
+		ranges[nr].start = vma->vm_start;
+		ranges[nr].len = min_t(u64, vma->vm_end - vma->vm_start,
+				       budget);
+		budget -= ranges[nr].len;
+		nr++;
+	}
+	mmap_read_unlock(mm);
+
+	/*
+	 * The task runs again and may have remapped the ranges with files by
+	 * now. MADV_WILLNEED on a file mapping works on current->mm, so
+	 * borrow the mm for the duration.
+	 */
+	kthread_use_mm(mm);
+	for (i = 0; i < nr; i++)
+		do_madvise(mm, ranges[i].start, ranges[i].len, MADV_WILLNEED);
+	kthread_unuse_mm(mm);
+
+	mmput(mm);
+	kfree(tp);
+}
+
+static void cgroup_thaw_prefetch(struct task_struct *task, u64 budget)
+{
+	struct cgroup_thaw_prefetch *tp;
+	struct mm_struct *mm;
+
+	mm = get_task_mm(task);
+	if (!mm)
+		return;
+
+	tp = kmalloc(sizeof(*tp), GFP_KERNEL);
+	if (!tp) {
+		mmput(mm);
+		return;
+	}
+
+	INIT_WORK(&tp->work, cgroup_thaw_prefetch_workfn);
+	tp->mm = mm;
+	tp->budget = budget;
+	queue_work(system_unbound_wq, &tp->work);
+}
+
 /*
  * Freeze or unfreeze all tasks in the given cgroup.
  */
@@ -202,6 +286,10 @@ static void cgroup_do_freeze(struct cgroup *cgrp, bool freeze)
 		if (task->flags & PF_KTHREAD)
 			continue;
 		cgroup_freeze_task(task, freeze);
+
+		if (!freeze && cgrp->freezer.thaw_prefetch &&
+		    thread_group_leader(task))
+			cgroup_thaw_prefetch(task, cgrp->freezer.thaw_prefetch);
 	}
 	css_task_iter_end(&it);
 
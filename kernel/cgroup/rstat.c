@@ -2,12 +2,28 @@
 #include "cgroup-internal.h"
 
 #include <linux/sched/cputime.h>
+#include <linux/workqueue.h>
 
 static DEFINE_SPINLOCK(cgroup_rstat_lock);
 static DEFINE_PER_CPU(raw_spinlock_t, cgroup_rstat_cpu_lock);
 
 static void cgroup_base_stat_flush(struct cgroup *cgrp, int cpu);
 
+/*
+ * The whole default hierarchy is flushed every cgroup_rstat_flush_ms from
+ * a deferrable work item, and readers of cpu.stat use the flushed values
+ * as they are unless the last periodic flush is more than two periods old.
+ * This keeps frequent readers from walking the tree themselves at the cost
+ * of the stats lagging by up to two periods.  0 disables periodic flushing
+ * and every read flushes synchronously.
+ */
+static unsigned int cgroup_rstat_flush_ms = 2000;
+static unsigned long cgroup_rstat_last_flush;	/* jiffies, under rstat_lock */
+
+static void cgroup_rstat_flush_workfn(struct work_struct *work);
+static DECLARE_DEFERRABLE_WORK(cgroup_rstat_flush_work,
+			       cgroup_rstat_flush_workfn);
+
 static struct cgroup_rstat_cpu *cgroup_rstat_cpu(struct cgroup *cgrp, int cpu)
 {
 	return per_cpu_ptr(cgrp->rstat_cpu, cpu);
@@ -245,6 +261,34 @@ void cgroup_rstat_flush_release(void)
 	spin_unlock_irq(&cgroup_rstat_lock);
 }
 
+static void cgroup_rstat_flush_workfn(struct work_struct *work)
+{
+	spin_lock_irq(&cgroup_rstat_lock);
+	cgroup_rstat_flush_locked(&cgrp_dfl_root.cgrp, true);
+	cgroup_rstat_last_flush = jiffies;
+	spin_unlock_irq(&cgroup_rstat_lock);
+
+	queue_delayed_work(system_unbound_wq, &cgroup_rstat_flush_work,
+			   msecs_to_jiffies(cgroup_rstat_flush_ms));
+}
+
+/*
+ * Like cgroup_rstat_flush_hold() but skip the flush if the periodic flush
+ * has recently covered @cgrp.  Paired with cgroup_rstat_flush_release().
+ */
+static void cgroup_rstat_flush_hold_recent(struct cgroup *cgrp)
+	__acquires(&cgroup_rstat_lock)
+{
+	unsigned long max_age = 2 * msecs_to_jiffies(cgroup_rstat_flush_ms);
+
+	might_sleep();
+	spin_lock_irq(&cgroup_rstat_lock);
+	if (!cgroup_rstat_flush_ms || !cgroup_on_dfl(cgrp) ||
+	    !time_in_range(jiffies, cgroup_rstat_last_flush,
+			   cgroup_rstat_last_flush + max_age))
+		cgroup_rstat_flush_locked(cgrp, true);
+}
+
 int cgroup_rstat_init(struct cgroup *cgrp)
 {
 	int cpu;
@@ -294,6 +338,21 @@ void __init cgroup_rstat_boot(void)
 		raw_spin_lock_init(per_cpu_ptr(&cgroup_rstat_cpu_lock, cpu));
 }
 
+static int __init cgroup_rstat_flush_ms_setup(char *str)
+{
+	return !kstrtouint(str, 0, &cgroup_rstat_flush_ms);
+}
+__setup("cgroup_rstat_flush_ms=", cgroup_rstat_flush_ms_setup);
+
+static int __init cgroup_rstat_flush_work_init(void)
+{
+	if (cgroup_rstat_flush_ms)
+		queue_delayed_work(system_unbound_wq, &cgroup_rstat_flush_work,
+				   msecs_to_jiffies(cgroup_rstat_flush_ms));
+	return 0;
+}
+late_initcall(cgroup_rstat_flush_work_init);
+
 /*
  * Functions for cgroup basic resource statistics implemented on top of
  * rstat.
@@ -442,7 +501,7 @@ void cgroup_base_stat_cputime_show(struct seq_file *seq)
 	struct task_cputime cputime;
 
 	if (cgroup_parent(cgrp)) {
-		cgroup_rstat_flush_hold(cgrp);
+		cgroup_rstat_flush_hold_recent(cgrp);
 		usage = cgrp->bstat.cputime.sum_exec_runtime;
 		cputime_adjust(&cgrp->bstat.cputime, &cgrp->prev_cputime,
 			       &utime, &stime);
@@ -48,8 +48,12 @@
 #include <linux/memblock.h>
 #include <linux/err.h>
 #include <linux/sizes.h>
+#include <linux/debugfs.h>
 #include <linux/dma-map-ops.h>
 #include <linux/cma.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/seq_file.h>
 
 #ifdef CONFIG_CMA_SIZE_MBYTES
 #define CMA_SIZE_MBYTES CONFIG_CMA_SIZE_MBYTES
@@ -242,6 +246,62 @@ int __init dma_contiguous_reserve_area(phys_addr_t size, phys_addr_t base,
 	return 0;
 }
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * cma_alloc() has to migrate the movable pages out of the range it hands
+ * out, so it takes anything from a few microseconds on an idle area to
+ * hundreds of milliseconds under memory pressure.  cma_latency[i] counts the
+ * DMA API allocations that took less than 2^i us but at least half of that,
+ * the last slot also the slower ones.
+ */
+#define CMA_LATENCY_BUCKETS	21
+
+static atomic_long_t cma_latency[CMA_LATENCY_BUCKETS];
+static atomic_long_t cma_failures;
+
+static ktime_t dma_contiguous_start(void)
+{
+	return ktime_get();
+}
+
+static void dma_contiguous_account(ktime_t start, struct page *page)
+{
+	u64 usecs = ktime_us_delta(ktime_get(), start);
+	unsigned int bucket = usecs ? ilog2(usecs) + 1 : 0;
+
+	atomic_long_inc(&cma_latency[min(bucket, CMA_LATENCY_BUCKETS - 1)]);
+	if (!page)
+		atomic_long_inc(&cma_failures);
+}
+
+static int cma_latency_show(struct seq_file *s, void *unused)
+{
+	unsigned int i;
+
+	seq_printf(s, "%12s %10s\n", "< usecs", "count");
+	for (i = 0; i < CMA_LATENCY_BUCKETS - 1; i++)
+		seq_printf(s, "%12lu %10ld\n", i ? 1UL << i : 1UL,
+			   atomic_long_read(&cma_latency[i]));
+	seq_printf(s, "%11lu+ %10ld\n", 1UL << (CMA_LATENCY_BUCKETS - 2),
+		   atomic_long_read(&cma_latency[i]));
+	seq_printf(s, "failures %ld\n", atomic_long_read(&cma_failures));
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(cma_latency);
+
+static int __init dma_contiguous_debugfs_init(void)
+{
+	debugfs_create_file("dma_cma_latency", 0400, NULL, NULL,
+			    &cma_latency_fops);
+	return 0;
+}
+late_initcall(dma_contiguous_debugfs_init);
+#else
+static inline ktime_t dma_contiguous_start(void) { return 0; }
+static inline void dma_contiguous_account(ktime_t start, struct page *page) {}
+#endif /* CONFIG_DEBUG_FS */
+
 /**
  * dma_alloc_from_contiguous() - allocate pages from contiguous area
  * @dev:   Pointer to device for which the allocation is performed.
@@ -257,10 +317,16 @@ int __init dma_contiguous_reserve_area(phys_addr_t size, phys_addr_t base,
 struct page *dma_alloc_from_contiguous(struct device *dev, size_t count,
 				       unsigned int align, bool no_warn)
 {
+	ktime_t start = dma_contiguous_start();
+	struct page *page;
+
 	if (align > CONFIG_CMA_ALIGNMENT)
 		align = CONFIG_CMA_ALIGNMENT;
 
-	return cma_alloc(dev_get_cma_area(dev), count, align, no_warn);
+	page = cma_alloc(dev_get_cma_area(dev), count, align, no_warn);
+	dma_contiguous_account(start, page);
+
+	return page;
 }
 
 /**
@@ -282,8 +348,13 @@ bool dma_release_from_contiguous(struct device *dev, struct page *pages,
 static struct page *cma_alloc_aligned(struct cma *cma, size_t size, gfp_t gfp)
 {
 	unsigned int align = min(get_order(size), CONFIG_CMA_ALIGNMENT);
+	ktime_t start = dma_contiguous_start();
+	struct page *page;
+
+	page = cma_alloc(cma, size >> PAGE_SHIFT, align, gfp & __GFP_NOWARN);
+	dma_contiguous_account(start, page);
 
-	return cma_alloc(cma, size >> PAGE_SHIFT, align, gfp & __GFP_NOWARN);
+	return page;
 }
 
 /**
@@ -15,6 +15,7 @@
 #include <linux/module.h>
 #include <linux/pci.h>
 #include <linux/platform_device.h>
+#include <linux/scatterlist.h>
 #include <linux/slab.h>
 #include <linux/timekeeping.h>
 
@@ -27,6 +28,11 @@
 #define DMA_MAP_TO_DEVICE	1
 #define DMA_MAP_FROM_DEVICE	2
 
+#define DMA_MAP_CACHE_DEFAULT	0 /* dirty, except for FROM_DEVICE */
+#define DMA_MAP_CACHE_DIRTY	1
+#define DMA_MAP_CACHE_CLEAN	2
+#define DMA_MAP_CACHE_MAX	DMA_MAP_CACHE_CLEAN
+
 struct map_benchmark {
 	__u64 avg_map_100ns; /* average map latency in 100ns */
 	__u64 map_stddev; /* standard deviation of map latency */
@@ -39,7 +45,13 @@ struct map_benchmark {
 	__u32 dma_dir; /* DMA data direction */
 	__u32 dma_trans_ns; /* time for DMA transmission in ns */
 	__u32 granule;	/* how many PAGE_SIZE will do map/unmap once a time */
-	__u8 expansion[76];	/* For future use */
+	__u32 skip_unmap_sync; /* unmap with DMA_ATTR_SKIP_CPU_SYNC */
+	__u64 avg_sync_100ns; /* average sync for cpu + device latency */
+	__u64 sync_stddev;
+	__u32 sync; /* sync for cpu then device before unmapping */
+	__u32 cache_state; /* state of the buffer in the CPU caches at map */
+	__u32 sg_nents; /* map a scatterlist of that many entries, if not 0 */
+	__u8 expansion[44];	/* For future use */
 };
 
 struct map_benchmark_data {
@@ -47,13 +59,99 @@ struct map_benchmark_data {
 	struct device *dev;
 	struct dentry  *debugfs;
 	enum dma_data_direction dir;
+	unsigned long unmap_attrs;
 	atomic64_t sum_map_100ns;
 	atomic64_t sum_unmap_100ns;
 	atomic64_t sum_sq_map;
 	atomic64_t sum_sq_unmap;
+	atomic64_t sum_sync_100ns;
+	atomic64_t sum_sq_sync;
 	atomic64_t loops;
 };
 
+static void map_benchmark_touch(struct map_benchmark_data *map, void *buf,
+				u64 size)
+{
+	volatile u8 *p = buf;
+	u64 i;
+
+	switch (map->bparam.cache_state) {
+	case DMA_MAP_CACHE_DEFAULT:
+		if (map->dir == DMA_FROM_DEVICE)
+			break;
+		fallthrough;
+	case DMA_MAP_CACHE_DIRTY:
+		memset(buf, 0x66, size);
+		break;
+	case DMA_MAP_CACHE_CLEAN:
+		/* Bring the lines in the cache, without dirtying them */
+		for (i = 0; i < size; i += L1_CACHE_BYTES)
+			(void)p[i];
+		break;
+	}
+}
+
+static int map_benchmark_map(struct map_benchmark_data *map, void *buf,
+			     u64 size, struct sg_table *sgt,
+			     dma_addr_t *dma_addr)
+{
+	if (sgt) {
+		if (!dma_map_sg(map->dev, sgt->sgl, sgt->orig_nents, map->dir))
+			return -ENOMEM;
+		return 0;
+	}
+
+	*dma_addr = dma_map_single(map->dev, buf, size, map->dir);
+	if (unlikely(dma_mapping_error(map->dev, *dma_addr)))
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void map_benchmark_sync(struct map_benchmark_data *map, u64 size,
+			       struct sg_table *sgt, dma_addr_t dma_addr)
+{
+	if (sgt) {
+		dma_sync_sg_for_cpu(map->dev, sgt->sgl, sgt->orig_nents,
+				    map->dir);
+		dma_sync_sg_for_device(map->dev, sgt->sgl, sgt->orig_nents,
+				       map->dir);
+	} else {
+		dma_sync_single_for_cpu(map->dev, dma_addr, size, map->dir);
+		dma_sync_single_for_device(map->dev, dma_addr, size, map->dir);
+	}
+}
+
+static void map_benchmark_unmap(struct map_benchmark_data *map, u64 size,
+				struct sg_table *sgt, dma_addr_t dma_addr)
+{
+	if (sgt)
+		dma_unmap_sg_attrs(map->dev, sgt->sgl, sgt->orig_nents,
+				   map->dir, map->unmap_attrs);
+	else
+		dma_unmap_single_attrs(map->dev, dma_addr, size, map->dir,
+				       map->unmap_attrs);
+}
+
+/* Split the buffer in sg_nents entries of the same size */
+static int map_benchmark_init_sgt(struct map_benchmark_data *map, void *buf,
+				  u64 size, struct sg_table *sgt)
+{
+	unsigned int nents = map->bparam.sg_nents;
+	unsigned int len = size / nents;
+	struct scatterlist *sg;
+	int i, ret;
+
+	ret = sg_alloc_table(sgt, nents, GFP_KERNEL);
+	if (ret)
+		return ret;
+
+	for_each_sg(sgt->sgl, sg, nents, i)
+		sg_set_buf(sg, buf + i * len, len);
+
+	return 0;
+}
+
 static int map_benchmark_thread(void *data)
 {
 	void *buf;
@@ -61,12 +159,20 @@ static int map_benchmark_thread(void *data)
 	struct map_benchmark_data *map = data;
 	int npages = map->bparam.granule;
 	u64 size = npages * PAGE_SIZE;
+	struct sg_table sg_table, *sgt = NULL;
 	int ret = 0;
 
 	buf = alloc_pages_exact(size, GFP_KERNEL);
 	if (!buf)
 		return -ENOMEM;
 
+	if (map->bparam.sg_nents) {
+		ret = map_benchmark_init_sgt(map, buf, size, &sg_table);
+		if (ret)
+			goto out;
+		sgt = &sg_table;
+	}
+
 	while (!kthread_should_stop())  {
 		u64 map_100ns, unmap_100ns, map_sq, unmap_sq;
 		ktime_t map_stime, map_etime, unmap_stime, unmap_etime;
@@ -78,15 +184,13 @@ static int map_benchmark_thread(void *data)
 		 * overhead of BIDIRECTIONAL or TO_DEVICE mappings;
 		 * 66 means evertything goes well! 66 is lucky.
 		 */
-		if (map->dir != DMA_FROM_DEVICE)
-			memset(buf, 0x66, size);
+		map_benchmark_touch(map, buf, size);
 
 		map_stime = ktime_get();
-		dma_addr = dma_map_single(map->dev, buf, size, map->dir);
-		if (unlikely(dma_mapping_error(map->dev, dma_addr))) {
-			pr_err("dma_map_single failed on %s\n",
+		ret = map_benchmark_map(map, buf, size, sgt, &dma_addr);
+		if (ret) {
+			pr_err("dma_map_%s failed on %s\n", sgt ? "sg" : "single",
 				dev_name(map->dev));
-			ret = -ENOMEM;
 			goto out;
 		}
 		map_etime = ktime_get();
@@ -95,8 +199,27 @@ static int map_benchmark_thread(void *data)
 		/* Pretend DMA is transmitting */
 		ndelay(map->bparam.dma_trans_ns);
 
+		if (map->bparam.sync) {
+			ktime_t sync_stime, sync_delta;
+			u64 sync_100ns;
+
+			/*
+			 * Reusing a mapping: the CPU looks at the buffer, then
+			 * hands it back to the device.
+			 */
+			sync_stime = ktime_get();
+			map_benchmark_sync(map, size, sgt, dma_addr);
+			sync_delta = ktime_sub(ktime_get(), sync_stime);
+
+			sync_100ns = div64_ul(sync_delta, 100);
+			atomic64_add(sync_100ns, &map->sum_sync_100ns);
+			atomic64_add(sync_100ns * sync_100ns, &map->sum_sq_sync);
+
+			ndelay(map->bparam.dma_trans_ns);
+		}
+
 		unmap_stime = ktime_get();
-		dma_unmap_single(map->dev, dma_addr, size, map->dir);
+		map_benchmark_unmap(map, size, sgt, dma_addr);
 		unmap_etime = ktime_get();
 		unmap_delta = ktime_sub(unmap_etime, unmap_stime);
 
@@ -115,6 +238,8 @@ static int map_benchmark_thread(void *data)
 	}
 
 out:
+	if (sgt)
+		sg_free_table(sgt);
 	free_pages_exact(buf, size);
 	return ret;
 }
@@ -153,6 +278,8 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 	atomic64_set(&map->sum_unmap_100ns, 0);
 	atomic64_set(&map->sum_sq_map, 0);
 	atomic64_set(&map->sum_sq_unmap, 0);
+	atomic64_set(&map->sum_sync_100ns, 0);
+	atomic64_set(&map->sum_sq_sync, 0);
 	atomic64_set(&map->loops, 0);
 
 	for (i = 0; i < threads; i++) {
@@ -190,6 +317,18 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 				map->bparam.avg_unmap_100ns;
 		map->bparam.map_stddev = int_sqrt64(map_variance);
 		map->bparam.unmap_stddev = int_sqrt64(unmap_variance);
+
+		if (map->bparam.sync) {
+			u64 sum_sync = atomic64_read(&map->sum_sync_100ns);
+			u64 sum_sq_sync = atomic64_read(&map->sum_sq_sync);
+			u64 sync_variance;
+
+			map->bparam.avg_sync_100ns = div64_u64(sum_sync, loops);
+			sync_variance = div64_u64(sum_sq_sync, loops) -
+					map->bparam.avg_sync_100ns *
+					map->bparam.avg_sync_100ns;
+			map->bparam.sync_stddev = int_sqrt64(sync_variance);
+		}
 	}
 
 out:
@@ -241,6 +380,19 @@ static long map_benchmark_ioctl(struct file *file, unsigned int cmd,
 			return -EINVAL;
 		}
 
+		if (map->bparam.cache_state > DMA_MAP_CACHE_MAX) {
+			pr_err("invalid cache state\n");
+			return -EINVAL;
+		}
+
+		if (map->bparam.sg_nents &&
+		    (map->bparam.sg_nents > map->bparam.granule * PAGE_SIZE /
+					    L1_CACHE_BYTES ||
+		     (map->bparam.granule * PAGE_SIZE) % map->bparam.sg_nents)) {
+			pr_err("invalid number of scatterlist entries\n");
+			return -EINVAL;
+		}
+
 		switch (map->bparam.dma_dir) {
 		case DMA_MAP_BIDIRECTIONAL:
 			map->dir = DMA_BIDIRECTIONAL;
@@ -256,6 +408,13 @@ static long map_benchmark_ioctl(struct file *file, unsigned int cmd,
 			return -EINVAL;
 		}
 
+		/*
+		 * Skipping the sync on unmap measures the cost of the post-DMA
+		 * cache invalidation of the CPUs that need one.
+		 */
+		map->unmap_attrs = map->bparam.skip_unmap_sync ?
+				   DMA_ATTR_SKIP_CPU_SYNC : 0;
+
 		old_dma_mask = dma_get_mask(map->dev);
 
 		ret = dma_set_mask(map->dev,
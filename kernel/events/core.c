@@ -3570,6 +3570,49 @@ static void perf_event_switch(struct task_struct *task,
 #define for_each_task_context_nr(ctxn)					\
 	for ((ctxn) = 0; (ctxn) < perf_nr_task_contexts; (ctxn)++)
 
+/*
+ * Wakeups of wakeup_idle events are held back until their cpu is about to
+ * idle, so that a reader draining the buffer doesn't compete with the busy
+ * tasks. perf_idle_wakeups counts the events of the cpu holding one back.
+ */
+static DEFINE_PER_CPU(int, perf_idle_wakeups);
+
+void perf_event_defer_wakeup(struct perf_event *event)
+{
+	if (!xchg(&event->pending_idle_wakeup, 1))
+		this_cpu_inc(perf_idle_wakeups);
+}
+
+static void perf_idle_wakeup_flush(void)
+{
+	struct perf_cpu_context *cpuctx;
+	struct perf_event *event;
+	struct pmu *pmu;
+	int idx;
+
+	if (!__this_cpu_read(perf_idle_wakeups))
+		return;
+	this_cpu_write(perf_idle_wakeups, 0);
+
+	idx = srcu_read_lock(&pmus_srcu);
+	list_for_each_entry_rcu(pmu, &pmus, entry, lockdep_is_held(&pmus_srcu)) {
+		cpuctx = this_cpu_ptr(pmu->pmu_cpu_context);
+		/* Contexts shared by several pmus are only walked once. */
+		if (cpuctx->ctx.pmu != pmu)
+			continue;
+
+		raw_spin_lock(&cpuctx->ctx.lock);
+		list_for_each_entry(event, &cpuctx->ctx.event_list, event_entry) {
+			if (xchg(&event->pending_idle_wakeup, 0)) {
+				event->pending_wakeup = 1;
+				irq_work_queue(&event->pending);
+			}
+		}
+		raw_spin_unlock(&cpuctx->ctx.lock);
+	}
+	srcu_read_unlock(&pmus_srcu, idx);
+}
+
 /*
  * Called from scheduler to remove the events of the current task,
  * with interrupts disabled.
@@ -3602,6 +3645,9 @@ void __perf_event_task_sched_out(struct task_struct *task,
 	 */
 	if (atomic_read(this_cpu_ptr(&perf_cgroup_events)))
 		perf_cgroup_sched_out(task, next);
+
+	if (is_idle_task(next))
+		perf_idle_wakeup_flush();
 }
 
 /*
@@ -4797,6 +4843,8 @@ static void unaccount_event(struct perf_event *event)
 		dec = true;
 		atomic_dec(&nr_switch_events);
 	}
+	if (event->attr.wakeup_idle)
+		dec = true;
 	if (is_cgroup_event(event))
 		dec = true;
 	if (has_branch_stack(event))
@@ -11357,6 +11405,8 @@ static void account_event(struct perf_event *event)
 		atomic_inc(&nr_switch_events);
 		inc = true;
 	}
+	if (event->attr.wakeup_idle)
+		inc = true;
 	if (has_branch_stack(event))
 		inc = true;
 	if (is_cgroup_event(event))
@@ -11426,6 +11476,10 @@ perf_event_alloc(struct perf_event_attr *attr, int cpu,
 		/* Requires a task: avoid signalling random tasks. */
 		return ERR_PTR(-EINVAL);
 	}
+	if (attr->wakeup_idle && task) {
+		/* Deferred wakeups are flushed per cpu: cpu events only. */
+		return ERR_PTR(-EINVAL);
+	}
 
 	node = (cpu >= 0) ? cpu_to_node(cpu) : -1;
 	event = kmem_cache_alloc_node(perf_event_cache, GFP_KERNEL | __GFP_ZERO,
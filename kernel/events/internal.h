@@ -79,6 +79,7 @@ static inline void rb_toggle_paused(struct perf_buffer *rb, bool pause)
 extern struct perf_buffer *
 rb_alloc(int nr_pages, long watermark, int cpu, int flags);
 extern void perf_event_wakeup(struct perf_event *event);
+extern void perf_event_defer_wakeup(struct perf_event *event);
 extern int rb_alloc_aux(struct perf_buffer *rb, struct perf_event *event,
 			pgoff_t pgoff, int nr_pages, long watermark, int flags);
 extern void rb_free_aux(struct perf_buffer *rb);
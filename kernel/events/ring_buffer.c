@@ -17,12 +17,35 @@
 
 #include "internal.h"
 
+/*
+ * Past three quarters full, holding the wakeup back until the cpu idles
+ * risks losing records.
+ */
+static bool perf_output_nearly_full(struct perf_buffer *rb)
+{
+	unsigned long size = perf_data_size(rb);
+	unsigned long used;
+
+	if (rb->overwrite)
+		return false;
+
+	used = local_read(&rb->head) - READ_ONCE(rb->user_page->data_tail);
+	return used > size - size / 4;
+}
+
 static void perf_output_wakeup(struct perf_output_handle *handle)
 {
+	struct perf_event *event = handle->event;
+
 	atomic_set(&handle->rb->poll, EPOLLIN);
 
-	handle->event->pending_wakeup = 1;
-	irq_work_queue(&handle->event->pending);
+	if (event->attr.wakeup_idle && !perf_output_nearly_full(handle->rb)) {
+		perf_event_defer_wakeup(event);
+		return;
+	}
+
+	event->pending_wakeup = 1;
+	irq_work_queue(&event->pending);
 }
 
 /*
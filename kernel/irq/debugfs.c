@@ -1,9 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0
 // Copyright 2017 Thomas Gleixner <tglx@linutronix.de>
 
+#include <linux/interrupt.h>
 #include <linux/irqdomain.h>
 #include <linux/irq.h>
+#include <linux/log2.h>
+#include <linux/sched.h>
+#include <linux/sched/clock.h>
 #include <linux/uaccess.h>
+#include <uapi/linux/sched/types.h>
 
 #include "internals.h"
 
@@ -155,6 +160,74 @@ static const struct irq_bit_descr irqdesc_istates[] = {
 };
 
 
+void irq_thread_latency_account(struct irq_desc *desc,
+				struct irqaction *action)
+{
+	u64 usecs = div_u64(local_clock() - READ_ONCE(action->wake_time),
+			    NSEC_PER_USEC);
+	unsigned int bucket = usecs ? ilog2(usecs) + 1 : 0;
+
+	bucket = min(bucket, IRQ_THREAD_LATENCY_BUCKETS - 1);
+	WRITE_ONCE(desc->thread_latency[bucket],
+		   desc->thread_latency[bucket] + 1);
+}
+
+static void irq_debug_show_threads(struct seq_file *m, struct irq_desc *desc)
+{
+	struct irqaction *action;
+	int i;
+
+	for_each_action_of_desc(desc, action) {
+		if (action->thread)
+			seq_printf(m, "thread:   %s prio %d\n", action->thread->comm,
+				   action->thread->rt_priority);
+	}
+
+	seq_puts(m, "latency:  ");
+	for (i = 0; i < IRQ_THREAD_LATENCY_BUCKETS; i++)
+		seq_printf(m, " %lu", READ_ONCE(desc->thread_latency[i]));
+	seq_puts(m, "\n");
+}
+
+/* Change the SCHED_FIFO priority of the threads of the interrupt */
+static int irq_debug_set_priority(struct irq_desc *desc, const char *buf)
+{
+	struct sched_param param;
+	struct irqaction *action;
+	bool updated = false;
+	int ret = 0;
+
+	if (kstrtoint(buf, 0, &param.sched_priority) ||
+	    param.sched_priority < 1 ||
+	    param.sched_priority >= MAX_RT_PRIO)
+		return -EINVAL;
+
+	mutex_lock(&desc->request_mutex);
+	for_each_action_of_desc(desc, action) {
+		if (action->thread) {
+			ret = sched_setscheduler_nocheck(action->thread,
+							 SCHED_FIFO, &param);
+			if (ret)
+				break;
+			updated = true;
+		}
+		if (action->secondary && action->secondary->thread) {
+			ret = sched_setscheduler_nocheck(action->secondary->thread,
+							 SCHED_FIFO, &param);
+			if (ret)
+				break;
+			updated = true;
+		}
+	}
+	mutex_unlock(&desc->request_mutex);
+
+	if (ret)
+		return ret;
+
+	/* Thread-less actions are skipped, fail only if there is no thread at all */
+	return updated ? 0 : -EINVAL;
+}
+
 static int irq_debug_show(struct seq_file *m, void *p)
 {
 	struct irq_desc *desc = m->private;
@@ -179,6 +252,10 @@ static int irq_debug_show(struct seq_file *m, void *p)
 	irq_debug_show_masks(m, desc);
 	irq_debug_show_data(m, data, 0);
 	raw_spin_unlock_irq(&desc->lock);
+
+	mutex_lock(&desc->request_mutex);
+	irq_debug_show_threads(m, desc);
+	mutex_unlock(&desc->request_mutex);
 	return 0;
 }
 
@@ -191,7 +268,7 @@ static ssize_t irq_debug_write(struct file *file, const char __user *user_buf,
 			       size_t count, loff_t *ppos)
 {
 	struct irq_desc *desc = file_inode(file)->i_private;
-	char buf[8] = { 0, };
+	char buf[16] = { 0, };
 	size_t size;
 
 	size = min(sizeof(buf) - 1, count);
@@ -204,6 +281,12 @@ static ssize_t irq_debug_write(struct file *file, const char __user *user_buf,
 		return err ? err : count;
 	}
 
+	if (!strncmp(buf, "priority ", 9)) {
+		int err = irq_debug_set_priority(desc, strim(buf + 9));
+
+		return err ? err : count;
+	}
+
 	return count;
 }
 
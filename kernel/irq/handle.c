@@ -73,6 +73,8 @@ void __irq_wake_thread(struct irq_desc *desc, struct irqaction *action)
 	if (test_and_set_bit(IRQTF_RUNTHREAD, &action->thread_flags))
 		return;
 
+	irq_thread_wake_stamp(action);
+
 	/*
 	 * It's safe to OR the mask lockless here. We have only two
 	 * places which write to threads_oneshot: This code and the
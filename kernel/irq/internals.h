@@ -492,6 +492,12 @@ static inline void irq_remove_debugfs_entry(struct irq_desc *desc)
 	kfree(desc->dev_name);
 }
 void irq_debugfs_copy_devname(int irq, struct device *dev);
+static inline void irq_thread_wake_stamp(struct irqaction *action)
+{
+	action->wake_time = local_clock();
+}
+void irq_thread_latency_account(struct irq_desc *desc,
+				struct irqaction *action);
 # ifdef CONFIG_IRQ_DOMAIN
 void irq_domain_debugfs_init(struct dentry *root);
 # else
@@ -509,4 +515,11 @@ static inline void irq_remove_debugfs_entry(struct irq_desc *d)
 static inline void irq_debugfs_copy_devname(int irq, struct device *dev)
 {
 }
+static inline void irq_thread_wake_stamp(struct irqaction *action)
+{
+}
+static inline void irq_thread_latency_account(struct irq_desc *desc,
+					      struct irqaction *action)
+{
+}
 #endif /* CONFIG_GENERIC_IRQ_DEBUGFS */
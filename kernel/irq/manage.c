@@ -1243,6 +1243,7 @@ static int irq_thread(void *data)
 	while (!irq_wait_for_interrupt(action)) {
 		irqreturn_t action_ret;
 
+		irq_thread_latency_account(desc, action);
 		irq_thread_check_affinity(desc, action);
 
 		action_ret = handler_fn(desc, action);
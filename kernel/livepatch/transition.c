@@ -20,6 +20,14 @@
 
 #define SIGNALS_TIMEOUT 15
 
+/*
+ * Without reliable stacktraces a task can only switch on its way out of the
+ * kernel, so there is no point in waiting before kicking it there.  Signal
+ * the stragglers right away and retry often.
+ */
+#define SIGNALS_TIMEOUT_UNRELIABLE 1
+#define RETRY_DELAY_UNRELIABLE_MS 100
+
 struct klp_patch *klp_transition_patch;
 
 static int klp_target_state = KLP_UNDEFINED;
@@ -337,6 +345,20 @@ static bool klp_try_switch_task(struct task_struct *task)
 	return success;
 }
 
+static unsigned int klp_signals_timeout(void)
+{
+	return klp_have_reliable_stack() ? SIGNALS_TIMEOUT :
+					   SIGNALS_TIMEOUT_UNRELIABLE;
+}
+
+static unsigned long klp_retry_delay(void)
+{
+	if (!klp_have_reliable_stack())
+		return msecs_to_jiffies(RETRY_DELAY_UNRELIABLE_MS);
+
+	return round_jiffies_relative(HZ);
+}
+
 /*
  * Sends a fake signal to all non-kthread tasks with TIF_PATCH_PENDING set.
  * Kthreads with TIF_PATCH_PENDING set are woken up.
@@ -345,7 +367,7 @@ static void klp_send_signals(void)
 {
 	struct task_struct *g, *task;
 
-	if (klp_signals_cnt == SIGNALS_TIMEOUT)
+	if (klp_signals_cnt == klp_signals_timeout())
 		pr_notice("signaling remaining tasks\n");
 
 	read_lock(&tasklist_lock);
@@ -426,7 +448,8 @@ void klp_try_complete_transition(void)
 	put_online_cpus();
 
 	if (!complete) {
-		if (klp_signals_cnt && !(klp_signals_cnt % SIGNALS_TIMEOUT))
+		if (klp_signals_cnt &&
+		    !(klp_signals_cnt % klp_signals_timeout()))
 			klp_send_signals();
 		klp_signals_cnt++;
 
@@ -435,8 +458,7 @@ void klp_try_complete_transition(void)
 		 * later and/or wait for other methods like kernel exit
 		 * switching.
 		 */
-		schedule_delayed_work(&klp_transition_work,
-				      round_jiffies_relative(HZ));
+		schedule_delayed_work(&klp_transition_work, klp_retry_delay());
 		return;
 	}
 
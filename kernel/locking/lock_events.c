@@ -53,7 +53,7 @@ static const char * const lockevent_names[lockevent_num + 1] = {
 /*
  * Per-cpu counts
  */
-DEFINE_PER_CPU(unsigned long, lockevents[lockevent_num]);
+DEFINE_PER_CPU(u64, lockevents[lockevent_num]);
 
 /*
  * The lockevent_read() function can be overridden.
@@ -98,7 +98,7 @@ static ssize_t lockevent_write(struct file *file, const char __user *user_buf,
 
 	for_each_possible_cpu(cpu) {
 		int i;
-		unsigned long *ptr = per_cpu_ptr(lockevents, cpu);
+		u64 *ptr = per_cpu_ptr(lockevents, cpu);
 
 		for (i = 0 ; i < lockevent_num; i++)
 			WRITE_ONCE(ptr[i], 0);
@@ -26,9 +26,10 @@ enum lock_events {
 
 #ifdef CONFIG_LOCK_EVENT_COUNTS
 /*
- * Per-cpu counters
+ * Per-cpu counters, 64-bit so that the events accumulating a duration in ns
+ * don't wrap on 32-bit systems.
  */
-DECLARE_PER_CPU(unsigned long, lockevents[lockevent_num]);
+DECLARE_PER_CPU(u64, lockevents[lockevent_num]);
 
 /*
  * Increment the statistical counters. use raw_cpu_inc() because of lower
@@ -43,18 +44,22 @@ static inline void __lockevent_inc(enum lock_events event, bool cond)
 #define lockevent_inc(ev)	  __lockevent_inc(LOCKEVENT_ ##ev, true)
 #define lockevent_cond_inc(ev, c) __lockevent_inc(LOCKEVENT_ ##ev, c)
 
-static inline void __lockevent_add(enum lock_events event, int inc)
+static inline void __lockevent_add(enum lock_events event, u64 inc)
 {
 	raw_cpu_add(lockevents[event], inc);
 }
 
 #define lockevent_add(ev, c)	__lockevent_add(LOCKEVENT_ ##ev, c)
 
+/* Timestamp for the events accumulating a duration in ns */
+#define lockevent_clock()	local_clock()
+
 #else  /* CONFIG_LOCK_EVENT_COUNTS */
 
 #define lockevent_inc(ev)
 #define lockevent_add(ev, c)
 #define lockevent_cond_inc(ev, c)
+#define lockevent_clock()	0
 
 #endif /* CONFIG_LOCK_EVENT_COUNTS */
 #endif /* __LOCKING_LOCK_EVENTS_H */
@@ -49,6 +49,17 @@ LOCK_EVENT(lock_use_node4)	/* # of locking ops that use 4th percpu node */
 LOCK_EVENT(lock_no_node)	/* # of locking ops w/o using percpu node    */
 #endif /* CONFIG_QUEUED_SPINLOCKS */
 
+/*
+ * Locking events for mutex
+ */
+LOCK_EVENT(mutex_opt_lock)	/* # of opt-acquired locks		*/
+LOCK_EVENT(mutex_opt_fail)	/* # of failed optspins			*/
+LOCK_EVENT(mutex_opt_nospin)	/* # of disabled optspins		*/
+LOCK_EVENT(mutex_spin_ns)	/* Total time (ns) spent optspinning	*/
+LOCK_EVENT(mutex_sleep)		/* # of sleeps in the slowpath		*/
+LOCK_EVENT(mutex_sleep_ns)	/* Total time (ns) spent sleeping	*/
+LOCK_EVENT(mutex_handoff)	/* # of lock handoffs at unlock		*/
+
 /*
  * Locking events for rwsem
  */
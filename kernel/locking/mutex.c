@@ -29,6 +29,7 @@
 #include <linux/interrupt.h>
 #include <linux/debug_locks.h>
 #include <linux/osq_lock.h>
+#include <linux/sched/clock.h>
 
 #ifdef CONFIG_DEBUG_MUTEXES
 # include "mutex-debug.h"
@@ -36,6 +37,11 @@
 # include "mutex.h"
 #endif
 
+#include "lock_events.h"
+
+#define CREATE_TRACE_POINTS
+#include <trace/events/lock.h>
+
 void
 __mutex_init(struct mutex *lock, const char *name, struct lock_class_key *key)
 {
@@ -638,6 +644,8 @@ static __always_inline bool
 mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 		      struct mutex_waiter *waiter)
 {
+	u64 __maybe_unused start = lockevent_clock();
+
 	if (!waiter) {
 		/*
 		 * The purpose of the mutex_can_spin_on_owner() function is
@@ -647,7 +655,7 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 		 * to call mutex_can_spin_on_owner().
 		 */
 		if (!mutex_can_spin_on_owner(lock))
-			goto fail;
+			goto nospin;
 
 		/*
 		 * In order to avoid a stampede of mutex spinners trying to
@@ -655,7 +663,7 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 		 * MCS (queued) lock first before spinning on the owner field.
 		 */
 		if (!osq_lock(&lock->osq))
-			goto fail;
+			goto nospin;
 	}
 
 	for (;;) {
@@ -685,6 +693,8 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 	if (!waiter)
 		osq_unlock(&lock->osq);
 
+	lockevent_inc(mutex_opt_lock);
+	lockevent_add(mutex_spin_ns, lockevent_clock() - start);
 	return true;
 
 
@@ -692,6 +702,13 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 	if (!waiter)
 		osq_unlock(&lock->osq);
 
+	lockevent_inc(mutex_opt_fail);
+	lockevent_add(mutex_spin_ns, lockevent_clock() - start);
+	goto fail;
+
+nospin:
+	lockevent_inc(mutex_opt_nospin);
+
 fail:
 	/*
 	 * If we fell out of the spin path because of need_resched(),
@@ -928,6 +945,7 @@ __mutex_lock_common(struct mutex *lock, long state, unsigned int subclass,
 		    struct ww_acquire_ctx *ww_ctx, const bool use_ww_ctx)
 {
 	struct mutex_waiter waiter;
+	u64 __maybe_unused sleep_start;
 	bool first = false;
 	struct ww_mutex *ww;
 	int ret;
@@ -968,6 +986,7 @@ __mutex_lock_common(struct mutex *lock, long state, unsigned int subclass,
 		return 0;
 	}
 
+	trace_contention_begin(lock, LCB_F_MUTEX);
 	spin_lock(&lock->wait_lock);
 	/*
 	 * After waiting to acquire the wait_lock, try again.
@@ -1033,7 +1052,10 @@ __mutex_lock_common(struct mutex *lock, long state, unsigned int subclass,
 		}
 
 		spin_unlock(&lock->wait_lock);
+		sleep_start = lockevent_clock();
 		schedule_preempt_disabled();
+		lockevent_inc(mutex_sleep);
+		lockevent_add(mutex_sleep_ns, lockevent_clock() - sleep_start);
 
 		/*
 		 * ww_mutex needs to always recheck its position since its waiter
@@ -1078,6 +1100,7 @@ __mutex_lock_common(struct mutex *lock, long state, unsigned int subclass,
 skip_wait:
 	/* got the lock - cleanup and rejoice! */
 	lock_acquired(&lock->dep_map, ip);
+	trace_contention_end(lock, 0);
 
 	if (ww_ctx)
 		ww_mutex_lock_acquired(ww, ww_ctx);
@@ -1093,6 +1116,7 @@ __mutex_lock_common(struct mutex *lock, long state, unsigned int subclass,
 	spin_unlock(&lock->wait_lock);
 	debug_mutex_free_waiter(&waiter);
 	mutex_release(&lock->dep_map, ip);
+	trace_contention_end(lock, ret);
 	preempt_enable();
 	return ret;
 }
@@ -1273,8 +1297,10 @@ static noinline void __sched __mutex_unlock_slowpath(struct mutex *lock, unsigne
 		wake_q_add(&wake_q, next);
 	}
 
-	if (owner & MUTEX_FLAG_HANDOFF)
+	if (owner & MUTEX_FLAG_HANDOFF) {
 		__mutex_handoff(lock, next);
+		lockevent_inc(mutex_handoff);
+	}
 
 	spin_unlock(&lock->wait_lock);
 
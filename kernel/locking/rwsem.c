@@ -27,6 +27,7 @@
 #include <linux/export.h>
 #include <linux/rwsem.h>
 #include <linux/atomic.h>
+#include <trace/events/lock.h>
 
 #include "lock_events.h"
 
@@ -1210,8 +1211,12 @@ static inline int __down_read_common(struct rw_semaphore *sem, int state)
 	long count;
 
 	if (!rwsem_read_trylock(sem, &count)) {
-		if (IS_ERR(rwsem_down_read_slowpath(sem, count, state)))
+		trace_contention_begin(sem, LCB_F_READ);
+		if (IS_ERR(rwsem_down_read_slowpath(sem, count, state))) {
+			trace_contention_end(sem, -EINTR);
 			return -EINTR;
+		}
+		trace_contention_end(sem, 0);
 		DEBUG_RWSEMS_WARN_ON(!is_rwsem_reader_owned(sem), sem);
 	}
 	return 0;
@@ -1258,8 +1263,12 @@ static inline int __down_read_trylock(struct rw_semaphore *sem)
 static inline int __down_write_common(struct rw_semaphore *sem, int state)
 {
 	if (unlikely(!rwsem_write_trylock(sem))) {
-		if (IS_ERR(rwsem_down_write_slowpath(sem, state)))
+		trace_contention_begin(sem, LCB_F_WRITE);
+		if (IS_ERR(rwsem_down_write_slowpath(sem, state))) {
+			trace_contention_end(sem, -EINTR);
 			return -EINTR;
+		}
+		trace_contention_end(sem, 0);
 	}
 
 	return 0;
@@ -37,6 +37,7 @@
 
 
 static int nocompress;
+static int compress_lz4;
 static int noresume;
 static int nohibernate;
 static int resume_wait;
@@ -752,6 +753,8 @@ int hibernate(void)
 			flags |= SF_NOCOMPRESS_MODE;
 		else
 		        flags |= SF_CRC32_MODE;
+		if (!nocompress && compress_lz4)
+			flags |= SF_LZ4_MODE;
 
 		pm_pr_dbg("Writing hibernation image.\n");
 		error = swsusp_write(flags);
@@ -1245,12 +1248,34 @@ static ssize_t reserved_size_store(struct kobject *kobj,
 
 power_attr(reserved_size);
 
+static ssize_t drop_file_cache_show(struct kobject *kobj,
+				    struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%d\n", drop_file_cache);
+}
+
+static ssize_t drop_file_cache_store(struct kobject *kobj,
+				     struct kobj_attribute *attr,
+				     const char *buf, size_t n)
+{
+	bool val;
+
+	if (kstrtobool(buf, &val))
+		return -EINVAL;
+
+	drop_file_cache = val;
+	return n;
+}
+
+power_attr(drop_file_cache);
+
 static struct attribute *g[] = {
 	&disk_attr.attr,
 	&resume_offset_attr.attr,
 	&resume_attr.attr,
 	&image_size_attr.attr,
 	&reserved_size_attr.attr,
+	&drop_file_cache_attr.attr,
 	NULL,
 };
 
@@ -1296,6 +1321,8 @@ static int __init hibernate_setup(char *str)
 		noresume = 1;
 	} else if (!strncmp(str, "nocompress", 10)) {
 		nocompress = 1;
+	} else if (!strncmp(str, "lz4", 3)) {
+		compress_lz4 = 1;
 	} else if (!strncmp(str, "no", 2)) {
 		noresume = 1;
 		nohibernate = 1;
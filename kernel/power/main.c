@@ -222,6 +222,40 @@ static ssize_t sync_on_suspend_store(struct kobject *kobj,
 }
 
 power_attr(sync_on_suspend);
+
+/*
+ * freeze_on_s2idle: freeze tasks before suspend-to-idle.
+ *
+ * show() returns whether tasks are frozen before suspend-to-idle.
+ * store() accepts 0 or 1.  0 leaves the tasks running, in which case user
+ * space is expected to freeze the cgroups that could get in the way through
+ * cgroup.freeze beforehand; the rest just get no CPU time while it is idle.
+ */
+bool freeze_on_s2idle_enabled = true;
+
+static ssize_t freeze_on_s2idle_show(struct kobject *kobj,
+				     struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%d\n", freeze_on_s2idle_enabled);
+}
+
+static ssize_t freeze_on_s2idle_store(struct kobject *kobj,
+				      struct kobj_attribute *attr,
+				      const char *buf, size_t n)
+{
+	unsigned long val;
+
+	if (kstrtoul(buf, 10, &val))
+		return -EINVAL;
+
+	if (val > 1)
+		return -EINVAL;
+
+	freeze_on_s2idle_enabled = !!val;
+	return n;
+}
+
+power_attr(freeze_on_s2idle);
 #endif /* CONFIG_SUSPEND */
 
 #ifdef CONFIG_PM_SLEEP_DEBUG
@@ -895,6 +929,7 @@ static struct attribute * g[] = {
 #ifdef CONFIG_SUSPEND
 	&mem_sleep_attr.attr,
 	&sync_on_suspend_attr.attr,
+	&freeze_on_s2idle_attr.attr,
 #endif
 #ifdef CONFIG_PM_AUTOSLEEP
 	&autosleep_attr.attr,
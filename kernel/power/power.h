@@ -98,6 +98,8 @@ static struct kobj_attribute _name##_attr = {	\
 extern unsigned long image_size;
 /* Size of memory reserved for drivers (default SPARE_PAGES x PAGE_SIZE) */
 extern unsigned long reserved_size;
+/* Reclaim clean page cache instead of saving it in the image */
+extern bool drop_file_cache;
 extern int in_suspend;
 extern dev_t swsusp_resume_device;
 extern sector_t swsusp_resume_block;
@@ -168,6 +170,7 @@ extern int swsusp_swap_in_use(void);
 #define SF_PLATFORM_MODE	1
 #define SF_NOCOMPRESS_MODE	2
 #define SF_CRC32_MODE	        4
+#define SF_LZ4_MODE		8
 
 /* kernel/power/hibernate.c */
 extern int swsusp_check(void);
@@ -190,6 +193,9 @@ extern const char *pm_states[];
 extern const char *mem_sleep_states[];
 
 extern int suspend_devices_and_enter(suspend_state_t state);
+
+/* kernel/power/main.c */
+extern bool freeze_on_s2idle_enabled;
 #else /* !CONFIG_SUSPEND */
 #define mem_sleep_current	PM_SUSPEND_ON
 
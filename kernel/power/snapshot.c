@@ -139,6 +139,13 @@ void __init hibernate_image_size_init(void)
 	image_size = ((totalram_pages() * 2) / 5) * PAGE_SIZE;
 }
 
+/*
+ * If set, clean page cache pages are not saved in the image, but reclaimed
+ * before it is created (tunable via /sys/power/drop_file_cache).  They will
+ * be read back from their backing store on demand after resume.
+ */
+bool drop_file_cache;
+
 /*
  * List of PBEs needed for restoring the pages that were allocated before
  * the suspend and included in the suspend image, but have also been
@@ -1714,6 +1721,24 @@ static unsigned long minimum_image_size(unsigned long saveable)
 	return saveable <= size ? 0 : saveable - size;
 }
 
+/**
+ * clean_file_pages - Estimate the number of clean page cache pages.
+ *
+ * These can be reclaimed without any I/O, so they are the first to go when
+ * drop_file_cache is set.
+ */
+static unsigned long clean_file_pages(void)
+{
+	unsigned long file, dirty;
+
+	file = global_node_page_state(NR_ACTIVE_FILE)
+		+ global_node_page_state(NR_INACTIVE_FILE);
+	dirty = global_node_page_state(NR_FILE_DIRTY)
+		+ global_node_page_state(NR_WRITEBACK);
+
+	return file > dirty ? file - dirty : 0;
+}
+
 /**
  * hibernate_preallocate_memory - Preallocate memory for hibernation image.
  *
@@ -1735,6 +1760,9 @@ static unsigned long minimum_image_size(unsigned long saveable)
  * the preallocation of memory is continued until the total number of saveable
  * pages in the system is below the requested image size or the minimum
  * acceptable image size returned by minimum_image_size(), whichever is greater.
+ *
+ * If drop_file_cache is set, the image size is additionally capped so that
+ * the clean page cache pages are reclaimed rather than saved.
  */
 int hibernate_preallocate_memory(void)
 {
@@ -1792,6 +1820,12 @@ int hibernate_preallocate_memory(void)
 	size = DIV_ROUND_UP(image_size, PAGE_SIZE);
 	if (size > max_size)
 		size = max_size;
+	if (drop_file_cache) {
+		unsigned long clean = clean_file_pages();
+
+		if (size > saveable - min(clean, saveable))
+			size = saveable - min(clean, saveable);
+	}
 	/*
 	 * If the desired number of image pages is at least as large as the
 	 * current number of saveable pages in memory, allocate page frames for
@@ -334,6 +334,9 @@ static int suspend_test(int level)
 	return 0;
 }
 
+/* Whether suspend_prepare() froze the tasks, and suspend_finish() thaws them */
+static bool suspend_tasks_frozen;
+
 /**
  * suspend_prepare - Prepare for entering system sleep state.
  * @state: Target system sleep state.
@@ -355,6 +358,13 @@ static int suspend_prepare(suspend_state_t state)
 	if (error)
 		goto Restore;
 
+	if (state == PM_SUSPEND_TO_IDLE && !freeze_on_s2idle_enabled) {
+		pm_pr_dbg("Not freezing tasks for suspend-to-idle\n");
+		suspend_tasks_frozen = false;
+		return 0;
+	}
+
+	suspend_tasks_frozen = true;
 	trace_suspend_resume(TPS("freeze_processes"), 0, true);
 	error = suspend_freeze_processes();
 	trace_suspend_resume(TPS("freeze_processes"), 0, false);
@@ -531,7 +541,8 @@ int suspend_devices_and_enter(suspend_state_t state)
  */
 static void suspend_finish(void)
 {
-	suspend_thaw_processes();
+	if (suspend_tasks_frozen)
+		suspend_thaw_processes();
 	pm_notifier_call_chain(PM_POST_SUSPEND);
 	pm_restore_console();
 }
@@ -24,6 +24,7 @@
 #include <linux/swapops.h>
 #include <linux/pm.h>
 #include <linux/slab.h>
+#include <linux/lz4.h>
 #include <linux/lzo.h>
 #include <linux/vmalloc.h>
 #include <linux/cpumask.h>
@@ -523,6 +524,10 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 			             LZO_HEADER, PAGE_SIZE)
 #define LZO_CMP_SIZE	(LZO_CMP_PAGES * PAGE_SIZE)
 
+/* Workspace for the compressor, LZO or LZ4 */
+#define CMP_WRK_SIZE	(LZO1X_1_MEM_COMPRESS > LZ4_MEM_COMPRESS ? \
+			 LZO1X_1_MEM_COMPRESS : LZ4_MEM_COMPRESS)
+
 /* Maximum number of threads for compression/decompression. */
 #define LZO_THREADS	3
 
@@ -622,20 +627,21 @@ static int crc32_threadfn(void *data)
 	return 0;
 }
 /**
- * Structure used for LZO data compression.
+ * Structure used for LZO/LZ4 data compression.
  */
 struct cmp_data {
 	struct task_struct *thr;                  /* thread */
 	atomic_t ready;                           /* ready to start flag */
 	atomic_t stop;                            /* ready to stop flag */
 	int ret;                                  /* return code */
+	bool lz4;                                 /* LZ4 instead of LZO */
 	wait_queue_head_t go;                     /* start compression */
 	wait_queue_head_t done;                   /* compression done */
 	size_t unc_len;                           /* uncompressed length */
 	size_t cmp_len;                           /* compressed length */
 	unsigned char unc[LZO_UNC_SIZE];          /* uncompressed buffer */
 	unsigned char cmp[LZO_CMP_SIZE];          /* compressed buffer */
-	unsigned char wrk[LZO1X_1_MEM_COMPRESS];  /* compression workspace */
+	unsigned char wrk[CMP_WRK_SIZE];          /* compression workspace */
 };
 
 /**
@@ -657,9 +663,20 @@ static int lzo_compress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->ret = lzo1x_1_compress(d->unc, d->unc_len,
-		                          d->cmp + LZO_HEADER, &d->cmp_len,
-		                          d->wrk);
+		if (d->lz4) {
+			int len = LZ4_compress_default(d->unc,
+						       d->cmp + LZO_HEADER,
+						       d->unc_len,
+						       LZO_CMP_SIZE - LZO_HEADER,
+						       d->wrk);
+
+			d->cmp_len = max(len, 0);
+			d->ret = len > 0 ? 0 : -1;
+		} else {
+			d->ret = lzo1x_1_compress(d->unc, d->unc_len,
+						  d->cmp + LZO_HEADER,
+						  &d->cmp_len, d->wrk);
+		}
 		atomic_set(&d->stop, 1);
 		wake_up(&d->done);
 	}
@@ -667,14 +684,15 @@ static int lzo_compress_threadfn(void *data)
 }
 
 /**
- * save_image_lzo - Save the suspend image data compressed with LZO.
+ * save_image_lzo - Save the suspend image data compressed with LZO or LZ4.
  * @handle: Swap map handle to use for saving the image.
  * @snapshot: Image to read data from.
  * @nr_to_write: Number of pages to save.
+ * @lz4: Compress with LZ4 instead of LZO.
  */
 static int save_image_lzo(struct swap_map_handle *handle,
                           struct snapshot_handle *snapshot,
-                          unsigned int nr_to_write)
+                          unsigned int nr_to_write, bool lz4)
 {
 	unsigned int m;
 	int ret = 0;
@@ -711,8 +729,10 @@ static int save_image_lzo(struct swap_map_handle *handle,
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	for (thr = 0; thr < nr_threads; thr++)
+	for (thr = 0; thr < nr_threads; thr++) {
 		memset(&data[thr], 0, offsetof(struct cmp_data, go));
+		data[thr].lz4 = lz4;
+	}
 
 	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
 	if (!crc) {
@@ -767,7 +787,8 @@ static int save_image_lzo(struct swap_map_handle *handle,
 	 */
 	handle->reqd_free_pages = reqd_free_pages();
 
-	pr_info("Using %u thread(s) for compression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s compression\n", nr_threads,
+		lz4 ? "LZ4" : "LZO");
 	pr_info("Compressing and saving image data (%u pages)...\n",
 		nr_to_write);
 	m = nr_to_write / 10;
@@ -817,7 +838,8 @@ static int save_image_lzo(struct swap_map_handle *handle,
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO compression failed\n");
+				pr_err("%s compression failed\n",
+				       lz4 ? "LZ4" : "LZO");
 				goto out_finish;
 			}
 
@@ -942,7 +964,8 @@ int swsusp_write(unsigned int flags)
 	if (!error) {
 		error = (flags & SF_NOCOMPRESS_MODE) ?
 			save_image(&handle, &snapshot, pages - 1) :
-			save_image_lzo(&handle, &snapshot, pages - 1);
+			save_image_lzo(&handle, &snapshot, pages - 1,
+				       flags & SF_LZ4_MODE);
 	}
 out_finish:
 	error = swap_writer_finish(&handle, flags, error);
@@ -1109,13 +1132,14 @@ static int load_image(struct swap_map_handle *handle,
 }
 
 /**
- * Structure used for LZO data decompression.
+ * Structure used for LZO/LZ4 data decompression.
  */
 struct dec_data {
 	struct task_struct *thr;                  /* thread */
 	atomic_t ready;                           /* ready to start flag */
 	atomic_t stop;                            /* ready to stop flag */
 	int ret;                                  /* return code */
+	bool lz4;                                 /* LZ4 instead of LZO */
 	wait_queue_head_t go;                     /* start decompression */
 	wait_queue_head_t done;                   /* decompression done */
 	size_t unc_len;                           /* uncompressed length */
@@ -1143,9 +1167,19 @@ static int lzo_decompress_threadfn(void *data)
 		}
 		atomic_set(&d->ready, 0);
 
-		d->unc_len = LZO_UNC_SIZE;
-		d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER, d->cmp_len,
-		                               d->unc, &d->unc_len);
+		if (d->lz4) {
+			int len = LZ4_decompress_safe(d->cmp + LZO_HEADER,
+						      d->unc, d->cmp_len,
+						      LZO_UNC_SIZE);
+
+			d->unc_len = max(len, 0);
+			d->ret = len > 0 ? 0 : -1;
+		} else {
+			d->unc_len = LZO_UNC_SIZE;
+			d->ret = lzo1x_decompress_safe(d->cmp + LZO_HEADER,
+						       d->cmp_len, d->unc,
+						       &d->unc_len);
+		}
 		if (clean_pages_on_decompress)
 			flush_icache_range((unsigned long)d->unc,
 					   (unsigned long)d->unc + d->unc_len);
@@ -1157,14 +1191,16 @@ static int lzo_decompress_threadfn(void *data)
 }
 
 /**
- * load_image_lzo - Load compressed image data and decompress them with LZO.
+ * load_image_lzo - Load compressed image data and decompress them with LZO
+ * or LZ4.
  * @handle: Swap map handle to use for loading data.
  * @snapshot: Image to copy uncompressed data into.
  * @nr_to_read: Number of pages to load.
+ * @lz4: The image was compressed with LZ4 instead of LZO.
  */
 static int load_image_lzo(struct swap_map_handle *handle,
                           struct snapshot_handle *snapshot,
-                          unsigned int nr_to_read)
+                          unsigned int nr_to_read, bool lz4)
 {
 	unsigned int m;
 	int ret = 0;
@@ -1204,8 +1240,10 @@ static int load_image_lzo(struct swap_map_handle *handle,
 		ret = -ENOMEM;
 		goto out_clean;
 	}
-	for (thr = 0; thr < nr_threads; thr++)
+	for (thr = 0; thr < nr_threads; thr++) {
 		memset(&data[thr], 0, offsetof(struct dec_data, go));
+		data[thr].lz4 = lz4;
+	}
 
 	crc = kmalloc(sizeof(*crc), GFP_KERNEL);
 	if (!crc) {
@@ -1286,7 +1324,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 	}
 	want = ring_size = i;
 
-	pr_info("Using %u thread(s) for decompression\n", nr_threads);
+	pr_info("Using %u thread(s) for %s decompression\n", nr_threads,
+		lz4 ? "LZ4" : "LZO");
 	pr_info("Loading and decompressing image data (%u pages)...\n",
 		nr_to_read);
 	m = nr_to_read / 10;
@@ -1399,7 +1438,8 @@ static int load_image_lzo(struct swap_map_handle *handle,
 			ret = data[thr].ret;
 
 			if (ret < 0) {
-				pr_err("LZO decompression failed\n");
+				pr_err("%s decompression failed\n",
+				       lz4 ? "LZ4" : "LZO");
 				goto out_finish;
 			}
 
@@ -1503,7 +1543,8 @@ int swsusp_read(unsigned int *flags_p)
 	if (!error) {
 		error = (*flags_p & SF_NOCOMPRESS_MODE) ?
 			load_image(&handle, &snapshot, header->pages - 1) :
-			load_image_lzo(&handle, &snapshot, header->pages - 1);
+			load_image_lzo(&handle, &snapshot, header->pages - 1,
+				       *flags_p & SF_LZ4_MODE);
 	}
 	swap_reader_finish(&handle);
 end:
@@ -47,6 +47,7 @@
 #include <linux/sched/clock.h>
 #include <linux/sched/debug.h>
 #include <linux/sched/task_stack.h>
+#include <linux/kthread.h>
 
 #include <linux/uaccess.h>
 #include <asm/sections.h>
@@ -2133,6 +2134,75 @@ int vprintk_store(int facility, int level,
 	return (text_len + trunc_msg_len);
 }
 
+/*
+ * With printk.console_kthread, the consoles are driven from a dedicated
+ * kthread rather than from the context of printk(), which only stores the
+ * message in the ringbuffer. A slow serial console then delays the output,
+ * but no longer the code printing. The consoles are still driven directly
+ * while the kthread is not running, during an oops and at shutdown, so that
+ * the last messages are not lost.
+ */
+static bool printk_console_kthread;
+module_param_named(console_kthread, printk_console_kthread, bool, S_IRUGO);
+MODULE_PARM_DESC(console_kthread, "print to the consoles from a kthread");
+
+static struct task_struct *printk_kthread;
+
+static bool printk_offload(void)
+{
+	return READ_ONCE(printk_kthread) && !oops_in_progress &&
+	       system_state == SYSTEM_RUNNING;
+}
+
+static int printk_kthread_func(void *unused)
+{
+	/*
+	 * Not freezable: the consoles are needed during suspend and resume,
+	 * no_console_suspend being set for that.
+	 */
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		/* Nothing gets printed while suspended, see resume_console() */
+		if (READ_ONCE(console_suspended) ||
+		    !prb_read_valid(prb, READ_ONCE(console_seq), NULL))
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		if (READ_ONCE(console_suspended))
+			continue;
+
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
+static void printk_kthread_wake(void)
+{
+	struct task_struct *tsk = READ_ONCE(printk_kthread);
+
+	if (tsk)
+		wake_up_process(tsk);
+}
+
+static void printk_kthread_init(void)
+{
+	struct task_struct *tsk;
+
+	if (!printk_console_kthread)
+		return;
+
+	tsk = kthread_run(printk_kthread_func, NULL, "printk");
+	if (IS_ERR(tsk)) {
+		pr_err("failed to start the console kthread: %ld\n",
+		       PTR_ERR(tsk));
+		return;
+	}
+
+	WRITE_ONCE(printk_kthread, tsk);
+}
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const struct dev_printk_info *dev_info,
 			    const char *fmt, va_list args)
@@ -2157,8 +2227,11 @@ asmlinkage int vprintk_emit(int facility, int level,
 	printed_len = vprintk_store(facility, level, dev_info, fmt, args);
 	printk_safe_exit_irqrestore(flags);
 
-	/* If called from the scheduler, we can not call up(). */
-	if (!in_sched) {
+	if (printk_offload()) {
+		/* Woken from irq_work, as we may be called from the scheduler */
+		defer_console_output();
+	} else if (!in_sched) {
+		/* If called from the scheduler, we can not call up(). */
 		/*
 		 * Disable preemption to avoid being preempted while holding
 		 * console_sem which would prevent anyone from printing to
@@ -2251,6 +2324,8 @@ static int console_lock_spinning_disable_and_check(void) { return 0; }
 static void call_console_drivers(const char *ext_text, size_t ext_len,
 				 const char *text, size_t len) {}
 static bool suppress_message_printing(int level) { return false; }
+static void printk_kthread_init(void) { }
+static void printk_kthread_wake(void) { }
 
 #endif /* CONFIG_PRINTK */
 
@@ -2426,6 +2501,9 @@ void resume_console(void)
 	down_console_sem();
 	console_suspended = 0;
 	console_unlock();
+
+	/* Messages may have been stored after the unlock above */
+	printk_kthread_wake();
 }
 
 /**
@@ -3139,6 +3217,7 @@ static int __init printk_late_init(void)
 	ret = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN, "printk:online",
 					console_cpu_notify, NULL);
 	WARN_ON(ret < 0);
+	printk_kthread_init();
 	return 0;
 }
 late_initcall(printk_late_init);
@@ -3157,9 +3236,12 @@ static void wake_up_klogd_work_func(struct irq_work *irq_work)
 	int pending = __this_cpu_xchg(printk_pending, 0);
 
 	if (pending & PRINTK_PENDING_OUTPUT) {
-		/* If trylock fails, someone else is doing the printing */
-		if (console_trylock())
+		if (printk_offload()) {
+			wake_up_process(printk_kthread);
+		} else if (console_trylock()) {
+			/* If trylock fails, someone else is doing the printing */
 			console_unlock();
+		}
 	}
 
 	if (pending & PRINTK_PENDING_WAKEUP)
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * KUnit API to time a piece of code from a test case.
+ */
+
+#include <kunit/bench.h>
+#include <kunit/test.h>
+#include <linux/kernel.h>
+#include <linux/sched.h>
+#include <linux/sched/clock.h>
+#include <linux/sort.h>
+#include <linux/timex.h>
+
+static int kunit_bench_cmp(const void *a, const void *b)
+{
+	u64 x = *(const u64 *)a, y = *(const u64 *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static u64 kunit_bench_now(bool cycles)
+{
+	return cycles ? (u64)get_cycles() : local_clock();
+}
+
+/* Nearest rank percentile of n sorted samples. */
+static u64 kunit_bench_percentile(const u64 *samples, unsigned int n,
+				  unsigned int pct)
+{
+	return samples[DIV_ROUND_UP(n * pct, 100) - 1];
+}
+
+int kunit_bench_run(struct kunit *test, const struct kunit_bench *bench,
+		    void (*fn)(struct kunit *test, void *data), void *data,
+		    struct kunit_bench_result *result)
+{
+	unsigned int runs = bench->runs;
+	bool cycles = bench->cycles;
+	struct kunit_bench_result res;
+	u64 *samples, start;
+	unsigned int i;
+
+	if (!runs || runs > KUNIT_BENCH_MAX_RUNS)
+		return -EINVAL;
+
+	samples = kunit_kmalloc(test, runs * sizeof(*samples), GFP_KERNEL);
+	if (!samples)
+		return -ENOMEM;
+
+	/* get_cycles() returns 0 where there's no cycle counter. */
+	if (cycles && !get_cycles()) {
+		kunit_info(test, "%s: no cycle counter, timing in ns\n",
+			   bench->name);
+		cycles = false;
+	}
+
+	for (i = 0; i < bench->warmup; i++) {
+		fn(test, data);
+		cond_resched();
+	}
+
+	for (i = 0; i < runs; i++) {
+		start = kunit_bench_now(cycles);
+		fn(test, data);
+		samples[i] = kunit_bench_now(cycles) - start;
+		cond_resched();
+	}
+
+	sort(samples, runs, sizeof(*samples), kunit_bench_cmp, NULL);
+
+	res.min = samples[0];
+	res.median = kunit_bench_percentile(samples, runs, 50);
+	res.p90 = kunit_bench_percentile(samples, runs, 90);
+	res.p99 = kunit_bench_percentile(samples, runs, 99);
+	res.max = samples[runs - 1];
+	kunit_kfree(test, samples);
+
+	kunit_info(test,
+		   "%s: %u runs (%s): min %llu median %llu p90 %llu p99 %llu max %llu\n",
+		   bench->name, runs, cycles ? "cycles" : "ns", res.min,
+		   res.median, res.p90, res.p99, res.max);
+
+	if (bench->max_median)
+		KUNIT_EXPECT_LE_MSG(test, res.median, bench->max_median,
+				    "%s: median run over the limit",
+				    bench->name);
+	if (bench->max_p99)
+		KUNIT_EXPECT_LE_MSG(test, res.p99, bench->max_p99,
+				    "%s: 99th percentile run over the limit",
+				    bench->name);
+
+	if (result)
+		*result = res;
+	return 0;
+}
+EXPORT_SYMBOL_GPL(kunit_bench_run);
@@ -6,7 +6,9 @@
  * Author: Brendan Higgins <brendanhiggins@google.com>
  */
 
+#include <kunit/bench.h>
 #include <kunit/test.h>
+#include <linux/sort.h>
 
 /*
  * This is the most fundamental element of KUnit, the test case. A test case
@@ -29,6 +31,41 @@ static void example_simple_test(struct kunit *test)
 	KUNIT_EXPECT_EQ(test, 1 + 1, 2);
 }
 
+static int example_cmp(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+static void example_bench_fn(struct kunit *test, void *data)
+{
+	int vals[64];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(vals); i++)
+		vals[i] = ARRAY_SIZE(vals) - i;
+
+	sort(vals, ARRAY_SIZE(vals), sizeof(vals[0]), example_cmp, NULL);
+}
+
+/*
+ * A test case can also time a piece of code: kunit_bench_run() calls it
+ * repeatedly and logs how long the runs took. Setting .max_median or
+ * .max_p99 turns the benchmark into a regression test, which fails when
+ * the code gets slower than the limit.
+ */
+static void example_bench_test(struct kunit *test)
+{
+	static const struct kunit_bench bench = {
+		.name = "sort 64 ints",
+		.warmup = 10,
+		.runs = 100,
+	};
+
+	KUNIT_EXPECT_EQ(test, 0, kunit_bench_run(test, &bench,
+						 example_bench_fn, NULL,
+						 NULL));
+}
+
 /*
  * This is run once before each test case, see the comment on
  * example_test_suite for more information.
@@ -52,6 +89,7 @@ static struct kunit_case example_test_cases[] = {
 	 * test suite.
 	 */
 	KUNIT_CASE(example_simple_test),
+	KUNIT_CASE(example_bench_test),
 	{}
 };
 
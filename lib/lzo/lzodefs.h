@@ -29,6 +29,16 @@
 		COPY4(dst, src); COPY4((dst) + 4, (src) + 4)
 #endif
 
+/*
+ * The fast paths of the decompressor copy 4 or 8 bytes at a time with
+ * unaligned accesses. Besides the architectures doing those in hardware,
+ * use them on MIPS, where get_unaligned() is a cheap lwl/lwr pair.
+ */
+#if defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS) || \
+	(defined(CONFIG_MIPS) && !defined(CONFIG_CPU_NO_LOAD_STORE_LR))
+#define LZO_FAST_UNALIGNED_ACCESS
+#endif
+
 #if defined(__BIG_ENDIAN) && defined(__LITTLE_ENDIAN)
 #error "conflicting endian definitions"
 #elif defined(CONFIG_X86_64) || defined(CONFIG_ARM64)
@@ -57,34 +57,41 @@
 	}
 
 	/* form the syndromes; i.e., evaluate data(x) at roots of
-	 * g(x) */
-	for (i = 0; i < nroots; i++)
-		syn[i] = (((uint16_t) data[0]) ^ invmsk) & msk;
+	 * g(x)
+	 *
+	 * One root at a time, so the syndrome stays in a register
+	 * while the data is run through. index_of[] of a nonzero
+	 * value and the root step are both below nn, so a single
+	 * conditional subtraction replaces rs_modnn().
+	 */
+	for (i = 0; i < nroots; i++) {
+		int step = rs_modnn(rs, (fcr + i) * prim);
+		uint16_t acc = (((uint16_t) data[0]) ^ invmsk) & msk;
+		int x;
 
-	for (j = 1; j < len; j++) {
-		for (i = 0; i < nroots; i++) {
-			if (syn[i] == 0) {
-				syn[i] = (((uint16_t) data[j]) ^
-					  invmsk) & msk;
-			} else {
-				syn[i] = ((((uint16_t) data[j]) ^
-					   invmsk) & msk) ^
-					alpha_to[rs_modnn(rs, index_of[syn[i]] +
-						       (fcr + i) * prim)];
+		for (j = 1; j < len; j++) {
+			tmp = (((uint16_t) data[j]) ^ invmsk) & msk;
+			if (acc) {
+				x = index_of[acc] + step;
+				if (x >= nn)
+					x -= nn;
+				tmp ^= alpha_to[x];
 			}
+			acc = tmp;
 		}
-	}
 
-	for (j = 0; j < nroots; j++) {
-		for (i = 0; i < nroots; i++) {
-			if (syn[i] == 0) {
-				syn[i] = ((uint16_t) par[j]) & msk;
-			} else {
-				syn[i] = (((uint16_t) par[j]) & msk) ^
-					alpha_to[rs_modnn(rs, index_of[syn[i]] +
-						       (fcr+i)*prim)];
+		for (j = 0; j < nroots; j++) {
+			tmp = ((uint16_t) par[j]) & msk;
+			if (acc) {
+				x = index_of[acc] + step;
+				if (x >= nn)
+					x -= nn;
+				tmp ^= alpha_to[x];
 			}
+			acc = tmp;
 		}
+
+		syn[i] = acc;
 	}
 	s = syn;
 
@@ -498,7 +498,22 @@ static __always_inline int rc_bit(struct rc_dec *rc, uint16_t *prob)
 {
 	uint32_t bound;
 	int bit;
+#ifdef XZ_DEC_RC_BRANCHLESS
+	uint32_t mask, prob0, prob1;
 
+	rc_normalize(rc);
+	bound = (rc->range >> RC_BIT_MODEL_TOTAL_BITS) * *prob;
+
+	/* All ones if the bit is 1 */
+	mask = (uint32_t)0 - (rc->code >= bound);
+	prob0 = *prob + ((RC_BIT_MODEL_TOTAL - *prob) >> RC_MOVE_BITS);
+	prob1 = *prob - (*prob >> RC_MOVE_BITS);
+
+	rc->range = ((rc->range - bound) & mask) | (bound & ~mask);
+	rc->code -= bound & mask;
+	*prob = (prob1 & mask) | (prob0 & ~mask);
+	bit = mask & 1;
+#else
 	rc_normalize(rc);
 	bound = (rc->range >> RC_BIT_MODEL_TOTAL_BITS) * *prob;
 	if (rc->code < bound) {
@@ -511,6 +526,7 @@ static __always_inline int rc_bit(struct rc_dec *rc, uint16_t *prob)
 		*prob -= *prob >> RC_MOVE_BITS;
 		bit = 1;
 	}
+#endif
 
 	return bit;
 }
@@ -522,10 +538,7 @@ static __always_inline uint32_t rc_bittree(struct rc_dec *rc,
 	uint32_t symbol = 1;
 
 	do {
-		if (rc_bit(rc, &probs[symbol]))
-			symbol = (symbol << 1) + 1;
-		else
-			symbol <<= 1;
+		symbol = (symbol << 1) + rc_bit(rc, &probs[symbol]);
 	} while (symbol < limit);
 
 	return symbol;
@@ -538,14 +551,12 @@ static __always_inline void rc_bittree_reverse(struct rc_dec *rc,
 {
 	uint32_t symbol = 1;
 	uint32_t i = 0;
+	uint32_t bit;
 
 	do {
-		if (rc_bit(rc, &probs[symbol])) {
-			symbol = (symbol << 1) + 1;
-			*dest += 1 << i;
-		} else {
-			symbol <<= 1;
-		}
+		bit = rc_bit(rc, &probs[symbol]);
+		symbol = (symbol << 1) + bit;
+		*dest += bit << i;
 	} while (++i < limit);
 }
 
@@ -585,6 +596,7 @@ static void lzma_literal(struct xz_dec_lzma2 *s)
 	uint32_t match_byte;
 	uint32_t match_bit;
 	uint32_t offset;
+	uint32_t bit;
 	uint32_t i;
 
 	probs = lzma_literal_probs(s);
@@ -601,13 +613,10 @@ static void lzma_literal(struct xz_dec_lzma2 *s)
 			match_byte <<= 1;
 			i = offset + match_bit + symbol;
 
-			if (rc_bit(&s->rc, &probs[i])) {
-				symbol = (symbol << 1) + 1;
-				offset &= match_bit;
-			} else {
-				symbol <<= 1;
-				offset &= ~match_bit;
-			}
+			/* offset &= bit ? match_bit : ~match_bit */
+			bit = rc_bit(&s->rc, &probs[i]);
+			symbol = (symbol << 1) + bit;
+			offset &= match_bit ^ (bit - 1);
 		} while (symbol < 0x100);
 	}
 
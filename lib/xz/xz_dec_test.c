@@ -12,6 +12,9 @@
 #include <linux/fs.h>
 #include <linux/uaccess.h>
 #include <linux/crc32.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
 #include <linux/xz.h>
 
 /* Maximum supported dictionary size */
@@ -61,6 +64,13 @@ static struct xz_buf buffers = {
  */
 static uint32_t crc;
 
+/*
+ * Time spent in xz_dec_run() and amount of uncompressed data, to report
+ * the decoding throughput.
+ */
+static u64 decode_ns;
+static u64 decode_bytes;
+
 static int xz_dec_test_open(struct inode *i, struct file *f)
 {
 	if (device_is_open)
@@ -71,6 +81,8 @@ static int xz_dec_test_open(struct inode *i, struct file *f)
 	xz_dec_reset(state);
 	ret = XZ_OK;
 	crc = 0xFFFFFFFF;
+	decode_ns = 0;
+	decode_bytes = 0;
 
 	buffers.in_pos = 0;
 	buffers.in_size = 0;
@@ -103,6 +115,7 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 				 size_t size, loff_t *pos)
 {
 	size_t remaining;
+	u64 start;
 
 	if (ret != XZ_OK) {
 		if (size > 0)
@@ -130,7 +143,10 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 		}
 
 		buffers.out_pos = 0;
+		start = ktime_get_ns();
 		ret = xz_dec_run(state, &buffers);
+		decode_ns += ktime_get_ns() - start;
+		decode_bytes += buffers.out_pos;
 		crc = crc32(crc, buffer_out, buffers.out_pos);
 	}
 
@@ -142,6 +158,11 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 	case XZ_STREAM_END:
 		printk(KERN_INFO DEVICE_NAME ": XZ_STREAM_END, "
 				"CRC32 = 0x%08X\n", ~crc);
+		printk(KERN_INFO DEVICE_NAME ": decoded %llu bytes in "
+				"%llu us, %llu MiB/s\n", decode_bytes,
+				div_u64(decode_ns, NSEC_PER_USEC),
+				decode_ns ? div64_u64(decode_bytes * NSEC_PER_SEC,
+						      decode_ns * SZ_1M) : 0);
 		return size - remaining - (buffers.in_size - buffers.in_pos);
 
 	case XZ_MEMLIMIT_ERROR:
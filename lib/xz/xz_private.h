@@ -41,6 +41,13 @@
 #		define memzero(buf, size) memset(buf, 0, size)
 #	endif
 #	define get_le32(p) le32_to_cpup((const uint32_t *)(p))
+	/*
+	 * The in-order MIPS cores predict the data-dependent branches of
+	 * the range decoder poorly; decode the bits with masks instead.
+	 */
+#	ifdef CONFIG_MIPS
+#		define XZ_DEC_RC_BRANCHLESS
+#	endif
 #else
 	/*
 	 * For userspace builds, use a separate header to define the required
@@ -4,6 +4,7 @@
  */
 
 #include <linux/zutil.h>
+#include <asm/unaligned.h>
 #include "inftrees.h"
 #include "inflate.h"
 #include "inffast.h"
@@ -15,6 +16,26 @@ union uu {
 	unsigned char b[2];
 };
 
+/*
+ * On 32-bit MIPS the bit buffer is 64 bits wide and refilled 32 bits at a
+ * time, instead of a byte at a time. It has enough registers to keep the
+ * buffer in a register pair, and the refills are what the loop spends most
+ * of its time on there with an unsigned long sized buffer. 64-bit machines
+ * keep the byte-wise refills, which tools/testing/zlib_inflate measures as
+ * faster on x86_64.
+ */
+#if BITS_PER_LONG == 32 && defined(CONFIG_MIPS)
+#define INFLATE_HOLD64
+typedef u64 hold_t;
+#else
+typedef unsigned long hold_t;
+#endif
+
+/* Match copies go a word at a time, using MIPS unaligned word loads */
+#ifdef INFLATE_HOLD64
+#define INFLATE_WIDE_COPY
+#endif
+
 /* Endian independed version */
 static inline unsigned short
 get_unaligned16(const unsigned short *p)
@@ -79,7 +100,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     unsigned whave;             /* valid bytes in the window */
     unsigned write;             /* window write index */
     unsigned char *window;      /* allocated sliding window, if wsize != 0 */
-    unsigned long hold;         /* local strm->hold */
+    hold_t hold;                /* local strm->hold */
     unsigned bits;              /* local strm->bits */
     code const *lcode;          /* local strm->lencode */
     code const *dcode;          /* local strm->distcode */
@@ -116,12 +137,24 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef INFLATE_HOLD64
+        /*
+         * At least 6 bytes are left here, and refilling only below 16
+         * bits reads no further than the byte wise refills would.
+         */
+        if (bits < 16) {
+            hold += (hold_t)get_unaligned_le32(in) << bits;
+            in += 4;
+            bits += 32;
+        }
+#else
         if (bits < 15) {
-            hold += (unsigned long)(*in++) << bits;
+            hold += (hold_t)(*in++) << bits;
             bits += 8;
-            hold += (unsigned long)(*in++) << bits;
+            hold += (hold_t)(*in++) << bits;
             bits += 8;
         }
+#endif
         this = lcode[hold & lmask];
       dolen:
         op = (unsigned)(this.bits);
@@ -136,7 +169,7 @@ void inflate_fast(z_streamp strm, unsigned start)
             op &= 15;                           /* number of extra bits */
             if (op) {
                 if (bits < op) {
-                    hold += (unsigned long)(*in++) << bits;
+                    hold += (hold_t)(*in++) << bits;
                     bits += 8;
                 }
                 len += (unsigned)hold & ((1U << op) - 1);
@@ -144,9 +177,9 @@ void inflate_fast(z_streamp strm, unsigned start)
                 bits -= op;
             }
             if (bits < 15) {
-                hold += (unsigned long)(*in++) << bits;
+                hold += (hold_t)(*in++) << bits;
                 bits += 8;
-                hold += (unsigned long)(*in++) << bits;
+                hold += (hold_t)(*in++) << bits;
                 bits += 8;
             }
             this = dcode[hold & dmask];
@@ -159,10 +192,10 @@ void inflate_fast(z_streamp strm, unsigned start)
                 dist = (unsigned)(this.val);
                 op &= 15;                       /* number of extra bits */
                 if (bits < op) {
-                    hold += (unsigned long)(*in++) << bits;
+                    hold += (hold_t)(*in++) << bits;
                     bits += 8;
                     if (bits < op) {
-                        hold += (unsigned long)(*in++) << bits;
+                        hold += (hold_t)(*in++) << bits;
                         bits += 8;
                     }
                 }
@@ -253,6 +286,18 @@ void inflate_fast(z_streamp strm, unsigned start)
 
 			sfrom = (unsigned short *)(from);
 			loops = len >> 1;
+#ifdef INFLATE_WIDE_COPY
+			/* two halfwords at a time, unless they overlap */
+			if (dist >= 4) {
+			    for (; loops >= 2; loops -= 2) {
+				put_unaligned(get_unaligned((u32 *)sfrom),
+					      (u32 *)sout);
+				sout += 2;
+				sfrom += 2;
+			    }
+			}
+			if (loops)
+#endif
 			do
 #ifdef CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS
 			    *sout++ = *sfrom++;
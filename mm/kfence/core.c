@@ -10,6 +10,7 @@
 #include <linux/atomic.h>
 #include <linux/bug.h>
 #include <linux/debugfs.h>
+#include <linux/hash.h>
 #include <linux/irq_work.h>
 #include <linux/kcsan-checks.h>
 #include <linux/kfence.h>
@@ -81,6 +82,67 @@ static const struct kernel_param_ops sample_interval_param_ops = {
 };
 module_param_cb(sample_interval, &sample_interval_param_ops, &kfence_sample_interval, 0600);
 
+/*
+ * Use a deferrable timer for the sample interval, which doesn't wake up idle
+ * CPUs: there are no allocations to sample while they sleep, and on mostly
+ * idle systems the effective interval becomes longer.
+ */
+static bool kfence_deferrable __read_mostly;
+module_param_named(deferrable, kfence_deferrable, bool, 0444);
+
+/*
+ * Comma-separated names of the caches to sample allocations from, all caches
+ * if empty. The allocation gate stays open until a targeted cache allocates.
+ */
+#define KFENCE_MAX_CACHES 8
+static char kfence_caches[128] __read_mostly;
+static char kfence_cache_buf[128] __read_mostly;
+static const char *kfence_cache_names[KFENCE_MAX_CACHES] __read_mostly;
+static int kfence_nr_cache_names __read_mostly;
+
+static int param_set_caches(const char *val, const struct kernel_param *kp)
+{
+	char *p = kfence_cache_buf, *name;
+	int ret = param_set_copystring(val, kp);
+
+	if (ret < 0)
+		return ret;
+
+	/* Split the list once here, rather than on every allocation. */
+	strscpy(kfence_cache_buf, kfence_caches, sizeof(kfence_cache_buf));
+	kfence_nr_cache_names = 0;
+	while ((name = strsep(&p, ","))) {
+		if (!*name)
+			continue;
+		if (kfence_nr_cache_names == KFENCE_MAX_CACHES)
+			return -EINVAL;
+		kfence_cache_names[kfence_nr_cache_names++] = name;
+	}
+
+	return 0;
+}
+
+static struct kparam_string kfence_caches_string = {
+	.maxlen = sizeof(kfence_caches),
+	.string = kfence_caches,
+};
+
+static const struct kernel_param_ops caches_param_ops = {
+	.set = param_set_caches,
+	.get = param_get_string,
+};
+module_param_cb(caches, &caches_param_ops, &kfence_caches_string, 0444);
+
+/*
+ * Whether the allocations of a cache are sampled, looked up by cache address:
+ * each slot holds the address of the cache it was computed for, with
+ * KFENCE_CACHE_TARGETED or'ed in if the cache is targeted. The names are only
+ * compared the first time a cache allocates, or after a collision.
+ */
+#define KFENCE_CACHE_VERDICT_BITS 6
+#define KFENCE_CACHE_TARGETED 1UL
+static unsigned long kfence_cache_verdicts[1 << KFENCE_CACHE_VERDICT_BITS];
+
 /* The pool of pages used for guard pages and objects. */
 char *__kfence_pool __ro_after_init;
 EXPORT_SYMBOL(__kfence_pool); /* Export for test modules. */
@@ -514,6 +576,7 @@ static int stats_show(struct seq_file *seq, void *v)
 	int i;
 
 	seq_printf(seq, "enabled: %i\n", READ_ONCE(kfence_enabled));
+	seq_printf(seq, "caches: %s\n", *kfence_caches ? kfence_caches : "all");
 	for (i = 0; i < KFENCE_COUNTER_COUNT; i++)
 		seq_printf(seq, "%s: %ld\n", counter_names[i], atomic_long_read(&counters[i]));
 
@@ -639,7 +702,31 @@ static void toggle_allocation_gate(struct work_struct *work)
 	queue_delayed_work(system_power_efficient_wq, &kfence_timer,
 			   msecs_to_jiffies(kfence_sample_interval));
 }
-static DECLARE_DELAYED_WORK(kfence_timer, toggle_allocation_gate);
+
+static bool kfence_cache_targeted(struct kmem_cache *s)
+{
+	unsigned long *slot, verdict;
+	int i;
+
+	if (!kfence_nr_cache_names)
+		return true;
+
+	slot = &kfence_cache_verdicts[hash_ptr(s, KFENCE_CACHE_VERDICT_BITS)];
+	verdict = READ_ONCE(*slot);
+	if ((verdict & ~KFENCE_CACHE_TARGETED) == (unsigned long)s)
+		return verdict & KFENCE_CACHE_TARGETED;
+
+	verdict = (unsigned long)s;
+	for (i = 0; i < kfence_nr_cache_names; i++) {
+		if (!strcmp(s->name, kfence_cache_names[i])) {
+			verdict |= KFENCE_CACHE_TARGETED;
+			break;
+		}
+	}
+	WRITE_ONCE(*slot, verdict);
+
+	return verdict & KFENCE_CACHE_TARGETED;
+}
 
 /* === Public interface ===================================================== */
 
@@ -665,6 +752,11 @@ void __init kfence_init(void)
 		return;
 	}
 
+	if (kfence_deferrable)
+		INIT_DEFERRABLE_WORK(&kfence_timer, toggle_allocation_gate);
+	else
+		INIT_DELAYED_WORK(&kfence_timer, toggle_allocation_gate);
+
 	WRITE_ONCE(kfence_enabled, true);
 	queue_delayed_work(system_power_efficient_wq, &kfence_timer, 0);
 	pr_info("initialized - using %lu bytes for %d objects at 0x%p-0x%p\n", KFENCE_POOL_SIZE,
@@ -674,10 +766,15 @@ void __init kfence_init(void)
 
 void kfence_shutdown_cache(struct kmem_cache *s)
 {
+	unsigned long *slot = &kfence_cache_verdicts[hash_ptr(s, KFENCE_CACHE_VERDICT_BITS)];
 	unsigned long flags;
 	struct kfence_metadata *meta;
 	int i;
 
+	/* A cache created later may get the same address. */
+	if ((READ_ONCE(*slot) & ~KFENCE_CACHE_TARGETED) == (unsigned long)s)
+		WRITE_ONCE(*slot, 0);
+
 	for (i = 0; i < CONFIG_KFENCE_NUM_OBJECTS; i++) {
 		bool in_use;
 
@@ -738,7 +835,12 @@ void *__kfence_alloc(struct kmem_cache *s, size_t size, gfp_t flags)
 	 * sense to continue writing to it and pay the associated contention
 	 * cost, in case we have a large number of concurrent allocations.
 	 */
-	if (atomic_read(&kfence_allocation_gate) || atomic_inc_return(&kfence_allocation_gate) > 1)
+	if (atomic_read(&kfence_allocation_gate))
+		return NULL;
+	/* Leave the gate open for an allocation from a targeted cache. */
+	if (!kfence_cache_targeted(s))
+		return NULL;
+	if (atomic_inc_return(&kfence_allocation_gate) > 1)
 		return NULL;
 #ifdef CONFIG_KFENCE_STATIC_KEYS
 	/*
@@ -21,11 +21,13 @@
    SOFTWARE IS DISCLAIMED.
 */
 
+#include <linux/debugfs.h>
 #include <linux/kref.h>
 #include <linux/module.h>
 #include <linux/file.h>
 #include <linux/kthread.h>
 #include <linux/hidraw.h>
+#include <linux/seq_file.h>
 
 #include <net/bluetooth/bluetooth.h>
 #include <net/bluetooth/hci_core.h>
@@ -39,6 +41,8 @@ static DECLARE_RWSEM(hidp_session_sem);
 static DECLARE_WAIT_QUEUE_HEAD(hidp_session_wq);
 static LIST_HEAD(hidp_session_list);
 
+static bool direct_input;
+
 static unsigned char hidp_keycode[256] = {
 	  0,   0,   0,   0,  30,  48,  46,  32,  18,  33,  34,  35,  23,  36,
 	 37,  38,  50,  49,  24,  25,  16,  19,  31,  20,  22,  47,  17,  45,
@@ -514,12 +518,16 @@ static int hidp_process_data(struct hidp_session *session, struct sk_buff *skb,
 	case HIDP_DATA_RTYPE_INPUT:
 		hidp_set_timer(session);
 
+		spin_lock(&session->input_lock);
+
 		if (session->input)
 			hidp_input_report(session, skb);
 
 		if (session->hid)
 			hidp_process_report(session, HID_INPUT_REPORT,
 					    skb->data, skb->len, 0);
+
+		spin_unlock(&session->input_lock);
 		break;
 
 	case HIDP_DATA_RTYPE_OTHER:
@@ -584,6 +592,32 @@ static void hidp_recv_ctrl_frame(struct hidp_session *session,
 		kfree_skb(skb);
 }
 
+/*
+ * Account the time an intr-report took from its reception by the HCI driver,
+ * which timestamped it, until the HID core was done with it. Reports which
+ * L2CAP had to reassemble carry no timestamp.
+ */
+static void hidp_intr_latency(struct hidp_session *session,
+			      struct sk_buff *skb)
+{
+	s64 delta;
+
+	session->intr_reports++;
+
+	if (!skb->tstamp) {
+		session->intr_untimed++;
+		return;
+	}
+
+	delta = ktime_to_ns(ktime_sub(ktime_get_real(), skb->tstamp));
+	if (delta < 0)
+		return;
+
+	session->intr_latency_sum += delta;
+	if (delta > session->intr_latency_max)
+		session->intr_latency_max = delta;
+}
+
 static void hidp_recv_intr_frame(struct hidp_session *session,
 				struct sk_buff *skb)
 {
@@ -597,6 +631,8 @@ static void hidp_recv_intr_frame(struct hidp_session *session,
 	if (hdr == (HIDP_TRANS_DATA | HIDP_DATA_RTYPE_INPUT)) {
 		hidp_set_timer(session);
 
+		spin_lock(&session->input_lock);
+
 		if (session->input)
 			hidp_input_report(session, skb);
 
@@ -605,6 +641,10 @@ static void hidp_recv_intr_frame(struct hidp_session *session,
 					    skb->data, skb->len, 1);
 			BT_DBG("report len %d", skb->len);
 		}
+
+		spin_unlock(&session->input_lock);
+
+		hidp_intr_latency(session, skb);
 	} else {
 		BT_DBG("Unsupported protocol header 0x%02x", hdr);
 	}
@@ -612,6 +652,67 @@ static void hidp_recv_intr_frame(struct hidp_session *session,
 	kfree_skb(skb);
 }
 
+/* parse incoming intr-skbs */
+static void hidp_recv_intr_queue(struct hidp_session *session)
+{
+	struct sock *intr_sk = session->intr_sock->sk;
+	struct sk_buff *skb;
+
+	while ((skb = skb_dequeue(&intr_sk->sk_receive_queue))) {
+		skb_orphan(skb);
+		if (!skb_linearize(skb))
+			hidp_recv_intr_frame(session, skb);
+		else
+			kfree_skb(skb);
+	}
+}
+
+/*
+ * Direct intr-report delivery
+ * L2CAP calls ->sk_data_ready() with the socket locked, right after queuing a
+ * frame. Reports are handed to the HID core from there, instead of waking up
+ * the session thread, which saves a context switch and the scheduling delay
+ * of the thread for every report. The ctrl channel and all transmissions are
+ * still handled by the thread.
+ */
+static void hidp_intr_data_ready(struct sock *sk)
+{
+	hidp_recv_intr_queue(sk->sk_user_data);
+}
+
+static void hidp_intr_direct_start(struct hidp_session *session)
+{
+	struct sock *intr_sk = session->intr_sock->sk;
+
+	lock_sock(intr_sk);
+
+	write_lock_bh(&intr_sk->sk_callback_lock);
+	session->intr_data_ready = intr_sk->sk_data_ready;
+	intr_sk->sk_user_data = session;
+	intr_sk->sk_data_ready = hidp_intr_data_ready;
+	write_unlock_bh(&intr_sk->sk_callback_lock);
+
+	/* reports which arrived before, if any */
+	hidp_recv_intr_queue(session);
+
+	release_sock(intr_sk);
+}
+
+static void hidp_intr_direct_stop(struct hidp_session *session)
+{
+	struct sock *intr_sk = session->intr_sock->sk;
+
+	/* wait for a running ->sk_data_ready() */
+	lock_sock(intr_sk);
+
+	write_lock_bh(&intr_sk->sk_callback_lock);
+	intr_sk->sk_data_ready = session->intr_data_ready;
+	intr_sk->sk_user_data = NULL;
+	write_unlock_bh(&intr_sk->sk_callback_lock);
+
+	release_sock(intr_sk);
+}
+
 static int hidp_send_frame(struct socket *sock, unsigned char *data, int len)
 {
 	struct kvec iv = { data, len };
@@ -946,6 +1047,7 @@ static int hidp_session_new(struct hidp_session **out, const bdaddr_t *bdaddr,
 	session->intr_mtu = min_t(uint, l2cap_pi(intr)->chan->omtu,
 					l2cap_pi(intr)->chan->imtu);
 	session->idle_to = req->idle_to;
+	session->intr_direct = READ_ONCE(direct_input);
 
 	/* device management */
 	INIT_WORK(&session->dev_init, hidp_session_dev_work);
@@ -954,6 +1056,7 @@ static int hidp_session_new(struct hidp_session **out, const bdaddr_t *bdaddr,
 	/* session data */
 	mutex_init(&session->report_mutex);
 	init_waitqueue_head(&session->report_queue);
+	spin_lock_init(&session->input_lock);
 
 	ret = hidp_session_dev_init(session, req);
 	if (ret)
@@ -1209,14 +1312,9 @@ static void hidp_session_run(struct hidp_session *session)
 		    intr_sk->sk_state != BT_CONNECTED)
 			break;
 
-		/* parse incoming intr-skbs */
-		while ((skb = skb_dequeue(&intr_sk->sk_receive_queue))) {
-			skb_orphan(skb);
-			if (!skb_linearize(skb))
-				hidp_recv_intr_frame(session, skb);
-			else
-				kfree_skb(skb);
-		}
+		/* with direct delivery, L2CAP already did that */
+		if (!session->intr_direct)
+			hidp_recv_intr_queue(session);
 
 		/* send pending intr-skbs */
 		hidp_process_transmit(session, &session->intr_transmit,
@@ -1275,6 +1373,9 @@ static int hidp_session_thread(void *arg)
 	set_user_nice(current, -15);
 	hidp_set_timer(session);
 
+	if (session->intr_direct)
+		hidp_intr_direct_start(session);
+
 	add_wait_queue(sk_sleep(session->ctrl_sock->sk), &ctrl_wait);
 	add_wait_queue(sk_sleep(session->intr_sock->sk), &intr_wait);
 	/* This memory barrier is paired with wq_has_sleeper(). See
@@ -1291,6 +1392,8 @@ static int hidp_session_thread(void *arg)
 	/* cleanup runtime environment */
 	remove_wait_queue(sk_sleep(session->intr_sock->sk), &intr_wait);
 	remove_wait_queue(sk_sleep(session->ctrl_sock->sk), &ctrl_wait);
+	if (session->intr_direct)
+		hidp_intr_direct_stop(session);
 	wake_up_interruptible(&session->report_queue);
 	hidp_del_timer(session);
 
@@ -1457,21 +1560,66 @@ int hidp_get_conninfo(struct hidp_conninfo *ci)
 	return session ? 0 : -ENOENT;
 }
 
+static int hidp_debugfs_show(struct seq_file *f, void *x)
+{
+	struct hidp_session *session;
+	u64 timed, avg;
+
+	down_read(&hidp_session_sem);
+
+	list_for_each_entry(session, &hidp_session_list, list) {
+		timed = session->intr_reports - session->intr_untimed;
+		avg = timed ? div64_u64(session->intr_latency_sum, timed) : 0;
+
+		seq_printf(f, "%pMR %s %llu %llu %llu %llu\n",
+			   &session->bdaddr,
+			   session->intr_direct ? "direct" : "thread",
+			   session->intr_reports, session->intr_untimed,
+			   div_u64(avg, NSEC_PER_USEC),
+			   div_u64(session->intr_latency_max, NSEC_PER_USEC));
+	}
+
+	up_read(&hidp_session_sem);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(hidp_debugfs);
+
+static struct dentry *hidp_debugfs;
+
 static int __init hidp_init(void)
 {
+	int err;
+
 	BT_INFO("HIDP (Human Interface Emulation) ver %s", VERSION);
 
-	return hidp_init_sockets();
+	err = hidp_init_sockets();
+	if (err < 0)
+		return err;
+
+	if (IS_ERR_OR_NULL(bt_debugfs))
+		return 0;
+
+	hidp_debugfs = debugfs_create_file("hidp", 0444, bt_debugfs, NULL,
+					   &hidp_debugfs_fops);
+
+	return 0;
 }
 
 static void __exit hidp_exit(void)
 {
+	debugfs_remove(hidp_debugfs);
+
 	hidp_cleanup_sockets();
 }
 
 module_init(hidp_init);
 module_exit(hidp_exit);
 
+module_param(direct_input, bool, 0644);
+MODULE_PARM_DESC(direct_input, "Deliver input reports in the L2CAP receive path");
+
 MODULE_AUTHOR("Marcel Holtmann <marcel@holtmann.org>");
 MODULE_AUTHOR("David Herrmann <dh.herrmann@gmail.com>");
 MODULE_DESCRIPTION("Bluetooth HIDP ver " VERSION);
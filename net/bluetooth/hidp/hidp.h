@@ -157,6 +157,10 @@ struct hidp_session {
 	uint intr_mtu;
 	unsigned long idle_to;
 
+	/* intr-reports delivered from the L2CAP receive path */
+	bool intr_direct;
+	void (*intr_data_ready)(struct sock *sk);
+
 	/* device management */
 	struct work_struct dev_init;
 	struct input_dev *input;
@@ -181,7 +185,14 @@ struct hidp_session {
 	/* Used in hidp_output_raw_report() */
 	int output_report_success; /* boolean */
 
-	/* temporary input buffer */
+	/* intr-report latency since HCI reception, in ns */
+	u64 intr_reports;
+	u64 intr_untimed;
+	u64 intr_latency_sum;
+	u64 intr_latency_max;
+
+	/* temporary input buffer, protected by input_lock */
+	spinlock_t input_lock;
 	u8 input_buf[HID_MAX_BUFFER_SIZE];
 };
 
@@ -22,8 +22,12 @@
 #include <linux/proc_fs.h>
 #include <linux/err.h>
 #include <linux/cpumask.h>
+#include <linux/bitmap.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
 
 #include <linux/netfilter/x_tables.h>
+#include <linux/netfilter/xt_tcpudp.h>
 #include <linux/netfilter_ipv4/ip_tables.h>
 #include <net/netfilter/nf_log.h>
 #include "../../netfilter/xt_repldata.h"
@@ -220,6 +224,211 @@ struct ipt_entry *ipt_next_entry(const struct ipt_entry *entry)
 	return (void *)entry + entry->next_offset;
 }
 
+/*
+ * Rule classifier.
+ *
+ * Besides the linear ruleset, each base chain gets one list of candidate
+ * rules per class of packets: TCP or UDP to a given destination port bucket,
+ * TCP or UDP whose ports can't be looked at, and everything else.  A rule is
+ * only left out of a list if its protocol, or its leading tcp/udp match on
+ * destination ports, rules out the whole class.  Such a rule could not have
+ * matched any packet of the class, so ipt_do_table() may skip it without
+ * changing the outcome or the counters.  Jumps, returns and XT_CONTINUE
+ * targets fall back to the linear walk.
+ */
+static bool rule_classifier __read_mostly = true;
+module_param(rule_classifier, bool, 0644);
+MODULE_PARM_DESC(rule_classifier,
+		 "Build per-chain candidate rule lists when a table is loaded");
+
+#define IPT_CLS_PORTS		16
+
+/* List slots, the port buckets follow the TCP and UDP slots */
+enum {
+	IPT_CLS_OTHER,
+	IPT_CLS_TCP,
+	IPT_CLS_UDP	= IPT_CLS_TCP + 1 + IPT_CLS_PORTS,
+	IPT_CLS_SLOTS	= IPT_CLS_UDP + 1 + IPT_CLS_PORTS,
+};
+
+struct ipt_classifier {
+	/* Offsets of the candidate rules, each list ends at the underflow */
+	const u32 *list[NF_INET_NUMHOOKS][IPT_CLS_SLOTS];
+	u32 offsets[];
+};
+
+/* Performance critical */
+static inline const u32 *
+ipt_classify(const struct xt_table_info *private, unsigned int hook,
+	     const struct sk_buff *skb, const struct iphdr *ip,
+	     const struct xt_action_param *par)
+{
+	const struct ipt_classifier *cls = private->classifier;
+	union {
+		struct tcphdr tcp;
+		struct udphdr udp;
+	} _hdr;
+	const __be16 *ports;
+	unsigned int slot;
+
+	if (!cls)
+		return NULL;
+
+	switch (ip->protocol) {
+	case IPPROTO_TCP:
+		slot = IPT_CLS_TCP;
+		ports = skb_header_pointer(skb, par->thoff,
+					   sizeof(struct tcphdr), &_hdr);
+		break;
+	case IPPROTO_UDP:
+		slot = IPT_CLS_UDP;
+		ports = skb_header_pointer(skb, par->thoff,
+					   sizeof(struct udphdr), &_hdr);
+		break;
+	default:
+		return cls->list[hook][IPT_CLS_OTHER];
+	}
+
+	/* Leave fragments and short headers to the matches */
+	if (!par->fragoff && ports)
+		slot += 1 + (ntohs(ports[1]) & (IPT_CLS_PORTS - 1));
+
+	return cls->list[hook][slot];
+}
+
+/* Set the port slots a leading tcp/udp match leaves open for the rule */
+static void ipt_classify_ports(const struct ipt_entry *e, u8 proto,
+			       unsigned int slot, unsigned long *slots)
+{
+	const struct xt_entry_match *m = (const void *)e->elems;
+	unsigned int lo = 0, hi = 0xffff, port;
+
+	__set_bit(slot, slots);
+
+	if (e->ip.proto == proto && !(e->ip.invflags & IPT_INV_PROTO) &&
+	    e->target_offset > sizeof(*e)) {
+		const char *name = m->u.kernel.match->name;
+
+		if (proto == IPPROTO_TCP && strcmp(name, "tcp") == 0) {
+			const struct xt_tcp *tcpinfo = (const void *)m->data;
+
+			if (!(tcpinfo->invflags & XT_TCP_INV_DSTPT)) {
+				lo = tcpinfo->dpts[0];
+				hi = tcpinfo->dpts[1];
+			}
+		} else if (proto == IPPROTO_UDP && strcmp(name, "udp") == 0) {
+			const struct xt_udp *udpinfo = (const void *)m->data;
+
+			if (!(udpinfo->invflags & XT_UDP_INV_DSTPT)) {
+				lo = udpinfo->dpts[0];
+				hi = udpinfo->dpts[1];
+			}
+		}
+	}
+
+	if (hi < lo || hi - lo >= IPT_CLS_PORTS - 1) {
+		bitmap_set(slots, slot + 1, IPT_CLS_PORTS);
+		return;
+	}
+
+	for (port = lo; port <= hi; port++)
+		__set_bit(slot + 1 + (port & (IPT_CLS_PORTS - 1)), slots);
+}
+
+static void ipt_classify_rule(const struct ipt_entry *e, unsigned long *slots)
+{
+	const struct ipt_ip *ip = &e->ip;
+	bool inv = ip->invflags & IPT_INV_PROTO;
+
+	bitmap_zero(slots, IPT_CLS_SLOTS);
+
+	if (!ip->proto || (ip->proto == IPPROTO_TCP) != inv)
+		ipt_classify_ports(e, IPPROTO_TCP, IPT_CLS_TCP, slots);
+	if (!ip->proto || (ip->proto == IPPROTO_UDP) != inv)
+		ipt_classify_ports(e, IPPROTO_UDP, IPT_CLS_UDP, slots);
+	if (!ip->proto || inv ||
+	    (ip->proto != IPPROTO_TCP && ip->proto != IPPROTO_UDP))
+		__set_bit(IPT_CLS_OTHER, slots);
+}
+
+/* Is the underflow of a base chain reached by walking its rules? */
+static bool ipt_classifier_chain_ok(const struct xt_table_info *info,
+				    const void *entry0, unsigned int hook)
+{
+	unsigned int off = info->hook_entry[hook];
+
+	while (off < info->underflow[hook])
+		off += get_entry(entry0, off)->next_offset;
+
+	return off == info->underflow[hook];
+}
+
+/*
+ * Fill the lists of the valid base chains, or just count their entries if
+ * cls is NULL.  The underflow is unconditional, so it ends every list.
+ */
+static unsigned int ipt_classifier_fill(const struct xt_table_info *info,
+					const void *entry0,
+					unsigned int valid_hooks,
+					struct ipt_classifier *cls)
+{
+	DECLARE_BITMAP(slots, IPT_CLS_SLOTS);
+	const struct ipt_entry *e;
+	unsigned int hook, slot, off, n = 0;
+
+	for (hook = 0; hook < NF_INET_NUMHOOKS; hook++) {
+		if (!(valid_hooks & (1 << hook)) ||
+		    !ipt_classifier_chain_ok(info, entry0, hook))
+			continue;
+
+		for (slot = 0; slot < IPT_CLS_SLOTS; slot++) {
+			if (cls)
+				cls->list[hook][slot] = &cls->offsets[n];
+
+			off = info->hook_entry[hook];
+			for (;;) {
+				e = get_entry(entry0, off);
+				ipt_classify_rule(e, slots);
+				if (test_bit(slot, slots)) {
+					if (cls)
+						cls->offsets[n] = off;
+					n++;
+				}
+				if (off == info->underflow[hook])
+					break;
+				off += e->next_offset;
+			}
+		}
+	}
+
+	return n;
+}
+
+static void ipt_build_classifier(struct xt_table_info *newinfo,
+				 const void *entry0, unsigned int valid_hooks)
+{
+	struct ipt_classifier *cls;
+	unsigned int n;
+
+	n = ipt_classifier_fill(newinfo, entry0, valid_hooks, NULL);
+	if (!n)
+		return;
+
+	/* Optional: without it, the rules are just walked linearly */
+	cls = kvzalloc(struct_size(cls, offsets, n), GFP_KERNEL_ACCOUNT);
+	if (!cls)
+		return;
+
+	ipt_classifier_fill(newinfo, entry0, valid_hooks, cls);
+	newinfo->classifier = cls;
+}
+
+static void ipt_free_table_info(struct xt_table_info *info)
+{
+	kvfree(info->classifier);
+	xt_free_table_info(info);
+}
+
 /* Returns one of the generic firewall policies, like NF_ACCEPT. */
 unsigned int
 ipt_do_table(struct sk_buff *skb,
@@ -236,6 +445,7 @@ ipt_do_table(struct sk_buff *skb,
 	struct ipt_entry *e, **jumpstack;
 	unsigned int stackidx, cpu;
 	const struct xt_table_info *private;
+	const u32 *cand;
 	struct xt_action_param acpar;
 	unsigned int addend;
 
@@ -274,6 +484,9 @@ ipt_do_table(struct sk_buff *skb,
 		jumpstack += private->stacksize * __this_cpu_read(nf_skb_duplicated);
 
 	e = get_entry(table_base, private->hook_entry[hook]);
+	cand = ipt_classify(private, hook, skb, ip, &acpar);
+	if (cand)
+		e = get_entry(table_base, *cand);
 
 	do {
 		const struct xt_entry_target *t;
@@ -284,7 +497,10 @@ ipt_do_table(struct sk_buff *skb,
 		if (!ip_packet_match(ip, indev, outdev,
 		    &e->ip, acpar.fragoff)) {
  no_match:
-			e = ipt_next_entry(e);
+			if (cand)
+				e = get_entry(table_base, *++cand);
+			else
+				e = ipt_next_entry(e);
 			continue;
 		}
 
@@ -318,6 +534,7 @@ ipt_do_table(struct sk_buff *skb,
 					verdict = (unsigned int)(-v) - 1;
 					break;
 				}
+				cand = NULL;
 				if (stackidx == 0) {
 					e = get_entry(table_base,
 					    private->underflow[hook]);
@@ -336,6 +553,7 @@ ipt_do_table(struct sk_buff *skb,
 				jumpstack[stackidx++] = e;
 			}
 
+			cand = NULL;
 			e = get_entry(table_base, v);
 			continue;
 		}
@@ -347,6 +565,7 @@ ipt_do_table(struct sk_buff *skb,
 		if (verdict == XT_CONTINUE) {
 			/* Target might have changed stuff. */
 			ip = ip_hdr(skb);
+			cand = NULL;
 			e = ipt_next_entry(e);
 		} else {
 			/* Verdict */
@@ -730,6 +949,9 @@ translate_table(struct net *net, struct xt_table_info *newinfo, void *entry0,
 		return ret;
 	}
 
+	if (rule_classifier)
+		ipt_build_classifier(newinfo, entry0, repl->valid_hooks);
+
 	return ret;
  out_free:
 	kvfree(offsets);
@@ -1083,7 +1305,7 @@ __do_replace(struct net *net, const char *name, unsigned int valid_hooks,
 	xt_entry_foreach(iter, oldinfo->entries, oldinfo->size)
 		cleanup_entry(iter, net);
 
-	xt_free_table_info(oldinfo);
+	ipt_free_table_info(oldinfo);
 	if (copy_to_user(counters_ptr, counters,
 			 sizeof(struct xt_counters) * num_counters) != 0) {
 		/* Silent error, can't fail, new table is already in place */
@@ -1146,7 +1368,7 @@ do_replace(struct net *net, sockptr_t arg, unsigned int len)
 	xt_entry_foreach(iter, loc_cpu_entry, newinfo->size)
 		cleanup_entry(iter, net);
  free_newinfo:
-	xt_free_table_info(newinfo);
+	ipt_free_table_info(newinfo);
 	return ret;
 }
 
@@ -1468,11 +1690,11 @@ translate_compat_table(struct net *net,
 
 	*pinfo = newinfo;
 	*pentry0 = entry1;
-	xt_free_table_info(info);
+	ipt_free_table_info(info);
 	return 0;
 
 free_newinfo:
-	xt_free_table_info(newinfo);
+	ipt_free_table_info(newinfo);
 	return ret;
 out_unlock:
 	xt_compat_flush_offsets(AF_INET);
@@ -1530,7 +1752,7 @@ compat_do_replace(struct net *net, sockptr_t arg, unsigned int len)
 	xt_entry_foreach(iter, loc_cpu_entry, newinfo->size)
 		cleanup_entry(iter, net);
  free_newinfo:
-	xt_free_table_info(newinfo);
+	ipt_free_table_info(newinfo);
 	return ret;
 }
 
@@ -1711,7 +1933,7 @@ static void __ipt_unregister_table(struct net *net, struct xt_table *table)
 		cleanup_entry(iter, net);
 	if (private->number > private->initial_entries)
 		module_put(table_owner);
-	xt_free_table_info(private);
+	ipt_free_table_info(private);
 }
 
 int ipt_register_table(struct net *net, const struct xt_table *table,
@@ -1735,13 +1957,13 @@ int ipt_register_table(struct net *net, const struct xt_table *table,
 
 	ret = translate_table(net, newinfo, loc_cpu_entry, repl);
 	if (ret != 0) {
-		xt_free_table_info(newinfo);
+		ipt_free_table_info(newinfo);
 		return ret;
 	}
 
 	new_table = xt_register_table(net, table, &bootstrap, newinfo);
 	if (IS_ERR(new_table)) {
-		xt_free_table_info(newinfo);
+		ipt_free_table_info(newinfo);
 		return PTR_ERR(new_table);
 	}
 
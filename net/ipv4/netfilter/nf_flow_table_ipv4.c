@@ -3,21 +3,130 @@
 #include <linux/init.h>
 #include <linux/module.h>
 #include <linux/netfilter.h>
+#include <linux/percpu.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <net/netns/generic.h>
 #include <net/netfilter/nf_flow_table.h>
 #include <net/netfilter/nf_tables.h>
 
+/*
+ * Fast path counters, per netns: how many packets the flowtables forwarded
+ * themselves, how many they left to the classic forwarding path, and how
+ * many they dropped.
+ */
+struct nf_flow_ipv4_stats {
+	unsigned long	hit;
+	unsigned long	miss;
+	unsigned long	drop;
+};
+
+struct nf_flow_ipv4_net {
+	struct nf_flow_ipv4_stats __percpu *stats;
+};
+
+static unsigned int nf_flow_ipv4_net_id __read_mostly;
+
+static unsigned int nf_flow_ipv4_hook(void *priv, struct sk_buff *skb,
+				      const struct nf_hook_state *state)
+{
+	struct nf_flow_ipv4_net *fn = net_generic(state->net,
+						  nf_flow_ipv4_net_id);
+	unsigned int verdict;
+
+	verdict = nf_flow_offload_ip_hook(priv, skb, state);
+
+	switch (verdict) {
+	case NF_STOLEN:
+		this_cpu_inc(fn->stats->hit);
+		break;
+	case NF_ACCEPT:
+		this_cpu_inc(fn->stats->miss);
+		break;
+	default:
+		this_cpu_inc(fn->stats->drop);
+		break;
+	}
+
+	return verdict;
+}
+
 static struct nf_flowtable_type flowtable_ipv4 = {
 	.family		= NFPROTO_IPV4,
 	.init		= nf_flow_table_init,
 	.setup		= nf_flow_table_offload_setup,
 	.action		= nf_flow_rule_route_ipv4,
 	.free		= nf_flow_table_free,
-	.hook		= nf_flow_offload_ip_hook,
+	.hook		= nf_flow_ipv4_hook,
 	.owner		= THIS_MODULE,
 };
 
+#ifdef CONFIG_PROC_FS
+static int nf_flow_ipv4_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct net *net = seq->private;
+	struct nf_flow_ipv4_net *fn = net_generic(net, nf_flow_ipv4_net_id);
+	struct nf_flow_ipv4_stats sum = {};
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		const struct nf_flow_ipv4_stats *st =
+			per_cpu_ptr(fn->stats, cpu);
+
+		sum.hit += READ_ONCE(st->hit);
+		sum.miss += READ_ONCE(st->miss);
+		sum.drop += READ_ONCE(st->drop);
+	}
+
+	seq_printf(seq, "hit %lu\nmiss %lu\ndrop %lu\n",
+		   sum.hit, sum.miss, sum.drop);
+
+	return 0;
+}
+#endif
+
+static int __net_init nf_flow_ipv4_net_init(struct net *net)
+{
+	struct nf_flow_ipv4_net *fn = net_generic(net, nf_flow_ipv4_net_id);
+
+	fn->stats = alloc_percpu(struct nf_flow_ipv4_stats);
+	if (!fn->stats)
+		return -ENOMEM;
+
+#ifdef CONFIG_PROC_FS
+	if (!proc_create_net_single("nf_flowtable_ipv4", 0444, net->proc_net,
+				    nf_flow_ipv4_stats_seq_show, NULL)) {
+		free_percpu(fn->stats);
+		return -ENOMEM;
+	}
+#endif
+
+	return 0;
+}
+
+static void __net_exit nf_flow_ipv4_net_exit(struct net *net)
+{
+	struct nf_flow_ipv4_net *fn = net_generic(net, nf_flow_ipv4_net_id);
+
+	remove_proc_entry("nf_flowtable_ipv4", net->proc_net);
+	free_percpu(fn->stats);
+}
+
+static struct pernet_operations nf_flow_ipv4_net_ops = {
+	.init	= nf_flow_ipv4_net_init,
+	.exit	= nf_flow_ipv4_net_exit,
+	.id	= &nf_flow_ipv4_net_id,
+	.size	= sizeof(struct nf_flow_ipv4_net),
+};
+
 static int __init nf_flow_ipv4_module_init(void)
 {
+	int ret;
+
+	ret = register_pernet_subsys(&nf_flow_ipv4_net_ops);
+	if (ret < 0)
+		return ret;
+
 	nft_register_flowtable_type(&flowtable_ipv4);
 
 	return 0;
@@ -26,6 +135,7 @@ static int __init nf_flow_ipv4_module_init(void)
 static void __exit nf_flow_ipv4_module_exit(void)
 {
 	nft_unregister_flowtable_type(&flowtable_ipv4);
+	unregister_pernet_subsys(&nf_flow_ipv4_net_ops);
 }
 
 module_init(nf_flow_ipv4_module_init);
@@ -200,6 +200,7 @@ static int prb_queue_frozen(struct tpacket_kbdq_core *);
 static void prb_open_block(struct tpacket_kbdq_core *,
 		struct tpacket_block_desc *);
 static void prb_retire_rx_blk_timer_expired(struct timer_list *);
+static void prb_wakeup(struct tpacket_kbdq_core *, struct packet_sock *);
 static void _prb_refresh_rx_retire_blk_timer(struct tpacket_kbdq_core *);
 static void prb_fill_rxhash(struct tpacket_kbdq_core *, struct tpacket3_hdr *);
 static void prb_clear_rxhash(struct tpacket_kbdq_core *,
@@ -565,10 +566,22 @@ static int prb_calc_retire_blk_tmo(struct packet_sock *po,
 	return mbits;
 }
 
+/* Packets a block retired by the timer should hold, with an adaptive tmo */
+#define PRB_TOV_TARGET_PKTS	64
+#define PRB_TOV_MAX_MULT	8
+
+/* Most blocks filled in a row to wake user-space up only once for */
+#define PRB_WAKEUP_MAX_BLKS	8
+
 static void prb_init_ft_ops(struct tpacket_kbdq_core *p1,
 			union tpacket_req_u *req_u)
 {
 	p1->feature_req_word = req_u->req3.tp_feature_req_word;
+
+	p1->wakeup_batch = 1;
+	if (p1->feature_req_word & TP_FT_REQ_COALESCE_WAKEUP)
+		p1->wakeup_batch = clamp_t(unsigned int, p1->knum_blocks / 4,
+					   1, PRB_WAKEUP_MAX_BLKS);
 }
 
 static void init_prb_bdqc(struct packet_sock *po,
@@ -706,12 +719,58 @@ static void prb_retire_rx_blk_timer_expired(struct timer_list *t)
 	}
 
 refresh_timer:
+	/* Don't leave closed blocks behind a coalesced wakeup for too long */
+	if (pkc->blks_pending)
+		prb_wakeup(pkc, po);
 	_prb_refresh_rx_retire_blk_timer(pkc);
 
 out:
 	spin_unlock(&po->sk.sk_receive_queue.lock);
 }
 
+static void prb_wakeup(struct tpacket_kbdq_core *pkc, struct packet_sock *po)
+{
+	pkc->blks_pending = 0;
+	po->sk.sk_data_ready(&po->sk);
+}
+
+/*
+ * Adaptive tmo:
+ * With a low packet rate, every timer expiry retires a block holding only a
+ * handful of packets, and costs user-space a wakeup. Stretch the tmo to the
+ * time it takes to gather PRB_TOV_TARGET_PKTS at the rate the block was
+ * filled at, between the requested tmo and PRB_TOV_MAX_MULT times that. With
+ * a high rate, blocks fill up before the requested tmo anyway.
+ */
+static void prb_adapt_retire_tov(struct tpacket_kbdq_core *pkc,
+		struct tpacket_block_desc *pbd)
+{
+	unsigned long base = msecs_to_jiffies(pkc->retire_blk_tov);
+	unsigned long elapsed = max(jiffies - pkc->blk_open_jiffies, 1UL);
+	unsigned int pkts = BLOCK_NUM_PKTS(pbd);
+	unsigned long tov;
+
+	if (!(pkc->feature_req_word & TP_FT_REQ_ADAPTIVE_TOV))
+		return;
+
+	if (pkts)
+		tov = DIV_ROUND_UP(elapsed * PRB_TOV_TARGET_PKTS, pkts);
+	else
+		tov = base * PRB_TOV_MAX_MULT;
+	tov = clamp(tov, base, base * PRB_TOV_MAX_MULT);
+
+	/*
+	 * Smoothed, so that a single burst or lull doesn't swing it. Round
+	 * towards the new value: truncating would keep a small tmo from ever
+	 * growing, e.g. from 1 to 3 jiffies.
+	 */
+	tov += 3 * pkc->tov_in_jiffies;
+	if (tov > 4 * pkc->tov_in_jiffies)
+		pkc->tov_in_jiffies = DIV_ROUND_UP(tov, 4);
+	else
+		pkc->tov_in_jiffies = tov / 4;
+}
+
 static void prb_flush_block(struct tpacket_kbdq_core *pkc1,
 		struct tpacket_block_desc *pbd1, __u32 status)
 {
@@ -763,7 +822,6 @@ static void prb_close_block(struct tpacket_kbdq_core *pkc1,
 
 	struct tpacket3_hdr *last_pkt;
 	struct tpacket_hdr_v1 *h1 = &pbd1->hdr.bh1;
-	struct sock *sk = &po->sk;
 
 	if (atomic_read(&po->tp_drops))
 		status |= TP_STATUS_LOSING;
@@ -787,12 +845,21 @@ static void prb_close_block(struct tpacket_kbdq_core *pkc1,
 		h1->ts_last_pkt.ts_nsec	= ts.tv_nsec;
 	}
 
+	prb_adapt_retire_tov(pkc1, pbd1);
+
 	smp_wmb();
 
 	/* Flush the block */
 	prb_flush_block(pkc1, pbd1, status);
 
-	sk->sk_data_ready(sk);
+	/*
+	 * Blocks filled in a row are announced together. A block retired
+	 * by the timer means that the link has gone quiet: announce it and
+	 * those before it right away.
+	 */
+	if (++pkc1->blks_pending >= pkc1->wakeup_batch ||
+	    (stat & TP_STATUS_BLK_TMO))
+		prb_wakeup(pkc1, po);
 
 	pkc1->kactive_blk_num = GET_NEXT_PRB_BLK_NUM(pkc1);
 }
@@ -829,6 +896,7 @@ static void prb_open_block(struct tpacket_kbdq_core *pkc1,
 
 	h1->ts_first_pkt.ts_sec = ts.tv_sec;
 	h1->ts_first_pkt.ts_nsec = ts.tv_nsec;
+	pkc1->blk_open_jiffies = jiffies;
 
 	pkc1->pkblk_start = (char *)pbd1;
 	pkc1->nxt_offset = pkc1->pkblk_start + BLK_PLUS_PRIV(pkc1->blk_sizeof_priv);
@@ -874,6 +942,10 @@ static void prb_freeze_queue(struct tpacket_kbdq_core *pkc,
 {
 	pkc->reset_pending_on_curr_blk = 1;
 	po->stats.stats3.tp_freeze_q_cnt++;
+
+	/* user-space has to catch up, it can't wait for more blocks */
+	if (pkc->blks_pending)
+		prb_wakeup(pkc, po);
 }
 
 #define TOTAL_PKT_LEN_INCL_ALIGN(length) (ALIGN((length), V3_ALIGNMENT))
@@ -47,6 +47,11 @@ struct tpacket_kbdq_core {
 	unsigned short  retire_blk_tov;
 	unsigned short  version;
 	unsigned long	tov_in_jiffies;
+	unsigned long	blk_open_jiffies;
+
+	/* blocks closed since the last wakeup, and how many to wait for */
+	unsigned int	blks_pending;
+	unsigned int	wakeup_batch;
 
 	/* timer to retire an outstanding block */
 	struct timer_list retire_blk_timer;
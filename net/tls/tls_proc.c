@@ -18,6 +18,10 @@ static const struct snmp_mib tls_mib_list[] = {
 	SNMP_MIB_ITEM("TlsRxDevice", LINUX_MIB_TLSRXDEVICE),
 	SNMP_MIB_ITEM("TlsDecryptError", LINUX_MIB_TLSDECRYPTERROR),
 	SNMP_MIB_ITEM("TlsRxDeviceResync", LINUX_MIB_TLSRXDEVICERESYNC),
+	SNMP_MIB_ITEM("TlsTxSwRecords", LINUX_MIB_TLSTXSWRECORDS),
+	SNMP_MIB_ITEM("TlsTxSwCryptoUsecs", LINUX_MIB_TLSTXSWCRYPTOUSECS),
+	SNMP_MIB_ITEM("TlsRxSwRecords", LINUX_MIB_TLSRXSWRECORDS),
+	SNMP_MIB_ITEM("TlsRxSwCryptoUsecs", LINUX_MIB_TLSRXSWCRYPTOUSECS),
 	SNMP_MIB_SENTINEL
 };
 
@@ -35,6 +35,7 @@
  * SOFTWARE.
  */
 
+#include <linux/sched/clock.h>
 #include <linux/sched/signal.h>
 #include <linux/module.h>
 #include <linux/splice.h>
@@ -215,6 +216,34 @@ static void tls_decrypt_done(struct crypto_async_request *req, int err)
 	spin_unlock_bh(&ctx->decrypt_compl_lock);
 }
 
+/*
+ * Nanoseconds of crypto time not yet accounted in the microsecond counters.
+ * A record typically takes a few microseconds, so rounding each of them
+ * would make the counters drift by up to half a microsecond per record.
+ */
+static DEFINE_PER_CPU(u32, tls_crypto_nsecs[__LINUX_MIB_TLSMAX]);
+
+/*
+ * Account a record the software path encrypted or decrypted synchronously,
+ * and the time the crypto took, so that the CPU cost of a record can be read
+ * from tls_stat. Records completed by an async engine are not counted.
+ */
+static void tls_account_record(struct sock *sk, int records_mib,
+			       int usecs_mib, u64 crypto_start)
+{
+	struct net *net = sock_net(sk);
+	u64 nsecs = local_clock() - crypto_start;
+	u32 *rem;
+
+	TLS_INC_STATS(net, records_mib);
+
+	rem = get_cpu_ptr(&tls_crypto_nsecs[usecs_mib]);
+	nsecs += *rem;
+	*rem = do_div(nsecs, NSEC_PER_USEC);
+	__SNMP_ADD_STATS(net->mib.tls_statistics, usecs_mib, nsecs);
+	put_cpu_ptr(rem);
+}
+
 static int tls_do_decryption(struct sock *sk,
 			     struct sk_buff *skb,
 			     struct scatterlist *sgin,
@@ -227,6 +256,7 @@ static int tls_do_decryption(struct sock *sk,
 	struct tls_context *tls_ctx = tls_get_ctx(sk);
 	struct tls_prot_info *prot = &tls_ctx->prot_info;
 	struct tls_sw_context_rx *ctx = tls_sw_ctx_rx(tls_ctx);
+	u64 crypto_start;
 	int ret;
 
 	aead_request_set_tfm(aead_req, ctx->aead_recv);
@@ -253,12 +283,16 @@ static int tls_do_decryption(struct sock *sk,
 					  crypto_req_done, &ctx->async_wait);
 	}
 
+	crypto_start = local_clock();
 	ret = crypto_aead_decrypt(aead_req);
 	if (ret == -EINPROGRESS) {
 		if (async)
 			return ret;
 
 		ret = crypto_wait_req(ret, &ctx->async_wait);
+	} else if (!ret) {
+		tls_account_record(sk, LINUX_MIB_TLSRXSWRECORDS,
+				   LINUX_MIB_TLSRXSWCRYPTOUSECS, crypto_start);
 	}
 
 	if (async)
@@ -496,6 +530,7 @@ static int tls_do_encryption(struct sock *sk,
 	struct sk_msg *msg_en = &rec->msg_encrypted;
 	struct scatterlist *sge = sk_msg_elem(msg_en, start);
 	int rc, iv_offset = 0;
+	u64 crypto_start;
 
 	/* For CCM based ciphers, first byte of IV is a constant */
 	if (prot->cipher_type == TLS_CIPHER_AES_CCM_128) {
@@ -526,7 +561,11 @@ static int tls_do_encryption(struct sock *sk,
 	list_add_tail((struct list_head *)&rec->list, &ctx->tx_list);
 	atomic_inc(&ctx->encrypt_pending);
 
+	crypto_start = local_clock();
 	rc = crypto_aead_encrypt(aead_req);
+	if (!rc)
+		tls_account_record(sk, LINUX_MIB_TLSTXSWRECORDS,
+				   LINUX_MIB_TLSTXSWCRYPTOUSECS, crypto_start);
 	if (!rc || rc != -EINPROGRESS) {
 		atomic_dec(&ctx->encrypt_pending);
 		sge->offset -= prot->prepend_size;
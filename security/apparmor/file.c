@@ -259,7 +259,7 @@ unsigned int aa_str_perms(struct aa_dfa *dfa, unsigned int start,
 			  struct aa_perms *perms)
 {
 	unsigned int state;
-	state = aa_dfa_match(dfa, start, name);
+	state = aa_dfa_match_path(dfa, start, name);
 	*perms = aa_compute_fperms(dfa, state, cond);
 
 	return state;
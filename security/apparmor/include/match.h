@@ -97,6 +97,7 @@ struct table_header {
 
 struct aa_dfa {
 	struct kref count;
+	u64 id;		/* unique for the lifetime of the system */
 	u16 flags;
 	u32 max_oob;
 	struct table_header *tables[YYTD_ID_TSIZE];
@@ -130,6 +131,8 @@ unsigned int aa_dfa_match_len(struct aa_dfa *dfa, unsigned int start,
 			      const char *str, int len);
 unsigned int aa_dfa_match(struct aa_dfa *dfa, unsigned int start,
 			  const char *str);
+unsigned int aa_dfa_match_path(struct aa_dfa *dfa, unsigned int start,
+			       const char *path);
 unsigned int aa_dfa_next(struct aa_dfa *dfa, unsigned int state,
 			 const char c);
 unsigned int aa_dfa_outofband_transition(struct aa_dfa *dfa,
@@ -15,12 +15,35 @@
 #include <linux/vmalloc.h>
 #include <linux/err.h>
 #include <linux/kref.h>
+#include <linux/percpu.h>
+#include <linux/string.h>
 
 #include "include/lib.h"
 #include "include/match.h"
 
 #define base_idx(X) ((X) & 0xffffff)
 
+/* longest directory prefix aa_dfa_match_path() remembers */
+#define DIR_CACHE_LEN 256
+
+/*
+ * The state a dfa reached at the end of the directory part of the last path
+ * matched on this cpu.  Consecutive checks tend to be for files in the same
+ * directory, and only their last component then needs walking.  The dfa is
+ * identified by its id rather than its address so that a freed dfa can't be
+ * mistaken for the next one allocated in its place.
+ */
+struct dir_cache {
+	u64 dfa_id;
+	unsigned int start;
+	unsigned int state;
+	unsigned int len;
+	char dir[DIR_CACHE_LEN];
+};
+
+static DEFINE_PER_CPU(struct dir_cache, dfa_dir_cache);
+static atomic64_t dfa_next_id = ATOMIC64_INIT(0);
+
 static char nulldfa_src[] = {
 	#include "nulldfa.in"
 };
@@ -314,6 +337,7 @@ struct aa_dfa *aa_dfa_unpack(void *blob, size_t size, int flags)
 		goto fail;
 
 	kref_init(&dfa->count);
+	dfa->id = atomic64_inc_return(&dfa_next_id);
 
 	error = -EPROTO;
 
@@ -505,6 +529,54 @@ unsigned int aa_dfa_match(struct aa_dfa *dfa, unsigned int start,
 	return state;
 }
 
+/**
+ * aa_dfa_match_path - traverse @dfa to find state @path stops at
+ * @dfa: the dfa to match @path against  (NOT NULL)
+ * @start: the state of the dfa to start matching in
+ * @path: the null terminated path name to match against the dfa (NOT NULL)
+ *
+ * Same as aa_dfa_match() but, when @path is in the same directory as the
+ * last path matched on this cpu against @dfa from @start, resume from the
+ * state the directory part led to instead of walking it again.
+ *
+ * Returns: final state reached after input is consumed
+ */
+unsigned int aa_dfa_match_path(struct aa_dfa *dfa, unsigned int start,
+			       const char *path)
+{
+	struct dir_cache *dc;
+	const char *base;
+	unsigned int state, len;
+
+	if (start == 0 || !in_task())
+		return aa_dfa_match(dfa, start, path);
+
+	base = strrchr(path, '/');
+	if (!base || base == path)
+		return aa_dfa_match(dfa, start, path);
+
+	/* the directory part, including its trailing '/' */
+	len = base - path + 1;
+	if (len > DIR_CACHE_LEN)
+		return aa_dfa_match(dfa, start, path);
+
+	dc = get_cpu_ptr(&dfa_dir_cache);
+	if (dc->dfa_id == dfa->id && dc->start == start && dc->len == len &&
+	    !memcmp(dc->dir, path, len)) {
+		state = dc->state;
+	} else {
+		state = aa_dfa_match_len(dfa, start, path, len);
+		dc->dfa_id = dfa->id;
+		dc->start = start;
+		dc->state = state;
+		dc->len = len;
+		memcpy(dc->dir, path, len);
+	}
+	put_cpu_ptr(dc);
+
+	return aa_dfa_match(dfa, state, base + 1);
+}
+
 /**
  * aa_dfa_next - step one character to the next state in the dfa
  * @dfa: the dfa to traverse (NOT NULL)
@@ -13,6 +13,7 @@
 #include <linux/fs.h>
 #include <linux/xattr.h>
 #include <linux/evm.h>
+#include <linux/fsverity.h>
 #include <linux/iversion.h>
 
 #include "ima.h"
@@ -198,11 +199,41 @@ int ima_get_action(struct user_namespace *mnt_userns, struct inode *inode,
 				flags, pcr, template_desc, func_data);
 }
 
+/*
+ * ima_get_verity_digest - use the fs-verity file digest as the measurement
+ *
+ * The digest is the one fs-verity enforces for every read of the file, so
+ * it is as good as a hash of the contents for measurement, without reading
+ * the file.  It isn't the file hash though, so it is only used when the file
+ * isn't also appraised against a signature of its contents, and it is not
+ * cached as IMA_COLLECTED for later appraisals.
+ *
+ * Return true if @hash was filled in.
+ */
+static bool ima_get_verity_digest(struct integrity_iint_cache *iint,
+				  struct inode *inode,
+				  struct ima_digest_data *hash)
+{
+	enum hash_algo alg;
+
+	if (iint->flags & IMA_APPRAISE)
+		return false;
+
+	if (fsverity_get_digest(inode, hash->digest, &alg))
+		return false;
+
+	hash->algo = alg;
+	hash->length = hash_digest_size[alg];
+	return true;
+}
+
 /*
  * ima_collect_measurement - collect file measurement
  *
  * Calculate the file hash, if it doesn't already exist,
  * storing the measurement and i_version in the iint.
+ * If @verity is set, as requested by a "digest_type=verity" measure rule,
+ * the fs-verity file digest is used instead when there is one.
  *
  * Must be called with iint->mutex held.
  *
@@ -210,7 +241,8 @@ int ima_get_action(struct user_namespace *mnt_userns, struct inode *inode,
  */
 int ima_collect_measurement(struct integrity_iint_cache *iint,
 			    struct file *file, void *buf, loff_t size,
-			    enum hash_algo algo, struct modsig *modsig)
+			    enum hash_algo algo, struct modsig *modsig,
+			    bool verity)
 {
 	const char *audit_cause = "failed";
 	struct inode *inode = file_inode(file);
@@ -246,9 +278,12 @@ int ima_collect_measurement(struct integrity_iint_cache *iint,
 	/* Initialize hash digest to 0's in case of failure */
 	memset(&hash.digest, 0, sizeof(hash.digest));
 
+	if (buf || !verity || !ima_get_verity_digest(iint, inode, &hash.hdr))
+		verity = false;
+
 	if (buf)
 		result = ima_calc_buffer_hash(buf, size, &hash.hdr);
-	else
+	else if (!verity)
 		result = ima_calc_file_hash(file, &hash.hdr);
 
 	if (result && result != -EBADF && result != -EINVAL)
@@ -265,8 +300,14 @@ int ima_collect_measurement(struct integrity_iint_cache *iint,
 	memcpy(iint->ima_hash, &hash, length);
 	iint->version = i_version;
 
+	/* Tell the template which kind of digest iint->ima_hash holds */
+	if (verity)
+		set_bit(IMA_VERITY_HASH, &iint->atomic_flags);
+	else
+		clear_bit(IMA_VERITY_HASH, &iint->atomic_flags);
+
 	/* Possibly temporary failure due to type of read (eg. O_DIRECT) */
-	if (!result)
+	if (!result && !verity)
 		iint->flags |= IMA_COLLECTED;
 out:
 	if (result) {
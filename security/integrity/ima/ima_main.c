@@ -208,7 +208,7 @@ static int process_measurement(struct file *file, const struct cred *cred,
 	struct evm_ima_xattr_data *xattr_value = NULL;
 	struct modsig *modsig = NULL;
 	int xattr_len = 0;
-	bool violation_check;
+	bool violation_check, verity;
 	enum hash_algo hash_algo;
 
 	if (!ima_policy_flag || !S_ISREG(inode->i_mode))
@@ -274,8 +274,12 @@ static int process_measurement(struct file *file, const struct cred *cred,
 	/* Determine if already appraised/measured based on bitmask
 	 * (IMA_MEASURE, IMA_MEASURED, IMA_XXXX_APPRAISE, IMA_XXXX_APPRAISED,
 	 *  IMA_AUDIT, IMA_AUDITED)
+	 *
+	 * The digest type comes from the rule that matched this time, so
+	 * it isn't cached in the iint.
 	 */
-	iint->flags |= action;
+	verity = action & IMA_VERITY_DIGEST;
+	iint->flags |= action & ~IMA_VERITY_DIGEST;
 	action &= IMA_DO_MASK;
 	action &= ~((iint->flags & (IMA_DONE_MASK ^ IMA_MEASURED)) >> 1);
 
@@ -327,7 +331,8 @@ static int process_measurement(struct file *file, const struct cred *cred,
 
 	hash_algo = ima_get_hash_algo(xattr_value, xattr_len);
 
-	rc = ima_collect_measurement(iint, file, buf, size, hash_algo, modsig);
+	rc = ima_collect_measurement(iint, file, buf, size, hash_algo, modsig,
+				     verity);
 	if (rc != 0 && rc != -EBADF && rc != -EINVAL)
 		goto out_locked;
 
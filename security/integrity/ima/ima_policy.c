@@ -948,7 +948,7 @@ enum {
 	Opt_uid_lt, Opt_euid_lt, Opt_fowner_lt,
 	Opt_appraise_type, Opt_appraise_flag,
 	Opt_permit_directio, Opt_pcr, Opt_template, Opt_keyrings,
-	Opt_label, Opt_err
+	Opt_label, Opt_digest_type, Opt_err
 };
 
 static const match_table_t policy_tokens = {
@@ -986,6 +986,7 @@ static const match_table_t policy_tokens = {
 	{Opt_template, "template=%s"},
 	{Opt_keyrings, "keyrings=%s"},
 	{Opt_label, "label=%s"},
+	{Opt_digest_type, "digest_type=%s"},
 	{Opt_err, NULL}
 };
 
@@ -1080,6 +1081,9 @@ static bool ima_validate_rule(struct ima_rule_entry *entry)
 	if (entry->action != MEASURE && entry->flags & IMA_PCR)
 		return false;
 
+	if (entry->action != MEASURE && entry->flags & IMA_VERITY_DIGEST)
+		return false;
+
 	if (entry->action != APPRAISE &&
 	    entry->flags & (IMA_DIGSIG_REQUIRED | IMA_MODSIG_ALLOWED | IMA_CHECK_BLACKLIST))
 		return false;
@@ -1111,7 +1115,7 @@ static bool ima_validate_rule(struct ima_rule_entry *entry)
 				     IMA_UID | IMA_FOWNER | IMA_FSUUID |
 				     IMA_INMASK | IMA_EUID | IMA_PCR |
 				     IMA_FSNAME | IMA_DIGSIG_REQUIRED |
-				     IMA_PERMIT_DIRECTIO))
+				     IMA_PERMIT_DIRECTIO | IMA_VERITY_DIGEST))
 			return false;
 
 		break;
@@ -1511,6 +1515,14 @@ static int ima_parse_rule(char *rule, struct ima_rule_entry *entry)
 		case Opt_permit_directio:
 			entry->flags |= IMA_PERMIT_DIRECTIO;
 			break;
+		case Opt_digest_type:
+			ima_log_string(ab, "digest_type", args[0].from);
+			if (IS_ENABLED(CONFIG_FS_VERITY) &&
+			    strcmp(args[0].from, "verity") == 0)
+				entry->flags |= IMA_VERITY_DIGEST;
+			else
+				result = -EINVAL;
+			break;
 		case Opt_pcr:
 			ima_log_string(ab, "pcr", args[0].from);
 
@@ -1560,6 +1572,18 @@ static int ima_parse_rule(char *rule, struct ima_rule_entry *entry)
 		check_template_modsig(template_desc);
 	}
 
+	/*
+	 * A verity digest must not be mistaken for a hash of the file
+	 * contents, so only record it with a template that says which one
+	 * it is.
+	 */
+	if (!result && entry->flags & IMA_VERITY_DIGEST) {
+		template_desc = entry->template ? entry->template :
+						  ima_template_desc_current();
+		if (!ima_template_has_digest_type(template_desc))
+			result = -EINVAL;
+	}
+
 	audit_log_format(ab, "res=%d", !result);
 	audit_log_end(ab);
 	return result;
@@ -1854,6 +1878,8 @@ int ima_policy_show(struct seq_file *m, void *v)
 		seq_puts(m, "appraise_flag=check_blacklist ");
 	if (entry->flags & IMA_PERMIT_DIRECTIO)
 		seq_puts(m, "permit_directio ");
+	if (entry->flags & IMA_VERITY_DIGEST)
+		seq_puts(m, "digest_type=verity ");
 	rcu_read_unlock();
 	seq_puts(m, "\n");
 	return 0;
@@ -19,9 +19,13 @@ static bool ima_template_hash_algo_allowed(u8 algo)
 	return false;
 }
 
+/* Room for the longest digest type prefix, "verity:" */
+#define DIGEST_TYPE_SIZE	8
+
 enum data_formats {
 	DATA_FMT_DIGEST = 0,
 	DATA_FMT_DIGEST_WITH_ALGO,
+	DATA_FMT_DIGEST_WITH_TYPE_AND_ALGO,
 	DATA_FMT_STRING,
 	DATA_FMT_HEX
 };
@@ -69,8 +73,9 @@ static void ima_show_template_data_ascii(struct seq_file *m,
 	u32 buflen = field_data->len;
 
 	switch (datafmt) {
+	case DATA_FMT_DIGEST_WITH_TYPE_AND_ALGO:
 	case DATA_FMT_DIGEST_WITH_ALGO:
-		buf_ptr = strnchr(field_data->data, buflen, ':');
+		buf_ptr = strrchr(field_data->data, ':');
 		if (buf_ptr != field_data->data)
 			seq_printf(m, "%s", field_data->data);
 
@@ -144,6 +149,14 @@ void ima_show_template_digest_ng(struct seq_file *m, enum ima_show_type show,
 				     field_data);
 }
 
+void ima_show_template_digest_ngv2(struct seq_file *m, enum ima_show_type show,
+				   struct ima_field_data *field_data)
+{
+	ima_show_template_field_data(m, show,
+				     DATA_FMT_DIGEST_WITH_TYPE_AND_ALGO,
+				     field_data);
+}
+
 void ima_show_template_string(struct seq_file *m, enum ima_show_type show,
 			      struct ima_field_data *field_data)
 {
@@ -224,7 +237,7 @@ int ima_parse_buf(void *bufstartp, void *bufendp, void **bufcurp,
 }
 
 static int ima_eventdigest_init_common(const u8 *digest, u32 digestsize,
-				       u8 hash_algo,
+				       const char *digest_type, u8 hash_algo,
 				       struct ima_field_data *field_data)
 {
 	/*
@@ -233,15 +246,26 @@ static int ima_eventdigest_init_common(const u8 *digest, u32 digestsize,
 	 *  - DATA_FMT_DIGEST_WITH_ALGO: [<hash algo>] + ':' + '\0' + digest,
 	 *    where <hash algo> is provided if the hash algoritm is not
 	 *    SHA1 or MD5
+	 *  - DATA_FMT_DIGEST_WITH_TYPE_AND_ALGO:
+	 *    <digest type> + ':' + <hash algo> + ':' + '\0' + digest,
+	 *    where <digest type> is either "ima" or "verity"
 	 */
-	u8 buffer[CRYPTO_MAX_ALG_NAME + 2 + IMA_MAX_DIGEST_SIZE] = { 0 };
+	u8 buffer[DIGEST_TYPE_SIZE + CRYPTO_MAX_ALG_NAME + 2 +
+		  IMA_MAX_DIGEST_SIZE] = { 0 };
 	enum data_formats fmt = DATA_FMT_DIGEST;
 	u32 offset = 0;
 
+	if (digest_type) {
+		fmt = DATA_FMT_DIGEST_WITH_TYPE_AND_ALGO;
+		offset += snprintf(buffer, DIGEST_TYPE_SIZE, "%s:",
+				   digest_type);
+	}
+
 	if (hash_algo < HASH_ALGO__LAST) {
-		fmt = DATA_FMT_DIGEST_WITH_ALGO;
-		offset += snprintf(buffer, CRYPTO_MAX_ALG_NAME + 1, "%s",
-				   hash_algo_name[hash_algo]);
+		if (!digest_type)
+			fmt = DATA_FMT_DIGEST_WITH_ALGO;
+		offset += snprintf(buffer + offset, CRYPTO_MAX_ALG_NAME + 1,
+				   "%s", hash_algo_name[hash_algo]);
 		buffer[offset] = ':';
 		offset += 2;
 	}
@@ -320,7 +344,7 @@ int ima_eventdigest_init(struct ima_event_data *event_data,
 	cur_digest = hash.hdr.digest;
 	cur_digestsize = hash.hdr.length;
 out:
-	return ima_eventdigest_init_common(cur_digest, cur_digestsize,
+	return ima_eventdigest_init_common(cur_digest, cur_digestsize, NULL,
 					   HASH_ALGO__LAST, field_data);
 }
 
@@ -341,10 +365,36 @@ int ima_eventdigest_ng_init(struct ima_event_data *event_data,
 
 	hash_algo = event_data->iint->ima_hash->algo;
 out:
-	return ima_eventdigest_init_common(cur_digest, cur_digestsize,
+	return ima_eventdigest_init_common(cur_digest, cur_digestsize, NULL,
 					   hash_algo, field_data);
 }
 
+/*
+ * This function writes the digest of an event (without size limit),
+ * prefixed with the type of the digest: "verity" for an fs-verity file
+ * digest, "ima" for a hash of the file contents.
+ */
+int ima_eventdigest_ngv2_init(struct ima_event_data *event_data,
+			      struct ima_field_data *field_data)
+{
+	u8 *cur_digest = NULL, hash_algo = HASH_ALGO_SHA1;
+	u32 cur_digestsize = 0;
+	const char *digest_type = "ima";
+
+	if (event_data->violation)	/* recording a violation. */
+		goto out;
+
+	cur_digest = event_data->iint->ima_hash->digest;
+	cur_digestsize = event_data->iint->ima_hash->length;
+
+	hash_algo = event_data->iint->ima_hash->algo;
+	if (test_bit(IMA_VERITY_HASH, &event_data->iint->atomic_flags))
+		digest_type = "verity";
+out:
+	return ima_eventdigest_init_common(cur_digest, cur_digestsize,
+					   digest_type, hash_algo, field_data);
+}
+
 /*
  * This function writes the digest of the file which is expected to match the
  * digest contained in the file's appended signature.
@@ -376,7 +426,7 @@ int ima_eventdigest_modsig_init(struct ima_event_data *event_data,
 			return -EINVAL;
 	}
 
-	return ima_eventdigest_init_common(cur_digest, cur_digestsize,
+	return ima_eventdigest_init_common(cur_digest, cur_digestsize, NULL,
 					   hash_algo, field_data);
 }
 
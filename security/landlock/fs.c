@@ -22,6 +22,7 @@
 #include <linux/namei.h>
 #include <linux/path.h>
 #include <linux/rcupdate.h>
+#include <linux/seqlock.h>
 #include <linux/spinlock.h>
 #include <linux/stat.h>
 #include <linux/types.h>
@@ -182,17 +183,17 @@ int landlock_append_fs_rule(struct landlock_ruleset *const ruleset,
 
 static inline u64 unmask_layers(
 		const struct landlock_ruleset *const domain,
-		const struct path *const path, const u32 access_request,
+		const struct dentry *const dentry, const u32 access_request,
 		u64 layer_mask)
 {
 	const struct landlock_rule *rule;
 	const struct inode *inode;
 	size_t i;
 
-	if (d_is_negative(path->dentry))
+	if (d_is_negative(dentry))
 		/* Ignore nonexistent leafs. */
 		return layer_mask;
-	inode = d_backing_inode(path->dentry);
+	inode = d_backing_inode(dentry);
 	rcu_read_lock();
 	rule = landlock_find_rule(domain,
 			rcu_dereference(landlock_inode(inode)->object));
@@ -222,42 +223,92 @@ static inline u64 unmask_layers(
 	return layer_mask;
 }
 
-static int check_access_path(const struct landlock_ruleset *const domain,
-		const struct path *const path, u32 access_request)
+/*
+ * Walks up from @path like check_access_path_ref() but without taking a
+ * reference on each directory, which otherwise makes every check bounce the
+ * refcounts of shared ancestors such as the root directory between CPUs.
+ * Directories within a mount are walked under RCU, and references are only
+ * taken to cross mount points.  Returns -EAGAIN if a concurrent rename may
+ * have misled the walk.
+ */
+static int check_access_path_rcu(const struct landlock_ruleset *const domain,
+		const struct path *const path, const u32 access_request,
+		u64 layer_mask)
 {
-	bool allowed = false;
-	struct path walker_path;
-	u64 layer_mask;
-	size_t i;
-
-	/* Make sure all layers can be checked. */
-	BUILD_BUG_ON(BITS_PER_TYPE(layer_mask) < LANDLOCK_MAX_NUM_LAYERS);
+	struct path walker_path = *path;
+	struct dentry *dentry;
+	unsigned int seq;
+	int err;
 
-	if (!access_request)
-		return 0;
-	if (WARN_ON_ONCE(!domain || !path))
-		return 0;
+	path_get(&walker_path);
+	dentry = walker_path.dentry;
+	rcu_read_lock();
+	seq = read_seqbegin(&rename_lock);
+	while (true) {
+		layer_mask = unmask_layers(domain, dentry, access_request,
+				layer_mask);
+		if (layer_mask == 0) {
+			/* Stops when a rule from each layer grants access. */
+			err = 0;
+			break;
+		}
+		if (read_seqretry(&rename_lock, seq)) {
+			err = -EAGAIN;
+			break;
+		}
+		if (dentry == walker_path.mnt->mnt_root) {
+			/* Pinned by walker_path.mnt, so safe to get. */
+			dget(dentry);
+			rcu_read_unlock();
+			dput(walker_path.dentry);
+			walker_path.dentry = dentry;
+			do {
+				if (!follow_up(&walker_path)) {
+					/*
+					 * Stops at the real root.  Denies
+					 * access because not all layers have
+					 * granted access.
+					 */
+					err = -EACCES;
+					goto out_put;
+				}
+				/* Ignores hidden mount points. */
+			} while (walker_path.dentry ==
+					walker_path.mnt->mnt_root);
+			dentry = walker_path.dentry;
+			rcu_read_lock();
+			seq = read_seqbegin(&rename_lock);
+		}
+		if (unlikely(IS_ROOT(dentry))) {
+			/*
+			 * Stops at disconnected root directories.  Only allows
+			 * access to internal filesystems (e.g. nsfs, which is
+			 * reachable through /proc/<pid>/ns/<namespace>).
+			 */
+			err = (walker_path.mnt->mnt_flags & MNT_INTERNAL) ?
+				0 : -EACCES;
+			break;
+		}
+		dentry = READ_ONCE(dentry->d_parent);
+	}
 	/*
-	 * Allows access to pseudo filesystems that will never be mountable
-	 * (e.g. sockfs, pipefs), but can still be reachable through
-	 * /proc/<pid>/fd/<file-descriptor> .
+	 * The result may depend on the last d_parent steps, which are only
+	 * known to be right if no rename happened since the walk started.
 	 */
-	if ((path->dentry->d_sb->s_flags & SB_NOUSER) ||
-			(d_is_positive(path->dentry) &&
-			 unlikely(IS_PRIVATE(d_backing_inode(path->dentry)))))
-		return 0;
-	if (WARN_ON_ONCE(domain->num_layers < 1))
-		return -EACCES;
+	if (err != -EAGAIN && read_seqretry(&rename_lock, seq))
+		err = -EAGAIN;
+	rcu_read_unlock();
+out_put:
+	path_put(&walker_path);
+	return err;
+}
 
-	/* Saves all layers handling a subset of requested accesses. */
-	layer_mask = 0;
-	for (i = 0; i < domain->num_layers; i++) {
-		if (domain->fs_access_masks[i] & access_request)
-			layer_mask |= BIT_ULL(i);
-	}
-	/* An access request not handled by the domain is allowed. */
-	if (layer_mask == 0)
-		return 0;
+static int check_access_path_ref(const struct landlock_ruleset *const domain,
+		const struct path *const path, const u32 access_request,
+		u64 layer_mask)
+{
+	bool allowed = false;
+	struct path walker_path;
 
 	walker_path = *path;
 	path_get(&walker_path);
@@ -268,7 +319,7 @@ static int check_access_path(const struct landlock_ruleset *const domain,
 	while (true) {
 		struct dentry *parent_dentry;
 
-		layer_mask = unmask_layers(domain, &walker_path,
+		layer_mask = unmask_layers(domain, walker_path.dentry,
 				access_request, layer_mask);
 		if (layer_mask == 0) {
 			/* Stops when a rule from each layer grants access. */
@@ -307,6 +358,48 @@ static int check_access_path(const struct landlock_ruleset *const domain,
 	return allowed ? 0 : -EACCES;
 }
 
+static int check_access_path(const struct landlock_ruleset *const domain,
+		const struct path *const path, u32 access_request)
+{
+	u64 layer_mask;
+	size_t i;
+	int err;
+
+	/* Make sure all layers can be checked. */
+	BUILD_BUG_ON(BITS_PER_TYPE(layer_mask) < LANDLOCK_MAX_NUM_LAYERS);
+
+	if (!access_request)
+		return 0;
+	if (WARN_ON_ONCE(!domain || !path))
+		return 0;
+	/*
+	 * Allows access to pseudo filesystems that will never be mountable
+	 * (e.g. sockfs, pipefs), but can still be reachable through
+	 * /proc/<pid>/fd/<file-descriptor> .
+	 */
+	if ((path->dentry->d_sb->s_flags & SB_NOUSER) ||
+			(d_is_positive(path->dentry) &&
+			 unlikely(IS_PRIVATE(d_backing_inode(path->dentry)))))
+		return 0;
+	if (WARN_ON_ONCE(domain->num_layers < 1))
+		return -EACCES;
+
+	/* Saves all layers handling a subset of requested accesses. */
+	layer_mask = 0;
+	for (i = 0; i < domain->num_layers; i++) {
+		if (domain->fs_access_masks[i] & access_request)
+			layer_mask |= BIT_ULL(i);
+	}
+	/* An access request not handled by the domain is allowed. */
+	if (layer_mask == 0)
+		return 0;
+
+	err = check_access_path_rcu(domain, path, access_request, layer_mask);
+	if (err != -EAGAIN)
+		return err;
+	return check_access_path_ref(domain, path, access_request, layer_mask);
+}
+
 static inline int current_check_access_path(const struct path *const path,
 		const u32 access_request)
 {
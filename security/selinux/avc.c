@@ -38,10 +38,14 @@
 #define AVC_DEF_CACHE_THRESHOLD		512
 #define AVC_CACHE_RECLAIM		16
 
+#define AVC_FRONT_SLOTS			16
+
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
+#define avc_class_misses_incr(tclass)	this_cpu_inc(avc_class_misses[tclass])
 #else
 #define avc_cache_stats_incr(field)	do {} while (0)
+#define avc_class_misses_incr(tclass)	do {} while (0)
 #endif
 
 struct avc_entry {
@@ -82,8 +86,32 @@ struct avc_callback_node {
 	struct avc_callback_node *next;
 };
 
+/*
+ * Small per-cpu direct mapped cache of the last decisions looked up in the
+ * AVC, checked before the hash table and without any atomics.  Any change
+ * to the decision of a cached node bumps avc_front_gen, which invalidates
+ * all the front entries filled before it.  Only used from task context so
+ * that disabling preemption is enough to own the cpu's slots.
+ */
+struct avc_front_entry {
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	unsigned int		gen;
+	struct av_decision	avd;
+};
+
+struct avc_front_cache {
+	struct avc_front_entry	slots[AVC_FRONT_SLOTS];
+};
+
+static DEFINE_PER_CPU(struct avc_front_cache, avc_front_cache);
+static atomic_t avc_front_gen = ATOMIC_INIT(1);
+
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 DEFINE_PER_CPU(struct avc_cache_stats, avc_cache_stats) = { 0 };
+static DEFINE_PER_CPU(unsigned int [ARRAY_SIZE(secclass_map)],
+		      avc_class_misses);
 #endif
 
 struct selinux_avc {
@@ -180,6 +208,28 @@ int avc_get_hash_stats(struct selinux_avc *avc, char *page)
 			 slots_used, AVC_CACHE_SLOTS, max_chain_len);
 }
 
+#ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
+int avc_get_class_miss_stats(struct selinux_avc *avc, char *page)
+{
+	unsigned int tclass, misses;
+	int cpu, len = 0;
+
+	len += scnprintf(page, PAGE_SIZE, "class misses\n");
+	for (tclass = 1; tclass < ARRAY_SIZE(secclass_map); tclass++) {
+		misses = 0;
+		for_each_possible_cpu(cpu)
+			misses += per_cpu(avc_class_misses, cpu)[tclass];
+		if (!misses)
+			continue;
+
+		len += scnprintf(page + len, PAGE_SIZE - len, "%s %u\n",
+				 secclass_map[tclass - 1].name, misses);
+	}
+
+	return len;
+}
+#endif
+
 /*
  * using a linked list for extended_perms_decision lookup because the list is
  * always small. i.e. less than 5, typically 1
@@ -453,12 +503,19 @@ static void avc_node_kill(struct selinux_avc *avc, struct avc_node *node)
 	atomic_dec(&avc->avc_cache.active_nodes);
 }
 
+static inline void avc_front_invalidate(void)
+{
+	smp_mb__before_atomic();
+	atomic_inc(&avc_front_gen);
+}
+
 static void avc_node_replace(struct selinux_avc *avc,
 			     struct avc_node *new, struct avc_node *old)
 {
 	hlist_replace_rcu(&old->list, &new->list);
 	call_rcu(&old->rhead, avc_node_free);
 	atomic_dec(&avc->avc_cache.active_nodes);
+	avc_front_invalidate();
 }
 
 static inline int avc_reclaim_node(struct selinux_avc *avc)
@@ -568,9 +625,66 @@ static struct avc_node *avc_lookup(struct selinux_avc *avc,
 		return node;
 
 	avc_cache_stats_incr(misses);
+	if (tclass < ARRAY_SIZE(secclass_map))
+		avc_class_misses_incr(tclass);
 	return NULL;
 }
 
+static inline struct avc_front_entry *avc_front_slot(u32 ssid, u32 tsid,
+						     u16 tclass)
+{
+	return &this_cpu_ptr(&avc_front_cache)->slots[
+		avc_hash(ssid, tsid, tclass) & (AVC_FRONT_SLOTS - 1)];
+}
+
+/*
+ * Look up the decision for (@ssid, @tsid, @tclass) in this cpu's front
+ * cache, copying it to @avd on a hit.
+ */
+static bool avc_front_lookup(u32 ssid, u32 tsid, u16 tclass,
+			     struct av_decision *avd)
+{
+	struct avc_front_entry *fe;
+	bool hit = false;
+
+	if (!in_task())
+		return false;
+
+	preempt_disable();
+	fe = avc_front_slot(ssid, tsid, tclass);
+	if (fe->ssid == ssid && fe->tsid == tsid && fe->tclass == tclass &&
+	    fe->gen == atomic_read(&avc_front_gen)) {
+		memcpy(avd, &fe->avd, sizeof(*avd));
+		avc_cache_stats_incr(lookups);
+		hit = true;
+	}
+	preempt_enable();
+
+	return hit;
+}
+
+/*
+ * Remember @avd in this cpu's front cache.  @gen is avc_front_gen as read
+ * before looking up the AVC node @avd was copied from.
+ */
+static void avc_front_fill(u32 ssid, u32 tsid, u16 tclass,
+			   struct av_decision *avd, unsigned int gen)
+{
+	struct avc_front_entry *fe;
+
+	if (!in_task())
+		return;
+
+	preempt_disable();
+	fe = avc_front_slot(ssid, tsid, tclass);
+	fe->ssid = ssid;
+	fe->tsid = tsid;
+	fe->tclass = tclass;
+	fe->gen = gen;
+	memcpy(&fe->avd, avd, sizeof(fe->avd));
+	preempt_enable();
+}
+
 static int avc_latest_notif_update(struct selinux_avc *avc,
 				   int seqno, int is_insert)
 {
@@ -962,6 +1076,8 @@ static void avc_flush(struct selinux_avc *avc)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+
+	avc_front_invalidate();
 }
 
 /**
@@ -1141,6 +1257,7 @@ inline int avc_has_perm_noaudit(struct selinux_state *state,
 {
 	struct avc_node *node;
 	struct avc_xperms_node xp_node;
+	unsigned int gen;
 	int rc = 0;
 	u32 denied;
 
@@ -1149,12 +1266,21 @@ inline int avc_has_perm_noaudit(struct selinux_state *state,
 
 	rcu_read_lock();
 
+	if (avc_front_lookup(ssid, tsid, tclass, avd))
+		goto check;
+
+	gen = atomic_read(&avc_front_gen);
+	smp_rmb();
+
 	node = avc_lookup(state->avc, ssid, tsid, tclass);
-	if (unlikely(!node))
+	if (unlikely(!node)) {
 		node = avc_compute_av(state, ssid, tsid, tclass, avd, &xp_node);
-	else
+	} else {
 		memcpy(avd, &node->ae.avd, sizeof(*avd));
+		avc_front_fill(ssid, tsid, tclass, avd, gen);
+	}
 
+check:
 	denied = requested & ~(avd->allowed);
 	if (unlikely(denied))
 		rc = avc_denied(state, ssid, tsid, tclass, requested, 0, 0,
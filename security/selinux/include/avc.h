@@ -183,6 +183,7 @@ int avc_add_callback(int (*callback)(u32 event), u32 events);
 /* Exported to selinuxfs */
 struct selinux_avc;
 int avc_get_hash_stats(struct selinux_avc *avc, char *page);
+int avc_get_class_miss_stats(struct selinux_avc *avc, char *page);
 unsigned int avc_get_cache_threshold(struct selinux_avc *avc);
 void avc_set_cache_threshold(struct selinux_avc *avc,
 			     unsigned int cache_threshold);
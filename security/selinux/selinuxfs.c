@@ -1608,6 +1608,31 @@ static const struct file_operations sel_avc_hash_stats_ops = {
 };
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
+static ssize_t sel_read_avc_class_misses(struct file *filp, char __user *buf,
+					 size_t count, loff_t *ppos)
+{
+	struct selinux_fs_info *fsi = file_inode(filp)->i_sb->s_fs_info;
+	struct selinux_state *state = fsi->state;
+	char *page;
+	ssize_t length;
+
+	page = (char *)__get_free_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	length = avc_get_class_miss_stats(state->avc, page);
+	if (length >= 0)
+		length = simple_read_from_buffer(buf, count, ppos, page, length);
+	free_page((unsigned long)page);
+
+	return length;
+}
+
+static const struct file_operations sel_avc_class_misses_ops = {
+	.read		= sel_read_avc_class_misses,
+	.llseek		= generic_file_llseek,
+};
+
 static struct avc_cache_stats *sel_avc_get_stat_idx(loff_t *idx)
 {
 	int cpu;
@@ -1689,6 +1714,7 @@ static int sel_make_avc_files(struct dentry *dir)
 		{ "hash_stats", &sel_avc_hash_stats_ops, S_IRUGO },
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 		{ "cache_stats", &sel_avc_cache_stats_ops, S_IRUGO },
+		{ "class_misses", &sel_avc_class_misses_ops, S_IRUGO },
 #endif
 	};
 
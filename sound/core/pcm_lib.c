@@ -20,15 +20,13 @@
 
 #include "pcm_local.h"
 
-#ifdef CONFIG_SND_PCM_XRUN_DEBUG
+/*
+ * The tracepoints cost a static branch each while disabled, so they are
+ * always built in: they allow correlating the period updates and the
+ * XRUNs with other events of the system without a debug build.
+ */
 #define CREATE_TRACE_POINTS
 #include "pcm_trace.h"
-#else
-#define trace_hwptr(substream, pos, in_interrupt)
-#define trace_xrun(substream)
-#define trace_hw_ptr_error(substream, reason)
-#define trace_applptr(substream, prev, curr)
-#endif
 
 static int fill_silence_frames(struct snd_pcm_substream *substream,
 			       snd_pcm_uframes_t off, snd_pcm_uframes_t frames);
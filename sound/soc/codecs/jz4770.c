@@ -213,11 +213,35 @@ static int jz4770_codec_set_bias_level(struct snd_soc_component *codec,
 	return 0;
 }
 
+/* Indexed by the value of the FREQ field of the FCR registers */
+static const unsigned int jz4770_codec_sample_rates[] = {
+	96000, 48000, 44100, 32000,
+	24000, 22050, 16000, 12000,
+	11025, 9600, 8000,
+};
+
+static const struct snd_pcm_hw_constraint_list jz4770_codec_rate_constraint = {
+	.count = ARRAY_SIZE(jz4770_codec_sample_rates),
+	.list = jz4770_codec_sample_rates,
+};
+
 static int jz4770_codec_startup(struct snd_pcm_substream *substream,
 				struct snd_soc_dai *dai)
 {
 	struct snd_soc_component *codec = dai->component;
 	struct snd_soc_dapm_context *dapm = snd_soc_component_get_dapm(codec);
+	int ret;
+
+	/*
+	 * SNDRV_PCM_RATE_8000_96000 includes 64 kHz and 88.2 kHz, which the
+	 * codec can't do; without this, hw_params would fail for them instead
+	 * of having the application pick a supported rate.
+	 */
+	ret = snd_pcm_hw_constraint_list(substream->runtime, 0,
+					 SNDRV_PCM_HW_PARAM_RATE,
+					 &jz4770_codec_rate_constraint);
+	if (ret < 0)
+		return ret;
 
 	/*
 	 * SYSCLK output from the codec to the AIC is required to keep the
@@ -683,12 +707,6 @@ static const struct snd_soc_component_driver jz4770_codec_soc_codec_dev = {
 	.use_pmdown_time	= 1,
 };
 
-static const unsigned int jz4770_codec_sample_rates[] = {
-	96000, 48000, 44100, 32000,
-	24000, 22050, 16000, 12000,
-	11025, 9600, 8000,
-};
-
 static int jz4770_codec_hw_params(struct snd_pcm_substream *substream,
 				  struct snd_pcm_hw_params *params,
 				  struct snd_soc_dai *dai)
@@ -8,6 +8,7 @@
 #include <linux/of.h>
 #include <linux/of_device.h>
 #include <linux/kernel.h>
+#include <linux/log2.h>
 #include <linux/module.h>
 #include <linux/platform_device.h>
 #include <linux/slab.h>
@@ -76,11 +77,19 @@
 #define JZ_AIC_I2S_STATUS_BUSY BIT(2)
 
 #define JZ_AIC_CLK_DIV_MASK 0xf
+#define JZ_AIC_CLK_DIV_MAX 16
 #define I2SDIV_DV_SHIFT 0
 #define I2SDIV_DV_MASK (0xf << I2SDIV_DV_SHIFT)
 #define I2SDIV_IDV_SHIFT 8
 #define I2SDIV_IDV_MASK (0xf << I2SDIV_IDV_SHIFT)
 
+#define JZ_AIC_DEFAULT_BURST 16
+
+static unsigned int fifo_burst = JZ_AIC_DEFAULT_BURST;
+module_param(fifo_burst, uint, 0444);
+MODULE_PARM_DESC(fifo_burst, "FIFO trigger level and DMA burst size, in samples (2, 4, 8 or 16). "
+		 "Lower values reduce the latency, at the cost of more DMA requests.");
+
 enum jz47xx_i2s_version {
 	JZ_I2S_JZ4740,
 	JZ_I2S_JZ4760,
@@ -105,6 +114,8 @@ struct jz4740_i2s {
 	struct snd_dmaengine_dai_dma_data capture_dma_data;
 
 	const struct i2s_soc_info *soc_info;
+	unsigned int burst;
+	unsigned int sysclk; /* set by the machine driver, or 0 */
 };
 
 static inline uint32_t jz4740_i2s_read(const struct jz4740_i2s *i2s,
@@ -246,18 +257,75 @@ static int jz4740_i2s_set_fmt(struct snd_soc_dai *dai, unsigned int fmt)
 	return 0;
 }
 
+/*
+ * Pick the rate of the I2S clock that gives the bit clock closest to
+ * 64 * @rate, trying all the dividers of the AIC. The CGU may then switch
+ * the I2S clock to the PLL that suits this rate best.
+ */
+static int jz4740_i2s_set_clk_rate(struct snd_soc_dai *dai, unsigned int rate)
+{
+	struct jz4740_i2s *i2s = snd_soc_dai_get_drvdata(dai);
+	unsigned long target, delta, best_delta = ULONG_MAX, best_rate = 0;
+	unsigned int div;
+	long clk_rate;
+	int ret;
+
+	for (div = JZ_AIC_CLK_DIV_MAX; div > 0 && best_delta; div--) {
+		target = 64UL * rate * div;
+		clk_rate = clk_round_rate(i2s->clk_i2s, target);
+		if (clk_rate <= 0)
+			continue;
+
+		/* Compare the errors on the bit clock */
+		delta = abs(clk_rate - (long)target) / div;
+		if (delta < best_delta) {
+			best_delta = delta;
+			best_rate = clk_rate;
+		}
+	}
+
+	if (!best_rate)
+		return -EINVAL;
+
+	if (best_rate == clk_get_rate(i2s->clk_i2s))
+		return 0;
+
+	/* The mux of the I2S clock can only be switched while it is gated */
+	clk_disable_unprepare(i2s->clk_i2s);
+	ret = clk_set_rate(i2s->clk_i2s, best_rate);
+	if (ret)
+		dev_warn(dai->dev, "Unable to set I2S clock to %lu Hz: %d\n",
+			 best_rate, ret);
+
+	return clk_prepare_enable(i2s->clk_i2s);
+}
+
 static int jz4740_i2s_hw_params(struct snd_pcm_substream *substream,
 	struct snd_pcm_hw_params *params, struct snd_soc_dai *dai)
 {
 	struct jz4740_i2s *i2s = snd_soc_dai_get_drvdata(dai);
+	unsigned int rate = params_rate(params);
 	unsigned int sample_size;
 	uint32_t ctrl, div_reg;
-	int div;
+	int div, ret;
 
 	ctrl = jz4740_i2s_read(i2s, JZ_REG_AIC_CTRL);
 
+	/*
+	 * When the AIC generates the bit clock, retune the I2S clock for the
+	 * new rate, unless the machine driver fixed it or the other stream
+	 * is already running from it.
+	 */
+	if ((jz4740_i2s_read(i2s, JZ_REG_AIC_CONF) & JZ_AIC_CONF_BIT_CLK_MASTER) &&
+	    !i2s->sysclk && snd_soc_dai_active(dai) <= 1) {
+		ret = jz4740_i2s_set_clk_rate(dai, rate);
+		if (ret)
+			return ret;
+	}
+
 	div_reg = jz4740_i2s_read(i2s, JZ_REG_AIC_CLK_DIV);
-	div = clk_get_rate(i2s->clk_i2s) / (64 * params_rate(params));
+	div = DIV_ROUND_CLOSEST(clk_get_rate(i2s->clk_i2s), 64 * rate);
+	div = clamp(div, 1, JZ_AIC_CLK_DIV_MAX);
 
 	switch (params_format(params)) {
 	case SNDRV_PCM_FORMAT_S8:
@@ -325,6 +393,9 @@ static int jz4740_i2s_set_sysclk(struct snd_soc_dai *dai, int clk_id,
 	}
 	clk_put(parent);
 
+	if (!ret)
+		i2s->sysclk = freq;
+
 	return ret;
 }
 
@@ -377,18 +448,19 @@ static void jz4740_i2c_init_pcm_config(struct jz4740_i2s *i2s)
 
 	/* Playback */
 	dma_data = &i2s->playback_dma_data;
-	dma_data->maxburst = 16;
+	dma_data->maxburst = i2s->burst;
 	dma_data->addr = i2s->phys_base + JZ_REG_AIC_FIFO;
 
 	/* Capture */
 	dma_data = &i2s->capture_dma_data;
-	dma_data->maxburst = 16;
+	dma_data->maxburst = i2s->burst;
 	dma_data->addr = i2s->phys_base + JZ_REG_AIC_FIFO;
 }
 
 static int jz4740_i2s_dai_probe(struct snd_soc_dai *dai)
 {
 	struct jz4740_i2s *i2s = snd_soc_dai_get_drvdata(dai);
+	unsigned int rx_thres, tx_thres;
 	uint32_t conf;
 	int ret;
 
@@ -400,15 +472,24 @@ static int jz4740_i2s_dai_probe(struct snd_soc_dai *dai)
 	snd_soc_dai_init_dma_data(dai, &i2s->playback_dma_data,
 		&i2s->capture_dma_data);
 
+	/*
+	 * The thresholds are in units of two samples. A DMA request is raised
+	 * when the TX FIFO holds no more than (tx_thres * 2) samples, or when
+	 * the RX FIFO holds at least ((rx_thres + 1) * 2) samples; in both
+	 * cases, exactly one burst can then be transferred.
+	 */
+	tx_thres = i2s->burst / 2;
+	rx_thres = i2s->burst / 2 - 1;
+
 	if (i2s->soc_info->version >= JZ_I2S_JZ4760) {
-		conf = (7 << JZ4760_AIC_CONF_FIFO_RX_THRESHOLD_OFFSET) |
-			(8 << JZ4760_AIC_CONF_FIFO_TX_THRESHOLD_OFFSET) |
+		conf = (rx_thres << JZ4760_AIC_CONF_FIFO_RX_THRESHOLD_OFFSET) |
+			(tx_thres << JZ4760_AIC_CONF_FIFO_TX_THRESHOLD_OFFSET) |
 			JZ_AIC_CONF_OVERFLOW_PLAY_LAST |
 			JZ_AIC_CONF_I2S |
 			JZ_AIC_CONF_INTERNAL_CODEC;
 	} else {
-		conf = (7 << JZ_AIC_CONF_FIFO_RX_THRESHOLD_OFFSET) |
-			(8 << JZ_AIC_CONF_FIFO_TX_THRESHOLD_OFFSET) |
+		conf = (rx_thres << JZ_AIC_CONF_FIFO_RX_THRESHOLD_OFFSET) |
+			(tx_thres << JZ_AIC_CONF_FIFO_TX_THRESHOLD_OFFSET) |
 			JZ_AIC_CONF_OVERFLOW_PLAY_LAST |
 			JZ_AIC_CONF_I2S |
 			JZ_AIC_CONF_INTERNAL_CODEC;
@@ -497,6 +578,37 @@ static const struct i2s_soc_info jz4780_i2s_soc_info = {
 	.dai = &jz4770_i2s_dai,
 };
 
+/*
+ * Allow periods as short as 16 stereo frames. The DMA controller gets an
+ * interrupt per period, and can't chain more than 256 cyclic descriptors.
+ *
+ * Without period wakeups the descriptors stay linked and the controller
+ * runs without any interrupt; the position is still read from the DMA
+ * transfer count at burst granularity, so that a sound server can use a
+ * large buffer and its own timer.
+ */
+static const struct snd_pcm_hardware jz4740_i2s_pcm_hardware = {
+	.info = SNDRV_PCM_INFO_MMAP |
+		SNDRV_PCM_INFO_MMAP_VALID |
+		SNDRV_PCM_INFO_INTERLEAVED |
+		SNDRV_PCM_INFO_BLOCK_TRANSFER |
+		SNDRV_PCM_INFO_PAUSE |
+		SNDRV_PCM_INFO_RESUME |
+		SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
+	.formats = JZ4740_I2S_FMTS,
+	.period_bytes_min = 64,
+	.period_bytes_max = 64 * 1024,
+	.periods_min = 2,
+	.periods_max = 256,
+	.buffer_bytes_max = 128 * 1024,
+};
+
+static const struct snd_dmaengine_pcm_config jz4740_i2s_pcm_config = {
+	.prepare_slave_config = snd_dmaengine_pcm_prepare_slave_config,
+	.pcm_hardware = &jz4740_i2s_pcm_hardware,
+	.prealloc_buffer_size = 128 * 1024,
+};
+
 static const struct snd_soc_component_driver jz4740_i2s_component = {
 	.name		= "jz4740-i2s",
 	.suspend	= jz4740_i2s_suspend,
@@ -525,6 +637,14 @@ static int jz4740_i2s_dev_probe(struct platform_device *pdev)
 
 	i2s->soc_info = device_get_match_data(dev);
 
+	if (fifo_burst < 2 || fifo_burst > 16 || !is_power_of_2(fifo_burst)) {
+		dev_warn(dev, "Invalid FIFO burst %u, using %u\n",
+			 fifo_burst, JZ_AIC_DEFAULT_BURST);
+		i2s->burst = JZ_AIC_DEFAULT_BURST;
+	} else {
+		i2s->burst = fifo_burst;
+	}
+
 	mem = platform_get_resource(pdev, IORESOURCE_MEM, 0);
 	i2s->base = devm_ioremap_resource(dev, mem);
 	if (IS_ERR(i2s->base))
@@ -547,7 +667,7 @@ static int jz4740_i2s_dev_probe(struct platform_device *pdev)
 	if (ret)
 		return ret;
 
-	return devm_snd_dmaengine_pcm_register(dev, NULL,
+	return devm_snd_dmaengine_pcm_register(dev, &jz4740_i2s_pcm_config,
 		SND_DMAENGINE_PCM_FLAG_COMPAT);
 }
 
@@ -1942,6 +1942,24 @@ static bool dapm_idle_bias_off(struct snd_soc_dapm_context *dapm)
 	return false;
 }
 
+/*
+ * Whether a power update would change nothing: no widget is dirty and every
+ * context is still at the bias level the last update targeted.
+ */
+static bool dapm_power_unchanged(struct snd_soc_card *card)
+{
+	struct snd_soc_dapm_context *d;
+
+	if (!list_empty(&card->dapm_dirty))
+		return false;
+
+	for_each_card_dapms(card, d)
+		if (d->bias_level != d->target_bias_level)
+			return false;
+
+	return true;
+}
+
 /*
  * Scan each dapm widget for complete audio path.
  * A complete path is a route that has valid endpoints i.e.:-
@@ -1965,6 +1983,16 @@ static int dapm_power_widgets(struct snd_soc_card *card, int event)
 
 	trace_snd_soc_dapm_start(card);
 
+	/*
+	 * A control change which didn't connect or disconnect any path, such
+	 * as a volume change, leaves no widget dirty: no widget power can
+	 * change, so only the register update remains to be done.
+	 */
+	if (event == SND_SOC_DAPM_STREAM_NOP && dapm_power_unchanged(card)) {
+		dapm_widget_update(card);
+		goto notify;
+	}
+
 	for_each_card_dapms(card, d) {
 		if (dapm_idle_bias_off(d))
 			d->target_bias_level = SND_SOC_BIAS_OFF;
@@ -2074,6 +2102,7 @@ static int dapm_power_widgets(struct snd_soc_card *card, int event)
 	/* Run card bias changes at last */
 	dapm_post_sequence_async(&card->dapm, 0);
 
+notify:
 	/* do we need to notify any clients that DAPM event is complete */
 	for_each_card_dapms(card, d) {
 		if (!d->component)
@@ -0,0 +1,12 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _TOOLS_ASM_MIPS_ASM_OFFSETS_H
+#define _TOOLS_ASM_MIPS_ASM_OFFSETS_H
+
+/*
+ * Only the fault fixups of arch/mips/lib/memcpy.S and memset.S use these,
+ * and perf bench never makes them fault.
+ */
+#define TI_TASK		0
+#define THREAD_BUADDR	0
+
+#endif /* _TOOLS_ASM_MIPS_ASM_OFFSETS_H */
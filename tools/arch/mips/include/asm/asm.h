@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _TOOLS_ASM_MIPS_ASM_H
+#define _TOOLS_ASM_MIPS_ASM_H
+
+/*
+ * The subset of arch/mips/include/asm/asm.h needed to build
+ * arch/mips/lib/memcpy.S and memset.S for perf bench.
+ */
+
+#define LEAF(symbol)					\
+		.globl	symbol;				\
+		.align	2;				\
+		.type	symbol, @function;		\
+		.ent	symbol, 0;			\
+symbol:		.frame	sp, 0, ra;			\
+		.insn
+
+#define END(function)					\
+		.end	function;			\
+		.size	function, .-function
+
+#define FEXPORT(symbol)					\
+		.globl	symbol;				\
+		.type	symbol, @function;		\
+symbol:		.insn
+
+/* No R10000 speculation barriers in user space */
+#define R10KCBARRIER(addr)
+
+/* No EVA in user space, prefetching is always done from the kernel view */
+#define kernel_pref(hint, addr)	pref	hint, addr
+#define user_pref(hint, addr)	pref	hint, addr
+
+#if _MIPS_SZLONG == 32
+#define LONG_ADDU	addu
+#define LONG_SUBU	subu
+#define LONG_L		lw
+#define LONG_S		sw
+#define LONG_SLL	sll
+#define LONG_SRL	srl
+#define LONGSIZE	4
+#define LONGMASK	3
+#define LONGLOG		2
+#else
+#define LONG_ADDU	daddu
+#define LONG_SUBU	dsubu
+#define LONG_L		ld
+#define LONG_S		sd
+#define LONG_SLL	dsll
+#define LONG_SRL	dsrl
+#define LONGSIZE	8
+#define LONGMASK	7
+#define LONGLOG		3
+#endif
+
+#if _MIPS_SZPTR == 32
+#define PTR_ADDU	addu
+#define PTR_ADDIU	addiu
+#define PTR_SUBU	subu
+#define PTR_L		lw
+#define PTR_LA		la
+#define PTR		.word
+#else
+#define PTR_ADDU	daddu
+#define PTR_ADDIU	daddiu
+#define PTR_SUBU	dsubu
+#define PTR_L		ld
+#define PTR_LA		dla
+#define PTR		.dword
+#endif
+
+#endif /* _TOOLS_ASM_MIPS_ASM_H */
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _TOOLS_ASM_MIPS_REGDEF_H
+#define _TOOLS_ASM_MIPS_REGDEF_H
+
+/*
+ * Symbolic register names, as in arch/mips/include/asm/regdef.h, for
+ * building arch/mips/lib/memcpy.S and memset.S for perf bench.
+ */
+
+#define zero	$0
+#define AT	$1
+#define v0	$2
+#define v1	$3
+#define a0	$4
+#define a1	$5
+#define a2	$6
+#define a3	$7
+#if _MIPS_SIM == _ABIO32
+#define t0	$8
+#define t1	$9
+#define t2	$10
+#define t3	$11
+#define t4	$12
+#define t5	$13
+#define t6	$14
+#define t7	$15
+#else
+#define a4	$8
+#define a5	$9
+#define a6	$10
+#define a7	$11
+#define t0	$12
+#define t1	$13
+#define t2	$14
+#define t3	$15
+#endif
+#define s0	$16
+#define s1	$17
+#define s2	$18
+#define s3	$19
+#define s4	$20
+#define s5	$21
+#define s6	$22
+#define s7	$23
+#define t8	$24
+#define t9	$25
+#define k0	$26
+#define k1	$27
+#define gp	$28
+#define sp	$29
+#define fp	$30
+#define s8	$30
+#define ra	$31
+
+#endif /* _TOOLS_ASM_MIPS_REGDEF_H */
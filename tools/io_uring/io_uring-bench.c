@@ -28,11 +28,13 @@
 #include <string.h>
 #include <pthread.h>
 #include <sched.h>
+#include <time.h>
 
 #include "liburing.h"
 #include "barrier.h"
 
 #define min(a, b)		((a < b) ? (a) : (b))
+#define ARRAY_SIZE(x)		(sizeof(x) / sizeof((x)[0]))
 
 struct io_sq_ring {
 	unsigned *head;
@@ -60,15 +62,37 @@ struct io_cq_ring {
 
 #define MAX_FDS			16
 
+/*
+ * Completion latencies are kept in a log-linear histogram, in usecs: values
+ * below LAT_SUB have a bucket each, every power of two above is split into
+ * LAT_SUB buckets.
+ */
+#define LAT_SUB_BITS		4
+#define LAT_SUB			(1U << LAT_SUB_BITS)
+#define LAT_NR			(LAT_SUB * 32)
+
 static unsigned sq_ring_mask, cq_ring_mask;
 
 struct file {
 	unsigned long max_blocks;
+	unsigned long seq_block;
 	unsigned pending_ios;
 	int real_fd;
 	int fixed_fd;
 };
 
+/*
+ * One per IO in flight, with its own buffer. Units are taken from the free
+ * list when an IO is queued and handed back when it is reaped, as the SQ
+ * ring entries are reused as soon as the kernel has consumed them.
+ */
+struct io_unit {
+	struct file *file;
+	unsigned long long issue_time;
+	unsigned buf_index;
+	int expected_res;
+};
+
 struct submitter {
 	pthread_t thread;
 	int ring_fd;
@@ -76,6 +100,9 @@ struct submitter {
 	struct io_sq_ring sq_ring;
 	struct io_uring_sqe *sqes;
 	struct iovec iovecs[DEPTH];
+	struct io_unit ios[DEPTH];
+	struct io_unit *free_ios[DEPTH];
+	unsigned nr_free_ios;
 	struct io_cq_ring cq_ring;
 	int inflight;
 	unsigned long reaps;
@@ -88,6 +115,10 @@ struct submitter {
 	struct file files[MAX_FDS];
 	unsigned nr_files;
 	unsigned cur_file;
+
+	unsigned long lat_hist[LAT_NR];
+	unsigned long lat_samples;
+	unsigned long long lat_max;
 };
 
 static struct submitter submitters[1];
@@ -104,6 +135,73 @@ static int sq_thread_poll = 0;	/* use kernel submission/poller thread */
 static int sq_thread_cpu = -1;	/* pin above thread to this CPU */
 static int do_nop = 0;		/* no-op SQ ring commands */
 
+/*
+ * Workload profiles, picked with -p. "random" is the default random read
+ * test, the others mimic what handheld devices do to SD cards and eMMC:
+ *
+ * mixed:    small random reads, such as from an emulator ROM, with a
+ *           sequential stream mixed in, such as music being played
+ * save:     small random writes, each followed by an fsync, like saving a
+ *           game. This overwrites the file or device!
+ * squashfs: random reads of whole compressed blocks of a squashfs image
+ *
+ * The storage these target doesn't support polling, so the handheld
+ * profiles use interrupt driven IO.
+ */
+struct profile {
+	const char *name;
+	unsigned bs;		/* size of each IO */
+	unsigned seq_pct;	/* percentage of sequential stream reads */
+	int write_fsync;	/* random writes, each followed by an fsync */
+	int polled;
+	int buffered;
+};
+
+static const struct profile profiles[] = {
+	{ .name = "random",   .bs = BS,        .polled = 1, },
+	{ .name = "mixed",    .bs = BS,        .seq_pct = 25, },
+	{ .name = "save",     .bs = BS,        .write_fsync = 1, .buffered = 1, },
+	{ .name = "squashfs", .bs = 128 * 1024, },
+};
+
+static const struct profile *profile = &profiles[0];
+static unsigned bs = BS;
+
+static unsigned long long now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static unsigned lat_index(unsigned long long usec)
+{
+	unsigned msb, index;
+
+	if (usec < LAT_SUB)
+		return usec;
+
+	msb = 63 - __builtin_clzll(usec);
+	index = (msb - LAT_SUB_BITS + 1) * LAT_SUB +
+		((usec >> (msb - LAT_SUB_BITS)) & (LAT_SUB - 1));
+
+	return min(index, LAT_NR - 1);
+}
+
+/* The lowest latency that falls into a bucket */
+static unsigned long long lat_value(unsigned index)
+{
+	unsigned msb;
+
+	if (index < LAT_SUB)
+		return index;
+
+	msb = index / LAT_SUB + LAT_SUB_BITS - 1;
+	return (unsigned long long)(LAT_SUB + index % LAT_SUB) <<
+		(msb - LAT_SUB_BITS);
+}
+
 static int io_uring_register_buffers(struct submitter *s)
 {
 	if (do_nop)
@@ -140,17 +238,9 @@ static unsigned file_depth(struct submitter *s)
 	return (DEPTH + s->nr_files - 1) / s->nr_files;
 }
 
-static void init_io(struct submitter *s, unsigned index)
+static struct file *pick_file(struct submitter *s)
 {
-	struct io_uring_sqe *sqe = &s->sqes[index];
-	unsigned long offset;
 	struct file *f;
-	long r;
-
-	if (do_nop) {
-		sqe->opcode = IORING_OP_NOP;
-		return;
-	}
 
 	if (s->nr_files == 1) {
 		f = &s->files[0];
@@ -165,8 +255,51 @@ static void init_io(struct submitter *s, unsigned index)
 	}
 	f->pending_ios++;
 
+	return f;
+}
+
+static unsigned long pick_block(struct submitter *s, struct file *f)
+{
+	long r;
+
 	lrand48_r(&s->rand, &r);
-	offset = (r % (f->max_blocks - 1)) * BS;
+	if (profile->seq_pct && (unsigned long)r % 100 < profile->seq_pct) {
+		if (++f->seq_block >= f->max_blocks)
+			f->seq_block = 0;
+		return f->seq_block;
+	}
+
+	lrand48_r(&s->rand, &r);
+	return r % (f->max_blocks - 1);
+}
+
+static struct io_unit *get_io_unit(struct submitter *s)
+{
+	assert(s->nr_free_ios);
+	return s->free_ios[--s->nr_free_ios];
+}
+
+static void put_io_unit(struct submitter *s, struct io_unit *io)
+{
+	s->free_ios[s->nr_free_ios++] = io;
+}
+
+static void init_io(struct submitter *s, unsigned index, struct file *f,
+		    int opcode)
+{
+	struct io_uring_sqe *sqe = &s->sqes[index];
+	struct io_unit *io = get_io_unit(s);
+
+	io->issue_time = now_usec();
+	sqe->user_data = (unsigned long) io;
+
+	if (do_nop) {
+		sqe->opcode = IORING_OP_NOP;
+		io->file = NULL;
+		return;
+	}
+
+	io->file = f;
 
 	if (register_files) {
 		sqe->flags = IOSQE_FIXED_FILE;
@@ -175,20 +308,34 @@ static void init_io(struct submitter *s, unsigned index)
 		sqe->flags = 0;
 		sqe->fd = f->real_fd;
 	}
+	sqe->ioprio = 0;
+
+	if (opcode == IORING_OP_FSYNC) {
+		sqe->opcode = IORING_OP_FSYNC;
+		sqe->addr = 0;
+		sqe->len = 0;
+		sqe->buf_index = 0;
+		sqe->off = 0;
+		sqe->fsync_flags = 0;
+		io->expected_res = 0;
+		return;
+	}
+
 	if (fixedbufs) {
-		sqe->opcode = IORING_OP_READ_FIXED;
-		sqe->addr = (unsigned long) s->iovecs[index].iov_base;
-		sqe->len = BS;
-		sqe->buf_index = index;
+		sqe->opcode = opcode == IORING_OP_WRITEV ?
+			IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->addr = (unsigned long) s->iovecs[io->buf_index].iov_base;
+		sqe->len = bs;
+		sqe->buf_index = io->buf_index;
 	} else {
-		sqe->opcode = IORING_OP_READV;
-		sqe->addr = (unsigned long) &s->iovecs[index];
+		sqe->opcode = opcode;
+		sqe->addr = (unsigned long) &s->iovecs[io->buf_index];
 		sqe->len = 1;
 		sqe->buf_index = 0;
 	}
-	sqe->ioprio = 0;
-	sqe->off = offset;
-	sqe->user_data = (unsigned long) f;
+	sqe->rw_flags = 0;
+	sqe->off = (unsigned long long) pick_block(s, f) * bs;
+	io->expected_res = bs;
 }
 
 static int prep_more_ios(struct submitter *s, unsigned max_ios)
@@ -204,7 +351,33 @@ static int prep_more_ios(struct submitter *s, unsigned max_ios)
 			break;
 
 		index = tail & sq_ring_mask;
-		init_io(s, index);
+
+		if (profile->write_fsync && !do_nop) {
+			unsigned fsync_index = next_tail & sq_ring_mask;
+			struct file *f;
+
+			/*
+			 * Queue the write and its fsync together, linked so
+			 * that the fsync only starts once the write is done.
+			 */
+			if (prepped + 2 > max_ios || next_tail + 1 == *ring->head)
+				break;
+
+			f = pick_file(s);
+			init_io(s, index, f, IORING_OP_WRITEV);
+			s->sqes[index].flags |= IOSQE_IO_LINK;
+			ring->array[index] = index;
+
+			f->pending_ios++;
+			init_io(s, fsync_index, f, IORING_OP_FSYNC);
+			ring->array[fsync_index] = fsync_index;
+
+			prepped += 2;
+			tail = ++next_tail;
+			continue;
+		}
+
+		init_io(s, index, do_nop ? NULL : pick_file(s), IORING_OP_READV);
 		ring->array[index] = index;
 		prepped++;
 		tail = next_tail;
@@ -231,10 +404,10 @@ static int get_file_size(struct file *f)
 		if (ioctl(f->real_fd, BLKGETSIZE64, &bytes) != 0)
 			return -1;
 
-		f->max_blocks = bytes / BS;
+		f->max_blocks = bytes / bs;
 		return 0;
 	} else if (S_ISREG(st.st_mode)) {
-		f->max_blocks = st.st_size / BS;
+		f->max_blocks = st.st_size / bs;
 		return 0;
 	}
 
@@ -249,16 +422,25 @@ static int reap_events(struct submitter *s)
 
 	head = *ring->head;
 	do {
-		struct file *f;
+		unsigned long long lat;
+		struct io_unit *io;
 
 		read_barrier();
 		if (head == *ring->tail)
 			break;
 		cqe = &ring->cqes[head & cq_ring_mask];
+		io = (struct io_unit *) (uintptr_t) cqe->user_data;
+		put_io_unit(s, io);
 		if (!do_nop) {
-			f = (struct file *) (uintptr_t) cqe->user_data;
-			f->pending_ios--;
-			if (cqe->res != BS) {
+			io->file->pending_ios--;
+
+			lat = now_usec() - io->issue_time;
+			s->lat_hist[lat_index(lat)]++;
+			s->lat_samples++;
+			if (lat > s->lat_max)
+				s->lat_max = lat;
+
+			if (cqe->res != io->expected_res) {
 				printf("io: unexpected ret=%d\n", cqe->res);
 				if (polled && cqe->res == -EOPNOTSUPP)
 					printf("Your filesystem doesn't support poll\n");
@@ -459,6 +641,27 @@ static int setup_ring(struct submitter *s)
 	return 0;
 }
 
+static void print_latencies(struct submitter *s)
+{
+	static const double pcts[] = { 50.0, 90.0, 99.0, 99.9 };
+	unsigned long seen = 0;
+	unsigned i, p = 0;
+
+	if (!s->lat_samples)
+		return;
+
+	printf("Completion latency, %lu IOs:", s->lat_samples);
+	for (i = 0; i < LAT_NR && p < ARRAY_SIZE(pcts); i++) {
+		seen += s->lat_hist[i];
+		while (p < ARRAY_SIZE(pcts) &&
+		       seen >= s->lat_samples * pcts[p] / 100) {
+			printf(" p%g=%lluus", pcts[p], lat_value(i));
+			p++;
+		}
+	}
+	printf(" max=%lluus\n", s->lat_max);
+}
+
 static void file_depths(char *buf)
 {
 	struct submitter *s = &submitters[0];
@@ -484,17 +687,42 @@ int main(int argc, char *argv[])
 	int err, i, flags, fd;
 	char *fdepths;
 	void *ret;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:")) != -1) {
+		switch (opt) {
+		case 'p':
+			for (i = 0; i < (int) ARRAY_SIZE(profiles); i++)
+				if (!strcmp(optarg, profiles[i].name))
+					break;
+			if (i == (int) ARRAY_SIZE(profiles)) {
+				printf("Unknown profile %s\n", optarg);
+				return 1;
+			}
+			profile = &profiles[i];
+			break;
+		default:
+			printf("%s: [-p random|mixed|save|squashfs] filename\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	bs = profile->bs;
+	polled = profile->polled;
+	buffered = profile->buffered;
 
-	if (!do_nop && argc < 2) {
+	if (!do_nop && optind == argc) {
 		printf("%s: filename\n", argv[0]);
 		return 1;
 	}
 
-	flags = O_RDONLY | O_NOATIME;
+	flags = profile->write_fsync ? O_RDWR : O_RDONLY;
+	flags |= O_NOATIME;
 	if (!buffered)
 		flags |= O_DIRECT;
 
-	i = 1;
+	i = optind;
 	while (!do_nop && i < argc) {
 		struct file *f;
 
@@ -541,12 +769,14 @@ int main(int argc, char *argv[])
 	for (i = 0; i < DEPTH; i++) {
 		void *buf;
 
-		if (posix_memalign(&buf, BS, BS)) {
+		if (posix_memalign(&buf, BS, bs)) {
 			printf("failed alloc\n");
 			return 1;
 		}
 		s->iovecs[i].iov_base = buf;
-		s->iovecs[i].iov_len = BS;
+		s->iovecs[i].iov_len = bs;
+		s->ios[i].buf_index = i;
+		put_io_unit(s, &s->ios[i]);
 	}
 
 	err = setup_ring(s);
@@ -554,6 +784,7 @@ int main(int argc, char *argv[])
 		printf("ring setup failed: %s, %d\n", strerror(errno), err);
 		return 1;
 	}
+	printf("profile=%s, bs=%u, ", profile->name, bs);
 	printf("polled=%d, fixedbufs=%d, buffered=%d", polled, fixedbufs, buffered);
 	printf(" QD=%d, sq_ring=%d, cq_ring=%d\n", DEPTH, *s->sq_ring.ring_entries, *s->cq_ring.ring_entries);
 
@@ -586,6 +817,7 @@ int main(int argc, char *argv[])
 	} while (!finish);
 
 	pthread_join(s->thread, &ret);
+	print_latencies(s);
 	close(s->ring_fd);
 	free(fdepths);
 	return 0;
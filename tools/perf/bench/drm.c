@@ -0,0 +1,624 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * drm: Benchmarks for the display path of a KMS device
+ *
+ * flip: the cost of a page flip commit, legacy or atomic, and the latency
+ *       from the commit to the flip completion event.
+ * dumb: the CPU write bandwidth to a mapped dumb buffer, compared to
+ *       ordinary cached memory of the same size.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include <drm/drm.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/time64.h>
+#include <subcmd/parse-options.h>
+
+#include "../util/stat.h"
+#include "bench.h"
+
+#include <err.h>
+
+/* Not part of the uAPI headers, see enum drm_plane_type */
+#define BENCH_DRM_PLANE_TYPE_PRIMARY	1
+
+struct bench_drm {
+	int			fd;
+	uint32_t		conn_id;
+	uint32_t		crtc_id;
+	unsigned int		crtc_index;
+	struct drm_mode_modeinfo mode;
+	uint32_t		plane_id;
+	uint32_t		fb_prop_id;
+};
+
+struct bench_drm_fb {
+	uint32_t		handle;
+	uint32_t		fb_id;
+	uint32_t		pitch;
+	uint64_t		size;
+	void			*map;
+};
+
+static const char	*device = "/dev/dri/card0";
+static unsigned int	loops = 100;
+static bool		atomic;
+static unsigned int	width = 1920;
+static unsigned int	height = 1080;
+
+static const struct option flip_options[] = {
+	OPT_STRING('d', "device", &device, "path", "DRM device to use"),
+	OPT_UINTEGER('l', "loop", &loops, "Specify number of page flips"),
+	OPT_BOOLEAN('a', "atomic", &atomic, "Flip with atomic commits"),
+	OPT_END()
+};
+
+static const struct option dumb_options[] = {
+	OPT_STRING('d', "device", &device, "path", "DRM device to use"),
+	OPT_UINTEGER('l', "loop", &loops, "Specify number of buffer writes"),
+	OPT_UINTEGER('W', "width", &width, "Width of the buffer in pixels"),
+	OPT_UINTEGER('H', "height", &height, "Height of the buffer in pixels"),
+	OPT_END()
+};
+
+static const char * const bench_drm_flip_usage[] = {
+	"perf bench drm flip <options>",
+	NULL
+};
+
+static const char * const bench_drm_dumb_usage[] = {
+	"perf bench drm dumb <options>",
+	NULL
+};
+
+static int drm_ioctl(int fd, unsigned long request, void *arg)
+{
+	int ret;
+
+	do {
+		ret = ioctl(fd, request, arg);
+	} while (ret == -1 && (errno == EINTR || errno == EAGAIN));
+
+	return ret;
+}
+
+static u64 now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void *alloc_ids(uint32_t count, size_t size)
+{
+	void *p = calloc(count ?: 1, size);
+
+	if (!p)
+		err(EXIT_FAILURE, "calloc");
+	return p;
+}
+
+static int drm_open(struct bench_drm *drm)
+{
+	drm->fd = open(device, O_RDWR | O_CLOEXEC);
+	if (drm->fd < 0) {
+		warn("%s", device);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Pick the first connected connector, its preferred mode and a CRTC its
+ * encoder can drive.
+ */
+static int drm_find_output(struct bench_drm *drm)
+{
+	struct drm_mode_card_res res = {};
+	uint32_t *crtcs, *conns, *encs, *fbs;
+	unsigned int i, j;
+	int ret = -1;
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETRESOURCES, &res))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_GETRESOURCES");
+
+	fbs = alloc_ids(res.count_fbs, sizeof(*fbs));
+	crtcs = alloc_ids(res.count_crtcs, sizeof(*crtcs));
+	conns = alloc_ids(res.count_connectors, sizeof(*conns));
+	encs = alloc_ids(res.count_encoders, sizeof(*encs));
+	res.fb_id_ptr = (uintptr_t)fbs;
+	res.crtc_id_ptr = (uintptr_t)crtcs;
+	res.connector_id_ptr = (uintptr_t)conns;
+	res.encoder_id_ptr = (uintptr_t)encs;
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETRESOURCES, &res))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_GETRESOURCES");
+
+	for (i = 0; i < res.count_connectors && ret; i++) {
+		struct drm_mode_get_connector conn = { .connector_id = conns[i] };
+		struct drm_mode_get_encoder enc = {};
+		struct drm_mode_modeinfo *modes;
+		uint32_t *conn_encs;
+
+		if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn))
+			continue;
+		/* DRM_MODE_CONNECTED */
+		if (conn.connection != 1 || !conn.count_modes)
+			continue;
+
+		modes = alloc_ids(conn.count_modes, sizeof(*modes));
+		conn_encs = alloc_ids(conn.count_encoders, sizeof(*conn_encs));
+		conn.modes_ptr = (uintptr_t)modes;
+		conn.encoders_ptr = (uintptr_t)conn_encs;
+		conn.count_props = 0;
+
+		if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETCONNECTOR, &conn))
+			goto next;
+
+		enc.encoder_id = conn.encoder_id ?: conn_encs[0];
+		if (!enc.encoder_id ||
+		    drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETENCODER, &enc))
+			goto next;
+
+		for (j = 0; j < res.count_crtcs; j++) {
+			if (enc.crtc_id ? crtcs[j] != enc.crtc_id :
+			    !(enc.possible_crtcs & (1U << j)))
+				continue;
+
+			drm->conn_id = conns[i];
+			drm->crtc_id = crtcs[j];
+			drm->crtc_index = j;
+			drm->mode = modes[0];
+			ret = 0;
+			break;
+		}
+next:
+		free(conn_encs);
+		free(modes);
+	}
+
+	free(encs);
+	free(conns);
+	free(crtcs);
+	free(fbs);
+
+	if (ret)
+		fprintf(stderr, "%s: no connected output\n", device);
+	return ret;
+}
+
+static uint32_t drm_find_prop(int fd, uint32_t obj_id, uint32_t obj_type,
+			      const char *name, uint64_t *value)
+{
+	struct drm_mode_obj_get_properties props = {
+		.obj_id = obj_id,
+		.obj_type = obj_type,
+	};
+	uint32_t *ids, prop_id = 0;
+	uint64_t *values;
+	unsigned int i;
+
+	if (drm_ioctl(fd, DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &props))
+		return 0;
+
+	ids = alloc_ids(props.count_props, sizeof(*ids));
+	values = alloc_ids(props.count_props, sizeof(*values));
+	props.props_ptr = (uintptr_t)ids;
+	props.prop_values_ptr = (uintptr_t)values;
+
+	if (drm_ioctl(fd, DRM_IOCTL_MODE_OBJ_GETPROPERTIES, &props))
+		goto out;
+
+	for (i = 0; i < props.count_props; i++) {
+		struct drm_mode_get_property prop = { .prop_id = ids[i] };
+
+		if (drm_ioctl(fd, DRM_IOCTL_MODE_GETPROPERTY, &prop))
+			continue;
+		if (strcmp(prop.name, name))
+			continue;
+
+		prop_id = ids[i];
+		if (value)
+			*value = values[i];
+		break;
+	}
+out:
+	free(values);
+	free(ids);
+	return prop_id;
+}
+
+/* Find the primary plane of the CRTC, and the property to flip it with. */
+static int drm_find_primary_plane(struct bench_drm *drm)
+{
+	struct drm_set_client_cap cap = {
+		.capability = DRM_CLIENT_CAP_ATOMIC,
+		.value = 1,
+	};
+	struct drm_mode_get_plane_res res = {};
+	unsigned int i;
+	uint32_t *planes;
+	uint64_t type;
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_SET_CLIENT_CAP, &cap)) {
+		warn("%s: no atomic modesetting", device);
+		return -1;
+	}
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_GETPLANERESOURCES");
+
+	planes = alloc_ids(res.count_planes, sizeof(*planes));
+	res.plane_id_ptr = (uintptr_t)planes;
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_GETPLANERESOURCES");
+
+	for (i = 0; i < res.count_planes; i++) {
+		struct drm_mode_get_plane plane = { .plane_id = planes[i] };
+
+		if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_GETPLANE, &plane))
+			continue;
+		if (!(plane.possible_crtcs & (1U << drm->crtc_index)))
+			continue;
+		if (!drm_find_prop(drm->fd, planes[i], DRM_MODE_OBJECT_PLANE,
+				   "type", &type) ||
+		    type != BENCH_DRM_PLANE_TYPE_PRIMARY)
+			continue;
+
+		drm->fb_prop_id = drm_find_prop(drm->fd, planes[i],
+						DRM_MODE_OBJECT_PLANE,
+						"FB_ID", NULL);
+		if (drm->fb_prop_id) {
+			drm->plane_id = planes[i];
+			break;
+		}
+	}
+
+	free(planes);
+
+	if (!drm->plane_id) {
+		fprintf(stderr, "%s: no primary plane\n", device);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int drm_fb_create(struct bench_drm *drm, struct bench_drm_fb *fb,
+			 unsigned int w, unsigned int h, bool add_fb)
+{
+	struct drm_mode_create_dumb create = {
+		.width = w,
+		.height = h,
+		.bpp = 32,
+	};
+	struct drm_mode_map_dumb map = {};
+	struct drm_mode_fb_cmd cmd = {};
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_CREATE_DUMB, &create)) {
+		warn("DRM_IOCTL_MODE_CREATE_DUMB");
+		return -1;
+	}
+
+	fb->handle = create.handle;
+	fb->pitch = create.pitch;
+	fb->size = create.size;
+	fb->fb_id = 0;
+
+	map.handle = fb->handle;
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_MAP_DUMB, &map))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_MAP_DUMB");
+
+	fb->map = mmap(NULL, fb->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		       drm->fd, map.offset);
+	if (fb->map == MAP_FAILED)
+		err(EXIT_FAILURE, "mmap");
+
+	if (!add_fb)
+		return 0;
+
+	cmd.width = w;
+	cmd.height = h;
+	cmd.pitch = fb->pitch;
+	cmd.bpp = 32;
+	cmd.depth = 24;
+	cmd.handle = fb->handle;
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_ADDFB, &cmd))
+		err(EXIT_FAILURE, "DRM_IOCTL_MODE_ADDFB");
+
+	fb->fb_id = cmd.fb_id;
+	return 0;
+}
+
+static void drm_fb_destroy(struct bench_drm *drm, struct bench_drm_fb *fb)
+{
+	struct drm_mode_destroy_dumb destroy = { .handle = fb->handle };
+
+	if (fb->fb_id)
+		drm_ioctl(drm->fd, DRM_IOCTL_MODE_RMFB, &fb->fb_id);
+	munmap(fb->map, fb->size);
+	drm_ioctl(drm->fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+}
+
+static int drm_flip(struct bench_drm *drm, struct bench_drm_fb *fb)
+{
+	uint32_t objs[] = { drm->plane_id };
+	uint32_t count_props[] = { 1 };
+	uint32_t props[] = { drm->fb_prop_id };
+	uint64_t values[] = { fb->fb_id };
+	struct drm_mode_atomic req = {
+		.flags = DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK,
+		.count_objs = 1,
+		.objs_ptr = (uintptr_t)objs,
+		.count_props_ptr = (uintptr_t)count_props,
+		.props_ptr = (uintptr_t)props,
+		.prop_values_ptr = (uintptr_t)values,
+	};
+	struct drm_mode_crtc_page_flip flip = {
+		.crtc_id = drm->crtc_id,
+		.fb_id = fb->fb_id,
+		.flags = DRM_MODE_PAGE_FLIP_EVENT,
+	};
+
+	if (atomic)
+		return drm_ioctl(drm->fd, DRM_IOCTL_MODE_ATOMIC, &req);
+
+	return drm_ioctl(drm->fd, DRM_IOCTL_MODE_PAGE_FLIP, &flip);
+}
+
+/* Wait for the flip completion event, return 0 once it has been read. */
+static int drm_wait_flip(struct bench_drm *drm)
+{
+	char buf[1024];
+	struct pollfd pfd = { .fd = drm->fd, .events = POLLIN };
+	struct drm_event *e;
+	ssize_t len, i;
+
+	for (;;) {
+		if (poll(&pfd, 1, 1000) <= 0) {
+			fprintf(stderr, "timed out waiting for the flip\n");
+			return -1;
+		}
+
+		len = read(drm->fd, buf, sizeof(buf));
+		if (len < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			warn("read");
+			return -1;
+		}
+
+		for (i = 0; i + (ssize_t)sizeof(*e) <= len; i += e->length) {
+			e = (struct drm_event *)&buf[i];
+			if (e->type == DRM_EVENT_FLIP_COMPLETE)
+				return 0;
+		}
+	}
+}
+
+/*
+ * Put back the configuration of the CRTC from before the benchmark, before
+ * its framebuffers go away, so that the console or compositor that was
+ * using it gets its display back. An idle CRTC is turned off again.
+ */
+static void drm_restore_crtc(struct bench_drm *drm,
+			     struct drm_mode_crtc *saved)
+{
+	struct drm_mode_crtc crtc = { .crtc_id = saved->crtc_id };
+
+	if (saved->mode_valid && saved->fb_id) {
+		crtc.fb_id = saved->fb_id;
+		crtc.x = saved->x;
+		crtc.y = saved->y;
+		crtc.set_connectors_ptr = (uintptr_t)&drm->conn_id;
+		crtc.count_connectors = 1;
+		crtc.mode = saved->mode;
+		crtc.mode_valid = 1;
+	}
+
+	if (drm_ioctl(drm->fd, DRM_IOCTL_MODE_SETCRTC, &crtc))
+		warn("DRM_IOCTL_MODE_SETCRTC");
+}
+
+int bench_drm_flip(int argc, const char **argv)
+{
+	struct stats commit_stats, event_stats;
+	struct drm_mode_crtc saved_crtc = {};
+	struct drm_mode_crtc crtc = {};
+	struct bench_drm_fb fb[2];
+	struct bench_drm drm = {};
+	unsigned int i, w, h;
+	u64 start, commit, event;
+	int ret = EXIT_FAILURE;
+
+	argc = parse_options(argc, argv, flip_options, bench_drm_flip_usage, 0);
+	if (argc) {
+		usage_with_options(bench_drm_flip_usage, flip_options);
+		exit(EXIT_FAILURE);
+	}
+
+	if (drm_open(&drm))
+		return EXIT_FAILURE;
+
+	if (drm_find_output(&drm))
+		goto out_close;
+
+	if (atomic && drm_find_primary_plane(&drm))
+		goto out_close;
+
+	saved_crtc.crtc_id = drm.crtc_id;
+	if (drm_ioctl(drm.fd, DRM_IOCTL_MODE_GETCRTC, &saved_crtc)) {
+		warn("DRM_IOCTL_MODE_GETCRTC");
+		goto out_close;
+	}
+
+	w = drm.mode.hdisplay;
+	h = drm.mode.vdisplay;
+	if (drm_fb_create(&drm, &fb[0], w, h, true))
+		goto out_close;
+	if (drm_fb_create(&drm, &fb[1], w, h, true))
+		goto out_destroy_fb0;
+
+	memset(fb[0].map, 0x00, fb[0].size);
+	memset(fb[1].map, 0xff, fb[1].size);
+
+	crtc.crtc_id = drm.crtc_id;
+	crtc.fb_id = fb[0].fb_id;
+	crtc.set_connectors_ptr = (uintptr_t)&drm.conn_id;
+	crtc.count_connectors = 1;
+	crtc.mode = drm.mode;
+	crtc.mode_valid = 1;
+	if (drm_ioctl(drm.fd, DRM_IOCTL_MODE_SETCRTC, &crtc)) {
+		warn("DRM_IOCTL_MODE_SETCRTC");
+		goto out_destroy_fb1;
+	}
+
+	printf("# Flipping %ux%u@%u on CRTC %u with %s commits, %u times\n\n",
+	       w, h, drm.mode.vrefresh, drm.crtc_id,
+	       atomic ? "atomic" : "legacy", loops);
+
+	init_stats(&commit_stats);
+	init_stats(&event_stats);
+
+	for (i = 0; i < loops; i++) {
+		start = now_nsec();
+		if (drm_flip(&drm, &fb[(i + 1) % 2])) {
+			warn("page flip");
+			goto out_restore_crtc;
+		}
+		commit = now_nsec();
+
+		if (drm_wait_flip(&drm))
+			goto out_restore_crtc;
+		event = now_nsec();
+
+		update_stats(&commit_stats, commit - start);
+		update_stats(&event_stats, event - start);
+	}
+
+	switch (bench_format) {
+	case BENCH_FORMAT_DEFAULT:
+		printf(" %14s: %.3f usecs (+-%.2f%%), max %.3f usecs\n",
+		       "Commit",
+		       avg_stats(&commit_stats) / NSEC_PER_USEC,
+		       rel_stddev_stats(stddev_stats(&commit_stats),
+					avg_stats(&commit_stats)),
+		       (double)commit_stats.max / NSEC_PER_USEC);
+		printf(" %14s: %.3f usecs (+-%.2f%%), max %.3f usecs\n",
+		       "Flip event",
+		       avg_stats(&event_stats) / NSEC_PER_USEC,
+		       rel_stddev_stats(stddev_stats(&event_stats),
+					avg_stats(&event_stats)),
+		       (double)event_stats.max / NSEC_PER_USEC);
+		break;
+
+	case BENCH_FORMAT_SIMPLE:
+		printf("%.3f %.3f\n",
+		       avg_stats(&commit_stats) / NSEC_PER_USEC,
+		       avg_stats(&event_stats) / NSEC_PER_USEC);
+		break;
+
+	default:
+		/* reaching here is something disaster */
+		fprintf(stderr, "Unknown format:%d\n", bench_format);
+		exit(1);
+		break;
+	}
+
+	ret = 0;
+out_restore_crtc:
+	drm_restore_crtc(&drm, &saved_crtc);
+out_destroy_fb1:
+	drm_fb_destroy(&drm, &fb[1]);
+out_destroy_fb0:
+	drm_fb_destroy(&drm, &fb[0]);
+out_close:
+	close(drm.fd);
+	return ret;
+}
+
+/* Return the write bandwidth to @buf in MB/s. */
+static double dumb_write_bw(void *buf, size_t size)
+{
+	u64 start, elapsed;
+	unsigned int i;
+
+	start = now_nsec();
+	for (i = 0; i < loops; i++)
+		memset(buf, i, size);
+	elapsed = now_nsec() - start;
+
+	return (double)size * loops / elapsed * NSEC_PER_SEC / (1024 * 1024);
+}
+
+int bench_drm_dumb(int argc, const char **argv)
+{
+	struct bench_drm drm = {};
+	struct bench_drm_fb fb;
+	double dumb_bw, mem_bw;
+	void *mem;
+
+	argc = parse_options(argc, argv, dumb_options, bench_drm_dumb_usage, 0);
+	if (argc || !loops) {
+		usage_with_options(bench_drm_dumb_usage, dumb_options);
+		exit(EXIT_FAILURE);
+	}
+
+	if (drm_open(&drm))
+		return EXIT_FAILURE;
+
+	if (drm_fb_create(&drm, &fb, width, height, false)) {
+		close(drm.fd);
+		return EXIT_FAILURE;
+	}
+
+	mem = malloc(fb.size);
+	if (!mem)
+		err(EXIT_FAILURE, "malloc");
+
+	/* Fault the pages in before timing anything */
+	memset(fb.map, 0, fb.size);
+	memset(mem, 0, fb.size);
+
+	dumb_bw = dumb_write_bw(fb.map, fb.size);
+	mem_bw = dumb_write_bw(mem, fb.size);
+
+	switch (bench_format) {
+	case BENCH_FORMAT_DEFAULT:
+		printf("# Writing a %ux%u dumb buffer (%llu bytes) %u times\n\n",
+		       width, height, (unsigned long long)fb.size, loops);
+		printf(" %14s: %.3f MB/sec\n", "Dumb buffer", dumb_bw);
+		printf(" %14s: %.3f MB/sec\n", "Cached memory", mem_bw);
+		break;
+
+	case BENCH_FORMAT_SIMPLE:
+		printf("%.3f %.3f\n", dumb_bw, mem_bw);
+		break;
+
+	default:
+		/* reaching here is something disaster */
+		fprintf(stderr, "Unknown format:%d\n", bench_format);
+		exit(1);
+		break;
+	}
+
+	free(mem);
+	drm_fb_destroy(&drm, &fb);
+	close(drm.fd);
+	return 0;
+}
@@ -11,3 +11,13 @@
 
 #endif
 
+#ifdef HAVE_ARCH_MIPS_SUPPORT
+
+#define MEMCPY_FN(fn, name, desc)		\
+	void *fn(void *, const void *, size_t);
+
+#include "mem-memcpy-mips-asm-def.h"
+
+#undef MEMCPY_FN
+
+#endif
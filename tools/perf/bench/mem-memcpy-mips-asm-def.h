@@ -0,0 +1,9 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+MEMCPY_FN(memcpy_mips,
+	"mips",
+	"memcpy() in arch/mips/lib/memcpy.S")
+
+MEMCPY_FN(memcpy_mips_pref,
+	"mips-pref",
+	"memcpy() in arch/mips/lib/memcpy.S, built with prefetching")
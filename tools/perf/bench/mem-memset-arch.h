@@ -11,3 +11,13 @@
 
 #endif
 
+#ifdef HAVE_ARCH_MIPS_SUPPORT
+
+#define MEMSET_FN(fn, name, desc)		\
+	void *fn(void *, int, size_t);
+
+#include "mem-memset-mips-asm-def.h"
+
+#undef MEMSET_FN
+
+#endif
@@ -0,0 +1,5 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+MEMSET_FN(memset_mips,
+	"mips",
+	"memset() in arch/mips/lib/memset.S")
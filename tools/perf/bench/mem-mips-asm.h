@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+/*
+ * Build environment for the arch/mips/lib .S files in user-space, with the
+ * kernel config they look at derived from the compiler's target:
+ */
+
+#if _MIPS_SZLONG == 64
+#define CONFIG_64BIT
+#endif
+#ifdef __MIPSEL__
+#define CONFIG_CPU_LITTLE_ENDIAN
+#endif
+#if __mips_isa_rev >= 6
+#define CONFIG_CPU_MIPSR6
+#define CONFIG_CPU_NO_LOAD_STORE_LR
+#endif
+
+#include <asm/asm.h>
+
+/* Drop the exception table entries, the fixups are never reached: */
+#undef PTR
+#define PTR bench_ignore
+
+	.macro	bench_ignore args:vararg
+	.endm
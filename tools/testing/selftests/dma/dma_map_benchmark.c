@@ -23,12 +23,22 @@
 #define DMA_MAP_TO_DEVICE	1
 #define DMA_MAP_FROM_DEVICE	2
 
+#define DMA_MAP_CACHE_DEFAULT	0
+#define DMA_MAP_CACHE_DIRTY	1
+#define DMA_MAP_CACHE_CLEAN	2
+
 static char *directions[] = {
 	"BIDIRECTIONAL",
 	"TO_DEVICE",
 	"FROM_DEVICE",
 };
 
+static char *cache_states[] = {
+	"default",
+	"dirty",
+	"clean",
+};
+
 struct map_benchmark {
 	__u64 avg_map_100ns; /* average map latency in 100ns */
 	__u64 map_stddev; /* standard deviation of map latency */
@@ -41,7 +51,13 @@ struct map_benchmark {
 	__u32 dma_dir; /* DMA data direction */
 	__u32 dma_trans_ns; /* time for DMA transmission in ns */
 	__u32 granule; /* how many PAGE_SIZE will do map/unmap once a time */
-	__u8 expansion[76];	/* For future use */
+	__u32 skip_unmap_sync; /* unmap with DMA_ATTR_SKIP_CPU_SYNC */
+	__u64 avg_sync_100ns; /* average sync for cpu + device latency */
+	__u64 sync_stddev;
+	__u32 sync; /* sync for cpu then device before unmapping */
+	__u32 cache_state; /* state of the buffer in the CPU caches at map */
+	__u32 sg_nents; /* map a scatterlist of that many entries, if not 0 */
+	__u8 expansion[44];	/* For future use */
 };
 
 int main(int argc, char **argv)
@@ -54,11 +70,15 @@ int main(int argc, char **argv)
 	int bits = 32, xdelay = 0, dir = DMA_MAP_BIDIRECTIONAL;
 	/* default granule 1 PAGESIZE */
 	int granule = 1;
+	/* default sync the buffer for the CPU on unmap */
+	int skip_unmap_sync = 0;
+	/* default no intermediate sync, dirty cache, single mapping */
+	int sync = 0, cache_state = DMA_MAP_CACHE_DEFAULT, sg_nents = 0;
 
 	int cmd = DMA_MAP_BENCHMARK;
 	char *p;
 
-	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:")) != -1) {
+	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:kyc:l:")) != -1) {
 		switch (opt) {
 		case 't':
 			threads = atoi(optarg);
@@ -81,6 +101,18 @@ int main(int argc, char **argv)
 		case 'g':
 			granule = atoi(optarg);
 			break;
+		case 'k':
+			skip_unmap_sync = 1;
+			break;
+		case 'y':
+			sync = 1;
+			break;
+		case 'c':
+			cache_state = atoi(optarg);
+			break;
+		case 'l':
+			sg_nents = atoi(optarg);
+			break;
 		default:
 			return -1;
 		}
@@ -121,6 +153,17 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+	if (cache_state < DMA_MAP_CACHE_DEFAULT ||
+	    cache_state > DMA_MAP_CACHE_CLEAN) {
+		fprintf(stderr, "invalid cache state, must be in 0-2\n");
+		exit(1);
+	}
+
+	if (sg_nents < 0) {
+		fprintf(stderr, "invalid number of scatterlist entries\n");
+		exit(1);
+	}
+
 	fd = open("/sys/kernel/debug/dma_map_benchmark", O_RDWR);
 	if (fd == -1) {
 		perror("open");
@@ -135,18 +178,27 @@ int main(int argc, char **argv)
 	map.dma_dir = dir;
 	map.dma_trans_ns = xdelay;
 	map.granule = granule;
+	map.skip_unmap_sync = skip_unmap_sync;
+	map.sync = sync;
+	map.cache_state = cache_state;
+	map.sg_nents = sg_nents;
 
 	if (ioctl(fd, cmd, &map)) {
 		perror("ioctl");
 		exit(1);
 	}
 
-	printf("dma mapping benchmark: threads:%d seconds:%d node:%d dir:%s granule: %d\n",
-			threads, seconds, node, dir[directions], granule);
+	printf("dma mapping benchmark: threads:%d seconds:%d node:%d dir:%s granule: %d cache:%s sg entries:%d%s\n",
+			threads, seconds, node, dir[directions], granule,
+			cache_states[cache_state], sg_nents,
+			skip_unmap_sync ? " skip unmap sync" : "");
 	printf("average map latency(us):%.1f standard deviation:%.1f\n",
 			map.avg_map_100ns/10.0, map.map_stddev/10.0);
 	printf("average unmap latency(us):%.1f standard deviation:%.1f\n",
 			map.avg_unmap_100ns/10.0, map.unmap_stddev/10.0);
+	if (sync)
+		printf("average sync latency(us):%.1f standard deviation:%.1f\n",
+				map.avg_sync_100ns/10.0, map.sync_stddev/10.0);
 
 	return 0;
 }
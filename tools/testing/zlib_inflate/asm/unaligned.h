@@ -0,0 +1,25 @@
+#ifndef _ASM_UNALIGNED_H
+#define _ASM_UNALIGNED_H
+
+#include <string.h>
+#include <linux/kernel.h>
+
+#define get_unaligned(p) ({			\
+	__typeof__(*(p)) __v;			\
+	memcpy(&__v, (p), sizeof(__v));		\
+	__v;					\
+})
+
+#define put_unaligned(v, p) do {		\
+	__typeof__(*(p)) __v = (v);		\
+	memcpy((p), &__v, sizeof(__v));		\
+} while (0)
+
+static inline u32 get_unaligned_le32(const void *p)
+{
+	const u8 *b = p;
+
+	return b[0] | b[1] << 8 | b[2] << 16 | (u32)b[3] << 24;
+}
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stddef.h>
+
+size_t bench_compress(void *dst, size_t dst_len,
+		      const void *src, size_t src_len);
+
+#endif
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * The input is compressed with the system zlib, in its own file since its
+ * zlib.h cannot be mixed with the one of the kernel.
+ */
+#include <zlib.h>
+
+#include "bench.h"
+
+size_t bench_compress(void *dst, size_t dst_len,
+		      const void *src, size_t src_len)
+{
+	uLongf len = dst_len;
+
+	if (compress2(dst, &len, src, src_len, Z_BEST_COMPRESSION) != Z_OK)
+		return 0;
+
+	return len;
+}
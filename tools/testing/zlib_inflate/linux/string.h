@@ -0,0 +1,6 @@
+#ifndef _LINUX_STRING_H
+#define _LINUX_STRING_H
+
+#include <string.h>
+
+#endif
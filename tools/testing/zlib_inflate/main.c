@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Decompression throughput of lib/zlib_inflate. The Makefile builds it twice:
+ * inflate-bench with the bit buffer refills and match copies selected for
+ * 32-bit MIPS, and inflate-bench-ref with the byte-wise ones they replace, so
+ * that both can be compared on the same input.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <linux/zlib.h>
+
+#include "bench.h"
+
+#define INPUT_SIZE	(1 << 20)
+#define MIN_NSECS	500000000ULL
+
+static const char *const words[] = {
+	"static", "struct", "return", "unsigned", "int", "const", "void",
+	"if", "else", "for", "while", "break", "the", "of", "to", "and",
+	"buffer", "length", "state", "window", "bits", "hold", "code",
+};
+
+static unsigned int seed = 1;
+
+static unsigned int bench_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+/* Words from a small dictionary, like source code or configuration files */
+static void fill_text(unsigned char *buf, size_t len)
+{
+	size_t pos = 0, n;
+	const char *word;
+
+	while (pos < len) {
+		word = words[bench_rand() % (sizeof(words) / sizeof(words[0]))];
+		n = strlen(word);
+		if (n > len - pos - 1)
+			n = len - pos - 1;
+		memcpy(buf + pos, word, n);
+		pos += n;
+		buf[pos++] = bench_rand() % 8 ? ' ' : '\n';
+	}
+}
+
+/* Smooth gradients with some noise, like the filtered rows of a PNG */
+static void fill_image(unsigned char *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (i % 1024) / 8 + (i / 4096) % 64 + bench_rand() % 4;
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int inflate_once(z_stream *strm, const void *in, size_t in_len,
+			void *out, size_t out_len)
+{
+	int ret;
+
+	strm->next_in = in;
+	strm->avail_in = in_len;
+	strm->next_out = out;
+	strm->avail_out = out_len;
+
+	if (zlib_inflateInit2(strm, MAX_WBITS) != Z_OK)
+		return -1;
+
+	ret = zlib_inflate(strm, Z_FINISH);
+	zlib_inflateEnd(strm);
+
+	if (ret != Z_STREAM_END || strm->total_out != out_len)
+		return -1;
+
+	return 0;
+}
+
+static int bench(const char *name, void (*fill)(unsigned char *, size_t))
+{
+	unsigned char *input, *compressed, *output;
+	unsigned long long start, elapsed;
+	unsigned int loops = 0;
+	size_t compressed_len;
+	z_stream strm = {};
+	int ret = -1;
+
+	input = malloc(INPUT_SIZE);
+	compressed = malloc(2 * INPUT_SIZE);
+	output = malloc(INPUT_SIZE);
+	strm.workspace = malloc(zlib_inflate_workspacesize());
+	if (!input || !compressed || !output || !strm.workspace)
+		goto out;
+
+	fill(input, INPUT_SIZE);
+
+	compressed_len = bench_compress(compressed, 2 * INPUT_SIZE,
+					input, INPUT_SIZE);
+	if (!compressed_len)
+		goto out;
+
+	if (inflate_once(&strm, compressed, compressed_len,
+			 output, INPUT_SIZE) ||
+	    memcmp(input, output, INPUT_SIZE)) {
+		fprintf(stderr, "%s: decompression mismatch\n", name);
+		goto out;
+	}
+
+	start = now_ns();
+	do {
+		inflate_once(&strm, compressed, compressed_len,
+			     output, INPUT_SIZE);
+		loops++;
+		elapsed = now_ns() - start;
+	} while (elapsed < MIN_NSECS);
+
+	printf("%-8s %5zu KiB -> %5zu KiB %8.1f MiB/s\n", name,
+	       (size_t)INPUT_SIZE / 1024, compressed_len / 1024,
+	       (double)INPUT_SIZE * loops / (1 << 20) / (elapsed / 1e9));
+	ret = 0;
+
+out:
+	free(strm.workspace);
+	free(output);
+	free(compressed);
+	free(input);
+	return ret;
+}
+
+int main(void)
+{
+	int ret = 0;
+
+	ret |= bench("text", fill_text);
+	ret |= bench("image", fill_image);
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
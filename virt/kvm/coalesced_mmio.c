@@ -12,6 +12,8 @@
 #include <kvm/iodev.h>
 
 #include <linux/kvm_host.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/kvm.h>
 
@@ -77,6 +79,8 @@ static int coalesced_mmio_write(struct kvm_vcpu *vcpu,
 	insert = READ_ONCE(ring->last);
 	if (!coalesced_mmio_has_room(dev, insert) ||
 	    insert >= KVM_COALESCED_MMIO_MAX) {
+		/* The write exits to userspace instead. */
+		dev->ring_full++;
 		spin_unlock(&dev->kvm->ring_lock);
 		return -EOPNOTSUPP;
 	}
@@ -89,6 +93,7 @@ static int coalesced_mmio_write(struct kvm_vcpu *vcpu,
 	ring->coalesced_mmio[insert].pio = dev->zone.pio;
 	smp_wmb();
 	ring->last = (insert + 1) % KVM_COALESCED_MMIO_MAX;
+	dev->coalesced++;
 	spin_unlock(&dev->kvm->ring_lock);
 	return 0;
 }
@@ -128,6 +133,68 @@ int kvm_coalesced_mmio_init(struct kvm *kvm)
 	return 0;
 }
 
+/*
+ * One line per registered zone: its address, size, whether it is a PIO
+ * zone, how many writes were coalesced into the ring and how many found
+ * the ring full and exited to userspace.
+ */
+static int coalesced_mmio_debugfs_show(struct seq_file *m, void *v)
+{
+	struct kvm *kvm = m->private;
+	struct kvm_coalesced_mmio_dev *dev;
+
+	mutex_lock(&kvm->slots_lock);
+	list_for_each_entry(dev, &kvm->coalesced_zones, list)
+		seq_printf(m, "%#llx %#x %u %llu %llu\n", dev->zone.addr,
+			   dev->zone.size, dev->zone.pio,
+			   READ_ONCE(dev->coalesced),
+			   READ_ONCE(dev->ring_full));
+	mutex_unlock(&kvm->slots_lock);
+
+	return 0;
+}
+
+static int coalesced_mmio_debugfs_open(struct inode *inode, struct file *file)
+{
+	struct kvm *kvm = inode->i_private;
+	int ret;
+
+	/* See kvm_debugfs_open(). */
+	if (!refcount_inc_not_zero(&kvm->users_count))
+		return -ENOENT;
+
+	ret = single_open(file, coalesced_mmio_debugfs_show, kvm);
+	if (ret)
+		kvm_put_kvm(kvm);
+
+	return ret;
+}
+
+static int coalesced_mmio_debugfs_release(struct inode *inode,
+					  struct file *file)
+{
+	struct kvm *kvm = inode->i_private;
+
+	single_release(inode, file);
+	kvm_put_kvm(kvm);
+
+	return 0;
+}
+
+static const struct file_operations coalesced_mmio_debugfs_fops = {
+	.owner		= THIS_MODULE,
+	.open		= coalesced_mmio_debugfs_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= coalesced_mmio_debugfs_release,
+};
+
+void kvm_coalesced_mmio_create_debugfs(struct kvm *kvm)
+{
+	debugfs_create_file("coalesced_mmio", 0444, kvm->debugfs_dentry, kvm,
+			    &coalesced_mmio_debugfs_fops);
+}
+
 void kvm_coalesced_mmio_free(struct kvm *kvm)
 {
 	if (kvm->coalesced_mmio_ring)
@@ -20,10 +20,14 @@ struct kvm_coalesced_mmio_dev {
 	struct kvm_io_device dev;
 	struct kvm *kvm;
 	struct kvm_coalesced_mmio_zone zone;
+	/* Writes coalesced, and writes that found the ring full. */
+	u64 coalesced;
+	u64 ring_full;
 };
 
 int kvm_coalesced_mmio_init(struct kvm *kvm);
 void kvm_coalesced_mmio_free(struct kvm *kvm);
+void kvm_coalesced_mmio_create_debugfs(struct kvm *kvm);
 int kvm_vm_ioctl_register_coalesced_mmio(struct kvm *kvm,
 					struct kvm_coalesced_mmio_zone *zone);
 int kvm_vm_ioctl_unregister_coalesced_mmio(struct kvm *kvm,
@@ -33,6 +37,7 @@ int kvm_vm_ioctl_unregister_coalesced_mmio(struct kvm *kvm,
 
 static inline int kvm_coalesced_mmio_init(struct kvm *kvm) { return 0; }
 static inline void kvm_coalesced_mmio_free(struct kvm *kvm) { }
+static inline void kvm_coalesced_mmio_create_debugfs(struct kvm *kvm) { }
 
 #endif
 
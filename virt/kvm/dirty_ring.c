@@ -11,6 +11,13 @@
 #include <trace/events/kvm.h>
 #include "mmu_lock.h"
 
+/*
+ * Number of coalesced runs of gfns re-protected per hold of the MMU lock
+ * while resetting a ring, so that resetting a full ring doesn't hold off
+ * the vCPUs' page faults for the whole reset.
+ */
+#define KVM_DIRTY_RING_RESET_BATCH	64
+
 int __weak kvm_cpu_dirty_log_size(void)
 {
 	return 0;
@@ -45,6 +52,7 @@ struct kvm_dirty_ring *kvm_dirty_ring_get(struct kvm *kvm)
 	return &vcpu->dirty_ring;
 }
 
+/* Called with the MMU lock held. */
 static void kvm_reset_dirty_gfn(struct kvm *kvm, u32 slot, u64 offset, u64 mask)
 {
 	struct kvm_memory_slot *memslot;
@@ -61,9 +69,27 @@ static void kvm_reset_dirty_gfn(struct kvm *kvm, u32 slot, u64 offset, u64 mask)
 	if (!memslot || (offset + __fls(mask)) >= memslot->npages)
 		return;
 
-	KVM_MMU_LOCK(kvm);
 	kvm_arch_mmu_enable_log_dirty_pt_masked(kvm, memslot, offset, mask);
-	KVM_MMU_UNLOCK(kvm);
+}
+
+/*
+ * Re-protect one run of gfns, taking the MMU lock for the first run of a
+ * batch and dropping it after the last one.  @batch counts the runs done
+ * under the current hold of the lock.
+ */
+static void kvm_reset_dirty_gfn_batched(struct kvm *kvm, unsigned int *batch,
+					u32 slot, u64 offset, u64 mask)
+{
+	if (!*batch)
+		KVM_MMU_LOCK(kvm);
+
+	kvm_reset_dirty_gfn(kvm, slot, offset, mask);
+
+	if (++*batch == KVM_DIRTY_RING_RESET_BATCH) {
+		KVM_MMU_UNLOCK(kvm);
+		*batch = 0;
+		cond_resched();
+	}
 }
 
 int kvm_dirty_ring_alloc(struct kvm_dirty_ring *ring, int index, u32 size)
@@ -106,6 +132,7 @@ int kvm_dirty_ring_reset(struct kvm *kvm, struct kvm_dirty_ring *ring)
 	u32 cur_slot, next_slot;
 	u64 cur_offset, next_offset;
 	unsigned long mask;
+	unsigned int batch = 0;
 	int count = 0;
 	struct kvm_dirty_gfn *entry;
 	bool first_round = true;
@@ -147,14 +174,20 @@ int kvm_dirty_ring_reset(struct kvm *kvm, struct kvm_dirty_ring *ring)
 				continue;
 			}
 		}
-		kvm_reset_dirty_gfn(kvm, cur_slot, cur_offset, mask);
+		if (!first_round)
+			kvm_reset_dirty_gfn_batched(kvm, &batch, cur_slot,
+						    cur_offset, mask);
 		cur_slot = next_slot;
 		cur_offset = next_offset;
 		mask = 1;
 		first_round = false;
 	}
 
-	kvm_reset_dirty_gfn(kvm, cur_slot, cur_offset, mask);
+	if (!first_round)
+		kvm_reset_dirty_gfn_batched(kvm, &batch, cur_slot, cur_offset,
+					    mask);
+	if (batch)
+		KVM_MMU_UNLOCK(kvm);
 
 	trace_kvm_dirty_ring_reset(ring);
 
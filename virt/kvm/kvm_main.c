@@ -873,6 +873,7 @@ static int kvm_create_vm_debugfs(struct kvm *kvm, int fd)
 				    kvm->debugfs_dentry, stat_data,
 				    &stat_fops_per_vm);
 	}
+	kvm_coalesced_mmio_create_debugfs(kvm);
 	return 0;
 }
 